@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+package org.postgresql.pljava;
+
+import java.sql.SQLException;
+
+/**
+ * Queues calls of functions to be made by background workers, in sessions of
+ * their own, obtained from {@link Session#backgroundJobs()}.
+ *<p>
+ * A job is a call of a function taking one {@code text} argument, made as the
+ * current outer user in the current database; its result is kept as text.
+ * The function is recorded by its oid when the job is submitted, and the user
+ * must be a role that can log in, as the workers connect as that role.
+ * Jobs are queued in {@code sqlj.background_job} when the submitting
+ * transaction commits, and run in order by up to {@code pljava.job_workers}
+ * background workers per user, which start Java once and then wait up to
+ * {@code pljava.job_idle_timeout} for further jobs, so a long computation
+ * need not hold the client's connection. The same operations are available
+ * in SQL as {@code sqlj.submit_job} and {@code sqlj.job_status}.
+ */
+public interface BackgroundJobs
+{
+	/**
+	 * The states of a job.
+	 */
+	enum State { QUEUED, RUNNING, DONE, FAILED }
+
+	/**
+	 * Queue a job.
+	 * @param function The function's signature, as accepted by
+	 * {@code regprocedure}, such as {@code myschema.retrain(text)}.
+	 * @param argument The argument to call it with, which may be null.
+	 * @return The job's id.
+	 * @throws SQLException if the function does not exist, does not take one
+	 * {@code text} argument, or returns a set, if the user may not execute it,
+	 * or if the user is a role that cannot log in.
+	 */
+	long submit(String function, String argument) throws SQLException;
+
+	/**
+	 * The state of a job, or null if there is no such job submitted by the
+	 * current outer user (or it has not yet been committed).
+	 */
+	State state(long jobId) throws SQLException;
+
+	/**
+	 * The result of a job that is done, or null if it is not yet done (or its
+	 * function returned null).
+	 * @throws SQLException if the job failed, with the error message
+	 * recorded for it, or there is no such job.
+	 */
+	String result(long jobId) throws SQLException;
+}
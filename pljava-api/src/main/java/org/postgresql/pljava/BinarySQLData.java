@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+package org.postgresql.pljava;
+
+import java.nio.ByteBuffer;
+
+import java.sql.SQLData;
+import java.sql.SQLException;
+import java.sql.SQLFeatureNotSupportedException;
+import java.sql.SQLInput;
+import java.sql.SQLOutput;
+
+/**
+ * A scalar user-defined type whose internal representation is read and
+ * written directly as bytes, rather than through {@code SQLInput} and
+ * {@code SQLOutput}.
+ *<p>
+ * For a class implementing this interface as a scalar UDT (of any internal
+ * length other than -2), PL/Java calls {@link #readBinary readBinary} on a new
+ * instance with a read-only {@code ByteBuffer} over a copy of the stored value,
+ * and obtains a value to store by calling {@link #binaryLength binaryLength}
+ * and then {@link #writeBinary writeBinary} with a {@code ByteBuffer} whose
+ * contents are copied into the stored value when it returns. No stream object
+ * is made per value, and a value may be as long as any varlena. The buffers are
+ * in the default (big-endian) byte order; an implementation may change the
+ * order of the buffer it is given.
+ *<p>
+ * As the buffers are not views of the stored value, retaining one does no
+ * harm, but changes to a buffer passed to {@code writeBinary} have no effect
+ * after that method returns.
+ *<p>
+ * The {@code readSQL} and {@code writeSQL} methods of {@code SQLData} are not
+ * used for such a type, and here have default implementations that throw
+ * {@code SQLFeatureNotSupportedException}.
+ */
+public interface BinarySQLData extends SQLData
+{
+	/**
+	 * Initialize this instance from its internal representation.
+	 * @param source A read-only buffer holding exactly the representation,
+	 * positioned at its start.
+	 * @param typeName The SQL name of the type.
+	 */
+	void readBinary(ByteBuffer source, String typeName) throws SQLException;
+
+	/**
+	 * Return the number of bytes {@link #writeBinary writeBinary} will write;
+	 * called just before it. For a type of fixed internal length, this must be
+	 * that length.
+	 */
+	int binaryLength() throws SQLException;
+
+	/**
+	 * Write the internal representation of this instance.
+	 * @param target A buffer positioned at zero with exactly
+	 * {@link #binaryLength binaryLength()} bytes remaining, all of which must
+	 * be written.
+	 */
+	void writeBinary(ByteBuffer target) throws SQLException;
+
+	@Override
+	default void readSQL(SQLInput stream, String typeName) throws SQLException
+	{
+		throw new SQLFeatureNotSupportedException(
+			"readSQL on a BinarySQLData type", "0A000");
+	}
+
+	@Override
+	default void writeSQL(SQLOutput stream) throws SQLException
+	{
+		throw new SQLFeatureNotSupportedException(
+			"writeSQL on a BinarySQLData type", "0A000");
+	}
+}
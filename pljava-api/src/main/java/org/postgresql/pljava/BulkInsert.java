@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+package org.postgresql.pljava;
+
+import java.sql.SQLException;
+
+/**
+ * Loading of many rows into a table in one statement, from Java arrays holding
+ * the values column by column, available from PL/Java's internal JDBC
+ * connection with {@code unwrap(BulkInsert.class)}.
+ *<p>
+ * Compared to executing an {@code INSERT} once per row, or a batch with one
+ * entry per row, the rows are inserted by a single execution of one statement,
+ * so the executor is started once for them all. As it is an ordinary
+ * {@code INSERT}, the table's triggers, constraints, and indexes are all
+ * maintained as usual.
+ */
+public interface BulkInsert
+{
+	/**
+	 * Insert rows into <var>table</var>, taking the values for the named
+	 * <var>columns</var> from the corresponding Java arrays in
+	 * <var>values</var>, which must all be of the same length, that length
+	 * being the number of rows.
+	 *<p>
+	 * Each array must be of a Java type that PL/Java maps to an array of the
+	 * column's type, such as {@code int[]} for an {@code integer} column or
+	 * {@code String[]} for a {@code text} column. A null element of an array
+	 * of a reference type inserts a null. Columns not named receive their
+	 * defaults.
+	 * @param table Name of the table, optionally schema-qualified, following
+	 * the same rules for case and quoting as names in PL/Java annotations.
+	 * @param columns Names of the columns, following the same rules.
+	 * @param values One array of values per column.
+	 * @return The number of rows inserted.
+	 */
+	long insertColumns(String table, String[] columns, Object... values)
+	throws SQLException;
+}
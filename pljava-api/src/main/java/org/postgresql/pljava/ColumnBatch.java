@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+package org.postgresql.pljava;
+
+import java.sql.ResultSet;
+import java.sql.ResultSetMetaData;
+import java.sql.SQLException;
+import java.sql.SQLNonTransientException;
+
+/**
+ * A batch of rows to be returned from a set-returning function, filled a
+ * column at a time by a {@link ResultSetProvider.Batched}.
+ *<p>
+ * Columns are numbered from 1, as in {@link ResultSet}, and rows within the
+ * batch from 0. Every value in the batch is null until set. A value of a
+ * primitive type set into a column of the corresponding SQL type
+ * ({@code boolean}, {@code smallint}, {@code integer}, {@code bigint},
+ * {@code real}, {@code double precision}) is stored unboxed, and the whole
+ * batch becomes rows of the result without a call into Java for each row.
+ * Other values are converted as they would be by
+ * {@link ResultSet#updateObject(int,Object) updateObject} on the row
+ * receiver of an ordinary {@link ResultSetProvider}.
+ */
+public interface ColumnBatch
+{
+	/**
+	 * The number of rows the batch has room for.
+	 */
+	int getCapacity();
+
+	/**
+	 * The number, names, and types of the columns expected by the caller, as
+	 * for the receiver passed to {@link ResultSetProvider#assignRowValues
+	 * assignRowValues}.
+	 */
+	ResultSetMetaData getMetaData() throws SQLException;
+
+	void setNull(int columnIndex, int row) throws SQLException;
+
+	void setBoolean(int columnIndex, int row, boolean x) throws SQLException;
+
+	void setShort(int columnIndex, int row, short x) throws SQLException;
+
+	void setInt(int columnIndex, int row, int x) throws SQLException;
+
+	void setLong(int columnIndex, int row, long x) throws SQLException;
+
+	void setFloat(int columnIndex, int row, float x) throws SQLException;
+
+	void setDouble(int columnIndex, int row, double x) throws SQLException;
+
+	void setObject(int columnIndex, int row, Object x) throws SQLException;
+
+	/**
+	 * Set the first {@code count} rows of a column from an array.
+	 */
+	default void setInts(int columnIndex, int[] x, int count)
+	throws SQLException
+	{
+		for ( int row = 0 ; row < count ; ++ row )
+			setInt(columnIndex, row, x[row]);
+	}
+
+	/**
+	 * Set the first {@code count} rows of a column from an array.
+	 */
+	default void setLongs(int columnIndex, long[] x, int count)
+	throws SQLException
+	{
+		for ( int row = 0 ; row < count ; ++ row )
+			setLong(columnIndex, row, x[row]);
+	}
+
+	/**
+	 * Set the first {@code count} rows of a column from an array.
+	 */
+	default void setDoubles(int columnIndex, double[] x, int count)
+	throws SQLException
+	{
+		for ( int row = 0 ; row < count ; ++ row )
+			setDouble(columnIndex, row, x[row]);
+	}
+
+	/**
+	 * A batch written by a {@link ResultSetProvider.Writing}, which passes
+	 * its rows on to become rows of the result each time it is flushed.
+	 */
+	interface Writer extends ColumnBatch
+	{
+		/**
+		 * Store rows 0 through <var>n</var>-1 of the batch as the next rows of
+		 * the result, and clear the batch, making all its values null again,
+		 * so it can be written afresh.
+		 *<p>
+		 * Rows stored are held by PostgreSQL, in memory up to
+		 * {@code work_mem} and on disk beyond it, not in Java.
+		 * @param n The number of rows to store, not greater than the batch's
+		 * capacity; zero only clears the batch.
+		 * @throws SQLException if <var>n</var> is out of range, if called
+		 * other than during {@link ResultSetProvider.Writing#writeRows
+		 * writeRows}, or if the rows cannot be stored.
+		 */
+		void flush(int n) throws SQLException;
+	}
+
+	/**
+	 * A batch with room for one row, whose values are stored into
+	 * {@code receiver}; used where rows are still requested one at a time.
+	 */
+	static ColumnBatch forRow(ResultSet receiver)
+	{
+		return new ColumnBatch()
+		{
+			private void check(int row) throws SQLException
+			{
+				if ( 0 != row )
+					throw new SQLNonTransientException(
+						"row " + row + " outside batch of 1 row", "22023");
+			}
+
+			@Override
+			public int getCapacity()
+			{
+				return 1;
+			}
+
+			@Override
+			public ResultSetMetaData getMetaData() throws SQLException
+			{
+				return receiver.getMetaData();
+			}
+
+			@Override
+			public void setNull(int columnIndex, int row)
+			throws SQLException
+			{
+				check(row);
+				receiver.updateNull(columnIndex);
+			}
+
+			@Override
+			public void setBoolean(int columnIndex, int row, boolean x)
+			throws SQLException
+			{
+				check(row);
+				receiver.updateBoolean(columnIndex, x);
+			}
+
+			@Override
+			public void setShort(int columnIndex, int row, short x)
+			throws SQLException
+			{
+				check(row);
+				receiver.updateShort(columnIndex, x);
+			}
+
+			@Override
+			public void setInt(int columnIndex, int row, int x)
+			throws SQLException
+			{
+				check(row);
+				receiver.updateInt(columnIndex, x);
+			}
+
+			@Override
+			public void setLong(int columnIndex, int row, long x)
+			throws SQLException
+			{
+				check(row);
+				receiver.updateLong(columnIndex, x);
+			}
+
+			@Override
+			public void setFloat(int columnIndex, int row, float x)
+			throws SQLException
+			{
+				check(row);
+				receiver.updateFloat(columnIndex, x);
+			}
+
+			@Override
+			public void setDouble(int columnIndex, int row, double x)
+			throws SQLException
+			{
+				check(row);
+				receiver.updateDouble(columnIndex, x);
+			}
+
+			@Override
+			public void setObject(int columnIndex, int row, Object x)
+			throws SQLException
+			{
+				check(row);
+				receiver.updateObject(columnIndex, x);
+			}
+		};
+	}
+}
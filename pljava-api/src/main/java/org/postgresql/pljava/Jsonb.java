@@ -0,0 +1,295 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+package org.postgresql.pljava;
+
+import java.math.BigDecimal;
+
+import java.sql.SQLException;
+
+import java.util.ArrayDeque;
+import java.util.ArrayList;
+import java.util.Deque;
+import java.util.LinkedHashMap;
+import java.util.List;
+import java.util.Map;
+
+/**
+ * A value of the PostgreSQL {@code jsonb} type, available as an alternative to
+ * the default mapping of {@code jsonb} to {@code String}, by declaring a
+ * parameter or result of a function with this type.
+ *<p>
+ * A {@code jsonb} value passed in to a function is a view of the stored binary
+ * form: {@link #get(String) get} and {@link #get(int) get} look up a member or
+ * element natively, without the document being rendered as text or parsed in
+ * Java, and the values found that are themselves objects or arrays are views
+ * of the same form. Such a view is valid only for the duration of the function
+ * call it was passed to; using it later throws an {@code SQLException}. It may
+ * be returned from that call, or from another function it calls, and is then
+ * copied as it stands.
+ *<p>
+ * A value to be returned can be built with a {@link Builder Builder}, and is
+ * then formed into {@code jsonb} natively from the values given, again without
+ * a rendering as text.
+ *<p>
+ * Any other implementation of this interface is converted to {@code jsonb} by
+ * parsing the result of its {@link #toJson toJson} method.
+ */
+public interface Jsonb
+{
+	/**
+	 * The kinds of JSON value.
+	 */
+	enum Kind { OBJECT, ARRAY, STRING, NUMBER, BOOLEAN, NULL }
+
+	/**
+	 * The kind of this value.
+	 */
+	Kind kind();
+
+	/**
+	 * The number of members of an object or elements of an array, or zero for
+	 * a scalar.
+	 */
+	int size() throws SQLException;
+
+	/**
+	 * The keys of an object's members, in the order {@code jsonb} keeps them,
+	 * or an empty list if this value is not an object.
+	 */
+	List<String> keys() throws SQLException;
+
+	/**
+	 * The value of the member of an object with the given key, or Java null if
+	 * there is no such member or this value is not an object.
+	 */
+	Jsonb get(String key) throws SQLException;
+
+	/**
+	 * The element of an array at the given index (from zero), or Java null if
+	 * there is no such element or this value is not an array.
+	 */
+	Jsonb get(int index) throws SQLException;
+
+	/**
+	 * The value found by following a path of keys (each a {@code String}) and
+	 * array indices (each an {@code Integer}) from this value, or Java null if
+	 * any step finds nothing.
+	 */
+	default Jsonb getPath(Object... path) throws SQLException
+	{
+		Jsonb v = this;
+		for ( Object step : path )
+		{
+			if ( step instanceof String )
+				v = v.get((String)step);
+			else if ( step instanceof Integer )
+				v = v.get((Integer)step);
+			else
+				throw new IllegalArgumentException(
+					"a jsonb path step must be a String or an Integer");
+			if ( null == v )
+				return null;
+		}
+		return v;
+	}
+
+	/**
+	 * The value of a JSON string.
+	 * @throws SQLException with SQLState 22023 if this value is not a string.
+	 */
+	String getString() throws SQLException;
+
+	/**
+	 * The value of a JSON number.
+	 * @throws SQLException with SQLState 22023 if this value is not a number.
+	 */
+	BigDecimal getNumber() throws SQLException;
+
+	/**
+	 * The value of a JSON boolean.
+	 * @throws SQLException with SQLState 22023 if this value is not a boolean.
+	 */
+	boolean getBoolean() throws SQLException;
+
+	/**
+	 * Whether this value is the JSON {@code null}.
+	 */
+	default boolean isNull()
+	{
+		return Kind.NULL == kind();
+	}
+
+	/**
+	 * This value rendered as JSON text.
+	 */
+	String toJson() throws SQLException;
+
+	/**
+	 * Return a new {@link Builder Builder}.
+	 */
+	static Builder builder()
+	{
+		return new Builder();
+	}
+
+	/**
+	 * Builds one JSON value, a scalar or an object or array of any depth,
+	 * from a sequence of calls as a streaming writer would take them.
+	 *<p>
+	 * Within an object, each value must be preceded by {@link #key key}. As in
+	 * {@code jsonb}, where an object is given the same key more than once, the
+	 * last value given is the one kept. Misuse of the sequence throws
+	 * {@code IllegalStateException}.
+	 */
+	final class Builder
+	{
+		private final Deque<Object> m_open = new ArrayDeque<>();
+		private String m_key;
+		private Object m_result;
+		private boolean m_done;
+
+		Builder()
+		{
+		}
+
+		public Builder beginObject()
+		{
+			Map<String,Object> m = new LinkedHashMap<>();
+			add(m);
+			m_open.push(m);
+			return this;
+		}
+
+		public Builder endObject()
+		{
+			if ( ! ( m_open.peek() instanceof Map )  ||  null != m_key )
+				throw new IllegalStateException(
+					"endObject without a matching beginObject");
+			m_open.pop();
+			return this;
+		}
+
+		public Builder beginArray()
+		{
+			List<Object> l = new ArrayList<>();
+			add(l);
+			m_open.push(l);
+			return this;
+		}
+
+		public Builder endArray()
+		{
+			if ( ! ( m_open.peek() instanceof List ) )
+				throw new IllegalStateException(
+					"endArray without a matching beginArray");
+			m_open.pop();
+			return this;
+		}
+
+		public Builder key(String key)
+		{
+			if ( ! ( m_open.peek() instanceof Map )  ||  null != m_key )
+				throw new IllegalStateException(
+					"key given other than before a value in an object");
+			if ( null == key )
+				throw new NullPointerException("a jsonb key may not be null");
+			m_key = key;
+			return this;
+		}
+
+		/**
+		 * Add a string, or the JSON null if <var>value</var> is null.
+		 */
+		public Builder value(String value)
+		{
+			add(null == value ? JsonbTree.NULL : value);
+			return this;
+		}
+
+		/**
+		 * Add a number, or the JSON null if <var>value</var> is null.
+		 */
+		public Builder value(BigDecimal value)
+		{
+			add(null == value ? JsonbTree.NULL : value);
+			return this;
+		}
+
+		public Builder value(long value)
+		{
+			add(BigDecimal.valueOf(value));
+			return this;
+		}
+
+		/**
+		 * Add a number.
+		 * @throws IllegalArgumentException if <var>value</var> is infinite or
+		 * NaN, which JSON cannot represent.
+		 */
+		public Builder value(double value)
+		{
+			if ( Double.isNaN(value)  ||  Double.isInfinite(value) )
+				throw new IllegalArgumentException(
+					"JSON cannot represent the number " + value);
+			add(BigDecimal.valueOf(value));
+			return this;
+		}
+
+		public Builder value(boolean value)
+		{
+			add(value);
+			return this;
+		}
+
+		public Builder nullValue()
+		{
+			add(JsonbTree.NULL);
+			return this;
+		}
+
+		/**
+		 * Return the value built, once every object and array begun has been
+		 * ended.
+		 */
+		public Jsonb build()
+		{
+			if ( ! m_done  ||  ! m_open.isEmpty() )
+				throw new IllegalStateException(
+					"jsonb value not complete");
+			return JsonbTree.of(m_result);
+		}
+
+		@SuppressWarnings("unchecked")
+		private void add(Object value)
+		{
+			Object container = m_open.peek();
+			if ( null == container )
+			{
+				if ( m_done )
+					throw new IllegalStateException(
+						"more than one jsonb value given to a builder");
+				m_result = value;
+				m_done = true;
+			}
+			else if ( container instanceof Map )
+			{
+				if ( null == m_key )
+					throw new IllegalStateException(
+						"value in an object not preceded by its key");
+				((Map<String,Object>)container).put(m_key, value);
+				m_key = null;
+			}
+			else
+				((List<Object>)container).add(value);
+		}
+	}
+}
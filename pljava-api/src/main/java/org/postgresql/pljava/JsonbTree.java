@@ -0,0 +1,277 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+package org.postgresql.pljava;
+
+import java.io.ByteArrayOutputStream;
+import java.io.DataOutputStream;
+import java.io.IOException;
+import java.io.UncheckedIOException;
+
+import java.math.BigDecimal;
+
+import static java.nio.charset.StandardCharsets.US_ASCII;
+import static java.nio.charset.StandardCharsets.UTF_8;
+
+import java.sql.SQLDataException;
+import java.sql.SQLException;
+
+import java.util.ArrayList;
+import java.util.Collections;
+import java.util.List;
+import java.util.Map;
+
+/**
+ * The {@link Jsonb} made by a {@link Jsonb.Builder}, over a tree of
+ * {@code Map}, {@code List}, {@code String}, {@code BigDecimal}, and
+ * {@code Boolean} values, with {@link #NULL} for the JSON null.
+ *<p>
+ * PL/Java's native code obtains the value to store from {@link #encoded},
+ * a compact stream of tokens it forms into {@code jsonb} in one pass: one of
+ * {@code { } [ ]} for the start or end of an object or array, {@code k} or
+ * {@code s} followed by a four-byte length and that many bytes of UTF-8 for a
+ * key or a string, {@code n} followed likewise by the decimal digits of a
+ * number, or {@code t}, {@code f}, or {@code z} for true, false, or null.
+ * Lengths are big-endian.
+ */
+final class JsonbTree implements Jsonb
+{
+	static final Object NULL = new Object();
+
+	private final Object m_value;
+
+	private JsonbTree(Object value)
+	{
+		m_value = value;
+	}
+
+	static Jsonb of(Object value)
+	{
+		return new JsonbTree(value);
+	}
+
+	@Override
+	public Kind kind()
+	{
+		if ( m_value instanceof Map )
+			return Kind.OBJECT;
+		if ( m_value instanceof List )
+			return Kind.ARRAY;
+		if ( m_value instanceof String )
+			return Kind.STRING;
+		if ( m_value instanceof BigDecimal )
+			return Kind.NUMBER;
+		if ( m_value instanceof Boolean )
+			return Kind.BOOLEAN;
+		return Kind.NULL;
+	}
+
+	@Override
+	public int size()
+	{
+		if ( m_value instanceof Map )
+			return ((Map<?,?>)m_value).size();
+		if ( m_value instanceof List )
+			return ((List<?>)m_value).size();
+		return 0;
+	}
+
+	@Override
+	public List<String> keys()
+	{
+		if ( ! ( m_value instanceof Map ) )
+			return Collections.emptyList();
+		List<String> keys = new ArrayList<>();
+		for ( Object k : ((Map<?,?>)m_value).keySet() )
+			keys.add((String)k);
+		return Collections.unmodifiableList(keys);
+	}
+
+	@Override
+	public Jsonb get(String key)
+	{
+		if ( ! ( m_value instanceof Map ) )
+			return null;
+		Object v = ((Map<?,?>)m_value).get(key);
+		return null == v ? null : new JsonbTree(v);
+	}
+
+	@Override
+	public Jsonb get(int index)
+	{
+		if ( ! ( m_value instanceof List ) )
+			return null;
+		List<?> l = (List<?>)m_value;
+		if ( 0 > index  ||  index >= l.size() )
+			return null;
+		return new JsonbTree(l.get(index));
+	}
+
+	@Override
+	public String getString() throws SQLException
+	{
+		return scalar(String.class);
+	}
+
+	@Override
+	public BigDecimal getNumber() throws SQLException
+	{
+		return scalar(BigDecimal.class);
+	}
+
+	@Override
+	public boolean getBoolean() throws SQLException
+	{
+		return scalar(Boolean.class);
+	}
+
+	private <T> T scalar(Class<T> c) throws SQLException
+	{
+		if ( c.isInstance(m_value) )
+			return c.cast(m_value);
+		throw new SQLDataException(
+			"jsonb " + kind() + " value is not a " + c.getSimpleName(),
+			"22023");
+	}
+
+	@Override
+	public String toJson()
+	{
+		StringBuilder sb = new StringBuilder();
+		render(sb, m_value);
+		return sb.toString();
+	}
+
+	@Override
+	public String toString()
+	{
+		return toJson();
+	}
+
+	private static void render(StringBuilder sb, Object v)
+	{
+		if ( v instanceof Map )
+		{
+			String sep = "";
+			sb.append('{');
+			for ( Map.Entry<?,?> e : ((Map<?,?>)v).entrySet() )
+			{
+				sb.append(sep);
+				quote(sb, (String)e.getKey());
+				sb.append(": ");
+				render(sb, e.getValue());
+				sep = ", ";
+			}
+			sb.append('}');
+		}
+		else if ( v instanceof List )
+		{
+			String sep = "";
+			sb.append('[');
+			for ( Object e : (List<?>)v )
+			{
+				sb.append(sep);
+				render(sb, e);
+				sep = ", ";
+			}
+			sb.append(']');
+		}
+		else if ( v instanceof String )
+			quote(sb, (String)v);
+		else if ( v instanceof BigDecimal )
+			sb.append(((BigDecimal)v).toString());
+		else if ( v instanceof Boolean )
+			sb.append(v.toString());
+		else
+			sb.append("null");
+	}
+
+	private static void quote(StringBuilder sb, String s)
+	{
+		sb.append('"');
+		for ( int i = 0, n = s.length() ; i < n ; ++ i )
+		{
+			char c = s.charAt(i);
+			switch ( c )
+			{
+			case '"':  sb.append("\\\""); break;
+			case '\\': sb.append("\\\\"); break;
+			case '\b': sb.append("\\b");  break;
+			case '\f': sb.append("\\f");  break;
+			case '\n': sb.append("\\n");  break;
+			case '\r': sb.append("\\r");  break;
+			case '\t': sb.append("\\t");  break;
+			default:
+				if ( c < 0x20 )
+					sb.append(String.format("\\u%04x", (int)c));
+				else
+					sb.append(c);
+			}
+		}
+		sb.append('"');
+	}
+
+	/**
+	 * The value as the stream of tokens described above; called from
+	 * PL/Java's native code.
+	 */
+	private byte[] encoded()
+	{
+		ByteArrayOutputStream bos = new ByteArrayOutputStream();
+		try ( DataOutputStream out = new DataOutputStream(bos) )
+		{
+			encode(out, m_value);
+		}
+		catch ( IOException e )
+		{
+			throw new UncheckedIOException(e); /* not from a byte array */
+		}
+		return bos.toByteArray();
+	}
+
+	private static void encode(DataOutputStream out, Object v)
+	throws IOException
+	{
+		if ( v instanceof Map )
+		{
+			out.writeByte('{');
+			for ( Map.Entry<?,?> e : ((Map<?,?>)v).entrySet() )
+			{
+				token(out, 'k', ((String)e.getKey()).getBytes(UTF_8));
+				encode(out, e.getValue());
+			}
+			out.writeByte('}');
+		}
+		else if ( v instanceof List )
+		{
+			out.writeByte('[');
+			for ( Object e : (List<?>)v )
+				encode(out, e);
+			out.writeByte(']');
+		}
+		else if ( v instanceof String )
+			token(out, 's', ((String)v).getBytes(UTF_8));
+		else if ( v instanceof BigDecimal )
+			token(out, 'n', ((BigDecimal)v).toString().getBytes(US_ASCII));
+		else if ( v instanceof Boolean )
+			out.writeByte((Boolean)v ? 't' : 'f');
+		else
+			out.writeByte('z');
+	}
+
+	private static void token(DataOutputStream out, char kind, byte[] bytes)
+	throws IOException
+	{
+		out.writeByte(kind);
+		out.writeInt(bytes.length);
+		out.write(bytes);
+	}
+}
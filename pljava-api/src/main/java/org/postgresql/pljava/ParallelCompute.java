@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+package org.postgresql.pljava;
+
+import java.sql.SQLException;
+
+import java.util.Collection;
+import java.util.List;
+import java.util.concurrent.Callable;
+import java.util.concurrent.Future;
+
+/**
+ * Runs pure-Java computation on worker threads, for a function that can use
+ * more than one core, obtained from {@link Session#parallelCompute()}.
+ *<p>
+ * The worker threads are shared by the session, but the tasks given to an
+ * instance belong to the invocation of the function that obtained it: when
+ * that invocation returns to PostgreSQL, any of its tasks not yet started are
+ * cancelled, and the return waits for any still running to finish, unless the
+ * query is cancelled (or the session terminated) meanwhile; then the running
+ * tasks are interrupted and no longer waited for. A task may
+ * not call into PostgreSQL, which includes using the internal JDBC connection;
+ * an attempt throws {@code IllegalStateException} in the task. Results should
+ * be gathered, and any database work done with them, on the thread that called
+ * the function.
+ *<p>
+ * A task runs with the permissions and the context class loader of the code
+ * that submitted it.
+ *<p>
+ * The number of worker threads is set by {@code pljava.compute_parallelism}.
+ */
+public interface ParallelCompute
+{
+	/**
+	 * Start a task on a worker thread.
+	 * @param task The computation, which must not call into PostgreSQL.
+	 * @return A {@code Future} for its result.
+	 */
+	<T> Future<T> submit(Callable<T> task);
+
+	/**
+	 * Run tasks on worker threads, returning their results, in order, once
+	 * all have finished.
+	 * @param tasks The computations, which must not call into PostgreSQL.
+	 * @return The results.
+	 * @throws SQLException if any task threw an exception (the first such
+	 * exception being the cause), or the waiting thread was interrupted.
+	 */
+	<T> List<T> invokeAll(Collection<? extends Callable<T>> tasks)
+	throws SQLException;
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+package org.postgresql.pljava;
+
+import java.sql.SQLException;
+
+/**
+ * Control over how PostgreSQL plans a {@link java.sql.PreparedStatement}
+ * obtained from PL/Java's internal JDBC connection, which can be reached with
+ * {@code unwrap(PlanControl.class)} on the statement.
+ *<p>
+ * By default, PostgreSQL chooses for itself, over repeated executions,
+ * between custom plans made for each execution's parameter values and one
+ * generic plan reused for any values. A statement whose best plan depends
+ * strongly on its parameter values may be better always planned with them,
+ * and one executed often with a cheap generic plan may be better never
+ * replanned.
+ */
+public interface PlanControl
+{
+	/**
+	 * The choices of planning mode.
+	 */
+	enum PlanMode
+	{
+		/** Let PostgreSQL choose between custom and generic plans. */
+		DEFAULT,
+		/** Always use a generic plan, made without the parameter values. */
+		GENERIC,
+		/** Always make a custom plan for each execution's parameter values. */
+		CUSTOM
+	}
+
+	/**
+	 * Set the planning mode, taking effect at the statement's next execution.
+	 */
+	void setPlanMode(PlanMode mode) throws SQLException;
+
+	/**
+	 * Return the planning mode.
+	 */
+	PlanMode getPlanMode() throws SQLException;
+}
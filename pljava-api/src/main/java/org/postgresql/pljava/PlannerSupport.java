@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+package org.postgresql.pljava;
+
+import java.sql.SQLException;
+
+/**
+ * Estimates and simplifications offered to the PostgreSQL planner (in
+ * PostgreSQL 12 and later) for calls of a PL/Java function, which names a
+ * class implementing this interface in the
+ * {@link org.postgresql.pljava.annotation.Function#support support} element
+ * of its annotation.
+ *<p>
+ * The class must have a public constructor with no parameters. One instance is
+ * made when the function is first resolved, and may be asked about any number
+ * of calls as queries are planned. Each method receives the
+ * {@link Arguments Arguments} of the call being planned, some of which may be
+ * known constants, and may decline to answer, leaving the planner to use what
+ * the function's declaration says.
+ */
+public interface PlannerSupport
+{
+	/**
+	 * The argument expressions of a call being planned.
+	 */
+	interface Arguments
+	{
+		/**
+		 * The number of arguments.
+		 */
+		int size();
+
+		/**
+		 * Whether the argument at <var>index</var> (from zero) is a constant
+		 * in the query, whose value {@link #get get} will return.
+		 */
+		boolean isConstant(int index);
+
+		/**
+		 * The value of the argument at <var>index</var> (from zero), as a
+		 * parameter of the function would receive it, if it is a constant;
+		 * null for a null constant, or an argument that is not constant.
+		 */
+		Object get(int index);
+	}
+
+	/**
+	 * Estimated number of rows a call of a set-returning function will return,
+	 * or a negative value (as by default) for no estimate, leaving the one in
+	 * the function's declaration.
+	 */
+	default double rows(Arguments args) throws SQLException
+	{
+		return -1;
+	}
+
+	/**
+	 * Estimated cost of one call, in units of {@code cpu_operator_cost}
+	 * as for the function's declared {@code COST}, or a negative value (as by
+	 * default) for no estimate, leaving the one in the declaration.
+	 */
+	default double cost(Arguments args) throws SQLException
+	{
+		return -1;
+	}
+
+	/**
+	 * A simpler form for the call: a value (null for SQL null) that the call
+	 * will certainly return, to be used as a constant in its place, or
+	 * {@link #NOT_SIMPLIFIED} (as by default) to leave the call as it is.
+	 *<p>
+	 * PostgreSQL already replaces a call of an {@code IMMUTABLE} function whose
+	 * arguments are all constants by its result, so this is for cases it
+	 * cannot see, such as a call whose result is known from only some of its
+	 * arguments.
+	 */
+	default Object simplify(Arguments args) throws SQLException
+	{
+		return NOT_SIMPLIFIED;
+	}
+
+	/**
+	 * Returned by {@link #simplify simplify} to leave a call unchanged.
+	 */
+	Object NOT_SIMPLIFIED = new Object();
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+package org.postgresql.pljava;
+
+import java.time.Instant;
+import java.time.LocalDate;
+import java.time.LocalDateTime;
+import java.time.OffsetDateTime;
+import java.time.ZoneOffset;
+
+/**
+ * Conversions between the {@code java.time} classes and the raw values
+ * PostgreSQL keeps for {@code timestamp}, {@code timestamptz}, and
+ * {@code date}.
+ *<p>
+ * A function parameter or return declared as {@code long} (or {@code long[]})
+ * for a PostgreSQL {@code timestamp} or {@code timestamp with time zone}, or
+ * as {@code int} (or {@code int[]}) for a {@code date}, receives or supplies
+ * the value PostgreSQL stores, without making any Java object of it: for a
+ * timestamp, the microseconds from the start of 1 January 2000 (UTC, for
+ * {@code timestamptz}); for a date, the days from 1 January 2000. The same is
+ * true of {@code ResultSet.getObject(..., Long.class)} or
+ * {@code Integer.class} on such a column. A function handling many such values
+ * can compare and do arithmetic on them in that form, and use these methods to
+ * make a {@code java.time} object only of a value it needs as one.
+ *<p>
+ * The conversions are exactly those PL/Java makes when mapping the types to
+ * {@code java.time} classes, so a value converted here equals the one
+ * {@code getObject} would have produced, and that includes the values mapped
+ * from PostgreSQL {@code infinity} and {@code -infinity}, which are
+ * {@code Long.MAX_VALUE} and {@code Long.MIN_VALUE} for a timestamp,
+ * {@code Integer.MAX_VALUE} and {@code Integer.MIN_VALUE} for a date.
+ *<p>
+ * The raw form of a timestamp is only available in a PostgreSQL built with
+ * {@code integer_datetimes}, the only choice since PostgreSQL 10.
+ */
+public final class RawDateTime
+{
+	private RawDateTime() { }
+
+	/**
+	 * Seconds from the Java epoch (1970) to the PostgreSQL epoch (2000).
+	 */
+	private static final long EPOCH_DIFF = 946684800L;
+
+	/**
+	 * Days from the Java epoch (1970) to the PostgreSQL epoch (2000).
+	 */
+	private static final int EPOCH_DIFF_DAYS = 10957;
+
+	/**
+	 * Raw value of a PostgreSQL {@code timestamp} as a {@code LocalDateTime}.
+	 */
+	public static LocalDateTime toLocalDateTime(long micros)
+	{
+		return LocalDateTime.ofEpochSecond(
+			EPOCH_DIFF + Math.floorDiv(micros, 1000000L),
+			1000 * (int)Math.floorMod(micros, 1000000L), ZoneOffset.UTC);
+	}
+
+	/**
+	 * Raw value of a PostgreSQL {@code timestamptz} as an
+	 * {@code OffsetDateTime}, always with offset zero (UTC).
+	 */
+	public static OffsetDateTime toOffsetDateTime(long micros)
+	{
+		return OffsetDateTime.of(toLocalDateTime(micros), ZoneOffset.UTC);
+	}
+
+	/**
+	 * Raw value of a PostgreSQL {@code timestamptz} as an {@code Instant}.
+	 */
+	public static Instant toInstant(long micros)
+	{
+		return Instant.ofEpochSecond(
+			EPOCH_DIFF + Math.floorDiv(micros, 1000000L),
+			1000 * Math.floorMod(micros, 1000000L));
+	}
+
+	/**
+	 * Raw value of a PostgreSQL {@code date} as a {@code LocalDate}.
+	 */
+	public static LocalDate toLocalDate(int days)
+	{
+		return LocalDate.ofEpochDay((long)EPOCH_DIFF_DAYS + days);
+	}
+
+	/**
+	 * Raw PostgreSQL {@code timestamp} value for a {@code LocalDateTime}.
+	 * Precision beyond microseconds is truncated.
+	 */
+	public static long fromLocalDateTime(LocalDateTime t)
+	{
+		return raw(t.toEpochSecond(ZoneOffset.UTC), t.getNano());
+	}
+
+	/**
+	 * Raw PostgreSQL {@code timestamptz} value for an {@code OffsetDateTime}
+	 * (of any offset). Precision beyond microseconds is truncated.
+	 */
+	public static long fromOffsetDateTime(OffsetDateTime t)
+	{
+		return raw(t.toEpochSecond(), t.getNano());
+	}
+
+	/**
+	 * Raw PostgreSQL {@code timestamptz} value for an {@code Instant}.
+	 * Precision beyond microseconds is truncated.
+	 */
+	public static long fromInstant(Instant t)
+	{
+		return raw(t.getEpochSecond(), t.getNano());
+	}
+
+	/**
+	 * Raw PostgreSQL {@code date} value for a {@code LocalDate}.
+	 */
+	public static int fromLocalDate(LocalDate d)
+	{
+		return (int)(d.toEpochDay() - EPOCH_DIFF_DAYS);
+	}
+
+	private static long raw(long epochSecond, int nanos)
+	{
+		return 1000000L * (epochSecond - EPOCH_DIFF) + nanos / 1000;
+	}
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+package org.postgresql.pljava;
+
+import java.sql.ResultSet;
+import java.sql.SQLException;
+
+/**
+ * Read-only lookups of rows in a table by equality on some of its columns,
+ * made with the table's (or an index's) access method directly, rather than by
+ * planning and executing a query; available from PL/Java's internal JDBC
+ * connection with {@code unwrap(RelationScan.class)}.
+ *<p>
+ * A lookup in a tight loop then costs no executor startup per call. In
+ * exchange, no SQL-level processing happens: rows are read under the current
+ * snapshot as they are stored, with no rules or inheritance. Only an ordinary
+ * table or a materialized view can be read this way, not a view or a
+ * partitioned or foreign table. Each {@link Lookup#find find} checks that the
+ * current user may {@code SELECT} the whole table, and refuses a table with
+ * row-level security in force for that user, whose policies it cannot apply;
+ * such a table must be read with a query.
+ * All matching rows of one {@link Lookup#find find} are read before it returns,
+ * so it suits lookups that match few rows.
+ */
+public interface RelationScan
+{
+	/**
+	 * Prepare lookups of the rows of <var>table</var> whose leading key
+	 * columns of the btree or hash <var>index</var> equal given keys.
+	 * @param table Name of the table, optionally schema-qualified, following
+	 * the same rules for case and quoting as names in PL/Java annotations.
+	 * @param index Name of an index of the table, following the same rules,
+	 * but never schema-qualified, as an index is in its table's schema.
+	 */
+	Lookup prepareIndexLookup(String table, String index)
+	throws SQLException;
+
+	/**
+	 * Prepare lookups of the rows of <var>table</var> whose named
+	 * <var>columns</var> equal given keys, by reading the whole table.
+	 * @param table Name of the table, as for
+	 * {@link #prepareIndexLookup prepareIndexLookup}.
+	 * @param columns Names of the columns, following the same rules.
+	 */
+	Lookup prepareTableScan(String table, String... columns)
+	throws SQLException;
+
+	/**
+	 * A lookup prepared in a {@code RelationScan}, to be made repeatedly for
+	 * different keys.
+	 */
+	interface Lookup
+	{
+		/**
+		 * Set the most rows one {@link #find find} will return, or zero
+		 * (the default) for no limit.
+		 */
+		void setMaxRows(int maxRows) throws SQLException;
+
+		/**
+		 * Return a read-only, forward-only {@code ResultSet} of the rows whose
+		 * key columns equal <var>keys</var>, given in the order of the index
+		 * key columns or of the columns named when the lookup was prepared.
+		 *<p>
+		 * For an index lookup, fewer keys than the index has key columns may be
+		 * given, for a btree index, to match on just the leading columns. A null
+		 * key, as in SQL, matches no row.
+		 */
+		ResultSet find(Object... keys) throws SQLException;
+	}
+}
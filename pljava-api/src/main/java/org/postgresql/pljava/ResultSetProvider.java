@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2004-2020 Tada AB and other contributors, as listed below.
+ * Copyright (c) 2004-2026 Tada AB and other contributors, as listed below.
  *
  * All rights reserved. This program and the accompanying materials
  * are made available under the terms of the The BSD 3-Clause License
@@ -14,6 +14,7 @@ package org.postgresql.pljava;
 
 import java.sql.ResultSet;
 import java.sql.SQLException;
+import java.sql.SQLFeatureNotSupportedException;
 import java.sql.SQLNonTransientException;
 
 /**
@@ -120,4 +121,90 @@ public interface ResultSetProvider
 			return assignRowValues(receiver, (long)currentRow);
 		}
 	}
+
+	/**
+	 * Version of {@code ResultSetProvider} that supplies rows a batch at a
+	 * time, filling a {@link ColumnBatch} a column at a time.
+	 *<p>
+	 * When the function's result is gathered in one call into a tuplestore
+	 * (see {@code pljava.srf_materialize_rows}), {@code assignBatch} is called
+	 * with a batch of as many rows as that setting, up to an internal limit,
+	 * and the rows of each batch are formed and stored by the native code
+	 * together. Otherwise, rows are still requested one at a time through
+	 * {@code assignRowValues}, which by default calls {@code assignBatch}
+	 * with a batch of one row writing to the receiver.
+	 */
+	interface Batched extends Large
+	{
+		/**
+		 * Fill rows 0 through <var>n</var>-1 of <var>batch</var>, for some
+		 * <var>n</var> not greater than <var>max</var>, and return
+		 * <var>n</var>.
+		 *<p>
+		 * A batch may hold fewer rows than it has room for without ending the
+		 * result; the result ends when this method returns zero.
+		 * @param batch The batch to fill, with all values initially null.
+		 * @param max The most rows that may be filled, never more than the
+		 * batch's capacity.
+		 * @return The number of rows filled, or zero at the end of data.
+		 * @throws SQLException
+		 */
+		int assignBatch(ColumnBatch batch, int max)
+		throws SQLException;
+
+		default boolean assignRowValues(ResultSet receiver, long currentRow)
+		throws SQLException
+		{
+			return 0 < assignBatch(ColumnBatch.forRow(receiver), 1);
+		}
+	}
+
+	/**
+	 * Version of {@code ResultSetProvider} that writes all the rows of its
+	 * result in one call, a batch at a time, into a {@link ColumnBatch.Writer}
+	 * that passes each flushed batch to PostgreSQL to be stored.
+	 *<p>
+	 * The stored rows are kept in a tuplestore, which holds up to
+	 * {@code work_mem} in memory and spills the rest to a temporary file, so a
+	 * result of any size can be produced with no more than one batch of rows
+	 * held in Java at a time. The result is gathered this way whenever the
+	 * calling query allows a function's result to be gathered in one call,
+	 * whatever the setting of {@code pljava.srf_materialize_rows}, which, if
+	 * positive, gives the capacity of the batch, up to an internal limit.
+	 * Where the query does not allow it, {@code assignRowValues} is called
+	 * instead, and by default reports that the function cannot be used there.
+	 */
+	interface Writing extends Large
+	{
+		/**
+		 * Write the rows of the result into <var>writer</var>, calling
+		 * {@link ColumnBatch.Writer#flush flush} each time it is full and once
+		 * more for any rows written after that; rows not flushed before this
+		 * method returns are not part of the result.
+		 *<p>
+		 * Between flushes, this method may do anything an
+		 * {@code assignRowValues} may do, including queries through the
+		 * default connection. The result ends when this method returns.
+		 * @param writer The batch to write into, with all values initially
+		 * null.
+		 * @throws SQLException
+		 */
+		void writeRows(ColumnBatch.Writer writer)
+		throws SQLException;
+
+		@Override
+		default boolean assignRowValues(ResultSet receiver, long currentRow)
+		throws SQLException
+		{
+			throw new SQLFeatureNotSupportedException(
+				getClass().getCanonicalName() + " writes its rows in one " +
+				"call, which this query does not allow", "0A000");
+		}
+
+		@Override
+		default void close()
+		throws SQLException
+		{
+		}
+	}
 }
@@ -72,6 +72,54 @@ public interface Session
 	@Deprecated(since="1.5.3", forRemoval=true)
 	Object getAttribute(String attributeName);
 
+	/**
+	 * Return a {@link ParallelCompute} for running pure-Java computation on
+	 * worker threads, tied to the current invocation of a PL/Java function.
+	 * Repeated calls within one invocation return the same instance.
+	 * @throws SQLException if there is no current invocation.
+	 */
+	ParallelCompute parallelCompute() throws SQLException;
+
+	/**
+	 * Return a {@link BackgroundJobs} for queueing function calls to be made
+	 * by background workers.
+	 */
+	BackgroundJobs backgroundJobs();
+
+	/**
+	 * An action to be run by {@link #runInSubtransaction runInSubtransaction}.
+	 */
+	@FunctionalInterface
+	interface SubtransactionAction<E extends Exception>
+	{
+		void run() throws E;
+	}
+
+	/**
+	 * Run an action in a subtransaction, which is released (committed) if the
+	 * action returns normally, and rolled back if it throws, whereupon the
+	 * exception is thrown on to the caller.
+	 *<p>
+	 * This has the effect of setting a savepoint, and releasing it or rolling
+	 * back to it, but without a {@link java.sql.Savepoint Savepoint} object or
+	 * the bookkeeping that keeps one, so it suits a subtransaction per row of
+	 * some larger work, where an error in one row is to be caught and the work
+	 * continued. Unless a {@link SavepointListener SavepointListener} is
+	 * registered, nothing is done in Java for the subtransaction; if one is,
+	 * the subtransaction is given a {@code Savepoint} for the listener to be
+	 * called with, as {@link Connection#setSavepoint() setSavepoint} would.
+	 *<p>
+	 * A savepoint set during the action and not released by it is released or
+	 * rolled back along with the subtransaction.
+	 * @param action the work to do in the subtransaction
+	 * @throws SQLException if the subtransaction cannot be started, released,
+	 * or rolled back
+	 * @throws E whatever the action throws (after the rollback)
+	 */
+	<E extends Exception> void runInSubtransaction(
+		SubtransactionAction<E> action)
+	throws SQLException, E;
+
 	/**
 	 * Return an object pool for the given class.
 	 * @param cls The class of object to be managed by this pool. It must
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+package org.postgresql.pljava;
+
+import java.sql.SQLException;
+
+/**
+ * Ordering of values of a type for PostgreSQL's sorts and index builds,
+ * offered through the sort support function of a {@code btree} operator
+ * class, optionally with abbreviated keys.
+ *<p>
+ * A class implementing this interface, with a public constructor taking no
+ * parameters, is named in the {@code AS} string of a function declared to take
+ * {@code internal} and return {@code void}:
+ *<pre>
+ * CREATE FUNCTION javatest.complex_sortsupport(internal) RETURNS void
+ *   LANGUAGE java IMMUTABLE
+ *   AS 'sortsupport[com.example.ComplexSort]'
+ *</pre>
+ * which the operator class names as its {@code FUNCTION 2}. It must order
+ * values exactly as the class's {@code FUNCTION 1} comparison does.
+ *<p>
+ * With abbreviated keys, each value being sorted is passed once to
+ * {@link #abbreviate abbreviate}, and most comparisons are made by PostgreSQL
+ * on the {@code long} keys, without calling Java or decoding the values.
+ * Only values whose keys are equal are decoded and passed to
+ * {@link #compare compare}. For a type mapped to an immutable Java class, such
+ * as {@code String}, {@code BigDecimal}, or a UDT annotated
+ * {@code ImmutableUDT}, the most recently decoded values are kept for reuse.
+ * If the keys turn out to distinguish few of the values, PostgreSQL
+ * stops using them and compares every pair with {@code compare}.
+ * @param <T> the Java type mapping the sorted SQL type
+ */
+public interface SortSupport<T>
+{
+	/**
+	 * Compare two (non-null) values, returning a negative number, zero, or a
+	 * positive number as <var>a</var> sorts before, with, or after
+	 * <var>b</var>.
+	 */
+	int compare(T a, T b) throws SQLException;
+
+	/**
+	 * Whether {@link #abbreviate abbreviate} is implemented; false by default.
+	 */
+	default boolean abbreviates()
+	{
+		return false;
+	}
+
+	/**
+	 * An abbreviated key for <var>value</var>, such that when the key of
+	 * <var>a</var> is less (as a signed {@code long}) than that of
+	 * <var>b</var>, {@code compare(a, b)} is certainly negative. Values whose
+	 * keys are equal may compare either way.
+	 */
+	default long abbreviate(T value) throws SQLException
+	{
+		throw new UnsupportedOperationException(
+			getClass().getName() + " does not abbreviate keys");
+	}
+}
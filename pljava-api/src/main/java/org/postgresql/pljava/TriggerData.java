@@ -55,6 +55,47 @@ public interface TriggerData
 	 */
 	ResultSet getOld() throws SQLException;
 
+	/**
+	 * Returns a ResultSet over the rows of the old transition table, for a
+	 * trigger declared with {@code REFERENCING OLD TABLE} (as by
+	 * {@code tableOld} in the {@code Trigger} annotation), or null for any
+	 * other trigger or if the event does not populate the table. The rows are
+	 * fetched from the transition table as the set is read, so
+	 * a statement-level trigger can process every row affected by the
+	 * statement in one call, without holding them all in Java at once:
+	 *<pre>
+	 * try ( ResultSet rs = td.getOldTable() )
+	 * {
+	 *     while ( rs.next() )
+	 *         ...
+	 * }
+	 *</pre>
+	 *<p>
+	 * The returned set is read-only and forward-only, and is obtained through
+	 * the default connection, so it is subject to its fetch size and to
+	 * {@code pljava.spi_fetch_memory} and {@code pljava.spi_columnar_fetch}.
+	 * Closing it also closes the statement it came from. It must not be used
+	 * after the trigger function returns.
+	 *
+	 * @return A read-only <code>ResultSet</code> or <code>null</code>.
+	 * @throws SQLException
+	 *             if the contained native buffer has gone stale.
+	 */
+	ResultSet getOldTable() throws SQLException;
+
+	/**
+	 * Returns a ResultSet over the rows of the new transition table, for a
+	 * trigger declared with {@code REFERENCING NEW TABLE} (as by
+	 * {@code tableNew} in the {@code Trigger} annotation), or null for any
+	 * other trigger or if the event does not populate the table; otherwise as
+	 * for {@link #getOldTable getOldTable}.
+	 *
+	 * @return A read-only <code>ResultSet</code> or <code>null</code>.
+	 * @throws SQLException
+	 *             if the contained native buffer has gone stale.
+	 */
+	ResultSet getNewTable() throws SQLException;
+
 
 	/**
 	 * Returns the arguments for this trigger (as declared in the <code>CREATE TRIGGER</code>
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+package org.postgresql.pljava;
+
+import java.nio.ByteBuffer;
+import java.sql.ResultSet;
+import java.sql.SQLException;
+
+/**
+ * Typed access to the column values of one row, read where PostgreSQL holds
+ * them, without making a Java object of each value.
+ *<p>
+ * An accessor is obtained with {@link ResultSet#unwrap unwrap} from a
+ * {@code ResultSet} of PL/Java's internal connection, or from the
+ * {@code ResultSet} of a trigger's new or old row, and covers the row on
+ * which that result set is positioned when it is obtained. The row is
+ * deformed once, natively, into the same array of values and nulls that a
+ * PostgreSQL {@code TupleTableSlot} holds, and the accessor reads that
+ * array through a direct buffer. A value of a fixed-width type is read
+ * straight from the array as a primitive. A value of a variable-length type,
+ * such as {@code text} or {@code bytea}, is presented by
+ * {@link #getBytes getBytes} as a read-only buffer holding a copy of its
+ * bytes, decompressed or fetched from TOAST storage first only if it is
+ * stored that way, with no conversion to a Java object.
+ *<p>
+ * Columns are numbered from 1, as in {@code ResultSet}. A null value reads as
+ * zero, false, or null; {@link #isNull isNull} tells which values are null.
+ *<p>
+ * The native memory of the accessor is freed by {@link #close close}, or
+ * when the accessor becomes unreachable; reading from the accessor after
+ * {@code close} throws an {@code SQLException}, as does {@code getBytes} on
+ * a row that a result set borrowed from PostgreSQL (see
+ * {@code pljava.spi_borrowed_tuples}) once the result set has moved past
+ * that row's batch. A buffer returned by {@code getBytes} is the caller's
+ * own, and stays valid after the accessor is closed.
+ */
+public interface TupleAccessor extends AutoCloseable
+{
+	/**
+	 * The number of columns in the row.
+	 */
+	int getColumnCount();
+
+	/**
+	 * Whether the value in a column is null.
+	 */
+	boolean isNull(int columnIndex) throws SQLException;
+
+	/**
+	 * The value of a {@code boolean} column.
+	 */
+	boolean getBoolean(int columnIndex) throws SQLException;
+
+	/**
+	 * The value of a {@code smallint} or {@code integer} column, or the raw
+	 * value of a {@code date} column, as described in {@link RawDateTime}.
+	 */
+	int getInt(int columnIndex) throws SQLException;
+
+	/**
+	 * The value of a {@code smallint}, {@code integer}, or {@code bigint}
+	 * column, or the raw value, in microseconds, of a {@code time},
+	 * {@code timestamp}, or {@code timestamp with time zone} column, as
+	 * described in {@link RawDateTime}.
+	 */
+	long getLong(int columnIndex) throws SQLException;
+
+	/**
+	 * The value of a {@code real} or {@code double precision} column.
+	 */
+	double getDouble(int columnIndex) throws SQLException;
+
+	/**
+	 * A read-only buffer holding a copy of the bytes of the value of a column
+	 * of a variable-length type, such as {@code text}, {@code varchar}, or
+	 * {@code bytea}, without its length header.
+	 *<p>
+	 * The bytes of a text value are in the server encoding.
+	 * @return the buffer, or null if the value is null.
+	 */
+	ByteBuffer getBytes(int columnIndex) throws SQLException;
+
+	/**
+	 * Free the accessor's native memory now, rather than when it becomes
+	 * unreachable.
+	 */
+	@Override
+	void close();
+}
@@ -135,6 +135,15 @@ public @interface Aggregate
 		 * except {@code deserialize} (both argument types for {@code combine})
 		 * and also, if there is no {@code finish} function, the result type
 		 * of the aggregate.
+		 *<p>
+		 * With {@code internal} (declared on the Java side as
+		 * {@code Object}, with {@code @SQLType("internal")} on the state
+		 * parameter and {@code type="internal"} on the function), the state
+		 * is any Java object, kept for the whole group as a reference and
+		 * never converted: each call of {@code accumulate} receives the object
+		 * itself along with the new row's values, and can update it in place
+		 * and return it. Such an aggregate can be parallel only if it also has
+		 * {@code serialize} and {@code deserialize} functions.
 		 */
 		String stateType() default "";
 
@@ -244,6 +253,11 @@ public @interface Aggregate
 		 *<p>
 		 * Not allowed in a {@code movingPlan}. Not allowed without
 		 * {@code deserialize}.
+		 *<p>
+		 * With a Java state object, the function can return a
+		 * {@code java.nio.ByteBuffer}, whose remaining bytes are copied
+		 * directly into the {@code bytea}, so it can reuse one buffer rather
+		 * than allocate an exactly-sized {@code byte[]} for each state.
 		 */
 		String[] serialize() default {};
 
@@ -253,6 +267,10 @@ public @interface Aggregate
 		 * also specified.
 		 *<p>
 		 * Not allowed in a {@code movingPlan}.
+		 *<p>
+		 * The function can take the {@code bytea} as a
+		 * {@code java.nio.ByteBuffer}, which is read-only and holds a copy of
+		 * the value, made in one bulk copy.
 		 */
 		String[] deserialize() default {};
 	}
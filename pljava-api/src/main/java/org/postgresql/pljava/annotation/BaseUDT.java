@@ -391,4 +391,18 @@ public @interface BaseUDT
 	 * operate on the new type; nothing happens automatically.
 	 */
 	boolean collatable() default false;
+
+	/**
+	 * If true, two values of the type are equal exactly when their internal
+	 * representations are the same bytes, and an {@code =} operator in the
+	 * type's schema, with a default {@code hash} operator class, will be
+	 * declared for it. Its equality and hash functions are implemented
+	 * natively over the bytes and never call Java, so that hash joins and hash
+	 * aggregation over the type need not decode its values.
+	 *<p>
+	 * The type's {@code writeSQL} must then always produce the same bytes for
+	 * values it considers equal, and no other {@code =} operator should be
+	 * declared for the type.
+	 */
+	boolean binaryEquality() default false;
 }
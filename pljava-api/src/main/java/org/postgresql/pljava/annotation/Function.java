@@ -18,6 +18,8 @@ import java.lang.annotation.Retention;
 import java.lang.annotation.RetentionPolicy;
 import java.lang.annotation.Target;
 
+import org.postgresql.pljava.PlannerSupport;
+
 /**
  * Annotates a Java method for which an SQL function declaration should be
  * generated into the deployment descriptor file.
@@ -145,6 +147,30 @@ category</a>
 	 */
 	int rows() default -1;
 
+	/**
+	 * Number of distinct argument lists whose results PL/Java should remember,
+	 * in the backend, for an {@link Effects#IMMUTABLE IMMUTABLE} function, so
+	 * that a repeated call returns the remembered result without calling Java.
+	 *<p>
+	 * Arguments are compared by their stored bytes, and the least recently used
+	 * entry is dropped when the cache is full. Not available for a function
+	 * returning a set, a composite, or a trigger function. If left unspecified
+	 * (0), no results are remembered.
+	 */
+	int memoize() default 0;
+
+	/**
+	 * A class implementing {@link PlannerSupport PlannerSupport}, to offer the
+	 * planner estimates of rows or cost, or a simpler form, for each call of
+	 * the function as a query is planned.
+	 *<p>
+	 * The generated declaration names {@code sqlj.java_support} as the
+	 * function's {@code SUPPORT} function, which PostgreSQL only allows a
+	 * superuser to do. Appeared in PostgreSQL 12. If left unspecified
+	 * ({@code PlannerSupport.class} itself), there is no support function.
+	 */
+	Class<? extends PlannerSupport> support() default PlannerSupport.class;
+
 	/**
 	 * Defines what should happen when input to the function
 	 * is null. RETURNS_NULL means that if any parameter value is null, Postgres
@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+package org.postgresql.pljava.annotation;
+
+import java.lang.annotation.Documented;
+import java.lang.annotation.ElementType;
+import java.lang.annotation.Retention;
+import java.lang.annotation.RetentionPolicy;
+import java.lang.annotation.Target;
+
+/**
+ * Annotation on a PL/Java UDT class (one mapped by {@link BaseUDT} or
+ * {@link MappedUDT}, or by {@code sqlj.add_type_mapping}) whose instances are
+ * never changed once read from their stored form, allowing PL/Java to decode a
+ * stored value once and pass the same instance again when the same value
+ * recurs.
+ *<p>
+ * When a value of such a type is passed as a parameter to a PL/Java function,
+ * the instance made from it is remembered, for the call site (typically, for
+ * the rest of the query), under a copy of the value's bytes. A later call at
+ * the same call site passing identical bytes, such as a constant argument or a
+ * repeated join key, receives the same instance without {@code readSQL} or
+ * {@code parse} being called again. Only a small number of values, and only
+ * values of modest size, are remembered at each call site.
+ *<p>
+ * Because the instances are shared among calls, neither the function receiving
+ * one nor anything else may change its state. Unlike the other annotations in
+ * this package, this one is retained at run time, where PL/Java looks for it
+ * when the class is registered as the UDT implementation.
+ */
+@Target(ElementType.TYPE) @Retention(RetentionPolicy.RUNTIME) @Documented
+public @interface ImmutableUDT
+{
+}
@@ -40,6 +40,11 @@ import java.lang.annotation.Target;
  * after-row triggers are all queued until the statement completes, and then
  * the function will be invoked for each row that was affected, but will see
  * the complete transition tables on each invocation.
+ *<p>
+ * Besides by name, the function can read the transition tables as result sets
+ * from {@code TriggerData.getOldTable} and {@code getNewTable}; an
+ * after-statement trigger so declared handles all of a statement's rows in
+ * one call, where a row trigger would be called once per row.
  * @author Thomas Hallgren
  */
 @Target({}) @Retention(RetentionPolicy.CLASS) @Documented
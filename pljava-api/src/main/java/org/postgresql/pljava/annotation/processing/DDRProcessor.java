@@ -112,6 +112,7 @@ import static javax.lang.model.util.ElementFilter.methodsIn;
 
 import static javax.tools.Diagnostic.Kind;
 
+import org.postgresql.pljava.PlannerSupport;
 import org.postgresql.pljava.ResultSetHandle;
 import org.postgresql.pljava.ResultSetProvider;
 import org.postgresql.pljava.TriggerData;
@@ -235,8 +236,12 @@ class DDRProcessorImpl
 	
 	// Certain known types that need to be recognized in the processed code
 	//
+	final DeclaredType TY_DOUBLESTREAM;
+	final DeclaredType TY_INTSTREAM;
 	final DeclaredType TY_ITERATOR;
+	final DeclaredType TY_LONGSTREAM;
 	final DeclaredType TY_OBJECT;
+	final DeclaredType TY_PLANNERSUPPORT;
 	final DeclaredType TY_RESULTSET;
 	final DeclaredType TY_RESULTSETPROVIDER;
 	final DeclaredType TY_RESULTSETHANDLE;
@@ -334,8 +339,15 @@ class DDRProcessorImpl
 
 		snippetTiebreaker = reproducible ? new SnippetTiebreaker() : null;
 		
+		TY_DOUBLESTREAM      = declaredTypeForClass(
+			java.util.stream.DoubleStream.class);
+		TY_INTSTREAM         = declaredTypeForClass(
+			java.util.stream.IntStream.class);
 		TY_ITERATOR          = declaredTypeForClass(java.util.Iterator.class);
+		TY_LONGSTREAM        = declaredTypeForClass(
+			java.util.stream.LongStream.class);
 		TY_OBJECT            = declaredTypeForClass(Object.class);
+		TY_PLANNERSUPPORT    = declaredTypeForClass(PlannerSupport.class);
 		TY_RESULTSET         = declaredTypeForClass(java.sql.ResultSet.class);
 		TY_RESULTSETPROVIDER = declaredTypeForClass(ResultSetProvider.class);
 		TY_RESULTSETHANDLE   = declaredTypeForClass(ResultSetHandle.class);
@@ -1913,6 +1925,12 @@ hunt:	for ( ExecutableElement ee : ees )
 		public boolean       leakproof() { return _leakproof; }
 		public int                cost() { return _cost; }
 		public int                rows() { return _rows; }
+		public int             memoize() { return _memoize; }
+		/*
+		 * There is no Class object for a class being compiled; the binary
+		 * name recorded by setSupport is what the processor uses.
+		 */
+		public Class<? extends PlannerSupport> support() { return null; }
 		public String[]       settings() { return _settings; }
 		public String[]       provides() { return _provides; }
 		public String[]       requires() { return _requires; }
@@ -1937,6 +1955,8 @@ hunt:	for ( ExecutableElement ee : ees )
 		public Boolean     _leakproof;
 		int                _cost;
 		int                _rows;
+		int                _memoize;
+		String             _support;
 		public String[]    _settings;
 		public String[]    _provides;
 		public String[]    _requires;
@@ -2003,6 +2023,26 @@ hunt:	for ( ExecutableElement ee : ees )
 				throw new IllegalArgumentException( "rows must be nonnegative");
 		}
 
+		public void setMemoize( Object o, boolean explicit, Element e)
+		{
+			_memoize = ((Integer)o).intValue();
+			if ( _memoize < 0 && explicit )
+				throw new IllegalArgumentException(
+					"memoize must be nonnegative");
+		}
+
+		public void setSupport( Object o, boolean explicit, Element e)
+		{
+			TypeMirror tm = (TypeMirror)o;
+			if ( typu.isSameType( tm, TY_PLANNERSUPPORT) )
+				return;
+			if ( ! typu.isAssignable( tm, TY_PLANNERSUPPORT) )
+				throw new IllegalArgumentException(
+					"support must name a class implementing PlannerSupport");
+			_support = elmu.getBinaryName(
+				(TypeElement)typu.asElement( tm)).toString();
+		}
+
 		public void setTriggers( Object o, boolean explicit, Element e)
 		{
 			AnnotationMirror[] ams = avToArray( o, AnnotationMirror.class);
@@ -2092,6 +2132,11 @@ hunt:	for ( ExecutableElement ee : ees )
 				}
 				checkOutType(MethodShape.ITERATOR);
 			}
+			else if ( null != (setofComponent = primitiveStreamComponent(ret)) )
+			{
+				setof = true;
+				checkOutType(MethodShape.ITERATOR);
+			}
 			else if ( typu.isAssignable( ret, TY_RESULTSETPROVIDER)
 				|| typu.isAssignable( ret, TY_RESULTSETHANDLE) )
 			{
@@ -2121,6 +2166,17 @@ hunt:	for ( ExecutableElement ee : ees )
 					"a function with triggers needs void return and " +
 					"one TriggerData parameter");
 
+			if ( 0 < memoize() )
+			{
+				if ( setof || trigger || complexViaInOut )
+					msg( Kind.ERROR, func,
+						"memoize cannot be specified on a set-returning, " +
+						"composite-returning, or trigger function");
+				else if ( Effects.IMMUTABLE != effects() )
+					msg( Kind.ERROR, func,
+						"memoize can only be specified on an IMMUTABLE function");
+			}
+
 			/*
 			 * Report any unmappable types now that could appear in
 			 * deployStrings (return type or parameter types) ... so that the
@@ -2147,6 +2203,26 @@ hunt:	for ( ExecutableElement ee : ees )
 			return Set.of(this);
 		}
 
+		/**
+		 * For a {@code LongStream}, {@code IntStream}, or {@code DoubleStream}
+		 * return type, which PL/Java accepts for a set-returning function as it
+		 * would an {@code Iterator} of the boxed type, return that boxed type;
+		 * otherwise null.
+		 */
+		TypeMirror primitiveStreamComponent(TypeMirror ret)
+		{
+			if ( typu.isSameType( ret, TY_LONGSTREAM) )
+				return typu.boxedClass( typu.getPrimitiveType( TypeKind.LONG))
+					.asType();
+			if ( typu.isSameType( ret, TY_INTSTREAM) )
+				return typu.boxedClass( typu.getPrimitiveType( TypeKind.INT))
+					.asType();
+			if ( typu.isSameType( ret, TY_DOUBLESTREAM) )
+				return typu.boxedClass(
+					typu.getPrimitiveType( TypeKind.DOUBLE)).asType();
+			return null;
+		}
+
 		void resolveLanguage()
 		{
 			if ( null != _trust  &&  null != _languageIdent )
@@ -2510,9 +2586,18 @@ hunt:	for ( ExecutableElement ee : ees )
 
 		public String[] deployStrings()
 		{
+			String as = makeAS();
+			String prefix = null;
+			if ( 0 < memoize() )
+				prefix = "memoize=" + memoize();
+			if ( null != _support )
+				prefix = ( null == prefix ? "" : prefix + ",") +
+					"support=" + _support;
+			if ( null != prefix )
+				as = "[" + prefix + "]" + as;
 			return deployStrings(
 				qnameFrom(name(), schema()), parameterInfo().collect(toList()),
-				makeAS(), comment());
+				as, comment());
 		}
 
 		/**
@@ -2569,6 +2654,8 @@ hunt:	for ( ExecutableElement ee : ees )
 				sb.append( "\tCOST ").append( cost()).append( '\n');
 			if ( -1 != rows() )
 				sb.append( "\tROWS ").append( rows()).append( '\n');
+			if ( null != _support )
+				sb.append( "\tSUPPORT sqlj.java_support\n");
 			for ( String s : settings() )
 				sb.append( "\tSET ").append( s).append( '\n');
 			sb.append( "\tAS ").append( DDRWriter.eQuote( as));
@@ -2763,7 +2850,9 @@ hunt:	for ( ExecutableElement ee : ees )
 		INPUT("in", null, "pg_catalog.cstring", "pg_catalog.oid", "integer"),
 		OUTPUT("out", "pg_catalog.cstring", (String[])null),
 		RECEIVE("recv", null, "pg_catalog.internal","pg_catalog.oid","integer"),
-		SEND("send", "pg_catalog.bytea", (String[])null);
+		SEND("send", "pg_catalog.bytea", (String[])null),
+		EQUALS("eq", "pg_catalog.bool", (String[])null),
+		HASH("hash", "pg_catalog.int4", (String[])null);
 		BaseUDTFunctionID( String suffix, String ret, String... param)
 		{
 			this.suffix = suffix;
@@ -2782,6 +2871,8 @@ hunt:	for ( ExecutableElement ee : ees )
 		{
 			if ( null != param )
 				return param;
+			if ( EQUALS == this )
+				return new DBType[] { u.qname, u.qname };
 			return new DBType[] { u.qname };
 		}
 		DBType getRet( BaseUDTImpl u)
@@ -2812,6 +2903,7 @@ hunt:	for ( ExecutableElement ee : ees )
 			_variadic = false;
 			_cost = -1;
 			_rows = -1;
+			_memoize = 0;
 			_onNullInput = OnNullInput.CALLED;
 			_security = Security.INVOKER;
 			_effects = Effects.VOLATILE;
@@ -2830,19 +2922,67 @@ hunt:	for ( ExecutableElement ee : ees )
 		@Override
 		public String[] deployStrings()
 		{
-			return deployStrings(
+			String[] fn = deployStrings(
 				qnameFrom(name(), schema()),
 				null, // parameter iterable unused in appendParams below
 				"UDT[" + elmu.getBinaryName(te) + "] " + id.name(),
 				comment());
+
+			String extra;
+			switch ( id )
+			{
+			case EQUALS:
+				extra =
+					"CREATE OPERATOR " + ui.binaryEqualsUnwrapped() + " (" +
+					"\n\tPROCEDURE = " + qnameFrom(name(), schema()) +
+					",\n\tLEFTARG = " + ui.qname +
+					",\n\tRIGHTARG = " + ui.qname +
+					",\n\tCOMMUTATOR = " + ui.binaryEqualsName() +
+					",\n\tRESTRICT = eqsel" +
+					",\n\tJOIN = eqjoinsel" +
+					",\n\tHASHES)";
+				break;
+			case HASH:
+				extra =
+					"CREATE OPERATOR CLASS " + ui.binaryOpclassName() +
+					"\n\tDEFAULT FOR TYPE " + ui.qname + " USING hash AS" +
+					"\n\tOPERATOR 1 " + ui.binaryEqualsUnwrapped() + "," +
+					"\n\tFUNCTION 1 " + qnameFrom(name(), schema()) +
+					"(" + ui.qname + ")";
+				break;
+			default:
+				return fn;
+			}
+			String[] rslt = Arrays.copyOf(fn, 1 + fn.length);
+			rslt[fn.length] = extra;
+			return rslt;
 		}
 
 		@Override
 		public String[] undeployStrings()
 		{
-			return undeployStrings(
+			String[] fn = undeployStrings(
 				qnameFrom(name(), schema()),
 				null); // parameter iterable unused in appendParams below
+
+			String extra;
+			switch ( id )
+			{
+			case EQUALS:
+				extra = "DROP OPERATOR " + ui.binaryEqualsUnwrapped() +
+					" (" + ui.qname + ", " + ui.qname + ")";
+				break;
+			case HASH:
+				extra = "DROP OPERATOR FAMILY " + ui.binaryOpclassName() +
+					" USING hash";
+				break;
+			default:
+				return fn;
+			}
+			String[] rslt = new String [ 1 + fn.length ];
+			rslt[0] = extra;
+			System.arraycopy(fn, 0, rslt, 1, fn.length);
+			return rslt;
 		}
 
 		@Override
@@ -2868,6 +3008,13 @@ hunt:	for ( ExecutableElement ee : ees )
 		{
 			resolveLanguage();
 			recordImplicitTags();
+			if ( BaseUDTFunctionID.EQUALS == id )
+				provideTags().add(new DependTag.Operator(
+					ui.binaryEqualsName(), parameterTypes));
+			else if ( BaseUDTFunctionID.HASH == id )
+				requireTags().add(new DependTag.Operator(
+					ui.binaryEqualsName(),
+					new DBType[] { ui.qname, ui.qname }));
 			recordExplicitTags(_provides, _requires);
 			return Set.of(this);
 		}
@@ -3126,8 +3273,10 @@ hunt:	for ( ExecutableElement ee : ees )
 		public String              element() { return _element; }
 		public char              delimiter() { return _delimiter; }
 		public boolean          collatable() { return _collatable; }
+		public boolean      binaryEquality() { return _binaryEquality; }
 
 		BaseUDTFunctionImpl in, out, recv, send;
+		BaseUDTFunctionImpl eq, hash;
 
 		public String            _typeModifierInput;
 		public String            _typeModifierOutput;
@@ -3143,6 +3292,7 @@ hunt:	for ( ExecutableElement ee : ees )
 		public String            _element;
 		char                     _delimiter;
 		public Boolean           _collatable;
+		public Boolean           _binaryEquality;
 
 		boolean lengthExplicit;
 		boolean alignmentExplicit;
@@ -3238,6 +3388,56 @@ hunt:	for ( ExecutableElement ee : ees )
 				this, tclass, BaseUDTFunctionID.SEND);
 			putSnippet( null != instanceWriteSQL ? instanceWriteSQL : send,
 				send);
+
+			if ( binaryEquality() )
+			{
+				eq = new BaseUDTFunctionImpl(
+					this, tclass, BaseUDTFunctionID.EQUALS);
+				hash = new BaseUDTFunctionImpl(
+					this, tclass, BaseUDTFunctionID.HASH);
+				/*
+				 * These also provide the type's own tags, so that whatever
+				 * requires the type will find its = operator in place too.
+				 */
+				for ( BaseUDTFunctionImpl f : List.of(eq, hash) )
+				{
+					f._provides = provides();
+					f._effects = Effects.IMMUTABLE;
+					f._onNullInput = OnNullInput.RETURNS_NULL;
+					f._parallel = Parallel.SAFE;
+					putSnippet( f, f);
+				}
+			}
+		}
+
+		/**
+		 * The {@code =} operator declared for a type with
+		 * {@code binaryEquality}, in the type's schema.
+		 */
+		Identifier.Qualified<Identifier.Operator> binaryEqualsName()
+		{
+			return operatorNameFrom(new String[] { schema(), "=" });
+		}
+
+		/**
+		 * The same, unwrapped, as needed in {@code CREATE} or
+		 * {@code DROP OPERATOR}.
+		 */
+		String binaryEqualsUnwrapped()
+		{
+			Identifier.Simple qualifier = binaryEqualsName().qualifier();
+			return null == qualifier ? "=" : qualifier + ".=";
+		}
+
+		/**
+		 * The {@code hash} operator class declared for a type with
+		 * {@code binaryEquality}.
+		 */
+		Identifier.Qualified<Identifier.Simple> binaryOpclassName()
+		{
+			return qnameFrom(
+				Identifier.Simple.fromJava(name())
+				.concat("_", "binary_ops").toString(), schema());
 		}
 
 		public Set<Snippet> characterize()
@@ -5543,12 +5743,15 @@ hunt:	for ( ExecutableElement ee : ees )
 			this.addMap(Time.class, "pg_catalog", "time");
 			this.addMap(java.sql.Date.class, "pg_catalog", "date");
 			this.addMap(java.sql.SQLXML.class, "pg_catalog", "xml");
+			this.addMap(org.postgresql.pljava.Jsonb.class,
+				"pg_catalog", "jsonb");
 			this.addMap(BigInteger.class, "pg_catalog", "numeric");
 			this.addMap(BigDecimal.class, "pg_catalog", "numeric");
 			this.addMap(ResultSet.class, DT_RECORD);
 			this.addMap(Object.class, DT_ANY);
 
 			this.addMap(byte[].class, DT_BYTEA);
+			this.addMap(java.nio.ByteBuffer.class, DT_BYTEA);
 
 			this.addMap(LocalDate.class, "pg_catalog", "date");
 			this.addMap(LocalTime.class, "pg_catalog", "time");
@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+package org.postgresql.pljava.benchmark;
+
+import java.sql.Connection;
+import java.sql.PreparedStatement;
+import java.sql.ResultSet;
+import java.sql.SQLException;
+import java.sql.Statement;
+
+import java.util.concurrent.TimeUnit;
+
+import static java.sql.DriverManager.getConnection;
+
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.BenchmarkMode;
+import org.openjdk.jmh.annotations.Fork;
+import org.openjdk.jmh.annotations.Level;
+import org.openjdk.jmh.annotations.Measurement;
+import org.openjdk.jmh.annotations.Mode;
+import org.openjdk.jmh.annotations.OperationsPerInvocation;
+import org.openjdk.jmh.annotations.OutputTimeUnit;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+import org.openjdk.jmh.annotations.TearDown;
+import org.openjdk.jmh.annotations.Warmup;
+
+/**
+ * Benchmarks of the paths across PL/Java's native boundary, run from a client
+ * against a backend with this module's jar installed (as {@code bench}; see
+ * the developer notes on benchmarks).
+ *<p>
+ * Each benchmark issues one query that makes {@link #N} crossings of the
+ * path it times, and is scored per crossing, so the client round trip is
+ * spread thin. The {@code baseline} benchmark does the same with a built-in
+ * function, to show how much of each score is PostgreSQL's own per-row cost.
+ * Every connection is to a fresh backend, so the first iterations include
+ * starting the JVM; the warmup iterations absorb that.
+ */
+@State(Scope.Thread)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.NANOSECONDS)
+@Warmup(iterations=5, time=2)
+@Measurement(iterations=5, time=2)
+@Fork(1)
+public class Boundary
+{
+	/**
+	 * Crossings made by each query.
+	 */
+	public static final int N = 1000;
+
+	@Param("jdbc:postgresql://localhost/postgres")
+	public String url;
+
+	@Param("")
+	public String user;
+
+	@Param("")
+	public String password;
+
+	private Connection m_conn;
+
+	private PreparedStatement m_baseline;
+	private PreparedStatement m_int;
+	private PreparedStatement m_text;
+	private PreparedStatement m_numeric;
+	private PreparedStatement m_timestamp;
+	private PreparedStatement m_array;
+	private PreparedStatement m_srf;
+	private PreparedStatement m_spiFetch;
+	private PreparedStatement m_prepared;
+	private PreparedStatement m_udt;
+
+	@Setup(Level.Trial)
+	public void connect() throws SQLException
+	{
+		m_conn = user.isEmpty()
+			? getConnection(url) : getConnection(url, user, password);
+
+		try ( Statement s = m_conn.createStatement() )
+		{
+			s.execute(
+				"CREATE TEMPORARY TABLE pairs AS" +
+				" SELECT CAST('(' || g || ',1)' AS bench.pair) AS p" +
+				" FROM generate_series(1, " + N + ") AS g");
+			s.execute(
+				"CREATE TEMPORARY TABLE arrays AS" +
+				" SELECT array_agg(g) AS a" +
+				" FROM generate_series(1, " + N + ") AS g");
+		}
+
+		m_baseline  = perRow("abs(g)");
+		m_int       = perRow("bench.int_identity(g)");
+		m_text      = perRow("bench.text_identity(CAST(g AS text))");
+		m_numeric   = perRow("bench.numeric_identity(CAST(g AS numeric))");
+		m_timestamp = perRow(
+			"bench.timestamp_identity(" +
+			"CAST('2000-01-01' AS timestamp) + g * interval '1 second')");
+		m_array     = m_conn.prepareStatement(
+			"SELECT bench.int_array_sum(a) FROM arrays");
+		m_srf       = m_conn.prepareStatement(
+			"SELECT count(*) FROM bench.series(" + N + ")");
+		m_spiFetch  = m_conn.prepareStatement(
+			"SELECT bench.spi_fetch(" + N + ")");
+		m_prepared  = m_conn.prepareStatement(
+			"SELECT bench.prepared_execute(" + N + ")");
+		m_udt       = m_conn.prepareStatement(
+			"SELECT count(bench.swap(p)) FROM pairs");
+	}
+
+	@TearDown(Level.Trial)
+	public void disconnect() throws SQLException
+	{
+		m_conn.close();
+	}
+
+	private PreparedStatement perRow(String expression) throws SQLException
+	{
+		return m_conn.prepareStatement(
+			"SELECT count(" + expression + ")" +
+			" FROM generate_series(1, " + N + ") AS g");
+	}
+
+	private static long run(PreparedStatement ps) throws SQLException
+	{
+		try ( ResultSet rs = ps.executeQuery() )
+		{
+			rs.next();
+			return rs.getLong(1);
+		}
+	}
+
+	@Benchmark @OperationsPerInvocation(N)
+	public long baseline() throws SQLException
+	{
+		return run(m_baseline);
+	}
+
+	@Benchmark @OperationsPerInvocation(N)
+	public long scalarInt() throws SQLException
+	{
+		return run(m_int);
+	}
+
+	@Benchmark @OperationsPerInvocation(N)
+	public long scalarText() throws SQLException
+	{
+		return run(m_text);
+	}
+
+	@Benchmark @OperationsPerInvocation(N)
+	public long scalarNumeric() throws SQLException
+	{
+		return run(m_numeric);
+	}
+
+	@Benchmark @OperationsPerInvocation(N)
+	public long scalarTimestamp() throws SQLException
+	{
+		return run(m_timestamp);
+	}
+
+	/**
+	 * Scored per array element coerced.
+	 */
+	@Benchmark @OperationsPerInvocation(N)
+	public long arrayCoercion() throws SQLException
+	{
+		return run(m_array);
+	}
+
+	@Benchmark @OperationsPerInvocation(N)
+	public long srfRows() throws SQLException
+	{
+		return run(m_srf);
+	}
+
+	@Benchmark @OperationsPerInvocation(N)
+	public long spiFetch() throws SQLException
+	{
+		return run(m_spiFetch);
+	}
+
+	@Benchmark @OperationsPerInvocation(N)
+	public long preparedExecute() throws SQLException
+	{
+		return run(m_prepared);
+	}
+
+	/**
+	 * Scored per value read and written back.
+	 */
+	@Benchmark @OperationsPerInvocation(N)
+	public long udtReadWrite() throws SQLException
+	{
+		return run(m_udt);
+	}
+}
@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+package org.postgresql.pljava.benchmark;
+
+import java.math.BigDecimal;
+
+import java.sql.Connection;
+import java.sql.PreparedStatement;
+import java.sql.ResultSet;
+import java.sql.SQLException;
+import java.sql.Statement;
+import java.sql.Timestamp;
+
+import java.util.Iterator;
+import java.util.NoSuchElementException;
+
+import static java.sql.DriverManager.getConnection;
+
+import org.postgresql.pljava.annotation.Function;
+import org.postgresql.pljava.annotation.SQLAction;
+
+import static org.postgresql.pljava.annotation.Function.Effects.IMMUTABLE;
+import static org.postgresql.pljava.annotation.Function.Effects.STABLE;
+import static
+	org.postgresql.pljava.annotation.Function.OnNullInput.RETURNS_NULL;
+
+/**
+ * The functions, run in the backend, whose calls the benchmarks in
+ * {@link Boundary} time.
+ *<p>
+ * Each does as little as it can in Java beyond crossing the boundary the
+ * benchmark is about, so the time per operation is mostly PL/Java's.
+ */
+@SQLAction(provides="bench schema",
+	install="CREATE SCHEMA bench",
+	remove="DROP SCHEMA bench CASCADE"
+)
+public class BoundaryFunctions
+{
+	private BoundaryFunctions() { }
+
+	@Function(schema="bench", name="int_identity", requires="bench schema",
+		effects=IMMUTABLE, onNullInput=RETURNS_NULL)
+	public static int intIdentity(int i)
+	{
+		return i;
+	}
+
+	@Function(schema="bench", name="text_identity", requires="bench schema",
+		effects=IMMUTABLE, onNullInput=RETURNS_NULL)
+	public static String textIdentity(String s)
+	{
+		return s;
+	}
+
+	@Function(schema="bench", name="numeric_identity",
+		requires="bench schema", effects=IMMUTABLE, onNullInput=RETURNS_NULL)
+	public static BigDecimal numericIdentity(BigDecimal n)
+	{
+		return n;
+	}
+
+	@Function(schema="bench", name="timestamp_identity",
+		requires="bench schema", effects=IMMUTABLE, onNullInput=RETURNS_NULL)
+	public static Timestamp timestampIdentity(Timestamp t)
+	{
+		return t;
+	}
+
+	/**
+	 * Sum the elements of an array, timing the coercion of the array.
+	 */
+	@Function(schema="bench", name="int_array_sum", requires="bench schema",
+		effects=IMMUTABLE, onNullInput=RETURNS_NULL)
+	public static long intArraySum(int[] a)
+	{
+		long sum = 0L;
+		for ( int i : a )
+			sum += i;
+		return sum;
+	}
+
+	/**
+	 * Return the integers from 1 to {@code n}, timing the production of rows
+	 * by a set-returning function.
+	 */
+	@Function(schema="bench", name="series", requires="bench schema",
+		effects=IMMUTABLE, onNullInput=RETURNS_NULL)
+	public static Iterator<Integer> series(int n)
+	{
+		return new Iterator<Integer>()
+		{
+			private int m_next = 1;
+
+			@Override
+			public boolean hasNext()
+			{
+				return m_next <= n;
+			}
+
+			@Override
+			public Integer next()
+			{
+				if ( m_next > n )
+					throw new NoSuchElementException();
+				return m_next ++;
+			}
+		};
+	}
+
+	/**
+	 * Fetch {@code n} rows over SPI, returning the sum of their values, timing
+	 * the fetching of a {@code ResultSet}.
+	 */
+	@Function(schema="bench", name="spi_fetch", requires="bench schema",
+		effects=STABLE, onNullInput=RETURNS_NULL)
+	public static long spiFetch(int n) throws SQLException
+	{
+		long sum = 0L;
+		try (
+			Connection c = getConnection("jdbc:default:connection");
+			Statement s = c.createStatement();
+			ResultSet rs = s.executeQuery(
+				"SELECT generate_series(1, " + n + ")")
+		)
+		{
+			while ( rs.next() )
+				sum += rs.getInt(1);
+		}
+		return sum;
+	}
+
+	/**
+	 * Execute a prepared statement {@code n} times, returning the sum of its
+	 * results, timing the execution of a prepared plan.
+	 */
+	@Function(schema="bench", name="prepared_execute", requires="bench schema",
+		effects=STABLE, onNullInput=RETURNS_NULL)
+	public static long preparedExecute(int n) throws SQLException
+	{
+		long sum = 0L;
+		try (
+			Connection c = getConnection("jdbc:default:connection");
+			PreparedStatement ps =
+				c.prepareStatement("SELECT CAST(? AS integer) + 1")
+		)
+		{
+			for ( int i = 0; i < n; ++ i )
+			{
+				ps.setInt(1, i);
+				try ( ResultSet rs = ps.executeQuery() )
+				{
+					rs.next();
+					sum += rs.getInt(1);
+				}
+			}
+		}
+		return sum;
+	}
+}
@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+package org.postgresql.pljava.benchmark;
+
+import java.sql.SQLData;
+import java.sql.SQLException;
+import java.sql.SQLInput;
+import java.sql.SQLOutput;
+
+import org.postgresql.pljava.annotation.BaseUDT;
+import org.postgresql.pljava.annotation.Function;
+import org.postgresql.pljava.annotation.Operator;
+import org.postgresql.pljava.annotation.SQLAction;
+
+import static org.postgresql.pljava.annotation.Operator.SELF;
+
+import static org.postgresql.pljava.annotation.Function.Effects.IMMUTABLE;
+import static
+	org.postgresql.pljava.annotation.Function.OnNullInput.RETURNS_NULL;
+
+/**
+ * A fixed-length base UDT of two {@code float8} values, for timing UDT
+ * values read and written by PL/Java functions.
+ *<p>
+ * Its relational operators and {@code btree} operator class, ordering pairs by
+ * {@code x} and then {@code y}, let a sort of pairs time the calls of a
+ * comparison function in Java.
+ */
+@SQLAction(requires={"bench pair relationals", "bench pair cmp"},
+	provides="bench pair ops",
+	install=
+		"CREATE OPERATOR CLASS bench.pair_ops" +
+		"  DEFAULT FOR TYPE bench.pair USING btree" +
+		" AS" +
+		"  OPERATOR 1 bench.<  ," +
+		"  OPERATOR 2 bench.<= ," +
+		"  OPERATOR 3 bench.=  ," +
+		"  OPERATOR 4 bench.>= ," +
+		"  OPERATOR 5 bench.>  ," +
+		"  FUNCTION 1 bench.pair_cmp(bench.pair,bench.pair)",
+	remove="DROP OPERATOR FAMILY bench.pair_ops USING btree"
+)
+@BaseUDT(schema="bench", name="pair", requires="bench schema",
+	provides="bench pair",
+	internalLength=16, alignment=BaseUDT.Alignment.DOUBLE)
+public class Pair implements SQLData
+{
+	private double m_x;
+	private double m_y;
+	private String m_typeName;
+
+	public Pair()
+	{
+	}
+
+	private Pair(double x, double y, String typeName)
+	{
+		m_x = x;
+		m_y = y;
+		m_typeName = typeName;
+	}
+
+	/**
+	 * Return the pair with its members exchanged, so each call reads one
+	 * value and writes another.
+	 */
+	@Function(schema="bench", requires="bench pair",
+		effects=IMMUTABLE, onNullInput=RETURNS_NULL)
+	public static Pair swap(Pair p)
+	{
+		return new Pair(p.m_y, p.m_x, p.m_typeName);
+	}
+
+	/**
+	 * Compare two pairs by {@code x} and then {@code y}, as the {@code btree}
+	 * support function a sort calls.
+	 */
+	@Function(schema="bench", name="pair_cmp", requires="bench pair",
+		provides="bench pair cmp",
+		effects=IMMUTABLE, onNullInput=RETURNS_NULL)
+	public static int compare(Pair a, Pair b)
+	{
+		int c = Double.compare(a.m_x, b.m_x);
+		return 0 != c ? c : Double.compare(a.m_y, b.m_y);
+	}
+
+	@Operator(name="bench.<", commutator="bench.>", negator="bench.>=",
+		provides="bench pair relationals")
+	@Operator(name="bench.<=", synthetic="bench.pair_le",
+		provides="bench pair relationals")
+	@Operator(name="bench.>=", synthetic="bench.pair_ge",
+		commutator="bench.<=", provides="bench pair relationals")
+	@Operator(name="bench.>", synthetic="bench.pair_gt",
+		negator="bench.<=", provides="bench pair relationals")
+	@Function(schema="bench", name="pair_lt", requires="bench pair",
+		effects=IMMUTABLE, onNullInput=RETURNS_NULL)
+	public static boolean lessThan(Pair a, Pair b)
+	{
+		return compare(a, b) < 0;
+	}
+
+	@Operator(name="bench.=", commutator=SELF, negator="bench.<>",
+		provides="bench pair relationals")
+	@Operator(name="bench.<>", synthetic="bench.pair_ne",
+		commutator=SELF, provides="bench pair relationals")
+	@Function(schema="bench", name="pair_eq", requires="bench pair",
+		effects=IMMUTABLE, onNullInput=RETURNS_NULL)
+	public static boolean equal(Pair a, Pair b)
+	{
+		return 0 == compare(a, b);
+	}
+
+	@Function(effects=IMMUTABLE, onNullInput=RETURNS_NULL)
+	public static Pair parse(String input, String typeName)
+	throws SQLException
+	{
+		String s = input.trim();
+		int comma = s.indexOf(',');
+		if ( s.startsWith("(")  &&  s.endsWith(")")  &&  0 < comma )
+		{
+			try
+			{
+				return new Pair(
+					Double.parseDouble(s.substring(1, comma)),
+					Double.parseDouble(s.substring(1 + comma, s.length() - 1)),
+					typeName);
+			}
+			catch ( NumberFormatException e ) { }
+		}
+		throw new SQLException(
+			"Unable to parse pair from string \"" + input + '"', "22P02");
+	}
+
+	@Override
+	public String getSQLTypeName()
+	{
+		return m_typeName;
+	}
+
+	@Function(effects=IMMUTABLE, onNullInput=RETURNS_NULL)
+	@Override
+	public void readSQL(SQLInput stream, String typeName) throws SQLException
+	{
+		m_x = stream.readDouble();
+		m_y = stream.readDouble();
+		m_typeName = typeName;
+	}
+
+	@Function(effects=IMMUTABLE, onNullInput=RETURNS_NULL)
+	@Override
+	public String toString()
+	{
+		return "(" + m_x + "," + m_y + ")";
+	}
+
+	@Function(effects=IMMUTABLE, onNullInput=RETURNS_NULL)
+	@Override
+	public void writeSQL(SQLOutput stream) throws SQLException
+	{
+		stream.writeDouble(m_x);
+		stream.writeDouble(m_y);
+	}
+}
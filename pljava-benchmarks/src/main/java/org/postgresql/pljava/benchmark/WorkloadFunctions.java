@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+package org.postgresql.pljava.benchmark;
+
+import java.sql.Connection;
+import java.sql.PreparedStatement;
+import java.sql.ResultSet;
+import java.sql.SQLException;
+
+import static java.sql.DriverManager.getConnection;
+
+import org.postgresql.pljava.ResultSetProvider;
+import org.postgresql.pljava.TriggerData;
+
+import org.postgresql.pljava.annotation.Function;
+import org.postgresql.pljava.annotation.SQLAction;
+import org.postgresql.pljava.annotation.Trigger;
+
+import static org.postgresql.pljava.annotation.Function.Effects.IMMUTABLE;
+import static org.postgresql.pljava.annotation.Function.Effects.STABLE;
+import static
+	org.postgresql.pljava.annotation.Function.OnNullInput.RETURNS_NULL;
+import static org.postgresql.pljava.annotation.Trigger.Called.BEFORE;
+import static org.postgresql.pljava.annotation.Trigger.Event.INSERT;
+import static org.postgresql.pljava.annotation.Trigger.Scope.ROW;
+
+/**
+ * The functions, and the tables they use, for the end-to-end workloads run by
+ * the pgbench scripts in {@code src/main/pgbench}, alongside those of
+ * {@link BoundaryFunctions}, which the scalar and array workloads call.
+ *<p>
+ * Unlike the {@link Boundary} benchmarks, each workload is a whole statement
+ * as a client would send it, timed by pgbench in transactions per second and
+ * latency, so the effect of a setting on work as an application sees it can be
+ * compared.
+ */
+@SQLAction(provides="bench workload tables", requires="bench schema",
+	install={
+		"CREATE TABLE bench.workload_items (" +
+		" id integer PRIMARY KEY," +
+		" name text NOT NULL," +
+		" score float8 NOT NULL)",
+
+		"INSERT INTO bench.workload_items" +
+		" SELECT g, 'item ' || g, g * 0.5" +
+		" FROM generate_series(1, 10000) AS g",
+
+		"CREATE TABLE bench.workload_log (" +
+		" name text NOT NULL," +
+		" name_length integer)",
+
+		"ANALYZE bench.workload_items"
+	},
+	remove={
+		"DROP TABLE bench.workload_log",
+		"DROP TABLE bench.workload_items"
+	}
+)
+@SQLAction(requires={"bench pair ops", "bench workload tables"},
+	install={
+		"CREATE TABLE bench.workload_pairs AS" +
+		" SELECT CAST('(' || (g * 7919 % 1000) || ',' || g || ')'" +
+		"  AS bench.pair) AS p" +
+		" FROM generate_series(1, 1000) AS g"
+	},
+	remove="DROP TABLE bench.workload_pairs"
+)
+public class WorkloadFunctions implements ResultSetProvider.Large
+{
+	/**
+	 * Return {@code n} rows of {@code workload_items}'s shape, made in Java,
+	 * timing a set-returning function with a composite result.
+	 *<p>
+	 * Run with {@code pljava.srf_materialize_rows} zero and positive, it times
+	 * the value-per-call and materialized paths.
+	 */
+	@Function(schema="bench", name="items", requires="bench schema",
+		effects=IMMUTABLE, onNullInput=RETURNS_NULL,
+		out={"id integer", "name text", "score float8"})
+	public static ResultSetProvider items(int n)
+	{
+		return new WorkloadFunctions(n);
+	}
+
+	private final int m_count;
+
+	private WorkloadFunctions(int count)
+	{
+		m_count = count;
+	}
+
+	@Override
+	public boolean assignRowValues(ResultSet receiver, long currentRow)
+	throws SQLException
+	{
+		if ( currentRow >= m_count )
+			return false;
+		int id = (int)currentRow + 1;
+		receiver.updateInt(1, id);
+		receiver.updateString(2, "item " + id);
+		receiver.updateDouble(3, id * 0.5);
+		return true;
+	}
+
+	@Override
+	public void close()
+	{
+	}
+
+	/**
+	 * Look up {@code n} rows of {@code workload_items} by key, one execution
+	 * of a prepared statement each, starting at {@code first}, returning the
+	 * sum of their scores; times a loop of SPI lookups as a function doing
+	 * row-at-a-time work would make them.
+	 */
+	@Function(schema="bench", name="lookup_loop",
+		requires="bench workload tables",
+		effects=STABLE, onNullInput=RETURNS_NULL)
+	public static double lookupLoop(int first, int n) throws SQLException
+	{
+		double sum = 0.;
+		try (
+			Connection c = getConnection("jdbc:default:connection");
+			PreparedStatement ps = c.prepareStatement(
+				"SELECT score FROM bench.workload_items WHERE id = ?")
+		)
+		{
+			for ( int i = 0; i < n; ++ i )
+			{
+				ps.setInt(1, 1 + (first + i) % 10000);
+				try ( ResultSet rs = ps.executeQuery() )
+				{
+					if ( rs.next() )
+						sum += rs.getDouble(1);
+				}
+			}
+		}
+		return sum;
+	}
+
+	/**
+	 * Fill in the {@code name_length} of each row inserted into
+	 * {@code workload_log}, timing a row-level trigger.
+	 */
+	@Function(schema="bench", name="set_name_length",
+		requires="bench workload tables",
+		triggers=@Trigger(called=BEFORE, scope=ROW, events=INSERT,
+			schema="bench", table="workload_log"))
+	public static void setNameLength(TriggerData td) throws SQLException
+	{
+		ResultSet nrs = td.getNew();
+		nrs.updateInt("name_length", nrs.getString("name").length());
+	}
+}
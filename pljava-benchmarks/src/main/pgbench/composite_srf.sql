@@ -0,0 +1,2 @@
+-- 1000 composite rows produced by a set-returning function.
+SELECT count(*), sum(score) FROM bench.items(1000);
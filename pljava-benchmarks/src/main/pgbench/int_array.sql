@@ -0,0 +1,2 @@
+-- One integer array of 1000 elements passed to Java.
+SELECT bench.int_array_sum(array(SELECT generate_series(1, 1000)));
@@ -0,0 +1,116 @@
+#!/bin/sh
+#
+# Copyright (c) 2026 Tada AB and other contributors, as listed below.
+#
+# All rights reserved. This program and the accompanying materials
+# are made available under the terms of the The BSD 3-Clause License
+# which accompanies this distribution, and is available at
+# http://opensource.org/licenses/BSD-3-Clause
+#
+# Contributors:
+#   Tada AB
+#
+# Run each pgbench workload script in this directory under each variant in
+# variants.conf, and print a tab-separated table of transactions per second
+# and latency percentiles, in milliseconds, for each pair.
+#
+# usage: run.sh [-c clients] [-j threads] [-T seconds] [-w warmup-seconds]
+#               [-s script-name]... [-v variant-name]... [dbname]
+#
+# The database must have the bench jar installed and on the classpath of
+# schema bench. Other connection settings come from the usual PG* variables.
+# Transactions begun in the first warmup seconds of each run, which include
+# starting each client's JVM, are left out of the figures.
+
+here=$(dirname "$0")
+clients=4
+threads=4
+duration=30
+warmup=5
+scripts=
+variants=
+
+while getopts c:j:T:w:s:v: opt
+do
+	case $opt in
+	c) clients=$OPTARG ;;
+	j) threads=$OPTARG ;;
+	T) duration=$OPTARG ;;
+	w) warmup=$OPTARG ;;
+	s) scripts="$scripts $OPTARG" ;;
+	v) variants="$variants $OPTARG" ;;
+	*) sed -n '/^# usage/,/^#$/s/^# \{0,1\}//p' "$0" >&2; exit 2 ;;
+	esac
+done
+shift $((OPTIND - 1))
+
+if [ "$warmup" -ge "$duration" ]
+then
+	echo "warmup must be shorter than the run" >&2
+	exit 2
+fi
+
+[ -n "$scripts" ] ||
+	scripts=$(cd "$here" && ls *.sql | sed 's/\.sql$//')
+
+logdir=$(mktemp -d) || exit 1
+trap 'rm -rf "$logdir"' EXIT
+
+printf 'workload\tvariant\ttps\tp50_ms\tp95_ms\tp99_ms\n'
+
+for script in $scripts
+do
+	grep -v '^[[:space:]]*\(#\|$\)' "$here/variants.conf" |
+	while read -r variant options
+	do
+		if [ -n "$variants" ]
+		then
+			case " $variants " in
+			*" $variant "*) ;;
+			*) continue ;;
+			esac
+		fi
+
+		rm -f "$logdir"/pgbench_log.*
+		PGOPTIONS="$PGOPTIONS $options" pgbench -n \
+			-c "$clients" -j "$threads" -T "$duration" \
+			-f "$here/$script.sql" \
+			-l --log-prefix="$logdir/pgbench_log" "$@" \
+			>"$logdir/out" 2>&1 || {
+				echo "$script under $variant failed:" >&2
+				cat "$logdir/out" >&2
+				continue
+			}
+
+		# Per-transaction log lines are: client, transaction, latency in us,
+		# script, epoch seconds, microseconds.
+		# Keep the latencies of transactions begun after the warmup, in order.
+		awk '{ print $5, $3 }' "$logdir"/pgbench_log.* |
+		sort -n |
+		awk -v warmup="$warmup" '
+			NR == 1 { start = $1 }
+			$1 - start >= warmup { print $2 }
+		' |
+		sort -n |
+		awk -v measured=$((duration - warmup)) \
+			-v script="$script" -v variant="$variant" '
+			{ lat[NR] = $1 }
+			function pct(p,  i) {
+				i = int(NR * p + 0.5)
+				if ( i < 1 ) i = 1
+				return lat[i] / 1000
+			}
+			END {
+				if ( 0 == NR )
+				{
+					printf "%s under %s: no transactions after warmup\n",
+						script, variant > "/dev/stderr"
+					exit
+				}
+				printf "%s\t%s\t%.1f\t%.3f\t%.3f\t%.3f\n",
+					script, variant, NR / measured,
+					pct(0.50), pct(0.95), pct(0.99)
+			}
+		'
+	done
+done
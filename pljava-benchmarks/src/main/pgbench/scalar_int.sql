@@ -0,0 +1,2 @@
+-- A call of a scalar function on integer, per row of a small set.
+SELECT sum(bench.int_identity(g)) FROM generate_series(1, 100) AS g;
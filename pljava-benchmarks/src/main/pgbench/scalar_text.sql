@@ -0,0 +1,2 @@
+-- A call of a scalar function on text, per row of a small set.
+SELECT count(bench.text_identity('item ' || g)) FROM generate_series(1, 100) AS g;
@@ -0,0 +1,3 @@
+-- 100 lookups by key, each an execution of a prepared statement over SPI.
+\set first random(1, 10000)
+SELECT bench.lookup_loop(:first, 100);
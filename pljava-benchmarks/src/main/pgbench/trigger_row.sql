@@ -0,0 +1,6 @@
+-- 100 rows inserted through a row-level trigger, rolled back so the table
+-- does not grow over the run.
+BEGIN;
+INSERT INTO bench.workload_log (name)
+  SELECT 'entry ' || g FROM generate_series(1, 100) AS g;
+ROLLBACK;
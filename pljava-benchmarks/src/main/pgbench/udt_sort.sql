@@ -0,0 +1,2 @@
+-- A sort of 1000 UDT values, each comparison a call of bench.pair_cmp.
+SELECT p FROM bench.workload_pairs ORDER BY p OFFSET 1000;
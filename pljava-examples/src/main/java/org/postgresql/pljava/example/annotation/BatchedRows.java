@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+package org.postgresql.pljava.example.annotation;
+
+import java.sql.SQLException;
+
+import org.postgresql.pljava.ColumnBatch;
+import org.postgresql.pljava.ResultSetProvider;
+import org.postgresql.pljava.annotation.Function;
+import org.postgresql.pljava.annotation.SQLAction;
+
+/**
+ * Example of a set-returning function that fills its rows a batch at a time
+ * with {@link ResultSetProvider.Batched}.
+ *<p>
+ * The test runs the function both with {@code pljava.srf_materialize_rows}
+ * set, so whole batches are formed into rows natively, and with one row per
+ * call, and checks that both give the same rows.
+ */
+@SQLAction(requires="batchedRows", install={
+	"SET LOCAL pljava.srf_materialize_rows TO 100",
+	"CREATE TEMPORARY TABLE batchedrows_m AS" +
+	" SELECT * FROM javatest.batchedRows(2500)",
+	"SET LOCAL pljava.srf_materialize_rows TO 0",
+	"SELECT CASE WHEN" +
+	"  (SELECT count(*) FROM batchedrows_m) = 2500" +
+	"  AND NOT EXISTS (" +
+	"   (SELECT * FROM batchedrows_m" +
+	"    EXCEPT SELECT * FROM javatest.batchedRows(2500))" +
+	"   UNION ALL" +
+	"   (SELECT * FROM javatest.batchedRows(2500)" +
+	"    EXCEPT SELECT * FROM batchedrows_m))" +
+	"  AND (SELECT count(*) FROM batchedrows_m WHERE label IS NULL) = 250" +
+	" THEN javatest.logmessage('INFO', 'BatchedRows ok')" +
+	" ELSE javatest.logmessage('WARNING', 'BatchedRows not ok')" +
+	" END",
+	"DROP TABLE batchedrows_m",
+	"SET LOCAL pljava.srf_materialize_rows TO DEFAULT"
+})
+public class BatchedRows implements ResultSetProvider.Batched
+{
+	/**
+	 * Return <var>count</var> rows of a row number, its square, its square
+	 * root, and a label that is null for every tenth row.
+	 */
+	@Function(schema="javatest", provides="batchedRows",
+		out={"n bigint", "square bigint", "root float8", "label text"})
+	public static ResultSetProvider batchedRows(int count)
+	{
+		return new BatchedRows(count);
+	}
+
+	private final int m_count;
+	private long m_next;
+	private long[] m_n = new long[0];
+	private long[] m_square = new long[0];
+	private double[] m_root = new double[0];
+
+	private BatchedRows(int count)
+	{
+		m_count = count;
+	}
+
+	@Override
+	public int assignBatch(ColumnBatch batch, int max) throws SQLException
+	{
+		int rows = (int)Math.min(max, m_count - m_next);
+		if ( m_n.length < rows )
+		{
+			m_n = new long [ rows ];
+			m_square = new long [ rows ];
+			m_root = new double [ rows ];
+		}
+
+		for ( int i = 0 ; i < rows ; ++ i )
+		{
+			long n = m_next + i;
+			m_n[i] = n;
+			m_square[i] = n * n;
+			m_root[i] = Math.sqrt(n);
+			if ( 0 != n % 10 )
+				batch.setObject(4, i, "row " + n);
+		}
+
+		batch.setLongs(1, m_n, rows);
+		batch.setLongs(2, m_square, rows);
+		batch.setDoubles(3, m_root, rows);
+		m_next += rows;
+		return rows;
+	}
+
+	@Override
+	public void close()
+	{
+	}
+}
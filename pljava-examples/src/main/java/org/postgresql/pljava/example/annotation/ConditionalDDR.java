@@ -132,4 +132,12 @@ import org.postgresql.pljava.annotation.SQLAction;
 	" current_setting('pljava.implementors'), true) " +
 	"END"
 )
+
+@SQLAction(provides="postgresql_ge_120000", install=
+	"SELECT CASE WHEN" +
+	" 120000 <= CAST(current_setting('server_version_num') AS integer)" +
+	" THEN set_config('pljava.implementors', 'postgresql_ge_120000,' || " +
+	" current_setting('pljava.implementors'), true) " +
+	"END"
+)
 public class ConditionalDDR { }
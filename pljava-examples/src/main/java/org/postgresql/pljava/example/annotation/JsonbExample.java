@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+package org.postgresql.pljava.example.annotation;
+
+import java.sql.SQLException;
+
+import java.util.List;
+
+import org.postgresql.pljava.Jsonb;
+import org.postgresql.pljava.annotation.Function;
+import org.postgresql.pljava.annotation.SQLAction;
+
+/**
+ * Examples of the {@link Jsonb} mapping of {@code jsonb}: looking values up in
+ * the stored form without parsing it, and building a value to return.
+ *<p>
+ * The implementor tag is only to avoid PostgreSQL versions before 9.4, which
+ * have no {@code jsonb}; the test uses the nearest tag already defined.
+ */
+@SQLAction(implementor="postgresql_ge_100000", requires="jsonb examples",
+	install=
+	"SELECT CASE WHEN" +
+	"  javatest.jsonbPath('{\"a\":{\"b\":[1,\"x\",true,null]}}', 'a')" +
+	"   = '{\"b\":[1,\"x\",true,null]}'" +
+	"  AND javatest.jsonbPath('{\"a\":{\"b\":[1,\"x\",true,null]}}'," +
+	"   'a', 'b', '1') = '\"x\"'" +
+	"  AND javatest.jsonbPath('{\"a\":[3.5]}', 'a', '0') = '3.5'" +
+	"  AND javatest.jsonbPath('{\"a\":1}', 'z') IS NULL" +
+	"  AND javatest.jsonbKeys('{\"cc\":1,\"b\":2,\"a\":3}')" +
+	"   = ARRAY['a','b','cc']" +
+	"  AND javatest.jsonbBuild(2) =" +
+	"   '{\"n\":2,\"items\":[0,1],\"ok\":true,\"none\":null,\"s\":\"a\\\"b\"}'" +
+	" THEN javatest.logmessage('INFO', 'jsonb examples ok')" +
+	" ELSE javatest.logmessage('WARNING', 'jsonb examples not ok')" +
+	" END"
+)
+public class JsonbExample
+{
+	/**
+	 * Follow a path from <var>doc</var>, each step a key or, where the value
+	 * reached is an array, an index written in decimal; return null if the
+	 * path leads nowhere.
+	 */
+	@Function(schema="javatest", implementor="postgresql_ge_100000",
+		provides="jsonb examples", variadic=true)
+	public static Jsonb jsonbPath(Jsonb doc, String[] path)
+	throws SQLException
+	{
+		Jsonb v = doc;
+		for ( String step : path )
+		{
+			if ( Jsonb.Kind.ARRAY == v.kind() )
+				v = v.get(Integer.parseInt(step));
+			else
+				v = v.get(step);
+			if ( null == v )
+				return null;
+		}
+		return v;
+	}
+
+	/**
+	 * Return the keys of an object.
+	 */
+	@Function(schema="javatest", implementor="postgresql_ge_100000",
+		provides="jsonb examples")
+	public static String[] jsonbKeys(Jsonb doc) throws SQLException
+	{
+		List<String> keys = doc.keys();
+		return keys.toArray(new String[keys.size()]);
+	}
+
+	/**
+	 * Build an object with assorted members, including an array of the
+	 * integers below <var>n</var>.
+	 */
+	@Function(schema="javatest", implementor="postgresql_ge_100000",
+		provides="jsonb examples")
+	public static Jsonb jsonbBuild(int n)
+	{
+		Jsonb.Builder b = Jsonb.builder().beginObject();
+		b.key("n").value(n);
+		b.key("items").beginArray();
+		for ( int i = 0 ; i < n ; ++ i )
+			b.value(i);
+		b.endArray();
+		b.key("ok").value(true);
+		b.key("none").nullValue();
+		b.key("s").value("a\"b");
+		return b.endObject().build();
+	}
+}
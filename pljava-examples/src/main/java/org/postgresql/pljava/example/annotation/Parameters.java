@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2004-2020 Tada AB and other contributors, as listed below.
+ * Copyright (c) 2004-2026 Tada AB and other contributors, as listed below.
  *
  * All rights reserved. This program and the accompanying materials
  * are made available under the terms of the The BSD 3-Clause License
@@ -13,9 +13,16 @@
 package org.postgresql.pljava.example.annotation;
 
 import java.math.BigDecimal;
+import java.nio.DoubleBuffer;
+import java.nio.IntBuffer;
+import java.nio.LongBuffer;
+import java.sql.Connection;
 import java.sql.Date;
+import static java.sql.DriverManager.getConnection;
 import java.sql.ResultSet;
+import java.sql.Savepoint;
 import java.sql.SQLException;
+import java.sql.Statement;
 import java.sql.Time;
 import java.sql.Timestamp;
 import java.text.DateFormat;
@@ -40,6 +47,20 @@ import org.postgresql.pljava.annotation.SQLType;
  * Of course, there is now a burden on the author to get this declaration right
  * and to keep it up to date if the method evolves, but at least it is here in
  * the same file, rather than in a separate hand-maintained DDR file.
+ *<p>
+ * The second {@code @SQLAction} checks {@code BigDecimal} values of negative
+ * scale, which a {@code numeric} never has and so cannot be round-tripped from
+ * SQL, and the refusal of a {@code numeric} NaN, which a {@code BigDecimal}
+ * cannot represent.
+ *<p>
+ * The third checks multidimensional arrays: one with lower bounds other than 1
+ * (which come back as 1), one with null elements, as {@code Integer[][]} and
+ * as {@code int[][]} (where nulls become zeros), and the refusal of a ragged
+ * Java array returned as a PostgreSQL one.
+ *<p>
+ * The fourth passes arrays with nulls at the first and last positions and
+ * every eighth through {@code IntBuffer}, {@code LongBuffer}, and
+ * {@code DoubleBuffer}, which have zero in place of each null.
  * @author Thomas Hallgren
  */
 @SQLAction(install = {
@@ -50,6 +71,81 @@ import org.postgresql.pljava.annotation.SQLType;
 	},
 	remove = "DROP FUNCTION javatest.java_getTimestamptz()"
 )
+@SQLAction(
+	requires = {"Parameters.scaleByPowerOfTen", "Parameters.numericNaNRefused"},
+	install = {
+	" SELECT" +
+	"  CASE WHEN every(javatest.scaleByPowerOfTen(v, n)::text = expected)" +
+	"  THEN javatest.logmessage('INFO',    'numeric negative scale passes')" +
+	"  ELSE javatest.logmessage('WARNING', 'numeric negative scale fails')" +
+	"  END" +
+	" FROM" +
+	"  (VALUES" +
+	"   (numeric '12.5', 5, '1250000'), ('-3', 7, '-30000000')," +
+	"   ('1', 4, '10000'), ('0.001', 3, '1'), ('0', 9, '0')" +
+	"  ) AS p(v, n, expected)",
+
+	" SELECT" +
+	"  CASE WHEN javatest.numericNaNRefused()" +
+	"  THEN javatest.logmessage('INFO',    'numeric NaN refusal passes')" +
+	"  ELSE javatest.logmessage('WARNING', 'numeric NaN refusal fails')" +
+	"  END"
+	}
+)
+@SQLAction(
+	requires = {
+		"Parameters.transpose", "Parameters.boxedMatrix",
+		"Parameters.intMatrix", "Parameters.ragged",
+		"Parameters.raggedRejected"
+	},
+	install = {
+	" SELECT" +
+	"  CASE WHEN" +
+	"   javatest.transpose('[0:1][-1:1]={{1,2,3},{4,5,6}}'::float8[])" +
+	"   = '{{1,4},{2,5},{3,6}}'::float8[]" +
+	"  THEN javatest.logmessage('INFO',    'array lower bounds passes')" +
+	"  ELSE javatest.logmessage('WARNING', 'array lower bounds fails')" +
+	"  END",
+
+	" SELECT" +
+	"  CASE WHEN" +
+	"   javatest.boxedMatrix('{{1,NULL,3},{NULL,5,NULL}}')" +
+	"   = '{{1,NULL,3},{NULL,5,NULL}}'::int4[]" +
+	"   AND javatest.intMatrix('{{1,NULL,3},{NULL,5,NULL}}')" +
+	"   = '{{1,0,3},{0,5,0}}'::int4[]" +
+	"  THEN javatest.logmessage('INFO',    'array 2-D nulls passes')" +
+	"  ELSE javatest.logmessage('WARNING', 'array 2-D nulls fails')" +
+	"  END",
+
+	" SELECT" +
+	"  CASE WHEN javatest.raggedRejected()" +
+	"  THEN javatest.logmessage('INFO',    'ragged array refusal passes')" +
+	"  ELSE javatest.logmessage('WARNING', 'ragged array refusal fails')" +
+	"  END"
+	}
+)
+@SQLAction(
+	requires = {
+		"Parameters.intBuffer", "Parameters.longBuffer",
+		"Parameters.doubleBuffer"
+	},
+	install = {
+	" SELECT" +
+	"  CASE WHEN" +
+	"   javatest.intBuffer(a::int4[]) = array_replace(a::int4[], null, 0)" +
+	"   AND javatest.longBuffer(a::int8[])" +
+	"   = array_replace(a::int8[], null, 0::int8)" +
+	"   AND javatest.doubleBuffer(a::float8[])" +
+	"   = array_replace(a::float8[], null, 0::float8)" +
+	"  THEN javatest.logmessage('INFO',    'array buffer nulls passes')" +
+	"  ELSE javatest.logmessage('WARNING', 'array buffer nulls fails')" +
+	"  END" +
+	" FROM" +
+	"  (SELECT array_agg(CASE WHEN i = 1 OR i % 8 = 0 OR i = 25" +
+	"   THEN NULL ELSE i END ORDER BY i)" +
+	"   FROM generate_series(1, 25) AS g(i)) AS p(a)"
+	}
+)
 public class Parameters {
 	public static double addNumbers(short a, int b, long c, BigDecimal d,
 			BigDecimal e, float f, double g) {
@@ -105,6 +201,138 @@ public class Parameters {
 		return new Timestamp(System.currentTimeMillis());
 	}
 
+	/**
+	 * Scale a {@code numeric} by a power of ten in Java, which gives a
+	 * {@code BigDecimal} of negative scale to be returned when {@code n}
+	 * exceeds the scale of {@code value}.
+	 */
+	@Function(schema = "javatest", effects = IMMUTABLE,
+		provides = "Parameters.scaleByPowerOfTen")
+	public static BigDecimal scaleByPowerOfTen(BigDecimal value, int n) {
+		return value.scaleByPowerOfTen(n);
+	}
+
+	/**
+	 * Return whether fetching a {@code numeric} NaN as a {@code BigDecimal}
+	 * fails with an exception, rather than producing some number.
+	 */
+	@Function(schema = "javatest", provides = "Parameters.numericNaNRefused")
+	public static boolean numericNaNRefused() throws SQLException {
+		Connection c = getConnection("jdbc:default:connection");
+		Statement s = c.createStatement();
+		Savepoint sp = c.setSavepoint();
+		try {
+			ResultSet rs = s.executeQuery("SELECT numeric 'NaN'");
+			rs.next();
+			rs.getBigDecimal(1);
+			c.releaseSavepoint(sp);
+			return false;
+		} catch (SQLException e) {
+			c.rollback(sp);
+			return true;
+		} finally {
+			s.close();
+		}
+	}
+
+	/**
+	 * Transpose a matrix, passed and returned as a two-dimensional
+	 * {@code float8} array.
+	 */
+	@Function(schema = "javatest", type = "float8[]", effects = IMMUTABLE,
+		provides = "Parameters.transpose")
+	public static double[][] transpose(@SQLType("float8[]") double[][] m) {
+		int rows = m.length;
+		int cols = 0 == rows ? 0 : m[0].length;
+		double[][] t = new double[cols][rows];
+		for (int i = 0; i < rows; ++i)
+			for (int j = 0; j < cols; ++j)
+				t[j][i] = m[i][j];
+		return t;
+	}
+
+	/**
+	 * Return a two-dimensional {@code int4} array unchanged, by way of
+	 * {@code Integer[][]}, which keeps its nulls.
+	 */
+	@Function(schema = "javatest", type = "int4[]", effects = IMMUTABLE,
+		provides = "Parameters.boxedMatrix")
+	public static Integer[][] boxedMatrix(@SQLType("int4[]") Integer[][] m) {
+		return m;
+	}
+
+	/**
+	 * Return a two-dimensional {@code int4} array by way of {@code int[][]},
+	 * which has zero in place of each null.
+	 */
+	@Function(schema = "javatest", type = "int4[]", effects = IMMUTABLE,
+		provides = "Parameters.intMatrix")
+	public static int[][] intMatrix(@SQLType("int4[]") int[][] m) {
+		return m;
+	}
+
+	/**
+	 * Return a ragged {@code int[][]}, which cannot become a PostgreSQL
+	 * array.
+	 */
+	@Function(schema = "javatest", type = "int4[]",
+		provides = "Parameters.ragged")
+	public static int[][] ragged() {
+		return new int[][] { { 1, 2 }, { 3 } };
+	}
+
+	/**
+	 * Return whether {@link #ragged ragged()} fails with an exception when
+	 * called from SQL, rather than returning some array.
+	 */
+	@Function(schema = "javatest", provides = "Parameters.raggedRejected")
+	public static boolean raggedRejected() throws SQLException {
+		Connection c = getConnection("jdbc:default:connection");
+		Statement s = c.createStatement();
+		Savepoint sp = c.setSavepoint();
+		try {
+			s.executeQuery("SELECT javatest.ragged()").close();
+			c.releaseSavepoint(sp);
+			return false;
+		} catch (SQLException e) {
+			c.rollback(sp);
+			return true;
+		} finally {
+			s.close();
+		}
+	}
+
+	/**
+	 * Return an {@code int4} array unchanged but for its nulls, by way of an
+	 * {@code IntBuffer}.
+	 */
+	@Function(schema = "javatest", type = "int4[]", effects = IMMUTABLE,
+		provides = "Parameters.intBuffer")
+	public static IntBuffer intBuffer(@SQLType("int4[]") IntBuffer b) {
+		return b;
+	}
+
+	/**
+	 * Return an {@code int8} array unchanged but for its nulls, by way of a
+	 * {@code LongBuffer}.
+	 */
+	@Function(schema = "javatest", type = "int8[]", effects = IMMUTABLE,
+		provides = "Parameters.longBuffer")
+	public static LongBuffer longBuffer(@SQLType("int8[]") LongBuffer b) {
+		return b;
+	}
+
+	/**
+	 * Return a {@code float8} array unchanged but for its nulls, by way of a
+	 * {@code DoubleBuffer}.
+	 */
+	@Function(schema = "javatest", type = "float8[]", effects = IMMUTABLE,
+		provides = "Parameters.doubleBuffer")
+	public static DoubleBuffer doubleBuffer(
+		@SQLType("float8[]") DoubleBuffer b) {
+		return b;
+	}
+
 	static void log(String msg) {
 		Logger.getAnonymousLogger().info(msg);
 	}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+package org.postgresql.pljava.example.annotation;
+
+import java.util.Iterator;
+import java.util.stream.IntStream;
+
+import org.postgresql.pljava.PlannerSupport;
+import org.postgresql.pljava.annotation.Function;
+import org.postgresql.pljava.annotation.SQLAction;
+
+/**
+ * Examples of {@link PlannerSupport}: a set-returning function whose row
+ * estimate is its argument, when that is a constant, and a function the
+ * planner may replace by its first argument, when that is a non-null constant.
+ *<p>
+ * A {@code SUPPORT} clause needs PostgreSQL 12 or later, and a superuser to
+ * declare it.
+ */
+@SQLAction(implementor="postgresql_ge_120000", requires="plannerSupport",
+	install=
+	"SELECT CASE WHEN" +
+	"  (SELECT sum(i) FROM javatest.supportedSeries(100) AS i) = 5050" +
+	"  AND javatest.supportedCoalesce('x', 'y') = 'x'" +
+	"  AND javatest.supportedCoalesce(NULL, 'y') = 'y'" +
+	" THEN javatest.logmessage('INFO', 'PlannerSupport ok')" +
+	" ELSE javatest.logmessage('WARNING', 'PlannerSupport not ok')" +
+	" END"
+)
+public class PlannerSupportExample
+{
+	/**
+	 * Return the integers from 1 to <var>n</var>.
+	 */
+	@Function(schema="javatest", implementor="postgresql_ge_120000",
+		provides="plannerSupport", support=SeriesSupport.class)
+	public static Iterator<Integer> supportedSeries(int n)
+	{
+		return IntStream.rangeClosed(1, n).iterator();
+	}
+
+	/**
+	 * Return <var>a</var> unless it is null, otherwise <var>b</var>.
+	 */
+	@Function(schema="javatest", implementor="postgresql_ge_120000",
+		provides="plannerSupport", support=CoalesceSupport.class)
+	public static String supportedCoalesce(String a, String b)
+	{
+		return null != a ? a : b;
+	}
+
+	/**
+	 * Estimates the rows of {@code supportedSeries} from a constant argument.
+	 */
+	public static class SeriesSupport implements PlannerSupport
+	{
+		@Override
+		public double rows(Arguments args)
+		{
+			if ( ! args.isConstant(0)  ||  null == args.get(0) )
+				return -1;
+			return Math.max(0, (Integer)args.get(0));
+		}
+	}
+
+	/**
+	 * Replaces {@code supportedCoalesce} by its first argument when that is a
+	 * non-null constant, whatever the second argument is.
+	 */
+	public static class CoalesceSupport implements PlannerSupport
+	{
+		@Override
+		public Object simplify(Arguments args)
+		{
+			if ( args.isConstant(0)  &&  null != args.get(0) )
+				return args.get(0);
+			return NOT_SIMPLIFIED;
+		}
+	}
+}
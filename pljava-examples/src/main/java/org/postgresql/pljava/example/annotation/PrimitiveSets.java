@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+package org.postgresql.pljava.example.annotation;
+
+import java.util.PrimitiveIterator;
+import java.util.stream.DoubleStream;
+import java.util.stream.LongStream;
+
+import org.postgresql.pljava.annotation.Function;
+import org.postgresql.pljava.annotation.SQLAction;
+
+/**
+ * Examples of set-returning functions that return a primitive stream or
+ * iterator, whose values are read without boxing when the rows are gathered
+ * into a tuplestore.
+ *<p>
+ * The test sums the results both with {@code pljava.srf_materialize_rows} set
+ * and with one row per call.
+ */
+@SQLAction(requires="primitiveSets", install={
+	"SET LOCAL pljava.srf_materialize_rows TO 100",
+	"CREATE TEMPORARY TABLE primitivesets_m AS SELECT" +
+	" (SELECT sum(s) FROM javatest.squares(2500) AS s) AS sq," +
+	" (SELECT sum(i) FROM javatest.countdown(250) AS i) AS cd," +
+	" (SELECT sum(h) FROM javatest.halves(1000) AS h) AS hv",
+	"SET LOCAL pljava.srf_materialize_rows TO 0",
+	"SELECT CASE WHEN" +
+	"  sq = 5205208750 AND cd = 31375 AND hv = 249750" +
+	"  AND sq = (SELECT sum(s) FROM javatest.squares(2500) AS s)" +
+	"  AND cd = (SELECT sum(i) FROM javatest.countdown(250) AS i)" +
+	"  AND hv = (SELECT sum(h) FROM javatest.halves(1000) AS h)" +
+	" THEN javatest.logmessage('INFO', 'PrimitiveSets ok')" +
+	" ELSE javatest.logmessage('WARNING', 'PrimitiveSets not ok')" +
+	" END" +
+	" FROM primitivesets_m",
+	"DROP TABLE primitivesets_m",
+	"SET LOCAL pljava.srf_materialize_rows TO DEFAULT"
+})
+public class PrimitiveSets
+{
+	/**
+	 * Return the squares of the integers below <var>count</var>.
+	 */
+	@Function(schema="javatest", provides="primitiveSets")
+	public static LongStream squares(int count)
+	{
+		return LongStream.range(0, count).map(n -> n * n);
+	}
+
+	/**
+	 * Return halves of the integers below <var>count</var>.
+	 */
+	@Function(schema="javatest", provides="primitiveSets")
+	public static DoubleStream halves(int count)
+	{
+		return LongStream.range(0, count).mapToDouble(n -> n / 2.0);
+	}
+
+	/**
+	 * Return the integers from <var>from</var> down to 1.
+	 */
+	@Function(schema="javatest", provides="primitiveSets")
+	public static PrimitiveIterator.OfInt countdown(int from)
+	{
+		return new PrimitiveIterator.OfInt()
+		{
+			private int m_next = from;
+
+			@Override
+			public boolean hasNext()
+			{
+				return 0 < m_next;
+			}
+
+			@Override
+			public int nextInt()
+			{
+				return m_next --;
+			}
+		};
+	}
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+package org.postgresql.pljava.example.annotation;
+
+import java.sql.Connection;
+import java.sql.DriverManager;
+import java.sql.ResultSet;
+import java.sql.SQLException;
+
+import org.postgresql.pljava.RelationScan;
+import org.postgresql.pljava.annotation.Function;
+import org.postgresql.pljava.annotation.SQLAction;
+
+/**
+ * Examples of {@link RelationScan}, looking rows up through an index and with a
+ * sequential scan, without running a query for each lookup.
+ *<p>
+ * The test compares the results with those of the same lookups in SQL.
+ */
+@SQLAction(requires="relationLookups", install={
+	"CREATE TABLE javatest.relscan(id integer PRIMARY KEY, grp text, v float8)",
+	"INSERT INTO javatest.relscan" +
+	" SELECT g, 'g' || (g % 7), g / 4.0 FROM generate_series(1, 1000) AS g",
+	"SELECT CASE WHEN" +
+	"  javatest.relscanSum(100) =" +
+	"   (SELECT sum(v) FROM javatest.relscan WHERE id <= 100)" +
+	"  AND javatest.relscanCount('g3') =" +
+	"   (SELECT count(*) FROM javatest.relscan WHERE grp = 'g3')" +
+	" THEN javatest.logmessage('INFO', 'RelationLookups ok')" +
+	" ELSE javatest.logmessage('WARNING', 'RelationLookups not ok')" +
+	" END",
+	"DROP TABLE javatest.relscan"
+})
+public class RelationLookups
+{
+	/**
+	 * Sum the {@code v} column of {@code javatest.relscan} over the rows with
+	 * {@code id} from 1 to <var>n</var>, one index lookup per row.
+	 */
+	@Function(schema="javatest", provides="relationLookups")
+	public static double relscanSum(int n) throws SQLException
+	{
+		Connection c = DriverManager.getConnection("jdbc:default:connection");
+		RelationScan.Lookup byId = c.unwrap(RelationScan.class)
+			.prepareIndexLookup("javatest.relscan", "relscan_pkey");
+		double sum = 0;
+		for ( int id = 1 ; id <= n ; ++ id )
+		{
+			try ( ResultSet rs = byId.find(id) )
+			{
+				while ( rs.next() )
+					sum += rs.getDouble("v");
+			}
+		}
+		return sum;
+	}
+
+	/**
+	 * Count the rows of {@code javatest.relscan} in the group <var>grp</var>,
+	 * with a sequential scan.
+	 */
+	@Function(schema="javatest", provides="relationLookups")
+	public static int relscanCount(String grp) throws SQLException
+	{
+		Connection c = DriverManager.getConnection("jdbc:default:connection");
+		RelationScan.Lookup byGroup = c.unwrap(RelationScan.class)
+			.prepareTableScan("javatest.relscan", "grp");
+		int count = 0;
+		try ( ResultSet rs = byGroup.find(grp) )
+		{
+			while ( rs.next() )
+				++ count;
+		}
+		return count;
+	}
+}
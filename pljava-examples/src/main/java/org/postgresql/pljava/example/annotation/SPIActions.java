@@ -59,6 +59,12 @@ import org.postgresql.pljava.annotation.SQLAction;
 }
 )
 @SQLAction(requires = "issue228", install = "SELECT javatest.issue228()")
+@SQLAction(requires = "runInSubtransaction", install =
+	"SELECT CASE WHEN 3 = javatest.subtransactionsSurviving()" +
+	" THEN javatest.logmessage('INFO', 'runInSubtransaction ok')" +
+	" ELSE javatest.logmessage('WARNING', 'runInSubtransaction not ok')" +
+	" END"
+)
 public class SPIActions {
 	private static final String SP_CHECKSTATE = "sp.checkState";
 
@@ -320,6 +326,32 @@ public class SPIActions {
 		}
 	}
 
+	/**
+	 * Run four statements, each in its own subtransaction, one of which fails;
+	 * return how many succeeded, which should be three.
+	 */
+	@Function(schema="javatest", provides="runInSubtransaction")
+	public static int subtransactionsSurviving() throws SQLException {
+		Connection conn = DriverManager
+				.getConnection("jdbc:default:connection");
+		Session session = SessionManager.current();
+		int surviving = 0;
+
+		try (Statement stmt = conn.createStatement()) {
+			for (int i = 0; i < 4; ++i) {
+				String sql = "SELECT 1 / " + (i - 1);
+				try {
+					session.runInSubtransaction(() -> stmt.execute(sql));
+					++surviving;
+				} catch (SQLException e) {
+					if (!"22012".equals(e.getSQLState()))
+						throw e;
+				}
+			}
+		}
+		return surviving;
+	}
+
 	@Function(schema="javatest", effects=IMMUTABLE)
 	@SuppressWarnings("removal") // setAttribute
 	public static int testTransactionRecovery() throws SQLException {
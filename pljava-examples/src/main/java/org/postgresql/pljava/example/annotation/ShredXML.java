@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+package org.postgresql.pljava.example.annotation;
+
+import java.sql.ResultSet;
+import java.sql.ResultSetMetaData;
+import java.sql.SQLException;
+import java.sql.SQLXML;
+
+import java.util.HashMap;
+import java.util.Map;
+
+import javax.xml.stream.XMLStreamException;
+import javax.xml.stream.XMLStreamReader;
+import static javax.xml.stream.XMLStreamConstants.CDATA;
+import static javax.xml.stream.XMLStreamConstants.CHARACTERS;
+import static javax.xml.stream.XMLStreamConstants.END_DOCUMENT;
+import static javax.xml.stream.XMLStreamConstants.END_ELEMENT;
+import static javax.xml.stream.XMLStreamConstants.START_ELEMENT;
+import javax.xml.transform.stax.StAXSource;
+
+import org.postgresql.pljava.ResultSetProvider;
+import org.postgresql.pljava.annotation.Function;
+import org.postgresql.pljava.annotation.SQLAction;
+
+/**
+ * Example of shredding an XML document into rows while streaming it, so that
+ * a document of any size is processed in memory bounded by the size of one
+ * row.
+ *<p>
+ * Unlike the {@code XMLTABLE}-like function in the Saxon example, which
+ * builds a tree of the whole document for the XQuery evaluator, this reads
+ * the value through the StAX source of {@code SQLXML}, which itself reads the
+ * stored value a piece at a time as the parser asks for it, and each row is
+ * handed to PostgreSQL as soon as its end is seen. With
+ * {@code pljava.srf_materialize_rows} set, the rows go straight into the
+ * tuplestore of the function's result.
+ *<p>
+ * Everything mentioning the type XML here needs a conditional implementor tag
+ * in case of being loaded into a PostgreSQL instance built without that type.
+ */
+@SQLAction(implementor="postgresql_xml", requires="shredXML", install=
+	"SELECT CASE WHEN" +
+	"  array_agg(r.id ORDER BY r.id) = ARRAY['1','2']" +
+	"  AND array_agg(r.name ORDER BY r.id) = ARRAY['a',' b&c ']" +
+	"  AND array_agg(r.note ORDER BY r.id) IS NOT DISTINCT FROM" +
+	"      ARRAY[NULL,'x']" +
+	" THEN javatest.logmessage('INFO', 'shredXML ok')" +
+	" ELSE javatest.logmessage('WARNING', 'shredXML not ok')" +
+	" END" +
+	" FROM javatest.shredXML(" +
+	"  '<t><r id=\"1\"><name>a</name></r>" +
+	"   <skip><name>no</name></skip>" +
+	"   <r id=\"2\"><name> b&amp;<![CDATA[c]]> </name><note>x</note></r></t>'," +
+	"  'r'" +
+	" ) AS r(id text, name text, note text)"
+)
+public class ShredXML implements ResultSetProvider.Large
+{
+	/**
+	 * Return one row for each element named <var>rowElement</var> in
+	 * <var>doc</var>, at any depth.
+	 *<p>
+	 * The function returns {@code SETOF RECORD}, and the caller names the
+	 * columns wanted in a column definition list. A column gets the value of
+	 * the row element's attribute of the same (local) name or, failing that,
+	 * the text content of the row element's first child element of that
+	 * name, or null if there is neither. Values are supplied as strings, so
+	 * columns should be declared {@code text} and cast in the query as
+	 * needed. Row elements nested within a row element are not rows
+	 * themselves.
+	 */
+	@Function(schema="javatest", implementor="postgresql_xml",
+		type="RECORD", provides="shredXML")
+	public static ResultSetProvider shredXML(SQLXML doc, String rowElement)
+	throws SQLException
+	{
+		return new ShredXML(doc, rowElement);
+	}
+
+	private final SQLXML m_doc;
+	private final XMLStreamReader m_reader;
+	private final String m_rowElement;
+	private Map<String,Integer> m_columns;
+
+	private ShredXML(SQLXML doc, String rowElement) throws SQLException
+	{
+		m_doc = doc;
+		m_reader = doc.getSource(StAXSource.class).getXMLStreamReader();
+		m_rowElement = rowElement;
+	}
+
+	@Override
+	public boolean assignRowValues(ResultSet receiver, long currentRow)
+	throws SQLException
+	{
+		if ( null == m_columns )
+		{
+			ResultSetMetaData md = receiver.getMetaData();
+			m_columns = new HashMap<>();
+			for ( int i = md.getColumnCount() ; i > 0 ; -- i )
+				m_columns.put(md.getColumnLabel(i), i);
+		}
+
+		try
+		{
+			if ( ! nextRowStart() )
+				return false;
+
+			String[] values = new String [ 1 + m_columns.size() ];
+
+			for ( int i = 0, n = m_reader.getAttributeCount() ; i < n ; ++ i )
+			{
+				Integer col =
+					m_columns.get(m_reader.getAttributeLocalName(i));
+				if ( null != col )
+					values[col] = m_reader.getAttributeValue(i);
+			}
+
+			/*
+			 * Read to the end of the row element, gathering the text of each
+			 * child whose name is a column.
+			 */
+			for ( int depth = 1 ; 0 < depth ; )
+			{
+				int event = m_reader.next();
+				if ( END_ELEMENT == event )
+					-- depth;
+				else if ( START_ELEMENT == event )
+				{
+					Integer col = 1 != depth ? null :
+						m_columns.get(m_reader.getLocalName());
+					if ( null != col  &&  null == values[col] )
+						values[col] = childText();
+					else
+						++ depth;
+				}
+			}
+
+			for ( int i = 1 ; i < values.length ; ++ i )
+				receiver.updateString(i, values[i]);
+			return true;
+		}
+		catch ( XMLStreamException e )
+		{
+			throw new SQLException(e.getMessage(), "2200M", e);
+		}
+	}
+
+	/**
+	 * Advance to the start of the next row element, returning false at the
+	 * end of the document.
+	 */
+	private boolean nextRowStart() throws XMLStreamException
+	{
+		while ( m_reader.hasNext() )
+		{
+			int event = m_reader.next();
+			if ( START_ELEMENT == event
+				&&  m_rowElement.equals(m_reader.getLocalName()) )
+				return true;
+			if ( END_DOCUMENT == event )
+				break;
+		}
+		return false;
+	}
+
+	/**
+	 * Return the text content of the element the reader is at the start of,
+	 * leaving the reader at its end.
+	 */
+	private String childText() throws XMLStreamException
+	{
+		StringBuilder sb = new StringBuilder();
+		for ( int depth = 1 ; 0 < depth ; )
+		{
+			switch ( m_reader.next() )
+			{
+			case START_ELEMENT:
+				++ depth;
+				break;
+			case END_ELEMENT:
+				-- depth;
+				break;
+			case CHARACTERS:
+			case CDATA:
+				sb.append(
+					m_reader.getTextCharacters(),
+					m_reader.getTextStart(), m_reader.getTextLength());
+				break;
+			default:
+			}
+		}
+		return sb.toString();
+	}
+
+	@Override
+	public void close() throws SQLException
+	{
+		try
+		{
+			m_reader.close();
+		}
+		catch ( XMLStreamException e )
+		{
+			/* nothing more is wanted from it anyway */
+		}
+		m_doc.free();
+	}
+}
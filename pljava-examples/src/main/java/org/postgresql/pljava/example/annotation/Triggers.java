@@ -65,6 +65,25 @@ import static org.postgresql.pljava.example.LoggerTest.logMessage;
 	requires = { "transition triggers", "foobar2_42" },
 	install = "UPDATE javatest.foobar_2 SET value = 43 WHERE value = 42"
 )
+@SQLAction(
+	provides = "foobar_3 table",
+	install = "CREATE TABLE javatest.foobar_3 ( username text, value numeric )",
+	remove = "DROP TABLE javatest.foobar_3"
+)
+@SQLAction(
+	requires = "unmodified triggers",
+	install = {
+		"INSERT INTO javatest.foobar_3 VALUES ('alice', 1), ('carol', NULL)",
+		"UPDATE javatest.foobar_3 SET value = 2 WHERE username = 'alice'",
+		"SELECT" +
+		"  CASE WHEN array_agg(username || '=' || coalesce(value::text, 'null')" +
+		"   ORDER BY username) = ARRAY['alice=2', 'carol=null']" +
+		"  THEN javatest.logmessage('INFO', 'unmodified trigger return ok')" +
+		"  ELSE javatest.logmessage('WARNING', 'unmodified trigger return ng')" +
+		"  END" +
+		" FROM javatest.foobar_3"
+	}
+)
 /*
  * Note for another day: this would seem an excellent place to add a
  * regression test for github issue #134 (make sure invocations of a
@@ -133,6 +152,29 @@ public class Triggers
 				"trigger transition table oval %d nval %d", oval, nval));
 	}
 
+	/**
+	 * Look at the row without changing it, in response to a trigger, so that
+	 * the trigger manager's own tuple is returned as it was.
+	 */
+	@Function(
+		requires = "foobar_3 table",
+		provides = "unmodified triggers",
+		schema = "javatest",
+		security = INVOKER,
+		triggers = {
+			@Trigger(called = BEFORE, scope = ROW, table = "foobar_3",
+					 events = { INSERT, UPDATE } )
+		})
+
+	public static void examineUnmodified(TriggerData td)
+	throws SQLException
+	{
+		ResultSet nrs = td.getNew();
+		if ( null == nrs.getString("username") )
+			throw new SQLIntegrityConstraintViolationException(
+				"username shall not be null", "23000");
+	}
+
 	/**
 	 * Throw exception if value to be inserted is 44.
 	 * Constraint triggers first became available in PostgreSQL 9.1.
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2020 Tada AB and other contributors, as listed below.
+ * Copyright (c) 2018-2026 Tada AB and other contributors, as listed below.
  *
  * All rights reserved. This program and the accompanying materials
  * are made available under the terms of the The BSD 3-Clause License
@@ -275,6 +275,131 @@ import org.postgresql.pljava.example.annotation.ConditionalDDR; // for javadoc
 	"   (rqcls = class OR rqcls = '')" +
 	"   AND roundtripped = orig" +
 	"  ) AS outcome(ok)",
+
+	/*
+	 * Values around the limits of the direct numeric/BigDecimal conversion:
+	 * an unscaled value of up to 18 digits from numeric, 15 to numeric, with
+	 * the text conversion beyond. Comparing as text also checks the scale,
+	 * which numeric equality would ignore.
+	 */
+	" SELECT" +
+	"  CASE WHEN every(outcome.ok)" +
+	"  THEN javatest.logmessage('INFO',    'numeric passes')" +
+	"  ELSE javatest.logmessage('WARNING', 'numeric fails')" +
+	"  END" +
+	" FROM" +
+	"  (VALUES" +
+	"   (numeric '0'), ('0.000'), ('-1.50'), ('1.500')," +
+	"   ('999999999999999'), ('-1000000000000000')," +
+	"   ('999999999999999999'), ('1000000000000000000')," +
+	"   ('-0.000000000000000001'), ('0.0000000000000000001')," +
+	"   ('12345.678901234'), ('99999999.9999999999')" +
+	"  ) AS p(orig)," +
+	"  (VALUES (''), ('java.math.BigDecimal')) as q(rqcls)," +
+	"  roundtrip(p, rqcls) AS (class text, roundtripped numeric)," +
+	"  LATERAL (SELECT" +
+	"   class = 'java.math.BigDecimal'" +
+	"   AND roundtripped::text = orig::text" +
+	"  ) AS outcome(ok)",
+
+	/*
+	 * Nulls at the first and last positions and at every eighth, so at both
+	 * ends of bytes of the null bitmap, the last alone in its byte.
+	 */
+	" SELECT" +
+	"  CASE WHEN every(outcome.ok)" +
+	"  THEN javatest.logmessage('INFO',    'int2[] null bitmap passes')" +
+	"  ELSE javatest.logmessage('WARNING', 'int2[] null bitmap fails')" +
+	"  END" +
+	" FROM" +
+	"  (SELECT array_agg(CASE WHEN i = 1 OR i % 8 = 0 OR i = 25" +
+	"   THEN NULL ELSE i END ORDER BY i)::int2[]" +
+	"   FROM generate_series(1, 25) AS g(i)) AS p(orig)," +
+	"  (VALUES (''), ('[Ljava.lang.Short;'), ('[S')) as q(rqcls)," +
+	"  roundtrip(p, rqcls) AS (class text, roundtripped int2[])," +
+	"  LATERAL (SELECT" +
+	"   (rqcls = class OR rqcls = '')" +
+	"   AND roundtripped =" +
+	"   CASE WHEN class LIKE '[_'" +
+	"   THEN array_replace(orig, null, 0::int2)" +
+	"   ELSE orig END" +
+	"  ) AS outcome(ok)",
+
+	" SELECT" +
+	"  CASE WHEN every(outcome.ok)" +
+	"  THEN javatest.logmessage('INFO',    'int4[] null bitmap passes')" +
+	"  ELSE javatest.logmessage('WARNING', 'int4[] null bitmap fails')" +
+	"  END" +
+	" FROM" +
+	"  (SELECT array_agg(CASE WHEN i = 1 OR i % 8 = 0 OR i = 25" +
+	"   THEN NULL ELSE i END ORDER BY i)::int4[]" +
+	"   FROM generate_series(1, 25) AS g(i)) AS p(orig)," +
+	"  (VALUES (''), ('[Ljava.lang.Integer;'), ('[I')) as q(rqcls)," +
+	"  roundtrip(p, rqcls) AS (class text, roundtripped int4[])," +
+	"  LATERAL (SELECT" +
+	"   (rqcls = class OR rqcls = '')" +
+	"   AND roundtripped =" +
+	"   CASE WHEN class LIKE '[_'" +
+	"   THEN array_replace(orig, null, 0::int4)" +
+	"   ELSE orig END" +
+	"  ) AS outcome(ok)",
+
+	" SELECT" +
+	"  CASE WHEN every(outcome.ok)" +
+	"  THEN javatest.logmessage('INFO',    'int8[] null bitmap passes')" +
+	"  ELSE javatest.logmessage('WARNING', 'int8[] null bitmap fails')" +
+	"  END" +
+	" FROM" +
+	"  (SELECT array_agg(CASE WHEN i = 1 OR i % 8 = 0 OR i = 25" +
+	"   THEN NULL ELSE i END ORDER BY i)::int8[]" +
+	"   FROM generate_series(1, 25) AS g(i)) AS p(orig)," +
+	"  (VALUES (''), ('[Ljava.lang.Long;'), ('[J')) as q(rqcls)," +
+	"  roundtrip(p, rqcls) AS (class text, roundtripped int8[])," +
+	"  LATERAL (SELECT" +
+	"   (rqcls = class OR rqcls = '')" +
+	"   AND roundtripped =" +
+	"   CASE WHEN class LIKE '[_'" +
+	"   THEN array_replace(orig, null, 0::int8)" +
+	"   ELSE orig END" +
+	"  ) AS outcome(ok)",
+
+	" SELECT" +
+	"  CASE WHEN every(outcome.ok)" +
+	"  THEN javatest.logmessage('INFO',    'float4[] null bitmap passes')" +
+	"  ELSE javatest.logmessage('WARNING', 'float4[] null bitmap fails')" +
+	"  END" +
+	" FROM" +
+	"  (SELECT array_agg(CASE WHEN i = 1 OR i % 8 = 0 OR i = 25" +
+	"   THEN NULL ELSE i END ORDER BY i)::float4[]" +
+	"   FROM generate_series(1, 25) AS g(i)) AS p(orig)," +
+	"  (VALUES (''), ('[Ljava.lang.Float;'), ('[F')) as q(rqcls)," +
+	"  roundtrip(p, rqcls) AS (class text, roundtripped float4[])," +
+	"  LATERAL (SELECT" +
+	"   (rqcls = class OR rqcls = '')" +
+	"   AND roundtripped =" +
+	"   CASE WHEN class LIKE '[_'" +
+	"   THEN array_replace(orig, null, 0::float4)" +
+	"   ELSE orig END" +
+	"  ) AS outcome(ok)",
+
+	" SELECT" +
+	"  CASE WHEN every(outcome.ok)" +
+	"  THEN javatest.logmessage('INFO',    'float8[] null bitmap passes')" +
+	"  ELSE javatest.logmessage('WARNING', 'float8[] null bitmap fails')" +
+	"  END" +
+	" FROM" +
+	"  (SELECT array_agg(CASE WHEN i = 1 OR i % 8 = 0 OR i = 25" +
+	"   THEN NULL ELSE i END ORDER BY i)::float8[]" +
+	"   FROM generate_series(1, 25) AS g(i)) AS p(orig)," +
+	"  (VALUES (''), ('[Ljava.lang.Double;'), ('[D')) as q(rqcls)," +
+	"  roundtrip(p, rqcls) AS (class text, roundtripped float8[])," +
+	"  LATERAL (SELECT" +
+	"   (rqcls = class OR rqcls = '')" +
+	"   AND roundtripped =" +
+	"   CASE WHEN class LIKE '[_'" +
+	"   THEN array_replace(orig, null, 0::float8)" +
+	"   ELSE orig END" +
+	"  ) AS outcome(ok)",
 	}
 )
 public class TypeRoundTripper
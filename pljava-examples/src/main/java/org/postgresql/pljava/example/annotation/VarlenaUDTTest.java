@@ -30,18 +30,29 @@ import static org.postgresql.pljava.annotation.Function.Effects.IMMUTABLE;
  * and retrieved. It should be about a GB, but in issue 52 was failing at 32768
  * because of a narrowing assignment in the native code.
  *<p>
+ * As the unary form is the same bytes for equal values, the type is also
+ * declared with {@code binaryEquality}, and the second test counts distinct
+ * values with the native hash operator class that gives it.
+ *<p>
  * This example relies on {@code implementor} tags reflecting the PostgreSQL
  * version, set up in the {@link ConditionalDDR} example.
  */
-@SQLAction(requires="varlena UDT", implementor="postgresql_ge_80300", install=
+@SQLAction(requires="varlena UDT", implementor="postgresql_ge_80300", install={
 "  SELECT CASE v::text = v::javatest.VarlenaUDTTest::text " +
 "   WHEN true THEN javatest.logmessage('INFO', 'works for ' || v) " +
 "   ELSE javatest.logmessage('WARNING', 'fails for ' || v) " +
 "   END " +
 "   FROM (VALUES (('32767')), (('32768')), (('65536')), (('1048576'))) " +
-"   AS t ( v )"
-)
-@BaseUDT(schema="javatest", provides="varlena UDT")
+"   AS t ( v )",
+
+"  SELECT CASE count(*) " +
+"   WHEN 2 THEN javatest.logmessage('INFO', 'binaryEquality works') " +
+"   ELSE javatest.logmessage('WARNING', 'binaryEquality fails') " +
+"   END " +
+"   FROM (SELECT DISTINCT v::javatest.VarlenaUDTTest " +
+"    FROM (VALUES (('3')), (('40')), (('3')), (('40'))) AS t ( v )) AS d"
+})
+@BaseUDT(schema="javatest", provides="varlena UDT", binaryEquality=true)
 public class VarlenaUDTTest implements SQLData {
 	int apop;
 	String typname;
@@ -26,6 +26,16 @@
 #include <catalog/catalog.h>
 #include <catalog/pg_proc.h>
 #include <catalog/pg_type.h>
+#include <access/xact.h>
+#include <utils/acl.h>
+#include <utils/builtins.h>
+#include <utils/resowner.h>
+#if PG_VERSION_NUM < 90500
+#define IsInParallelMode() false
+#endif
+#if PG_VERSION_NUM >= 120000
+#include <nodes/supportnodes.h>
+#endif
 
 #if PG_VERSION_NUM >= 120000
  #ifdef HAVE_DLOPEN
@@ -47,6 +57,7 @@
 
 #include "org_postgresql_pljava_internal_Backend.h"
 #include "org_postgresql_pljava_internal_Backend_EarlyNatives.h"
+#include "pljava/BackgroundJob.h"
 #include "pljava/DualState.h"
 #include "pljava/Invocation.h"
 #include "pljava/InstallHelper.h"
@@ -116,17 +127,56 @@ static bool    s_startingVM;
 static char* libjvmlocation;
 static char* vmoptions;
 static char* modulepath;
+static char* sharedArchive;
+static char* classImageCache;
 static char* implementors;
+static char* preloadFunctionList;
+static char* stacklessSQLStates;
 static char* policy_urls;
 static int   statementCacheSize;
+static int   spiFetchMemory;
+static int   statementCacheMemory;
+static int   srfMaterializeRows;
+static int   varlenaEagerSize;
+static int   dualStateCleanupMemory;
+static int   varlenaParkRatio;
+static int   computeParallelism;
+static int   jobWorkers;
+static int   jobIdleTimeout;
+static int   logBufferSize;
+
+int64 pljavaConfigGeneration;
+static bool  spiColumnarFetch;
+static bool  spiBorrowedTuples;
+static bool  prefetchClasses;
+static bool  warmUpClasses;
 static bool  pljavaDebug;
 static bool  pljavaReleaseLingeringSavepoints;
+static bool  trackFunctions;
+static bool  trackJNI;
+static bool  logCancelStack;
 static bool  pljavaEnabled;
 
 static int   java_thread_pg_entry;
+static int   vmProfile;
 
 static int   s_javaLogLevel;
 
+/*
+ * The codes parsed from pljava.stackless_sqlstates.
+ */
+#define MAX_STACKLESS_SQLSTATES 32
+static int   stacklessCodes[MAX_STACKLESS_SQLSTATES];
+static int   stacklessCount;
+static bool  parseSQLStates(char const *list, int *codes, int *count);
+
+/*
+ * Whether pljava.preload_functions has been set, and not yet acted on, since
+ * the last PL/Java call. It starts out true so a value set before the first
+ * call is acted on then.
+ */
+static bool  preloadPending = true;
+
 #if PG_VERSION_NUM < 100000
 bool integerDateTimes = false;
 static void checkIntTimeType(void);
@@ -163,6 +213,8 @@ static void JVMOptList_delete(JVMOptList*);
 static void JVMOptList_add(JVMOptList*, const char*, void*, bool);
 static void JVMOptList_addVisualVMName(JVMOptList*);
 static void JVMOptList_addModuleMain(JVMOptList*);
+static void JVMOptList_addSharedArchive(JVMOptList*);
+static void JVMOptList_addProfile(JVMOptList*);
 static void addUserJVMOptions(JVMOptList*);
 static char* getModulePath(const char*);
 static jint JNICALL my_vfprintf(FILE*, const char*, va_list)
@@ -171,6 +223,8 @@ static void _destroyJavaVM(int, Datum);
 static void initPLJavaClasses(void);
 static void initJavaSession(void);
 static void reLogWithChangedLevel(int);
+static void warmUpAtSessionStart(void);
+static void preloadFunctions(void);
 
 #ifndef WIN32
 #define USE_PLJAVA_SIGHANDLERS
@@ -207,8 +261,12 @@ static bool alteredSettingsWereNeeded = false;
 static bool loadAsExtensionFailed = false;
 static bool seenVisualVMName;
 static bool seenModuleMain;
+static bool seenSharedArchive;
+static bool seenXshare;
 static char const visualVMprefix[] = "-Dvisualvm.display.name=";
 static char const moduleMainPrefix[] = "-Djdk.module.main=";
+static char const sharedArchivePrefix[] = "-XX:SharedArchiveFile=";
+static char const xsharePrefix[] = "-Xshare:";
 static char const policyUrlsGUC[] = "pljava.policy_urls";
 
 /*
@@ -257,12 +315,18 @@ static void initsequencer(enum initstage is, bool tolerant);
 		char **newval, void **extra, GucSource source);
 	static bool check_modulepath(
 		char **newval, void **extra, GucSource source);
+	static bool check_shared_archive(
+		char **newval, void **extra, GucSource source);
 	static bool check_policy_urls(
 		char **newval, void **extra, GucSource source);
 	static bool check_enabled(
 		bool *newval, void **extra, GucSource source);
 	static bool check_java_thread_pg_entry(
 		int *newval, void **extra, GucSource source);
+	static bool check_vm_profile(
+		int *newval, void **extra, GucSource source);
+	static bool check_stackless_sqlstates(
+		char **newval, void **extra, GucSource source);
 
 	/* Check hooks will always allow "setting" a value that is the same as
 	 * current; otherwise, it would be frustrating to have just found settings
@@ -327,6 +391,25 @@ static void initsequencer(enum initstage is, bool tolerant);
 		return false;
 	}
 
+	static bool check_shared_archive(
+		char **newval, void **extra, GucSource source)
+	{
+		if ( initstage < IS_JAVAVM_OPTLIST )
+			return true;
+		if ( sharedArchive == *newval )
+			return true;
+		if ( sharedArchive && *newval && 0 == strcmp(sharedArchive, *newval) )
+			return true;
+		GUC_check_errmsg(
+			"too late to change \"pljava.shared_archive\" setting");
+		GUC_check_errdetail(
+			"Changing the setting has no effect after "
+			"PL/Java has started the Java virtual machine.");
+		GUC_check_errhint(
+			"To try a different value, exit this session and start a new one.");
+		return false;
+	}
+
 	static bool check_policy_urls(
 		char **newval, void **extra, GucSource source)
 	{
@@ -377,6 +460,37 @@ static void initsequencer(enum initstage is, bool tolerant);
 			"For another chance, exit this session and start a new one.");
 		return false;
 	}
+
+	static bool check_vm_profile(
+		int *newval, void **extra, GucSource source)
+	{
+		if ( initstage < IS_JAVAVM_OPTLIST )
+			return true;
+		if ( vmProfile == *newval )
+			return true;
+		GUC_check_errmsg(
+			"too late to change \"pljava.vm_profile\" setting");
+		GUC_check_errdetail(
+			"Changing the setting has no effect after "
+			"PL/Java has started the Java virtual machine.");
+		GUC_check_errhint(
+			"To try a different value, exit this session and start a new one.");
+		return false;
+	}
+
+	static bool check_stackless_sqlstates(
+		char **newval, void **extra, GucSource source)
+	{
+		int codes[MAX_STACKLESS_SQLSTATES];
+		int count;
+
+		if ( parseSQLStates(*newval, codes, &count) )
+			return true;
+		GUC_check_errdetail(
+			"The value must be a comma-separated list of at most %d "
+			"five-character SQLSTATE codes.", MAX_STACKLESS_SQLSTATES);
+		return false;
+	}
 #endif
 
 #if PG_VERSION_NUM < 90100
@@ -422,6 +536,17 @@ static const struct config_enum_entry java_thread_pg_entry_options[] = {
 	{NULL, 0, false}
 };
 
+#define VM_PROFILE_DEFAULT 0
+#define VM_PROFILE_SMALL 1
+#define VM_PROFILE_SMALL_EPSILON 2
+
+static const struct config_enum_entry vm_profile_options[] = {
+	{"default", VM_PROFILE_DEFAULT, false},
+	{"small", VM_PROFILE_SMALL, false},
+	{"small_epsilon", VM_PROFILE_SMALL_EPSILON, false},
+	{NULL, 0, false}
+};
+
 ASSIGNSTRINGHOOK(libjvm_location)
 {
 	ASSIGNRETURNIFCHECK(newval);
@@ -461,6 +586,19 @@ ASSIGNSTRINGHOOK(modulepath)
 	ASSIGNRETURN(newval);
 }
 
+ASSIGNSTRINGHOOK(shared_archive)
+{
+	ASSIGNRETURNIFCHECK(newval);
+	sharedArchive = (char *)newval;
+	if ( IS_FORMLESS_VOID < initstage && initstage < IS_JAVAVM_OPTLIST )
+	{
+		ASSIGNRETURNIFNXACT(newval);
+		alteredSettingsWereNeeded = true;
+		initsequencer( initstage, true);
+	}
+	ASSIGNRETURN(newval);
+}
+
 ASSIGNSTRINGHOOK(policy_urls)
 {
 	ASSIGNRETURNIFCHECK(newval);
@@ -474,6 +612,63 @@ ASSIGNSTRINGHOOK(policy_urls)
 	ASSIGNRETURN(newval);
 }
 
+ASSIGNSTRINGHOOK(preload_functions)
+{
+	ASSIGNRETURNIFCHECK(newval);
+	preloadFunctionList = (char *)newval;
+	preloadPending = true;
+	ASSIGNRETURN(newval);
+}
+
+ASSIGNSTRINGHOOK(stackless_sqlstates)
+{
+	ASSIGNRETURNIFCHECK(newval);
+	stacklessSQLStates = (char *)newval;
+	if ( ! parseSQLStates(newval, stacklessCodes, &stacklessCount) )
+		stacklessCount = 0;
+	ASSIGNRETURN(newval);
+}
+
+/*
+ * Parse a comma-separated list of SQLSTATE codes into codes (which has room
+ * for MAX_STACKLESS_SQLSTATES), returning false if the list is malformed.
+ */
+static bool parseSQLStates(char const *list, int *codes, int *count)
+{
+	char const *p = list;
+
+	*count = 0;
+	if ( NULL == p )
+		return true;
+	for ( ;; )
+	{
+		char code[5];
+		int len = 0;
+
+		while ( isspace((unsigned char)*p) )
+			++ p;
+		if ( '\0' == *p )
+			return true;
+		while ( '\0' != *p  &&  ',' != *p  &&  ! isspace((unsigned char)*p) )
+		{
+			if ( 5 == len  ||  ! ( isdigit((unsigned char)*p)
+				|| ( 'A' <= *p  &&  *p <= 'Z' ) ) )
+				return false;
+			code[len ++] = *p ++;
+		}
+		while ( isspace((unsigned char)*p) )
+			++ p;
+		if ( 5 != len  ||  MAX_STACKLESS_SQLSTATES == *count )
+			return false;
+		codes[(*count) ++] =
+			MAKE_SQLSTATE(code[0], code[1], code[2], code[3], code[4]);
+		if ( '\0' == *p )
+			return true;
+		if ( ',' != *p ++ )
+			return false;
+	}
+}
+
 ASSIGNHOOK(enabled, bool)
 {
 	ASSIGNRETURNIFCHECK(true);
@@ -653,11 +848,16 @@ static void initsequencer(enum initstage is, bool tolerant)
 		JVMOptList_init(&optList); /* uses CurrentMemoryContext */
 		seenVisualVMName = false;
 		seenModuleMain = false;
+		seenSharedArchive = false;
+		seenXshare = false;
 		addUserJVMOptions(&optList);
 		if ( ! seenVisualVMName )
 			JVMOptList_addVisualVMName(&optList);
 		if ( ! seenModuleMain )
 			JVMOptList_addModuleMain(&optList);
+		if ( ! seenSharedArchive )
+			JVMOptList_addSharedArchive(&optList);
+		JVMOptList_addProfile(&optList);
 		JVMOptList_add(&optList, "vfprintf", (void*)my_vfprintf, true);
 #ifndef GCJ
 		JVMOptList_add(&optList, "-Xrs", 0, true);
@@ -983,6 +1183,48 @@ void _PG_init()
 	else
 		pljavaCheckExtension( NULL);
 	initsequencer( initstage, true);
+
+	if ( IS_COMPLETE == initstage && ! IsTransactionState() )
+		warmUpAtSessionStart();
+}
+
+/*
+ * When this library is named in session_preload_libraries, _PG_init runs as
+ * the connection is set up, outside of any transaction, and the initsequencer
+ * has just started the JVM there, before the first query. The functions named
+ * in pljava.preload_functions (which may have come from ALTER DATABASE or
+ * ALTER ROLE, applied before the libraries are loaded) are then resolved too,
+ * in a transaction of their own, rather than at the first PL/Java call.
+ *
+ * No PL/Java function has been called yet to say which library PL/Java is, so
+ * the library of the java language's call handler is taken to be it.
+ * Failures only warn; the connection goes ahead.
+ */
+static void warmUpAtSessionStart(void)
+{
+	MemoryContext oldContext = CurrentMemoryContext;
+
+	if ( ! IsUnderPostmaster  ||  InvalidOid == MyDatabaseId )
+		return;
+	if ( ! preloadPending
+		|| NULL == preloadFunctionList  ||  '\0' == *preloadFunctionList )
+		return;
+
+	StartTransactionCommand();
+	PG_TRY();
+	{
+		InstallHelper_assumeLoadPathOf("java");
+		preloadFunctions();
+		CommitTransactionCommand();
+	}
+	PG_CATCH();
+	{
+		MemoryContextSwitchTo(oldContext);
+		reLogWithChangedLevel(WARNING);
+		AbortCurrentTransaction();
+	}
+	PG_END_TRY();
+	MemoryContextSwitchTo(oldContext);
 }
 
 static void initPLJavaClasses(void)
@@ -1012,6 +1254,16 @@ static void initPLJavaClasses(void)
 		Java_org_postgresql_pljava_internal_Backend__1getStatementCacheSize
 		},
 		{
+		"_getStatementCacheMemory",
+		"()I",
+		Java_org_postgresql_pljava_internal_Backend__1getStatementCacheMemory
+		},
+		{
+		"_getSPIFetchMemory",
+		"()I",
+		Java_org_postgresql_pljava_internal_Backend__1getSPIFetchMemory
+		},
+		{
 		"_log",
 		"(ILjava/lang/String;)V",
 		Java_org_postgresql_pljava_internal_Backend__1log
@@ -1022,6 +1274,11 @@ static void initPLJavaClasses(void)
 		Java_org_postgresql_pljava_internal_Backend__1clearFunctionCache
 		},
 		{
+		"_clearFunctionCacheForLoader",
+		"(Ljava/lang/ClassLoader;)V",
+		Java_org_postgresql_pljava_internal_Backend__1clearFunctionCacheForLoader
+		},
+		{
 		"_isCreatingExtension",
 		"()Z",
 		Java_org_postgresql_pljava_internal_Backend__1isCreatingExtension
@@ -1036,6 +1293,46 @@ static void initPLJavaClasses(void)
 		"(Ljava/lang/Class;Ljava/lang/Object;)V",
 		Java_org_postgresql_pljava_internal_Backend__1pokeJEP411
 		},
+		{
+		"_jniStatistics",
+		"()[J",
+		Java_org_postgresql_pljava_internal_Backend__1jniStatistics
+		},
+		{
+		"_messageLevel",
+		"(Z)Ljava/nio/ByteBuffer;",
+		Java_org_postgresql_pljava_internal_Backend__1messageLevel
+		},
+		{
+		"_logBufferSize",
+		"()Ljava/nio/ByteBuffer;",
+		Java_org_postgresql_pljava_internal_Backend__1logBufferSize
+		},
+		{
+		"_configGeneration",
+		"()Ljava/nio/ByteBuffer;",
+		Java_org_postgresql_pljava_internal_Backend__1configGeneration
+		},
+		{
+		"_logBuffered",
+		"([I[Ljava/lang/String;I)V",
+		Java_org_postgresql_pljava_internal_Backend__1logBuffered
+		},
+		{
+		"_getJobWorkers",
+		"()I",
+		Java_org_postgresql_pljava_internal_Backend__1getJobWorkers
+		},
+		{
+		"_launchJobWorker",
+		"(I)Z",
+		Java_org_postgresql_pljava_internal_Backend__1launchJobWorker
+		},
+		{
+		"_isInterruptPending",
+		"()Z",
+		Java_org_postgresql_pljava_internal_Backend__1isInterruptPending
+		},
 		{ 0, 0, 0 }
 	};
 
@@ -1099,6 +1396,78 @@ static void initPLJavaClasses(void)
 	InstallHelper_initialize();
 }
 
+int Backend_getSRFMaterializeRows(void)
+{
+	return srfMaterializeRows;
+}
+
+Size Backend_getDualStateCleanupMemory(void)
+{
+	return (Size)1024 * dualStateCleanupMemory;
+}
+
+Size Backend_getVarlenaEagerSize(void)
+{
+	return (Size)varlenaEagerSize * 1024;
+}
+
+int Backend_getVarlenaParkRatio(void)
+{
+	return varlenaParkRatio;
+}
+
+bool Backend_isLogCancelStack(void)
+{
+	return logCancelStack;
+}
+
+bool Backend_isTrackFunctions(void)
+{
+	return trackFunctions;
+}
+
+bool Backend_isSPIBorrowedTuples(void)
+{
+	return spiBorrowedTuples;
+}
+
+bool Backend_isSPIColumnarFetch(void)
+{
+	return spiColumnarFetch;
+}
+
+bool Backend_isStacklessSQLState(int sqlerrcode)
+{
+	int i;
+
+	for ( i = 0; i < stacklessCount; ++ i )
+		if ( stacklessCodes[i] == sqlerrcode )
+			return true;
+	return false;
+}
+
+int Backend_getJobWorkers(void)
+{
+	return jobWorkers;
+}
+
+int Backend_getJobIdleTimeout(void)
+{
+	return jobIdleTimeout;
+}
+
+void Backend_initializeInWorker(void)
+{
+	if ( IS_COMPLETE != initstage )
+	{
+		deferInit = false;
+		initsequencer( initstage, false);
+	}
+
+	if ( preloadPending )
+		preloadFunctions();
+}
+
 int Backend_setJavaLogLevel(int logLevel)
 {
 	int oldLevel = s_javaLogLevel;
@@ -1480,6 +1849,13 @@ static void JVMOptList_add(JVMOptList* jol, const char* optString, void* extraIn
 	if ( 0 == strncmp(optString, moduleMainPrefix, sizeof moduleMainPrefix-1) )
 		seenModuleMain = true;
 
+	if ( 0 == strncmp(optString,
+			sharedArchivePrefix, sizeof sharedArchivePrefix - 1) )
+		seenSharedArchive = true;
+
+	if ( 0 == strncmp(optString, xsharePrefix, sizeof xsharePrefix - 1) )
+		seenXshare = true;
+
 	elog(DEBUG2, "Added JVM option string \"%s\"", optString);
 }
 
@@ -1506,6 +1882,96 @@ static void JVMOptList_addModuleMain(JVMOptList* jol)
 	JVMOptList_add(jol, buf.data, 0, false);
 }
 
+/*
+ * If pljava.shared_archive names a class data sharing archive, and
+ * pljava.vmoptions did not already name one, add the option to use it, with
+ * -Xshare:auto (unless some -Xshare: option was given) so that a missing or
+ * mismatched archive only forgoes the speedup rather than failing startup.
+ */
+static void JVMOptList_addSharedArchive(JVMOptList* jol)
+{
+	StringInfoData buf;
+	if ( NULL == sharedArchive  ||  '\0' == *sharedArchive )
+		return;
+	initStringInfo(&buf);
+	appendStringInfo(&buf, "%s%s", sharedArchivePrefix, sharedArchive);
+	JVMOptList_add(jol, buf.data, 0, false);
+	if ( ! seenXshare )
+		JVMOptList_add(jol, "-Xshare:auto", 0, true);
+}
+
+/*
+ * Whether an option beginning with prefix is already in the list.
+ */
+static bool JVMOptList_has(JVMOptList* jol, char const *prefix)
+{
+	size_t len = strlen(prefix);
+	int i;
+	for ( i = 0 ; i < jol->size ; ++ i )
+		if ( 0 == strncmp(jol->options[i].optionString, prefix, len) )
+			return true;
+	return false;
+}
+
+/*
+ * Whether the list already chooses a garbage collector, with some
+ * -XX:+Use...GC option.
+ */
+static bool JVMOptList_hasGC(JVMOptList* jol)
+{
+	int i;
+	for ( i = 0 ; i < jol->size ; ++ i )
+	{
+		char const *o = jol->options[i].optionString;
+		size_t len = strlen(o);
+		if ( 0 == strncmp(o, "-XX:+Use", 8)
+			&&  len > 10  &&  0 == strcmp(o + len - 2, "GC") )
+			return true;
+	}
+	return false;
+}
+
+/*
+ * For a pljava.vm_profile other than default, add the options of the profile
+ * for which pljava.vmoptions has not already given a value of its own: a
+ * small heap, metaspace, and code cache, a smaller thread stack, only the
+ * client compiler, and the serial collector (or, for small_epsilon, the
+ * Epsilon collector, which never reclaims anything and suits only sessions
+ * too short to fill the heap). The sizes are what a backend running modest
+ * functions needs; a session that outgrows them fails with OutOfMemoryError,
+ * and pljava.vmoptions can raise any one of them.
+ */
+static void JVMOptList_addProfile(JVMOptList* jol)
+{
+	if ( VM_PROFILE_DEFAULT == vmProfile )
+		return;
+
+	if ( ! JVMOptList_has(jol, "-Xmx") )
+		JVMOptList_add(jol, "-Xmx64m", 0, true);
+	if ( ! JVMOptList_has(jol, "-Xms") )
+		JVMOptList_add(jol, "-Xms8m", 0, true);
+	if ( ! JVMOptList_has(jol, "-Xss") )
+		JVMOptList_add(jol, "-Xss512k", 0, true);
+	if ( ! JVMOptList_has(jol, "-XX:MaxMetaspaceSize=") )
+		JVMOptList_add(jol, "-XX:MaxMetaspaceSize=64m", 0, true);
+	if ( ! JVMOptList_has(jol, "-XX:ReservedCodeCacheSize=") )
+		JVMOptList_add(jol, "-XX:ReservedCodeCacheSize=16m", 0, true);
+	if ( ! JVMOptList_has(jol, "-XX:TieredStopAtLevel=") )
+		JVMOptList_add(jol, "-XX:TieredStopAtLevel=1", 0, true);
+	if ( ! JVMOptList_has(jol, "-XX:CICompilerCount=") )
+		JVMOptList_add(jol, "-XX:CICompilerCount=1", 0, true);
+	if ( JVMOptList_hasGC(jol) )
+		return;
+	if ( VM_PROFILE_SMALL_EPSILON == vmProfile )
+	{
+		if ( ! JVMOptList_has(jol, "-XX:+UnlockExperimentalVMOptions") )
+			JVMOptList_add(jol, "-XX:+UnlockExperimentalVMOptions", 0, true);
+		JVMOptList_add(jol, "-XX:+UseEpsilonGC", 0, true);
+	}
+	else
+		JVMOptList_add(jol, "-XX:+UseSerialGC", 0, true);
+}
+
 /* Split JVM options. The string is split on whitespace unless the
  * whitespace is found within a string or is escaped by backslash. A
  * backslash escaped quote is not considered a string delimiter.
@@ -1737,6 +2203,33 @@ static void registerGUCOptions(void)
 		assign_modulepath,
 		NULL); /* show hook */
 
+	STRING_GUC(
+		"pljava.shared_archive",
+		"Java class data sharing archive to be used by the JVM",
+		"Adds -XX:SharedArchiveFile with this file to the JVM options, unless "
+		"pljava.vmoptions already has one. sqlj.dump_shared_archive can write "
+		"an archive of the classes loaded in a running session.",
+		&sharedArchive,
+		NULL, /* boot value */
+		PGC_SUSET,
+		GUC_SUPERUSER_ONLY,    /* flags */
+		check_shared_archive,
+		assign_shared_archive,
+		NULL); /* show hook */
+
+	STRING_GUC(
+		"pljava.class_image_cache",
+		"Directory in which to cache the class images of installed jars",
+		"If set, install_jar and replace_jar write the class images of jars "
+		"to files here, and class loaders map them from here rather than "
+		"querying sqlj.jar_entry. Read once in a session, when first needed.",
+		&classImageCache,
+		NULL, /* boot value */
+		PGC_SUSET,
+		GUC_SUPERUSER_ONLY,    /* flags */
+		NULL, /* check hook */
+		NULL, NULL); /* assign hook, show hook */
+
 	STRING_GUC(
 		policyUrlsGUC,
 		"URLs to Java security policy file(s) for PL/Java's use",
@@ -1778,45 +2271,338 @@ static void registerGUCOptions(void)
 		NULL, /* check hook */
 		NULL, NULL); /* assign hook, show hook */
 
-	BOOL_GUC(
-		"pljava.release_lingering_savepoints",
-		"If true, lingering savepoints will be released on function exit. "
-		"If false, they will be rolled back",
-		NULL, /* extended description */
-		&pljavaReleaseLingeringSavepoints,
-		false, /* boot value */
+	INT_GUC(
+		"pljava.statement_cache_memory",
+		"Memory limit for the prepared statement MRU cache",
+		"If nonzero, least-recently-used plans are evicted from the cache "
+		"while the plans in it occupy more memory than this, as well as when "
+		"it holds more than pljava.statement_cache_size plans.",
+		&statementCacheMemory,
+		0,    /* boot value */
+		0, MAX_KILOBYTES,   /* min, max values */
 		PGC_USERSET,
-		0,    /* flags */
+		GUC_UNIT_KB, /* flags */
 		NULL, /* check hook */
 		NULL, NULL); /* assign hook, show hook */
 
-	BOOL_GUC(
-		"pljava.enable",
-		"If off, the Java virtual machine will not be started until set on.",
-		"This is mostly of use on PostgreSQL versions < 9.2, where option "
-		"settings changed before LOADing PL/Java may be rejected, so they must "
-		"be made after LOAD, but before the virtual machine is started.",
-		&pljavaEnabled,
-		PLJAVA_ENABLE_DEFAULT, /* boot value */
+	INT_GUC(
+		"pljava.srf_materialize_rows",
+		"If positive, set-returning functions produce all rows in one call, "
+		"resetting row memory after each this many rows",
+		"When the calling context accepts a materialized result, the rows of "
+		"a PL/Java set-returning function are then all gathered into a "
+		"tuplestore in a single call, rather than returned one per call. "
+		"Zero keeps the value-per-call protocol.",
+		&srfMaterializeRows,
+		0,    /* boot value */
+		0, INT_MAX,   /* min, max values */
 		PGC_USERSET,
 		0,    /* flags */
-		check_enabled, /* check hook */
-		assign_enabled,
-		NULL); /* show hook */
-
-	STRING_GUC(
-		"pljava.implementors",
-		"Implementor names recognized in deployment descriptors",
-		NULL, /* extended description */
-		&implementors,
-		"postgresql", /* boot value */
-		PGC_USERSET,
-		PLJAVA_IMPLEMENTOR_FLAGS,
 		NULL, /* check hook */
 		NULL, NULL); /* assign hook, show hook */
 
-	ENUM_GUC(
-		"pljava.java_thread_pg_entry",
+	INT_GUC(
+		"pljava.compute_parallelism",
+		"Number of worker threads for parallel Java computation in a session",
+		"The threads are started as needed when a function first submits work "
+		"through Session.parallelCompute(). Zero means the number of "
+		"processors available to the Java virtual machine. The setting is "
+		"read once, when the threads are first needed.",
+		&computeParallelism,
+		0,    /* boot value */
+		0, 32767,   /* min, max values */
+		PGC_SUSET,
+		0,    /* flags */
+		NULL, /* check hook */
+		NULL, NULL); /* assign hook, show hook */
+
+	INT_GUC(
+		"pljava.job_workers",
+		"Most background workers running PL/Java jobs for one role in one "
+		"database",
+		"Jobs queued with sqlj.submit_job or Session.backgroundJobs() are run "
+		"by background workers that connect as the submitting role, start "
+		"Java once, and run queued jobs one after another. Submitting a job "
+		"starts another worker when fewer than this many are running and more "
+		"jobs are queued than workers. Zero leaves jobs queued. The workers "
+		"also count against max_worker_processes.",
+		&jobWorkers,
+		2,    /* boot value */
+		0, 1024,   /* min, max values */
+		PGC_SUSET,
+		0,    /* flags */
+		NULL, /* check hook */
+		NULL, NULL); /* assign hook, show hook */
+
+	INT_GUC(
+		"pljava.job_idle_timeout",
+		"Time a PL/Java job worker waits for another job before exiting",
+		NULL, /* extended description */
+		&jobIdleTimeout,
+		300,  /* boot value */
+		0, INT_MAX / 1000,   /* min, max values */
+		PGC_SIGHUP,
+		GUC_UNIT_S, /* flags */
+		NULL, /* check hook */
+		NULL, NULL); /* assign hook, show hook */
+
+	INT_GUC(
+		"pljava.log_buffer",
+		"If positive, log records from Java are buffered and passed to "
+		"PostgreSQL this many at a time",
+		"Buffered records are passed in one call when the buffer fills and "
+		"when the PL/Java function that logged them returns. Records at "
+		"level ERROR, and any buffered before them, are always passed at once. "
+		"Zero passes every record as it is published.",
+		&logBufferSize,
+		0,    /* boot value */
+		0, 65536,   /* min, max values */
+		PGC_USERSET,
+		0,    /* flags */
+		NULL, /* check hook */
+		NULL, NULL); /* assign hook, show hook */
+
+	BOOL_GUC(
+		"pljava.prefetch_classes",
+		"If true, a class loader's first miss in a jar fetches the images of "
+		"all that jar's classes in one query",
+		NULL, /* extended description */
+		&prefetchClasses,
+		false, /* boot value */
+		PGC_USERSET,
+		0,    /* flags */
+		NULL, /* check hook */
+		NULL, NULL); /* assign hook, show hook */
+
+	BOOL_GUC(
+		"pljava.warm_up_classes",
+		"If true, a new class loader fetches the images of all classes on its "
+		"class path in one query and defines them on parallel worker threads",
+		"The number of threads is pljava.compute_parallelism. Classes are "
+		"defined but not initialized; any that cannot be defined ahead are "
+		"loaded as usual when first needed.",
+		&warmUpClasses,
+		false, /* boot value */
+		PGC_USERSET,
+		0,    /* flags */
+		NULL, /* check hook */
+		NULL, NULL); /* assign hook, show hook */
+
+	BOOL_GUC(
+		"pljava.spi_borrowed_tuples",
+		"If true, SPI result set fetches leave the rows in the SPI tuple table, "
+		"freed when the result set moves past them, instead of copying them",
+		NULL, /* extended description */
+		&spiBorrowedTuples,
+		false, /* boot value */
+		PGC_USERSET,
+		0,    /* flags */
+		NULL, /* check hook */
+		NULL, NULL); /* assign hook, show hook */
+
+	BOOL_GUC(
+		"pljava.spi_columnar_fetch",
+		"If true, SPI result set fetches also deform fixed-width numeric and "
+		"boolean columns natively into Java arrays",
+		NULL, /* extended description */
+		&spiColumnarFetch,
+		false, /* boot value */
+		PGC_USERSET,
+		0,    /* flags */
+		NULL, /* check hook */
+		NULL, NULL); /* assign hook, show hook */
+
+	INT_GUC(
+		"pljava.spi_fetch_memory",
+		"Memory to aim for in each batch of rows a ResultSet fetches over SPI",
+		"If nonzero, the number of rows fetched at a time is adjusted, from one "
+		"batch to the next, toward the number that would occupy about this "
+		"much memory. If zero, the fetch size is fixed.",
+		&spiFetchMemory,
+		0,    /* boot value */
+		0, MAX_KILOBYTES,   /* min, max values */
+		PGC_USERSET,
+		GUC_UNIT_KB,    /* flags */
+		NULL, /* check hook */
+		NULL, NULL); /* assign hook, show hook */
+
+	INT_GUC(
+		"pljava.dualstate_cleanup_memory",
+		"Growth of PL/Java's native object memory that prompts cleanup of "
+		"native state Java no longer reaches",
+		"Checked every few hundred constructions of objects with native state, "
+		"so a function making many of them between fetches does not let "
+		"unreachable ones accumulate. Zero means they are cleaned only at "
+		"fetches and function returns.",
+		&dualStateCleanupMemory,
+		1024, /* boot value */
+		0, MAX_KILOBYTES,   /* min, max values */
+		PGC_USERSET,
+		GUC_UNIT_KB, /* flags */
+		NULL, /* check hook */
+		NULL, NULL); /* assign hook, show hook */
+
+	INT_GUC(
+		"pljava.varlena_eager_size",
+		"Size below which a varlena value passed to Java is detoasted at once",
+		"A larger value given to Java as a stream or SQLXML may instead be "
+		"kept in its stored form (parked) and detoasted only when Java first "
+		"reads it, subject also to pljava.varlena_park_ratio.",
+		&varlenaEagerSize,
+		4,    /* boot value */
+		0, MAX_KILOBYTES,   /* min, max values */
+		PGC_USERSET,
+		GUC_UNIT_KB, /* flags */
+		NULL, /* check hook */
+		NULL, NULL); /* assign hook, show hook */
+
+	INT_GUC(
+		"pljava.varlena_park_ratio",
+		"Largest stored size, as a percentage of the detoasted size, of a "
+		"varlena value Java may hold undetoasted until read",
+		"A value stored in a larger proportion of its full size than this is "
+		"detoasted at once rather than parked, as parking it saves too little. "
+		"Zero means values are never parked.",
+		&varlenaParkRatio,
+		50,   /* boot value */
+		0, 100,   /* min, max values */
+		PGC_USERSET,
+		0,    /* flags */
+		NULL, /* check hook */
+		NULL, NULL); /* assign hook, show hook */
+
+	BOOL_GUC(
+		"pljava.release_lingering_savepoints",
+		"If true, lingering savepoints will be released on function exit. "
+		"If false, they will be rolled back",
+		NULL, /* extended description */
+		&pljavaReleaseLingeringSavepoints,
+		false, /* boot value */
+		PGC_USERSET,
+		0,    /* flags */
+		NULL, /* check hook */
+		NULL, NULL); /* assign hook, show hook */
+
+	BOOL_GUC(
+		"pljava.log_cancel_stack",
+		"If true, the Java stack is logged when a query cancel reaches Java",
+		"When a cancel, as by statement_timeout, is noticed by PostgreSQL code "
+		"called from Java, the Java stack at that call is logged at level "
+		"WARNING along with the error, showing where the Java code was.",
+		&logCancelStack,
+		false, /* boot value */
+		PGC_SUSET,
+		0,    /* flags */
+		NULL, /* check hook */
+		NULL, NULL); /* assign hook, show hook */
+
+	BOOL_GUC(
+		"pljava.track_functions",
+		"If true, calls of PL/Java functions are counted and timed",
+		"The counts and times, per function, are returned by "
+		"sqlj.function_stats() and shown by the MXBean "
+		"org.postgresql.pljava:type=Function,name=FunctionStatistics.",
+		&trackFunctions,
+		false, /* boot value */
+		PGC_USERSET,
+		0,    /* flags */
+		NULL, /* check hook */
+		NULL, NULL); /* assign hook, show hook */
+
+	BOOL_GUC(
+		"pljava.track_jni",
+		"If true, crossings of the JNI boundary are reported for each "
+		"transaction",
+		"At the end of each top-level transaction in which PL/Java called "
+		"into Java, the numbers of calls into Java and back into PostgreSQL, "
+		"of local references made, and of string bytes converted in each "
+		"direction are reported at level INFO. The running totals for the "
+		"session are returned by sqlj.jni_statistics() whatever this setting.",
+		&trackJNI,
+		false, /* boot value */
+		PGC_USERSET,
+		0,    /* flags */
+		NULL, /* check hook */
+		NULL, NULL); /* assign hook, show hook */
+
+	BOOL_GUC(
+		"pljava.enable",
+		"If off, the Java virtual machine will not be started until set on.",
+		"This is mostly of use on PostgreSQL versions < 9.2, where option "
+		"settings changed before LOADing PL/Java may be rejected, so they must "
+		"be made after LOAD, but before the virtual machine is started.",
+		&pljavaEnabled,
+		PLJAVA_ENABLE_DEFAULT, /* boot value */
+		PGC_USERSET,
+		0,    /* flags */
+		check_enabled, /* check hook */
+		assign_enabled,
+		NULL); /* show hook */
+
+	STRING_GUC(
+		"pljava.implementors",
+		"Implementor names recognized in deployment descriptors",
+		NULL, /* extended description */
+		&implementors,
+		"postgresql", /* boot value */
+		PGC_USERSET,
+		PLJAVA_IMPLEMENTOR_FLAGS,
+		NULL, /* check hook */
+		NULL, NULL); /* assign hook, show hook */
+
+	STRING_GUC(
+		"pljava.preload_functions",
+		"PL/Java functions to be resolved before they are first called",
+		"A comma-separated list of function signatures, as accepted by "
+		"regprocedure, such as myschema.f(integer,text). At the first call of "
+		"any PL/Java function after this is set, each one listed is looked up "
+		"and prepared for calling, so later first calls do not pay that "
+		"cost. A listed function that cannot be prepared draws a warning.",
+		&preloadFunctionList,
+		NULL, /* boot value */
+		PGC_USERSET,
+		GUC_LIST_INPUT,
+		NULL, /* check hook */
+		assign_preload_functions,
+		NULL); /* show hook */
+
+	STRING_GUC(
+		"pljava.stackless_sqlstates",
+		"SQLSTATEs of PostgreSQL errors made into Java exceptions without "
+		"a stack trace",
+		"A comma-separated list of SQLSTATE codes, such as 23505 for "
+		"unique_violation. An error with one of them, caught by Java code "
+		"that expects it (inserting, and updating instead on a duplicate "
+		"key, for example), is made into a ServerException without the cost "
+		"of capturing the Java stack. Its stack trace is empty.",
+		&stacklessSQLStates,
+		"23505,23503,23514,40001,40P01", /* boot value */
+		PGC_USERSET,
+		GUC_LIST_INPUT,
+		check_stackless_sqlstates,
+		assign_stackless_sqlstates,
+		NULL); /* show hook */
+
+	ENUM_GUC(
+		"pljava.vm_profile",
+		"A set of JVM options for a smaller footprint per backend",
+		"If 'small', options are added for a 64 MB heap, metaspace limited "
+		"to 64 MB, a 16 MB code cache, 512 kB thread stacks, only the client "
+		"compiler, and the serial garbage collector; 'small_epsilon' is the "
+		"same but with the Epsilon collector, which never frees anything, "
+		"for short sessions. Any of these given in pljava.vmoptions is used "
+		"instead. sqlj.memory_usage() reports what a session uses.",
+		&vmProfile,
+		ENUMBOOTVAL(vm_profile_options[0]), /* default */
+		vm_profile_options,
+		PGC_SUSET,
+		GUC_SUPERUSER_ONLY,    /* flags */
+		check_vm_profile, /* check hook */
+		NULL, /* assign hook */
+		NULL); /* display hook */
+
+	ENUM_GUC(
+		"pljava.java_thread_pg_entry",
 		"Policy for entry to PG code by Java threads other than the main one",
 		"If 'allow', any Java thread can enter PG while the main thread has "
 		"entered Java. If 'error', any thread other than the main one will "
@@ -1893,6 +2679,9 @@ internalCallHandler(bool trusted, PG_FUNCTION_ARGS)
 		initsequencer( initstage, false);
 	}
 
+	if ( preloadPending )
+		preloadFunctions();
+
 	Invocation_pushInvocation(&ctx);
 	PG_TRY();
 	{
@@ -1909,6 +2698,226 @@ internalCallHandler(bool trusted, PG_FUNCTION_ARGS)
 	return retval;
 }
 
+/*
+ * Split the pljava.preload_functions list at the commas not within
+ * parentheses or double quotes, returning a List of the trimmed signatures,
+ * which are written into (and point into) the list string passed.
+ */
+static List *splitSignatureList(char *list)
+{
+	List *result = NIL;
+	char *start = list;
+	char *p;
+	int depth = 0;
+	bool quoted = false;
+
+	for ( p = list ;; ++ p )
+	{
+		if ( '"' == *p )
+			quoted = ! quoted;
+		else if ( quoted  &&  '\0' != *p )
+			continue;
+		else if ( '(' == *p )
+			++ depth;
+		else if ( ')' == *p )
+			-- depth;
+		else if ( '\0' == *p  ||  ( ',' == *p  &&  0 >= depth ) )
+		{
+			bool atEnd = '\0' == *p;
+			char *end = p;
+			while ( start < end  &&  isspace((unsigned char)*start) )
+				++ start;
+			while ( start < end  &&  isspace((unsigned char)end[-1]) )
+				-- end;
+			*end = '\0';
+			if ( start < end )
+				result = lappend(result, start);
+			if ( atEnd )
+				break;
+			start = p + 1;
+		}
+	}
+	return result;
+}
+
+/*
+ * Prepare one function named in pljava.preload_functions, in a subtransaction
+ * so that a failure (a mistyped signature, a function not in PL/Java, one the
+ * user may not execute, a class that cannot be loaded, or the subtransaction
+ * itself not starting) costs only a warning and leaves the call that
+ * occasioned the preloading unaffected.
+ *
+ * The variable can be set by any user, so the user must have EXECUTE
+ * permission on a function for it to be prepared, as for calling it.
+ */
+static void preloadFunction(char *signature)
+{
+	MemoryContext oldContext = CurrentMemoryContext;
+	ResourceOwner oldOwner = CurrentResourceOwner;
+	volatile bool inSubTransaction = false;
+
+	PG_TRY();
+	{
+		Invocation ctx;
+		bool trusted;
+		Oid funcoid;
+		AclResult aclresult;
+
+		BeginInternalSubTransaction(NULL);
+		inSubTransaction = true;
+		MemoryContextSwitchTo(oldContext);
+
+		funcoid = DatumGetObjectId(DirectFunctionCall1(
+			regprocedurein, CStringGetDatum(signature)));
+
+		if ( ! InstallHelper_isPLJavaFunction(funcoid, NULL, &trusted) )
+			ereport(ERROR, (
+				errcode(ERRCODE_WRONG_OBJECT_TYPE),
+				errmsg("function %s is not a PL/Java function", signature)));
+
+#if PG_VERSION_NUM >= 160000
+		aclresult = object_aclcheck(
+			ProcedureRelationId, funcoid, GetUserId(), ACL_EXECUTE);
+#else
+		aclresult = pg_proc_aclcheck(funcoid, GetUserId(), ACL_EXECUTE);
+#endif
+		if ( ACLCHECK_OK != aclresult )
+#if PG_VERSION_NUM >= 110000
+			aclcheck_error(aclresult, OBJECT_FUNCTION, signature);
+#else
+			aclcheck_error(aclresult, ACL_KIND_PROC, signature);
+#endif
+
+		Invocation_pushInvocation(&ctx);
+		PG_TRY();
+		{
+			Function_preload(funcoid, trusted);
+			Invocation_popInvocation(false);
+		}
+		PG_CATCH();
+		{
+			Invocation_popInvocation(true);
+			PG_RE_THROW();
+		}
+		PG_END_TRY();
+
+		ReleaseCurrentSubTransaction();
+		MemoryContextSwitchTo(oldContext);
+		CurrentResourceOwner = oldOwner;
+	}
+	PG_CATCH();
+	{
+		ErrorData *edata;
+
+		MemoryContextSwitchTo(oldContext);
+		edata = CopyErrorData();
+		FlushErrorState();
+		if ( inSubTransaction )
+			RollbackAndReleaseCurrentSubTransaction();
+		MemoryContextSwitchTo(oldContext);
+		CurrentResourceOwner = oldOwner;
+
+		ereport(WARNING, (
+			errmsg("could not preload PL/Java function %s", signature),
+			errdetail("%s", edata->message)));
+		FreeErrorData(edata);
+	}
+	PG_END_TRY();
+}
+
+/*
+ * Act on pljava.preload_functions, if it has been set since last acted on.
+ * This is done at the start of a PL/Java call, where there is sure to be
+ * a transaction and a started JVM; setting the variable itself can happen
+ * where there is neither.
+ *
+ * Not in parallel mode, though, in a worker or in the leader: starting the
+ * subtransactions used to contain failures would there be an error, not
+ * a warning. The work is left pending for a call outside parallel mode,
+ * which a worker, living for one query, will not see; it resolves only the
+ * functions it actually calls.
+ */
+static void preloadFunctions(void)
+{
+	char *list;
+	List *signatures;
+	ListCell *lc;
+
+	if ( IsInParallelMode() )
+		return;
+	preloadPending = false;
+	if ( NULL == preloadFunctionList  ||  '\0' == *preloadFunctionList )
+		return;
+
+	list = pstrdup(preloadFunctionList);
+	signatures = splitSignatureList(list);
+	foreach ( lc, signatures )
+		preloadFunction((char *)lfirst(lc));
+	list_free(signatures);
+	pfree(list);
+}
+
+extern PLJAVADLLEXPORT Datum java_support(PG_FUNCTION_ARGS);
+PG_FUNCTION_INFO_V1(java_support);
+
+/*
+ * The planner support function (declared as sqlj.java_support, and named in
+ * the SUPPORT clause of a PL/Java function declared with [support=class]),
+ * answering row estimate, cost, and simplify requests from the function's
+ * PlannerSupport class. Other requests, and any request in a PostgreSQL
+ * before 12, get NULL: no help offered.
+ */
+Datum java_support(PG_FUNCTION_ARGS)
+{
+#if PG_VERSION_NUM >= 120000
+	Invocation ctx;
+	Node *req = (Node *)PG_GETARG_POINTER(0);
+	Node *result = NULL;
+	Oid funcoid;
+	bool trusted;
+
+	switch ( nodeTag(req) )
+	{
+	case T_SupportRequestRows:
+		funcoid = ((SupportRequestRows *)req)->funcid;
+		break;
+	case T_SupportRequestCost:
+		funcoid = ((SupportRequestCost *)req)->funcid;
+		break;
+	case T_SupportRequestSimplify:
+		funcoid = ((SupportRequestSimplify *)req)->fcall->funcid;
+		break;
+	default:
+		PG_RETURN_POINTER(NULL);
+	}
+
+	if ( ! InstallHelper_isPLJavaFunction(funcoid, NULL, &trusted) )
+		PG_RETURN_POINTER(NULL);
+
+	if ( IS_COMPLETE != initstage )
+	{
+		deferInit = false;
+		initsequencer( initstage, false);
+	}
+
+	Invocation_pushInvocation(&ctx);
+	PG_TRY();
+	{
+		result = Function_planSupport(funcoid, trusted, req);
+		Invocation_popInvocation(false);
+	}
+	PG_CATCH();
+	{
+		Invocation_popInvocation(true);
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+	PG_RETURN_POINTER(result);
+#else
+	PG_RETURN_POINTER(NULL);
+#endif
+}
+
 static Datum internalValidator(bool trusted, PG_FUNCTION_ARGS);
 
 extern PLJAVADLLEXPORT Datum javau_validator(PG_FUNCTION_ARGS);
@@ -2045,6 +3054,31 @@ void Backend_warnJEP411(bool isCommit)
 	));
 }
 
+/*
+ * Called at the ends of top-level transactions. If pljava.track_jni is on,
+ * reports the JNI crossings counted since the last call, if there were any.
+ */
+void Backend_reportJNICounters(void)
+{
+	static JNI_Counters last; /* as of the last transaction end */
+	JNI_Counters now = JNI_counters;
+
+	if ( trackJNI  &&
+		( now.upcalls != last.upcalls  ||  now.downcalls != last.downcalls ) )
+		ereport(INFO, (
+			errmsg("PL/Java JNI crossings: " UINT64_FORMAT " calls into Java, "
+				UINT64_FORMAT " calls into PostgreSQL, "
+				UINT64_FORMAT " local references",
+				now.upcalls - last.upcalls, now.downcalls - last.downcalls,
+				now.localRefs - last.localRefs),
+			errdetail("String bytes converted: " UINT64_FORMAT " to Java, "
+				UINT64_FORMAT " from Java.",
+				now.bytesToJava - last.bytesToJava,
+				now.bytesFromJava - last.bytesFromJava)));
+
+	last = now;
+}
+
 /****************************************
  * JNI methods
  ****************************************/
@@ -2070,8 +3104,15 @@ JNICALL Java_org_postgresql_pljava_internal_Backend__1getConfigOption(JNIEnv* en
 		PG_TRY();
 		{
 			const char *value;
+			/*
+			 * These two are GUC_SUPERUSER_ONLY, which would make
+			 * GetConfigOption refuse them to other users, but PL/Java itself
+			 * needs their values in any user's session.
+			 */
 			if ( 0 == strcmp(policyUrlsGUC, key) )
 				value = policy_urls;
+			else if ( 0 == strcmp("pljava.class_image_cache", key) )
+				value = classImageCache;
 			else
 				value = PG_GETCONFIGOPTION(key);
 			pfree(key);
@@ -2089,6 +3130,17 @@ JNICALL Java_org_postgresql_pljava_internal_Backend__1getConfigOption(JNIEnv* en
 }
 
 
+/*
+ * Class:     org_postgresql_pljava_internal_Backend
+ * Method:    _getSPIFetchMemory
+ * Signature: ()I
+ */
+JNIEXPORT jint JNICALL
+Java_org_postgresql_pljava_internal_Backend__1getSPIFetchMemory(JNIEnv* env, jclass cls)
+{
+	return spiFetchMemory;
+}
+
 /*
  * Class:     org_postgresql_pljava_internal_Backend
  * Method:    _getStatementCacheSize
@@ -2100,6 +3152,140 @@ Java_org_postgresql_pljava_internal_Backend__1getStatementCacheSize(JNIEnv* env,
 	return statementCacheSize;
 }
 
+/*
+ * Class:     org_postgresql_pljava_internal_Backend
+ * Method:    _getStatementCacheMemory
+ * Signature: ()I
+ */
+JNIEXPORT jint JNICALL
+Java_org_postgresql_pljava_internal_Backend__1getStatementCacheMemory(JNIEnv* env, jclass cls)
+{
+	return statementCacheMemory;
+}
+
+/*
+ * Class:     org_postgresql_pljava_internal_Backend
+ * Method:    _jniStatistics
+ * Signature: ()[J
+ */
+JNIEXPORT jlongArray JNICALL
+Java_org_postgresql_pljava_internal_Backend__1jniStatistics(JNIEnv* env, jclass cls)
+{
+	jlongArray result = NULL;
+	jlong counts[5];
+
+	counts[0] = (jlong)JNI_counters.upcalls;
+	counts[1] = (jlong)JNI_counters.downcalls;
+	counts[2] = (jlong)JNI_counters.localRefs;
+	counts[3] = (jlong)JNI_counters.bytesToJava;
+	counts[4] = (jlong)JNI_counters.bytesFromJava;
+
+	BEGIN_NATIVE
+	result = JNI_newLongArray(5);
+	JNI_setLongArrayRegion(result, 0, 5, counts);
+	END_NATIVE
+
+	return result;
+}
+
+/*
+ * Class:     org_postgresql_pljava_internal_Backend
+ * Method:    _messageLevel
+ * Signature: (Z)Ljava/nio/ByteBuffer;
+ *
+ * A direct buffer over the int variable of client_min_messages (if client) or
+ * log_min_messages, so Java can read the live setting, as it changes, with no
+ * call into PostgreSQL. An extension cannot add assign hooks to those settings,
+ * and this needs none.
+ */
+JNIEXPORT jobject JNICALL
+Java_org_postgresql_pljava_internal_Backend__1messageLevel(JNIEnv* env, jclass cls, jboolean client)
+{
+	jobject result = NULL;
+	BEGIN_NATIVE
+	result = JNI_newDirectByteBuffer(
+		JNI_TRUE == client ? &client_min_messages : &log_min_messages,
+		(jlong)sizeof (int));
+	END_NATIVE
+	return result;
+}
+
+/*
+ * Class:     org_postgresql_pljava_internal_Backend
+ * Method:    _logBufferSize
+ * Signature: ()Ljava/nio/ByteBuffer;
+ *
+ * A direct buffer over the int variable of pljava.log_buffer, so the Java log
+ * handler can see the live setting with no call into PostgreSQL.
+ */
+JNIEXPORT jobject JNICALL
+Java_org_postgresql_pljava_internal_Backend__1logBufferSize(JNIEnv* env, jclass cls)
+{
+	jobject result = NULL;
+	BEGIN_NATIVE
+	result = JNI_newDirectByteBuffer(&logBufferSize, (jlong)sizeof (int));
+	END_NATIVE
+	return result;
+}
+
+/*
+ * Class:     org_postgresql_pljava_internal_Backend
+ * Method:    _configGeneration
+ * Signature: ()Ljava/nio/ByteBuffer;
+ *
+ * A direct buffer over pljavaConfigGeneration, so the Java cache of setting
+ * values can tell with no call into PostgreSQL whether it is still good.
+ */
+JNIEXPORT jobject JNICALL
+Java_org_postgresql_pljava_internal_Backend__1configGeneration(JNIEnv* env, jclass cls)
+{
+	jobject result = NULL;
+	BEGIN_NATIVE
+	result = JNI_newDirectByteBuffer(
+		&pljavaConfigGeneration, (jlong)sizeof pljavaConfigGeneration);
+	END_NATIVE
+	return result;
+}
+
+/*
+ * Class:     org_postgresql_pljava_internal_Backend
+ * Method:    _logBuffered
+ * Signature: ([I[Ljava/lang/String;I)V
+ *
+ * Passes the first count buffered records to elog, in order. The string of
+ * each is freed as soon as it has been passed.
+ */
+JNIEXPORT void JNICALL
+Java_org_postgresql_pljava_internal_Backend__1logBuffered(JNIEnv* env, jclass cls, jintArray levels, jobjectArray messages, jint count)
+{
+	BEGIN_NATIVE_NO_ERRCHECK
+	jint *lvls = JNI_getIntArrayElements(levels, NULL);
+	PG_TRY();
+	{
+		jint i;
+		for ( i = 0 ; i < count ; ++ i )
+		{
+			jstring jstr = JNI_getObjectArrayElement(messages, i);
+			char *str = String_createNTS(jstr);
+			JNI_deleteLocalRef(jstr);
+			if ( NULL == str )
+				continue;
+			elog(lvls[i], "%s", str);
+			pfree(str);
+		}
+	}
+	PG_CATCH();
+	{
+		JNI_releaseIntArrayElements(levels, lvls, JNI_ABORT);
+		lvls = NULL;
+		Exception_throw_ERROR("ereport");
+	}
+	PG_END_TRY();
+	if ( NULL != lvls )
+		JNI_releaseIntArrayElements(levels, lvls, JNI_ABORT);
+	END_NATIVE
+}
+
 /*
  * Class:     org_postgresql_pljava_internal_Backend
  * Method:    _log
@@ -2161,6 +3347,19 @@ Java_org_postgresql_pljava_internal_Backend__1clearFunctionCache(JNIEnv* env, jc
 	END_NATIVE
 }
 
+/*
+ * Class:     org_postgresql_pljava_internal_Backend
+ * Method:    _clearFunctionCacheForLoader
+ * Signature: (Ljava/lang/ClassLoader;)V
+ */
+JNIEXPORT void JNICALL
+Java_org_postgresql_pljava_internal_Backend__1clearFunctionCacheForLoader(JNIEnv* env, jclass cls, jobject loader)
+{
+	BEGIN_NATIVE_NO_ERRCHECK
+	Function_clearFunctionCacheForLoader(loader);
+	END_NATIVE
+}
+
 /*
  * Class:     org_postgresql_pljava_internal_Backend
  * Method:    _isCreatingExtension
@@ -2209,6 +3408,60 @@ Java_org_postgresql_pljava_internal_Backend__1myLibraryPath(JNIEnv *env, jclass
 	return result;
 }
 
+/*
+ * Class:     org_postgresql_pljava_internal_Backend
+ * Method:    _getJobWorkers
+ * Signature: ()I
+ */
+JNIEXPORT jint JNICALL
+Java_org_postgresql_pljava_internal_Backend__1getJobWorkers(JNIEnv *env, jclass cls)
+{
+	return jobWorkers;
+}
+
+/*
+ * Class:     org_postgresql_pljava_internal_Backend
+ * Method:    _isInterruptPending
+ * Signature: ()Z
+ */
+JNIEXPORT jboolean JNICALL
+Java_org_postgresql_pljava_internal_Backend__1isInterruptPending(JNIEnv *env, jclass cls)
+{
+	return InterruptPending ? JNI_TRUE : JNI_FALSE;
+}
+
+/*
+ * Class:     org_postgresql_pljava_internal_Backend
+ * Method:    _launchJobWorker
+ * Signature: (I)Z
+ */
+JNIEXPORT jboolean JNICALL
+Java_org_postgresql_pljava_internal_Backend__1launchJobWorker(JNIEnv *env, jclass cls, jint roleId)
+{
+	jboolean result = JNI_FALSE;
+
+	BEGIN_NATIVE
+	PG_TRY();
+	{
+		if ( NULL == pljavaLoadPath )
+			InstallHelper_assumeLoadPathOf("java");
+		if ( NULL == pljavaLoadPath )
+			ereport(ERROR, (
+				errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				errmsg("cannot determine PL/Java's library path")));
+		result = pljava_BackgroundJob_launch(pljavaLoadPath, (Oid)roleId)
+			? JNI_TRUE : JNI_FALSE;
+	}
+	PG_CATCH();
+	{
+		Exception_throw_ERROR("pljava_BackgroundJob_launch");
+	}
+	PG_END_TRY();
+	END_NATIVE
+
+	return result;
+}
+
 /*
  * Class:     org_postgresql_pljava_internal_Backend
  * Method:    _pokeJEP411
@@ -0,0 +1,451 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+#include <postgres.h>
+#include <access/xact.h>
+#include <catalog/pg_authid.h>
+#include <catalog/pg_proc.h>
+#include <catalog/pg_type.h>
+#include <executor/spi.h>
+#include <libpq/pqsignal.h>
+#include <miscadmin.h>
+#include <pgstat.h>
+#include <postmaster/bgworker.h>
+#include <storage/ipc.h>
+#include <storage/latch.h>
+#include <tcop/tcopprot.h>
+#include <utils/acl.h>
+#include <utils/builtins.h>
+#include <utils/guc.h>
+#include <utils/lsyscache.h>
+#include <utils/memutils.h>
+#include <utils/regproc.h>
+#include <utils/snapmgr.h>
+#include <utils/timestamp.h>
+
+#include "pljava/Backend.h"
+#include "pljava/BackgroundJob.h"
+
+/*
+ * The bgw_type of the workers, which is what pg_stat_activity shows as their
+ * backend_type; sqlj.submit_job counts the running workers by it.
+ */
+#define WORKER_TYPE "pljava job worker"
+
+/*
+ * How often an idle worker looks for a newly queued job. A job is queued by
+ * a transaction the worker cannot see until it commits, so there is nothing
+ * to be woken by; the queue is simply checked again after this long.
+ */
+#define POLL_INTERVAL_MS 1000
+
+#if PG_VERSION_NUM >= 110000
+
+static MemoryContext s_jobContext;
+
+static volatile sig_atomic_t s_gotSIGHUP = false;
+
+static void sighupHandler(SIGNAL_ARGS);
+static bool enoughOtherWorkers(Oid roleId);
+static bool runOneJob(Oid roleId);
+static void queueExecute(
+	char const *sql, int nargs, Oid *types, Datum *values, char const *nulls);
+static bool claimJob(
+	Oid roleId, int64 *jobId, Oid *function, char **argument);
+static char *callJob(Oid function, char const *argument);
+static void finishJob(
+	int64 jobId, char const *state, char const *result, char const *error);
+
+bool pljava_BackgroundJob_launch(char const *libraryPath, Oid roleId)
+{
+	BackgroundWorker worker;
+	BackgroundWorkerHandle *handle;
+
+	if ( strlen(libraryPath) >= sizeof worker.bgw_library_name )
+		ereport(ERROR, (
+			errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+			errmsg("PL/Java's library path is too long to name in "
+				"a background worker"),
+			errdetail("The path is \"%s\".", libraryPath)));
+
+	memset(&worker, 0, sizeof worker);
+	worker.bgw_flags =
+		BGWORKER_SHMEM_ACCESS | BGWORKER_BACKEND_DATABASE_CONNECTION;
+	worker.bgw_start_time = BgWorkerStart_RecoveryFinished;
+	worker.bgw_restart_time = BGW_NEVER_RESTART;
+	strlcpy(worker.bgw_library_name, libraryPath,
+		sizeof worker.bgw_library_name);
+	strlcpy(worker.bgw_function_name, "pljava_BackgroundJob_main",
+		sizeof worker.bgw_function_name);
+	snprintf(worker.bgw_name, sizeof worker.bgw_name,
+		"PL/Java job worker for role %u", roleId);
+	strlcpy(worker.bgw_type, WORKER_TYPE, sizeof worker.bgw_type);
+	worker.bgw_main_arg = ObjectIdGetDatum(roleId);
+	memcpy(worker.bgw_extra, &MyDatabaseId, sizeof MyDatabaseId);
+	worker.bgw_notify_pid = 0;
+
+	return RegisterDynamicBackgroundWorker(&worker, &handle);
+}
+
+void pljava_BackgroundJob_main(Datum arg)
+{
+	Oid roleId = DatumGetObjectId(arg);
+	Oid dbId;
+	TimestampTz idleSince;
+	bool enough;
+
+	memcpy(&dbId, MyBgworkerEntry->bgw_extra, sizeof dbId);
+
+	pqsignal(SIGHUP, sighupHandler);
+	pqsignal(SIGTERM, die);
+	BackgroundWorkerUnblockSignals();
+	BackgroundWorkerInitializeConnectionByOid(dbId, roleId, 0);
+
+	s_jobContext = AllocSetContextCreate(TopMemoryContext,
+		"PL/Java job", ALLOCSET_DEFAULT_SIZES);
+
+	/*
+	 * Unless enough workers are running already, start Java now, so the
+	 * first job does not wait for it.
+	 */
+	pgstat_report_activity(STATE_RUNNING, "starting PL/Java");
+	StartTransactionCommand();
+	SPI_connect();
+	PushActiveSnapshot(GetTransactionSnapshot());
+	enough = enoughOtherWorkers(roleId);
+	SPI_finish();
+	PopActiveSnapshot();
+	if ( ! enough )
+		Backend_initializeInWorker();
+	CommitTransactionCommand();
+	if ( enough )
+		proc_exit(0);
+	pgstat_report_activity(STATE_IDLE, NULL);
+
+	idleSince = GetCurrentTimestamp();
+	for ( ;; )
+	{
+		int rc;
+
+		CHECK_FOR_INTERRUPTS();
+		if ( s_gotSIGHUP )
+		{
+			s_gotSIGHUP = false;
+			ProcessConfigFile(PGC_SIGHUP);
+		}
+
+		if ( runOneJob(roleId) )
+		{
+			idleSince = GetCurrentTimestamp();
+			continue;
+		}
+
+		if ( TimestampDifferenceExceeds(idleSince, GetCurrentTimestamp(),
+			1000 * Backend_getJobIdleTimeout()) )
+			break;
+
+		rc = WaitLatch(MyLatch, WL_LATCH_SET | WL_TIMEOUT | WL_POSTMASTER_DEATH,
+			POLL_INTERVAL_MS, PG_WAIT_EXTENSION);
+		ResetLatch(MyLatch);
+		if ( rc & WL_POSTMASTER_DEATH )
+			proc_exit(1);
+	}
+
+	proc_exit(0);
+}
+
+static void sighupHandler(SIGNAL_ARGS)
+{
+	int save_errno = errno;
+	s_gotSIGHUP = true;
+	SetLatch(MyLatch);
+	errno = save_errno;
+}
+
+/*
+ * Whether pljava.job_workers workers for the same role and database were
+ * running when this one started. Several submissions in one transaction can
+ * each start a worker before any is seen running; the ones started last are
+ * those that find enough others (with lower process IDs) and exit.
+ */
+static bool enoughOtherWorkers(Oid roleId)
+{
+	Oid types[2] = { OIDOID, OIDOID };
+	Datum values[2];
+	bool isnull;
+	int rc;
+
+	values[0] = ObjectIdGetDatum(MyDatabaseId);
+	values[1] = ObjectIdGetDatum(roleId);
+	rc = SPI_execute_with_args(
+		"SELECT pg_catalog.count(*) FROM pg_catalog.pg_stat_activity"
+		" WHERE backend_type OPERATOR(pg_catalog.=) '" WORKER_TYPE "'"
+		"  AND datid OPERATOR(pg_catalog.=) $1"
+		"  AND usesysid OPERATOR(pg_catalog.=) $2"
+		"  AND pid OPERATOR(pg_catalog.<) pg_catalog.pg_backend_pid()",
+		2, types, values, NULL, true, 1);
+	if ( SPI_OK_SELECT != rc  ||  1 != SPI_processed )
+		return false;
+
+	return Backend_getJobWorkers() <= DatumGetInt64(SPI_getbinval(
+		SPI_tuptable->vals[0], SPI_tuptable->tupdesc, 1, &isnull));
+}
+
+/*
+ * Claim the role's oldest queued job, if there is one, and run it: the call
+ * and the recording of its result are one transaction, so a job whose
+ * result is recorded as done has had all its effects committed. If it fails,
+ * the error message is recorded in a transaction of its own.
+ */
+static bool runOneJob(Oid roleId)
+{
+	int64 jobId;
+	Oid function;
+	char *argument;
+	char *result;
+	ErrorData *edata = NULL;
+	bool claimed;
+
+	MemoryContextReset(s_jobContext);
+
+	StartTransactionCommand();
+	SPI_connect();
+	PushActiveSnapshot(GetTransactionSnapshot());
+	claimed = claimJob(roleId, &jobId, &function, &argument);
+	SPI_finish();
+	PopActiveSnapshot();
+	CommitTransactionCommand();
+
+	if ( ! claimed )
+		return false;
+	if ( InvalidOid == function )
+		return true;
+
+	StartTransactionCommand();
+	PG_TRY();
+	{
+		pgstat_report_activity(STATE_RUNNING, format_procedure(function));
+		SPI_connect();
+		PushActiveSnapshot(GetTransactionSnapshot());
+		result = callJob(function, argument);
+		finishJob(jobId, "done", result, NULL);
+		SPI_finish();
+		PopActiveSnapshot();
+		CommitTransactionCommand();
+	}
+	PG_CATCH();
+	{
+		MemoryContextSwitchTo(s_jobContext);
+		edata = CopyErrorData();
+		FlushErrorState();
+		AbortCurrentTransaction();
+	}
+	PG_END_TRY();
+
+	if ( NULL != edata )
+	{
+		ereport(LOG, (
+			errmsg("PL/Java job " INT64_FORMAT " failed", jobId),
+			errdetail("%s", edata->message)));
+
+		StartTransactionCommand();
+		SPI_connect();
+		PushActiveSnapshot(GetTransactionSnapshot());
+		finishJob(jobId, "failed", NULL, edata->message);
+		SPI_finish();
+		PopActiveSnapshot();
+		CommitTransactionCommand();
+	}
+
+	pgstat_report_activity(STATE_IDLE, NULL);
+	return true;
+}
+
+/*
+ * Execute a statement on sqlj.background_job, which only its owner can read
+ * or change, as the bootstrap superuser, while the worker is otherwise the
+ * submitting role. If the statement fails, the transaction's abort restores
+ * the user.
+ */
+static void queueExecute(
+	char const *sql, int nargs, Oid *types, Datum *values, char const *nulls)
+{
+	Oid saveUser;
+	int saveSecContext;
+	int rc;
+
+	GetUserIdAndSecContext(&saveUser, &saveSecContext);
+	SetUserIdAndSecContext(BOOTSTRAP_SUPERUSERID,
+		saveSecContext | SECURITY_LOCAL_USERID_CHANGE);
+	rc = SPI_execute_with_args(sql, nargs, types, values, nulls, false, 0);
+	SetUserIdAndSecContext(saveUser, saveSecContext);
+
+	if ( 0 > rc )
+		ereport(ERROR, (
+			errcode(ERRCODE_INTERNAL_ERROR),
+			errmsg("PL/Java job queue statement failed: %s",
+				SPI_result_code_string(rc))));
+}
+
+/*
+ * Mark the role's oldest queued job running, and return its id, the oid of
+ * its function, and its argument, copied into s_jobContext. If the function
+ * has been dropped since, the job is marked failed, and *function is
+ * InvalidOid.
+ */
+static bool claimJob(
+	Oid roleId, int64 *jobId, Oid *function, char **argument)
+{
+	Oid types[1] = { OIDOID };
+	Datum values[1];
+	bool isnull;
+	char *s;
+
+	values[0] = ObjectIdGetDatum(roleId);
+	queueExecute(
+		"UPDATE sqlj.background_job"
+		" SET state = 'running', started = pg_catalog.now()"
+		" WHERE jobId OPERATOR(pg_catalog.=) ("
+		"  SELECT jobId FROM sqlj.background_job"
+		"  WHERE state OPERATOR(pg_catalog.=) 'queued'"
+		"   AND submitter OPERATOR(pg_catalog.=) $1"
+		"  ORDER BY jobId LIMIT 1 FOR UPDATE SKIP LOCKED)"
+		" RETURNING jobId,"
+		"  (SELECT p.oid FROM pg_catalog.pg_proc p"
+		"   WHERE p.oid OPERATOR(pg_catalog.=) jobFunction),"
+		"  argument",
+		1, types, values, NULL);
+
+	if ( 1 != SPI_processed )
+		return false;
+
+	*jobId = DatumGetInt64(SPI_getbinval(
+		SPI_tuptable->vals[0], SPI_tuptable->tupdesc, 1, &isnull));
+
+	*function = DatumGetObjectId(SPI_getbinval(
+		SPI_tuptable->vals[0], SPI_tuptable->tupdesc, 2, &isnull));
+	if ( isnull )
+		*function = InvalidOid;
+	s = SPI_getvalue(SPI_tuptable->vals[0], SPI_tuptable->tupdesc, 3);
+	*argument = NULL == s ? NULL : MemoryContextStrdup(s_jobContext, s);
+
+	if ( InvalidOid == *function )
+		finishJob(*jobId, "failed", NULL, "function no longer exists");
+	return true;
+}
+
+/*
+ * Call the job's function by the oid recorded when it was submitted, as the
+ * worker's role, after checking the role's privilege to execute it and that
+ * it still takes one text argument (submit_job checked both, but either may
+ * have changed since). The result, as text, is copied into s_jobContext.
+ */
+static char *callJob(Oid function, char const *argument)
+{
+	Oid *argTypes;
+	int nargs;
+	Oid retType;
+	Oid typOutput;
+	bool typIsVarlena;
+	AclResult aclresult;
+	FmgrInfo flinfo;
+	Datum result;
+	bool isnull;
+	char *s;
+#if PG_VERSION_NUM >= 120000
+	LOCAL_FCINFO(fcinfo, 1);
+#else
+	FunctionCallInfoData fcinfoData;
+	FunctionCallInfo fcinfo = &fcinfoData;
+#endif
+
+#if PG_VERSION_NUM >= 160000
+	aclresult = object_aclcheck(
+		ProcedureRelationId, function, GetUserId(), ACL_EXECUTE);
+#else
+	aclresult = pg_proc_aclcheck(function, GetUserId(), ACL_EXECUTE);
+#endif
+	if ( ACLCHECK_OK != aclresult )
+		aclcheck_error(aclresult, OBJECT_FUNCTION, get_func_name(function));
+
+	retType = get_func_signature(function, &argTypes, &nargs);
+	if ( 1 != nargs  ||  TEXTOID != argTypes[0]  ||  get_func_retset(function) )
+		ereport(ERROR, (
+			errcode(ERRCODE_INVALID_FUNCTION_DEFINITION),
+			errmsg("PL/Java job function %s no longer takes one text "
+				"argument and returns no set", format_procedure(function))));
+
+	if ( NULL == argument  &&  func_strict(function) )
+		return NULL;
+
+	fmgr_info(function, &flinfo);
+	InitFunctionCallInfoData(*fcinfo, &flinfo, 1, InvalidOid, NULL, NULL);
+#if PG_VERSION_NUM >= 120000
+	fcinfo->args[0].value =
+		NULL == argument ? (Datum)0 : CStringGetTextDatum(argument);
+	fcinfo->args[0].isnull = NULL == argument;
+#else
+	fcinfo->arg[0] =
+		NULL == argument ? (Datum)0 : CStringGetTextDatum(argument);
+	fcinfo->argnull[0] = NULL == argument;
+#endif
+	result = FunctionCallInvoke(fcinfo);
+	isnull = fcinfo->isnull;
+
+	if ( isnull )
+		return NULL;
+	getTypeOutputInfo(retType, &typOutput, &typIsVarlena);
+	s = OidOutputFunctionCall(typOutput, result);
+	return MemoryContextStrdup(s_jobContext, s);
+}
+
+static void finishJob(
+	int64 jobId, char const *state, char const *result, char const *error)
+{
+	Oid types[4] = { INT8OID, TEXTOID, TEXTOID, TEXTOID };
+	Datum values[4];
+	char nulls[4] = { ' ', ' ', ' ', ' ' };
+
+	values[0] = Int64GetDatum(jobId);
+	values[1] = CStringGetTextDatum(state);
+	if ( NULL == result )
+		nulls[2] = 'n';
+	else
+		values[2] = CStringGetTextDatum(result);
+	if ( NULL == error )
+		nulls[3] = 'n';
+	else
+		values[3] = CStringGetTextDatum(error);
+
+	queueExecute(
+		"UPDATE sqlj.background_job"
+		" SET state = $2, result = $3, error = $4,"
+		"  finished = pg_catalog.now()"
+		" WHERE jobId OPERATOR(pg_catalog.=) $1",
+		4, types, values, nulls);
+}
+
+#else /* PG_VERSION_NUM < 110000 */
+
+bool pljava_BackgroundJob_launch(char const *libraryPath, Oid roleId)
+{
+	ereport(ERROR, (
+		errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+		errmsg("PL/Java background jobs require PostgreSQL 11 or later")));
+	return false;
+}
+
+void pljava_BackgroundJob_main(Datum arg)
+{
+	proc_exit(1);
+}
+
+#endif
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2019 Tada AB and other contributors, as listed below.
+ * Copyright (c) 2018-2026 Tada AB and other contributors, as listed below.
  *
  * All rights reserved. This program and the accompanying materials
  * are made available under the terms of the The BSD 3-Clause License
@@ -11,6 +11,7 @@
  *   Chapman Flack
  */
 
+#include "org_postgresql_pljava_internal_DualState.h"
 #include "org_postgresql_pljava_internal_DualState_SinglePfree.h"
 #include "org_postgresql_pljava_internal_DualState_SingleMemContextDelete.h"
 #include "org_postgresql_pljava_internal_DualState_SingleFreeTupleDesc.h"
@@ -18,6 +19,7 @@
 #include "org_postgresql_pljava_internal_DualState_SingleFreeErrorData.h"
 #include "org_postgresql_pljava_internal_DualState_SingleSPIfreeplan.h"
 #include "org_postgresql_pljava_internal_DualState_SingleSPIcursorClose.h"
+#include "org_postgresql_pljava_internal_DualState_SingleSPIfreetuptable.h"
 #include "pljava/DualState.h"
 
 #include "pljava/Backend.h"
@@ -44,6 +46,9 @@ extern void pljava_ExecutionPlan_initialize(void);
 #include "pljava/SQLInputFromTuple.h"
 #include "pljava/VarlenaWrapper.h"
 
+#include <utils/memutils.h>
+#include <utils/portal.h>
+
 #if PG_VERSION_NUM < 80400
 #include <access/heapam.h> /* heap_freetuple was there then */
 #endif
@@ -55,6 +60,12 @@ static jmethodID s_DualState_cleanEnqueuedInstances;
 
 static jobject s_DualState_key;
 
+/*
+ * Bytes allocated in JavaMemoryContext just after the last cleaning of
+ * enqueued instances prompted by memory pressure.
+ */
+static Size s_bytesAfterClean;
+
 static void resourceReleaseCB(ResourceReleasePhase phase,
 							  bool isCommit, bool isTopLevel, void *arg);
 
@@ -113,6 +124,16 @@ void pljava_DualState_initialize(void)
 	jclass clazz;
 	jmethodID ctor;
 
+	JNINativeMethod dualStateMethods[] =
+	{
+		{
+		"_cleanIfPressured",
+		"()V",
+		Java_org_postgresql_pljava_internal_DualState__1cleanIfPressured
+		},
+		{ 0, 0, 0 }
+	};
+
 	JNINativeMethod singlePfreeMethods[] =
 	{
 		{
@@ -120,6 +141,11 @@ void pljava_DualState_initialize(void)
 		"(J)V",
 		Java_org_postgresql_pljava_internal_DualState_00024SinglePfree__1pfree
 		},
+		{
+		"_nativeBytes",
+		"(J)J",
+		Java_org_postgresql_pljava_internal_DualState_00024SinglePfree__1nativeBytes
+		},
 		{ 0, 0, 0 }
 	};
 
@@ -130,6 +156,11 @@ void pljava_DualState_initialize(void)
 		"(J)V",
 		Java_org_postgresql_pljava_internal_DualState_00024SingleMemContextDelete__1memContextDelete
 		},
+		{
+		"_nativeBytes",
+		"(J)J",
+		Java_org_postgresql_pljava_internal_DualState_00024SingleMemContextDelete__1nativeBytes
+		},
 		{ 0, 0, 0 }
 	};
 
@@ -140,6 +171,11 @@ void pljava_DualState_initialize(void)
 		"(J)V",
 		Java_org_postgresql_pljava_internal_DualState_00024SingleFreeTupleDesc__1freeTupleDesc
 		},
+		{
+		"_nativeBytes",
+		"(J)J",
+		Java_org_postgresql_pljava_internal_DualState_00024SingleFreeTupleDesc__1nativeBytes
+		},
 		{ 0, 0, 0 }
 	};
 
@@ -150,6 +186,11 @@ void pljava_DualState_initialize(void)
 		"(J)V",
 		Java_org_postgresql_pljava_internal_DualState_00024SingleHeapFreeTuple__1heapFreeTuple
 		},
+		{
+		"_nativeBytes",
+		"(J)J",
+		Java_org_postgresql_pljava_internal_DualState_00024SingleHeapFreeTuple__1nativeBytes
+		},
 		{ 0, 0, 0 }
 	};
 
@@ -180,6 +221,26 @@ void pljava_DualState_initialize(void)
 		"(J)V",
 		Java_org_postgresql_pljava_internal_DualState_00024SingleSPIcursorClose__1spiCursorClose
 		},
+		{
+		"_nativeBytes",
+		"(J)J",
+		Java_org_postgresql_pljava_internal_DualState_00024SingleSPIcursorClose__1nativeBytes
+		},
+		{ 0, 0, 0 }
+	};
+
+	JNINativeMethod singleSPIfreetuptableMethods[] =
+	{
+		{
+		"_spiFreeTupTable",
+		"(J)V",
+		Java_org_postgresql_pljava_internal_DualState_00024SingleSPIfreetuptable__1spiFreeTupTable
+		},
+		{
+		"_nativeBytes",
+		"(J)J",
+		Java_org_postgresql_pljava_internal_DualState_00024SingleSPIfreetuptable__1nativeBytes
+		},
 		{ 0, 0, 0 }
 	};
 
@@ -189,6 +250,7 @@ void pljava_DualState_initialize(void)
 		s_DualState_class, "resourceOwnerRelease", "(J)V");
 	s_DualState_cleanEnqueuedInstances = PgObject_getStaticJavaMethod(
 		s_DualState_class, "cleanEnqueuedInstances", "()V");
+	PgObject_registerNatives2(s_DualState_class, dualStateMethods);
 
 	clazz = (jclass)PgObject_getJavaClass(
 		"org/postgresql/pljava/internal/DualState$Key");
@@ -231,6 +293,11 @@ void pljava_DualState_initialize(void)
 	PgObject_registerNatives2(clazz, singleSPIcursorCloseMethods);
 	JNI_deleteLocalRef(clazz);
 
+	clazz = (jclass)PgObject_getJavaClass(
+		"org/postgresql/pljava/internal/DualState$SingleSPIfreetuptable");
+	PgObject_registerNatives2(clazz, singleSPIfreetuptableMethods);
+	JNI_deleteLocalRef(clazz);
+
 	RegisterResourceReleaseCallback(resourceReleaseCB, NULL);
 
 	/*
@@ -271,11 +338,61 @@ static void resourceReleaseCB(ResourceReleasePhase phase,
 	pljava_DualState_nativeRelease(CurrentResourceOwner);
 
 	if ( isTopLevel )
+	{
 		Backend_warnJEP411(isCommit);
+		Backend_reportJNICounters();
+	}
 }
 
 
 
+/*
+ * Class:     org_postgresql_pljava_internal_DualState
+ * Method:    _cleanIfPressured
+ * Signature: ()V
+ *
+ * Called from Java every so many DualState constructions, so a function
+ * making many short-lived objects without fetching or returning (the points
+ * where enqueued instances are otherwise cleaned) does not let the native
+ * memory of the unreachable ones pile up. With pljava.dualstate_cleanup_memory
+ * nonzero, the enqueued instances are cleaned when JavaMemoryContext (where
+ * copied tuples and descriptors live) has grown by more than that since the
+ * last such cleaning; before PG 13, where its size can't be cheaply had, they
+ * are simply cleaned at every call.
+ */
+JNIEXPORT void JNICALL
+Java_org_postgresql_pljava_internal_DualState__1cleanIfPressured(
+	JNIEnv* env, jclass cls)
+{
+	BEGIN_NATIVE
+	PG_TRY();
+	{
+		Size threshold = Backend_getDualStateCleanupMemory();
+		if ( 0 < threshold )
+		{
+#if PG_VERSION_NUM >= 130000
+			Size bytes = MemoryContextMemAllocated(JavaMemoryContext, true);
+			if ( bytes < s_bytesAfterClean )
+				s_bytesAfterClean = bytes;
+			else if ( bytes - s_bytesAfterClean > threshold )
+			{
+				pljava_DualState_cleanEnqueuedInstances();
+				s_bytesAfterClean =
+					MemoryContextMemAllocated(JavaMemoryContext, true);
+			}
+#else
+			pljava_DualState_cleanEnqueuedInstances();
+#endif
+		}
+	}
+	PG_CATCH();
+	{
+		Exception_throw_ERROR("_cleanIfPressured");
+	}
+	PG_END_TRY();
+	END_NATIVE
+}
+
 /*
  * Class:     org_postgresql_pljava_internal_DualState_SinglePfree
  * Method:    _pfree
@@ -417,7 +534,7 @@ Java_org_postgresql_pljava_internal_DualState_00024SingleSPIcursorClose__1spiCur
 		 */
 		if ( NULL != currentInvocation && ! currentInvocation->errorOccurred
 			&& ! currentInvocation->inExprContextCB )
-			SPI_cursor_close(p2l.ptrVal);
+			pljava_Portal_close(p2l.ptrVal);
 	}
 	PG_CATCH();
 	{
@@ -426,3 +543,156 @@ Java_org_postgresql_pljava_internal_DualState_00024SingleSPIcursorClose__1spiCur
 	PG_END_TRY();
 	END_NATIVE
 }
+
+
+
+/*
+ * Class:     org_postgresql_pljava_internal_DualState_SingleSPIfreetuptable
+ * Method:    _spiFreeTupTable
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL
+Java_org_postgresql_pljava_internal_DualState_00024SingleSPIfreetuptable__1spiFreeTupTable(
+	JNIEnv* env, jobject _this, jlong pointer)
+{
+	BEGIN_NATIVE_NO_ERRCHECK
+	Ptr2Long p2l;
+	p2l.longVal = pointer;
+	PG_TRY();
+	{
+		SPI_freetuptable(p2l.ptrVal);
+	}
+	PG_CATCH();
+	{
+		Exception_throw_ERROR("SPI_freetuptable");
+	}
+	PG_END_TRY();
+	END_NATIVE
+}
+
+
+/*
+ * The _nativeBytes methods report the native memory held by an instance, for
+ * DualState's per-class statistics. They are called on the PG thread for live
+ * instances only. Where the measure needs MemoryContextMemAllocated, it is
+ * zero before PostgreSQL 13.
+ */
+static jlong chunkBytes(jlong pointer)
+{
+	Ptr2Long p2l;
+	p2l.longVal = pointer;
+	return NULL == p2l.ptrVal ? 0 : (jlong)GetMemoryChunkSpace(p2l.ptrVal);
+}
+
+static jlong contextBytes(MemoryContext cxt)
+{
+#if PG_VERSION_NUM >= 130000
+	return NULL == cxt ? 0 : (jlong)MemoryContextMemAllocated(cxt, true);
+#else
+	return 0;
+#endif
+}
+
+/*
+ * Class:     org_postgresql_pljava_internal_DualState_SinglePfree
+ * Method:    _nativeBytes
+ * Signature: (J)J
+ */
+JNIEXPORT jlong JNICALL
+Java_org_postgresql_pljava_internal_DualState_00024SinglePfree__1nativeBytes(
+	JNIEnv* env, jobject _this, jlong pointer)
+{
+	jlong result = 0;
+	BEGIN_NATIVE_NO_ERRCHECK
+	result = chunkBytes(pointer);
+	END_NATIVE
+	return result;
+}
+
+/*
+ * Class:     org_postgresql_pljava_internal_DualState_SingleMemContextDelete
+ * Method:    _nativeBytes
+ * Signature: (J)J
+ */
+JNIEXPORT jlong JNICALL
+Java_org_postgresql_pljava_internal_DualState_00024SingleMemContextDelete__1nativeBytes(
+	JNIEnv* env, jobject _this, jlong pointer)
+{
+	jlong result = 0;
+	BEGIN_NATIVE_NO_ERRCHECK
+	Ptr2Long p2l;
+	p2l.longVal = pointer;
+	result = contextBytes(p2l.ptrVal);
+	END_NATIVE
+	return result;
+}
+
+/*
+ * Class:     org_postgresql_pljava_internal_DualState_SingleFreeTupleDesc
+ * Method:    _nativeBytes
+ * Signature: (J)J
+ */
+JNIEXPORT jlong JNICALL
+Java_org_postgresql_pljava_internal_DualState_00024SingleFreeTupleDesc__1nativeBytes(
+	JNIEnv* env, jobject _this, jlong pointer)
+{
+	jlong result = 0;
+	BEGIN_NATIVE_NO_ERRCHECK
+	result = chunkBytes(pointer);
+	END_NATIVE
+	return result;
+}
+
+/*
+ * Class:     org_postgresql_pljava_internal_DualState_SingleHeapFreeTuple
+ * Method:    _nativeBytes
+ * Signature: (J)J
+ */
+JNIEXPORT jlong JNICALL
+Java_org_postgresql_pljava_internal_DualState_00024SingleHeapFreeTuple__1nativeBytes(
+	JNIEnv* env, jobject _this, jlong pointer)
+{
+	jlong result = 0;
+	BEGIN_NATIVE_NO_ERRCHECK
+	result = chunkBytes(pointer);
+	END_NATIVE
+	return result;
+}
+
+/*
+ * Class:     org_postgresql_pljava_internal_DualState_SingleSPIcursorClose
+ * Method:    _nativeBytes
+ * Signature: (J)J
+ */
+JNIEXPORT jlong JNICALL
+Java_org_postgresql_pljava_internal_DualState_00024SingleSPIcursorClose__1nativeBytes(
+	JNIEnv* env, jobject _this, jlong pointer)
+{
+	jlong result = 0;
+#if PG_VERSION_NUM >= 130000
+	BEGIN_NATIVE_NO_ERRCHECK
+	Ptr2Long p2l;
+	p2l.longVal = pointer;
+	result = contextBytes(((Portal)p2l.ptrVal)->portalContext);
+	END_NATIVE
+#endif
+	return result;
+}
+
+/*
+ * Class:     org_postgresql_pljava_internal_DualState_SingleSPIfreetuptable
+ * Method:    _nativeBytes
+ * Signature: (J)J
+ */
+JNIEXPORT jlong JNICALL
+Java_org_postgresql_pljava_internal_DualState_00024SingleSPIfreetuptable__1nativeBytes(
+	JNIEnv* env, jobject _this, jlong pointer)
+{
+	jlong result = 0;
+	BEGIN_NATIVE_NO_ERRCHECK
+	Ptr2Long p2l;
+	p2l.longVal = pointer;
+	result = contextBytes(((SPITupleTable*)p2l.ptrVal)->tuptabcxt);
+	END_NATIVE
+	return result;
+}
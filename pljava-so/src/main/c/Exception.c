@@ -28,6 +28,9 @@ jmethodID Class_getCanonicalName;
 jclass    ServerException_class;
 jmethodID ServerException_getErrorData;
 jmethodID ServerException_init;
+static jclass    s_ServerException_Stackless_class;
+static jmethodID s_ServerException_Stackless_init;
+static jmethodID ServerException_logCancelStack;
 
 jclass    Throwable_class;
 jmethodID Throwable_getMessage;
@@ -155,21 +158,60 @@ void Exception_throwSPI(const char* function, int errCode)
 			SPI_result_code_string(errCode));
 }
 
+/*
+ * The message and SQLSTATE are given to the constructor from the ErrorData
+ * copy here, rather than read back through Java's ErrorData by two more calls
+ * into PostgreSQL; the other fields are only read if Java asks for them. For
+ * a SQLSTATE listed in pljava.stackless_sqlstates, the exception is
+ * a ServerException.Stackless, which does not capture the Java stack: Java
+ * code catching such errors in a loop (insert, and update instead on
+ * unique_violation, say) pays for neither.
+ *
+ * The ErrorData is still copied here, as the error state is flushed before
+ * returning to Java, and the copy is what PostgreSQL gets back if Java lets
+ * the exception propagate.
+ */
 void Exception_throw_ERROR(const char* funcName)
 {
 	jobject ex;
 	PG_TRY();
 	{
-		jobject ed = pljava_ErrorData_getCurrentError();
-	
+		ErrorData *edata;
+		jobject ed = pljava_ErrorData_getCurrentError(&edata);
+		jstring message;
+		jstring sqlState;
+
 		FlushErrorState();
-	
-		ex = JNI_newObject(ServerException_class, ServerException_init, ed);
+
+		message = NULL == edata->message
+			? NULL : String_createJavaStringFromNTS(edata->message);
+		sqlState = String_createJavaStringFromNTS(
+			unpack_sql_state(edata->sqlerrcode));
+
+		if ( Backend_isStacklessSQLState(edata->sqlerrcode) )
+			ex = JNI_newObject(s_ServerException_Stackless_class,
+				s_ServerException_Stackless_init, ed, message, sqlState);
+		else
+			ex = JNI_newObject(ServerException_class, ServerException_init,
+				ed, message, sqlState);
+
+		/*
+		 * With pljava.log_cancel_stack on, Java logs the stack (that is, where
+		 * the Java code called in) if this is a cancel, as by statement_timeout.
+		 * It must happen before errorOccurred is set, or the logging could not
+		 * reach elog.
+		 */
+		if ( Backend_isLogCancelStack() )
+			JNI_callStaticVoidMethod(ServerException_class,
+				ServerException_logCancelStack, ex);
 		currentInvocation->errorOccurred = true;
 
 		elog(DEBUG2, "Exception in function %s", funcName);
 
 		JNI_deleteLocalRef(ed);
+		if ( NULL != message )
+			JNI_deleteLocalRef(message);
+		JNI_deleteLocalRef(sqlState);
 		JNI_throw(ex);
 	}
 	PG_CATCH();
@@ -210,7 +252,19 @@ extern void Exception_initialize2(void);
 void Exception_initialize2(void)
 {
 	ServerException_class = (jclass)JNI_newGlobalRef(PgObject_getJavaClass("org/postgresql/pljava/internal/ServerException"));
-	ServerException_init = PgObject_getJavaMethod(ServerException_class, "<init>", "(Lorg/postgresql/pljava/internal/ErrorData;)V");
+	ServerException_init = PgObject_getJavaMethod(ServerException_class, "<init>", "(Lorg/postgresql/pljava/internal/ErrorData;Ljava/lang/String;Ljava/lang/String;)V");
+
+	s_ServerException_Stackless_class = (jclass)JNI_newGlobalRef(
+		PgObject_getJavaClass(
+			"org/postgresql/pljava/internal/ServerException$Stackless"));
+	s_ServerException_Stackless_init = PgObject_getJavaMethod(
+		s_ServerException_Stackless_class, "<init>",
+		"(Lorg/postgresql/pljava/internal/ErrorData;"
+		"Ljava/lang/String;Ljava/lang/String;)V");
 
 	ServerException_getErrorData = PgObject_getJavaMethod(ServerException_class, "getErrorData", "()Lorg/postgresql/pljava/internal/ErrorData;");
+
+	ServerException_logCancelStack = PgObject_getStaticJavaMethod(
+		ServerException_class, "logCancelStack",
+		"(Lorg/postgresql/pljava/internal/ServerException;)V");
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2004-2019 Tada AB and other contributors, as listed below.
+ * Copyright (c) 2004-2026 Tada AB and other contributors, as listed below.
  *
  * All rights reserved. This program and the accompanying materials
  * are made available under the terms of the The BSD 3-Clause License
@@ -14,9 +14,18 @@
  */
 #include <postgres.h>
 #include <executor/tuptable.h>
+#include <miscadmin.h>
 #include <utils/guc.h>
+#include <utils/memutils.h>
+#include <utils/plancache.h>
+#if PG_VERSION_NUM >= 140000
+#include <nodes/params.h>
+#include <tcop/dest.h>
+#include <utils/resowner.h>
+#endif
 
 #include "org_postgresql_pljava_internal_ExecutionPlan.h"
+#include "pljava/Backend.h"
 #include "pljava/DualState.h"
 #include "pljava/Invocation.h"
 #include "pljava/Exception.h"
@@ -26,10 +35,6 @@
 #include "pljava/type/Portal.h"
 #include "pljava/type/String.h"
 
-#if defined(NEED_MISCADMIN_FOR_STACK_BASE)
-#include <miscadmin.h>
-#endif
-
 /* Class 07 - Dynamic SQL Error */
 #define ERRCODE_PARAMETER_COUNT_MISMATCH	MAKE_SQLSTATE('0','7', '0','0','1')
 
@@ -40,9 +45,52 @@
 #define SPI_READONLY_CLEARED \
 		org_postgresql_pljava_internal_ExecutionPlan_SPI_READONLY_CLEARED
 
+#define PLAN_MODE_GENERIC \
+		org_postgresql_pljava_internal_ExecutionPlan_PLAN_MODE_GENERIC
+#define PLAN_MODE_CUSTOM \
+		org_postgresql_pljava_internal_ExecutionPlan_PLAN_MODE_CUSTOM
+#define PLAN_SCROLL \
+		org_postgresql_pljava_internal_ExecutionPlan_PLAN_SCROLL
+
 static jclass s_ExecutionPlan_class;
 static jmethodID s_ExecutionPlan_init;
 
+/*
+ * The Types of a prepared plan's arguments, resolved once in _prepare and
+ * kept with the plan (the Java ExecutionPlan holds a pointer to this along
+ * with the plan pointer), to be resolved again only if the plan is executed
+ * under a different type map. Allocated in the saved plan's own memory
+ * context, so it goes away with SPI_freeplan.
+ *
+ * The type map is held by a global reference, so it cannot be collected and
+ * another map take its place at the same address while the Types resolved
+ * with it are kept; the reference is deleted when the plan's context is.
+ */
+typedef struct
+{
+	jobject typeMap;
+#if PG_VERSION_NUM >= 100000
+	MemoryContextCallback cb;
+#endif
+	int     count;
+	Type    types[FLEXIBLE_ARRAY_MEMBER];
+} ArgTypes;
+
+static void releaseTypeMap(void* arg)
+{
+	ArgTypes* argTypes = (ArgTypes*)arg;
+	if(argTypes->typeMap != 0)
+	{
+		JNI_deleteGlobalRef(argTypes->typeMap);
+		argTypes->typeMap = 0;
+	}
+}
+
+static jobject typeMapRef(jobject typeMap)
+{
+	return typeMap == 0 ? 0 : JNI_newGlobalRef(typeMap);
+}
+
 /* Make this datatype available to the postgres system.
  */
 extern void pljava_ExecutionPlan_initialize(void);
@@ -52,7 +100,7 @@ void pljava_ExecutionPlan_initialize(void)
 	{
 		{
 		"_cursorOpen",
-		"(JLjava/lang/String;[Ljava/lang/Object;S)Lorg/postgresql/pljava/internal/Portal;",
+		"(JJLjava/lang/String;[Ljava/lang/Object;SZ)Lorg/postgresql/pljava/internal/Portal;",
 		Java_org_postgresql_pljava_internal_ExecutionPlan__1cursorOpen
 		},
 		{
@@ -62,12 +110,17 @@ void pljava_ExecutionPlan_initialize(void)
 		},
 		{
 		"_execute",
-		"(J[Ljava/lang/Object;SI)I",
+		"(JJ[Ljava/lang/Object;SI)I",
 		Java_org_postgresql_pljava_internal_ExecutionPlan__1execute
 		},
 		{
+		"_executeBatch",
+		"(JJ[[Ljava/lang/Object;SI)[J",
+		Java_org_postgresql_pljava_internal_ExecutionPlan__1executeBatch
+		},
+		{
 		"_prepare",
-		"(Ljava/lang/Object;Ljava/lang/String;[Lorg/postgresql/pljava/internal/Oid;)Lorg/postgresql/pljava/internal/ExecutionPlan;",
+		"(Ljava/lang/Object;Ljava/lang/String;[Lorg/postgresql/pljava/internal/Oid;S)Lorg/postgresql/pljava/internal/ExecutionPlan;",
 		Java_org_postgresql_pljava_internal_ExecutionPlan__1prepare
 		},
 		{ 0, 0, 0 }
@@ -79,15 +132,129 @@ void pljava_ExecutionPlan_initialize(void)
 	s_ExecutionPlan_init = PgObject_getJavaMethod(s_ExecutionPlan_class,
 		"<init>",
 		"(Lorg/postgresql/pljava/internal/DualState$Key;J"
-		"Ljava/lang/Object;J)V");
+		"Ljava/lang/Object;JJJ)V");
 }
 
-static bool coerceObjects(void* ePlan, jobjectArray jvalues, Datum** valuesPtr, char** nullsPtr)
+/*
+ * Coerce the count Java values in jvalues to Datums of the corresponding types,
+ * into values, marking nulls with 'n' in nulls (which the caller has filled
+ * with ' ' and terminated). Returns true if any value was null.
+ */
+static bool coerceInto(int count, Type* types, jobjectArray jvalues,
+	Datum* values, char* nulls)
 {
-	char*  nulls = 0;
-	Datum* values = 0;
+	int idx;
+	bool anyNull = false;
+	for(idx = 0; idx < count; ++idx)
+	{
+		jobject value = JNI_getObjectArrayElement(jvalues, idx);
+		if(value != 0)
+		{
+			values[idx] = Type_coerceObjectBridged(types[idx], value);
+			JNI_deleteLocalRef(value);
+		}
+		else
+		{
+			values[idx] = 0;
+			nulls[idx] = 'n';
+			anyNull = true;
+		}
+	}
+	return anyNull;
+}
 
+/*
+ * Allocate the ArgTypes for a plan just saved with SPI_keepplan.
+ */
+static ArgTypes* createArgTypes(void* ePlan)
+{
 	int count = SPI_getargcount(ePlan);
+	ArgTypes* argTypes;
+	int idx;
+#if PG_VERSION_NUM >= 100000
+	MemoryContext cxt = GetMemoryChunkContext(ePlan);
+#else
+	/* not freed with the plan; plans are seldom freed, and this is small */
+	MemoryContext cxt = TopMemoryContext;
+#endif
+	argTypes = (ArgTypes*)MemoryContextAlloc(cxt,
+		offsetof(ArgTypes, types) + count * sizeof(Type));
+	argTypes->count = count;
+	argTypes->typeMap = typeMapRef(Invocation_getTypeMap());
+#if PG_VERSION_NUM >= 100000
+	argTypes->cb.func = releaseTypeMap;
+	argTypes->cb.arg = argTypes;
+	MemoryContextRegisterResetCallback(cxt, &argTypes->cb);
+#endif
+	for(idx = 0; idx < count; ++idx)
+		argTypes->types[idx] =
+			Type_fromOid(SPI_getargtypeid(ePlan, idx), argTypes->typeMap);
+	return argTypes;
+}
+
+/*
+ * Approximate the memory held by a saved plan: its own context and those of
+ * its cached plan sources (with their analyzed query trees). Generic plans
+ * built later, on execution, are not counted. Zero where the server cannot
+ * report context sizes.
+ */
+static jlong planBytes(void* ePlan)
+{
+#if PG_VERSION_NUM >= 130000
+	jlong bytes =
+		(jlong)MemoryContextMemAllocated(GetMemoryChunkContext(ePlan), true);
+	ListCell* lc;
+	foreach(lc, SPI_plan_get_plan_sources(ePlan))
+	{
+		CachedPlanSource* src = (CachedPlanSource*)lfirst(lc);
+		bytes += (jlong)MemoryContextMemAllocated(src->context, true);
+	}
+	return bytes;
+#else
+	return 0;
+#endif
+}
+
+/*
+ * Return the plan's resolved argument Types, resolving them again first if
+ * the current type map is not the one they were resolved with.
+ */
+static Type* currentArgTypes(void* ePlan, ArgTypes* argTypes)
+{
+	jobject typeMap = Invocation_getTypeMap();
+	if(!JNI_isSameObject(typeMap, argTypes->typeMap))
+	{
+		int idx;
+		for(idx = 0; idx < argTypes->count; ++idx)
+			argTypes->types[idx] =
+				Type_fromOid(SPI_getargtypeid(ePlan, idx), typeMap);
+		releaseTypeMap(argTypes);
+		argTypes->typeMap = typeMapRef(typeMap);
+	}
+	return argTypes->types;
+}
+
+/*
+ * Number of parameter values that coerceObjects can hold in the inline arrays
+ * of an ArgValues, which the caller declares on its stack. Plans with more
+ * parameters than this get palloc'd arrays.
+ */
+#define INLINE_ARGS 16
+
+typedef struct
+{
+	Datum* values;
+	char*  nulls;   /* 0 when no value is null, as SPI_execute_plan allows */
+	Datum  inlineValues[INLINE_ARGS];
+	char   inlineNulls[INLINE_ARGS + 1];
+} ArgValues;
+
+static bool coerceObjects(void* ePlan, ArgTypes* argTypes, jobjectArray jvalues, ArgValues* args)
+{
+	int count = argTypes->count;
+
+	args->values = 0;
+	args->nulls = 0;
 	if((jvalues == 0 && count != 0)
 	|| (jvalues != 0 && count != JNI_getArrayLength(jvalues)))
 	{
@@ -98,48 +265,98 @@ static bool coerceObjects(void* ePlan, jobjectArray jvalues, Datum** valuesPtr,
 
 	if(count > 0)
 	{
-		int idx;
-		jobject typeMap = Invocation_getTypeMap();
-		values = (Datum*)palloc(count * sizeof(Datum));
-		for(idx = 0; idx < count; ++idx)
+		Type* types = currentArgTypes(ePlan, argTypes);
+		char* nulls;
+		if(count <= INLINE_ARGS)
 		{
-			Oid typeId = SPI_getargtypeid(ePlan, idx);
-			Type type = Type_fromOid(typeId, typeMap);
-			jobject value = JNI_getObjectArrayElement(jvalues, idx);
-			if(value != 0)
-			{
-				values[idx] = Type_coerceObjectBridged(type, value);
-				JNI_deleteLocalRef(value);
-			}
-			else
-			{
-				values[idx] = 0;
-				if(nulls == 0)
-				{
-					nulls = (char*)palloc(count+1);
-					memset(nulls, ' ', count);	/* all values non-null initially */
-					nulls[count] = 0;
-					*nullsPtr = nulls;
-				}
-				nulls[idx] = 'n';
-			}
+			args->values = args->inlineValues;
+			nulls = args->inlineNulls;
 		}
+		else
+		{
+			args->values = (Datum*)palloc(count * sizeof(Datum));
+			nulls = (char*)palloc(count+1);
+		}
+		memset(nulls, ' ', count);	/* all values non-null initially */
+		nulls[count] = 0;
+		if(coerceInto(count, types, jvalues, args->values, nulls))
+			args->nulls = nulls;
+		else if(nulls != args->inlineNulls)
+			pfree(nulls);
 	}
-	*valuesPtr = values;
-	*nullsPtr = nulls;
 	return true;
 }
 
+/*
+ * Free whatever coerceObjects had to palloc.
+ */
+static void releaseArgValues(ArgValues* args)
+{
+	if(args->values != 0 && args->values != args->inlineValues)
+		pfree(args->values);
+	if(args->nulls != 0 && args->nulls != args->inlineNulls)
+		pfree(args->nulls);
+}
+
+/*
+ * Execute a plan whose caller wants only SPI_processed, not the rows. From
+ * PostgreSQL 14, the rows go to None_Receiver as the executor makes them,
+ * rather than all being gathered into SPI_tuptable first; SPI_processed still
+ * counts them, though a SELECT then reports SPI_OK_UTILITY. Before 14, this is
+ * SPI_execute_plan and the caller frees SPI_tuptable.
+ */
+static int executeDiscardingRows(void* ePlan,
+	Datum* values, const char* nulls, bool read_only, long count)
+{
+#if PG_VERSION_NUM >= 140000
+	SPIExecuteOptions options;
+	ParamListInfo params = 0;
+	int nargs = SPI_getargcount(ePlan);
+	int idx;
+	int result;
+
+	if(nargs > 0)
+	{
+		params = makeParamList(nargs);
+		for(idx = 0; idx < nargs; ++idx)
+		{
+			ParamExternData* prm = &params->params[idx];
+			prm->value = values[idx];
+			prm->isnull = (nulls != 0 && nulls[idx] == 'n');
+			prm->pflags = PARAM_FLAG_CONST;
+			prm->ptype = SPI_getargtypeid(ePlan, idx);
+		}
+	}
+
+	memset(&options, 0, sizeof options);
+	options.params = params;
+	options.read_only = read_only;
+	options.tcount = count;
+	options.dest = None_Receiver;
+	options.owner = CurrentResourceOwner;
+
+	result = SPI_execute_plan_extended(ePlan, &options);
+	Backend_configMayHaveChanged();
+	if(params != 0)
+		pfree(params);
+	return result;
+#else
+	int result = SPI_execute_plan(ePlan, values, nulls, read_only, count);
+	Backend_configMayHaveChanged();
+	return result;
+#endif
+}
+
 /****************************************
  * JNI methods
  ****************************************/
 /*
  * Class:     org_postgresql_pljava_internal_ExecutionPlan
  * Method:    _cursorOpen
- * Signature: (JLjava/lang/String;[Ljava/lang/Object;S)Lorg/postgresql/pljava/internal/Portal;
+ * Signature: (JJLjava/lang/String;[Ljava/lang/Object;SZ)Lorg/postgresql/pljava/internal/Portal;
  */
 JNIEXPORT jobject JNICALL
-Java_org_postgresql_pljava_internal_ExecutionPlan__1cursorOpen(JNIEnv* env, jobject jplan, jlong _this, jstring cursorName, jobjectArray jvalues, jshort readonly_spec)
+Java_org_postgresql_pljava_internal_ExecutionPlan__1cursorOpen(JNIEnv* env, jobject jplan, jlong _this, jlong _argTypes, jstring cursorName, jobjectArray jvalues, jshort readonly_spec, jboolean hold)
 {
 	jobject jportal = 0;
 	if(_this != 0)
@@ -150,10 +367,11 @@ Java_org_postgresql_pljava_internal_ExecutionPlan__1cursorOpen(JNIEnv* env, jobj
 		PG_TRY();
 		{
 			Ptr2Long p2l;
-			Datum*  values  = 0;
-			char*   nulls   = 0;
+			Ptr2Long p2lat;
+			ArgValues args;
 			p2l.longVal = _this;
-			if(coerceObjects(p2l.ptrVal, jvalues, &values, &nulls))
+			p2lat.longVal = _argTypes;
+			if(coerceObjects(p2l.ptrVal, p2lat.ptrVal, jvalues, &args))
 			{
 				Portal portal;
 				char* name = 0;
@@ -161,21 +379,27 @@ Java_org_postgresql_pljava_internal_ExecutionPlan__1cursorOpen(JNIEnv* env, jobj
 				if(cursorName != 0)
 					name = String_createNTS(cursorName);
 
+				/* as for DECLARE ... WITH HOLD */
+				if ( JNI_TRUE == hold && InSecurityRestrictedOperation() )
+					ereport(ERROR,
+						(errcode(ERRCODE_INSUFFICIENT_PRIVILEGE),
+						 errmsg("cannot create a cursor WITH HOLD within "
+								"security-restricted operation")));
+
 				Invocation_assertConnect();
 				if ( SPI_READONLY_DEFAULT == readonly_spec )
 					read_only = Function_isCurrentReadOnly();
 				else
 					read_only = (SPI_READONLY_FORCED == readonly_spec);
 				portal = SPI_cursor_open(
-					name, p2l.ptrVal, values, nulls, read_only);
+					name, p2l.ptrVal, args.values, args.nulls, read_only);
+				Backend_configMayHaveChanged();
 				if(name != 0)
 					pfree(name);
-				if(values != 0)
-					pfree(values);
-				if(nulls != 0)
-					pfree(nulls);
+				releaseArgValues(&args);
 			
-				jportal = pljava_Portal_create(portal, jplan);
+				jportal =
+					pljava_Portal_create(portal, jplan, JNI_TRUE == hold);
 			}
 		}
 		PG_CATCH();
@@ -222,10 +446,10 @@ Java_org_postgresql_pljava_internal_ExecutionPlan__1isCursorPlan(JNIEnv* env, jc
 /*
  * Class:     org_postgresql_pljava_internal_ExecutionPlan
  * Method:    _execute
- * Signature: (J[Ljava/lang/Object;SI)V
+ * Signature: (JJ[Ljava/lang/Object;SI)I
  */
 JNIEXPORT jint JNICALL
-Java_org_postgresql_pljava_internal_ExecutionPlan__1execute(JNIEnv* env, jclass clazz, jlong _this, jobjectArray jvalues, jshort readonly_spec, jint count)
+Java_org_postgresql_pljava_internal_ExecutionPlan__1execute(JNIEnv* env, jclass clazz, jlong _this, jlong _argTypes, jobjectArray jvalues, jshort readonly_spec, jint count)
 {
 	jint result = 0;
 	if(_this != 0)
@@ -236,10 +460,11 @@ Java_org_postgresql_pljava_internal_ExecutionPlan__1execute(JNIEnv* env, jclass
 		PG_TRY();
 		{
 			Ptr2Long p2l;
-			Datum* values = 0;
-			char*  nulls  = 0;
+			Ptr2Long p2lat;
+			ArgValues args;
 			p2l.longVal = _this;
-			if(coerceObjects(p2l.ptrVal, jvalues, &values, &nulls))
+			p2lat.longVal = _argTypes;
+			if(coerceObjects(p2l.ptrVal, p2lat.ptrVal, jvalues, &args))
 			{
 				bool read_only;
 				Invocation_assertConnect();
@@ -247,15 +472,132 @@ Java_org_postgresql_pljava_internal_ExecutionPlan__1execute(JNIEnv* env, jclass
 					read_only = Function_isCurrentReadOnly();
 				else
 					read_only = (SPI_READONLY_FORCED == readonly_spec);
-				result = (jint)SPI_execute_plan(
-					p2l.ptrVal, values, nulls, read_only, (int)count);
+				result = (jint)executeDiscardingRows(
+					p2l.ptrVal, args.values, args.nulls, read_only, (long)count);
 				if(result < 0)
 					Exception_throwSPI("execute_plan", result);
 
-				if(values != 0)
-					pfree(values);
-				if(nulls != 0)
-					pfree(nulls);
+				releaseArgValues(&args);
+			}
+		}
+		PG_CATCH();
+		{
+			Exception_throw_ERROR("SPI_execute_plan");
+		}
+		PG_END_TRY();
+		STACK_BASE_POP()
+		END_NATIVE
+	}
+	return result;
+}
+
+/*
+ * Class:     org_postgresql_pljava_internal_ExecutionPlan
+ * Method:    _executeBatch
+ * Signature: (JJ[[Ljava/lang/Object;SI)[J
+ *
+ * Execute the plan once for each row of parameter values, returning the
+ * SPI_processed count for each execution. Any rows returned by the plan are
+ * discarded. Memory used in coercing one row's values is reclaimed before the
+ * next.
+ */
+JNIEXPORT jlongArray JNICALL
+Java_org_postgresql_pljava_internal_ExecutionPlan__1executeBatch(JNIEnv* env, jclass clazz, jlong _this, jlong _argTypes, jobjectArray jrows, jshort readonly_spec, jint count)
+{
+	jlongArray result = 0;
+	if(_this != 0 && jrows != 0)
+	{
+		BEGIN_NATIVE
+		STACK_BASE_VARS
+		STACK_BASE_PUSH(env)
+		PG_TRY();
+		{
+			Ptr2Long p2l;
+			Ptr2Long p2lat;
+			void*  ePlan;
+			int    nargs;
+			jsize  nrows = JNI_getArrayLength(jrows);
+			jsize  row;
+			jlong* counts;
+			Type*  types = 0;
+			Datum* values = 0;
+			char*  nulls = 0;
+			bool   read_only;
+			MemoryContext rowCtx;
+			MemoryContext curr;
+
+			p2l.longVal = _this;
+			p2lat.longVal = _argTypes;
+			ePlan = p2l.ptrVal;
+			nargs = ((ArgTypes*)p2lat.ptrVal)->count;
+
+			Invocation_assertConnect();
+			if ( SPI_READONLY_DEFAULT == readonly_spec )
+				read_only = Function_isCurrentReadOnly();
+			else
+				read_only = (SPI_READONLY_FORCED == readonly_spec);
+
+			counts = (jlong*)palloc0(((Size)nrows + 1) * sizeof(jlong));
+			if(nargs > 0)
+			{
+				types  = currentArgTypes(ePlan, p2lat.ptrVal);
+				values = (Datum*)palloc(nargs * sizeof(Datum));
+				nulls  = (char*)palloc(nargs + 1);
+				nulls[nargs] = 0;
+			}
+
+			rowCtx = AllocSetContextCreate(CurrentMemoryContext,
+				"PL/Java ExecutionPlan batch row", ALLOCSET_DEFAULT_SIZES);
+
+			for(row = 0; row < nrows; ++row)
+			{
+				int spi_ret;
+				bool anyNull = false;
+				jobjectArray jvalues =
+					(jobjectArray)JNI_getObjectArrayElement(jrows, row);
+
+				if((jvalues == 0 && nargs != 0)
+				|| (jvalues != 0 && nargs != JNI_getArrayLength(jvalues)))
+				{
+					JNI_deleteLocalRef(jvalues);
+					Exception_throw(ERRCODE_PARAMETER_COUNT_MISMATCH,
+						"Number of values does not match number of arguments for prepared plan");
+					break;
+				}
+
+				curr = MemoryContextSwitchTo(rowCtx);
+				if(nargs > 0)
+				{
+					memset(nulls, ' ', nargs);
+					anyNull = coerceInto(nargs, types, jvalues, values, nulls);
+				}
+				JNI_deleteLocalRef(jvalues);
+				MemoryContextSwitchTo(curr);
+
+				spi_ret = executeDiscardingRows(ePlan, values,
+					anyNull ? nulls : NULL, read_only, (long)count);
+				MemoryContextReset(rowCtx);
+				if(spi_ret < 0)
+				{
+					Exception_throwSPI("execute_plan", spi_ret);
+					break;
+				}
+				counts[row] = (jlong)SPI_processed;
+				SPI_freetuptable(SPI_tuptable);
+				SPI_tuptable = 0;
+			}
+
+			MemoryContextDelete(rowCtx);
+			if(row == nrows)
+			{
+				result = JNI_newLongArray(nrows);
+				JNI_setLongArrayRegion(result, 0, nrows, counts);
+			}
+			pfree(counts);
+			if(types != 0)
+			{
+				pfree(values);
+				pfree(nulls);
 			}
 		}
 		PG_CATCH();
@@ -272,12 +614,13 @@ Java_org_postgresql_pljava_internal_ExecutionPlan__1execute(JNIEnv* env, jclass
 /*
  * Class:     org_postgresql_pljava_internal_ExecutionPlan
  * Method:    _prepare
- * Signature: (Ljava/lang/Object;Ljava/lang/String;[Lorg/postgresql/pljava/internal/Oid;)Lorg/postgresql/pljava/internal/ExecutionPlan;
+ * Signature: (Ljava/lang/Object;Ljava/lang/String;[Lorg/postgresql/pljava/internal/Oid;S)Lorg/postgresql/pljava/internal/ExecutionPlan;
  */
 JNIEXPORT jobject JNICALL
-Java_org_postgresql_pljava_internal_ExecutionPlan__1prepare(JNIEnv* env, jclass clazz, jobject key, jstring jcmd, jobjectArray paramTypes)
+Java_org_postgresql_pljava_internal_ExecutionPlan__1prepare(JNIEnv* env, jclass clazz, jobject key, jstring jcmd, jobjectArray paramTypes, jshort planMode)
 {
 	jobject result = 0;
+	int cursorOptions = 0;
 #if PG_VERSION_NUM >= 90200
 	int spi_ret;
 #endif
@@ -307,9 +650,20 @@ Java_org_postgresql_pljava_internal_ExecutionPlan__1prepare(JNIEnv* env, jclass
 			}
 		}
 
+		if ( 0 != (PLAN_SCROLL & planMode) )
+			cursorOptions |= CURSOR_OPT_SCROLL;
+		planMode &= ~PLAN_SCROLL;
+
+#if PG_VERSION_NUM >= 90200
+		if ( PLAN_MODE_GENERIC == planMode )
+			cursorOptions |= CURSOR_OPT_GENERIC_PLAN;
+		else if ( PLAN_MODE_CUSTOM == planMode )
+			cursorOptions |= CURSOR_OPT_CUSTOM_PLAN;
+#endif
+
 		cmd   = String_createNTS(jcmd);
 		Invocation_assertConnect();
-		ePlan = SPI_prepare(cmd, paramCount, paramOids);
+		ePlan = SPI_prepare_cursor(cmd, paramCount, paramOids, cursorOptions);
 		pfree(cmd);
 
 		if(ePlan == 0)
@@ -317,10 +671,12 @@ Java_org_postgresql_pljava_internal_ExecutionPlan__1prepare(JNIEnv* env, jclass
 		else
 		{
 			Ptr2Long p2l;
+			Ptr2Long p2lat;
 			
 			/* Make the plan durable
 			 */
 			p2l.longVal = 0L; /* ensure that the rest is zeroed out */
+			p2lat.longVal = 0L;
 #if PG_VERSION_NUM >= 90200
 			spi_ret = SPI_keepplan(ePlan);
 			if ( 0 == spi_ret )
@@ -331,10 +687,12 @@ Java_org_postgresql_pljava_internal_ExecutionPlan__1prepare(JNIEnv* env, jclass
 			p2l.ptrVal = SPI_saveplan(ePlan);
 			SPI_freeplan(ePlan); /* Get rid of original, nobody can see it */
 #endif
+			p2lat.ptrVal = createArgTypes(p2l.ptrVal);
 			result = JNI_newObjectLocked(
 				s_ExecutionPlan_class, s_ExecutionPlan_init,
 				/* (jlong)0 as resource owner: the saved plan isn't transient */
-				pljava_DualState_key(), (jlong)0, key, p2l.longVal);
+				pljava_DualState_key(), (jlong)0, key, p2l.longVal,
+				p2lat.longVal, planBytes(p2l.ptrVal));
 		}
 	}
 	PG_CATCH();
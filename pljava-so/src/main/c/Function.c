@@ -12,20 +12,23 @@
  */
 #include "org_postgresql_pljava_internal_Function.h"
 #include "org_postgresql_pljava_internal_Function_EarlyNatives.h"
+#include "org_postgresql_pljava_internal_FunctionStats.h"
+#include "pljava/Backend.h"
 #include "pljava/PgObject_priv.h"
 #include "pljava/Exception.h"
 #include "pljava/InstallHelper.h"
 #include "pljava/Invocation.h"
 #include "pljava/Function.h"
-#include "pljava/HashMap.h"
-#include "pljava/Iterator.h"
 #include "pljava/JNICalls.h"
+#include "pljava/OidMap.h"
+#include "pljava/SortSupport.h"
 #include "pljava/type/Composite.h"
 #include "pljava/type/Oid.h"
 #include "pljava/type/String.h"
 #include "pljava/type/TriggerData.h"
 #include "pljava/type/UDT.h"
 
+#include <access/xact.h>
 #include <catalog/pg_proc.h>
 #include <catalog/pg_language.h>
 #include <catalog/pg_namespace.h>
@@ -33,6 +36,23 @@
 #include <ctype.h>
 #include <funcapi.h>
 #include <utils/typcache.h>
+#include <utils/inval.h>
+#include <utils/syscache.h>
+#include <utils/datum.h>
+#include <lib/stringinfo.h>
+#include <nodes/makefuncs.h>
+#include <utils/lsyscache.h>
+
+#if PG_VERSION_NUM >= 120000
+#include <nodes/supportnodes.h>
+#include <optimizer/cost.h>
+#endif
+
+#if PG_VERSION_NUM >= 130000
+#include <common/hashfn.h>
+#else
+#include <access/hash.h>
+#endif
 
 #ifdef _MSC_VER
 #	define strcasecmp _stricmp
@@ -52,10 +72,121 @@
 
 #define COUNTCHECK(refs, prims) ((jshort)(((refs) << 8) | ((prims) & 0xff)))
 
+/*
+ * Layout of the slot array of per-function counts kept while
+ * pljava.track_functions is on, shared with FunctionStats.java.
+ */
+#define STATS_CONST(name) org_postgresql_pljava_internal_FunctionStats_s_##name
+#define STATS_SLOT_LONGS STATS_CONST(slotLongs)
+#define STATS_CAPACITY   STATS_CONST(capacity)
+#define STATS_USED       STATS_CONST(header_used)
+#define STATS_UNTRACKED  STATS_CONST(header_untracked)
+#define STATS_OID        STATS_CONST(oid)
+#define STATS_CALLS      STATS_CONST(calls)
+#define STATS_TOTAL      STATS_CONST(totalNanos)
+#define STATS_MAX        STATS_CONST(maxNanos)
+#define STATS_JAVA       STATS_CONST(javaNanos)
+#define STATS_ARGS       STATS_CONST(argumentNanos)
+#define STATS_RETURN     STATS_CONST(returnNanos)
+#define STATS_MEMO_HITS  STATS_CONST(memoHits)
+
+/*
+ * One step of the argument plan compiled for a non-UDT function once its
+ * parameter types are final, so the per-call loop in Function_invoke need not
+ * rediscover, for every argument on every call, whether it is passed as
+ * a primitive, which slot it goes in, and which coercer applies.
+ */
+typedef struct
+{
+	/*
+	 * The coercer of the parameter's Type, or NULL if the Type is dynamic and
+	 * must be resolved against the actual argument type at call time.
+	 */
+	DatumCoercer coerce;
+	Type         type;
+	/*
+	 * Index into s_primitiveParameters or s_referenceParameters.
+	 */
+	uint16       slot;
+	bool         primitive;
+	/*
+	 * True if the Type is an ImmutableUDT, decoded through the call site's
+	 * UDTDecodeCache.
+	 */
+	bool         decodeOnce;
+} ArgStep;
+
+/*
+ * For a function with dynamic (polymorphic) parameter or return types, the
+ * Types they resolve to at one call site, kept in flinfo->fn_extra so the
+ * resolution is done once per call site (typically once per query) rather
+ * than on every call. The actual argument and result types at a call site do
+ * not change, so they need not be rechecked; the serial number of the Function
+ * is remembered in case the function cache has been cleared and the Function
+ * replaced. (Not its address, which a new Function could be given once the
+ * old one is freed.) A NULL
+ * entry is one that could not be resolved in advance (the parameter is not
+ * dynamic, or its actual type is not known from the call expression), and is
+ * handled as if uncached.
+ *
+ * The same structure also holds, for any function that is not multi-call,
+ * the state the return type's invoke method may keep for the call site; see
+ * pljava_Function_callSiteState, and the decode cache for its ImmutableUDT
+ * parameters.
+ */
+typedef struct
+{
+	uint64   serial;
+	void*    resultState;
+	UDTDecodeCache udtCache;
+	Type     returnType;
+	Type     paramTypes [ FLEXIBLE_ARRAY_MEMBER ];
+} PolyCache;
+
+/*
+ * For a function declared with the [memoize=n] transformation, the results of
+ * its n most recently used distinct argument lists, so a repeated call can be
+ * answered without entering Java. The key of an entry is the arguments laid
+ * end to end: for each, a null flag and, if not null, the Datum itself for a
+ * by-value type, or the bytes of a by-reference one (after detoasting, as
+ * a length and the data for a varlena). Only the bytes are compared, so two
+ * equal values stored differently (one compressed, say) are simply two keys.
+ *
+ * Entries are found by hash through chains from buckets, and kept in a list
+ * in order of use; all links are indices into entries, -1 meaning none. The
+ * whole cache, and the keys and by-reference results it holds, are in its own
+ * context, deleted with the Function.
+ */
+typedef struct
+{
+	uint32 hash;
+	int32  chain;
+	int32  prev;
+	int32  next;
+	int32  keyLen;
+	char*  key;
+	Datum  result;
+	bool   isnull;
+} MemoEntry;
+
+typedef struct
+{
+	MemoryContext cxt;
+	StringInfoData scratch;
+	int32  capacity;
+	int32  count;
+	uint32 bucketMask;
+	int32* buckets;
+	int32  head;
+	int32  tail;
+	int16  retLen;
+	bool   retByVal;
+	MemoEntry entries [ FLEXIBLE_ARRAY_MEMBER ];
+} MemoCache;
+
 jobject pljava_Function_NO_LOADER;
 
 static jclass s_Function_class;
-static jclass s_ParameterFrame_class;
 static jclass s_EntryPoints_class;
 static jmethodID s_Function_create;
 static jmethodID s_Function_getClassIfUDT;
@@ -63,17 +194,31 @@ static jmethodID s_Function_udtReadHandle;
 static jmethodID s_Function_udtParseHandle;
 static jmethodID s_Function_udtWriteHandle;
 static jmethodID s_Function_udtToStringHandle;
-static jmethodID s_ParameterFrame_push;
-static jmethodID s_ParameterFrame_pop;
 static jmethodID s_EntryPoints_invoke;
 static jmethodID s_EntryPoints_udtWriteInvoke;
 static jmethodID s_EntryPoints_udtToStringInvoke;
 static jmethodID s_EntryPoints_udtReadInvoke;
 static jmethodID s_EntryPoints_udtParseInvoke;
+static jmethodID s_EntryPoints_udtReadBinaryInvoke;
+static jmethodID s_EntryPoints_udtBinaryLengthInvoke;
+static jmethodID s_EntryPoints_udtWriteBinaryInvoke;
+static jmethodID s_EntryPoints_planSupportInvoke;
+static jmethodID s_EntryPoints_sortSupportAbbreviates;
+static jmethodID s_EntryPoints_sortSupportCompare;
+static jmethodID s_EntryPoints_sortSupportAbbreviate;
+static jmethodID s_EntryPoints_srfProducer;
+static jmethodID s_EntryPoints_srfBatchFill;
+static jmethodID s_EntryPoints_srfWrite;
+static jmethodID s_EntryPoints_srfPrimitiveFill;
+static jclass s_FunctionStats_class;
+static jmethodID s_FunctionStats_publish;
 static PgObjectClass s_FunctionClass;
 static Type s_pgproc_Type;
 
+static Datum invoke(
+	Function self, bool forTrigger, int64 *argNanos, PG_FUNCTION_ARGS);
 static inline Datum invokeTrigger(Function self, PG_FUNCTION_ARGS);
+static void compileArgPlan(Function self);
 
 static jobjectArray s_referenceParameters;
 static jvalue s_primitiveParameters [ 1 + 255 ];
@@ -82,6 +227,22 @@ static jshort * const s_countCheck =
 	(jshort *)(((char *)s_primitiveParameters) +
 		org_postgresql_pljava_internal_Function_s_offset_paramCounts);
 
+/*
+ * Stack of parameter frames saved for the re-entrant case described at
+ * reserveParameterFrame. Each saved frame is the in-use primitive jvalues (at
+ * least slot 0), then the in-use reference parameters as local references,
+ * then one jvalue holding the frame's counts; so a push or pop only moves
+ * s_savedFramesTop, and the area (in TopMemoryContext) is grown only when a
+ * nesting deeper than any before is reached.
+ *
+ * The local references are made in the JNI local frame of the re-entrant
+ * Invocation, which is still in place when Invocation_popInvocation calls
+ * pljava_Function_popFrame, and are deleted there.
+ */
+static jvalue *s_savedFrames;
+static jsize s_savedFramesTop;
+static jsize s_savedFramesSize;
+
 struct Function_
 {
 	struct PgObject_ PgObject_extension;
@@ -98,6 +259,36 @@ struct Function_
 	 */
 	bool   isUDT;
 
+	/**
+	 * True if the function's pg_proc entry has changed since this was
+	 * created, so it should be created again at its next call.
+	 */
+	bool   stale;
+
+	/**
+	 * The next Function in the list of those taken out of the cache but not
+	 * yet freed; see retireFunction.
+	 */
+	Function retiredNext;
+
+	/**
+	 * Index of this function's slot in the pljava.track_functions counts,
+	 * zero if not yet looked up, or -1 if there was no room for it.
+	 */
+	int32  statsSlot;
+
+	/**
+	 * Hash value of the function's pg_proc syscache entry, to match against
+	 * invalidations.
+	 */
+	uint32 procHash;
+
+	/**
+	 * Number distinct to this Function among all made in the session, by which
+	 * a PolyCache recognizes the Function it was built for.
+	 */
+	uint64 serial;
+
 	/**
 	 * Java class, i.e. the UDT class or the class where the static method
 	 * is defined.
@@ -134,6 +325,36 @@ struct Function_
 		 * Array containing one type for eeach parameter.
 		 */
 		Type*     paramTypes;
+
+		/*
+		 * The number of entries in paramTypes (and argPlan).
+		 */
+		uint16    numParams;
+
+		/*
+		 * The argument plan, one step per parameter, built by compileArgPlan.
+		 */
+		ArgStep*  argPlan;
+
+		/*
+		 * True if any parameter type, or the return type, is dynamic; also
+		 * set by compileArgPlan.
+		 */
+		bool      hasDynamicTypes;
+
+		/*
+		 * True if any parameter is of an ImmutableUDT type; also set by
+		 * compileArgPlan.
+		 */
+		bool      hasDecodeOnce;
+
+		/*
+		 * The number of results to keep, for a function declared with the
+		 * [memoize=n] transformation, or zero; and the cache of them, made
+		 * at the first call.
+		 */
+		int32      memoSize;
+		MemoCache* memo;
 	
 		/*
 		 * The return type.
@@ -154,6 +375,21 @@ struct Function_
 		 * the function.
 		 */
 		jobject invocable;
+
+		/**
+		 * EntryPoints.Invocable carrying the PlannerSupport instance for a
+		 * function declared with the [support=class] transformation, or the
+		 * SortSupport instance for one declared AS 'sortsupport[class]';
+		 * otherwise NULL.
+		 */
+		jobject support;
+
+		/*
+		 * True for a function declared AS 'sortsupport[class]', the sort
+		 * support function of a btree operator class, which is handled
+		 * entirely here rather than by invoking a Java method.
+		 */
+		bool      isSortSupport;
 		} nonudt;
 		
 		struct
@@ -179,7 +415,26 @@ static struct Function_ s_initWriter;
 
 Function Function_INIT_WRITER = &s_initWriter;
 
-static HashMap s_funcMap = 0;
+static OidMap s_funcMap = 0;
+
+/*
+ * The pljava.track_functions counts, allocated at the first call tracked.
+ */
+static int64 *s_funcStats = NULL;
+
+/*
+ * Functions taken out of s_funcMap, because they went stale or their loader
+ * was cleared, and waiting to be freed at the end of the transaction.
+ */
+static Function s_retiredFunctions = NULL;
+
+/*
+ * The serial number given the last Function made.
+ */
+static uint64 s_lastSerial = 0;
+
+static bool Function_inUse(Function func);
+static void retiredFunctionsXactCB(XactEvent event, void *arg);
 
 static void _Function_finalize(PgObject func)
 {
@@ -189,10 +444,92 @@ static void _Function_finalize(PgObject func)
 	if(!self->isUDT)
 	{
 		JNI_deleteGlobalRef(self->func.nonudt.invocable);
+		if(self->func.nonudt.support != 0)
+			JNI_deleteGlobalRef(self->func.nonudt.support);
 		if(self->func.nonudt.typeMap != 0)
 			JNI_deleteGlobalRef(self->func.nonudt.typeMap);
 		if(self->func.nonudt.paramTypes != 0)
 			pfree(self->func.nonudt.paramTypes);
+		if(self->func.nonudt.argPlan != 0)
+			pfree(self->func.nonudt.argPlan);
+		if(self->func.nonudt.memo != 0)
+			MemoryContextDelete(self->func.nonudt.memo->cxt);
+	}
+}
+
+/*
+ * Take a Function out of use, once it has been removed from s_funcMap.
+ *
+ * It is not freed at once: a value-per-call set-returning function suspended
+ * between rows still holds it in its CallContextData, and a call site's
+ * PolyCache may still point to it, though neither is in the Invocation stack
+ * that Function_inUse can see. Neither outlives the transaction, so the
+ * Function is freed at its end, by retiredFunctionsXactCB.
+ */
+static void retireFunction(Function func)
+{
+	func->retiredNext = s_retiredFunctions;
+	s_retiredFunctions = func;
+}
+
+static void retiredFunctionsXactCB(XactEvent event, void *arg)
+{
+	Function *link = &s_retiredFunctions;
+	Function func;
+
+	switch ( event )
+	{
+	case XACT_EVENT_COMMIT:
+	case XACT_EVENT_ABORT:
+#if PG_VERSION_NUM >= 90500
+	case XACT_EVENT_PARALLEL_COMMIT:
+	case XACT_EVENT_PARALLEL_ABORT:
+#endif
+		break;
+	default:
+		return;
+	}
+
+	while ( NULL != (func = *link) )
+	{
+		if ( Function_inUse(func) )
+			link = &func->retiredNext;
+		else
+		{
+			*link = func->retiredNext;
+			PgObject_free((PgObject)func);
+		}
+	}
+}
+
+/*
+ * Invalidation callback for pg_proc, marking stale the cached non-UDT Functions
+ * whose entries have changed (or all of them, when the hash value is zero, or
+ * not supplied in older PostgreSQL versions). They are not freed here, as that
+ * would mean JNI calls at any point where invalidations are processed; instead
+ * getFunction replaces a stale one when it is next called, and retires it.
+ */
+#if PG_VERSION_NUM >= 90200
+static void procInvalCallback(Datum arg, int cacheId, uint32 hashValue)
+#else
+static void procInvalCallback(Datum arg, int cacheId, ItemPointer tuplePtr)
+#endif
+{
+	uint32 cursor = 0;
+	void *value;
+#if PG_VERSION_NUM < 90200
+	uint32 hashValue = 0;
+#endif
+
+	if ( NULL == s_funcMap )
+		return;
+
+	while ( OidMap_next(s_funcMap, &cursor, NULL, &value) )
+	{
+		Function func = (Function)value;
+		if ( ! func->isUDT
+			&&  ( 0 == hashValue  ||  func->procHash == hashValue ) )
+			func->stale = true;
 	}
 }
 
@@ -227,6 +564,22 @@ void Function_initialize(void)
 		"(J[Ljava/lang/String;[Ljava/lang/String;I)V",
 		Java_org_postgresql_pljava_internal_Function__1reconcileTypes
 		},
+		{
+		"_setMemoize",
+		"(JI)V",
+		Java_org_postgresql_pljava_internal_Function__1setMemoize
+		},
+		{
+		"_setSupport",
+		"(JLorg/postgresql/pljava/internal/EntryPoints$Invocable;)V",
+		Java_org_postgresql_pljava_internal_Function__1setSupport
+		},
+		{
+		"_storeToSortSupport",
+		"(JLjava/lang/ClassLoader;Ljava/lang/Class;Ljava/util/Map;"
+		"Lorg/postgresql/pljava/internal/EntryPoints$Invocable;)V",
+		Java_org_postgresql_pljava_internal_Function__1storeToSortSupport
+		},
 		{ 0, 0, 0 }
 	};
 
@@ -236,20 +589,15 @@ void Function_initialize(void)
 	StaticAssertStmt(org_postgresql_pljava_internal_Function_s_sizeof_jvalue
 		== sizeof (jvalue), "Function.java has wrong size for Java JNI jvalue");
 
-	s_funcMap = HashMap_create(59, TopMemoryContext);
+	s_funcMap = OidMap_create(59, TopMemoryContext);
+	CacheRegisterSyscacheCallback(PROCOID, procInvalCallback, (Datum)0);
+	RegisterXactCallback(retiredFunctionsXactCB, NULL);
 
 	cls = PgObject_getJavaClass(
 		"org/postgresql/pljava/internal/Function$EarlyNatives");
 	PgObject_registerNatives2(cls, earlyMethods);
 	JNI_deleteLocalRef(cls);
 
-	s_ParameterFrame_class = JNI_newGlobalRef(PgObject_getJavaClass(
-		"org/postgresql/pljava/internal/Function$ParameterFrame"));
-	s_ParameterFrame_push = PgObject_getStaticJavaMethod(s_ParameterFrame_class,
-		"push", "()V");
-	s_ParameterFrame_pop = PgObject_getStaticJavaMethod(s_ParameterFrame_class,
-		"pop", "()V");
-
 	s_Function_class = JNI_newGlobalRef(PgObject_getJavaClass(
 		"org/postgresql/pljava/internal/Function"));
 	s_Function_create = PgObject_getStaticJavaMethod(s_Function_class, "create",
@@ -291,6 +639,60 @@ void Function_initialize(void)
 		"(Lorg/postgresql/pljava/internal/EntryPoints$Invocable;"
 		"Ljava/lang/String;"
 		"Ljava/lang/String;)Ljava/sql/SQLData;");
+	s_EntryPoints_udtReadBinaryInvoke = PgObject_getStaticJavaMethod(
+		s_EntryPoints_class,
+		"udtReadBinaryInvoke",
+		"(Lorg/postgresql/pljava/internal/EntryPoints$Invocable;"
+		"[BLjava/lang/String;)Ljava/sql/SQLData;");
+	s_EntryPoints_udtBinaryLengthInvoke = PgObject_getStaticJavaMethod(
+		s_EntryPoints_class,
+		"udtBinaryLengthInvoke",
+		"(Lorg/postgresql/pljava/internal/EntryPoints$Invocable;"
+		"Ljava/sql/SQLData;)I");
+	s_EntryPoints_udtWriteBinaryInvoke = PgObject_getStaticJavaMethod(
+		s_EntryPoints_class,
+		"udtWriteBinaryInvoke",
+		"(Lorg/postgresql/pljava/internal/EntryPoints$Invocable;"
+		"Ljava/sql/SQLData;[B)I");
+	s_EntryPoints_planSupportInvoke = PgObject_getStaticJavaMethod(
+		s_EntryPoints_class,
+		"planSupportInvoke",
+		"(Lorg/postgresql/pljava/internal/EntryPoints$Invocable;"
+		"I[Ljava/lang/Object;[Z)Ljava/lang/Object;");
+	s_EntryPoints_sortSupportAbbreviates = PgObject_getStaticJavaMethod(
+		s_EntryPoints_class,
+		"sortSupportAbbreviates",
+		"(Lorg/postgresql/pljava/internal/EntryPoints$Invocable;)Z");
+	s_EntryPoints_sortSupportCompare = PgObject_getStaticJavaMethod(
+		s_EntryPoints_class,
+		"sortSupportCompare",
+		"(Lorg/postgresql/pljava/internal/EntryPoints$Invocable;"
+		"Ljava/lang/Object;Ljava/lang/Object;)I");
+	s_EntryPoints_sortSupportAbbreviate = PgObject_getStaticJavaMethod(
+		s_EntryPoints_class,
+		"sortSupportAbbreviate",
+		"(Lorg/postgresql/pljava/internal/EntryPoints$Invocable;"
+		"Ljava/lang/Object;)J");
+	s_EntryPoints_srfProducer = PgObject_getStaticJavaMethod(
+		s_EntryPoints_class,
+		"srfProducer",
+		"(Lorg/postgresql/pljava/internal/EntryPoints$Invocable;)"
+		"Ljava/lang/Object;");
+	s_EntryPoints_srfBatchFill = PgObject_getStaticJavaMethod(
+		s_EntryPoints_class,
+		"srfBatchFill",
+		"(Lorg/postgresql/pljava/internal/EntryPoints$Invocable;"
+		"Lorg/postgresql/pljava/jdbc/ColumnBatchWriter;)I");
+	s_EntryPoints_srfWrite = PgObject_getStaticJavaMethod(
+		s_EntryPoints_class,
+		"srfWrite",
+		"(Lorg/postgresql/pljava/internal/EntryPoints$Invocable;"
+		"Lorg/postgresql/pljava/jdbc/ColumnBatchWriter;J)V");
+	s_EntryPoints_srfPrimitiveFill = PgObject_getStaticJavaMethod(
+		s_EntryPoints_class,
+		"srfPrimitiveFill",
+		"(Lorg/postgresql/pljava/internal/EntryPoints$Invocable;"
+		"Lorg/postgresql/pljava/jdbc/PrimitiveBatchReader;)I");
 
 	s_Function_udtReadHandle = PgObject_getStaticJavaMethod(s_Function_class,
 		"udtReadHandle", "(Ljava/lang/Class;Ljava/lang/String;Z)"
@@ -308,6 +710,11 @@ void Function_initialize(void)
 
 	PgObject_registerNatives2(s_Function_class, functionMethods);
 
+	s_FunctionStats_class = JNI_newGlobalRef(PgObject_getJavaClass(
+		"org/postgresql/pljava/internal/FunctionStats"));
+	s_FunctionStats_publish = PgObject_getStaticJavaMethod(
+		s_FunctionStats_class, "publish", "(Ljava/nio/ByteBuffer;)V");
+
 	cls = PgObject_getJavaClass("org/postgresql/pljava/sqlj/Loader");
 	fld = PgObject_getStaticJavaField(cls,
 		"SENTINEL", "Ljava/lang/ClassLoader;");
@@ -320,71 +727,99 @@ void Function_initialize(void)
 	s_pgproc_Type = Composite_obtain(ProcedureRelation_Rowtype_Id);
 }
 
+/*
+ * Bracket a call into Java, adding its duration to the current invocation's
+ * javaTime when the invocation is being timed for pljava.track_functions.
+ * The timed flag is cleared for the duration, so an upcall made from within
+ * (a UDT conversion for an SPI result, say) is not counted twice. A call
+ * ending in an error is not added, as the invocation's counts will not be
+ * recorded anyway.
+ */
+static inline bool beginJava(instr_time *start)
+{
+	if ( NULL == currentInvocation  ||  ! currentInvocation->timed )
+		return false;
+	currentInvocation->timed = false;
+	INSTR_TIME_SET_CURRENT(*start);
+	return true;
+}
+
+static inline void endJava(bool timing, instr_time *start)
+{
+	instr_time now;
+	if ( ! timing )
+		return;
+	INSTR_TIME_SET_CURRENT(now);
+	INSTR_TIME_ACCUM_DIFF(currentInvocation->javaTime, now, *start);
+	currentInvocation->timed = true;
+}
+
+static inline jobject invokeEntry(jobject invocable)
+{
+	instr_time start;
+	jobject result;
+	bool timing = beginJava(&start);
+	result = JNI_callStaticObjectMethod(s_EntryPoints_class,
+		s_EntryPoints_invoke, invocable);
+	endJava(timing, &start);
+	return result;
+}
+
 jobject pljava_Function_refInvoke(Function self)
 {
-	return JNI_callStaticObjectMethod(s_EntryPoints_class,
-		s_EntryPoints_invoke, self->func.nonudt.invocable);
+	return invokeEntry(self->func.nonudt.invocable);
 }
 
 void pljava_Function_voidInvoke(Function self)
 {
-	JNI_callStaticObjectMethod(s_EntryPoints_class,
-		s_EntryPoints_invoke, self->func.nonudt.invocable);
+	invokeEntry(self->func.nonudt.invocable);
 }
 
 jboolean pljava_Function_booleanInvoke(Function self)
 {
-	JNI_callStaticObjectMethod(s_EntryPoints_class,
-		s_EntryPoints_invoke, self->func.nonudt.invocable);
+	invokeEntry(self->func.nonudt.invocable);
 	return s_primitiveParameters[0].z;
 }
 
 jbyte pljava_Function_byteInvoke(Function self)
 {
-	JNI_callStaticObjectMethod(s_EntryPoints_class,
-		s_EntryPoints_invoke, self->func.nonudt.invocable);
+	invokeEntry(self->func.nonudt.invocable);
 	return s_primitiveParameters[0].b;
 }
 
 jshort pljava_Function_shortInvoke(Function self)
 {
-	JNI_callStaticObjectMethod(s_EntryPoints_class,
-		s_EntryPoints_invoke, self->func.nonudt.invocable);
+	invokeEntry(self->func.nonudt.invocable);
 	return s_primitiveParameters[0].s;
 }
 
 jchar pljava_Function_charInvoke(Function self)
 {
-	JNI_callStaticObjectMethod(s_EntryPoints_class,
-		s_EntryPoints_invoke, self->func.nonudt.invocable);
+	invokeEntry(self->func.nonudt.invocable);
 	return s_primitiveParameters[0].c;
 }
 
 jint pljava_Function_intInvoke(Function self)
 {
-	JNI_callStaticObjectMethod(s_EntryPoints_class,
-		s_EntryPoints_invoke, self->func.nonudt.invocable);
+	invokeEntry(self->func.nonudt.invocable);
 	return s_primitiveParameters[0].i;
 }
 
 jfloat pljava_Function_floatInvoke(Function self)
 {
-	JNI_callStaticObjectMethod(s_EntryPoints_class,
-		s_EntryPoints_invoke, self->func.nonudt.invocable);
+	invokeEntry(self->func.nonudt.invocable);
 	return s_primitiveParameters[0].f;
 }
 
 jlong pljava_Function_longInvoke(Function self)
 {
-	JNI_callStaticObjectMethod(s_EntryPoints_class,
-		s_EntryPoints_invoke, self->func.nonudt.invocable);
+	invokeEntry(self->func.nonudt.invocable);
 	return s_primitiveParameters[0].j;
 }
 
 jdouble pljava_Function_doubleInvoke(Function self)
 {
-	JNI_callStaticObjectMethod(s_EntryPoints_class,
-		s_EntryPoints_invoke, self->func.nonudt.invocable);
+	invokeEntry(self->func.nonudt.invocable);
 	return s_primitiveParameters[0].d;
 }
 
@@ -412,6 +847,58 @@ jdouble pljava_Function_doubleInvoke(Function self)
  * jvalue slot for returns, though, must handle its own normal and exceptional
  * cleanup.
  */
+static void
+pushParameterFrame(void)
+{
+	jshort counts = *s_countCheck;
+	jsize refs = (counts >> 8) & 0xff;
+	jsize prims = Max(counts & 0xff, 1);
+	jsize needed = s_savedFramesTop + prims + refs + 1;
+	jvalue *top;
+	jsize i;
+
+	if ( needed > s_savedFramesSize )
+	{
+		jsize newSize = Max(needed, Max(2 * s_savedFramesSize, 64));
+		if ( NULL == s_savedFrames )
+			s_savedFrames = MemoryContextAlloc(TopMemoryContext,
+				newSize * sizeof *s_savedFrames);
+		else
+			s_savedFrames = repalloc(s_savedFrames,
+				newSize * sizeof *s_savedFrames);
+		s_savedFramesSize = newSize;
+	}
+
+	top = s_savedFrames + s_savedFramesTop;
+	memcpy(top, s_primitiveParameters, prims * sizeof *top);
+	top += prims;
+	for ( i = 0 ; i < refs ; ++ i )
+		(top++)->l = JNI_getObjectArrayElement(s_referenceParameters, i);
+	(top++)->s = counts;
+	s_savedFramesTop = top - s_savedFrames;
+}
+
+static void
+popParameterFrame(void)
+{
+	jvalue *top = s_savedFrames + s_savedFramesTop;
+	jshort counts = (--top)->s;
+	jsize refs = (counts >> 8) & 0xff;
+	jsize prims = Max(counts & 0xff, 1);
+	jsize i = refs;
+
+	while ( 0 < i-- )
+	{
+		--top;
+		JNI_setObjectArrayElement(s_referenceParameters, i, top->l);
+		JNI_deleteLocalRef(top->l);
+	}
+	top -= prims;
+	memcpy(s_primitiveParameters, top, prims * sizeof *top);
+	*s_countCheck = counts;
+	s_savedFramesTop = top - s_savedFrames;
+}
+
 static inline jsize
 reserveParameterFrame(jsize refArgCount, jsize primArgCount)
 {
@@ -428,8 +915,7 @@ reserveParameterFrame(jsize refArgCount, jsize primArgCount)
 	 */
 	if ( 0 != newCounts  &&  0 != *s_countCheck )
 	{
-		JNI_callStaticVoidMethodLocked(
-			s_ParameterFrame_class, s_ParameterFrame_push);
+		pushParameterFrame();
 		/* Record, in currentInvocation, that a frame was pushed; the pop
 		 * will happen in Invocation_popInvocation, which our caller
 		 * arranges for both normal return and PG_CATCH cases.
@@ -464,7 +950,7 @@ installContextLoader(Function self)
 void pljava_Function_popFrame(bool heavy)
 {
 	if ( heavy )
-		JNI_callStaticVoidMethod(s_ParameterFrame_class, s_ParameterFrame_pop);
+		popParameterFrame();
 
 	if ( pljava_Function_NO_LOADER == currentInvocation->savedLoader )
 		return;
@@ -499,36 +985,158 @@ jboolean pljava_Function_vpcInvoke(
 	JNI_setObjectArrayElement(s_referenceParameters, 0, rowcollect);
 	s_primitiveParameters[0].j = call_cntr;
 	s_primitiveParameters[1].z = close;
-	*result = JNI_callStaticObjectMethod(s_EntryPoints_class,
-		s_EntryPoints_invoke, invocable);
+	*result = invokeEntry(invocable);
 	return s_primitiveParameters[0].z;
 }
 
+jobject pljava_Function_srfProducer(jobject invocable)
+{
+	return JNI_callStaticObjectMethod(s_EntryPoints_class,
+		s_EntryPoints_srfProducer, invocable);
+}
+
+jint pljava_Function_srfBatchFill(jobject invocable, jobject batch)
+{
+	instr_time start;
+	jint result;
+	bool timing = beginJava(&start);
+	result = JNI_callStaticIntMethod(s_EntryPoints_class,
+		s_EntryPoints_srfBatchFill, invocable, batch);
+	endJava(timing, &start);
+	return result;
+}
+
+void pljava_Function_srfWrite(jobject invocable, jobject batch, jlong dest)
+{
+	instr_time start;
+	bool timing = beginJava(&start);
+	JNI_callStaticVoidMethod(s_EntryPoints_class,
+		s_EntryPoints_srfWrite, invocable, batch, dest);
+	endJava(timing, &start);
+}
+
+jint pljava_Function_srfPrimitiveFill(jobject invocable, jobject reader)
+{
+	instr_time start;
+	jint result;
+	bool timing = beginJava(&start);
+	result = JNI_callStaticIntMethod(s_EntryPoints_class,
+		s_EntryPoints_srfPrimitiveFill, invocable, reader);
+	endJava(timing, &start);
+	return result;
+}
+
 void pljava_Function_udtWriteInvoke(
 	jobject invocable, jobject value, jobject stream)
 {
+	instr_time start;
+	bool timing = beginJava(&start);
 	JNI_callStaticVoidMethod(s_EntryPoints_class,
 		s_EntryPoints_udtWriteInvoke, invocable, value, stream);
+	endJava(timing, &start);
 }
 
 jstring pljava_Function_udtToStringInvoke(jobject invocable, jobject value)
 {
-	return JNI_callStaticObjectMethod(s_EntryPoints_class,
+	instr_time start;
+	jstring result;
+	bool timing = beginJava(&start);
+	result = JNI_callStaticObjectMethod(s_EntryPoints_class,
 		s_EntryPoints_udtToStringInvoke, invocable, value);
+	endJava(timing, &start);
+	return result;
 }
 
 jobject pljava_Function_udtReadInvoke(
 	jobject invocable, jobject stream, jstring typeName)
 {
-	return JNI_callStaticObjectMethod(s_EntryPoints_class,
+	instr_time start;
+	jobject result;
+	bool timing = beginJava(&start);
+	result = JNI_callStaticObjectMethod(s_EntryPoints_class,
 		s_EntryPoints_udtReadInvoke, invocable, stream, typeName);
+	endJava(timing, &start);
+	return result;
 }
 
 jobject pljava_Function_udtParseInvoke(
 	jobject parseInvocable, jstring stringRep, jstring typeName)
 {
-	return JNI_callStaticObjectMethod(s_EntryPoints_class,
+	instr_time start;
+	jobject result;
+	bool timing = beginJava(&start);
+	result = JNI_callStaticObjectMethod(s_EntryPoints_class,
 		s_EntryPoints_udtParseInvoke, parseInvocable, stringRep, typeName);
+	endJava(timing, &start);
+	return result;
+}
+
+jobject pljava_Function_udtReadBinaryInvoke(
+	jobject invocable, jobject buffer, jstring typeName)
+{
+	instr_time start;
+	jobject result;
+	bool timing = beginJava(&start);
+	result = JNI_callStaticObjectMethod(s_EntryPoints_class,
+		s_EntryPoints_udtReadBinaryInvoke, invocable, buffer, typeName);
+	endJava(timing, &start);
+	return result;
+}
+
+jint pljava_Function_udtBinaryLengthInvoke(jobject invocable, jobject value)
+{
+	instr_time start;
+	jint result;
+	bool timing = beginJava(&start);
+	result = JNI_callStaticIntMethod(s_EntryPoints_class,
+		s_EntryPoints_udtBinaryLengthInvoke, invocable, value);
+	endJava(timing, &start);
+	return result;
+}
+
+jboolean pljava_Function_sortSupportAbbreviates(jobject invocable)
+{
+	instr_time start;
+	jboolean result;
+	bool timing = beginJava(&start);
+	result = JNI_callStaticBooleanMethod(s_EntryPoints_class,
+		s_EntryPoints_sortSupportAbbreviates, invocable);
+	endJava(timing, &start);
+	return result;
+}
+
+jint pljava_Function_sortSupportCompare(jobject invocable, jobject a, jobject b)
+{
+	instr_time start;
+	jint result;
+	bool timing = beginJava(&start);
+	result = JNI_callStaticIntMethod(s_EntryPoints_class,
+		s_EntryPoints_sortSupportCompare, invocable, a, b);
+	endJava(timing, &start);
+	return result;
+}
+
+jlong pljava_Function_sortSupportAbbreviate(jobject invocable, jobject value)
+{
+	instr_time start;
+	jlong result;
+	bool timing = beginJava(&start);
+	result = JNI_callStaticLongMethod(s_EntryPoints_class,
+		s_EntryPoints_sortSupportAbbreviate, invocable, value);
+	endJava(timing, &start);
+	return result;
+}
+
+jint pljava_Function_udtWriteBinaryInvoke(
+	jobject invocable, jobject value, jobject buffer)
+{
+	instr_time start;
+	jint result;
+	bool timing = beginJava(&start);
+	result = JNI_callStaticIntMethod(s_EntryPoints_class,
+		s_EntryPoints_udtWriteBinaryInvoke, invocable, value, buffer);
+	endJava(timing, &start);
+	return result;
 }
 
 static jobject obtainUDTHandle(
@@ -731,6 +1339,10 @@ static Function Function_create(
 		(Function)PgObjectClass_allocInstance(s_FunctionClass,TopMemoryContext);
 	p2l.longVal = 0;
 	p2l.ptrVal = (void *)self;
+	self->serial = ++ s_lastSerial;
+#if PG_VERSION_NUM >= 90200
+	self->procHash = GetSysCacheHashValue1(PROCOID, ObjectIdGetDatum(funcOid));
+#endif
 
 	PG_TRY();
 	{
@@ -785,6 +1397,7 @@ static Function Function_create(
 	{
 		self->func.nonudt.invocable = JNI_newGlobalRef(invocable);
 		JNI_deleteLocalRef(invocable);
+		compileArgPlan(self);
 	}
 	else if ( ! self->isUDT )
 	{
@@ -823,72 +1436,244 @@ getFunction(
 	bool forValidator, bool checkBody)
 {
 	Function func =
-		forValidator ? NULL : (Function)HashMap_getByOid(s_funcMap, funcOid);
+		forValidator ? NULL : (Function)OidMap_get(s_funcMap, funcOid);
+
+	if ( NULL != func  &&  func->stale  &&  ! Function_inUse(func) )
+	{
+		OidMap_remove(s_funcMap, funcOid);
+		retireFunction(func);
+		func = NULL;
+	}
 
 	if ( NULL == func )
 	{
 		func = Function_create(
 			funcOid, trusted, forTrigger, forValidator, checkBody);
 		if ( NULL != func )
-			HashMap_putByOid(s_funcMap, funcOid, func);
+			OidMap_put(s_funcMap, funcOid, func);
 	}
 
 	currentInvocation->function = func;
 	return func;
 }
 
-jobject Function_getTypeMap(Function self)
+bool Function_preload(Oid funcOid, bool trusted)
 {
-	return self->func.nonudt.typeMap;
+	HeapTuple procTup;
+	bool forTrigger;
+
+	if ( NULL != OidMap_get(s_funcMap, funcOid) )
+		return false;
+
+	procTup = PgObject_getValidTuple(PROCOID, funcOid, "function");
+	forTrigger =
+		TRIGGEROID == ((Form_pg_proc)GETSTRUCT(procTup))->prorettype;
+	ReleaseSysCache(procTup);
+
+	getFunction(funcOid, trusted, forTrigger, false, true);
+	return true;
 }
 
-static bool Function_inUse(Function func)
+#if PG_VERSION_NUM >= 120000
+/*
+ * The argument expressions of the call a support request is about: those of
+ * the FuncExpr or OpExpr, or NIL when there is no call node (as for a cost
+ * request made about the function in general).
+ */
+static List *supportArgs(Node *call)
 {
-	Invocation* ic = currentInvocation;
-	while(ic != 0)
-	{
-		if(ic->function == func)
-			return true;
-		ic = ic->previous;
-	}
-	return false;
+	if ( NULL == call )
+		return NIL;
+	if ( IsA(call, FuncExpr) )
+		return ((FuncExpr *)call)->args;
+	if ( IsA(call, OpExpr) )
+		return ((OpExpr *)call)->args;
+	return NIL;
 }
 
-void Function_clearFunctionCache(void)
+Node *Function_planSupport(Oid funcOid, bool trusted, Node *rawreq)
 {
-	Entry entry;
+	Function self;
+	Node *call;
+	Node *result = NULL;
+	List *args;
+	ListCell *lc;
+	jint kind;
+	jsize nargs;
+	jsize i = 0;
+	jobjectArray values;
+	jbooleanArray constant;
+	jboolean *isConst;
+	jobject answer;
+	jobject typeMap;
+	instr_time start;
+	bool timing;
+
+	self = getFunction(funcOid, trusted, false, false, true);
+	if ( self->isUDT  ||  NULL == self->func.nonudt.support )
+		return NULL;
+	typeMap = Function_getTypeMap(self);
+
+	switch ( nodeTag(rawreq) )
+	{
+	case T_SupportRequestRows:
+		kind = org_postgresql_pljava_internal_Function_SUPPORT_ROWS;
+		call = ((SupportRequestRows *)rawreq)->node;
+		break;
+	case T_SupportRequestCost:
+		kind = org_postgresql_pljava_internal_Function_SUPPORT_COST;
+		call = ((SupportRequestCost *)rawreq)->node;
+		break;
+	case T_SupportRequestSimplify:
+		kind = org_postgresql_pljava_internal_Function_SUPPORT_SIMPLIFY;
+		call = (Node *)((SupportRequestSimplify *)rawreq)->fcall;
+		break;
+	default:
+		return NULL;
+	}
+
+	args = supportArgs(call);
+	nargs = NULL == call ? self->func.nonudt.numParams : list_length(args);
 
-	HashMap oldMap = s_funcMap;
-	Iterator itor = Iterator_create(oldMap);
+	values = JNI_newObjectArray(nargs, s_Object_class, NULL);
+	constant = JNI_newBooleanArray(nargs);
+	isConst = palloc0(Max(1, nargs) * sizeof (jboolean));
 
-	s_funcMap = HashMap_create(59, TopMemoryContext);
-	while((entry = Iterator_next(itor)) != 0)
+	foreach ( lc, args )
 	{
-		Function func = (Function)Entry_getValue(entry);
-		if(func != 0)
+		Node *arg = (Node *)lfirst(lc);
+		if ( IsA(arg, Const) )
 		{
-			if(Function_inUse(func))
-			{
-				/* This is the replace_jar function or similar. Just
-				 * move it to the new map.
-				 */
-				HashMap_put(s_funcMap, Entry_getKey(entry), func);
-			}
-			else
+			Const *c = (Const *)arg;
+			isConst[i] = JNI_TRUE;
+			if ( ! c->constisnull )
 			{
-				Entry_setValue(entry, 0);
-				PgObject_free((PgObject)func);
+				Type t = Type_objectTypeFromOid(c->consttype, typeMap);
+				jobject v = Type_coerceDatum(t, c->constvalue).l;
+				JNI_setObjectArrayElement(values, i, v);
+				JNI_deleteLocalRef(v);
 			}
 		}
+		++ i;
 	}
-	PgObject_free((PgObject)itor);
-	PgObject_free((PgObject)oldMap);
-}
+	JNI_setBooleanArrayRegion(constant, 0, nargs, isConst);
+	pfree(isConst);
+
+	timing = beginJava(&start);
+	answer = JNI_callStaticObjectMethod(s_EntryPoints_class,
+		s_EntryPoints_planSupportInvoke, self->func.nonudt.support, kind,
+		values, constant);
+	endJava(timing, &start);
+	JNI_deleteLocalRef(values);
+	JNI_deleteLocalRef(constant);
+
+	if ( NULL == answer )
+		return NULL;
 
-/*
- * Type_isPrimitive() by itself returns true for both, say, int and int[].
- * That is sometimes relied on, as in the code that would accept Integer[]
- * as a replacement for int[].
+	if ( org_postgresql_pljava_internal_Function_SUPPORT_SIMPLIFY == kind )
+	{
+		FuncExpr *fcall = ((SupportRequestSimplify *)rawreq)->fcall;
+		Oid rettype = fcall->funcresulttype;
+		jobject v = JNI_getObjectArrayElement(answer, 0);
+		MemoryContext currCtx = Invocation_switchToUpperContext();
+
+		if ( NULL == v )
+			result = (Node *)makeNullConst(rettype, -1, fcall->funccollid);
+		else
+		{
+			int16 typlen;
+			bool typbyval;
+			Datum d = Type_coerceObject(Type_fromOid(rettype, typeMap), v);
+			get_typlenbyval(rettype, &typlen, &typbyval);
+			result = (Node *)makeConst(rettype, -1, fcall->funccollid,
+				typlen, d, false, typbyval);
+			JNI_deleteLocalRef(v);
+		}
+		MemoryContextSwitchTo(currCtx);
+	}
+	else
+	{
+		double d = DatumGetFloat8(
+			Type_coerceObject(Type_fromOid(FLOAT8OID, NULL), answer));
+		if ( org_postgresql_pljava_internal_Function_SUPPORT_ROWS == kind )
+			((SupportRequestRows *)rawreq)->rows = d;
+		else
+		{
+			((SupportRequestCost *)rawreq)->startup = 0;
+			((SupportRequestCost *)rawreq)->per_tuple = d * cpu_operator_cost;
+		}
+		result = rawreq;
+	}
+
+	JNI_deleteLocalRef(answer);
+	return result;
+}
+#endif
+
+jobject Function_getTypeMap(Function self)
+{
+	return self->func.nonudt.typeMap;
+}
+
+static bool Function_inUse(Function func)
+{
+	Invocation* ic = currentInvocation;
+	while(ic != 0)
+	{
+		if(ic->function == func)
+			return true;
+		ic = ic->previous;
+	}
+	return false;
+}
+
+/*
+ * Retire the cached Functions that use the given schema loader (all of them, if
+ * loader is NULL), except any in use by a current invocation, which are kept.
+ */
+static void clearFunctions(jobject loader)
+{
+	uint32 cursor = 0;
+	Oid funcOid;
+	void *value;
+
+	OidMap oldMap = s_funcMap;
+
+	s_funcMap = OidMap_create(59, TopMemoryContext);
+	while ( OidMap_next(oldMap, &cursor, &funcOid, &value) )
+	{
+		Function func = (Function)value;
+		if(Function_inUse(func)  ||  ( NULL != loader
+			&&  NULL != func->schemaLoader
+			&&  ! JNI_isSameObject(func->schemaLoader, loader) ))
+		{
+			/* This is the replace_jar function or similar, or one that
+			 * does not use the loader being cleared. Just move it to the
+			 * new map.
+			 */
+			OidMap_put(s_funcMap, funcOid, func);
+		}
+		else
+			retireFunction(func);
+	}
+	OidMap_free(oldMap);
+}
+
+void Function_clearFunctionCache(void)
+{
+	clearFunctions(NULL);
+}
+
+void Function_clearFunctionCacheForLoader(jobject loader)
+{
+	if ( NULL != loader )
+		clearFunctions(loader);
+}
+
+/*
+ * Type_isPrimitive() by itself returns true for both, say, int and int[].
+ * That is sometimes relied on, as in the code that would accept Integer[]
+ * as a replacement for int[].
  *
  * However, it isn't correct for determining whether the thing should be passed
  * to Java as a primitive or a reference, because of course no Java array is a
@@ -901,6 +1686,416 @@ passAsPrimitive(Type t)
 	return Type_isPrimitive(t) && (NULL == Type_getElementType(t));
 }
 
+/*
+ * Build the argument plan for a non-UDT function. Called when Function.create
+ * has returned, so any adjustments by _reconcileTypes have been made.
+ */
+static void compileArgPlan(Function self)
+{
+	uint16 idx;
+	uint16 refIdx = 0;
+	uint16 primIdx = 0;
+	uint16 numParams = self->func.nonudt.numParams;
+	ArgStep* plan;
+
+	self->func.nonudt.hasDynamicTypes =
+		Type_isDynamic(self->func.nonudt.returnType);
+	self->func.nonudt.hasDecodeOnce = false;
+
+	if ( 0 == numParams )
+		return;
+
+	plan = (ArgStep *)MemoryContextAlloc(
+		GetMemoryChunkContext(self), numParams * sizeof (ArgStep));
+
+	for ( idx = 0 ; idx < numParams ; ++ idx )
+	{
+		Type t = self->func.nonudt.paramTypes[idx];
+		plan[idx].type = t;
+		plan[idx].coerce = Type_isDynamic(t) ? NULL : Type_getDatumCoercer(t);
+		plan[idx].primitive = passAsPrimitive(t);
+		plan[idx].slot = plan[idx].primitive ? primIdx++ : refIdx++;
+		plan[idx].decodeOnce = UDT_isDecodeCached(t);
+		if ( NULL == plan[idx].coerce )
+			self->func.nonudt.hasDynamicTypes = true;
+		if ( plan[idx].decodeOnce )
+			self->func.nonudt.hasDecodeOnce = true;
+	}
+
+	self->func.nonudt.argPlan = plan;
+}
+
+/*
+ * Return the PolyCache for this call site, building it on first use.
+ * Not for a multi-call function, whose fn_extra belongs to funcapi (and
+ * which resolves its types only on the first call in any case).
+ */
+static PolyCache* getPolyCache(Function self, PG_FUNCTION_ARGS)
+{
+	FmgrInfo* flinfo = fcinfo->flinfo;
+	PolyCache* cache = (PolyCache*)flinfo->fn_extra;
+	uint16 numParams = self->func.nonudt.numParams;
+	ArgStep* plan = self->func.nonudt.argPlan;
+	jobject typeMap = self->func.nonudt.typeMap;
+	Type rt = self->func.nonudt.returnType;
+	void* resultState = NULL;
+	UDTDecodeCache udtCache = NULL;
+	uint16 idx;
+	Oid actual;
+
+	if ( NULL != cache  &&  self->serial == cache->serial )
+		return cache;
+
+	if ( NULL != cache )
+	{
+		resultState = cache->resultState;
+		udtCache = cache->udtCache;
+		pfree(cache);
+	}
+
+	cache = (PolyCache*)MemoryContextAlloc(flinfo->fn_mcxt,
+		offsetof(PolyCache, paramTypes) + numParams * sizeof (Type));
+	cache->serial = self->serial;
+	cache->resultState = resultState;
+	cache->udtCache = udtCache;
+
+	cache->returnType = NULL;
+	if ( ! Type_isDynamic(rt) )
+		cache->returnType = rt;
+	else if ( InvalidOid != (actual = get_fn_expr_rettype(flinfo)) )
+		cache->returnType = Type_getRealType(rt, actual, typeMap);
+
+	for ( idx = 0 ; idx < numParams ; ++ idx )
+	{
+		cache->paramTypes[idx] = NULL;
+		if ( NULL != plan[idx].coerce )
+			continue;
+		actual = get_fn_expr_argtype(flinfo, idx);
+		if ( InvalidOid != actual )
+			cache->paramTypes[idx] =
+				Type_getRealType(plan[idx].type, actual, typeMap);
+	}
+
+	flinfo->fn_extra = cache;
+	return cache;
+}
+
+void **pljava_Function_callSiteState(Function self, PG_FUNCTION_ARGS)
+{
+	if ( self->isUDT  ||  self->func.nonudt.isMultiCall
+		||  NULL == fcinfo->flinfo )
+		return NULL;
+	return &getPolyCache(self, fcinfo)->resultState;
+}
+
+Type pljava_Function_paramType(Function self, uint16 idx)
+{
+	if ( self->isUDT  ||  idx >= self->func.nonudt.numParams )
+		return NULL;
+	return self->func.nonudt.paramTypes[idx];
+}
+
+static inline int64 elapsedNanos(instr_time *start, instr_time *end)
+{
+	instr_time t = *end;
+	INSTR_TIME_SUBTRACT(t, *start);
+#if PG_VERSION_NUM >= 160000
+	return (int64)INSTR_TIME_GET_NANOSEC(t);
+#else
+	return (int64)(INSTR_TIME_GET_DOUBLE(t) * 1e9);
+#endif
+}
+
+static inline int64 totalNanos(instr_time t)
+{
+	instr_time zero;
+	INSTR_TIME_SET_ZERO(zero);
+	return elapsedNanos(&zero, &t);
+}
+
+/*
+ * Return the pljava.track_functions slot for a function, or NULL if there is
+ * no room to track it, allocating the slot array (and handing it to Java) at
+ * the first use. A new Function for an already-tracked funcoid (after its
+ * pg_proc entry changed, say) finds the same slot again.
+ */
+static int64 *statsSlot(Function self, Oid funcoid)
+{
+	int64 used;
+	int32 i;
+
+	if ( NULL == s_funcStats )
+	{
+		Size size =
+			(1 + STATS_CAPACITY) * STATS_SLOT_LONGS * sizeof *s_funcStats;
+		jobject buffer;
+		s_funcStats = MemoryContextAllocZero(TopMemoryContext, size);
+		buffer = JNI_newDirectByteBuffer(s_funcStats, (jlong)size);
+		JNI_callStaticVoidMethod(
+			s_FunctionStats_class, s_FunctionStats_publish, buffer);
+		JNI_deleteLocalRef(buffer);
+	}
+
+	if ( 0 == self->statsSlot )
+	{
+		used = s_funcStats[STATS_USED];
+		self->statsSlot = -1;
+		for ( i = 1; i <= used; ++ i )
+		{
+			if ( (int64)funcoid
+				== s_funcStats[i * STATS_SLOT_LONGS + STATS_OID] )
+			{
+				self->statsSlot = i;
+				break;
+			}
+		}
+		if ( -1 == self->statsSlot  &&  used < STATS_CAPACITY )
+		{
+			self->statsSlot = (int32)(++ used);
+			s_funcStats[used * STATS_SLOT_LONGS + STATS_OID] = (int64)funcoid;
+			s_funcStats[STATS_USED] = used;
+		}
+	}
+
+	if ( -1 == self->statsSlot )
+		return NULL;
+	return s_funcStats + self->statsSlot * STATS_SLOT_LONGS;
+}
+
+/*
+ * Make the MemoCache for a function at its first call, or return NULL (and
+ * stop asking) if its types are dynamic, as the same argument bytes could then
+ * mean different values at different call sites.
+ */
+static MemoCache *memoCreate(Function self)
+{
+	int32 capacity = self->func.nonudt.memoSize;
+	uint32 nbuckets = 1;
+	MemoryContext cxt;
+	MemoryContext oldcxt;
+	MemoCache *memo;
+	Type rt = self->func.nonudt.returnType;
+
+	if ( self->func.nonudt.hasDynamicTypes )
+	{
+		self->func.nonudt.memoSize = 0;
+		ereport(WARNING, (
+			errmsg("PL/Java function with polymorphic types "
+				"will not be memoized")));
+		return NULL;
+	}
+
+	while ( nbuckets < (uint32)capacity )
+		nbuckets <<= 1;
+
+	cxt = AllocSetContextCreate(TopMemoryContext, "PL/Java memoize",
+		ALLOCSET_DEFAULT_SIZES);
+	oldcxt = MemoryContextSwitchTo(cxt);
+
+	memo = palloc0(offsetof(MemoCache, entries)
+		+ capacity * sizeof (MemoEntry));
+	memo->cxt = cxt;
+	memo->capacity = capacity;
+	memo->bucketMask = nbuckets - 1;
+	memo->buckets = palloc(nbuckets * sizeof *memo->buckets);
+	memset(memo->buckets, -1, nbuckets * sizeof *memo->buckets);
+	memo->head = memo->tail = -1;
+	memo->retLen = Type_getLength(rt);
+	memo->retByVal = Type_isByValue(rt);
+	initStringInfo(&memo->scratch);
+
+	MemoryContextSwitchTo(oldcxt);
+	self->func.nonudt.memo = memo;
+	return memo;
+}
+
+/*
+ * Lay out the arguments of this call as a key in memo->scratch.
+ */
+static void memoKey(Function self, MemoCache *memo, PG_FUNCTION_ARGS)
+{
+	StringInfo key = &memo->scratch;
+	ArgStep* step = self->func.nonudt.argPlan;
+	int idx;
+
+	resetStringInfo(key);
+	for ( idx = 0 ; idx < PG_NARGS() ; ++ idx, ++ step )
+	{
+		Datum d;
+		int16 len;
+		char isnull = PG_ARGISNULL(idx);
+
+		appendBinaryStringInfo(key, &isnull, 1);
+		if ( isnull )
+			continue;
+
+		d = PG_GETARG_DATUM(idx);
+		len = Type_getLength(step->type);
+		if ( Type_isByValue(step->type) )
+			appendBinaryStringInfo(key, (char *)&d, SIZEOF_DATUM);
+		else if ( 0 < len )
+			appendBinaryStringInfo(key, DatumGetPointer(d), len);
+		else if ( -1 == len )
+		{
+			struct varlena *v = PG_DETOAST_DATUM_PACKED(d);
+			int32 vlen = VARSIZE_ANY_EXHDR(v);
+			appendBinaryStringInfo(key, (char *)&vlen, sizeof vlen);
+			appendBinaryStringInfo(key, VARDATA_ANY(v), vlen);
+		}
+		else
+			appendBinaryStringInfo(key, DatumGetCString(d),
+				1 + strlen(DatumGetCString(d)));
+	}
+}
+
+static void memoUnlink(MemoCache *memo, int32 e)
+{
+	MemoEntry *ent = memo->entries + e;
+	if ( -1 == ent->prev )
+		memo->head = ent->next;
+	else
+		memo->entries[ent->prev].next = ent->next;
+	if ( -1 == ent->next )
+		memo->tail = ent->prev;
+	else
+		memo->entries[ent->next].prev = ent->prev;
+}
+
+static void memoPushFront(MemoCache *memo, int32 e)
+{
+	MemoEntry *ent = memo->entries + e;
+	ent->prev = -1;
+	ent->next = memo->head;
+	if ( -1 == memo->head )
+		memo->tail = e;
+	else
+		memo->entries[memo->head].prev = e;
+	memo->head = e;
+}
+
+/*
+ * Return the index of the entry for a key, made most recently used, or -1.
+ */
+static int32 memoFind(MemoCache *memo, const char *key, int32 len, uint32 hash)
+{
+	int32 e = memo->buckets[hash & memo->bucketMask];
+
+	for ( ; -1 != e ; e = memo->entries[e].chain )
+	{
+		MemoEntry *ent = memo->entries + e;
+		if ( ent->hash == hash  &&  ent->keyLen == len
+			&&  0 == memcmp(ent->key, key, len) )
+		{
+			if ( memo->head != e )
+			{
+				memoUnlink(memo, e);
+				memoPushFront(memo, e);
+			}
+			return e;
+		}
+	}
+	return -1;
+}
+
+/*
+ * Enter a result for a key, evicting the least recently used entry if full.
+ */
+static void memoStore(MemoCache *memo, const char *key, int32 len,
+	uint32 hash, Datum result, bool isnull)
+{
+	int32 e;
+	int32 *link;
+	MemoEntry *ent;
+
+	if ( memo->count < memo->capacity )
+		e = memo->count ++;
+	else
+	{
+		e = memo->tail;
+		ent = memo->entries + e;
+		memoUnlink(memo, e);
+		for ( link = memo->buckets + (ent->hash & memo->bucketMask) ;
+			  e != *link ; link = &memo->entries[*link].chain )
+			;
+		*link = ent->chain;
+		pfree(ent->key);
+		if ( ! ent->isnull  &&  ! memo->retByVal )
+			pfree(DatumGetPointer(ent->result));
+	}
+
+	ent = memo->entries + e;
+	ent->hash = hash;
+	ent->keyLen = len;
+	ent->key = MemoryContextAlloc(memo->cxt, len);
+	memcpy(ent->key, key, len);
+	ent->isnull = isnull;
+	if ( isnull )
+		ent->result = (Datum)0;
+	else
+	{
+		MemoryContext oldcxt = MemoryContextSwitchTo(memo->cxt);
+		ent->result = datumCopy(result, memo->retByVal, memo->retLen);
+		MemoryContextSwitchTo(oldcxt);
+	}
+	link = memo->buckets + (hash & memo->bucketMask);
+	ent->chain = *link;
+	*link = e;
+	memoPushFront(memo, e);
+}
+
+/*
+ * Invoke a function declared with [memoize=n], answering from its MemoCache
+ * when the arguments have been seen, and setting *memoHit (if not NULL) then.
+ * On a miss, the key is copied out of the scratch buffer before the call, as
+ * the call may itself reach this function again.
+ */
+static Datum invokeMemoized(
+	Function self, int64 *argNanos, bool *memoHit, PG_FUNCTION_ARGS)
+{
+	MemoCache *memo = self->func.nonudt.memo;
+	char *key;
+	int32 len;
+	uint32 hash;
+	int32 e;
+	Datum result;
+
+	if ( NULL == memo  &&  NULL == (memo = memoCreate(self)) )
+		return invoke(self, false, argNanos, fcinfo);
+
+	memoKey(self, memo, fcinfo);
+	len = memo->scratch.len;
+	hash = DatumGetUInt32(
+		hash_any((unsigned char *)memo->scratch.data, len));
+
+	e = memoFind(memo, memo->scratch.data, len, hash);
+	if ( -1 != e )
+	{
+		if ( NULL != memoHit )
+			*memoHit = true;
+		fcinfo->isnull = memo->entries[e].isnull;
+		if ( fcinfo->isnull )
+			return (Datum)0;
+		return datumCopy(
+			memo->entries[e].result, memo->retByVal, memo->retLen);
+	}
+
+	key = palloc(len);
+	memcpy(key, memo->scratch.data, len);
+	result = invoke(self, false, argNanos, fcinfo);
+	memoStore(memo, key, len, hash, result, fcinfo->isnull);
+	pfree(key);
+	return result;
+}
+
+static inline Datum invokeMaybeMemoized(
+	Function self, bool forTrigger, int64 *argNanos, bool *memoHit,
+	PG_FUNCTION_ARGS)
+{
+	if ( forTrigger  ||  self->isUDT  ||  0 == self->func.nonudt.memoSize )
+		return invoke(self, forTrigger, argNanos, fcinfo);
+	return invokeMemoized(self, argNanos, memoHit, fcinfo);
+}
+
 Datum
 Function_invoke(
 	Oid funcoid, bool trusted, bool forTrigger, bool forValidator,
@@ -908,15 +2103,77 @@ Function_invoke(
 {
 	Function self;
 	Datum retVal;
-	Size passedArgCount;
-	Type invokerType;
-	bool skipParameterConversion = false;
+	instr_time start;
+	instr_time end;
+	int64 argNanos = 0;
+	int64 javaNanos;
+	int64 elapsed;
+	int64 *slot;
+	bool memoHit = false;
 
 	self = getFunction(funcoid, trusted, forTrigger, forValidator, checkBody);
 
 	if ( forValidator )
 		PG_RETURN_VOID();
 
+	if ( ! self->isUDT  &&  self->func.nonudt.isSortSupport )
+	{
+		pljava_SortSupport_prepare((SortSupport)PG_GETARG_POINTER(0),
+			self->func.nonudt.support, pljava_SortSupport_typeFor(funcoid),
+			self->func.nonudt.typeMap);
+		PG_RETURN_VOID();
+	}
+
+	if ( ! Backend_isTrackFunctions() )
+		return invokeMaybeMemoized(self, forTrigger, NULL, NULL, fcinfo);
+
+	/*
+	 * Time the call. Whatever is not spent in Java or converting arguments is
+	 * counted as converting the result; that also takes in the small, fixed
+	 * costs of the call itself.
+	 */
+	INSTR_TIME_SET_ZERO(currentInvocation->javaTime);
+	currentInvocation->timed = true;
+	INSTR_TIME_SET_CURRENT(start);
+	retVal = invokeMaybeMemoized(
+		self, forTrigger, &argNanos, &memoHit, fcinfo);
+	INSTR_TIME_SET_CURRENT(end);
+	currentInvocation->timed = false;
+
+	elapsed = elapsedNanos(&start, &end);
+	javaNanos = totalNanos(currentInvocation->javaTime);
+
+	slot = statsSlot(self, funcoid);
+	if ( NULL == slot )
+	{
+		++ s_funcStats[STATS_UNTRACKED];
+		return retVal;
+	}
+	++ slot[STATS_CALLS];
+	if ( memoHit )
+		++ slot[STATS_MEMO_HITS];
+	slot[STATS_TOTAL] += elapsed;
+	if ( elapsed > slot[STATS_MAX] )
+		slot[STATS_MAX] = elapsed;
+	slot[STATS_JAVA] += javaNanos;
+	slot[STATS_ARGS] += argNanos;
+	slot[STATS_RETURN] += Max(0, elapsed - javaNanos - argNanos);
+	return retVal;
+}
+
+/*
+ * The work of Function_invoke, once the Function is found. If argNanos is not
+ * NULL, the call is being timed, and the time spent converting arguments (less
+ * any of it in Java) is stored there.
+ */
+static Datum invoke(
+	Function self, bool forTrigger, int64 *argNanos, PG_FUNCTION_ARGS)
+{
+	Datum retVal;
+	Size passedArgCount;
+	Type invokerType;
+	bool skipParameterConversion = false;
+
 	if ( forTrigger )
 		return invokeTrigger(self, fcinfo);
 
@@ -968,43 +2225,71 @@ Function_invoke(
 	if ( passedArgCount > 0  &&  ! skipParameterConversion )
 	{
 		int32 idx;
-		int32 refIdx = 0;
-		int32 primIdx = 0;
-		Type* types = self->func.nonudt.paramTypes;
+		ArgStep* step = self->func.nonudt.argPlan;
+		PolyCache* poly = NULL;
 		jvalue coerced;
+		instr_time argStart;
+		instr_time argEnd;
+		int64 javaBefore = 0;
+
+		if ( NULL != argNanos )
+		{
+			javaBefore = totalNanos(currentInvocation->javaTime);
+			INSTR_TIME_SET_CURRENT(argStart);
+		}
+
+		if ( ( self->func.nonudt.hasDynamicTypes
+				||  self->func.nonudt.hasDecodeOnce )
+			&&  ! self->func.nonudt.isMultiCall )
+			poly = getPolyCache(self, fcinfo);
 
-		if(Type_isDynamic(invokerType))
+		if ( NULL != poly  &&  NULL != poly->returnType )
+			invokerType = poly->returnType;
+		else if(Type_isDynamic(invokerType))
 			invokerType = Type_getRealType(invokerType,
 				get_fn_expr_rettype(fcinfo->flinfo), self->func.nonudt.typeMap);
 
-		for(idx = 0; idx < passedArgCount; ++idx)
+		for(idx = 0; idx < passedArgCount; ++idx, ++step)
 		{
-			Type paramType = types[idx];
-			bool passPrimitive = passAsPrimitive(paramType);
-
 			if(PG_ARGISNULL(idx))
 			{
 				/*
-				 * Set this argument to zero (or null in case of object)
+				 * Set this argument to zero (or null in case of object;
+				 * the array element is already initially null)
 				 */
-				if ( passPrimitive )
-					s_primitiveParameters[primIdx++].j = 0L;
-				else
-					++ refIdx; /* array element is already initially null */
+				if ( step->primitive )
+					s_primitiveParameters[step->slot].j = 0L;
+				continue;
 			}
+
+			if ( step->decodeOnce  &&  NULL != poly )
+				coerced = UDT_coerceDatumCached(step->type,
+					PG_GETARG_DATUM(idx), &poly->udtCache,
+					fcinfo->flinfo->fn_mcxt);
+			else if ( NULL != step->coerce )
+				coerced = step->coerce(step->type, PG_GETARG_DATUM(idx));
 			else
 			{
-				if(Type_isDynamic(paramType))
-					paramType = Type_getRealType(paramType,
+				Type realType = (NULL == poly) ? NULL : poly->paramTypes[idx];
+				if ( NULL == realType )
+					realType = Type_getRealType(step->type,
 						get_fn_expr_argtype(fcinfo->flinfo, idx),
 						self->func.nonudt.typeMap);
-				coerced = Type_coerceDatum(paramType, PG_GETARG_DATUM(idx));
-				if ( passPrimitive )
-					s_primitiveParameters[primIdx++] = coerced;
-				else
-					JNI_setObjectArrayElement(
-						s_referenceParameters, refIdx++, coerced.l);
+				coerced = Type_coerceDatum(realType, PG_GETARG_DATUM(idx));
 			}
+
+			if ( step->primitive )
+				s_primitiveParameters[step->slot] = coerced;
+			else
+				JNI_setObjectArrayElement(
+					s_referenceParameters, step->slot, coerced.l);
+		}
+
+		if ( NULL != argNanos )
+		{
+			INSTR_TIME_SET_CURRENT(argEnd);
+			*argNanos = elapsedNanos(&argStart, &argEnd)
+				- (totalNanos(currentInvocation->javaTime) - javaBefore);
 		}
 	}
 
@@ -1067,7 +2352,7 @@ invokeTrigger(Function self, PG_FUNCTION_ARGS)
 		currCtx = Invocation_switchToUpperContext();
 		ret = PointerGetDatum(
 				pljava_TriggerData_getTriggerReturnTuple(
-					jtd, &fcinfo->isnull));
+					jtd, td, &fcinfo->isnull));
 
 		/* Triggers are not allowed to set the fcinfo->isnull, even when
 		 * they return null.
@@ -1123,6 +2408,86 @@ jobject Function_currentLoader(void)
 	return f->schemaLoader;
 }
 
+/*
+ * Class:     org_postgresql_pljava_internal_Function
+ * Method:    _setMemoize
+ * Signature: (JI)V
+ */
+JNIEXPORT void JNICALL
+	Java_org_postgresql_pljava_internal_Function__1setMemoize(
+	JNIEnv *env, jclass jFunctionClass, jlong wrappedPtr, jint size)
+{
+	Ptr2Long p2l;
+	Function self;
+
+	p2l.longVal = wrappedPtr;
+	self = (Function)p2l.ptrVal;
+
+	/*
+	 * Only the size is stored; the cache is made at the first call, so nothing
+	 * is left to free if this Function is only being validated.
+	 */
+	self->func.nonudt.memoSize = size;
+}
+
+/*
+ * Class:     org_postgresql_pljava_internal_Function
+ * Method:    _setSupport
+ * Signature: (JLorg/postgresql/pljava/internal/EntryPoints$Invocable;)V
+ */
+JNIEXPORT void JNICALL
+	Java_org_postgresql_pljava_internal_Function__1setSupport(
+	JNIEnv *env, jclass jFunctionClass, jlong wrappedPtr, jobject support)
+{
+	Ptr2Long p2l;
+	Function self;
+
+	p2l.longVal = wrappedPtr;
+	self = (Function)p2l.ptrVal;
+
+	BEGIN_NATIVE_NO_ERRCHECK
+	self->func.nonudt.support = JNI_newGlobalRef(support);
+	END_NATIVE
+}
+
+/*
+ * Class:     org_postgresql_pljava_internal_Function
+ * Method:    _storeToSortSupport
+ * Signature: (JLjava/lang/ClassLoader;Ljava/lang/Class;Ljava/util/Map;Lorg/postgresql/pljava/internal/EntryPoints$Invocable;)V
+ */
+JNIEXPORT void JNICALL
+	Java_org_postgresql_pljava_internal_Function__1storeToSortSupport(
+	JNIEnv *env, jclass jFunctionClass, jlong wrappedPtr, jobject schemaLoader,
+	jclass clazz, jobject typeMap, jobject support)
+{
+	Ptr2Long p2l;
+	Function self;
+
+	p2l.longVal = wrappedPtr;
+	self = (Function)p2l.ptrVal;
+
+	BEGIN_NATIVE_NO_ERRCHECK
+	PG_TRY();
+	{
+		self->isUDT = false;
+		self->readOnly = true;
+		self->schemaLoader = JNI_newGlobalRef(schemaLoader);
+		self->clazz = JNI_newGlobalRef(clazz);
+		self->func.nonudt.typeMap =
+			(NULL == typeMap) ? NULL : JNI_newGlobalRef(typeMap);
+		self->func.nonudt.support = JNI_newGlobalRef(support);
+		self->func.nonudt.isSortSupport = true;
+		self->func.nonudt.numParams = 0;
+		self->func.nonudt.returnType = Type_fromOid(VOIDOID, NULL);
+	}
+	PG_CATCH();
+	{
+		Exception_throw_ERROR(PG_FUNCNAME_MACRO);
+	}
+	PG_END_TRY();
+	END_NATIVE
+}
+
 /*
  * Class:     org_postgresql_pljava_internal_Function_EarlyNatives
  * Method:    _parameterArea
@@ -1177,6 +2542,7 @@ JNIEXPORT jboolean JNICALL
 		self->func.nonudt.isMultiCall = (JNI_TRUE == isMultiCall);
 		self->func.nonudt.typeMap =
 			(NULL == typeMap) ? NULL : JNI_newGlobalRef(typeMap);
+		self->func.nonudt.numParams = (uint16)numParams;
 
 		if ( NULL != returnJType )
 		{
@@ -1309,6 +2675,8 @@ JNIEXPORT void JNICALL
 			case 'o': self->func.udt.udtFunction = UDT_output; break;
 			case 'r': self->func.udt.udtFunction = UDT_receive; break;
 			case 's': self->func.udt.udtFunction = UDT_send; break;
+			case 'e': self->func.udt.udtFunction = UDT_binaryEquals; break;
+			case 'h': self->func.udt.udtFunction = UDT_binaryHash; break;
 			default:
 				elog(ERROR,
 					"PL/Java jar/native code mismatch: unexpected UDT func ID");
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015-2021 Tada AB and other contributors, as listed below.
+ * Copyright (c) 2015-2026 Tada AB and other contributors, as listed below.
  *
  * All rights reserved. This program and the accompanying materials
  * are made available under the terms of the The BSD 3-Clause License
@@ -34,6 +34,11 @@
 #include <utils/snapmgr.h>
 #endif
 #include <utils/syscache.h>
+#if PG_VERSION_NUM >= 170000
+#include <storage/dsm_registry.h>
+#include <storage/spin.h>
+#define GROUNDWORK_MARKERS
+#endif
 
 #if PG_VERSION_NUM >= 120000
 #include <catalog/pg_namespace.h>
@@ -116,6 +121,48 @@ static void checkLoadPath( bool *livecheck);
 static void getExtensionLoadPath(void);
 static char *origUserName();
 
+#ifdef GROUNDWORK_MARKERS
+/*
+ * Markers, shared by all backends through a named DSM segment, of the
+ * databases where the groundwork has been done, and committed, by this version
+ * of PL/Java (which is part of the segment name) from a given load path. A LOAD
+ * of PL/Java in another session can then skip the groundwork (CREATE or ALTER
+ * EXTENSION never does). A marker also records the Oids of the sqlj schema and
+ * of the call handlers of the java and javaU languages as they were; if any of
+ * those has since been dropped or made anew, the marker is not believed.
+ *
+ * Before PostgreSQL 17 there is no way to get shared memory without being in
+ * shared_preload_libraries, where PL/Java cannot be, so there the groundwork
+ * is always done.
+ */
+#define GROUNDWORK_MARKER_SLOTS 32
+
+typedef struct
+{
+	Oid dbid;
+	Oid sqljOid;
+	Oid handlerOid;
+	Oid uHandlerOid;
+	char loadPath[MAXPGPATH];
+} GroundworkMarker;
+
+typedef struct
+{
+	slock_t mutex;
+	int next;
+	GroundworkMarker markers[GROUNDWORK_MARKER_SLOTS];
+} GroundworkMarkers;
+
+static GroundworkMarkers *s_markers;
+static GroundworkMarker s_pendingMarker;
+static bool s_markerPending = false;
+
+static bool currentMarker(GroundworkMarker *m);
+static bool groundworkIsMarked(void);
+static void markGroundwork(void);
+static void groundworkXactCB(XactEvent event, void *arg);
+#endif
+
 char const *pljavaLoadPath = NULL;
 
 bool pljavaLoadingAsExtension = false;
@@ -450,6 +497,49 @@ bool InstallHelper_shouldDeferInit()
 	return true;
 }
 
+void InstallHelper_assumeLoadPathOf(char const *langName)
+{
+	bool isnull;
+	HeapTuple langTup;
+	HeapTuple procTup;
+	Oid handlerOid;
+	Datum probinattr;
+	char *probinstring;
+
+	if ( NULL != pljavaLoadPath )
+		return;
+
+	langTup = SearchSysCache1(LANGNAME, CStringGetDatum(langName));
+	if ( ! HeapTupleIsValid(langTup) )
+		return;
+	handlerOid = ((Form_pg_language) GETSTRUCT(langTup))->lanplcallfoid;
+	ReleaseSysCache(langTup);
+	if ( InvalidOid == handlerOid )
+		return;
+
+	procTup = SearchSysCache1(PROCOID, ObjectIdGetDatum(handlerOid));
+	if ( ! HeapTupleIsValid(procTup) )
+		return;
+	if ( ClanguageId != ((Form_pg_proc) GETSTRUCT(procTup))->prolang )
+	{
+		ReleaseSysCache(procTup);
+		return;
+	}
+	probinattr =
+		SysCacheGetAttr(PROCOID, procTup, Anum_pg_proc_probin, &isnull);
+	if ( isnull )
+	{
+		ReleaseSysCache(procTup);
+		return;
+	}
+	probinstring = DatumGetCString(DirectFunctionCall1(textout, probinattr));
+	ReleaseSysCache(procTup);
+
+	pljavaLoadPath =
+		(char const *)MemoryContextStrdup(TopMemoryContext, probinstring);
+	pfree(probinstring);
+}
+
 bool InstallHelper_isPLJavaFunction(Oid fn, char **langName, bool *trusted)
 {
 	char *itsPath;
@@ -612,6 +702,13 @@ void InstallHelper_groundwork()
 {
 	Invocation ctx;
 	bool snapshot_set = false;
+#ifdef GROUNDWORK_MARKERS
+	if ( ! pljavaLoadingAsExtension  &&  groundworkIsMarked() )
+	{
+		elog(DEBUG1, "PL/Java groundwork already done in this database");
+		return;
+	}
+#endif
 	Invocation_pushInvocation(&ctx);
 	ctx.function = Function_INIT_WRITER;
 #if PG_VERSION_NUM >= 80400
@@ -642,6 +739,9 @@ void InstallHelper_groundwork()
 		JNI_deleteLocalRef(pljlp);
 		JNI_deleteLocalRef(jlpt);
 		JNI_deleteLocalRef(jlptq);
+#ifdef GROUNDWORK_MARKERS
+		markGroundwork();
+#endif
 		if ( snapshot_set )
 		{
 #if PG_VERSION_NUM >= 80400
@@ -683,4 +783,130 @@ void InstallHelper_initialize()
 	s_InstallHelper_groundwork = PgObject_getStaticJavaMethod(
 		s_InstallHelper_class, "groundwork",
 		"(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;ZZ)V");
+#ifdef GROUNDWORK_MARKERS
+	RegisterXactCallback(groundworkXactCB, NULL);
+#endif
+}
+
+#ifdef GROUNDWORK_MARKERS
+static void initMarkers(void *ptr)
+{
+	GroundworkMarkers *ms = (GroundworkMarkers *)ptr;
+
+	memset(ms, 0, sizeof *ms);
+	SpinLockInit(&ms->mutex);
+}
+
+static Oid languageHandler(char const *langName)
+{
+	HeapTuple langTup;
+	Oid handlerOid;
+
+	langTup = SearchSysCache1(LANGNAME, CStringGetDatum(langName));
+	if ( ! HeapTupleIsValid(langTup) )
+		return InvalidOid;
+	handlerOid = ((Form_pg_language) GETSTRUCT(langTup))->lanplcallfoid;
+	ReleaseSysCache(langTup);
+	return handlerOid;
 }
+
+/*
+ * Fill in a marker for the current state of this database, returning false if
+ * it is not a state worth marking, lacking the schema or either language.
+ */
+static bool currentMarker(GroundworkMarker *m)
+{
+	if ( NULL == pljavaLoadPath  ||  MAXPGPATH <= strlen(pljavaLoadPath) )
+		return false;
+	m->dbid = MyDatabaseId;
+	m->sqljOid = GetNamespaceOid(CStringGetDatum("sqlj"));
+	m->handlerOid = languageHandler("java");
+	m->uHandlerOid = languageHandler("javau");
+	if ( InvalidOid == m->sqljOid  ||  InvalidOid == m->handlerOid
+		||  InvalidOid == m->uHandlerOid )
+		return false;
+	strlcpy(m->loadPath, pljavaLoadPath, sizeof m->loadPath);
+	return true;
+}
+
+static bool groundworkIsMarked(void)
+{
+	GroundworkMarker cur;
+	GroundworkMarker *m;
+	bool found;
+	bool result = false;
+
+	if ( ! currentMarker(&cur) )
+		return false;
+	if ( NULL == s_markers )
+		s_markers = GetNamedDSMSegment(
+			"pljava groundwork " SO_VERSION_STRING,
+			sizeof (GroundworkMarkers), initMarkers, &found);
+
+	SpinLockAcquire(&s_markers->mutex);
+	for ( m = s_markers->markers;
+		m < s_markers->markers + GROUNDWORK_MARKER_SLOTS; ++ m )
+	{
+		if ( cur.dbid != m->dbid )
+			continue;
+		result = cur.sqljOid == m->sqljOid
+			&&  cur.handlerOid == m->handlerOid
+			&&  cur.uHandlerOid == m->uHandlerOid
+			&&  0 == strcmp(cur.loadPath, m->loadPath);
+		break;
+	}
+	SpinLockRelease(&s_markers->mutex);
+	return result;
+}
+
+/*
+ * Note the groundwork just done, to be marked in shared memory if the
+ * transaction commits. The segment is attached now, as it cannot be at commit.
+ */
+static void markGroundwork(void)
+{
+	bool found;
+
+	if ( ! currentMarker(&s_pendingMarker) )
+		return;
+	if ( NULL == s_markers )
+		s_markers = GetNamedDSMSegment(
+			"pljava groundwork " SO_VERSION_STRING,
+			sizeof (GroundworkMarkers), initMarkers, &found);
+	s_markerPending = true;
+}
+
+static void groundworkXactCB(XactEvent event, void *arg)
+{
+	GroundworkMarker *m;
+
+	if ( ! s_markerPending )
+		return;
+
+	switch ( event )
+	{
+	case XACT_EVENT_COMMIT:
+		SpinLockAcquire(&s_markers->mutex);
+		for ( m = s_markers->markers;
+			m < s_markers->markers + GROUNDWORK_MARKER_SLOTS; ++ m )
+			if ( s_pendingMarker.dbid == m->dbid )
+				break;
+		if ( m == s_markers->markers + GROUNDWORK_MARKER_SLOTS )
+		{
+			m = s_markers->markers + s_markers->next;
+			s_markers->next =
+				(s_markers->next + 1) % GROUNDWORK_MARKER_SLOTS;
+		}
+		*m = s_pendingMarker;
+		SpinLockRelease(&s_markers->mutex);
+		s_markerPending = false;
+		break;
+	case XACT_EVENT_ABORT:
+	case XACT_EVENT_PREPARE:
+		s_markerPending = false;
+		break;
+	default:
+		break;
+	}
+}
+#endif
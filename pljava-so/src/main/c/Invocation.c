@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2004-2021 Tada AB and other contributors, as listed below.
+ * Copyright (c) 2004-2026 Tada AB and other contributors, as listed below.
  *
  * All rights reserved. This program and the accompanying materials
  * are made available under the terms of the The BSD 3-Clause License
@@ -34,8 +34,8 @@ Invocation* currentInvocation;
  * here in Invocation to keep wrappers in Function simple. A PL/Java function
  * may use static primitive slot 0 to return a primitive value, so that will
  * always be saved in an Invocation struct and restored on both normal and
- * exceptional return paths, when the heavier-weight full pushing of a Java
- * ParameterFrame has not occurred. Likewise, the heavy full push is skipped if
+ * exceptional return paths, when the heavier-weight full pushing of the
+ * parameter frame has not occurred. Likewise, the heavy full push is skipped if
  * either the current or the new frame limits are (0,0), which means for such
  * cases the frame limits themselves must be saved and restored the same way.
  */
@@ -146,6 +146,7 @@ void Invocation_pushBootContext(Invocation* ctx)
 	ctx->upperContext    = CurrentMemoryContext;
 	ctx->errorOccurred   = false;
 	ctx->inExprContextCB = false;
+	ctx->timed           = false;
 	ctx->previous        = 0;
 #if PG_VERSION_NUM >= 100000
 	ctx->triggerData     = 0;
@@ -169,6 +170,7 @@ void Invocation_popBootContext(void)
 
 void Invocation_pushInvocation(Invocation* ctx)
 {
+	Backend_configMayHaveChanged();
 	JNI_pushLocalFrame(LOCAL_FRAME_SIZE);
 	ctx->invocation      = 0;
 	ctx->function        = 0;
@@ -179,6 +181,7 @@ void Invocation_pushInvocation(Invocation* ctx)
 	ctx->upperContext    = CurrentMemoryContext;
 	ctx->errorOccurred   = false;
 	ctx->inExprContextCB = false;
+	ctx->timed           = false;
 	ctx->previous        = currentInvocation;
 #if PG_VERSION_NUM >= 100000
 	ctx->triggerData     = 0;
@@ -192,6 +195,8 @@ void Invocation_popInvocation(bool wasException)
 	Invocation* ctx = currentInvocation->previous;
 	bool heavy = FRAME_LIMITS_PUSHED == currentInvocation->frameLimits;
 
+	Backend_configMayHaveChanged();
+
 	/*
 	 * If the more heavyweight parameter-frame push wasn't done, do
 	 * the lighter cleanup here.
@@ -40,6 +40,12 @@ static jfieldID  s_Thread_contextLoader;
 
 static jobject   s_threadObject;
 
+/*
+ * A weak reference to the loader most recently installed by a top-level call on
+ * the primordial thread, or NULL. See _updaterCommon.
+ */
+static jobject   s_installedLoader;
+
 void pljava_JNI_setThreadPolicy(bool refuseOtherThreads, bool doMonitorOps)
 {
 	s_refuseOtherThreads = refuseOtherThreads;
@@ -93,19 +99,29 @@ void pljava_JNI_threadInitialize(bool manageLoader)
 		JNI_loaderUpdater  = _noopUpdater;
 		JNI_loaderRestorer = _noopRestorer;
 	}
-	else if ( s_refuseOtherThreads  ||  ! s_doMonitorOps )
+	else
 	{
+		/*
+		 * The primordial thread's Thread object is wanted in every case: as
+		 * the only thread in the light flavor, and as the one to compare
+		 * against in the heavy flavor, which need not ask Java for the
+		 * current thread when a simple comparison of JNIEnv pointers shows
+		 * it to be the primordial one.
+		 */
 		s_threadObject =
 			JNI_newGlobalRef(
 				JNI_callStaticObjectMethod(
 					s_Thread_class, s_Thread_currentThread));
-		JNI_loaderUpdater  = _lightUpdater;
-		JNI_loaderRestorer = _lightRestorer;
-	}
-	else
-	{
-		JNI_loaderUpdater  = _heavyUpdater;
-		JNI_loaderRestorer = _heavyRestorer;
+		if ( s_refuseOtherThreads  ||  ! s_doMonitorOps )
+		{
+			JNI_loaderUpdater  = _lightUpdater;
+			JNI_loaderRestorer = _lightRestorer;
+		}
+		else
+		{
+			JNI_loaderUpdater  = _heavyUpdater;
+			JNI_loaderRestorer = _heavyRestorer;
+		}
 	}
 }
 
@@ -131,16 +147,25 @@ void pljava_JNI_threadInitialize(bool manageLoader)
 
 #define BEGIN_CALL \
 	BEGIN_JAVA \
+	++ JNI_counters.upcalls; \
 	if(s_doMonitorOps && ((*env)->MonitorExit(env, s_threadLock) < 0)) \
 		elog(ERROR, "Java exit monitor failure");
 
 #define END_CALL endCall(env); }
 
 #define BEGIN_CALL_MONITOR_HELD \
-	BEGIN_JAVA
+	BEGIN_JAVA \
+	++ JNI_counters.upcalls;
 
 #define END_CALL_MONITOR_HELD endCallMonitorHeld(env); }
 
+/*
+ * Used in the wrappers that return a new local reference, to count it.
+ */
+#define COUNT_LOCAL_REF(ref) if ( 0 != (ref) ) ++ JNI_counters.localRefs
+
+JNI_Counters JNI_counters;
+
 static void elogExceptionMessage(JNIEnv* env, jthrowable exh, int logLevel)
 {
 	StringInfoData buf;
@@ -309,6 +334,7 @@ bool beginNativeNoErrCheck(JNIEnv* env)
 		JNI_setEnv(env);
 		return false;
 	}
+	++ JNI_counters.downcalls;
 	return true;
 }
 
@@ -524,6 +550,7 @@ jobject JNI_callObjectMethodV(jobject object, jmethodID methodID, va_list args)
 	BEGIN_CALL
 	result = (*env)->CallObjectMethodV(env, object, methodID, args);
 	END_CALL
+	COUNT_LOCAL_REF(result);
 	return result;
 }
 
@@ -543,6 +570,7 @@ jobject JNI_callObjectMethodLockedV(jobject object, jmethodID methodID, va_list
 	BEGIN_CALL_MONITOR_HELD
 	result = (*env)->CallObjectMethodV(env, object, methodID, args);
 	END_CALL_MONITOR_HELD
+	COUNT_LOCAL_REF(result);
 	return result;
 }
 
@@ -768,6 +796,7 @@ jobject JNI_callStaticObjectMethodA(jclass clazz, jmethodID methodID, jvalue* ar
 	BEGIN_CALL
 	result = (*env)->CallStaticObjectMethodA(env, clazz, methodID, args);
 	END_CALL
+	COUNT_LOCAL_REF(result);
 	return result;
 }
 
@@ -777,6 +806,7 @@ jobject JNI_callStaticObjectMethodV(jclass clazz, jmethodID methodID, va_list ar
 	BEGIN_CALL
 	result = (*env)->CallStaticObjectMethodV(env, clazz, methodID, args);
 	END_CALL
+	COUNT_LOCAL_REF(result);
 	return result;
 }
 
@@ -796,6 +826,7 @@ jobject JNI_callStaticObjectMethodLockedV(jclass clazz, jmethodID methodID, va_l
 	BEGIN_CALL_MONITOR_HELD
 	result = (*env)->CallStaticObjectMethodV(env, clazz, methodID, args);
 	END_CALL_MONITOR_HELD
+	COUNT_LOCAL_REF(result);
 	return result;
 }
 
@@ -962,6 +993,7 @@ jthrowable JNI_exceptionOccurred(void)
 	BEGIN_JAVA
 	result = (*env)->ExceptionOccurred(env);
 	END_JAVA
+	COUNT_LOCAL_REF(result);
 	return result;
 }
 
@@ -971,6 +1003,7 @@ jclass JNI_findClass(const char* className)
 	BEGIN_JAVA
 	result = (*env)->FindClass(env, className);
 	END_JAVA
+	COUNT_LOCAL_REF(result);
 	return result;
 }
 
@@ -1148,6 +1181,7 @@ jobject JNI_getObjectArrayElement(jobjectArray array, jsize index)
 	BEGIN_JAVA
 	result = (*env)->GetObjectArrayElement(env, array, index);
 	END_JAVA
+	COUNT_LOCAL_REF(result);
 	return result;
 }
 
@@ -1157,6 +1191,17 @@ jclass JNI_getObjectClass(jobject obj)
 	BEGIN_JAVA
 	result = (*env)->GetObjectClass(env, obj);
 	END_JAVA
+	COUNT_LOCAL_REF(result);
+	return result;
+}
+
+jobject JNI_getObjectField(jobject object, jfieldID field)
+{
+	jobject result;
+	BEGIN_JAVA
+	result = (*env)->GetObjectField(env, object, field);
+	END_JAVA
+	COUNT_LOCAL_REF(result);
 	return result;
 }
 
@@ -1245,6 +1290,7 @@ jobject JNI_getStaticObjectField(jclass clazz, jfieldID field)
 	BEGIN_JAVA
 	result = (*env)->GetStaticObjectField(env, clazz, field);
 	END_JAVA
+	COUNT_LOCAL_REF(result);
 	return result;
 }
 
@@ -1288,6 +1334,15 @@ jboolean JNI_isInstanceOf(jobject obj, jclass clazz)
 	return result;
 }
 
+jboolean JNI_isAssignableFrom(jclass sub, jclass sup)
+{
+	jboolean result;
+	BEGIN_JAVA
+	result = (*env)->IsAssignableFrom(env, sub, sup);
+	END_JAVA
+	return result;
+}
+
 jboolean JNI_isSameObject(jobject obj1, jobject obj2)
 {
 	jboolean result;
@@ -1303,6 +1358,7 @@ jbyteArray JNI_newByteArray(jsize length)
 	BEGIN_JAVA
 	result = (*env)->NewByteArray(env, length);
 	END_JAVA
+	COUNT_LOCAL_REF(result);
 	return result;
 }
 
@@ -1312,6 +1368,7 @@ jbooleanArray JNI_newBooleanArray(jsize length)
 	BEGIN_JAVA
 	result = (*env)->NewBooleanArray(env, length);
 	END_JAVA
+	COUNT_LOCAL_REF(result);
 	return result;
 }
 
@@ -1321,6 +1378,7 @@ jobjectArray JNI_newObjectArray(jsize length, jclass elementClass, jobject initi
 	BEGIN_JAVA
 	result = (*env)->NewObjectArray(env, length, elementClass, initialElement);
 	END_JAVA
+	COUNT_LOCAL_REF(result);
 	return result;
 }
 
@@ -1330,6 +1388,16 @@ jobject JNI_newDirectByteBuffer(void* address, jlong capacity)
 	BEGIN_JAVA
 	result = (*env)->NewDirectByteBuffer(env, address, capacity);
 	END_JAVA
+	COUNT_LOCAL_REF(result);
+	return result;
+}
+
+void* JNI_getDirectBufferAddress(jobject buffer)
+{
+	void* result;
+	BEGIN_JAVA
+	result = (*env)->GetDirectBufferAddress(env, buffer);
+	END_JAVA
 	return result;
 }
 
@@ -1339,6 +1407,7 @@ jdoubleArray JNI_newDoubleArray(jsize length)
 	BEGIN_JAVA
 	result = (*env)->NewDoubleArray(env, length);
 	END_JAVA
+	COUNT_LOCAL_REF(result);
 	return result;
 }
 
@@ -1348,6 +1417,7 @@ jfloatArray JNI_newFloatArray(jsize length)
 	BEGIN_JAVA
 	result = (*env)->NewFloatArray(env, length);
 	END_JAVA
+	COUNT_LOCAL_REF(result);
 	return result;
 }
 
@@ -1366,6 +1436,7 @@ jintArray JNI_newIntArray(jsize length)
 	BEGIN_JAVA
 	result = (*env)->NewIntArray(env, length);
 	END_JAVA
+	COUNT_LOCAL_REF(result);
 	return result;
 }
 
@@ -1375,6 +1446,7 @@ jobject JNI_newLocalRef(jobject object)
 	BEGIN_JAVA
 	result = (*env)->NewLocalRef(env, object);
 	END_JAVA
+	COUNT_LOCAL_REF(result);
 	return result;
 }
 
@@ -1384,6 +1456,7 @@ jlongArray JNI_newLongArray(jsize length)
 	BEGIN_JAVA
 	result = (*env)->NewLongArray(env, length);
 	END_JAVA
+	COUNT_LOCAL_REF(result);
 	return result;
 }
 
@@ -1393,6 +1466,7 @@ jshortArray JNI_newShortArray(jsize length)
 	BEGIN_JAVA
 	result = (*env)->NewShortArray(env, length);
 	END_JAVA
+	COUNT_LOCAL_REF(result);
 	return result;
 }
 
@@ -1402,6 +1476,7 @@ jstring JNI_newStringUTF(const char* bytes)
 	BEGIN_JAVA
 	result = (*env)->NewStringUTF(env, bytes);
 	END_JAVA
+	COUNT_LOCAL_REF(result);
 	return result;
 }
 
@@ -1423,6 +1498,44 @@ jobject JNI_popLocalFrame(jobject resultObj)
 	return result;
 }
 
+static void pushLocalChunk(JNI_LocalChunks* lc)
+{
+	if ( 0 != JNI_pushLocalFrame(lc->capacity) )
+	{
+		JNI_exceptionClear();
+		ereport(ERROR, (
+			errcode(ERRCODE_OUT_OF_MEMORY),
+			errmsg("could not reserve %d JNI local references",
+				(int)lc->capacity)));
+	}
+	lc->pushed = true;
+	lc->left = JNI_LOCAL_CHUNK;
+}
+
+void JNI_beginLocalChunks(JNI_LocalChunks* lc, jint refsPerElement)
+{
+	lc->capacity = JNI_LOCAL_CHUNK * refsPerElement;
+	lc->pushed = false;
+	pushLocalChunk(lc);
+}
+
+void JNI_nextLocalChunk(JNI_LocalChunks* lc)
+{
+	if ( 0 < -- lc->left )
+		return;
+	lc->pushed = false;
+	JNI_popLocalFrame(NULL);
+	pushLocalChunk(lc);
+}
+
+void JNI_endLocalChunks(JNI_LocalChunks* lc)
+{
+	if ( ! lc->pushed )
+		return;
+	lc->pushed = false;
+	JNI_popLocalFrame(NULL);
+}
+
 jweak JNI_newWeakGlobalRef(jobject object)
 {
 	jweak result;
@@ -1448,6 +1561,7 @@ jobject JNI_newObjectV(jclass clazz, jmethodID ctor, va_list args)
 	BEGIN_CALL
 	result = (*env)->NewObjectV(env, clazz, ctor, args);
 	END_CALL
+	COUNT_LOCAL_REF(result);
 	return result;
 }
 
@@ -1467,6 +1581,7 @@ jobject JNI_newObjectLockedV(jclass clazz, jmethodID ctor, va_list args)
 	BEGIN_CALL_MONITOR_HELD
 	result = (*env)->NewObjectV(env, clazz, ctor, args);
 	END_CALL_MONITOR_HELD
+	COUNT_LOCAL_REF(result);
 	return result;
 }
 
@@ -1638,41 +1753,70 @@ jint JNI_throw(jthrowable obj)
 
 static inline void _updaterCommon(JNIEnv *env, jobject thread, jobject loader)
 {
-	jobject old = (*env)->GetObjectField(env, thread, s_Thread_contextLoader);
+	jobject old;
+	bool topLevel = NULL == currentInvocation->previous;
+	bool primordial = thread == s_threadObject;
 
 	/*
-	 * If it is not already the loader we want, change it, and set
-	 * currentInvocation->savedLoader to restore it later. If this is
-	 * a top-level invocation, we don't care what it gets restored to, so lie,
-	 * and save loader there instead of old. If there are many consecutive
-	 * top-level calls with the same context loader, that will save work later.
-	 *
-	 * If it is already the loader we want, again we check for a top-level call,
-	 * and can leave currentInvocation->savedLoader completely unset in that
-	 * case, so the restore call will be skipped completely. If not a top-level
-	 * call, though, see that it gets restored to what the caller might expect,
-	 * even if it somehow got changed.
+	 * A top-level call on the primordial thread whose loader is the one the
+	 * last such call installed has nothing to do at all: the thread's field is
+	 * not even read. That relies on the documented assumption that no Java code
+	 * uses setContextClassLoader to change it; the loader is not put back after
+	 * a top-level call, but simply left for the next call to find, so a run of
+	 * calls of functions in one schema does no switching, and the switch is
+	 * made lazily when a function from a different schema is called.
+	 */
+	if ( topLevel  &&  primordial  &&  NULL != s_installedLoader
+		&&  (*env)->IsSameObject(env, s_installedLoader, loader) )
+		return;
+
+	old = (*env)->GetObjectField(env, thread, s_Thread_contextLoader);
+
+	/*
+	 * If it is not already the loader we want, change it. If this is not
+	 * a top-level call, set currentInvocation->savedLoader to restore the old
+	 * one later; a top-level call leaves currentInvocation->savedLoader unset,
+	 * so the restore call will be skipped completely, as it is also when the
+	 * loader is already the one wanted at top level. If not a top-level call,
+	 * though, see that it gets restored to what the caller might expect, even
+	 * if it somehow got changed.
 	 */
 
 	if ( ! (*env)->IsSameObject(env, old, loader) )
 	{
 		(*env)->SetObjectField(env, thread, s_Thread_contextLoader, loader);
 
-		currentInvocation->savedLoader = (*env)->NewGlobalRef(env,
-			( NULL == currentInvocation->previous ) ? loader : old);
+		if ( ! topLevel )
+			currentInvocation->savedLoader = (*env)->NewGlobalRef(env, old);
 	}
-	else if ( NULL != currentInvocation->previous )
+	else if ( ! topLevel )
 		currentInvocation->savedLoader = (*env)->NewGlobalRef(env, old);
 
+	if ( topLevel  &&  primordial )
+	{
+		if ( NULL != s_installedLoader )
+			(*env)->DeleteWeakGlobalRef(env, s_installedLoader);
+		s_installedLoader = (*env)->NewWeakGlobalRef(env, loader);
+	}
+
 	(*env)->DeleteLocalRef(env, old);
 }
 
-static void _heavyUpdater(jobject loader)
+/*
+ * Return the Thread object of the thread owning env: without a call into Java
+ * if env is the primordial thread's, as it nearly always will be. Only in that
+ * case is the result not a new local reference, which is indicated by *isLocal.
+ */
+static inline jobject currentThread(JNIEnv *env, bool *isLocal)
 {
 	jobject thread;
 	jobject exh;
 
-	BEGIN_JAVA
+	if ( env == primordialJNIEnv )
+	{
+		*isLocal = false;
+		return s_threadObject;
+	}
 
 	thread =
 		(*env)->CallStaticObjectMethod(env,
@@ -1685,9 +1829,23 @@ static void _heavyUpdater(jobject loader)
 		elogExceptionMessage(env, exh, ERROR);
 	}
 
+	*isLocal = true;
+	return thread;
+}
+
+static void _heavyUpdater(jobject loader)
+{
+	jobject thread;
+	bool isLocal;
+
+	BEGIN_JAVA
+
+	thread = currentThread(env, &isLocal);
+
 	_updaterCommon(env, thread, loader);
 
-	(*env)->DeleteLocalRef(env, thread);
+	if ( isLocal )
+		(*env)->DeleteLocalRef(env, thread);
 
 	END_JAVA
 }
@@ -1696,26 +1854,18 @@ void _heavyRestorer()
 {
 	jobject thread;
 	jobject value;
-	jobject exh;
+	bool isLocal;
 
 	BEGIN_JAVA
 
-	thread =
-		(*env)->CallStaticObjectMethod(env,
-			s_Thread_class, s_Thread_currentThread); /* should never fail */
-
-	exh = (*env)->ExceptionOccurred(env); /* but mollify -Xcheck:jni anyway */
-	if(exh != 0)
-	{
-		(*env)->ExceptionClear(env);
-		elogExceptionMessage(env, exh, ERROR);
-	}
+	thread = currentThread(env, &isLocal);
 
 	value = currentInvocation->savedLoader;
 
 	(*env)->SetObjectField(env, thread, s_Thread_contextLoader, value);
 	(*env)->DeleteGlobalRef(env, value);
-	(*env)->DeleteLocalRef(env, thread);
+	if ( isLocal )
+		(*env)->DeleteLocalRef(env, thread);
 
 	END_JAVA
 }
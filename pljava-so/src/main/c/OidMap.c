@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+#include <postgres.h>
+#include <utils/memutils.h>
+
+#include "pljava/OidMap.h"
+
+typedef struct
+{
+	Oid   key;
+	void* value;
+} Slot;
+
+struct OidMap_
+{
+	MemoryContext ctx;
+	Slot*  table;
+	uint32 mask;   /* table size, a power of two, less one */
+	uint32 size;
+};
+
+/*
+ * Oids are allotted sequentially, so they are mixed (with the finalizer of
+ * MurmurHash3) before taking the low bits as the home slot, or neighbouring
+ * Oids would crowd into runs of neighbouring slots.
+ */
+static inline uint32 slotOf(OidMap self, Oid key)
+{
+	uint32 h = (uint32)key;
+	h ^= h >> 16;
+	h *= 0x85ebca6b;
+	h ^= h >> 13;
+	h *= 0xc2b2ae35;
+	h ^= h >> 16;
+	return h & self->mask;
+}
+
+static Slot* allocTable(MemoryContext ctx, uint32 tableSize)
+{
+	return (Slot*)MemoryContextAllocZero(ctx, tableSize * sizeof(Slot));
+}
+
+/*
+ * Double the table, reinserting every entry at its home or the first free
+ * slot after.
+ */
+static void grow(OidMap self)
+{
+	Slot*  oldTable = self->table;
+	uint32 oldSize  = self->mask + 1;
+	uint32 idx;
+
+	self->table = allocTable(self->ctx, oldSize * 2);
+	self->mask  = oldSize * 2 - 1;
+
+	for(idx = 0; idx < oldSize; ++idx)
+	{
+		uint32 s;
+		if(InvalidOid == oldTable[idx].key)
+			continue;
+		for(s = slotOf(self, oldTable[idx].key);
+			InvalidOid != self->table[s].key;
+			s = (s + 1) & self->mask)
+			;
+		self->table[s] = oldTable[idx];
+	}
+	pfree(oldTable);
+}
+
+OidMap OidMap_create(uint32 initialCapacity, MemoryContext ctx)
+{
+	OidMap self;
+	uint32 tableSize = 16;
+
+	if(ctx == 0)
+		ctx = CurrentMemoryContext;
+
+	/* Keep the table at most half full. */
+	while(tableSize < initialCapacity * 2)
+		tableSize <<= 1;
+
+	self = (OidMap)MemoryContextAlloc(ctx, sizeof(struct OidMap_));
+	self->ctx   = ctx;
+	self->table = allocTable(ctx, tableSize);
+	self->mask  = tableSize - 1;
+	self->size  = 0;
+	return self;
+}
+
+void OidMap_free(OidMap self)
+{
+	pfree(self->table);
+	pfree(self);
+}
+
+void* OidMap_get(OidMap self, Oid key)
+{
+	uint32 s;
+	for(s = slotOf(self, key); ; s = (s + 1) & self->mask)
+	{
+		Slot* slot = self->table + s;
+		if(slot->key == key)
+			return slot->value;
+		if(InvalidOid == slot->key)
+			return NULL;
+	}
+}
+
+void* OidMap_put(OidMap self, Oid key, void* value)
+{
+	uint32 s;
+
+	Assert(InvalidOid != key);
+	Assert(NULL != value);
+
+	if((self->size + 1) * 2 > self->mask + 1)
+		grow(self);
+
+	for(s = slotOf(self, key); ; s = (s + 1) & self->mask)
+	{
+		Slot* slot = self->table + s;
+		if(slot->key == key)
+		{
+			void* old = slot->value;
+			slot->value = value;
+			return old;
+		}
+		if(InvalidOid == slot->key)
+		{
+			slot->key = key;
+			slot->value = value;
+			++self->size;
+			return NULL;
+		}
+	}
+}
+
+void* OidMap_remove(OidMap self, Oid key)
+{
+	uint32 hole;
+	uint32 s;
+	void*  old;
+
+	for(hole = slotOf(self, key); ; hole = (hole + 1) & self->mask)
+	{
+		if(self->table[hole].key == key)
+			break;
+		if(InvalidOid == self->table[hole].key)
+			return NULL;
+	}
+	old = self->table[hole].value;
+	--self->size;
+
+	/*
+	 * Rather than leave a tombstone, move back into the hole any later entry
+	 * in the same run whose home slot does not lie between the hole and it,
+	 * as that entry would otherwise no longer be found; repeat for the hole
+	 * that move leaves, until the run ends.
+	 */
+	for(s = (hole + 1) & self->mask;
+		InvalidOid != self->table[s].key;
+		s = (s + 1) & self->mask)
+	{
+		uint32 home = slotOf(self, self->table[s].key);
+		if(((s - home) & self->mask) >= ((s - hole) & self->mask))
+		{
+			self->table[hole] = self->table[s];
+			hole = s;
+		}
+	}
+	self->table[hole].key = InvalidOid;
+	self->table[hole].value = NULL;
+	return old;
+}
+
+uint32 OidMap_size(OidMap self)
+{
+	return self->size;
+}
+
+bool OidMap_next(OidMap self, uint32* cursor, Oid* key, void** value)
+{
+	uint32 tableSize = self->mask + 1;
+	while(*cursor < tableSize)
+	{
+		Slot* slot = self->table + (*cursor)++;
+		if(InvalidOid == slot->key)
+			continue;
+		if(NULL != key)
+			*key = slot->key;
+		if(NULL != value)
+			*value = slot->value;
+		return true;
+	}
+	return false;
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2004-2019 Tada AB and other contributors, as listed below.
+ * Copyright (c) 2004-2026 Tada AB and other contributors, as listed below.
  *
  * All rights reserved. This program and the accompanying materials
  * are made available under the terms of the The BSD 3-Clause License
@@ -17,6 +17,7 @@
 
 #include "org_postgresql_pljava_internal_PgSavepoint.h"
 #include "pljava/PgSavepoint.h"
+#include "pljava/Backend.h"
 #include "pljava/Exception.h"
 #include "pljava/Invocation.h"
 #include "pljava/type/String.h"
@@ -76,6 +77,16 @@ void PgSavepoint_initialize(void)
 		"(II)V",
 		Java_org_postgresql_pljava_internal_PgSavepoint__1rollback
 		},
+		{
+		"_begin",
+		"()J",
+		Java_org_postgresql_pljava_internal_PgSavepoint__1begin
+		},
+		{
+		"_abort",
+		"(II)V",
+		Java_org_postgresql_pljava_internal_PgSavepoint__1abort
+		},
 		{ 0, 0, 0 }
 	};
 	PgObject_registerNatives("org/postgresql/pljava/internal/PgSavepoint",
@@ -187,6 +198,7 @@ Java_org_postgresql_pljava_internal_PgSavepoint__1rollback(JNIEnv* env, jclass c
 	PG_TRY();
 	{
 		unwind(RollbackAndReleaseCurrentSubTransaction, xid, nestLevel);
+		Backend_configMayHaveChanged();
 		SPI_restore_connection();
 	}
 	PG_CATCH();
@@ -196,3 +208,50 @@ Java_org_postgresql_pljava_internal_PgSavepoint__1rollback(JNIEnv* env, jclass c
 	PG_END_TRY();
 	END_NATIVE
 }
+
+/*
+ * Class:     org_postgresql_pljava_internal_PgSavepoint
+ * Method:    _begin
+ * Signature: ()J
+ */
+JNIEXPORT jlong JNICALL
+Java_org_postgresql_pljava_internal_PgSavepoint__1begin(JNIEnv* env, jclass clazz)
+{
+	jlong result = 0;
+	BEGIN_NATIVE
+	PG_TRY();
+	{
+		jint nestLevel;
+		Invocation_assertConnect();
+		nestLevel = 1 + GetCurrentTransactionNestLevel();
+		BeginInternalSubTransaction(NULL);
+		result = (jlong)nestLevel << 32
+			| (jlong)(uint32)GetCurrentSubTransactionId();
+	}
+	PG_CATCH();
+	{
+		Exception_throw_ERROR("BeginInternalSubTransaction");
+	}
+	PG_END_TRY();
+	END_NATIVE
+	return result;
+}
+
+/*
+ * Class:     org_postgresql_pljava_internal_PgSavepoint
+ * Method:    _abort
+ * Signature: (II)V
+ */
+JNIEXPORT void JNICALL
+Java_org_postgresql_pljava_internal_PgSavepoint__1abort(JNIEnv* env, jclass clazz, jint xid, jint nestLevel)
+{
+	/*
+	 * Clear the error condition, as Invocation._clearErrorCondition does for
+	 * Connection.rollback; it must be done before BEGIN_NATIVE, which would
+	 * refuse to proceed with it set.
+	 */
+	if ( NULL != currentInvocation )
+		currentInvocation->errorOccurred = false;
+	Java_org_postgresql_pljava_internal_PgSavepoint__1rollback(
+		env, clazz, xid, nestLevel);
+}
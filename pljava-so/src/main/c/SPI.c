@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2004-2019 Tada AB and other contributors, as listed below.
+ * Copyright (c) 2004-2026 Tada AB and other contributors, as listed below.
  *
  * All rights reserved. This program and the accompanying materials
  * are made available under the terms of the The BSD 3-Clause License
@@ -12,6 +12,7 @@
  */
 #include "org_postgresql_pljava_internal_SPI.h"
 #include "pljava/SPI.h"
+#include "pljava/Backend.h"
 #include "pljava/Invocation.h"
 #include "pljava/Exception.h"
 #include "pljava/type/String.h"
@@ -52,6 +53,11 @@ void SPI_initialize(void)
 		Java_org_postgresql_pljava_internal_SPI__1getTupTable
 		},
 		{
+		"_getTupTableBytes",
+		"()J",
+		Java_org_postgresql_pljava_internal_SPI__1getTupTableBytes
+		},
+		{
 		"_freeTupTable",
 		"()V",
 		Java_org_postgresql_pljava_internal_SPI__1freeTupTable
@@ -127,6 +133,7 @@ Java_org_postgresql_pljava_internal_SPI__1exec(JNIEnv* env, jclass cls, jstring
 		{
 			Invocation_assertConnect();
 			result = (jint)SPI_exec(command, (int)count);
+			Backend_configMayHaveChanged();
 			if(result < 0)
 				Exception_throwSPI("exec", result);
 	
@@ -177,12 +184,55 @@ Java_org_postgresql_pljava_internal_SPI__1getTupTable(JNIEnv* env, jclass cls, j
 	if(SPI_tuptable != 0)
 	{
 		BEGIN_NATIVE
-		tupleTable = TupleTable_create(SPI_tuptable, td);
+		tupleTable = pljava_SPI_createTupleTable(td);
 		END_NATIVE
 	}
 	return tupleTable;
 }
 
+jobject pljava_SPI_createTupleTable(jobject td)
+{
+	jobject tupleTable;
+	if(SPI_tuptable == 0)
+		return 0;
+	if ( Backend_isSPIBorrowedTuples() )
+	{
+		tupleTable = TupleTable_createBorrowed(SPI_tuptable, td);
+		SPI_tuptable = 0;
+	}
+	else
+		tupleTable = TupleTable_create(SPI_tuptable, td);
+	return tupleTable;
+}
+
+/*
+ * Class:     org_postgresql_pljava_internal_SPI
+ * Method:    _getTupTableBytes
+ * Signature: ()J
+ */
+JNIEXPORT jlong JNICALL
+Java_org_postgresql_pljava_internal_SPI__1getTupTableBytes(JNIEnv* env, jclass cls)
+{
+	return pljava_SPI_tupTableBytes();
+}
+
+jlong pljava_SPI_tupTableBytes(void)
+{
+	jlong bytes = 0;
+	if(SPI_tuptable != 0)
+	{
+		uint64 i;
+#if PG_VERSION_NUM < 130000
+		uint64 count = SPI_tuptable->alloced - SPI_tuptable->free;
+#else
+		uint64 count = SPI_tuptable->numvals;
+#endif
+		for ( i = 0 ; i < count ; ++ i )
+			bytes += SPI_tuptable->vals[i]->t_len;
+	}
+	return bytes;
+}
+
 /*
  * Class:     org_postgresql_pljava_internal_SPI
  * Method:    _freeTupTable
@@ -13,9 +13,18 @@
 #include <postgres.h>
 #include "pljava/SQLInputFromChunk.h"
 
+#include <utils/memutils.h>
+
+/*
+ * Values larger than this are read in place by a new reader rather than
+ * copied into a pooled one.
+ */
+#define POOLED_MAX 8192
+
 static jclass    s_SQLInputFromChunk_class;
 static jmethodID s_SQLInputFromChunk_init;
 static jmethodID s_SQLInputFromChunk_close;
+static jmethodID s_SQLInputFromChunk_reset;
 
 jobject SQLInputFromChunk_create(void* data, size_t sz, bool isJavaBasedScalar)
 {
@@ -31,6 +40,64 @@ void SQLInputFromChunk_close(jobject stream)
 	JNI_callVoidMethod(stream, s_SQLInputFromChunk_close);
 }
 
+jobject SQLInputFromChunk_acquire(SQLInputFromChunkPool *pool,
+	void* data, size_t sz, bool isJavaBasedScalar)
+{
+	jobject dbb = NULL;
+	jobject stream;
+	size_t capacity;
+
+	if ( pool->busy  ||  sz > POOLED_MAX )
+		return SQLInputFromChunk_create(data, sz, isJavaBasedScalar);
+
+	if ( NULL == pool->stream  ||  sz > pool->capacity )
+	{
+		for ( capacity = Max(64, pool->capacity) ; capacity < sz ; )
+			capacity *= 2;
+		if ( NULL != pool->data )
+		{
+			JNI_deleteGlobalRef(pool->byteBuffer);
+			pfree(pool->data);
+		}
+		pool->data = MemoryContextAlloc(TopMemoryContext, capacity);
+		pool->capacity = capacity;
+		dbb = JNI_newDirectByteBuffer(pool->data, capacity);
+		pool->byteBuffer = JNI_newGlobalRef(dbb);
+		if ( NULL == pool->stream )
+		{
+			stream = JNI_newObject(s_SQLInputFromChunk_class,
+				s_SQLInputFromChunk_init, dbb,
+				isJavaBasedScalar ? JNI_TRUE : JNI_FALSE);
+			pool->stream = JNI_newGlobalRef(stream);
+			JNI_deleteLocalRef(stream);
+			JNI_deleteLocalRef(dbb);
+			dbb = NULL;
+		}
+	}
+
+	memcpy(pool->data, data, sz);
+	JNI_callVoidMethod(pool->stream, s_SQLInputFromChunk_reset, dbb, (jint)sz);
+	if ( NULL != dbb )
+		JNI_deleteLocalRef(dbb);
+	pool->busy = true;
+	return pool->stream;
+}
+
+void SQLInputFromChunk_release(SQLInputFromChunkPool *pool, jobject stream)
+{
+	SQLInputFromChunk_close(stream);
+	if ( stream == pool->stream )
+		pool->busy = false;
+	else
+		JNI_deleteLocalRef(stream);
+}
+
+void SQLInputFromChunk_abandon(SQLInputFromChunkPool *pool, jobject stream)
+{
+	if ( stream == pool->stream )
+		pool->busy = false;
+}
+
 /* Make this datatype available to the postgres system.
  */
 extern void SQLInputFromChunk_initialize(void);
@@ -40,4 +107,6 @@ void SQLInputFromChunk_initialize(void)
 	s_SQLInputFromChunk_init = PgObject_getJavaMethod(s_SQLInputFromChunk_class,
 		"<init>", "(Ljava/nio/ByteBuffer;Z)V");
 	s_SQLInputFromChunk_close = PgObject_getJavaMethod(s_SQLInputFromChunk_class, "close", "()V");
+	s_SQLInputFromChunk_reset = PgObject_getJavaMethod(
+		s_SQLInputFromChunk_class, "reset", "(Ljava/nio/ByteBuffer;I)V");
 }
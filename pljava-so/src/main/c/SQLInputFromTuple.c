@@ -22,23 +22,27 @@
 static jclass    s_SQLInputFromTuple_class;
 static jmethodID s_SQLInputFromTuple_init;
 
+/*
+ * The fields are all deformed and coerced to Java here, in one pass, so that
+ * the readSQL method of the UDT reads each of them from a Java array rather
+ * than with a call into native code per field.
+ */
 jobject pljava_SQLInputFromTuple_create(HeapTupleHeader hth)
 {
-	Ptr2Long p2lht;
 	Ptr2Long p2lro;
 	jobject result;
+	jobjectArray values;
 	jobject jtd = pljava_SingleRowReader_getTupleDesc(hth);
+	jlong state = pljava_SingleRowReader_newState(hth, &values);
 
-	p2lht.longVal = 0L;
 	p2lro.longVal = 0L;
-
-	p2lht.ptrVal = hth;
 	p2lro.ptrVal = currentInvocation;
 
 	result =
 		JNI_newObjectLocked(s_SQLInputFromTuple_class, s_SQLInputFromTuple_init,
-			pljava_DualState_key(), p2lro.longVal, p2lht.longVal, jtd);
+			pljava_DualState_key(), p2lro.longVal, state, jtd, values);
 
+	JNI_deleteLocalRef(values);
 	JNI_deleteLocalRef(jtd);
 	return result;
 }
@@ -50,7 +54,7 @@ void pljava_SQLInputFromTuple_initialize(void)
 	jclass cls =
 		PgObject_getJavaClass("org/postgresql/pljava/jdbc/SQLInputFromTuple");
 	s_SQLInputFromTuple_init = PgObject_getJavaMethod(cls, "<init>",
-		"(Lorg/postgresql/pljava/internal/DualState$Key;JJLorg/postgresql/pljava/internal/TupleDesc;)V");
+		"(Lorg/postgresql/pljava/internal/DualState$Key;JJLorg/postgresql/pljava/internal/TupleDesc;[Ljava/lang/Object;)V");
 	s_SQLInputFromTuple_class = JNI_newGlobalRef(cls);
 	JNI_deleteLocalRef(cls);
 }
@@ -11,9 +11,20 @@
 
 #include "org_postgresql_pljava_jdbc_SQLOutputToChunk.h"
 
+#include <utils/memutils.h>
+#include "pljava/Invocation.h"
+
+/*
+ * A pooled buffer grown past this many times the average length written (or
+ * times a kilobyte, if that is more) is freed once it is released, rather than
+ * kept at that size.
+ */
+#define KEEP_FACTOR 4
+
 static jclass    s_SQLOutputToChunk_class;
 static jmethodID s_SQLOutputToChunk_init;
 static jmethodID s_SQLOutputToChunk_close;
+static jmethodID s_SQLOutputToChunk_reset;
 static jmethodID s_Buffer_position;
 
 jobject SQLOutputToChunk_create(StringInfo data, bool isJavaBasedScalar)
@@ -39,6 +50,99 @@ void SQLOutputToChunk_close(jobject stream)
 	JNI_callVoidMethod(stream, s_SQLOutputToChunk_close);
 }
 
+StringInfo SQLOutputToChunk_buffer(SQLOutputToChunkPool *pool)
+{
+	StringInfo buffer;
+	MemoryContext currCtx;
+
+	if ( ! pool->busy )
+	{
+		if ( NULL == pool->buffer.data )
+		{
+			currCtx = MemoryContextSwitchTo(TopMemoryContext);
+			initStringInfo(&pool->buffer);
+			MemoryContextSwitchTo(currCtx);
+		}
+		resetStringInfo(&pool->buffer);
+		pool->busy = true;
+		return &pool->buffer;
+	}
+
+	currCtx = Invocation_switchToUpperContext();
+	buffer = makeStringInfo();
+	if ( pool->averageLen >= buffer->maxlen )
+		enlargeStringInfo(buffer, pool->averageLen);
+	MemoryContextSwitchTo(currCtx); /* buffer remembers its context */
+	return buffer;
+}
+
+jobject SQLOutputToChunk_acquire(SQLOutputToChunkPool *pool,
+	StringInfo buffer, bool isJavaBasedScalar)
+{
+	jobject stream;
+	jobject dbb = NULL;
+	Ptr2Long p2l;
+
+	if ( buffer != &pool->buffer )
+		return SQLOutputToChunk_create(buffer, isJavaBasedScalar);
+
+	if ( NULL == pool->stream )
+	{
+		stream = SQLOutputToChunk_create(buffer, isJavaBasedScalar);
+		pool->stream = JNI_newGlobalRef(stream);
+		JNI_deleteLocalRef(stream);
+		return pool->stream;
+	}
+
+	/*
+	 * Whatever was appended ahead of the Java-written bytes may have moved
+	 * the buffer since the writer last saw it.
+	 */
+	if ( buffer->data != pool->javaData  ||  buffer->maxlen != pool->javaMaxlen )
+		dbb = JNI_newDirectByteBuffer(buffer->data, buffer->maxlen);
+
+	p2l.longVal = 0L; /* ensure that the rest is zeroed out */
+	p2l.ptrVal = buffer;
+	JNI_callVoidMethod(pool->stream, s_SQLOutputToChunk_reset,
+		p2l.longVal, dbb, (jint)buffer->len);
+	if ( NULL != dbb )
+		JNI_deleteLocalRef(dbb);
+	return pool->stream;
+}
+
+void SQLOutputToChunk_release(SQLOutputToChunkPool *pool,
+	jobject stream, StringInfo buffer)
+{
+	pool->averageLen += (buffer->len - pool->averageLen) / 8;
+
+	if ( buffer != &pool->buffer )
+	{
+		JNI_deleteLocalRef(stream);
+		return;
+	}
+
+	pool->busy = false;
+	pool->javaData = pool->buffer.data;
+	pool->javaMaxlen = pool->buffer.maxlen;
+	if ( pool->buffer.maxlen / KEEP_FACTOR <= Max(pool->averageLen, 1024) )
+		return;
+
+	/*
+	 * Let the buffer go; the Java writer's ByteBuffer over it goes too, so the
+	 * next use will make both anew.
+	 */
+	JNI_deleteGlobalRef(pool->stream);
+	pool->stream = NULL;
+	pfree(pool->buffer.data);
+	pool->buffer.data = NULL;
+}
+
+void SQLOutputToChunk_abandon(SQLOutputToChunkPool *pool, StringInfo buffer)
+{
+	if ( buffer == &pool->buffer )
+		pool->busy = false;
+}
+
 /* Make this datatype available to the postgres system.
  */
 extern void SQLOutputToChunk_initialize(void);
@@ -59,6 +163,8 @@ void SQLOutputToChunk_initialize(void)
 	s_SQLOutputToChunk_init = PgObject_getJavaMethod(s_SQLOutputToChunk_class,
 		"<init>", "(JLjava/nio/ByteBuffer;Z)V");
 	s_SQLOutputToChunk_close = PgObject_getJavaMethod(s_SQLOutputToChunk_class, "close", "()V");
+	s_SQLOutputToChunk_reset = PgObject_getJavaMethod(
+		s_SQLOutputToChunk_class, "reset", "(JLjava/nio/ByteBuffer;I)V");
 
 	Buffer_class = PgObject_getJavaClass("java/nio/Buffer");
 	s_Buffer_position = PgObject_getJavaMethod(Buffer_class, "position",
@@ -0,0 +1,377 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+#include <postgres.h>
+#include <access/genam.h>
+#include <access/heapam.h>
+#include <access/htup_details.h>
+#include <access/nbtree.h>
+#include <catalog/pg_am.h>
+#include <catalog/pg_amproc.h>
+#include <catalog/pg_opfamily.h>
+#include <lib/hyperloglog.h>
+#include <utils/datum.h>
+#include <utils/lsyscache.h>
+#include <utils/memutils.h>
+#include <utils/rel.h>
+#include <utils/syscache.h>
+#if PG_VERSION_NUM >= 120000
+#include <access/table.h>
+#endif
+#if PG_VERSION_NUM >= 130000
+#include <common/hashfn.h>
+#else
+#include <access/hash.h>
+#endif
+
+#include "pljava/Function.h"
+#include "pljava/Invocation.h"
+#include "pljava/JNICalls.h"
+#include "pljava/SortSupport.h"
+#include "pljava/type/Type.h"
+#include "pljava/type/UDT.h"
+
+#if PG_VERSION_NUM < 120000
+#define table_open(r, l) heap_open((r), (l))
+#define table_close(r, l) heap_close((r), (l))
+#endif
+
+/*
+ * Values decoded for full comparisons are kept in a small direct-mapped cache,
+ * indexed by the Datum (a pointer, for a by-reference type) and confirmed by
+ * comparing the stored bytes with a copy, as the memory behind a pointer can
+ * be reused for another value during a sort. Sorting calls for the same value
+ * many times in a row (a pivot, the head of a run being merged), which is the
+ * case the cache serves.
+ *
+ * Each comparison has its own Invocation, so a value kept in the cache outlives
+ * the one it was decoded in. Only values of immutable Java classes, holding
+ * nothing released as an Invocation exits, are kept: not, for example, a jsonb
+ * or SQLXML value, which is a view invalidated with its Invocation.
+ */
+#define DECODED_SLOTS_LOG2 6
+#define DECODED_SLOTS (1 << DECODED_SLOTS_LOG2)
+
+/*
+ * Abbreviated keys are given up when, after this many rows, fewer than one in
+ * ABBREV_MIN_RATIO of them have distinct keys; and are kept for good once
+ * ABBREV_ENOUGH distinct keys have been seen.
+ */
+#define ABBREV_MIN_ROWS  10000
+#define ABBREV_MIN_RATIO 2000.0
+#define ABBREV_ENOUGH    100000.0
+
+typedef struct
+{
+	bool    valid;
+	Datum   datum;   /* the value if by value, else a copy in the sort's cxt */
+	jobject value;   /* global reference to the decoded value */
+} DecodedSlot;
+
+typedef struct
+{
+	jobject               provider;
+	Type                  type;
+	int16                 typlen;
+	bool                  typbyval;
+	bool                  cacheDecoded;
+	bool                  estimating;
+	MemoryContext         cxt;
+	hyperLogLogState      abbrCard;
+	MemoryContextCallback cb;
+	DecodedSlot           slots[DECODED_SLOTS];
+} SortState;
+
+static void releaseState(void *arg)
+{
+	SortState *st = (SortState *)arg;
+	int i;
+
+	for ( i = 0 ; i < DECODED_SLOTS ; ++ i )
+		if ( st->slots[i].valid )
+			JNI_deleteGlobalRef(st->slots[i].value);
+	JNI_deleteGlobalRef(st->provider);
+}
+
+static inline uint32 slotIndex(Datum d)
+{
+	return (uint32)(((uint64)d * UINT64CONST(0x9E3779B97F4A7C15))
+		>> (64 - DECODED_SLOTS_LOG2));
+}
+
+/*
+ * Java classes whose instances, as decoded, are immutable and hold only Java
+ * heap state, so may be kept from one comparison's Invocation to another's.
+ */
+static const char *s_immutableClasses[] =
+{
+	"java.lang.String",
+	"java.math.BigDecimal",
+	"java.lang.Boolean",
+	"java.lang.Byte",
+	"java.lang.Short",
+	"java.lang.Integer",
+	"java.lang.Long",
+	"java.lang.Float",
+	"java.lang.Double",
+	"java.time.LocalDate",
+	"java.time.LocalTime",
+	"java.time.LocalDateTime",
+	"java.time.OffsetTime",
+	"java.time.OffsetDateTime",
+	NULL
+};
+
+static bool decodesImmutably(Type t)
+{
+	const char *name = Type_getJavaTypeName(t);
+	const char **cp;
+
+	if ( UDT_isDecodeCached(t) )
+		return true;
+	if ( NULL == name )
+		return false;
+	for ( cp = s_immutableClasses ; NULL != *cp ; ++ cp )
+		if ( 0 == strcmp(*cp, name) )
+			return true;
+	return false;
+}
+
+/*
+ * Return the decoded value of d, from the cache if there, otherwise decoding it
+ * and caching it, unless its slot is the one given as keep (holding the other
+ * operand of the same comparison), or values of this type are not cached, when
+ * the result is only a local reference. Called within a pushed Invocation,
+ * whose local frame takes care of that.
+ */
+static jobject decoded(SortState *st, Datum d, DecodedSlot **used)
+{
+	DecodedSlot *keep = *used;
+	DecodedSlot *slot = &st->slots[slotIndex(d)];
+	MemoryContext oldcxt;
+	jobject value;
+
+	if ( ! st->cacheDecoded )
+		return Type_coerceDatum(st->type, d).l;
+
+	*used = slot;
+
+	if ( slot->valid  &&  datumIsEqual(slot->datum, d, st->typbyval, st->typlen) )
+		return slot->value;
+
+	value = Type_coerceDatum(st->type, d).l;
+	if ( slot == keep )
+		return value;
+
+	if ( slot->valid )
+	{
+		JNI_deleteGlobalRef(slot->value);
+		if ( ! st->typbyval )
+			pfree(DatumGetPointer(slot->datum));
+		slot->valid = false;
+	}
+
+	oldcxt = MemoryContextSwitchTo(st->cxt);
+	slot->datum = datumCopy(d, st->typbyval, st->typlen);
+	MemoryContextSwitchTo(oldcxt);
+	slot->value = JNI_newGlobalRef(value);
+	slot->valid = true;
+	JNI_deleteLocalRef(value);
+	return slot->value;
+}
+
+/*
+ * The full comparison: decode both values (or find them decoded) and call the
+ * provider's compare method.
+ */
+static int compareFull(Datum a, Datum b, SortSupport ssup)
+{
+	SortState *st = (SortState *)ssup->ssup_extra;
+	Invocation ctx;
+	jint result = 0;
+
+	Invocation_pushInvocation(&ctx);
+	PG_TRY();
+	{
+		DecodedSlot *used = NULL;
+		jobject va = decoded(st, a, &used);
+		jobject vb = decoded(st, b, &used);
+		result = pljava_Function_sortSupportCompare(st->provider, va, vb);
+		Invocation_popInvocation(false);
+	}
+	PG_CATCH();
+	{
+		Invocation_popInvocation(true);
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+
+	return ( 0 < result ) - ( 0 > result );
+}
+
+#if SIZEOF_DATUM >= 8
+/*
+ * Comparison of two abbreviated keys, as signed 64-bit integers, done without
+ * calling Java.
+ */
+static int compareAbbrev(Datum x, Datum y, SortSupport ssup)
+{
+	int64 a = DatumGetInt64(x);
+	int64 b = DatumGetInt64(y);
+
+	return ( a > b ) - ( a < b );
+}
+
+/*
+ * Make the abbreviated key for one value, once per value sorted.
+ */
+static Datum abbrevConvert(Datum original, SortSupport ssup)
+{
+	SortState *st = (SortState *)ssup->ssup_extra;
+	Invocation ctx;
+	jlong key = 0;
+
+	Invocation_pushInvocation(&ctx);
+	PG_TRY();
+	{
+		jobject value = Type_coerceDatum(st->type, original).l;
+		key = pljava_Function_sortSupportAbbreviate(st->provider, value);
+		Invocation_popInvocation(false);
+	}
+	PG_CATCH();
+	{
+		Invocation_popInvocation(true);
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+
+	if ( st->estimating )
+	{
+		uint32 h = (uint32)key ^ (uint32)((uint64)key >> 32);
+		addHyperLogLog(&st->abbrCard, DatumGetUInt32(hash_uint32(h)));
+	}
+
+	return Int64GetDatum(key);
+}
+
+/*
+ * Whether to give up on abbreviated keys, judged as PostgreSQL's own types
+ * judge it, by an estimate of how many distinct keys there have been.
+ */
+static bool abbrevAbort(int memtupcount, SortSupport ssup)
+{
+	SortState *st = (SortState *)ssup->ssup_extra;
+	double card;
+
+	if ( ! st->estimating  ||  memtupcount < ABBREV_MIN_ROWS )
+		return false;
+
+	card = estimateHyperLogLog(&st->abbrCard);
+
+	if ( card > ABBREV_ENOUGH )
+	{
+		st->estimating = false;
+		return false;
+	}
+
+	return card < memtupcount / ABBREV_MIN_RATIO;
+}
+#endif
+
+void pljava_SortSupport_prepare(
+	SortSupport ssup, jobject provider, Oid typeId, jobject typeMap)
+{
+	MemoryContext oldcxt = MemoryContextSwitchTo(ssup->ssup_cxt);
+	SortState *st = (SortState *)palloc0(sizeof (SortState));
+
+	st->provider = JNI_newGlobalRef(provider);
+	st->type = Type_objectTypeFromOid(typeId, typeMap);
+	get_typlenbyval(typeId, &st->typlen, &st->typbyval);
+	st->cacheDecoded = decodesImmutably(st->type);
+	st->cxt = ssup->ssup_cxt;
+	st->cb.func = releaseState;
+	st->cb.arg = st;
+	MemoryContextRegisterResetCallback(ssup->ssup_cxt, &st->cb);
+
+	ssup->ssup_extra = st;
+	ssup->comparator = compareFull;
+
+	/*
+	 * An abbreviated key is a Java long, so there are none where a Datum is
+	 * narrower.
+	 */
+#if SIZEOF_DATUM >= 8
+	if ( ssup->abbreviate
+		&&  JNI_TRUE == pljava_Function_sortSupportAbbreviates(provider) )
+	{
+		initHyperLogLog(&st->abbrCard, 10);
+		st->estimating = true;
+		ssup->comparator = compareAbbrev;
+		ssup->abbrev_converter = abbrevConvert;
+		ssup->abbrev_abort = abbrevAbort;
+		ssup->abbrev_full_comparator = compareFull;
+	}
+#endif
+
+	MemoryContextSwitchTo(oldcxt);
+}
+
+Oid pljava_SortSupport_typeFor(Oid funcOid)
+{
+	Relation rel;
+	SysScanDesc scan;
+	HeapTuple tup;
+	Oid result = InvalidOid;
+
+	/*
+	 * pg_amproc has no index on amproc, but is small, and this is done once
+	 * as each sort is set up.
+	 */
+	rel = table_open(AccessMethodProcedureRelationId, AccessShareLock);
+	scan = systable_beginscan(rel, InvalidOid, false, NULL, 0, NULL);
+	while ( HeapTupleIsValid(tup = systable_getnext(scan)) )
+	{
+		Form_pg_amproc amproc = (Form_pg_amproc)GETSTRUCT(tup);
+		HeapTuple famTup;
+		bool btree;
+
+		if ( funcOid != amproc->amproc
+			||  BTSORTSUPPORT_PROC != amproc->amprocnum )
+			continue;
+
+		famTup = SearchSysCache1(OPFAMILYOID,
+			ObjectIdGetDatum(amproc->amprocfamily));
+		if ( ! HeapTupleIsValid(famTup) )
+			continue;
+		btree =
+			BTREE_AM_OID == ((Form_pg_opfamily)GETSTRUCT(famTup))->opfmethod;
+		ReleaseSysCache(famTup);
+		if ( ! btree )
+			continue;
+
+		if ( OidIsValid(result)  &&  result != amproc->amproclefttype )
+			ereport(ERROR, (
+				errcode(ERRCODE_INVALID_OBJECT_DEFINITION),
+				errmsg("PL/Java sortsupport function %u is named by btree "
+					"operator classes for more than one type", funcOid)));
+		result = amproc->amproclefttype;
+	}
+	systable_endscan(scan);
+	table_close(rel, AccessShareLock);
+
+	if ( ! OidIsValid(result) )
+		ereport(ERROR, (
+			errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+			errmsg("PL/Java sortsupport function %u is not named by any "
+				"btree operator class", funcOid)));
+
+	return result;
+}
@@ -24,6 +24,29 @@ static void subXactCB(
 	SubXactEvent event, SubTransactionId mySubid, SubTransactionId parentSubid,
 	void* arg)
 {
+	jobject sp;
+	jobject parent;
+
+	/*
+	 * This callback is only registered while some Java listener is (see
+	 * SubXactListener.java). Even so, the Java savepoint lookups below are
+	 * upcalls, so make them only for an event that will be passed to Java.
+	 *
+	 * The event ordinal can simply be passed to Java, as long as upstream
+	 * hasn't changed the order; list the known ones in a switch, for a better
+	 * chance that a clever compiler will warn if upstream has added any.
+	 */
+	switch(event)
+	{
+		case SUBXACT_EVENT_START_SUB:
+		case SUBXACT_EVENT_COMMIT_SUB:
+		case SUBXACT_EVENT_ABORT_SUB:
+		case SUBXACT_EVENT_PRE_COMMIT_SUB:
+			break;
+		default:
+			return;
+	}
+
 	/*
 	 * Map the subids to PgSavepoints first - this function upcalls into Java
 	 * without releasing the Backend.THREADLOCK monitor, so the called methods
@@ -32,29 +55,18 @@ static void subXactCB(
 	 * a new PgSavepoint instance is under construction in the 'nursery', and
 	 * will be assigned the first id to be looked up.
 	 */
-	jobject     sp = pljava_PgSavepoint_forId(mySubid);
-	jobject parent = pljava_PgSavepoint_forId(parentSubid);
+	sp = pljava_PgSavepoint_forId(mySubid);
+	parent = pljava_PgSavepoint_forId(parentSubid);
 
 	/*
-	 * These upcalls are made with the monitor released. We are, of course, ON
+	 * This upcall is made with the monitor released. We are, of course, ON
 	 * the PG thread, but this time with no monitor held to prevent another
 	 * thread from stepping in. These methods should not blindly assert
 	 * Backend.threadMayEnterPG(), as for some java_thread_pg_entry settings it
 	 * won't be true. This is the legacy behavior, so not changed for 1.5.x.
-	 *
-	 * The event ordinal can simply be passed to Java, as long as upstream
-	 * hasn't changed the order; list the known ones in a switch, for a better
-	 * chance that a clever compiler will warn if upstream has added any.
 	 */
-	switch(event)
-	{
-		case SUBXACT_EVENT_START_SUB:
-		case SUBXACT_EVENT_COMMIT_SUB:
-		case SUBXACT_EVENT_ABORT_SUB:
-		case SUBXACT_EVENT_PRE_COMMIT_SUB:
-			JNI_callStaticVoidMethod(s_SubXactListener_class,
-				s_SubXactListener_invokeListeners, (jint)event, sp, parent);
-	}
+	JNI_callStaticVoidMethod(s_SubXactListener_class,
+		s_SubXactListener_invokeListeners, (jint)event, sp, parent);
 }
 
 extern void SubXactListener_initialize(void);
@@ -56,4 +56,6 @@ JNIEXPORT void JNICALL Java_org_postgresql_pljava_jdbc_TypeOid__1dummy(JNIEnv *
 #endif
 
 	CONFIRMCONST(TRIGGEROID);
+	CONFIRMCONST(VOIDOID);
+	CONFIRMCONST(INTERNALOID);
 }
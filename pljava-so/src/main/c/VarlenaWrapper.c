@@ -16,6 +16,7 @@
 #if PG_VERSION_NUM < 130000
 #include <access/tuptoaster.h>
 #define detoast_external_attr heap_tuple_fetch_attr
+#define detoast_attr_slice heap_tuple_untoast_attr_slice
 #else
 #include <access/detoast.h>
 #endif
@@ -29,9 +30,11 @@
 #include <utils/snapmgr.h>
 #endif
 
+#include "org_postgresql_pljava_internal_VarlenaWrapper_Input.h"
 #include "org_postgresql_pljava_internal_VarlenaWrapper_Input_State.h"
 #include "org_postgresql_pljava_internal_VarlenaWrapper_Output_State.h"
 #include "pljava/VarlenaWrapper.h"
+#include "pljava/Backend.h"
 #include "pljava/DualState.h"
 
 #include "pljava/PgObject.h"
@@ -79,6 +82,33 @@ do { \
 
 #define INITIALSIZE 1024
 
+/*
+ * Sizing of the nodes added as a VarlenaWrapper.Output is written: each is
+ * an eighth of what has been written so far, within these bounds, so a long
+ * value takes few trips through _nextBuffer and leaves at most about an eighth
+ * of its size unused in its last node.
+ */
+#define NODE_MINSIZE 8180
+#define NODE_MAXSIZE (64 * 1024 * 1024)
+
+/*
+ * A VarlenaWrapper.Output whose content reaches this size is flattened, as it
+ * is adopted, in place of the "expanded" nodes, which are freed as their
+ * content is moved, rather than left for PostgreSQL to flatten into a second
+ * full copy. Smaller ones stay in the expanded form.
+ */
+#define FLATTEN_IN_PLACE_SIZE (1024 * 1024)
+
+/*
+ * Counts of the paths taken by pljava_VarlenaWrapper_Input, and of parked
+ * values later detoasted for reading, for tuning pljava.varlena_eager_size
+ * and pljava.varlena_park_ratio.
+ */
+static uint64 s_eagerCount;
+static uint64 s_parkedCount;
+static uint64 s_parkedCompressedCount;
+static uint64 s_detoastedCount;
+
 static jclass s_VarlenaWrapper_class;
 static jmethodID s_VarlenaWrapper_adopt;
 
@@ -137,6 +167,10 @@ static Size VOS_get_flat_size(ExpandedObjectHeader *eohptr);
 static void VOS_flatten_into(ExpandedObjectHeader *eohptr,
 		void *result, Size allocated_size);
 
+typedef struct ExpandedVarlenaOutputStreamHeader
+	ExpandedVarlenaOutputStreamHeader;
+static void *VOS_flatten_in_place(ExpandedVarlenaOutputStreamHeader *evosh);
+
 static const ExpandedObjectMethods VOS_methods =
 {
 	VOS_get_flat_size,
@@ -151,12 +185,12 @@ struct ExpandedVarlenaOutputStreamNode
 	Size size;
 };
 
-typedef struct ExpandedVarlenaOutputStreamHeader
+struct ExpandedVarlenaOutputStreamHeader
 {
 	ExpandedObjectHeader hdr;
 	ExpandedVarlenaOutputStreamNode *tail;
 	Size total_size;
-} ExpandedVarlenaOutputStreamHeader;
+};
 
 
 
@@ -207,7 +241,8 @@ jobject pljava_VarlenaWrapper_Input(
 
 	prevcxt = MemoryContextSwitchTo(mc);
 
-	if ( actual < 4096  ||  (actual >> 1) < parked )
+	if ( actual < Backend_getVarlenaEagerSize()  ||  parked * 100 >
+		actual * (uint64)Backend_getVarlenaParkRatio() )
 		goto justDetoastEagerly;
 	if ( VARATT_IS_EXTERNAL_EXPANDED(vl) )
 		goto justDetoastEagerly;
@@ -224,11 +259,13 @@ jobject pljava_VarlenaWrapper_Input(
 			struct varatt_external toast_pointer;
 			VARATT_EXTERNAL_GET_POINTER(toast_pointer, vl);
 			parked = VARATT_EXTERNAL_GET_EXTSIZE(toast_pointer) + VARHDRSZ;
-			if ( (actual >> 1) < parked ) /* not compressed enough to bother */
+			if ( parked * 100 > /* not compressed enough to bother */
+				actual * (uint64)Backend_getVarlenaParkRatio() )
 				goto justDetoastEagerly;
 			vl = detoast_external_attr(vl); /* fetch without decompressing */
 			d = PointerGetDatum(vl);
 			dbb = NULL;
+			++ s_parkedCompressedCount;
 			goto constructResult;
 		}
 		pin = RegisterSnapshotOnOwner(pin, ro);
@@ -237,12 +274,14 @@ jobject pljava_VarlenaWrapper_Input(
 /* parkAndDetoastLazily: */
 	vl = (_VL_TYPE) DatumGetPointer(datumCopy(d, false, -1));
 	dbb = NULL;
+	++ s_parkedCount;
 	goto constructResult;
 
 justDetoastEagerly:
 	vl = (_VL_TYPE) PG_DETOAST_DATUM_COPY(d);
 	parked = actual + VARHDRSZ;
 	dbb = JNI_newDirectByteBuffer(VARDATA(vl), actual);
+	++ s_eagerCount;
 
 constructResult:
 	MemoryContextSwitchTo(prevcxt);
@@ -334,33 +373,33 @@ jobject pljava_VarlenaWrapper_Output(MemoryContext parent, ResourceOwner ro)
 /*
  * Adopt a VarlenaWrapper (if Output, after Java code has written and closed it)
  * and leave it no longer accessible from Java. It may be an 'expanded' datum,
- * in PG 9.5+ where there are such things. Otherwise, it will be an ordinary
- * flat one (the ersatz 'expanded' form used internally here then being only an
+ * in PG 9.5+ where there are such things, if it is smaller than
+ * FLATTEN_IN_PLACE_SIZE. Otherwise, it will be an ordinary flat one (the
+ * ersatz 'expanded' form used internally here then being only an
  * implementation detail, not exposed to the caller); its memory context is
  * unchanged.
  */
 Datum pljava_VarlenaWrapper_adopt(jobject vlw)
 {
 	Ptr2Long p2l;
-#if PG_VERSION_NUM < 90500
-	ExpandedObjectHeader *eohptr;
-	Size final_size;
-	void *final_result;
-#endif
+	ExpandedVarlenaOutputStreamHeader *evosh;
 
 	p2l.longVal = JNI_callLongMethodLocked(vlw, s_VarlenaWrapper_adopt,
 					pljava_DualState_key());
 #if PG_VERSION_NUM >= 90500
-	return PointerGetDatum(p2l.ptrVal);
+	if ( ! VARATT_IS_EXTERNAL_EXPANDED_RW(p2l.ptrVal) )
+		return PointerGetDatum(p2l.ptrVal);
+	evosh = (ExpandedVarlenaOutputStreamHeader *)
+		DatumGetEOHP(PointerGetDatum(p2l.ptrVal));
+	if ( &VOS_methods != evosh->hdr.eoh_methods
+		||  FLATTEN_IN_PLACE_SIZE > evosh->total_size )
+		return PointerGetDatum(p2l.ptrVal);
 #else
-	eohptr = p2l.ptrVal;
-	if ( -1 != eohptr->magic )
-		return PointerGetDatum(eohptr);
-	final_size = VOS_get_flat_size(eohptr);
-	final_result = MemoryContextAlloc(eohptr->eoh_context, final_size);
-	VOS_flatten_into(eohptr, final_result, final_size);
-	return PointerGetDatum(final_result);
+	evosh = p2l.ptrVal;
+	if ( -1 != evosh->hdr.magic )
+		return PointerGetDatum(evosh);
 #endif
+	return PointerGetDatum(VOS_flatten_in_place(evosh));
 }
 
 static Size VOS_get_flat_size(ExpandedObjectHeader *eohptr)
@@ -376,9 +415,6 @@ static void VOS_flatten_into(ExpandedObjectHeader *eohptr,
 	ExpandedVarlenaOutputStreamHeader *evosh =
 		(ExpandedVarlenaOutputStreamHeader *)eohptr;
 	ExpandedVarlenaOutputStreamNode *node = evosh->tail;
-#if PG_VERSION_NUM < 90500
-	ExpandedVarlenaOutputStreamNode *next;
-#endif
 
 	Assert(allocated_size == evosh->total_size);
 	SET_VARSIZE(result, allocated_size);
@@ -391,25 +427,45 @@ static void VOS_flatten_into(ExpandedObjectHeader *eohptr,
 		result = (char *)result + node->size;
 	}
 	while ( node != evosh->tail );
+}
+
+/*
+ * Flatten the content into one varlena in the same context, and free the
+ * expanded object, which is no longer usable. Rather than allocate the whole
+ * result and then copy the nodes in, the result is grown by repalloc for each
+ * node and the node freed once copied, so the memory in use stays near the
+ * size of the content plus one node. (Past the chunk size limit of the memory
+ * context, each node and the result are blocks of their own, and growing the
+ * result is a realloc, which for large sizes the C library can generally do by
+ * remapping, not copying, what is there.)
+ */
+static void *VOS_flatten_in_place(ExpandedVarlenaOutputStreamHeader *evosh)
+{
+	ExpandedVarlenaOutputStreamNode *head = evosh->tail->next;
+	ExpandedVarlenaOutputStreamNode *node;
+	ExpandedVarlenaOutputStreamNode *next;
+	Size used = VARHDRSZ + head->size;
+	char *result = MemoryContextAlloc(evosh->hdr.eoh_context, used);
+
+	memcpy(result + VARHDRSZ, head + 1, head->size);
 
-#if PG_VERSION_NUM < 90500
 	/*
-	 * It's been flattened into the same context; the original nodes can be
-	 * freed so the 2x memory usage doesn't last longer than necessary. Freeing
-	 * them retail isn't ideal, but this is back-compatibility code. Remember
-	 * the first one wasn't a separate allocation.
+	 * The head node was not a separate allocation, but part of evosh itself,
+	 * which goes last.
 	 */
-	 node = node->next; /* this is the head, the one that can't be pfreed */
-	 evosh->tail = node; /* tail is now head, the non-pfreeable node */
-	 node = node->next;
-	 while ( node != evosh->tail )
-	 {
+	for ( node = head->next ; node != head ; node = next )
+	{
 		next = node->next;
+		result = repalloc(result, used + node->size);
+		memcpy(result + used, node + 1, node->size);
+		used += node->size;
 		pfree(node);
-		node = next;
-	 }
-	 pfree(evosh);
-#endif
+	}
+
+	Assert(used == evosh->total_size);
+	SET_VARSIZE(result, used);
+	pfree(evosh);
+	return result;
 }
 
 void pljava_VarlenaWrapper_initialize(void)
@@ -432,6 +488,20 @@ void pljava_VarlenaWrapper_initialize(void)
 		"(JJ)J",
 		Java_org_postgresql_pljava_internal_VarlenaWrapper_00024Input_00024State__1fetch
 		},
+		{
+		"_slice",
+		"(JJI)[B",
+		Java_org_postgresql_pljava_internal_VarlenaWrapper_00024Input_00024State__1slice
+		},
+		{ 0, 0, 0 }
+	};
+	JNINativeMethod methodsInStatic[] =
+	{
+		{
+		"_statistics",
+		"()[J",
+		Java_org_postgresql_pljava_internal_VarlenaWrapper_00024Input__1statistics
+		},
 		{ 0, 0, 0 }
 	};
 	JNINativeMethod methodsOut[] =
@@ -468,6 +538,8 @@ void pljava_VarlenaWrapper_initialize(void)
 		s_VarlenaWrapper_class, "adopt",
 		"(Lorg/postgresql/pljava/internal/DualState$Key;)J");
 
+	PgObject_registerNatives2(s_VarlenaWrapper_Input_class, methodsInStatic);
+
 	clazz = PgObject_getJavaClass(
 			"org/postgresql/pljava/internal/VarlenaWrapper$Input$State");
 
@@ -486,6 +558,31 @@ void pljava_VarlenaWrapper_initialize(void)
 	JNI_deleteLocalRef(clazz);
 }
 
+/*
+ * Class:     org_postgresql_pljava_internal_VarlenaWrapper_Input
+ * Method:    _statistics
+ * Signature: ()[J
+ */
+JNIEXPORT jlongArray JNICALL
+Java_org_postgresql_pljava_internal_VarlenaWrapper_00024Input__1statistics
+  (JNIEnv *env, jclass cls)
+{
+	jlongArray result = NULL;
+	jlong counts[4];
+
+	counts[0] = (jlong)s_eagerCount;
+	counts[1] = (jlong)s_parkedCount;
+	counts[2] = (jlong)s_parkedCompressedCount;
+	counts[3] = (jlong)s_detoastedCount;
+
+	BEGIN_NATIVE
+	result = JNI_newLongArray(4);
+	JNI_setLongArrayRegion(result, 0, 4, counts);
+	END_NATIVE
+
+	return result;
+}
+
 /*
  * Class:     org_postgresql_pljava_internal_VarlenaWrapper_Input_State
  * Method:    _unregisterSnapshot
@@ -538,6 +635,7 @@ Java_org_postgresql_pljava_internal_VarlenaWrapper_00024Input_00024State__1detoa
 	prevcxt = MemoryContextSwitchTo((MemoryContext)p2lcxt.ptrVal);
 
 	detoasted = (_VL_TYPE) PG_DETOAST_DATUM_COPY(PointerGetDatum(p2lvl.ptrVal));
+	++ s_detoastedCount;
 	p2ldetoasted.longVal = 0L;
 	p2ldetoasted.ptrVal = detoasted;
 
@@ -624,11 +722,12 @@ Java_org_postgresql_pljava_internal_VarlenaWrapper_00024Output_00024State__1next
 
 	BEGIN_NATIVE
 	/*
-	 * This adjustment of desiredCapacity is arbitrary and amenable to
-	 * performance experimentation. For initial signs of life, ignore the
-	 * desiredCapacity hint completely and use a hardwired size.
+	 * The desiredCapacity hint is only what the current write call has left
+	 * to write, so the node size is instead chosen from what has been written
+	 * so far; see NODE_MINSIZE.
 	 */
-	desiredCapacity = 8180;
+	desiredCapacity = (jint)Min(Max(evosh->total_size / 8, NODE_MINSIZE),
+		NODE_MAXSIZE);
 
 	node = (ExpandedVarlenaOutputStreamNode *)
 			MemoryContextAlloc(evosh->hdr.eoh_context, desiredCapacity);
@@ -641,3 +740,36 @@ Java_org_postgresql_pljava_internal_VarlenaWrapper_00024Output_00024State__1next
 
 	return dbb;
 }
+
+/*
+ * Class:     org_postgresql_pljava_internal_VarlenaWrapper_Input_State
+ * Method:    _slice
+ * Signature: (JJI)[B
+ *
+ * Return a range of the bytes of a parked value without detoasting the whole:
+ * for a value stored out of line and uncompressed, only the TOAST chunks that
+ * hold the range are fetched; for a compressed one, only as much as precedes
+ * the end of the range is decompressed. The parked value is left as it was.
+ */
+JNIEXPORT jbyteArray JNICALL
+Java_org_postgresql_pljava_internal_VarlenaWrapper_00024Input_00024State__1slice
+  (JNIEnv *env, jobject _this, jlong varlena, jlong offset, jint length)
+{
+	Ptr2Long p2lvl;
+	_VL_TYPE slice;
+	jsize got;
+	jbyteArray result = NULL;
+
+	BEGIN_NATIVE
+	p2lvl.longVal = varlena;
+	slice = (_VL_TYPE) detoast_attr_slice(
+		(_VL_TYPE) p2lvl.ptrVal, (int32) offset, (int32) length);
+	got = VARSIZE_ANY_EXHDR(slice);
+	result = JNI_newByteArray(got);
+	JNI_setByteArrayRegion(result, 0, got, (jbyte *)VARDATA_ANY(slice));
+	if ( slice != p2lvl.ptrVal )
+		pfree(slice);
+	END_NATIVE
+
+	return result;
+}
@@ -48,6 +48,14 @@ case XACT_EVENT_##c: \
 #endif
 	}
 
+	/*
+	 * The callback is only registered while some Java listener is (see
+	 * XactListener.java), but there is no Java method to call for an event not
+	 * known here, so don't make the upcall only to have it fail.
+	 */
+	if ( -1 == mapped )
+		return;
+
 	JNI_callStaticVoidMethod(s_XactListener_class,
 		s_XactListener_invokeListeners, mapped);
 }
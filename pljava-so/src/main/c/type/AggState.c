@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+#include <postgres.h>
+#include <fmgr.h>
+#include <utils/memutils.h>
+
+#include "pljava/type/Type_priv.h"
+#include "pljava/Function.h"
+
+/*
+ * The PostgreSQL type internal, as the state type of an aggregate whose
+ * functions are in PL/Java, mapped to java.lang.Object.
+ *
+ * The state value is a small holder, allocated in the aggregate context, of a
+ * global reference to the Java state object, which is released when that
+ * context is reset at the end of the group. Passing the state to a transition
+ * or final function is just passing that reference; nothing is serialized.
+ * When a transition (or combine) function returns the same object it was
+ * passed, the same holder is returned, so updating the state in place from row
+ * to row costs no allocation at all. An aggregate with such a state can be
+ * parallel only with serialize and deserialize functions, as for any state of
+ * type internal.
+ *
+ * A value of this type can be made only by a function called as part of an
+ * aggregate.
+ */
+
+#if PG_VERSION_NUM >= 90500
+
+#define AGGSTATE_MAGIC 0x4A617641 /* "JavaA" less the last letter */
+
+typedef struct
+{
+	uint32                magic;
+	jobject               state;
+	MemoryContextCallback cb;
+} AggStateHolder;
+
+static void releaseHolder(void *arg)
+{
+	AggStateHolder *holder = (AggStateHolder *)arg;
+	if ( NULL != holder->state )
+		JNI_deleteGlobalRef(holder->state);
+	holder->state = NULL;
+	holder->magic = 0;
+}
+
+static AggStateHolder *holderOf(Datum d)
+{
+	AggStateHolder *holder = (AggStateHolder *)DatumGetPointer(d);
+	if ( NULL == holder  ||  AGGSTATE_MAGIC != holder->magic )
+		ereport(ERROR, (
+			errcode(ERRCODE_DATA_EXCEPTION),
+			errmsg("value of type internal passed to PL/Java is not "
+				"a PL/Java aggregate state")));
+	return holder;
+}
+
+static jvalue _AggState_coerceDatum(Type self, Datum arg)
+{
+	jvalue result;
+	result.l = holderOf(arg)->state;
+	return result;
+}
+
+static Datum _AggState_coerceObject(Type self, jobject value)
+{
+	ereport(ERROR, (
+		errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+		errmsg("PL/Java can produce a value of type internal only as "
+			"the result of an aggregate support function")));
+	return 0; /* not reached */
+}
+
+static Datum _AggState_invoke(Type self, Function fn, PG_FUNCTION_ARGS)
+{
+	MemoryContext aggContext;
+	AggStateHolder *holder;
+	jobject value = pljava_Function_refInvoke(fn);
+
+	if ( NULL == value )
+	{
+		fcinfo->isnull = true;
+		return 0;
+	}
+
+	if ( 0 == AggCheckCallContext(fcinfo, &aggContext) )
+		ereport(ERROR, (
+			errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+			errmsg("PL/Java function returning type internal called "
+				"other than as part of an aggregate")));
+
+	/*
+	 * A transition or combine function passed its state as the first argument;
+	 * if it is returning the same object, return the same holder. If it is
+	 * returning a new one, the old holder's reference can go now rather than at
+	 * the end of the group.
+	 */
+	if ( 0 < PG_NARGS()  &&  ! PG_ARGISNULL(0)
+		&&  self == pljava_Function_paramType(fn, 0) )
+	{
+		holder = holderOf(PG_GETARG_DATUM(0));
+		if ( JNI_isSameObject(holder->state, value) )
+		{
+			JNI_deleteLocalRef(value);
+			return PG_GETARG_DATUM(0);
+		}
+		JNI_deleteGlobalRef(holder->state);
+		holder->state = NULL;
+	}
+
+	holder = (AggStateHolder *)
+		MemoryContextAlloc(aggContext, sizeof (AggStateHolder));
+	holder->magic = AGGSTATE_MAGIC;
+	holder->state = JNI_newGlobalRef(value);
+	holder->cb.func = releaseHolder;
+	holder->cb.arg = holder;
+	MemoryContextRegisterResetCallback(aggContext, &holder->cb);
+	JNI_deleteLocalRef(value);
+	return PointerGetDatum(holder);
+}
+
+#endif
+
+/* Make this datatype available to the postgres system.
+ */
+extern void AggState_initialize(void);
+void AggState_initialize(void)
+{
+#if PG_VERSION_NUM >= 90500
+	TypeClass cls = TypeClass_alloc("type.AggState");
+	cls->JNISignature = "Ljava/lang/Object;";
+	cls->javaTypeName = "java.lang.Object";
+	cls->invoke       = _AggState_invoke;
+	cls->coerceDatum  = _AggState_coerceDatum;
+	cls->coerceObject = _AggState_coerceObject;
+	Type_registerType(0, TypeClass_allocInstance(cls, INTERNALOID));
+#endif
+}
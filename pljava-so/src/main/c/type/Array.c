@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2004-2020 Tada AB and other contributors, as listed below.
+ * Copyright (c) 2004-2026 Tada AB and other contributors, as listed below.
  *
  * All rights reserved. This program and the accompanying materials
  * are made available under the terms of the The BSD 3-Clause License
@@ -13,6 +13,48 @@
 #include "pljava/type/Type_priv.h"
 #include "pljava/type/Array.h"
 #include "pljava/Invocation.h"
+#include "pljava/Function.h"
+
+#include <utils/lsyscache.h>
+
+#if PG_VERSION_NUM >= 90500
+#include <utils/array.h>
+#include <utils/expandeddatum.h>
+#endif
+
+/*
+ * The arrays of boxed numeric types that are unboxed in bulk by
+ * BoxedArrays.unbox, on the way from Java to PostgreSQL.
+ */
+typedef struct
+{
+	const char* javaTypeName;
+	const char* arrayClassName;
+	const char* unboxSignature;
+	char        sig;
+	size_t      elemSize;
+	jclass      arrayClass;
+	jmethodID   unbox;
+} BoxedKind;
+
+static BoxedKind s_boxedKinds[] =
+{
+	{ "java.lang.Short",   "[Ljava/lang/Short;",
+		"([Ljava/lang/Short;[S[Z)I",   'S', sizeof(jshort) },
+	{ "java.lang.Integer", "[Ljava/lang/Integer;",
+		"([Ljava/lang/Integer;[I[Z)I", 'I', sizeof(jint) },
+	{ "java.lang.Long",    "[Ljava/lang/Long;",
+		"([Ljava/lang/Long;[J[Z)I",    'J', sizeof(jlong) },
+	{ "java.lang.Float",   "[Ljava/lang/Float;",
+		"([Ljava/lang/Float;[F[Z)I",   'F', sizeof(jfloat) },
+	{ "java.lang.Double",  "[Ljava/lang/Double;",
+		"([Ljava/lang/Double;[D[Z)I",  'D', sizeof(jdouble) }
+};
+
+static jclass s_BoxedArrays_class;
+
+static jarray _ArrayMD_newPrimitive(char sig, jsize n);
+static void _ArrayMD_getRegion(char sig, jarray a, jsize n, void* buf);
 
 void arraySetNull(bits8* bitmap, int offset, bool flag)
 {
@@ -29,22 +71,147 @@ bool arrayIsNull(const bits8* bitmap, int offset)
 	return bitmap == 0 ? false : !(bitmap[offset / 8] & (1 << (offset % 8)));
 }
 
+/*
+ * Null bitmap expansion and compaction for arrays of fixed-width elements.
+ *
+ * The data region of an array with nulls holds only its non-null elements,
+ * packed together. arrayExpandNulls copies nElems elements, starting at bit
+ * offset of bitmap, from the packed src to dest, with zero in place of each
+ * null, and returns the number of elements taken from src. arrayCompactNulls
+ * does the reverse for nElems elements of src, with isNull (one jboolean per
+ * element, as from Java) saying which are null: it packs the non-null ones
+ * into dest, sets the corresponding bits of bitmap, and returns the number
+ * packed.
+ *
+ * Both work a bitmap byte (eight elements) at a time. Runs of bytes with all
+ * bits set, or none, are moved with one memcpy or memset, which the C library
+ * implements with the widest vector instructions the processor has, so a
+ * sparse array costs little more than one without nulls. Only the elements
+ * in bytes of mixed bits are moved one at a time.
+ */
+int arrayExpandNulls(char* dest, const char* src, const bits8* bitmap,
+	int offset, int nElems, size_t elemSize)
+{
+	const char* start = src;
+	int idx = 0;
+
+	bitmap += offset / 8;
+	offset %= 8;
+
+	while(idx < nElems)
+	{
+		int run;
+
+		if(offset != 0 || nElems - idx < 8 || (*bitmap != 0xFF && *bitmap != 0))
+		{
+			/* one byte's worth, or what is left, bit by bit */
+			bits8 bits = *bitmap++;
+			for(; offset < 8 && idx < nElems; ++offset, ++idx)
+			{
+				if(bits & (1 << offset))
+				{
+					memcpy(dest, src, elemSize);
+					src += elemSize;
+				}
+				else
+					memset(dest, 0, elemSize);
+				dest += elemSize;
+			}
+			offset = 0;
+			continue;
+		}
+
+		for(run = 1; (run + 1) * 8 <= nElems - idx && bitmap[run] == *bitmap;)
+			++run;
+		if(*bitmap == 0xFF)
+		{
+			memcpy(dest, src, run * 8 * elemSize);
+			src += run * 8 * elemSize;
+		}
+		else
+			memset(dest, 0, run * 8 * elemSize);
+		dest += run * 8 * elemSize;
+		bitmap += run;
+		idx += run * 8;
+	}
+	return (int)((src - start) / elemSize);
+}
+
+int arrayCompactNulls(char* dest, bits8* bitmap, const char* src,
+	const jboolean* isNull, int nElems, size_t elemSize)
+{
+	const char* start = dest;
+	int idx = 0;
+
+	while(idx < nElems)
+	{
+		int bit;
+		int run = 0;
+		bits8 bits = 0;
+		uint64 eight;
+
+		/* eight jbooleans at a time: while none is true, extend the run */
+		while(nElems - idx - run * 8 >= 8)
+		{
+			memcpy(&eight, isNull + idx + run * 8, sizeof eight);
+			if(eight != 0)
+				break;
+			++run;
+		}
+		if(run > 0)
+		{
+			memcpy(dest, src, run * 8 * elemSize);
+			memset(bitmap, 0xFF, run);
+			dest += run * 8 * elemSize;
+			src += run * 8 * elemSize;
+			bitmap += run;
+			idx += run * 8;
+			continue;
+		}
+
+		for(bit = 0; bit < 8 && idx < nElems; ++bit, ++idx)
+		{
+			if(!isNull[idx])
+			{
+				bits |= 1 << bit;
+				memcpy(dest, src, elemSize);
+				dest += elemSize;
+			}
+			src += elemSize;
+		}
+		*bitmap++ = bits;
+	}
+	return (int)((dest - start) / elemSize);
+}
+
 ArrayType* createArrayType(jsize nElems, size_t elemSize, Oid elemType, bool withNulls)
+{
+	int dim = (int)nElems;
+	return createArrayTypeMD(1, &dim, elemSize, elemType, withNulls);
+}
+
+/*
+ * As createArrayType, but with ndim dimensions of the lengths in dims, all
+ * with lower bound 1.
+ */
+ArrayType* createArrayTypeMD(int ndim, const int* dims, size_t elemSize, Oid elemType, bool withNulls)
 {
 	ArrayType* v;
+	int idx;
+	int nElems = ArrayGetNItems(ndim, (int*)dims);
 	Size nBytes = elemSize * nElems;
 	MemoryContext currCtx = Invocation_switchToUpperContext();
 
 	Size dataoffset;
 	if(withNulls)
 	{
-		dataoffset = ARR_OVERHEAD_WITHNULLS(1, nElems);
+		dataoffset = ARR_OVERHEAD_WITHNULLS(ndim, nElems);
 		nBytes += dataoffset;
 	}
 	else
 	{
 		dataoffset = 0;			/* marker for no null bitmap */
-		nBytes += ARR_OVERHEAD_NONULLS(1);
+		nBytes += ARR_OVERHEAD_NONULLS(ndim);
 	}
 	v = (ArrayType*)palloc0(nBytes);
 	AssertVariableIsOfType(v->dataoffset, int32);
@@ -56,13 +223,151 @@ ArrayType* createArrayType(jsize nElems, size_t elemSize, Oid elemType, bool wit
 #else
 	SET_VARSIZE(v, nBytes);
 #endif
-	ARR_NDIM(v) = 1;
+	ARR_NDIM(v) = ndim;
 	ARR_ELEMTYPE(v) = elemType;
-	*((int*)ARR_DIMS(v)) = nElems;
-	*((int*)ARR_LBOUND(v)) = 1;
+	for(idx = 0; idx < ndim; ++idx)
+	{
+		ARR_DIMS(v)[idx] = dims[idx];
+		ARR_LBOUND(v)[idx] = 1;
+	}
 	return v;
 }
 
+#if PG_VERSION_NUM >= 90500
+static jobjectArray _Array_expandedToJava(
+	ExpandedArrayHeader* eah, Type elemType)
+{
+	jsize idx;
+	jsize nElems;
+	jobjectArray objArray;
+	JNI_LocalChunks lc;
+
+	deconstruct_expanded_array(eah);
+	nElems = (jsize)eah->nelems;
+	objArray = JNI_newObjectArray(nElems, Type_getJavaClass(elemType), 0);
+
+	JNI_beginLocalChunks(&lc, 2);
+	PG_TRY();
+	{
+		for(idx = 0; idx < nElems; ++idx)
+		{
+			if(eah->dnulls == 0 || !eah->dnulls[idx])
+			{
+				jvalue obj = Type_coerceDatum(elemType, eah->dvalues[idx]);
+				JNI_setObjectArrayElement(objArray, idx, obj.l);
+				JNI_nextLocalChunk(&lc);
+			}
+		}
+		JNI_endLocalChunks(&lc);
+	}
+	PG_CATCH();
+	{
+		JNI_endLocalChunks(&lc);
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+	return objArray;
+}
+
+/*
+ * Build a function's result as an expanded array owning its element Datums,
+ * so a caller that goes on to modify it (appending in a PL/pgSQL loop, say)
+ * can do so in place, and it is flattened only once, when and if it is stored.
+ * Only a function result is made this way: it is returned read/write, which
+ * suits no other use (an SPI parameter or a planner Const must not be changed
+ * in place), and it costs a memory context of its own, so everywhere else
+ * _Array_coerceObject makes a flat array.
+ */
+static Datum _Array_javaToExpanded(Type elemType, jobject objArray)
+{
+	jsize idx;
+	int nElems = (int)JNI_getArrayLength((jarray)objArray);
+	ArrayMetaState meta;
+	ExpandedArrayHeader* eah;
+	MemoryContext oldcxt;
+	Datum result;
+	JNI_LocalChunks lc;
+
+	meta.element_type = Type_getOid(elemType);
+	meta.typlen = Type_getLength(elemType);
+	meta.typbyval = Type_isByValue(elemType);
+	meta.typalign = Type_getAlign(elemType);
+
+	result = construct_empty_expanded_array(
+		meta.element_type, CurrentMemoryContext, &meta);
+	if(nElems == 0)
+		return result;
+
+	eah = (ExpandedArrayHeader*)DatumGetEOHP(result);
+	oldcxt = MemoryContextSwitchTo(eah->hdr.eoh_context);
+
+	eah->ndims = 1;
+	eah->dims = (int*)palloc(2 * sizeof(int));
+	eah->lbound = eah->dims + 1;
+	eah->dims[0] = nElems;
+	eah->lbound[0] = 1;
+	eah->dvalues = (Datum*)palloc(nElems * sizeof(Datum));
+	eah->dnulls = 0;
+	eah->dvalueslen = nElems;
+	eah->nelems = nElems;
+
+	JNI_beginLocalChunks(&lc, 2);
+	PG_TRY();
+	{
+		for(idx = 0; idx < nElems; ++idx)
+		{
+			jobject obj = JNI_getObjectArrayElement(objArray, idx);
+			if(obj == 0)
+			{
+				if(eah->dnulls == 0)
+					eah->dnulls = (bool*)palloc0(nElems * sizeof(bool));
+				eah->dnulls[idx] = true;
+				eah->dvalues[idx] = 0;
+			}
+			else
+			{
+				eah->dvalues[idx] = Type_coerceObject(elemType, obj);
+				JNI_nextLocalChunk(&lc);
+			}
+		}
+		JNI_endLocalChunks(&lc);
+	}
+	PG_CATCH();
+	{
+		JNI_endLocalChunks(&lc);
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+
+	/* The element Datums, not any flat copy, are now the value. */
+	eah->fvalue = 0;
+	eah->fstartptr = 0;
+	eah->fendptr = 0;
+	eah->flat_size = 0;
+
+	MemoryContextSwitchTo(oldcxt);
+	return result;
+}
+
+static Datum _Array_invoke(Type self, Function fn, PG_FUNCTION_ARGS)
+{
+	MemoryContext currCtx;
+	Datum ret;
+	jobject value = pljava_Function_refInvoke(fn);
+	if(value == 0)
+	{
+		fcinfo->isnull = true;
+		return 0;
+	}
+
+	currCtx = Invocation_switchToUpperContext();
+	ret = _Array_javaToExpanded(Type_getElementType(self), value);
+	MemoryContextSwitchTo(currCtx);
+	JNI_deleteLocalRef(value);
+	return ret;
+}
+#endif
+
 static jvalue _Array_coerceDatum(Type self, Datum arg)
 {
 	jvalue result;
@@ -71,33 +376,66 @@ static jvalue _Array_coerceDatum(Type self, Datum arg)
 	int16 elemLength  = Type_getLength(elemType);
 	char  elemAlign   = Type_getAlign(elemType);
 	bool  elemByValue = Type_isByValue(elemType);
-	ArrayType* v = DatumGetArrayTypeP(arg);
-	jsize nElems = (jsize)ArrayGetNItems(ARR_NDIM(v), ARR_DIMS(v));
-	jobjectArray objArray = JNI_newObjectArray(nElems, Type_getJavaClass(elemType), 0);
-	const char* values = ARR_DATA_PTR(v);
-	bits8* nullBitMap = ARR_NULLBITMAP(v);
+	ArrayType* v;
+	jsize nElems;
+	jobjectArray objArray;
+	const char* values;
+	bits8* nullBitMap;
+	JNI_LocalChunks lc;
 
-	for(idx = 0; idx < nElems; ++idx)
+#if PG_VERSION_NUM >= 90500
+	/*
+	 * An expanded array (as PL/pgSQL keeps in its variables) is read from its
+	 * element Datums as it stands, rather than flattened into a copy.
+	 */
+	if(VARATT_IS_EXTERNAL_EXPANDED(DatumGetPointer(arg)))
 	{
-		if(arrayIsNull(nullBitMap, idx))
-			JNI_setObjectArrayElement(objArray, idx, 0);
-		else
+		result.l = _Array_expandedToJava(
+			(ExpandedArrayHeader*)DatumGetEOHP(arg), elemType);
+		return result;
+	}
+#endif
+
+	v = DatumGetArrayTypeP(arg);
+	nElems = (jsize)ArrayGetNItems(ARR_NDIM(v), ARR_DIMS(v));
+	objArray = JNI_newObjectArray(nElems, Type_getJavaClass(elemType), 0);
+	values = ARR_DATA_PTR(v);
+	nullBitMap = ARR_NULLBITMAP(v);
+
+	JNI_beginLocalChunks(&lc, 2);
+	PG_TRY();
+	{
+		for(idx = 0; idx < nElems; ++idx)
 		{
-			Datum value = fetch_att(values, elemByValue, elemLength);
-			jvalue obj = Type_coerceDatum(elemType, value);
-			JNI_setObjectArrayElement(objArray, idx, obj.l);
-			JNI_deleteLocalRef(obj.l);
+			if(arrayIsNull(nullBitMap, idx))
+				JNI_setObjectArrayElement(objArray, idx, 0);
+			else
+			{
+				Datum value = fetch_att(values, elemByValue, elemLength);
+				jvalue obj = Type_coerceDatum(elemType, value);
+				JNI_setObjectArrayElement(objArray, idx, obj.l);
+				JNI_nextLocalChunk(&lc);
 
 #if PG_VERSION_NUM < 80300
-			values = att_addlength(values, elemLength, PointerGetDatum(values));
-			values = (char*)att_align(values, elemAlign);
+				values = att_addlength(
+					values, elemLength, PointerGetDatum(values));
+				values = (char*)att_align(values, elemAlign);
 #else
-			values = att_addlength_datum(values, elemLength, PointerGetDatum(values));
-			values = (char*)att_align_nominal(values, elemAlign);
+				values = att_addlength_datum(
+					values, elemLength, PointerGetDatum(values));
+				values = (char*)att_align_nominal(values, elemAlign);
 #endif
 
+			}
 		}
+		JNI_endLocalChunks(&lc);
+	}
+	PG_CATCH();
+	{
+		JNI_endLocalChunks(&lc);
+		PG_RE_THROW();
 	}
+	PG_END_TRY();
 	result.l = (jobject)objArray;
 	return result;
 }
@@ -111,22 +449,34 @@ static Datum _Array_coerceObject(Type self, jobject objArray)
 	int    nElems   = (int)JNI_getArrayLength((jarray)objArray);
 	Datum* values   = (Datum*)palloc(nElems * sizeof(Datum) + nElems * sizeof(bool));
 	bool*  nulls    = (bool*)(values + nElems);
+	JNI_LocalChunks lc;
 
-	for(idx = 0; idx < nElems; ++idx)
+	JNI_beginLocalChunks(&lc, 2);
+	PG_TRY();
 	{
-		jobject obj = JNI_getObjectArrayElement(objArray, idx);
-		if(obj == 0)
+		for(idx = 0; idx < nElems; ++idx)
 		{
-			nulls[idx] = true;
-			values[idx] = 0;
-		}
-		else
-		{
-			nulls[idx] = false;
-			values[idx] = Type_coerceObject(elemType, obj);
-			JNI_deleteLocalRef(obj);
+			jobject obj = JNI_getObjectArrayElement(objArray, idx);
+			if(obj == 0)
+			{
+				nulls[idx] = true;
+				values[idx] = 0;
+			}
+			else
+			{
+				nulls[idx] = false;
+				values[idx] = Type_coerceObject(elemType, obj);
+				JNI_nextLocalChunk(&lc);
+			}
 		}
+		JNI_endLocalChunks(&lc);
 	}
+	PG_CATCH();
+	{
+		JNI_endLocalChunks(&lc);
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
 
 	v = construct_md_array(
 		values,
@@ -143,6 +493,80 @@ static Datum _Array_coerceObject(Type self, jobject objArray)
 	PG_RETURN_ARRAYTYPE_P(v);
 }
 
+static BoxedKind* _BoxedArray_kindOf(Type elemType)
+{
+	const char* name = Type_getJavaTypeName(elemType);
+	size_t i;
+	for(i = 0; i < lengthof(s_boxedKinds); ++i)
+		if(strcmp(name, s_boxedKinds[i].javaTypeName) == 0)
+			return s_boxedKinds + i;
+	return 0;
+}
+
+/*
+ * An array of a boxed numeric type, such as Integer[], is unboxed by one call
+ * of BoxedArrays.unbox into a primitive array and a mask of its nulls, from
+ * which the PostgreSQL array and its null bitmap are made in bulk by
+ * arrayCompactNulls.
+ *
+ * JNI does not check the argument types of that call, so any other array
+ * (an Object[] or Number[] holding the values, or a Long[] given for int4[])
+ * goes element by element through _Array_coerceObject, which converts or
+ * rejects each element as it always has.
+ */
+static Datum _BoxedArray_coerceObject(Type self, jobject objArray)
+{
+	ArrayType* v;
+	jarray values;
+	jbooleanArray isNull;
+	jint nNulls;
+	Type elemType = Type_getElementType(self);
+	BoxedKind* kind = _BoxedArray_kindOf(elemType);
+	Oid elemOid = get_element_type(Type_getOid(self));
+	jsize nElems;
+
+	if(objArray == 0)
+		return 0;
+
+	if(!JNI_isInstanceOf(objArray, kind->arrayClass))
+		return _Array_coerceObject(self, objArray);
+
+	if(InvalidOid == elemOid)
+		elemOid = Type_getOid(elemType);
+
+	nElems = JNI_getArrayLength((jarray)objArray);
+	values = _ArrayMD_newPrimitive(kind->sig, nElems);
+	isNull = JNI_newBooleanArray(nElems);
+	nNulls = JNI_callStaticIntMethod(
+		s_BoxedArrays_class, kind->unbox, objArray, values, isNull);
+
+	if(nNulls == 0)
+	{
+		v = createArrayType(nElems, kind->elemSize, elemOid, false);
+		_ArrayMD_getRegion(kind->sig, values, nElems, ARR_DATA_PTR(v));
+	}
+	else
+	{
+		char* buf = palloc(nElems * (kind->elemSize + sizeof(jboolean)));
+		jboolean* mask = (jboolean*)(buf + nElems * kind->elemSize);
+
+		_ArrayMD_getRegion(kind->sig, values, nElems, buf);
+		JNI_getBooleanArrayRegion(isNull, 0, nElems, mask);
+
+		v = createArrayType(nElems, kind->elemSize, elemOid, true);
+		arrayCompactNulls(ARR_DATA_PTR(v), ARR_NULLBITMAP(v),
+			buf, mask, nElems, kind->elemSize);
+		/* only the non-null elements occupy the data region */
+		SET_VARSIZE(v,
+			ARR_DATA_OFFSET(v) + (nElems - nNulls) * kind->elemSize);
+		pfree(buf);
+	}
+
+	JNI_deleteLocalRef(isNull);
+	JNI_deleteLocalRef(values);
+	PG_RETURN_ARRAYTYPE_P(v);
+}
+
 /*
  * For an array, canReplaceType can be computed a bit more generously.
  * The primitive types are coded so that a boxed scalar can replace its
@@ -160,9 +584,427 @@ static bool _Array_canReplaceType(Type self, Type other)
 		|| Type_getObjectType(self) == other;
 }
 
+/*
+ * Multidimensional arrays.
+ *
+ * A Java array type nested more than one level deep (double[][], say) maps to
+ * a PostgreSQL array having that many dimensions, preserving the shape rather
+ * than flattening, so a matrix function can work on the rows directly. The
+ * number of dimensions must match the nesting exactly; an array of zero
+ * dimensions (empty) maps to an empty Java array. Lower bounds other than 1
+ * are accepted from PostgreSQL (Java indices simply start at zero), and
+ * arrays returned to PostgreSQL have lower bounds of 1. A Java array returned
+ * must be rectangular.
+ *
+ * When the innermost element type is a Java primitive, each innermost row is
+ * copied directly from or to the PostgreSQL array's data region with one
+ * JNI array region call. (PostgreSQL nulls become zero, as for the 1-D arrays
+ * of primitives.) Otherwise, elements are coerced one at a time, as for 1-D
+ * arrays of non-primitives.
+ */
+typedef struct
+{
+	Type        leaf;        /* innermost element type */
+	char        sig;         /* its JNI signature if primitive, or 0 */
+	int16       elemLength;
+	bool        elemByValue;
+	char        elemAlign;
+	int         depth;       /* levels of Java array nesting */
+	char*       values;      /* current position in array data region */
+	bits8*      nullBitMap;
+	int         offset;      /* index of current element, for nullBitMap */
+	Datum*      datums;      /* elements collected from Java, if not sig */
+	bool*       nulls;
+} MDCursor;
+
+static Type _ArrayMD_leafType(Type self, int* depth)
+{
+	int d = 0;
+	Type t = self;
+	while(Type_getElementType(t) != 0)
+	{
+		t = Type_getElementType(t);
+		++d;
+	}
+	*depth = d;
+	return t;
+}
+
+static void _ArrayMD_initCursor(Type self, MDCursor* c)
+{
+	Type leaf = _ArrayMD_leafType(self, &c->depth);
+	c->leaf        = leaf;
+	c->elemLength  = Type_getLength(leaf);
+	c->elemByValue = Type_isByValue(leaf);
+	c->elemAlign   = Type_getAlign(leaf);
+	c->sig         = 0;
+	c->values      = 0;
+	c->nullBitMap  = 0;
+	c->offset      = 0;
+	c->datums      = 0;
+	c->nulls       = 0;
+
+	if(Type_isPrimitive(leaf))
+	{
+		size_t jsz = 0;
+		c->sig = *Type_getJNISignature(leaf);
+		switch(c->sig)
+		{
+		case 'Z': jsz = sizeof(jboolean); break;
+		case 'B': jsz = sizeof(jbyte);    break;
+		case 'S': jsz = sizeof(jshort);   break;
+		case 'I': jsz = sizeof(jint);     break;
+		case 'J': jsz = sizeof(jlong);    break;
+		case 'F': jsz = sizeof(jfloat);   break;
+		case 'D': jsz = sizeof(jdouble);  break;
+		}
+		if(jsz == 0 || jsz != (size_t)c->elemLength || !c->elemByValue)
+			elog(ERROR, "PL/Java cannot map multidimensional array of %s",
+				Type_getJavaTypeName(leaf));
+	}
+}
+
+static jarray _ArrayMD_newPrimitive(char sig, jsize n)
+{
+	switch(sig)
+	{
+	case 'Z': return JNI_newBooleanArray(n);
+	case 'B': return JNI_newByteArray(n);
+	case 'S': return JNI_newShortArray(n);
+	case 'I': return JNI_newIntArray(n);
+	case 'J': return JNI_newLongArray(n);
+	case 'F': return JNI_newFloatArray(n);
+	default:  return JNI_newDoubleArray(n);
+	}
+}
+
+static void _ArrayMD_setRegion(char sig, jarray a, jsize n, void* buf)
+{
+	switch(sig)
+	{
+	case 'Z': JNI_setBooleanArrayRegion(a, 0, n, buf); break;
+	case 'B': JNI_setByteArrayRegion(a, 0, n, buf);    break;
+	case 'S': JNI_setShortArrayRegion(a, 0, n, buf);   break;
+	case 'I': JNI_setIntArrayRegion(a, 0, n, buf);     break;
+	case 'J': JNI_setLongArrayRegion(a, 0, n, buf);    break;
+	case 'F': JNI_setFloatArrayRegion(a, 0, n, buf);   break;
+	default:  JNI_setDoubleArrayRegion(a, 0, n, buf);  break;
+	}
+}
+
+static void _ArrayMD_getRegion(char sig, jarray a, jsize n, void* buf)
+{
+	switch(sig)
+	{
+	case 'Z': JNI_getBooleanArrayRegion(a, 0, n, buf); break;
+	case 'B': JNI_getByteArrayRegion(a, 0, n, buf);    break;
+	case 'S': JNI_getShortArrayRegion(a, 0, n, buf);   break;
+	case 'I': JNI_getIntArrayRegion(a, 0, n, buf);     break;
+	case 'J': JNI_getLongArrayRegion(a, 0, n, buf);    break;
+	case 'F': JNI_getFloatArrayRegion(a, 0, n, buf);   break;
+	default:  JNI_getDoubleArrayRegion(a, 0, n, buf);  break;
+	}
+}
+
+/*
+ * Return a new Java array for one innermost row of n elements.
+ */
+static jobject _ArrayMD_rowToJava(MDCursor* c, jsize n)
+{
+	jsize idx;
+	jobjectArray objArray;
+	JNI_LocalChunks lc;
+
+	if(c->sig != 0)
+	{
+		jarray primArray = _ArrayMD_newPrimitive(c->sig, n);
+		if(c->nullBitMap == 0)
+		{
+			_ArrayMD_setRegion(c->sig, primArray, n, c->values);
+			c->values += n * c->elemLength;
+		}
+		else
+		{
+			char* buf = palloc(n * c->elemLength);
+			c->values += c->elemLength * arrayExpandNulls(
+				buf, c->values, c->nullBitMap, c->offset, n, c->elemLength);
+			_ArrayMD_setRegion(c->sig, primArray, n, buf);
+			pfree(buf);
+		}
+		c->offset += n;
+		return primArray;
+	}
+
+	objArray = JNI_newObjectArray(n, Type_getJavaClass(c->leaf), 0);
+	JNI_beginLocalChunks(&lc, 2);
+	PG_TRY();
+	{
+		for(idx = 0; idx < n; ++idx)
+		{
+			Datum value;
+			jvalue obj;
+
+			if(arrayIsNull(c->nullBitMap, c->offset + idx))
+				continue;
+
+			value = fetch_att(c->values, c->elemByValue, c->elemLength);
+			obj = Type_coerceDatum(c->leaf, value);
+			JNI_setObjectArrayElement(objArray, idx, obj.l);
+			JNI_nextLocalChunk(&lc);
+
+			c->values = att_addlength_datum(
+				c->values, c->elemLength, PointerGetDatum(c->values));
+			c->values = (char*)att_align_nominal(c->values, c->elemAlign);
+		}
+		JNI_endLocalChunks(&lc);
+	}
+	PG_CATCH();
+	{
+		JNI_endLocalChunks(&lc);
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+	c->offset += n;
+	return objArray;
+}
+
+static jobject _ArrayMD_levelToJava(
+	Type self, int level, const int* dims, MDCursor* c)
+{
+	jsize idx;
+	jobjectArray objArray;
+	Type elemType = Type_getElementType(self);
+
+	if(level == c->depth - 1)
+		return _ArrayMD_rowToJava(c, dims[level]);
+
+	objArray = JNI_newObjectArray(dims[level], Type_getJavaClass(elemType), 0);
+	for(idx = 0; idx < dims[level]; ++idx)
+	{
+		jobject sub = _ArrayMD_levelToJava(elemType, level + 1, dims, c);
+		JNI_setObjectArrayElement(objArray, idx, sub);
+		JNI_deleteLocalRef(sub);
+	}
+	return objArray;
+}
+
+static jvalue _ArrayMD_coerceDatum(Type self, Datum arg)
+{
+	jvalue result;
+	MDCursor c;
+	ArrayType* v = DatumGetArrayTypeP(arg);
+	int ndim = ARR_NDIM(v);
+
+	_ArrayMD_initCursor(self, &c);
+
+	if(ndim == 0)
+	{
+		result.l = JNI_newObjectArray(
+			0, Type_getJavaClass(Type_getElementType(self)), 0);
+		return result;
+	}
+
+	if(ndim != c.depth)
+		ereport(ERROR, (
+			errcode(ERRCODE_DATATYPE_MISMATCH),
+			errmsg("cannot map %d-dimensional array to Java type %s",
+				ndim, Type_getJavaTypeName(self))));
+
+	c.values = ARR_DATA_PTR(v);
+	c.nullBitMap = ARR_NULLBITMAP(v);
+	result.l = _ArrayMD_levelToJava(self, 0, ARR_DIMS(v), &c);
+	return result;
+}
+
+static void _ArrayMD_levelFromJava(
+	jobject array, int level, const int* dims, MDCursor* c)
+{
+	jsize idx;
+	jsize n = JNI_getArrayLength((jarray)array);
+	JNI_LocalChunks lc;
+
+	if(n != dims[level])
+		ereport(ERROR, (
+			errcode(ERRCODE_ARRAY_SUBSCRIPT_ERROR),
+			errmsg("multidimensional arrays must have array expressions "
+				"with matching dimensions")));
+
+	if(level < c->depth - 1)
+	{
+		for(idx = 0; idx < n; ++idx)
+		{
+			jobject sub = JNI_getObjectArrayElement(array, idx);
+			if(sub == 0)
+				ereport(ERROR, (
+					errcode(ERRCODE_ARRAY_SUBSCRIPT_ERROR),
+					errmsg("multidimensional arrays must have array "
+						"expressions with matching dimensions")));
+			_ArrayMD_levelFromJava(sub, level + 1, dims, c);
+			JNI_deleteLocalRef(sub);
+		}
+		return;
+	}
+
+	if(c->sig != 0)
+	{
+		_ArrayMD_getRegion(c->sig, (jarray)array, n, c->values);
+		c->values += n * c->elemLength;
+		return;
+	}
+
+	JNI_beginLocalChunks(&lc, 2);
+	PG_TRY();
+	{
+		for(idx = 0; idx < n; ++idx)
+		{
+			jobject obj = JNI_getObjectArrayElement(array, idx);
+			if(obj == 0)
+			{
+				c->nulls[c->offset] = true;
+				c->datums[c->offset] = 0;
+			}
+			else
+			{
+				c->nulls[c->offset] = false;
+				c->datums[c->offset] = Type_coerceObject(c->leaf, obj);
+				JNI_nextLocalChunk(&lc);
+			}
+			++ c->offset;
+		}
+		JNI_endLocalChunks(&lc);
+	}
+	PG_CATCH();
+	{
+		JNI_endLocalChunks(&lc);
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+}
+
+static Datum _ArrayMD_coerceObject(Type self, jobject objArray)
+{
+	ArrayType* v;
+	MDCursor c;
+	int level;
+	int nElems;
+	int* dims;
+	int* lbs;
+	jobject probe;
+
+	if(objArray == 0)
+		return 0;
+
+	_ArrayMD_initCursor(self, &c);
+	dims = (int*)palloc(2 * c.depth * sizeof(int));
+	lbs = dims + c.depth;
+
+	/*
+	 * Take the dimensions from the first element at each level; the walk
+	 * below will confirm every other element agrees.
+	 */
+	probe = objArray;
+	for(level = 0; level < c.depth; ++level)
+	{
+		jobject next;
+		dims[level] = JNI_getArrayLength((jarray)probe);
+		lbs[level] = 1;
+		if(level == c.depth - 1)
+			break;
+		if(dims[level] == 0)
+		{
+			pfree(dims);
+			v = construct_empty_array(Type_getOid(c.leaf));
+			PG_RETURN_ARRAYTYPE_P(v);
+		}
+		next = JNI_getObjectArrayElement(probe, 0);
+		if(probe != objArray)
+			JNI_deleteLocalRef(probe);
+		probe = next;
+		if(probe == 0)
+			ereport(ERROR, (
+				errcode(ERRCODE_ARRAY_SUBSCRIPT_ERROR),
+				errmsg("multidimensional arrays must have array "
+					"expressions with matching dimensions")));
+	}
+	if(probe != objArray)
+		JNI_deleteLocalRef(probe);
+
+	nElems = ArrayGetNItems(c.depth, dims);
+	if(nElems == 0)
+	{
+		pfree(dims);
+		v = construct_empty_array(Type_getOid(c.leaf));
+		PG_RETURN_ARRAYTYPE_P(v);
+	}
+
+	if(c.sig != 0)
+	{
+		v = createArrayTypeMD(
+			c.depth, dims, c.elemLength, Type_getOid(c.leaf), false);
+		c.values = ARR_DATA_PTR(v);
+		_ArrayMD_levelFromJava(objArray, 0, dims, &c);
+	}
+	else
+	{
+		c.datums = (Datum*)palloc(nElems * (sizeof(Datum) + sizeof(bool)));
+		c.nulls  = (bool*)(c.datums + nElems);
+		_ArrayMD_levelFromJava(objArray, 0, dims, &c);
+		v = construct_md_array(
+			c.datums,
+			c.nulls,
+			c.depth,
+			dims,
+			lbs,
+			Type_getOid(c.leaf),
+			c.elemLength,
+			c.elemByValue,
+			c.elemAlign);
+		pfree(c.datums);
+	}
+
+	pfree(dims);
+	PG_RETURN_ARRAYTYPE_P(v);
+}
+
+/*
+ * A multidimensional array type can replace an array type when their
+ * innermost element types correspond, following the same rules as for
+ * one-dimensional arrays.
+ */
+static bool _ArrayMD_canReplaceType(Type self, Type other)
+{
+	int sd;
+	int od;
+	Type sl = _ArrayMD_leafType(self, &sd);
+	Type ol = _ArrayMD_leafType(other, &od);
+	if ( od == 0 )
+		return false;
+	return Type_canReplaceType(sl, ol) || Type_getObjectType(sl) == ol;
+}
+
+/*
+ * An array of arrays; see "Multidimensional arrays" above.
+ */
+static Type _Array_createArrayType(Type self, Oid arrayTypeId)
+{
+	Type mdType = Array_fromOid2(
+		arrayTypeId, self, _ArrayMD_coerceDatum, _ArrayMD_coerceObject);
+	mdType->typeClass->canReplaceType = _ArrayMD_canReplaceType;
+	return mdType;
+}
+
 Type Array_fromOid(Oid typeId, Type elementType)
 {
-	return Array_fromOid2(typeId, elementType, _Array_coerceDatum, _Array_coerceObject);
+	Type self;
+	if(_BoxedArray_kindOf(elementType) != 0)
+		return Array_fromOid2(typeId, elementType,
+			_Array_coerceDatum, _BoxedArray_coerceObject);
+	self = Array_fromOid2(
+		typeId, elementType, _Array_coerceDatum, _Array_coerceObject);
+#if PG_VERSION_NUM >= 90500
+	self->typeClass->invoke = _Array_invoke;
+#endif
+	return self;
 }
 
 Type Array_fromOid2(Oid typeId, Type elementType, DatumCoercer coerceDatum, ObjectCoercer coerceObject)
@@ -189,6 +1031,7 @@ Type Array_fromOid2(Oid typeId, Type elementType, DatumCoercer coerceDatum, Obje
 	arrayClass->coerceDatum  = coerceDatum;
 	arrayClass->coerceObject = coerceObject;
 	arrayClass->canReplaceType = _Array_canReplaceType;
+	arrayClass->createArrayType = _Array_createArrayType;
 	self = TypeClass_allocInstance(arrayClass, typeId);
 	MemoryContextSwitchTo(currCtx);
 
@@ -200,3 +1043,18 @@ Type Array_fromOid2(Oid typeId, Type elementType, DatumCoercer coerceDatum, Obje
 	return self;
 }
 
+extern void Array_initialize(void);
+void Array_initialize(void)
+{
+	size_t i;
+
+	s_BoxedArrays_class = (jclass)JNI_newGlobalRef(PgObject_getJavaClass(
+		"org/postgresql/pljava/internal/BoxedArrays"));
+	for(i = 0; i < lengthof(s_boxedKinds); ++i)
+	{
+		s_boxedKinds[i].arrayClass = (jclass)JNI_newGlobalRef(
+			PgObject_getJavaClass(s_boxedKinds[i].arrayClassName));
+		s_boxedKinds[i].unbox = PgObject_getStaticJavaMethod(
+			s_BoxedArrays_class, "unbox", s_boxedKinds[i].unboxSignature);
+	}
+}
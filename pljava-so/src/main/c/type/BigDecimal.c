@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2004, 2005, 2006 TADA AB - Taby Sweden
+ * Copyright (c) 2004, 2005, 2006, 2026 TADA AB - Taby Sweden
  * Distributed under the terms shown in the file COPYRIGHT
  * found in the root folder of this project or at
  * http://eng.tada.se/osprojects/COPYRIGHT.html
@@ -7,33 +7,189 @@
  * @author Thomas Hallgren
  */
 #include <postgres.h>
+#include <lib/stringinfo.h>
+#include <utils/builtins.h>
 #include <utils/memutils.h>
 #include <utils/numeric.h>
 
 #include "pljava/type/String_priv.h"
 
 /*
- * BigDecimal type. We use String conversions here. Perhaps there's
- * room for optimizations such as creating a 2's complement byte
- * array directly from the digits. Don't think we'd gain much though.
+ * BigDecimal type. Values that fit (as an unscaled value and a scale) in
+ * a Java long are converted directly between the base-10000 digits of
+ * PostgreSQL's numeric binary send/receive format and the long unscaled value,
+ * avoiding the text detour. Larger values, and the NaN and infinite values
+ * a BigDecimal cannot represent, take the String conversion path.
  */
 static jclass    s_BigDecimal_class;
 static jmethodID s_BigDecimal_init;
 static jmethodID s_BigDecimal_toString;
+static jmethodID s_BigDecimal_valueOf;
+static jmethodID s_BigDecimal_precision;
+static jmethodID s_BigDecimal_scale;
+static jmethodID s_BigDecimal_unscaledValue;
+static jmethodID s_BigInteger_longValue;
 static TypeClass s_BigDecimalClass;
 
+/*
+ * Sign words of the numeric binary format (see numeric_send).
+ */
+#define NUMERIC_SEND_POS 0x0000
+#define NUMERIC_SEND_NEG 0x4000
+
+/*
+ * Display scale limit of the numeric binary format (see numeric_recv).
+ */
+#define NUMERIC_SEND_MAX_DSCALE 0x3FFF
+
+/*
+ * Longest unscaled value, in decimal digits, taken on the fast path from
+ * numeric to BigDecimal, and in the other direction (leaving room for up to
+ * three more digits of padding to a base-10000 digit boundary).
+ */
+#define FAST_DIGITS_IN  18
+#define FAST_DIGITS_OUT 15
+
+static const int64 s_pow10[] =
+{
+	INT64CONST(1),
+	INT64CONST(10),
+	INT64CONST(100),
+	INT64CONST(1000),
+	INT64CONST(10000),
+	INT64CONST(100000),
+	INT64CONST(1000000),
+	INT64CONST(10000000),
+	INT64CONST(100000000),
+	INT64CONST(1000000000),
+	INT64CONST(10000000000),
+	INT64CONST(100000000000),
+	INT64CONST(1000000000000),
+	INT64CONST(10000000000000),
+	INT64CONST(100000000000000),
+	INT64CONST(1000000000000000),
+	INT64CONST(10000000000000000),
+	INT64CONST(100000000000000000),
+	INT64CONST(1000000000000000000)
+};
+
+static int getInt16(const unsigned char* p)
+{
+	return (int)(int16)((p[0] << 8) | p[1]);
+}
+
+static void appendInt16(StringInfo buf, int v)
+{
+	appendStringInfoChar(buf, (char)((v >> 8) & 0xff));
+	appendStringInfoChar(buf, (char)(v & 0xff));
+}
+
 static jvalue _BigDecimal_coerceDatum(Type self, Datum arg)
 {
-	jvalue result = _String_coerceDatum(self, arg);
+	jvalue result;
+	bytea* sent = DatumGetByteaPP(DirectFunctionCall1(numeric_send, arg));
+	const unsigned char* p = (const unsigned char*)VARDATA_ANY(sent);
+	int ndigits = getInt16(p);
+	int weight  = getInt16(p + 2);
+	int sign    = getInt16(p + 4) & 0xffff;
+	int dscale  = getInt16(p + 6);
+	int intDigits = weight >= 0 ? 4 * (weight + 1) : 0;
+
+	if ( ( NUMERIC_SEND_POS == sign  ||  NUMERIC_SEND_NEG == sign )
+		&& FAST_DIGITS_IN >= intDigits + dscale )
+	{
+		int64 unscaled = 0;
+		int i;
+		for ( i = 0 ; i < ndigits ; ++ i )
+		{
+			int64 digit = getInt16(p + 8 + 2 * i);
+			int e = 4 * (weight - i) + dscale;
+			if ( 0 <= e )
+				unscaled += digit * s_pow10[e];
+			else if ( -4 < e )
+				unscaled += digit / s_pow10[-e];
+			/* else the digit is past dscale, and necessarily zero */
+		}
+		pfree(sent);
+		result.l = JNI_callStaticObjectMethod(s_BigDecimal_class,
+			s_BigDecimal_valueOf,
+			(jlong)(NUMERIC_SEND_NEG == sign ? -unscaled : unscaled),
+			(jint)dscale);
+		return result;
+	}
+
+	pfree(sent);
+	result = _String_coerceDatum(self, arg);
 	if(result.l != 0)
 		result.l = JNI_newObject(s_BigDecimal_class, s_BigDecimal_init, result.l);
 	return result;
 }
 
+/*
+ * Construct a numeric from an unscaled value less than 10^FAST_DIGITS_OUT in
+ * magnitude, and a scale, by way of numeric_recv, which validates the result.
+ */
+static Datum numericFromUnscaled(int64 unscaled, int scale)
+{
+	Datum result;
+	StringInfoData buf;
+	int16 groups[5];
+	int   ngroups = 0;
+	int   low = 0;
+	int   i;
+	bool  negative = unscaled < 0;
+	uint64 v = negative ? (uint64)(-unscaled) : (uint64)unscaled;
+	/*
+	 * Pad with 0 to 3 decimal zeros so the scale falls on a base-10000 digit
+	 * boundary; the least significant digit then has weight -k.
+	 */
+	int pad = (4 - ((scale % 4) + 4) % 4) % 4;
+	int k = (scale + pad) / 4;
+
+	v *= (uint64)s_pow10[pad];
+	while ( 0 != v )
+	{
+		groups[ngroups++] = (int16)(v % 10000);
+		v /= 10000;
+	}
+	while ( low < ngroups  &&  0 == groups[low] )
+		++ low;
+
+	initStringInfo(&buf);
+	appendInt16(&buf, ngroups - low);
+	appendInt16(&buf, 0 == ngroups ? 0 : ngroups - 1 - k);
+	appendInt16(&buf, negative ? NUMERIC_SEND_NEG : NUMERIC_SEND_POS);
+	appendInt16(&buf, scale > 0 ? scale : 0);
+	for ( i = ngroups - 1 ; i >= low ; -- i )
+		appendInt16(&buf, groups[i]);
+
+	result = DirectFunctionCall3(numeric_recv, PointerGetDatum(&buf),
+		ObjectIdGetDatum(InvalidOid), Int32GetDatum(-1));
+	pfree(buf.data);
+	return result;
+}
+
 static Datum _BigDecimal_coerceObject(Type self, jobject value)
 {
-	jstring jstr = (jstring)JNI_callObjectMethod(value, s_BigDecimal_toString);
-	Datum ret = _String_coerceObject(self, jstr);
+	jstring jstr;
+	Datum ret;
+
+	if ( FAST_DIGITS_OUT >= JNI_callIntMethod(value, s_BigDecimal_precision) )
+	{
+		jint scale = JNI_callIntMethod(value, s_BigDecimal_scale);
+		if ( -NUMERIC_SEND_MAX_DSCALE <= scale
+			&& NUMERIC_SEND_MAX_DSCALE >= scale )
+		{
+			jobject bi =
+				JNI_callObjectMethod(value, s_BigDecimal_unscaledValue);
+			jlong unscaled = JNI_callLongMethod(bi, s_BigInteger_longValue);
+			JNI_deleteLocalRef(bi);
+			return numericFromUnscaled(unscaled, scale);
+		}
+	}
+
+	jstr = (jstring)JNI_callObjectMethod(value, s_BigDecimal_toString);
+	ret = _String_coerceObject(self, jstr);
 	JNI_deleteLocalRef(jstr);
 	return ret;
 }
@@ -48,9 +204,19 @@ static Type BigDecimal_obtain(Oid typeId)
 extern void BigDecimal_initialize(void);
 void BigDecimal_initialize(void)
 {
+	jclass bigInteger_class;
+
 	s_BigDecimal_class = JNI_newGlobalRef(PgObject_getJavaClass("java/math/BigDecimal"));
 	s_BigDecimal_init = PgObject_getJavaMethod(s_BigDecimal_class, "<init>", "(Ljava/lang/String;)V");
 	s_BigDecimal_toString = PgObject_getJavaMethod(s_BigDecimal_class, "toString", "()Ljava/lang/String;");
+	s_BigDecimal_valueOf = PgObject_getStaticJavaMethod(s_BigDecimal_class, "valueOf", "(JI)Ljava/math/BigDecimal;");
+	s_BigDecimal_precision = PgObject_getJavaMethod(s_BigDecimal_class, "precision", "()I");
+	s_BigDecimal_scale = PgObject_getJavaMethod(s_BigDecimal_class, "scale", "()I");
+	s_BigDecimal_unscaledValue = PgObject_getJavaMethod(s_BigDecimal_class, "unscaledValue", "()Ljava/math/BigInteger;");
+
+	bigInteger_class = PgObject_getJavaClass("java/math/BigInteger");
+	s_BigInteger_longValue = PgObject_getJavaMethod(bigInteger_class, "longValue", "()J");
+	JNI_deleteLocalRef(bigInteger_class);
 
 	s_BigDecimalClass = TypeClass_alloc2("type.BigDecimal", sizeof(struct TypeClass_), sizeof(struct String_));
 	s_BigDecimalClass->JNISignature   = "Ljava/math/BigDecimal;";
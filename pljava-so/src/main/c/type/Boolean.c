@@ -17,7 +17,7 @@
 
 static TypeClass s_booleanClass;
 static jclass    s_Boolean_class;
-static jmethodID s_Boolean_init;
+static jmethodID s_Boolean_valueOf;
 static jmethodID s_Boolean_booleanValue;
 
 /*
@@ -95,7 +95,8 @@ static bool _Boolean_canReplace(Type self, Type other)
 static jvalue _Boolean_coerceDatum(Type self, Datum arg)
 {
 	jvalue result;
-	result.l = JNI_newObject(s_Boolean_class, s_Boolean_init, DatumGetBool(arg));
+	result.l = JNI_callStaticObjectMethod(s_Boolean_class, s_Boolean_valueOf,
+		DatumGetBool(arg));
 	return result;
 }
 
@@ -119,7 +120,8 @@ void Boolean_initialize(void)
 	TypeClass cls;
 
 	s_Boolean_class = JNI_newGlobalRef(PgObject_getJavaClass("java/lang/Boolean"));
-	s_Boolean_init = PgObject_getJavaMethod(s_Boolean_class, "<init>", "(Z)V");
+	s_Boolean_valueOf = PgObject_getStaticJavaMethod(s_Boolean_class,
+		"valueOf", "(Z)Ljava/lang/Boolean;");
 	s_Boolean_booleanValue = PgObject_getJavaMethod(s_Boolean_class, "booleanValue", "()Z");
 
 	cls = TypeClass_alloc("type.Boolean");
@@ -21,7 +21,7 @@
  */
 static TypeClass s_byteClass;
 static jclass    s_Byte_class;
-static jmethodID s_Byte_init;
+static jmethodID s_Byte_valueOf;
 static jmethodID s_Byte_byteValue;
 
 /*
@@ -96,7 +96,8 @@ static bool _Byte_canReplace(Type self, Type other)
 static jvalue _Byte_coerceDatum(Type self, Datum arg)
 {
 	jvalue result;
-	result.l = JNI_newObject(s_Byte_class, s_Byte_init, DatumGetChar(arg));
+	result.l = JNI_callStaticObjectMethod(s_Byte_class, s_Byte_valueOf,
+		DatumGetChar(arg));
 	return result;
 }
 
@@ -120,7 +121,8 @@ void Byte_initialize(void)
 	TypeClass cls;
 
 	s_Byte_class = JNI_newGlobalRef(PgObject_getJavaClass("java/lang/Byte"));
-	s_Byte_init = PgObject_getJavaMethod(s_Byte_class, "<init>", "(B)V");
+	s_Byte_valueOf = PgObject_getStaticJavaMethod(s_Byte_class,
+		"valueOf", "(B)Ljava/lang/Byte;");
 	s_Byte_byteValue = PgObject_getJavaMethod(s_Byte_class, "byteValue", "()B");
 
 	cls = TypeClass_alloc("type.Byte");
@@ -32,10 +32,55 @@ struct Coerce_
 	Type outerType;
 
 	FmgrInfo coerceFunction;
+
+	/*
+	 * Call info for the one-argument call of coerceFunction, set up once in
+	 * _Coerce_create so that each value only needs its argument stored. If the
+	 * coercion function should somehow lead back here before returning, the
+	 * nested call is made with FunctionCall1 instead, leaving this untouched.
+	 */
+	FunctionCallInfo coerceCall;
+
+	bool coerceCallBusy;
 };
 
 typedef struct Coerce_* Coerce;
 
+static Datum _Coerce_call(Coerce self, Datum arg)
+{
+	Datum result;
+	FunctionCallInfo fcinfo = self->coerceCall;
+
+	if ( self->coerceCallBusy )
+		return FunctionCall1(&self->coerceFunction, arg);
+
+#if PG_VERSION_NUM >= 120000
+	fcinfo->args[0].value = arg;
+	fcinfo->args[0].isnull = false;
+#else
+	fcinfo->arg[0] = arg;
+	fcinfo->argnull[0] = false;
+#endif
+	fcinfo->isnull = false;
+
+	self->coerceCallBusy = true;
+	PG_TRY();
+	{
+		result = FunctionCallInvoke(fcinfo);
+	}
+	PG_CATCH();
+	{
+		self->coerceCallBusy = false;
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+	self->coerceCallBusy = false;
+
+	if ( fcinfo->isnull )
+		elog(ERROR, "function %u returned NULL", self->coerceFunction.fn_oid);
+	return result;
+}
+
 static Datum _Coerce_invoke(Type type, Function fn, PG_FUNCTION_ARGS)
 {
 	Coerce self = (Coerce)type;
@@ -43,7 +88,7 @@ static Datum _Coerce_invoke(Type type, Function fn, PG_FUNCTION_ARGS)
 	if(arg != 0)
 	{
 		MemoryContext currCtx = Invocation_switchToUpperContext();
-		arg = FunctionCall1(&self->coerceFunction, arg);
+		arg = _Coerce_call(self, arg);
 		MemoryContextSwitchTo(currCtx);
 	}
 	return arg;
@@ -56,7 +101,7 @@ static jvalue _Coerce_coerceDatum(Type type, Datum arg)
 	if(arg == 0)
 		result.j = 0;
 	else
-		result = Type_coerceDatum(self->innerType, FunctionCall1(&self->coerceFunction, arg));
+		result = Type_coerceDatum(self->innerType, _Coerce_call(self, arg));
 	return result;
 }
 
@@ -67,7 +112,7 @@ static Datum _Coerce_coerceObject(Type type, jobject jval)
 	if(arg != 0)
 	{
 		MemoryContext currCtx = Invocation_switchToUpperContext();
-		arg = FunctionCall1(&self->coerceFunction, arg);
+		arg = _Coerce_call(self, arg);
 		MemoryContextSwitchTo(currCtx);
 	}
 	return arg;
@@ -81,7 +126,22 @@ static const char* _Coerce_getJNISignature(Type self)
 static Type _Coerce_create(TypeClass coerceClass, Type innerType, Type outerType, Oid coerceFunctionID)
 {
 	Coerce self = (Coerce)TypeClass_allocInstance(coerceClass, Type_getOid(outerType));
-	fmgr_info_cxt(coerceFunctionID, &self->coerceFunction, GetMemoryChunkContext(self));
+	MemoryContext cxt = GetMemoryChunkContext(self);
+	fmgr_info_cxt(coerceFunctionID, &self->coerceFunction, cxt);
+#if PG_VERSION_NUM >= 120000
+	self->coerceCall = MemoryContextAlloc(cxt, SizeForFunctionCallInfo(1));
+#else
+	self->coerceCall = MemoryContextAlloc(cxt, sizeof (FunctionCallInfoData));
+#endif
+#if PG_VERSION_NUM >= 90100
+	InitFunctionCallInfoData(*self->coerceCall, &self->coerceFunction, 1,
+		InvalidOid, /* collation */
+		NULL, NULL);
+#else
+	InitFunctionCallInfoData(*self->coerceCall, &self->coerceFunction, 1,
+		NULL, NULL);
+#endif
+	self->coerceCallBusy = false;
 	self->innerType = innerType;
 	self->outerType = outerType;
 	if(Type_isPrimitive(self->innerType))
@@ -18,6 +18,7 @@
 #include "pljava/type/Composite.h"
 #include "pljava/type/TupleDesc.h"
 #include "pljava/type/SingleRowReader.h"
+#include "pljava/Function.h"
 #include "pljava/Invocation.h"
 #include "org_postgresql_pljava_jdbc_SingleRowReader.h"
 
@@ -49,6 +50,31 @@ static jmethodID s_ResultSetPicker_init;
 static jclass s_SingleRowWriter_class;
 static jmethodID s_SingleRowWriter_init;
 static jmethodID s_SingleRowWriter_getTupleAndClear;
+static jmethodID s_SingleRowWriter_cancelRowUpdates;
+
+/*
+ * A SingleRowWriter kept for one call site of a function returning
+ * a composite, so each call need not make a new one (and a new Java TupleDesc,
+ * and for RECORD a new native copy of the descriptor). The writer's global
+ * reference is released when fn_mcxt is, typically at the end of the query.
+ * The writer is cleared before reuse if the previous call could have left
+ * values in it: if the function threw, or returned false after writing.
+ */
+typedef struct
+{
+#if PG_VERSION_NUM >= 90500
+	MemoryContextCallback cb;
+#endif
+	jobject writer;
+	bool    dirty;
+} WriterCache;
+
+#if PG_VERSION_NUM >= 90500
+static void _releaseWriter(void *arg)
+{
+	JNI_deleteGlobalRef(((WriterCache *)arg)->writer);
+}
+#endif
 
 static TypeClass s_CompositeClass;
 
@@ -80,10 +106,45 @@ static Datum _Composite_invoke(Type self, Function fn, PG_FUNCTION_ARGS)
 {
 	bool hasRow;
 	Datum result = 0;
-	TupleDesc tupleDesc = Type_getTupleDesc(self, fcinfo);
-	jobject jtd = pljava_TupleDesc_create(tupleDesc);
+	TupleDesc tupleDesc;
+	jobject jtd = NULL;
 	jvalue singleRowWriter;
-	singleRowWriter.l = _createWriter(jtd);
+	WriterCache *wc = NULL;
+#if PG_VERSION_NUM >= 90500
+	void **state = pljava_Function_callSiteState(fn, fcinfo);
+
+	if ( NULL != state )
+	{
+		wc = (WriterCache *)*state;
+		if ( NULL == wc )
+		{
+			tupleDesc = Type_getTupleDesc(self, fcinfo);
+			jtd = pljava_TupleDesc_create(tupleDesc);
+			singleRowWriter.l = _createWriter(jtd);
+			wc = (WriterCache *)MemoryContextAllocZero(
+				fcinfo->flinfo->fn_mcxt, sizeof *wc);
+			wc->writer = JNI_newGlobalRef(singleRowWriter.l);
+			wc->cb.func = _releaseWriter;
+			wc->cb.arg = wc;
+			MemoryContextRegisterResetCallback(
+				fcinfo->flinfo->fn_mcxt, &wc->cb);
+			*state = wc;
+			JNI_deleteLocalRef(jtd);
+			JNI_deleteLocalRef(singleRowWriter.l);
+			jtd = NULL;
+		}
+		else if ( wc->dirty )
+			JNI_callVoidMethod(wc->writer, s_SingleRowWriter_cancelRowUpdates);
+		singleRowWriter.l = wc->writer;
+		wc->dirty = true;
+	}
+	else
+#endif
+	{
+		tupleDesc = Type_getTupleDesc(self, fcinfo);
+		jtd = pljava_TupleDesc_create(tupleDesc);
+		singleRowWriter.l = _createWriter(jtd);
+	}
 	/*
 	 * Caller guarantees room for one extra reference parameter, so it will go
 	 * at index (length - 1).
@@ -101,10 +162,15 @@ static Datum _Composite_invoke(Type self, Function fn, PG_FUNCTION_ARGS)
 		HeapTuple tuple = _getTupleAndClear(singleRowWriter.l);
 	    result = HeapTupleGetDatum(tuple);
 		MemoryContextSwitchTo(currCtx);
+		if ( NULL != wc )
+			wc->dirty = false;
 	}
 	else
 		fcinfo->isnull = true;
 
+	if ( NULL != wc )
+		return result;
+
 	JNI_deleteLocalRef(jtd);
 	JNI_deleteLocalRef(singleRowWriter.l);
 	return result;
@@ -219,6 +285,7 @@ void Composite_initialize(void)
 	s_SingleRowWriter_class = JNI_newGlobalRef(PgObject_getJavaClass("org/postgresql/pljava/jdbc/SingleRowWriter"));
 	s_SingleRowWriter_init = PgObject_getJavaMethod(s_SingleRowWriter_class, "<init>", "(Lorg/postgresql/pljava/internal/TupleDesc;)V");
 	s_SingleRowWriter_getTupleAndClear = PgObject_getJavaMethod(s_SingleRowWriter_class, "getTupleAndClear", "()J");
+	s_SingleRowWriter_cancelRowUpdates = PgObject_getJavaMethod(s_SingleRowWriter_class, "cancelRowUpdates", "()V");
 
 	s_ResultSetProvider_class = JNI_newGlobalRef(PgObject_getJavaClass("org/postgresql/pljava/ResultSetProvider"));
 	s_ResultSetProvider_assignRowValues = PgObject_getJavaMethod(s_ResultSetProvider_class, "assignRowValues", "(Ljava/sql/ResultSet;I)Z");
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2004-2020 Tada AB and other contributors, as listed below.
+ * Copyright (c) 2004-2026 Tada AB and other contributors, as listed below.
  *
  * All rights reserved. This program and the accompanying materials
  * are made available under the terms of the The BSD 3-Clause License
@@ -52,19 +52,11 @@ static jvalue _doubleArray_coerceDatum(Type self, Datum arg)
 
 	if(ARR_HASNULL(v))
 	{
-		jsize idx;
 		jboolean isCopy = JNI_FALSE;
-		bits8* nullBitMap = ARR_NULLBITMAP(v);
-		jdouble* values = (jdouble*)ARR_DATA_PTR(v);
-		jdouble* elems  = JNI_getDoubleArrayElements(doubleArray, &isCopy);
-		for(idx = 0; idx < nElems; ++idx)
-		{
-			if(arrayIsNull(nullBitMap, idx))
-				elems[idx] = 0;
-			else
-				elems[idx] = *values++;
-		}
-		JNI_releaseDoubleArrayElements(doubleArray, elems, JNI_COMMIT);
+		jdouble* elems = JNI_getDoubleArrayElements(doubleArray, &isCopy);
+		arrayExpandNulls((char*)elems, ARR_DATA_PTR(v), ARR_NULLBITMAP(v),
+			0, nElems, sizeof(jdouble));
+		JNI_releaseDoubleArrayElements(doubleArray, elems, 0);
 	}
 	else
 		JNI_setDoubleArrayRegion(doubleArray, 0, nElems, (jdouble*)ARR_DATA_PTR(v));
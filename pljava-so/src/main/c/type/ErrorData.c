@@ -23,7 +23,7 @@ static jclass    s_ErrorData_class;
 static jmethodID s_ErrorData_init;
 static jmethodID s_ErrorData_getNativePointer;
 
-jobject pljava_ErrorData_getCurrentError(void)
+jobject pljava_ErrorData_getCurrentError(ErrorData **copy)
 {
 	Ptr2Long p2l;
 	jobject jed;
@@ -31,6 +31,8 @@ jobject pljava_ErrorData_getCurrentError(void)
 	MemoryContext curr = MemoryContextSwitchTo(JavaMemoryContext);
 	ErrorData* errorData = CopyErrorData();
 	MemoryContextSwitchTo(curr);
+	if ( NULL != copy )
+		*copy = errorData;
 
 	p2l.longVal = 0L; /* ensure that the rest is zeroed out */
 	p2l.ptrVal = errorData;
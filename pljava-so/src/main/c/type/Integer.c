@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2004-2020 Tada AB and other contributors, as listed below.
+ * Copyright (c) 2004-2026 Tada AB and other contributors, as listed below.
  *
  * All rights reserved. This program and the accompanying materials
  * are made available under the terms of the The BSD 3-Clause License
@@ -15,11 +15,35 @@
 #include "pljava/type/Array.h"
 #include "pljava/Invocation.h"
 
+#include <utils/lsyscache.h>
+
 static TypeClass s_intClass;
 static jclass    s_Integer_class;
-static jmethodID s_Integer_init;
+static jmethodID s_Integer_valueOf;
 static jmethodID s_Integer_intValue;
 
+/*
+ * Whether an int (or Integer) can stand for a value of type other without
+ * conversion: besides its own type, a date, whose Datum is the int32 count of
+ * days from 1 January 2000. This lets a function take or return such values
+ * raw, converting them only if and when it needs to.
+ */
+static bool _rawReplaces(Type other)
+{
+	Oid oid = Type_getOid(other);
+	return DATEOID == oid;
+}
+
+/*
+ * The element type of the array type self, which is INT4OID unless this array
+ * type has been made for one of the types in _rawReplaces.
+ */
+static Oid _elementOid(Type self)
+{
+	Oid elemOid = get_element_type(Type_getOid(self));
+	return InvalidOid == elemOid ? INT4OID : elemOid;
+}
+
 /*
  * int primitive type.
  */
@@ -29,6 +53,11 @@ static Datum _int_invoke(Type self, Function fn, PG_FUNCTION_ARGS)
 	return Int32GetDatum(iv);
 }
 
+static bool _int_canReplace(Type self, Type other)
+{
+	return Type_getClass(self) == Type_getClass(other)  ||  _rawReplaces(other);
+}
+
 static jvalue _int_coerceDatum(Type self, Datum arg)
 {
 	jvalue result;
@@ -45,19 +74,11 @@ static jvalue _intArray_coerceDatum(Type self, Datum arg)
 
 	if(ARR_HASNULL(v))
 	{
-		jsize idx;
 		jboolean isCopy = JNI_FALSE;
-		bits8* nullBitMap = ARR_NULLBITMAP(v);
-		jint* values = (jint*)ARR_DATA_PTR(v);
-		jint* elems  = JNI_getIntArrayElements(intArray, &isCopy);
-		for(idx = 0; idx < nElems; ++idx)
-		{
-			if(arrayIsNull(nullBitMap, idx))
-				elems[idx] = 0;
-			else
-				elems[idx] = *values++;
-		}
-		JNI_releaseIntArrayElements(intArray, elems, JNI_COMMIT);
+		jint* elems = JNI_getIntArrayElements(intArray, &isCopy);
+		arrayExpandNulls((char*)elems, ARR_DATA_PTR(v), ARR_NULLBITMAP(v),
+			0, nElems, sizeof(jint));
+		JNI_releaseIntArrayElements(intArray, elems, 0);
 	}
 	else
 		JNI_setIntArrayRegion(intArray, 0, nElems, (jint*)ARR_DATA_PTR(v));
@@ -75,7 +96,7 @@ static Datum _intArray_coerceObject(Type self, jobject intArray)
 
 	nElems = JNI_getArrayLength((jarray)intArray);
 
-	v = createArrayType(nElems, sizeof(jint), INT4OID, false);
+	v = createArrayType(nElems, sizeof(jint), _elementOid(self), false);
 
 	JNI_getIntArrayRegion(
 			(jintArray)intArray, 0, nElems, (jint*)ARR_DATA_PTR(v));
@@ -89,13 +110,15 @@ static Datum _intArray_coerceObject(Type self, jobject intArray)
 static bool _Integer_canReplace(Type self, Type other)
 {
 	TypeClass cls = Type_getClass(other);
-	return Type_getClass(self) == cls || cls == s_intClass;
+	return Type_getClass(self) == cls || cls == s_intClass
+		||  _rawReplaces(other);
 }
 
 static jvalue _Integer_coerceDatum(Type self, Datum arg)
 {
 	jvalue result;
-	result.l = JNI_newObject(s_Integer_class, s_Integer_init, DatumGetInt32(arg));
+	result.l = JNI_callStaticObjectMethod(s_Integer_class, s_Integer_valueOf,
+		DatumGetInt32(arg));
 	return result;
 }
 
@@ -119,7 +142,8 @@ void Integer_initialize(void)
 	TypeClass cls;
 
 	s_Integer_class = JNI_newGlobalRef(PgObject_getJavaClass("java/lang/Integer"));
-	s_Integer_init = PgObject_getJavaMethod(s_Integer_class, "<init>", "(I)V");
+	s_Integer_valueOf = PgObject_getStaticJavaMethod(s_Integer_class,
+		"valueOf", "(I)Ljava/lang/Integer;");
 	s_Integer_intValue = PgObject_getJavaMethod(s_Integer_class, "intValue", "()I");
 
 	cls = TypeClass_alloc("type.Integer");
@@ -131,6 +155,7 @@ void Integer_initialize(void)
 	t_Integer = TypeClass_allocInstance(cls, INT4OID);
 
 	cls = TypeClass_alloc("type.int");
+	cls->canReplaceType = _int_canReplace;
 	cls->JNISignature = "I";
 	cls->javaTypeName = "int";
 	cls->invoke       = _int_invoke;
@@ -0,0 +1,539 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+#include <postgres.h>
+
+#include "pljava/type/Type_priv.h"
+
+#if PG_VERSION_NUM >= 90400
+#include <catalog/pg_type.h>
+#include <mb/pg_wchar.h>
+#include <utils/builtins.h>
+#include <utils/jsonb.h>
+#include <utils/numeric.h>
+
+#include "org_postgresql_pljava_jdbc_JsonbImpl.h"
+#include "pljava/DualState.h"
+#include "pljava/Exception.h"
+#include "pljava/Invocation.h"
+#include "pljava/type/String.h"
+
+/*
+ * A mapping of jsonb to org.postgresql.pljava.Jsonb. It is not the default
+ * mapping (which remains String), but is chosen by declaring that Java type.
+ *
+ * In the direction from PostgreSQL, an object or array is passed as a
+ * JsonbImpl viewing a JsonbContainer, and lookups in it are made here with the
+ * jsonb functions, without rendering the value as text. The value is first
+ * copied into the Invocation's upper memory context, as the datum given may lie
+ * in memory that does not last as long (an SPI tuple table is freed by the next
+ * fetch or by closing the ResultSet); the view is valid for the current
+ * Invocation. A jsonb that is a bare scalar is passed as the Jsonb a Builder
+ * makes.
+ *
+ * In the direction to PostgreSQL, a JsonbImpl has its container copied, one
+ * made by a Builder (a JsonbTree) is formed with pushJsonbValue from the token
+ * stream described in JsonbTree.java, and any other Jsonb is parsed from its
+ * toJson() text by jsonb_in.
+ */
+
+static TypeClass s_JsonbClass;
+static Type      s_JsonbInstance;
+
+static jclass    s_JsonbImpl_class;
+static jmethodID s_JsonbImpl_init;
+static jmethodID s_JsonbImpl_scalar;
+static jmethodID s_JsonbImpl_pointer;
+static jmethodID s_JsonbImpl_length;
+static jclass    s_JsonbTree_class;
+static jmethodID s_JsonbTree_encoded;
+static jmethodID s_Jsonb_toJson;
+static jclass    s_Boolean_class;
+static jmethodID s_Boolean_valueOf;
+
+#define ContainerSize(c) ((int)((c)->header & JB_CMASK))
+#define ContainerIsObject(c) (0 != ((c)->header & JB_FOBJECT))
+
+/*
+ * Return a found JsonbValue as a Java Jsonb: a new view for an object or
+ * array, else the scalar as made by JsonbImpl.scalar.
+ */
+static jobject toJava(JsonbValue* v)
+{
+	Ptr2Long p2lc;
+	Ptr2Long p2lro;
+	jobject value = 0;
+	jobject result;
+	jboolean isJsonNull = JNI_FALSE;
+	char* s;
+
+	switch ( v->type )
+	{
+	case jbvBinary:
+		p2lc.longVal = 0L;
+		p2lro.longVal = 0L;
+		p2lc.ptrVal = v->val.binary.data;
+		p2lro.ptrVal = currentInvocation;
+		return JNI_newObjectLocked(s_JsonbImpl_class, s_JsonbImpl_init,
+			pljava_DualState_key(), p2lro.longVal, p2lc.longVal,
+			(jint)v->val.binary.len,
+			ContainerIsObject(v->val.binary.data) ? JNI_TRUE : JNI_FALSE);
+	case jbvString:
+		s = pnstrdup(v->val.string.val, v->val.string.len);
+		value = String_createJavaStringFromNTS(s);
+		pfree(s);
+		break;
+	case jbvNumeric:
+		value = Type_coerceDatum(Type_fromOid(NUMERICOID, 0),
+			NumericGetDatum(v->val.numeric)).l;
+		break;
+	case jbvBool:
+		value = JNI_callStaticObjectMethod(s_Boolean_class, s_Boolean_valueOf,
+			v->val.boolean ? JNI_TRUE : JNI_FALSE);
+		break;
+	case jbvNull:
+		isJsonNull = JNI_TRUE;
+		break;
+	default:
+		elog(ERROR, "unexpected jsonb value type %d", (int)v->type);
+	}
+
+	result = JNI_callStaticObjectMethodLocked(
+		s_JsonbImpl_class, s_JsonbImpl_scalar, value, isJsonNull);
+	JNI_deleteLocalRef(value);
+	return result;
+}
+
+static bool _Jsonb_canReplaceType(Type self, Type other)
+{
+	return Type_getClass(other) == s_JsonbClass
+		|| Type_getOid(other) == JSONBOID;
+}
+
+static jvalue _Jsonb_coerceDatum(Type self, Datum arg)
+{
+	jvalue result;
+	Jsonb* jb = (Jsonb*)PG_DETOAST_DATUM(arg);
+	JsonbContainer* root = &jb->root;
+
+	if ( root->header & JB_FSCALAR )
+		result.l = toJava(getIthJsonbValueFromContainer(root, 0));
+	else
+	{
+		/* a JsonbValue of the root of a copy, so toJava makes the view */
+		JsonbValue v;
+		Jsonb* copy;
+		MemoryContext currCtx = Invocation_switchToUpperContext();
+		copy = (Jsonb*)palloc(VARSIZE(jb));
+		MemoryContextSwitchTo(currCtx);
+		memcpy(copy, jb, VARSIZE(jb));
+		if ( (Pointer)jb != DatumGetPointer(arg) )
+			pfree(jb);
+		v.type = jbvBinary;
+		v.val.binary.data = &copy->root;
+		v.val.binary.len = VARSIZE(copy) - VARHDRSZ;
+		result.l = toJava(&v);
+	}
+	return result;
+}
+
+static uint32 tokenLength(const unsigned char** p, const unsigned char* end)
+{
+	const unsigned char* q = *p;
+	uint32 n;
+	if ( end - q < 4 )
+		elog(ERROR, "malformed jsonb token stream");
+	n = (uint32)q[0] << 24 | (uint32)q[1] << 16 | (uint32)q[2] << 8 | q[3];
+	q += 4;
+	if ( (uint32)(end - q) < n )
+		elog(ERROR, "malformed jsonb token stream");
+	*p = q;
+	return n;
+}
+
+/*
+ * Form a jsonb from the token stream of a JsonbTree.
+ */
+static Datum fromTokens(const unsigned char* p, const unsigned char* end)
+{
+	JsonbParseState* state = NULL;
+	JsonbValue* res = NULL;
+	JsonbValue v;
+	bool rawScalar = false;
+
+	while ( p < end )
+	{
+		int seq;
+		uint32 n;
+		char* s;
+		unsigned char t = *p++;
+
+		if ( NULL == state  &&  NULL != res )
+			elog(ERROR, "malformed jsonb token stream");
+
+		switch ( t )
+		{
+		case '{':
+			res = pushJsonbValue(&state, WJB_BEGIN_OBJECT, NULL);
+			continue;
+		case '}':
+			res = pushJsonbValue(&state, WJB_END_OBJECT, NULL);
+			continue;
+		case '[':
+			res = pushJsonbValue(&state, WJB_BEGIN_ARRAY, NULL);
+			continue;
+		case ']':
+			res = pushJsonbValue(&state, WJB_END_ARRAY, NULL);
+			continue;
+		case 'k':
+		case 's':
+			n = tokenLength(&p, end);
+			s = pg_any_to_server((char*)p, (int)n, PG_UTF8);
+			v.type = jbvString;
+			v.val.string.val = s;
+			v.val.string.len = ((const char*)p == s) ? (int)n : strlen(s);
+			p += n;
+			break;
+		case 'n':
+			n = tokenLength(&p, end);
+			s = pnstrdup((const char*)p, n);
+			v.type = jbvNumeric;
+			v.val.numeric = DatumGetNumeric(DirectFunctionCall3(numeric_in,
+				CStringGetDatum(s), ObjectIdGetDatum(InvalidOid),
+				Int32GetDatum(-1)));
+			pfree(s);
+			p += n;
+			break;
+		case 't':
+		case 'f':
+			v.type = jbvBool;
+			v.val.boolean = ('t' == t);
+			break;
+		case 'z':
+			v.type = jbvNull;
+			break;
+		default:
+			elog(ERROR, "malformed jsonb token stream");
+		}
+
+		if ( NULL == state )
+		{
+			/* a bare scalar is kept as a one-element 'raw scalar' array */
+			JsonbValue va;
+			va.type = jbvArray;
+			va.val.array.rawScalar = true;
+			va.val.array.nElems = 1;
+			pushJsonbValue(&state, WJB_BEGIN_ARRAY, &va);
+			rawScalar = true;
+		}
+
+		if ( 'k' == t )
+			seq = WJB_KEY;
+		else if ( jbvObject == state->contVal.type )
+			seq = WJB_VALUE;
+		else
+			seq = WJB_ELEM;
+		res = pushJsonbValue(&state, seq, &v);
+
+		if ( rawScalar )
+		{
+			res = pushJsonbValue(&state, WJB_END_ARRAY, NULL);
+			rawScalar = false;
+		}
+	}
+
+	if ( NULL != state  ||  NULL == res )
+		elog(ERROR, "malformed jsonb token stream");
+	return PointerGetDatum(JsonbValueToJsonb(res));
+}
+
+static Datum _Jsonb_coerceObject(Type self, jobject jsonb)
+{
+	Datum result;
+
+	if ( jsonb == 0 )
+		return 0;
+
+	if ( JNI_isInstanceOf(jsonb, s_JsonbImpl_class) )
+	{
+		Ptr2Long p2l;
+		JsonbValue v;
+		p2l.longVal = JNI_callLongMethodLocked(jsonb, s_JsonbImpl_pointer);
+		v.type = jbvBinary;
+		v.val.binary.data = (JsonbContainer*)p2l.ptrVal;
+		v.val.binary.len = JNI_callIntMethodLocked(jsonb, s_JsonbImpl_length);
+		result = PointerGetDatum(JsonbValueToJsonb(&v));
+	}
+	else if ( JNI_isInstanceOf(jsonb, s_JsonbTree_class) )
+	{
+		jbyteArray tokens = (jbyteArray)JNI_callObjectMethodLocked(
+			jsonb, s_JsonbTree_encoded);
+		jsize n = JNI_getArrayLength((jarray)tokens);
+		unsigned char* bytes = palloc(n);
+		JNI_getByteArrayRegion(tokens, 0, n, (jbyte*)bytes);
+		JNI_deleteLocalRef(tokens);
+		result = fromTokens(bytes, bytes + n);
+		pfree(bytes);
+	}
+	else
+	{
+		jstring json = (jstring)JNI_callObjectMethod(jsonb, s_Jsonb_toJson);
+		char* s = String_createNTS(json);
+		JNI_deleteLocalRef(json);
+		result = DirectFunctionCall1(jsonb_in, CStringGetDatum(s));
+		pfree(s);
+	}
+	return result;
+}
+
+static Type _Jsonb_obtain(Oid typeId)
+{
+	if ( NULL == s_JsonbInstance )
+		s_JsonbInstance = TypeClass_allocInstance(s_JsonbClass, JSONBOID);
+	return s_JsonbInstance;
+}
+
+/* Make this datatype available to the postgres system.
+ */
+extern void Jsonb_initialize(void);
+void Jsonb_initialize(void)
+{
+	jclass cls;
+	JNINativeMethod methods[] =
+	{
+		{
+		"_size",
+		"(J)I",
+		Java_org_postgresql_pljava_jdbc_JsonbImpl__1size
+		},
+		{
+		"_keys",
+		"(J)[Ljava/lang/String;",
+		Java_org_postgresql_pljava_jdbc_JsonbImpl__1keys
+		},
+		{
+		"_get",
+		"(JLjava/lang/String;)Lorg/postgresql/pljava/Jsonb;",
+		Java_org_postgresql_pljava_jdbc_JsonbImpl__1get
+		},
+		{
+		"_getElement",
+		"(JI)Lorg/postgresql/pljava/Jsonb;",
+		Java_org_postgresql_pljava_jdbc_JsonbImpl__1getElement
+		},
+		{
+		"_toJson",
+		"(JI)Ljava/lang/String;",
+		Java_org_postgresql_pljava_jdbc_JsonbImpl__1toJson
+		},
+		{ 0, 0, 0 }
+	};
+
+	cls = PgObject_getJavaClass("org/postgresql/pljava/jdbc/JsonbImpl");
+	PgObject_registerNatives2(cls, methods);
+	s_JsonbImpl_init = PgObject_getJavaMethod(cls, "<init>",
+		"(Lorg/postgresql/pljava/internal/DualState$Key;JJIZ)V");
+	s_JsonbImpl_scalar = PgObject_getStaticJavaMethod(cls, "scalar",
+		"(Ljava/lang/Object;Z)Lorg/postgresql/pljava/Jsonb;");
+	s_JsonbImpl_pointer = PgObject_getJavaMethod(cls, "pointer", "()J");
+	s_JsonbImpl_length = PgObject_getJavaMethod(cls, "length", "()I");
+	s_JsonbImpl_class = JNI_newGlobalRef(cls);
+	JNI_deleteLocalRef(cls);
+
+	cls = PgObject_getJavaClass("org/postgresql/pljava/JsonbTree");
+	s_JsonbTree_encoded = PgObject_getJavaMethod(cls, "encoded", "()[B");
+	s_JsonbTree_class = JNI_newGlobalRef(cls);
+	JNI_deleteLocalRef(cls);
+
+	cls = PgObject_getJavaClass("org/postgresql/pljava/Jsonb");
+	s_Jsonb_toJson = PgObject_getJavaMethod(cls, "toJson",
+		"()Ljava/lang/String;");
+	JNI_deleteLocalRef(cls);
+
+	cls = PgObject_getJavaClass("java/lang/Boolean");
+	s_Boolean_valueOf = PgObject_getStaticJavaMethod(cls, "valueOf",
+		"(Z)Ljava/lang/Boolean;");
+	s_Boolean_class = JNI_newGlobalRef(cls);
+	JNI_deleteLocalRef(cls);
+
+	s_JsonbClass = TypeClass_alloc("type.Jsonb");
+	s_JsonbClass->JNISignature   = "Lorg/postgresql/pljava/Jsonb;";
+	s_JsonbClass->javaTypeName   = "org.postgresql.pljava.Jsonb";
+	s_JsonbClass->canReplaceType = _Jsonb_canReplaceType;
+	s_JsonbClass->coerceDatum    = _Jsonb_coerceDatum;
+	s_JsonbClass->coerceObject   = _Jsonb_coerceObject;
+	Type_registerType2(InvalidOid, s_JsonbClass->javaTypeName, _Jsonb_obtain);
+}
+
+/****************************************
+ * JNI methods
+ ****************************************/
+
+/*
+ * Class:     org_postgresql_pljava_jdbc_JsonbImpl
+ * Method:    _size
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL
+Java_org_postgresql_pljava_jdbc_JsonbImpl__1size(JNIEnv* env, jclass cls, jlong container)
+{
+	Ptr2Long p2l;
+	p2l.longVal = container;
+	return ContainerSize((JsonbContainer*)p2l.ptrVal);
+}
+
+/*
+ * Class:     org_postgresql_pljava_jdbc_JsonbImpl
+ * Method:    _keys
+ * Signature: (J)[Ljava/lang/String;
+ */
+JNIEXPORT jobjectArray JNICALL
+Java_org_postgresql_pljava_jdbc_JsonbImpl__1keys(JNIEnv* env, jclass cls, jlong container)
+{
+	jobjectArray result = 0;
+	Ptr2Long p2l;
+	p2l.longVal = container;
+
+	BEGIN_NATIVE
+	PG_TRY();
+	{
+		JsonbContainer* c = (JsonbContainer*)p2l.ptrVal;
+		JsonbIterator* it = JsonbIteratorInit(c);
+		JsonbValue v;
+		jsize idx = 0;
+		int tok;
+
+		result = JNI_newObjectArray(ContainerSize(c), s_String_class, 0);
+		tok = JsonbIteratorNext(&it, &v, false); /* WJB_BEGIN_OBJECT */
+		while ( WJB_DONE != (tok = JsonbIteratorNext(&it, &v, true)) )
+		{
+			if ( WJB_KEY == tok )
+			{
+				char* s = pnstrdup(v.val.string.val, v.val.string.len);
+				jstring key = String_createJavaStringFromNTS(s);
+				pfree(s);
+				JNI_setObjectArrayElement(result, idx++, key);
+				JNI_deleteLocalRef(key);
+			}
+		}
+	}
+	PG_CATCH();
+	{
+		Exception_throw_ERROR("JsonbIteratorNext");
+	}
+	PG_END_TRY();
+	END_NATIVE
+	return result;
+}
+
+/*
+ * Class:     org_postgresql_pljava_jdbc_JsonbImpl
+ * Method:    _get
+ * Signature: (JLjava/lang/String;)Lorg/postgresql/pljava/Jsonb;
+ */
+JNIEXPORT jobject JNICALL
+Java_org_postgresql_pljava_jdbc_JsonbImpl__1get(JNIEnv* env, jclass cls, jlong container, jstring key)
+{
+	jobject result = 0;
+	Ptr2Long p2l;
+	p2l.longVal = container;
+
+	BEGIN_NATIVE
+	PG_TRY();
+	{
+		JsonbValue k;
+		JsonbValue* v;
+		char* s = String_createNTS(key);
+		k.type = jbvString;
+		k.val.string.val = s;
+		k.val.string.len = strlen(s);
+		v = findJsonbValueFromContainer(
+			(JsonbContainer*)p2l.ptrVal, JB_FOBJECT, &k);
+		pfree(s);
+		if ( NULL != v )
+			result = toJava(v);
+	}
+	PG_CATCH();
+	{
+		Exception_throw_ERROR("findJsonbValueFromContainer");
+	}
+	PG_END_TRY();
+	END_NATIVE
+	return result;
+}
+
+/*
+ * Class:     org_postgresql_pljava_jdbc_JsonbImpl
+ * Method:    _getElement
+ * Signature: (JI)Lorg/postgresql/pljava/Jsonb;
+ */
+JNIEXPORT jobject JNICALL
+Java_org_postgresql_pljava_jdbc_JsonbImpl__1getElement(JNIEnv* env, jclass cls, jlong container, jint index)
+{
+	jobject result = 0;
+	Ptr2Long p2l;
+	p2l.longVal = container;
+
+	BEGIN_NATIVE
+	PG_TRY();
+	{
+		JsonbValue* v = getIthJsonbValueFromContainer(
+			(JsonbContainer*)p2l.ptrVal, (uint32)index);
+		if ( NULL != v )
+			result = toJava(v);
+	}
+	PG_CATCH();
+	{
+		Exception_throw_ERROR("getIthJsonbValueFromContainer");
+	}
+	PG_END_TRY();
+	END_NATIVE
+	return result;
+}
+
+/*
+ * Class:     org_postgresql_pljava_jdbc_JsonbImpl
+ * Method:    _toJson
+ * Signature: (JI)Ljava/lang/String;
+ */
+JNIEXPORT jstring JNICALL
+Java_org_postgresql_pljava_jdbc_JsonbImpl__1toJson(JNIEnv* env, jclass cls, jlong container, jint length)
+{
+	jstring result = 0;
+	Ptr2Long p2l;
+	p2l.longVal = container;
+
+	BEGIN_NATIVE
+	PG_TRY();
+	{
+		char* s = JsonbToCString(
+			NULL, (JsonbContainer*)p2l.ptrVal, (int)length);
+		result = String_createJavaStringFromNTS(s);
+		pfree(s);
+	}
+	PG_CATCH();
+	{
+		Exception_throw_ERROR("JsonbToCString");
+	}
+	PG_END_TRY();
+	END_NATIVE
+	return result;
+}
+
+#else /* PG_VERSION_NUM < 90400 */
+
+/* There is no jsonb before PostgreSQL 9.4; nothing to map. */
+extern void Jsonb_initialize(void);
+void Jsonb_initialize(void)
+{
+}
+
+#endif
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2004-2020 Tada AB and other contributors, as listed below.
+ * Copyright (c) 2004-2026 Tada AB and other contributors, as listed below.
  *
  * All rights reserved. This program and the accompanying materials
  * are made available under the terms of the The BSD 3-Clause License
@@ -14,12 +14,42 @@
 #include "pljava/type/Type_priv.h"
 #include "pljava/type/Array.h"
 #include "pljava/Invocation.h"
+#include "pljava/Backend.h"
+
+#include <utils/lsyscache.h>
 
 static TypeClass s_longClass;
 static jclass    s_Long_class;
-static jmethodID s_Long_init;
+static jmethodID s_Long_valueOf;
 static jmethodID s_Long_longValue;
 
+/*
+ * Whether a long (or Long) can stand for a value of type other without
+ * conversion: besides its own type, a timestamp or timestamptz, whose Datum
+ * (with integer datetimes) is the int64 count of microseconds from 1 January
+ * 2000. This lets a function take or return such values raw, converting them
+ * only if and when it needs to.
+ */
+static bool _rawReplaces(Type other)
+{
+	Oid oid = Type_getOid(other);
+	return
+#if PG_VERSION_NUM < 100000
+		integerDateTimes  &&
+#endif
+		( TIMESTAMPOID == oid  ||  TIMESTAMPTZOID == oid );
+}
+
+/*
+ * The element type of the array type self, which is INT8OID unless this array
+ * type has been made for one of the types in _rawReplaces.
+ */
+static Oid _elementOid(Type self)
+{
+	Oid elemOid = get_element_type(Type_getOid(self));
+	return InvalidOid == elemOid ? INT8OID : elemOid;
+}
+
 /*
  * long primitive type.
  */
@@ -36,6 +66,11 @@ static Datum _long_invoke(Type self, Function fn, PG_FUNCTION_ARGS)
 	return _asDatum(pljava_Function_longInvoke(fn));
 }
 
+static bool _long_canReplace(Type self, Type other)
+{
+	return Type_getClass(self) == Type_getClass(other)  ||  _rawReplaces(other);
+}
+
 static jvalue _long_coerceDatum(Type self, Datum arg)
 {
 	jvalue result;
@@ -52,19 +87,11 @@ static jvalue _longArray_coerceDatum(Type self, Datum arg)
 
 	if(ARR_HASNULL(v))
 	{
-		jsize idx;
 		jboolean isCopy = JNI_FALSE;
-		bits8* nullBitMap = ARR_NULLBITMAP(v);
-		jlong* values = (jlong*)ARR_DATA_PTR(v);
-		jlong* elems  = JNI_getLongArrayElements(longArray, &isCopy);
-		for(idx = 0; idx < nElems; ++idx)
-		{
-			if(arrayIsNull(nullBitMap, idx))
-				elems[idx] = 0;
-			else
-				elems[idx] = *values++;
-		}
-		JNI_releaseLongArrayElements(longArray, elems, JNI_COMMIT);
+		jlong* elems = JNI_getLongArrayElements(longArray, &isCopy);
+		arrayExpandNulls((char*)elems, ARR_DATA_PTR(v), ARR_NULLBITMAP(v),
+			0, nElems, sizeof(jlong));
+		JNI_releaseLongArrayElements(longArray, elems, 0);
 	}
 	else
 		JNI_setLongArrayRegion(longArray, 0, nElems, (jlong*)ARR_DATA_PTR(v));
@@ -82,7 +109,7 @@ static Datum _longArray_coerceObject(Type self, jobject longArray)
 
 	nElems = JNI_getArrayLength((jarray)longArray);
 
-	v = createArrayType(nElems, sizeof(jlong), INT8OID, false);
+	v = createArrayType(nElems, sizeof(jlong), _elementOid(self), false);
 
 	JNI_getLongArrayRegion(
 			(jlongArray)longArray, 0, nElems, (jlong*)ARR_DATA_PTR(v));
@@ -96,13 +123,15 @@ static Datum _longArray_coerceObject(Type self, jobject longArray)
 static bool _Long_canReplace(Type self, Type other)
 {
 	TypeClass cls = Type_getClass(other);
-	return Type_getClass(self) == cls || cls == s_longClass;
+	return Type_getClass(self) == cls || cls == s_longClass
+		||  _rawReplaces(other);
 }
 
 static jvalue _Long_coerceDatum(Type self, Datum arg)
 {
 	jvalue result;
-	result.l = JNI_newObject(s_Long_class, s_Long_init, DatumGetInt64(arg));
+	result.l = JNI_callStaticObjectMethod(s_Long_class, s_Long_valueOf,
+		DatumGetInt64(arg));
 	return result;
 }
 
@@ -126,7 +155,8 @@ void Long_initialize(void)
 	TypeClass cls;
 
 	s_Long_class = JNI_newGlobalRef(PgObject_getJavaClass("java/lang/Long"));
-	s_Long_init = PgObject_getJavaMethod(s_Long_class, "<init>", "(J)V");
+	s_Long_valueOf = PgObject_getStaticJavaMethod(s_Long_class,
+		"valueOf", "(J)Ljava/lang/Long;");
 	s_Long_longValue = PgObject_getJavaMethod(s_Long_class, "longValue", "()J");
 
 	cls = TypeClass_alloc("type.Long");
@@ -138,6 +168,7 @@ void Long_initialize(void)
 	t_Long = TypeClass_allocInstance(cls, INT8OID);
 
 	cls = TypeClass_alloc("type.long");
+	cls->canReplaceType = _long_canReplace;
 	cls->JNISignature = "J";
 	cls->javaTypeName = "long";
 	cls->invoke       = _long_invoke;
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2004-2019 Tada AB and other contributors, as listed below.
+ * Copyright (c) 2004-2026 Tada AB and other contributors, as listed below.
  *
  * All rights reserved. This program and the accompanying materials
  * are made available under the terms of the The BSD 3-Clause License
@@ -21,6 +21,7 @@
 #include "pljava/DualState.h"
 #include "pljava/Exception.h"
 #include "pljava/Invocation.h"
+#include "pljava/SPI.h"
 #include "pljava/HashMap.h"
 #include "pljava/type/Type_priv.h"
 #include "pljava/type/TupleDesc.h"
@@ -31,13 +32,39 @@
 #include <miscadmin.h>
 #endif
 
+#define FETCH_DIR_FORWARD \
+		org_postgresql_pljava_internal_Portal_FETCH_FORWARD
+#define FETCH_DIR_BACKWARD \
+		org_postgresql_pljava_internal_Portal_FETCH_BACKWARD
+#define FETCH_DIR_ABSOLUTE \
+		org_postgresql_pljava_internal_Portal_FETCH_ABSOLUTE
+#define FETCH_DIR_RELATIVE \
+		org_postgresql_pljava_internal_Portal_FETCH_RELATIVE
+
 static jclass    s_Portal_class;
 static jmethodID s_Portal_init;
 
+static void holdablePortalCleanup(Portal portal);
+static FetchDirection fetchDirection(jint direction);
+static jobject fetchTable(Portal portal, FetchDirection direction, long count,
+	jobject td, jlongArray counts);
+
+/*
+ * A portal opened WITH HOLD outlives the resource owner of the transaction
+ * that opened it, so its Java counterpart is scoped to the portal itself, and
+ * released by this cleanup hook when PostgreSQL drops the portal, whether at
+ * abort of the opening transaction, by CLOSE, or at DISCARD.
+ */
+static void holdablePortalCleanup(Portal portal)
+{
+	pljava_DualState_nativeRelease(portal);
+	PortalCleanup(portal);
+}
+
 /*
  * org.postgresql.pljava.type.Portal type.
  */
-jobject pljava_Portal_create(Portal portal, jobject jplan)
+jobject pljava_Portal_create(Portal portal, jobject jplan, bool hold)
 {
 	jobject jportal;
 	Ptr2Long p2l;
@@ -49,7 +76,14 @@ jobject pljava_Portal_create(Portal portal, jobject jplan)
 	p2l.ptrVal = portal;
 
 	p2lro.longVal = 0L;
-	p2lro.ptrVal = portal->resowner;
+	if ( hold )
+	{
+		portal->cursorOptions |= CURSOR_OPT_HOLD;
+		portal->cleanup = holdablePortalCleanup;
+		p2lro.ptrVal = portal;
+	}
+	else
+		p2lro.ptrVal = portal->resowner;
 
 	jportal = JNI_newObjectLocked(s_Portal_class, s_Portal_init,
 		pljava_DualState_key(), p2lro.longVal, p2l.longVal, jplan);
@@ -57,6 +91,17 @@ jobject pljava_Portal_create(Portal portal, jobject jplan)
 	return jportal;
 }
 
+/*
+ * Close a portal from Java, first taking back the cleanup hook of a holdable
+ * one, as its Java counterpart is already being released.
+ */
+void pljava_Portal_close(Portal portal)
+{
+	if ( holdablePortalCleanup == portal->cleanup )
+		portal->cleanup = PortalCleanup;
+	SPI_cursor_close(portal);
+}
+
 /* Make this datatype available to the postgres system.
  */
 void pljava_Portal_initialize(void)
@@ -84,6 +129,16 @@ void pljava_Portal_initialize(void)
 	  	Java_org_postgresql_pljava_internal_Portal__1fetch
 		},
 		{
+		"_fetchTable",
+		"(JZJLorg/postgresql/pljava/internal/TupleDesc;[J)Lorg/postgresql/pljava/internal/TupleTable;",
+	  	Java_org_postgresql_pljava_internal_Portal__1fetchTable
+		},
+		{
+		"_scrollFetchTable",
+		"(JIJLorg/postgresql/pljava/internal/TupleDesc;[J)Lorg/postgresql/pljava/internal/TupleTable;",
+	  	Java_org_postgresql_pljava_internal_Portal__1scrollFetchTable
+		},
+		{
 		"_isAtEnd",
 	  	"(J)Z",
 	  	Java_org_postgresql_pljava_internal_Portal__1isAtEnd
@@ -98,6 +153,11 @@ void pljava_Portal_initialize(void)
 		"(JZJ)J",
 	  	Java_org_postgresql_pljava_internal_Portal__1move
 		},
+		{
+		"_scrollMove",
+		"(JIJ)J",
+	  	Java_org_postgresql_pljava_internal_Portal__1scrollMove
+		},
 		{ 0, 0, 0 }
 	};
 
@@ -161,6 +221,7 @@ Java_org_postgresql_pljava_internal_Portal__1fetch(JNIEnv* env, jclass clazz, jl
 			Invocation_assertConnect();
 			SPI_cursor_fetch((Portal)p2l.ptrVal, forward == JNI_TRUE,
 				(long)count);
+			Backend_configMayHaveChanged();
 			result = (jlong)SPI_processed;
 		}
 		PG_CATCH();
@@ -174,6 +235,121 @@ Java_org_postgresql_pljava_internal_Portal__1fetch(JNIEnv* env, jclass clazz, jl
 	return result;
 }
 
+/*
+ * The work of _fetch, SPI._getTupTableBytes, SPI._getTupTable, and
+ * SPI._freeTupTable in one call. If counts is not null, its first two elements
+ * receive the number of rows fetched and their total size in bytes.
+ */
+static jobject fetchTable(Portal portal, FetchDirection direction, long count,
+	jobject td, jlongArray counts)
+{
+	jobject result = 0;
+	bool fetched = false;
+
+	/* as in _fetch */
+	pljava_DualState_cleanEnqueuedInstances();
+
+	PG_TRY();
+	{
+		Invocation_assertConnect();
+		SPI_scroll_cursor_fetch(portal, direction, count);
+		Backend_configMayHaveChanged();
+		fetched = true;
+	}
+	PG_CATCH();
+	{
+		Exception_throw_ERROR("SPI_cursor_fetch");
+	}
+	PG_END_TRY();
+
+	if ( fetched )
+	{
+		if ( 0 != counts )
+		{
+			jlong values[2];
+			values[0] = (jlong)SPI_processed;
+			values[1] = pljava_SPI_tupTableBytes();
+			JNI_setLongArrayRegion(counts, 0, 2, values);
+		}
+		if ( 0 < SPI_processed )
+			result = pljava_SPI_createTupleTable(td);
+		if ( 0 != SPI_tuptable )
+		{
+			SPI_freetuptable(SPI_tuptable);
+			SPI_tuptable = 0;
+		}
+	}
+	return result;
+}
+
+/*
+ * The PostgreSQL FetchDirection for one of the FETCH_ constants of the Java
+ * Portal class.
+ */
+static FetchDirection fetchDirection(jint direction)
+{
+	switch ( direction )
+	{
+	case FETCH_DIR_BACKWARD: return FETCH_BACKWARD;
+	case FETCH_DIR_ABSOLUTE: return FETCH_ABSOLUTE;
+	case FETCH_DIR_RELATIVE: return FETCH_RELATIVE;
+	default:                 return FETCH_FORWARD;
+	}
+}
+
+/*
+ * Class:     org_postgresql_pljava_internal_Portal
+ * Method:    _fetchTable
+ * Signature: (JZJLorg/postgresql/pljava/internal/TupleDesc;[J)Lorg/postgresql/pljava/internal/TupleTable;
+ */
+JNIEXPORT jobject JNICALL
+Java_org_postgresql_pljava_internal_Portal__1fetchTable(JNIEnv* env, jclass clazz, jlong _this, jboolean forward, jlong count, jobject td, jlongArray counts)
+{
+	jobject result = 0;
+	if(_this != 0)
+	{
+		BEGIN_NATIVE
+		Ptr2Long p2l;
+		STACK_BASE_VARS
+		STACK_BASE_PUSH(env)
+		p2l.longVal = _this;
+		result = fetchTable((Portal)p2l.ptrVal,
+			forward == JNI_TRUE ? FETCH_FORWARD : FETCH_BACKWARD,
+			(long)count, td, counts);
+		STACK_BASE_POP()
+		END_NATIVE
+	}
+	return result;
+}
+
+/*
+ * Class:     org_postgresql_pljava_internal_Portal
+ * Method:    _scrollFetchTable
+ * Signature: (JIJLorg/postgresql/pljava/internal/TupleDesc;[J)Lorg/postgresql/pljava/internal/TupleTable;
+ *
+ * As _fetchTable, but through SPI_scroll_cursor_fetch, in any direction the
+ * portal allows; with FETCH_ABSOLUTE or FETCH_RELATIVE, count is the position
+ * and at most one row is fetched.
+ */
+JNIEXPORT jobject JNICALL
+Java_org_postgresql_pljava_internal_Portal__1scrollFetchTable(JNIEnv* env, jclass clazz, jlong _this, jint direction, jlong count, jobject td, jlongArray counts)
+{
+	jobject result = 0;
+	if(_this != 0)
+	{
+		BEGIN_NATIVE
+		Ptr2Long p2l;
+		STACK_BASE_VARS
+		STACK_BASE_PUSH(env)
+		p2l.longVal = _this;
+		result = fetchTable((Portal)p2l.ptrVal, fetchDirection(direction),
+			(long)count, td, counts);
+		STACK_BASE_POP()
+		END_NATIVE
+	}
+	return result;
+}
+
 /*
  * Class:     org_postgresql_pljava_internal_Portal
  * Method:    _getName
@@ -271,6 +447,7 @@ Java_org_postgresql_pljava_internal_Portal__1move(JNIEnv* env, jclass clazz, jlo
 		{
 			Invocation_assertConnect();
 			SPI_cursor_move((Portal)p2l.ptrVal, forward == JNI_TRUE, (long)count);
+			Backend_configMayHaveChanged();
 			result = (jlong)SPI_processed;
 		}
 		PG_CATCH();
@@ -283,3 +460,39 @@ Java_org_postgresql_pljava_internal_Portal__1move(JNIEnv* env, jclass clazz, jlo
 	}
 	return result;
 }
+
+/*
+ * Class:     org_postgresql_pljava_internal_Portal
+ * Method:    _scrollMove
+ * Signature: (JIJ)J
+ */
+JNIEXPORT jlong JNICALL
+Java_org_postgresql_pljava_internal_Portal__1scrollMove(JNIEnv* env, jclass clazz, jlong _this, jint direction, jlong count)
+{
+	jlong result = 0;
+	if(_this != 0)
+	{
+		BEGIN_NATIVE
+		Ptr2Long p2l;
+		STACK_BASE_VARS
+		STACK_BASE_PUSH(env)
+
+		p2l.longVal = _this;
+		PG_TRY();
+		{
+			Invocation_assertConnect();
+			SPI_scroll_cursor_move((Portal)p2l.ptrVal,
+				fetchDirection(direction), (long)count);
+			Backend_configMayHaveChanged();
+			result = (jlong)SPI_processed;
+		}
+		PG_CATCH();
+		{
+			Exception_throw_ERROR("SPI_scroll_cursor_move");
+		}
+		PG_END_TRY();
+		STACK_BASE_POP()
+		END_NATIVE
+	}
+	return result;
+}
@@ -0,0 +1,263 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+#include <postgres.h>
+#include <utils/array.h>
+#include <utils/lsyscache.h>
+
+#include "pljava/type/Type_priv.h"
+#include "pljava/type/Array.h"
+
+/*
+ * Mappings of PostgreSQL int4[], int8[], and float8[] to java.nio.IntBuffer,
+ * LongBuffer, and DoubleBuffer. These are not the default mappings for those
+ * types (int[], long[], and double[] remain so), but can be chosen with an
+ * explicit signature in a function's AS string, or with the getObject(..,
+ * Class) JDBC methods.
+ *
+ * In the direction from PostgreSQL to Java, the buffer is a read-only view of
+ * a copy of the array's data region in the Java heap, made in one region copy
+ * into a byte array, with no per-element conversion. It is not a view of the
+ * data region itself, which lies in argument or tuple memory that can be freed
+ * (at the end of the call, or as a result set moves past an SPI batch) while
+ * Java code still holds the buffer. An array containing nulls has its non-null
+ * elements packed together in the data region; it is first expanded into a
+ * native copy with zero in place of each null, just as the mapping to a Java
+ * primitive array would do, and that is what is copied. Either way, the buffer
+ * may be retained by Java code after the call returns.
+ *
+ * In the direction from Java to PostgreSQL, the remaining elements of any
+ * buffer of the right class are copied in one bulk operation into the data
+ * region of a newly-constructed array.
+ */
+
+typedef struct
+{
+	const char* javaTypeName;
+	const char* className;
+	const char* JNISignature;
+	const char* viewMethod;
+	const char* putSignature;
+	const char* dupSignature;
+	Oid         elemTypeId;
+	size_t      elemSize;
+	TypeClass   typeClass;
+	Type        instance;
+	jclass      bufferClass;
+	jmethodID   view;
+	jmethodID   remaining;
+	jmethodID   duplicate;
+	jmethodID   put;
+} BufferKind;
+
+static BufferKind s_kinds[] =
+{
+	{
+		"java.nio.IntBuffer", "java/nio/IntBuffer", "Ljava/nio/IntBuffer;",
+		"asIntBuffer",
+		"(Ljava/nio/IntBuffer;)Ljava/nio/IntBuffer;", "()Ljava/nio/IntBuffer;",
+		INT4OID, sizeof(jint)
+	},
+	{
+		"java.nio.LongBuffer", "java/nio/LongBuffer", "Ljava/nio/LongBuffer;",
+		"asLongBuffer",
+		"(Ljava/nio/LongBuffer;)Ljava/nio/LongBuffer;",
+		"()Ljava/nio/LongBuffer;",
+		INT8OID, sizeof(jlong)
+	},
+	{
+		"java.nio.DoubleBuffer", "java/nio/DoubleBuffer",
+		"Ljava/nio/DoubleBuffer;",
+		"asDoubleBuffer",
+		"(Ljava/nio/DoubleBuffer;)Ljava/nio/DoubleBuffer;",
+		"()Ljava/nio/DoubleBuffer;",
+		FLOAT8OID, sizeof(jdouble)
+	}
+};
+
+#define N_KINDS (sizeof s_kinds / sizeof *s_kinds)
+
+static jclass    s_ByteBuffer_class;
+static jmethodID s_ByteBuffer_asReadOnlyBuffer;
+static jmethodID s_ByteBuffer_order;
+static jmethodID s_ByteBuffer_wrap;
+static jobject   s_ByteOrder_native;
+
+static BufferKind* kindOf(Type self)
+{
+	TypeClass cls = Type_getClass(self);
+	unsigned int i;
+	for ( i = 0 ; i < N_KINDS ; ++ i )
+		if ( s_kinds[i].typeClass == cls )
+			return s_kinds + i;
+	elog(ERROR, "PL/Java primitive buffer mapping for unknown class");
+	return NULL; /* not reached */
+}
+
+/*
+ * True for (same class or) an array type with the right element type.
+ */
+static bool _PrimitiveBuffer_canReplaceType(Type self, Type other)
+{
+	BufferKind* kind = kindOf(self);
+	Type elementType = Type_getElementType(other);
+	return Type_getClass(other) == kind->typeClass
+		|| ( NULL != elementType
+			&& Type_getOid(elementType) == kind->elemTypeId );
+}
+
+static jvalue _PrimitiveBuffer_coerceDatum(Type self, Datum arg)
+{
+	jvalue      result;
+	jbyteArray  ba;
+	jobject     bb;
+	jobject     ro;
+	BufferKind* kind   = kindOf(self);
+	ArrayType*  v      = DatumGetArrayTypeP(arg);
+	jsize       nElems = (jsize)ArrayGetNItems(ARR_NDIM(v), ARR_DIMS(v));
+	jsize       size   = nElems * (jsize)kind->elemSize;
+	char*       data   = ARR_DATA_PTR(v);
+
+	if ( ARR_HASNULL(v) )
+	{
+		char* values = data;
+		data = palloc(size);
+		arrayExpandNulls(data, values, ARR_NULLBITMAP(v),
+			0, nElems, kind->elemSize);
+	}
+
+	ba = JNI_newByteArray(size);
+	JNI_setByteArrayRegion(ba, 0, size, (jbyte*)data);
+	if ( ARR_HASNULL(v) )
+		pfree(data);
+	bb = JNI_callStaticObjectMethod(s_ByteBuffer_class, s_ByteBuffer_wrap, ba);
+	JNI_deleteLocalRef(ba);
+	ro = JNI_callObjectMethod(bb, s_ByteBuffer_asReadOnlyBuffer);
+	JNI_deleteLocalRef(bb);
+	bb = JNI_callObjectMethod(ro, s_ByteBuffer_order, s_ByteOrder_native);
+	JNI_deleteLocalRef(ro);
+	result.l = JNI_callObjectMethod(bb, kind->view);
+	JNI_deleteLocalRef(bb);
+	return result;
+}
+
+static Datum _PrimitiveBuffer_coerceObject(Type self, jobject buffer)
+{
+	ArrayType*  v;
+	jsize       nElems;
+	jobject     bb;
+	jobject     dst;
+	jobject     src;
+	jobject     ret;
+	BufferKind* kind = kindOf(self);
+
+	if ( buffer == 0 )
+		return 0;
+
+	nElems = JNI_callIntMethod(buffer, kind->remaining);
+	v = createArrayType(nElems, kind->elemSize, kind->elemTypeId, false);
+
+	bb = JNI_newDirectByteBuffer(
+		ARR_DATA_PTR(v), (jlong)nElems * kind->elemSize);
+	dst = JNI_callObjectMethod(bb, s_ByteBuffer_order, s_ByteOrder_native);
+	JNI_deleteLocalRef(bb);
+	bb = dst;
+	dst = JNI_callObjectMethod(bb, kind->view);
+	JNI_deleteLocalRef(bb);
+
+	/* a duplicate, so the caller's buffer position is left undisturbed */
+	src = JNI_callObjectMethod(buffer, kind->duplicate);
+	ret = JNI_callObjectMethod(dst, kind->put, src);
+	JNI_deleteLocalRef(ret);
+	JNI_deleteLocalRef(src);
+	JNI_deleteLocalRef(dst);
+
+	PG_RETURN_ARRAYTYPE_P(v);
+}
+
+static Type obtain(BufferKind* kind)
+{
+	if ( NULL == kind->instance )
+	{
+		kind->bufferClass =
+			JNI_newGlobalRef(PgObject_getJavaClass(kind->className));
+		kind->view = PgObject_getJavaMethod(s_ByteBuffer_class,
+			kind->viewMethod, kind->dupSignature);
+		kind->remaining = PgObject_getJavaMethod(kind->bufferClass,
+			"remaining", "()I");
+		kind->duplicate = PgObject_getJavaMethod(kind->bufferClass,
+			"duplicate", kind->dupSignature);
+		kind->put = PgObject_getJavaMethod(kind->bufferClass,
+			"put", kind->putSignature);
+
+		kind->instance = TypeClass_allocInstance(kind->typeClass,
+			get_array_type(kind->elemTypeId));
+	}
+	return kind->instance;
+}
+
+static Type _IntBuffer_obtain(Oid typeId)
+{
+	return obtain(s_kinds + 0);
+}
+
+static Type _LongBuffer_obtain(Oid typeId)
+{
+	return obtain(s_kinds + 1);
+}
+
+static Type _DoubleBuffer_obtain(Oid typeId)
+{
+	return obtain(s_kinds + 2);
+}
+
+/* Make these mappings available to the postgres system.
+ */
+extern void PrimitiveBuffer_initialize(void);
+void PrimitiveBuffer_initialize(void)
+{
+	static TypeObtainer obtainers[N_KINDS] =
+	{
+		_IntBuffer_obtain, _LongBuffer_obtain, _DoubleBuffer_obtain
+	};
+	jclass ByteOrder_class;
+	jmethodID ByteOrder_nativeOrder;
+	unsigned int i;
+
+	s_ByteBuffer_class = JNI_newGlobalRef(
+		PgObject_getJavaClass("java/nio/ByteBuffer"));
+	s_ByteBuffer_asReadOnlyBuffer = PgObject_getJavaMethod(s_ByteBuffer_class,
+		"asReadOnlyBuffer", "()Ljava/nio/ByteBuffer;");
+	s_ByteBuffer_order = PgObject_getJavaMethod(s_ByteBuffer_class,
+		"order", "(Ljava/nio/ByteOrder;)Ljava/nio/ByteBuffer;");
+	s_ByteBuffer_wrap = PgObject_getStaticJavaMethod(s_ByteBuffer_class,
+		"wrap", "([B)Ljava/nio/ByteBuffer;");
+
+	ByteOrder_class = PgObject_getJavaClass("java/nio/ByteOrder");
+	ByteOrder_nativeOrder = PgObject_getStaticJavaMethod(ByteOrder_class,
+		"nativeOrder", "()Ljava/nio/ByteOrder;");
+	s_ByteOrder_native = JNI_newGlobalRef(JNI_callStaticObjectMethod(
+		ByteOrder_class, ByteOrder_nativeOrder));
+	JNI_deleteLocalRef(ByteOrder_class);
+
+	for ( i = 0 ; i < N_KINDS ; ++ i )
+	{
+		TypeClass cls = TypeClass_alloc("type.PrimitiveBuffer");
+		cls->JNISignature   = s_kinds[i].JNISignature;
+		cls->javaTypeName   = s_kinds[i].javaTypeName;
+		cls->canReplaceType = _PrimitiveBuffer_canReplaceType;
+		cls->coerceDatum    = _PrimitiveBuffer_coerceDatum;
+		cls->coerceObject   = _PrimitiveBuffer_coerceObject;
+		s_kinds[i].typeClass = cls;
+		Type_registerType2(
+			InvalidOid, s_kinds[i].javaTypeName, obtainers[i]);
+	}
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2004-2019 Tada AB and other contributors, as listed below.
+ * Copyright (c) 2004-2026 Tada AB and other contributors, as listed below.
  *
  * All rights reserved. This program and the accompanying materials
  * are made available under the terms of the The BSD 3-Clause License
@@ -13,7 +13,29 @@
  * @author Thomas Hallgren
  */
 #include <postgres.h>
+#include <access/genam.h>
+#include <access/heapam.h>
+#include <access/stratnum.h>
+#include <catalog/pg_am.h>
+#include <catalog/pg_class.h>
 #include <executor/spi.h>
+#include <miscadmin.h>
+#include <utils/acl.h>
+#include <utils/builtins.h>
+#include <utils/lsyscache.h>
+#include <utils/rel.h>
+#include <utils/snapmgr.h>
+#include <utils/typcache.h>
+#if PG_VERSION_NUM >= 90500
+#include <utils/rls.h>
+#endif
+#if PG_VERSION_NUM >= 110000
+#include <catalog/objectaddress.h>
+#endif
+#if PG_VERSION_NUM >= 120000
+#include <access/table.h>
+#include <access/tableam.h>
+#endif
 
 #include "org_postgresql_pljava_internal_Relation.h"
 #include "pljava/DualState.h"
@@ -24,8 +46,22 @@
 #include "pljava/type/String.h"
 #include "pljava/type/TupleDesc.h"
 #include "pljava/type/Tuple.h"
+#include "pljava/type/TupleTable.h"
 #include "pljava/type/Relation.h"
 
+#if PG_VERSION_NUM < 100000
+#define TupleDescAttr(tupdesc, i) ((tupdesc)->attrs[(i)])
+#endif
+
+#if PG_VERSION_NUM < 110000
+#define IndexRelationGetNumberOfKeyAttributes(r) RelationGetNumberOfAttributes(r)
+#endif
+
+#if PG_VERSION_NUM < 120000
+#define table_open(r, l) heap_open((r), (l))
+#define table_close(r, l) heap_close((r), (l))
+#endif
+
 static jclass    s_Relation_class;
 static jmethodID s_Relation_init;
 
@@ -78,6 +114,11 @@ void pljava_Relation_initialize(void)
 		"(JJ[I[Ljava/lang/Object;)Lorg/postgresql/pljava/internal/Tuple;",
 		Java_org_postgresql_pljava_internal_Relation__1modifyTuple
 		},
+		{
+		"_scan",
+		"(II[I[Ljava/lang/Object;I)Lorg/postgresql/pljava/internal/TupleTable;",
+		Java_org_postgresql_pljava_internal_Relation__1scan
+		},
 		{ 0, 0, 0 }
 	};
 
@@ -293,3 +334,324 @@ Java_org_postgresql_pljava_internal_Relation__1modifyTuple(JNIEnv* env, jclass c
 	}
 	return result;
 }
+
+/*
+ * Fill in the scan key for the k'th of the keys, comparing it for equality to
+ * the k'th key column of idx, or (when idx is NULL) to the column attnum of
+ * rel, with the equality function of the index's operator family or of the
+ * column type's default operator class. Return false, leaving the scan key
+ * unset, if the key is null, as then nothing can match.
+ */
+static bool setScanKey(ScanKey skey, Relation rel, Relation idx, int k,
+	AttrNumber attnum, jobject key, jobject typeMap)
+{
+	Form_pg_attribute att;
+	StrategyNumber strategy;
+	Oid opr;
+	Oid collation;
+	Datum value;
+
+	if ( NULL != idx )
+		attnum = idx->rd_index->indkey.values[k];
+	if ( attnum < 1  ||  attnum > RelationGetNumberOfAttributes(rel) )
+		ereport(ERROR, (
+			errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+			errmsg("key %d of lookup in relation \"%s\" is not a column",
+				k + 1, RelationGetRelationName(rel))));
+	att = TupleDescAttr(RelationGetDescr(rel), attnum - 1);
+
+	if ( NULL == idx )
+	{
+		TypeCacheEntry *tce =
+			lookup_type_cache(att->atttypid, TYPECACHE_EQ_OPR);
+		strategy = BTEqualStrategyNumber;
+		opr = tce->eq_opr;
+		collation = att->attcollation;
+	}
+	else
+	{
+		strategy = BTREE_AM_OID == idx->rd_rel->relam
+			? BTEqualStrategyNumber : HTEqualStrategyNumber;
+		opr = get_opfamily_member(idx->rd_opfamily[k],
+			idx->rd_opcintype[k], idx->rd_opcintype[k], strategy);
+		collation = idx->rd_indcollation[k];
+	}
+	if ( ! OidIsValid(opr) )
+		ereport(ERROR, (
+			errcode(ERRCODE_UNDEFINED_FUNCTION),
+			errmsg("could not identify an equality operator for type %s",
+				format_type_be(att->atttypid))));
+
+	if ( NULL == key )
+		return false;
+
+	value = Type_coerceObjectBridged(Type_fromOid(att->atttypid, typeMap), key);
+	ScanKeyEntryInitialize(skey, 0, NULL == idx ? attnum : k + 1, strategy,
+		InvalidOid, collation, get_opcode(opr), value);
+	return true;
+}
+
+/*
+ * Whether a row fetched by a lossy index scan (one that sets xs_recheck, as
+ * a hash index scan always does, the index holding only hash codes) really
+ * matches the keys: each key is compared, with the equality function setScanKey
+ * gave it, to the value in the row of the column indexed by its index column.
+ */
+#if PG_VERSION_NUM >= 120000
+static bool recheckKeys(Relation idx, ScanKey skeys, int nkeys,
+	TupleTableSlot* slot)
+#else
+static bool recheckKeys(Relation idx, ScanKey skeys, int nkeys,
+	HeapTuple tuple, TupleDesc td)
+#endif
+{
+	int k;
+
+	for ( k = 0 ; k < nkeys ; ++ k )
+	{
+		ScanKey skey = &skeys[k];
+		AttrNumber attnum = idx->rd_index->indkey.values[skey->sk_attno - 1];
+		bool isnull;
+#if PG_VERSION_NUM >= 120000
+		Datum value = slot_getattr(slot, attnum, &isnull);
+#else
+		Datum value = heap_getattr(tuple, attnum, td, &isnull);
+#endif
+		if ( isnull  ||  ! DatumGetBool(FunctionCall2Coll(&skey->sk_func,
+				skey->sk_collation, value, skey->sk_argument)) )
+			return false;
+	}
+	return true;
+}
+
+/*
+ * Refuse, with an ERROR, a scan the executor would not make for the current
+ * user: of a relation that is not stored as a heap (a view, or a partitioned
+ * or foreign table), of a table the user may not read (in full, as the scan
+ * returns whole rows), or of a table with row-level security in force for the
+ * user, whose policies the scan could not apply. It is checked on every scan,
+ * not only when the lookup is prepared, as the role or the grants may have
+ * changed since.
+ */
+static void checkScannable(Relation rel)
+{
+	Oid relid = RelationGetRelid(rel);
+	char relkind = rel->rd_rel->relkind;
+	AclResult aclresult;
+
+	if ( RELKIND_RELATION != relkind  &&  RELKIND_MATVIEW != relkind
+		&&  RELKIND_TOASTVALUE != relkind )
+		ereport(ERROR, (
+			errcode(ERRCODE_WRONG_OBJECT_TYPE),
+			errmsg("\"%s\" is not a table that can be scanned directly",
+				RelationGetRelationName(rel))));
+
+	aclresult = pg_class_aclcheck(relid, GetUserId(), ACL_SELECT);
+	if ( ACLCHECK_OK != aclresult )
+		aclresult = pg_attribute_aclcheck_all(
+			relid, GetUserId(), ACL_SELECT, ACLMASK_ALL);
+	if ( ACLCHECK_OK != aclresult )
+		aclcheck_error(aclresult,
+#if PG_VERSION_NUM >= 110000
+			get_relkind_objtype(relkind),
+#else
+			ACL_KIND_CLASS,
+#endif
+			RelationGetRelationName(rel));
+
+#if PG_VERSION_NUM >= 90500
+	if ( RLS_ENABLED == check_enable_rls(relid, InvalidOid, false) )
+		ereport(ERROR, (
+			errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+			errmsg("row-level security is in force on \"%s\"",
+				RelationGetRelationName(rel)),
+			errhint("Read the table with a query instead of a direct "
+				"lookup.")));
+#endif
+}
+
+/*
+ * Class:     org_postgresql_pljava_internal_Relation
+ * Method:    _scan
+ * Signature: (II[I[Ljava/lang/Object;I)Lorg/postgresql/pljava/internal/TupleTable;
+ *
+ * Read, with the active snapshot, up to maxRows (all, if zero) rows of the
+ * relation relOid whose key columns equal the given keys: the leading key
+ * columns of the index indexOid, if that is valid, with an index scan, or else
+ * the columns numbered in attnums, with a sequential scan, after the checks of
+ * checkScannable. A row from a lossy index scan is rechecked against the keys
+ * (see recheckKeys). The rows come back as one TupleTable in the columnar form.
+ * The locks taken are kept to the end of the transaction, as the executor
+ * would keep them, so that a repeated lookup finds them already held.
+ */
+JNIEXPORT jobject JNICALL
+Java_org_postgresql_pljava_internal_Relation__1scan(JNIEnv* env, jclass clazz, jint relOid, jint indexOid, jintArray _attnums, jobjectArray _keys, jint maxRows)
+{
+	jobject result = 0;
+	jint* volatile attnums = NULL;
+
+	BEGIN_NATIVE
+	PG_TRY();
+	{
+		Relation rel;
+		Relation idx = NULL;
+		jobject typeMap = Invocation_getTypeMap();
+		jint nkeys = JNI_getArrayLength(_keys);
+		ScanKey skeys = (ScanKey)palloc(Max(1, nkeys) * sizeof(ScanKeyData));
+		HeapTuple* tuples;
+		jint count = 0;
+		jint capacity = 16;
+		bool matchable = true;
+		Snapshot snapshot = GetActiveSnapshot();
+		int k;
+
+		rel = table_open((Oid)relOid, AccessShareLock);
+		checkScannable(rel);
+		if ( InvalidOid != (Oid)indexOid )
+		{
+			idx = index_open((Oid)indexOid, AccessShareLock);
+			if ( RELKIND_INDEX != idx->rd_rel->relkind )
+				ereport(ERROR, (
+					errcode(ERRCODE_WRONG_OBJECT_TYPE),
+					errmsg("\"%s\" is not an index that can be scanned "
+						"directly", RelationGetRelationName(idx))));
+			if ( idx->rd_index->indrelid != RelationGetRelid(rel) )
+				ereport(ERROR, (
+					errcode(ERRCODE_WRONG_OBJECT_TYPE),
+					errmsg("index \"%s\" is not an index of \"%s\"",
+						RelationGetRelationName(idx),
+						RelationGetRelationName(rel))));
+			if ( BTREE_AM_OID != idx->rd_rel->relam
+				&&  HASH_AM_OID != idx->rd_rel->relam )
+				ereport(ERROR, (
+					errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					errmsg("lookup through index \"%s\" needs a btree or "
+						"hash index", RelationGetRelationName(idx))));
+			if ( nkeys < 1
+				||  nkeys > IndexRelationGetNumberOfKeyAttributes(idx)
+				||  ( HASH_AM_OID == idx->rd_rel->relam
+					&&  nkeys != IndexRelationGetNumberOfKeyAttributes(idx) ) )
+				ereport(ERROR, (
+					errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+					errmsg("%d keys do not fit index \"%s\" of %d key columns",
+						(int)nkeys, RelationGetRelationName(idx),
+						(int)IndexRelationGetNumberOfKeyAttributes(idx))));
+		}
+		else
+		{
+			if ( nkeys != JNI_getArrayLength(_attnums) )
+				ereport(ERROR, (
+					errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+					errmsg("%d keys given for %d columns",
+						(int)nkeys, (int)JNI_getArrayLength(_attnums))));
+			attnums = JNI_getIntArrayElements(_attnums, 0);
+		}
+
+		for ( k = 0 ; k < nkeys  &&  matchable ; ++ k )
+		{
+			jobject key = JNI_getObjectArrayElement(_keys, k);
+			matchable = setScanKey(&skeys[k], rel, idx, k,
+				NULL == attnums ? InvalidAttrNumber : (AttrNumber)attnums[k],
+				key, typeMap);
+			JNI_deleteLocalRef(key);
+		}
+		if ( NULL != attnums )
+		{
+			JNI_releaseIntArrayElements(_attnums, attnums, JNI_ABORT);
+			attnums = NULL;
+		}
+
+		tuples = (HeapTuple*)palloc(capacity * sizeof(HeapTuple));
+		if ( matchable )
+		{
+#if PG_VERSION_NUM >= 120000
+			TupleTableSlot* slot = table_slot_create(rel, NULL);
+#else
+			HeapTuple tuple;
+#endif
+			IndexScanDesc iscan = NULL;
+#if PG_VERSION_NUM >= 120000
+			TableScanDesc hscan = NULL;
+#else
+			HeapScanDesc hscan = NULL;
+#endif
+			if ( NULL != idx )
+			{
+				iscan = index_beginscan(rel, idx, snapshot, nkeys, 0);
+				index_rescan(iscan, skeys, nkeys, NULL, 0);
+			}
+			else
+#if PG_VERSION_NUM >= 120000
+				hscan = table_beginscan(rel, snapshot, nkeys, skeys);
+#else
+				hscan = heap_beginscan(rel, snapshot, nkeys, skeys);
+#endif
+
+			while ( 0 == maxRows  ||  count < maxRows )
+			{
+#if PG_VERSION_NUM >= 120000
+				if ( NULL != iscan
+					? ! index_getnext_slot(iscan, ForwardScanDirection, slot)
+					: ! table_scan_getnextslot(hscan, ForwardScanDirection,
+						slot) )
+					break;
+#else
+				tuple = NULL != iscan
+					? index_getnext(iscan, ForwardScanDirection)
+					: heap_getnext(hscan, ForwardScanDirection);
+				if ( NULL == tuple )
+					break;
+#endif
+				if ( NULL != iscan  &&  iscan->xs_recheck
+#if PG_VERSION_NUM >= 120000
+					&&  ! recheckKeys(idx, skeys, nkeys, slot) )
+#else
+					&&  ! recheckKeys(idx, skeys, nkeys,
+						tuple, RelationGetDescr(rel)) )
+#endif
+					continue;
+				if ( count == capacity )
+				{
+					capacity *= 2;
+					tuples = (HeapTuple*)
+						repalloc(tuples, capacity * sizeof(HeapTuple));
+				}
+#if PG_VERSION_NUM >= 120000
+				tuples[count++] = ExecCopySlotHeapTuple(slot);
+#else
+				tuples[count++] = heap_copytuple(tuple);
+#endif
+			}
+
+			if ( NULL != iscan )
+				index_endscan(iscan);
+			else
+#if PG_VERSION_NUM >= 120000
+				table_endscan(hscan);
+			ExecDropSingleTupleTableSlot(slot);
+#else
+				heap_endscan(hscan);
+#endif
+		}
+
+		result = TupleTable_createFromTuples(
+			RelationGetDescr(rel), tuples, count);
+
+		while ( count > 0 )
+			heap_freetuple(tuples[--count]);
+		pfree(tuples);
+		pfree(skeys);
+		if ( NULL != idx )
+			index_close(idx, NoLock);
+		table_close(rel, NoLock);
+	}
+	PG_CATCH();
+	{
+		if ( NULL != attnums )
+			JNI_releaseIntArrayElements(_attnums, attnums, JNI_ABORT);
+		Exception_throw_ERROR("Relation scan");
+	}
+	PG_END_TRY();
+	END_NATIVE
+	return result;
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2004-2020 Tada AB and other contributors, as listed below.
+ * Copyright (c) 2004-2026 Tada AB and other contributors, as listed below.
  *
  * All rights reserved. This program and the accompanying materials
  * are made available under the terms of the The BSD 3-Clause License
@@ -17,7 +17,7 @@
 
 static TypeClass s_shortClass;
 static jclass    s_Short_class;
-static jmethodID s_Short_init;
+static jmethodID s_Short_valueOf;
 static jmethodID s_Short_shortValue;
 
 /*
@@ -45,19 +45,11 @@ static jvalue _shortArray_coerceDatum(Type self, Datum arg)
 
 	if(ARR_HASNULL(v))
 	{
-		jsize idx;
 		jboolean isCopy = JNI_FALSE;
-		bits8* nullBitMap = ARR_NULLBITMAP(v);
-		jshort* values = (jshort*)ARR_DATA_PTR(v);
-		jshort* elems  = JNI_getShortArrayElements(shortArray, &isCopy);
-		for(idx = 0; idx < nElems; ++idx)
-		{
-			if(arrayIsNull(nullBitMap, idx))
-				elems[idx] = 0;
-			else
-				elems[idx] = *values++;
-		}
-		JNI_releaseShortArrayElements(shortArray, elems, JNI_COMMIT);
+		jshort* elems = JNI_getShortArrayElements(shortArray, &isCopy);
+		arrayExpandNulls((char*)elems, ARR_DATA_PTR(v), ARR_NULLBITMAP(v),
+			0, nElems, sizeof(jshort));
+		JNI_releaseShortArrayElements(shortArray, elems, 0);
 	}
 	else
 		JNI_setShortArrayRegion(shortArray, 0, nElems, (jshort*)ARR_DATA_PTR(v));
@@ -94,7 +86,8 @@ static bool _Short_canReplace(Type self, Type other)
 static jvalue _Short_coerceDatum(Type self, Datum arg)
 {
 	jvalue result;
-	result.l = JNI_newObject(s_Short_class, s_Short_init, DatumGetInt16(arg));
+	result.l = JNI_callStaticObjectMethod(s_Short_class, s_Short_valueOf,
+		DatumGetInt16(arg));
 	return result;
 }
 
@@ -118,7 +111,8 @@ void Short_initialize(void)
 	TypeClass cls;
 
 	s_Short_class = JNI_newGlobalRef(PgObject_getJavaClass("java/lang/Short"));
-	s_Short_init = PgObject_getJavaMethod(s_Short_class, "<init>", "(S)V");
+	s_Short_valueOf = PgObject_getStaticJavaMethod(s_Short_class,
+		"valueOf", "(S)Ljava/lang/Short;");
 	s_Short_shortValue = PgObject_getJavaMethod(s_Short_class, "shortValue", "()S");
 
 	cls = TypeClass_alloc("type.Short");
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2004-2019 Tada AB and other contributors, as listed below.
+ * Copyright (c) 2004-2026 Tada AB and other contributors, as listed below.
  *
  * All rights reserved. This program and the accompanying materials
  * are made available under the terms of the The BSD 3-Clause License
@@ -16,6 +16,7 @@
 #include "pljava/type/Type_priv.h"
 #include "pljava/type/SingleRowReader.h"
 
+#include <access/htup_details.h>
 #include <executor/executor.h>
 #include <executor/spi.h>
 #include <utils/typcache.h>
@@ -29,6 +30,28 @@
 
 static jclass s_SingleRowReader_class;
 static jmethodID s_SingleRowReader_init;
+static jclass s_Object_class;
+
+/*
+ * The native state of a SingleRowReader: the tuple, and its values once
+ * deformed, which is done all at once on the first access to any field, so
+ * that reading every field of a wide row costs one deforming pass rather than
+ * one (each starting over from the first attribute) per field. The tuple is
+ * a copy, and the values are allocated, in the same context as this struct,
+ * the upper context of the Invocation the reader belongs to, so they last as
+ * long as the reader is usable at all. The tuple given may be in memory that
+ * goes away sooner, such as a batch of SPI results freed as a ResultSet moves
+ * past it, and is not deformed until a field is first read.
+ */
+typedef struct
+{
+	HeapTupleHeader ht;
+	int    natts;     /* zero until deformed */
+	Datum *values;
+	bool  *nulls;
+} ReaderState;
+
+static void deform(ReaderState *rs, TupleDesc tupleDesc);
 
 jobject pljava_SingleRowReader_getTupleDesc(HeapTupleHeader ht)
 {
@@ -47,25 +70,68 @@ jobject pljava_SingleRowReader_getTupleDesc(HeapTupleHeader ht)
 
 jobject pljava_SingleRowReader_create(HeapTupleHeader ht)
 {
-	Ptr2Long p2lht;
 	Ptr2Long p2lro;
 	jobject result;
 	jobject jtd = pljava_SingleRowReader_getTupleDesc(ht);
+	jlong state = pljava_SingleRowReader_newState(ht, NULL);
 
-	p2lht.longVal = 0L;
 	p2lro.longVal = 0L;
-
-	p2lht.ptrVal = ht;
 	p2lro.ptrVal = currentInvocation;
 
 	result =
 		JNI_newObjectLocked(s_SingleRowReader_class, s_SingleRowReader_init,
-			pljava_DualState_key(), p2lro.longVal, p2lht.longVal, jtd);
+			pljava_DualState_key(), p2lro.longVal, state, jtd);
 
 	JNI_deleteLocalRef(jtd);
 	return result;
 }
 
+jlong pljava_SingleRowReader_newState(HeapTupleHeader ht, jobjectArray *values)
+{
+	Ptr2Long p2lht;
+	ReaderState *rs = (ReaderState *)MemoryContextAllocZero(
+		currentInvocation->upperContext, sizeof (ReaderState));
+	uint32 len = HeapTupleHeaderGetDatumLength(ht);
+	TupleDesc tupleDesc;
+	jobjectArray array;
+	jobject value;
+	Type type;
+	int i;
+
+	rs->ht = (HeapTupleHeader)
+		MemoryContextAlloc(currentInvocation->upperContext, len);
+	memcpy(rs->ht, ht, len);
+
+	if ( NULL != values )
+	{
+		/*
+		 * A copy, so that an error coercing some field cannot leave a
+		 * reference count behind.
+		 */
+		tupleDesc = lookup_rowtype_tupdesc_copy(
+			HeapTupleHeaderGetTypeId(ht), HeapTupleHeaderGetTypMod(ht));
+		deform(rs, tupleDesc);
+		array = JNI_newObjectArray(rs->natts, s_Object_class, NULL);
+		for ( i = 0 ; i < rs->natts ; ++ i )
+		{
+			if ( rs->nulls[i] )
+				continue;
+			type = pljava_TupleDesc_getColumnType(tupleDesc, i + 1);
+			if ( 0 == type )
+				continue;
+			value = Type_coerceDatumAs(type, rs->values[i], NULL).l;
+			JNI_setObjectArrayElement(array, i, value);
+			JNI_deleteLocalRef(value);
+		}
+		FreeTupleDesc(tupleDesc);
+		*values = array;
+	}
+
+	p2lht.longVal = 0L;
+	p2lht.ptrVal = rs;
+	return p2lht.longVal;
+}
+
 /* Make this datatype available to the postgres system.
  */
 void pljava_SingleRowReader_initialize(void)
@@ -86,8 +152,28 @@ void pljava_SingleRowReader_initialize(void)
 		"(Lorg/postgresql/pljava/internal/DualState$Key;JJLorg/postgresql/pljava/internal/TupleDesc;)V");
 	s_SingleRowReader_class = JNI_newGlobalRef(cls);
 	JNI_deleteLocalRef(cls);
+
+	cls = PgObject_getJavaClass("java/lang/Object");
+	s_Object_class = JNI_newGlobalRef(cls);
+	JNI_deleteLocalRef(cls);
 }
 
+static void deform(ReaderState *rs, TupleDesc tupleDesc)
+{
+	HeapTupleData tmptup;
+	MemoryContext cxt = GetMemoryChunkContext(rs);
+	int natts = tupleDesc->natts;
+
+	tmptup.t_len = HeapTupleHeaderGetDatumLength(rs->ht);
+	ItemPointerSetInvalid(&(tmptup.t_self));
+	tmptup.t_tableOid = InvalidOid;
+	tmptup.t_data = rs->ht;
+
+	rs->values = (Datum *)MemoryContextAlloc(cxt, natts * sizeof (Datum));
+	rs->nulls = (bool *)MemoryContextAlloc(cxt, natts * sizeof (bool));
+	heap_deform_tuple(&tmptup, tupleDesc, rs->values, rs->nulls);
+	rs->natts = natts;
+}
 
 /****************************************
  * JNI methods
@@ -111,22 +197,23 @@ Java_org_postgresql_pljava_jdbc_SingleRowReader__1getObject(JNIEnv* env, jclass
 		BEGIN_NATIVE
 		PG_TRY();
 		{
-			Type type = pljava_TupleDesc_getColumnType(
-				(TupleDesc) p2ltd.ptrVal, (int) attrNo);
+			ReaderState *rs = (ReaderState *)p2lhth.ptrVal;
+			TupleDesc tupleDesc = (TupleDesc)p2ltd.ptrVal;
+			Type type = pljava_TupleDesc_getColumnType(tupleDesc, (int)attrNo);
 			if (type != 0)
 			{
-				Datum binVal;
-				bool wasNull = false;
-				binVal = GetAttributeByNum(
-							(HeapTupleHeader)p2lhth.ptrVal,
-							(AttrNumber)attrNo, &wasNull);
-				if(!wasNull)
-					result = Type_coerceDatumAs(type, binVal, rqcls).l;
+				if ( 0 == rs->natts )
+					deform(rs, tupleDesc);
+				if ( attrNo < 1  ||  attrNo > rs->natts )
+					elog(ERROR, "invalid attribute number %d", (int)attrNo);
+				if ( ! rs->nulls[attrNo - 1] )
+					result = Type_coerceDatumAs(
+						type, rs->values[attrNo - 1], rqcls).l;
 			}
 		}
 		PG_CATCH();
 		{
-			Exception_throw_ERROR("GetAttributeByNum");
+			Exception_throw_ERROR("heap_deform_tuple");
 		}
 		PG_END_TRY();
 		END_NATIVE
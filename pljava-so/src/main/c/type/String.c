@@ -12,6 +12,7 @@
  *   Francisco Miguel Biete Banon
  */
 #include "pljava/type/String_priv.h"
+#include "pljava/type/Array.h"
 #include "pljava/HashMap.h"
 
 static TypeClass s_StringClass;
@@ -32,9 +33,45 @@ static jmethodID s_CharBuffer_wrap;
 static jmethodID s_Buffer_position;
 static jmethodID s_Buffer_remaining;
 static jstring s_the_empty_string;
+static jclass  s_StringArrays_class;
+static jmethodID s_StringArrays_decode;
+static jmethodID s_StringArrays_encode;
+static jmethodID s_StringArrays_setCharset;
 
 static int s_server_encoding;
 
+/*
+ * Single-byte server encodings for which Java has a charset that decodes each
+ * byte to the character PostgreSQL's own conversion to UTF-8 would. With one
+ * of these, values are decoded and encoded in the server encoding directly,
+ * without the full-size UTF-8 copy made in the two-step conversion. The few
+ * bytes a WIN125x encoding leaves unassigned are reported as errors, as
+ * PostgreSQL's conversion would report them, not replaced with U+FFFD.
+ */
+static const struct
+{
+	int         encoding;
+	const char *javaName;
+} s_directCharsets[] =
+{
+	{ PG_LATIN1,  "ISO-8859-1" },
+	{ PG_LATIN2,  "ISO-8859-2" },
+	{ PG_LATIN9,  "ISO-8859-15" },
+	{ PG_WIN1250, "windows-1250" },
+	{ PG_WIN1251, "windows-1251" },
+	{ PG_WIN1252, "windows-1252" },
+	{ PG_KOI8R,   "KOI8-R" }
+};
+
+static const char *directCharsetName(int encoding)
+{
+	int i;
+	for ( i = 0 ; i < lengthof(s_directCharsets) ; ++ i )
+		if ( encoding == s_directCharsets[i].encoding )
+			return s_directCharsets[i].javaName;
+	return NULL;
+}
+
 /*
  * String_appendJavaString and String_createNTS can be called from
  * elogExceptionMessage in JNICalls.c if something goes off the rails before
@@ -92,6 +129,168 @@ Datum _String_coerceObject(Type self, jobject jstr)
 	return ret;
 }
 
+/*
+ * Arrays of text, varchar, and bpchar, whose output functions return the
+ * stored bytes unchanged, are converted in bulk: the element bytes (converted
+ * to UTF-8 if the server encoding is something else) are gathered into one
+ * buffer with an array of end offsets, and cross to or from Java in a single
+ * call to StringArrays.decode or encode, rather than in several JNI calls per
+ * element. SQL_ASCII is excluded, as its bytes are not necessarily UTF-8.
+ */
+static jvalue _StringArray_coerceDatum(Type self, Datum arg)
+{
+	jvalue     result;
+	jsize      idx;
+	jobject    bytebuf;
+	jintArray  endArray;
+	StringInfoData sid;
+	ArrayType* v          = DatumGetArrayTypeP(arg);
+	jsize      nElems     = (jsize)ArrayGetNItems(ARR_NDIM(v), ARR_DIMS(v));
+	jint*      ends       = (jint*)palloc(nElems * sizeof(jint));
+	const char* values    = ARR_DATA_PTR(v);
+	bits8*     nullBitMap = ARR_NULLBITMAP(v);
+
+	initStringInfo(&sid);
+
+	for ( idx = 0 ; idx < nElems ; ++ idx )
+	{
+		char* src;
+		char* utf8;
+		int   srcLen;
+
+		if ( arrayIsNull(nullBitMap, idx) )
+		{
+			ends[idx] = -1;
+			continue;
+		}
+
+		src = VARDATA_ANY(values);
+		srcLen = (int)VARSIZE_ANY_EXHDR(values);
+		utf8 = src;
+		if ( s_two_step_conversion  &&  0 < srcLen )
+		{
+			utf8 = (char*)pg_do_encoding_conversion((unsigned char*)src,
+				srcLen, s_server_encoding, PG_UTF8);
+			if ( utf8 != src )
+				srcLen = strlen(utf8);
+		}
+		appendBinaryStringInfo(&sid, utf8, srcLen);
+		if ( utf8 != src )
+			pfree(utf8);
+		ends[idx] = sid.len;
+
+		values = att_addlength_pointer(values, -1, values);
+		values = (char*)att_align_nominal(values, 'i');
+	}
+
+	endArray = JNI_newIntArray(nElems);
+	JNI_setIntArrayRegion(endArray, 0, nElems, ends);
+	bytebuf = JNI_newDirectByteBuffer(sid.data, sid.len);
+	result.l = JNI_callStaticObjectMethod(s_StringArrays_class,
+		s_StringArrays_decode, bytebuf, endArray);
+	JNI_deleteLocalRef(bytebuf);
+	JNI_deleteLocalRef(endArray);
+	pfree(sid.data);
+	pfree(ends);
+	return result;
+}
+
+static Datum _StringArray_coerceObject(Type self, jobject strArray)
+{
+	ArrayType* v;
+	jsize      idx;
+	jbyteArray byteArray;
+	jintArray  endArray;
+	jsize      nBytes;
+	char*      bytes;
+	jint*      ends;
+	int        lowerBound = 1;
+	jint       start      = 0;
+	int        nElems     = (int)JNI_getArrayLength((jarray)strArray);
+	Datum*     values     =
+		(Datum*)palloc(nElems * sizeof(Datum) + nElems * sizeof(bool));
+	bool*      nulls      = (bool*)(values + nElems);
+
+	endArray = JNI_newIntArray(nElems);
+	byteArray = (jbyteArray)JNI_callStaticObjectMethod(s_StringArrays_class,
+		s_StringArrays_encode, strArray, endArray);
+	nBytes = JNI_getArrayLength((jarray)byteArray);
+	bytes = palloc(nBytes + 1);
+	ends = (jint*)palloc(nElems * sizeof(jint));
+	JNI_getByteArrayRegion(byteArray, 0, nBytes, (jbyte*)bytes);
+	JNI_getIntArrayRegion(endArray, 0, nElems, ends);
+	JNI_deleteLocalRef(byteArray);
+	JNI_deleteLocalRef(endArray);
+
+	for ( idx = 0 ; idx < nElems ; ++ idx )
+	{
+		char* denc;
+		int   dencLen;
+		text* t;
+
+		if ( -1 == ends[idx] )
+		{
+			nulls[idx] = true;
+			values[idx] = 0;
+			continue;
+		}
+
+		denc = bytes + start;
+		dencLen = ends[idx] - start;
+		start = ends[idx];
+		if ( s_two_step_conversion  &&  0 < dencLen )
+		{
+			char* utf8 = denc;
+			denc = (char*)pg_do_encoding_conversion(
+				(unsigned char*)utf8, dencLen, PG_UTF8, s_server_encoding);
+			if ( denc != utf8 )
+				dencLen = strlen(denc);
+		}
+
+		t = (text*)palloc(dencLen + VARHDRSZ);
+		SET_VARSIZE(t, dencLen + VARHDRSZ);
+		memcpy(VARDATA(t), denc, dencLen);
+		if ( denc < bytes  ||  denc >= bytes + nBytes )
+			pfree(denc);
+
+		nulls[idx] = false;
+		values[idx] = PointerGetDatum(t);
+	}
+
+	v = construct_md_array(
+		values,
+		nulls,
+		1,
+		&nElems,
+		&lowerBound,
+		Type_getOid(Type_getElementType(self)),
+		-1,
+		false,
+		'i');
+
+	for ( idx = 0 ; idx < nElems ; ++ idx )
+		if ( ! nulls[idx] )
+			pfree(DatumGetPointer(values[idx]));
+	pfree(values);
+	pfree(ends);
+	pfree(bytes);
+	PG_RETURN_ARRAYTYPE_P(v);
+}
+
+static Type _String_createArrayType(Type self, Oid arrayTypeId)
+{
+	switch ( Type_getOid(self) )
+	{
+	case TEXTOID:
+	case VARCHAROID:
+	case BPCHAROID:
+		if ( PG_SQL_ASCII != s_server_encoding )
+			return Array_fromOid2(arrayTypeId, self,
+				_StringArray_coerceDatum, _StringArray_coerceObject);
+	}
+	return Array_fromOid(arrayTypeId, self);
+}
+
 static PLJString String_create(TypeClass cls, Oid typeId)
 {
 	HeapTuple    typeTup = PgObject_getValidTuple(TYPEOID, typeId, "type");
@@ -115,6 +314,53 @@ PLJString StringClass_obtain(TypeClass self, Oid typeId)
 	return String_create(self, typeId);
 }
 
+/*
+ * True if the len bytes at p are all seven-bit ASCII. Every PostgreSQL server
+ * encoding is an ASCII superset, so such bytes mean the same thing whatever
+ * the encoding, and are also valid modified UTF-8 as JNI's NewStringUTF
+ * expects (text values cannot contain NUL). That allows a Java String to be
+ * made with one JNI call, instead of the CharsetDecoder decode and toString
+ * upcalls and the CharBuffer in between. The scan goes a word at a time once
+ * p is aligned.
+ */
+static bool isAscii(const char* p, Size len)
+{
+	const uint64 highBits = UINT64CONST(0x8080808080808080);
+	const char* end = p + len;
+
+	while ( p < end  &&  0 != ((uintptr_t)p & (sizeof(uint64) - 1)) )
+		if ( 0 != (*p++ & 0x80) )
+			return false;
+
+	for ( ; p + sizeof(uint64) <= end ; p += sizeof(uint64) )
+		if ( 0 != (*(const uint64*)p & highBits) )
+			return false;
+
+	while ( p < end )
+		if ( 0 != (*p++ & 0x80) )
+			return false;
+
+	return true;
+}
+
+/*
+ * Construct a Java String from len bytes known to be ASCII, not necessarily
+ * NUL-terminated.
+ */
+static jstring asciiToJavaString(const char* p, Size len)
+{
+	char stackBuf[256];
+	char* nts = len < sizeof stackBuf ? stackBuf : palloc(len + 1);
+	jstring result;
+
+	memcpy(nts, p, len);
+	nts[len] = '\0';
+	result = JNI_newStringUTF(nts);
+	if ( nts != stackBuf )
+		pfree(nts);
+	return result;
+}
+
 jstring String_createJavaString(text* t)
 {
 	jstring result = 0;
@@ -128,6 +374,11 @@ jstring String_createJavaString(text* t)
 		if(srcLen == 0)
 			return s_the_empty_string;
 
+		JNI_counters.bytesToJava += srcLen;
+
+		if ( isAscii(src, srcLen) )
+			return asciiToJavaString(src, srcLen);
+
 		if ( s_two_step_conversion )
 		{
 			utf8 = (char*)pg_do_encoding_conversion((unsigned char*)src,
@@ -165,6 +416,8 @@ jstring String_createJavaStringFromNTS(const char* cp)
 		jobject charbuf;
 		Size sz = strlen(cp);
 		char const * utf8 = cp;
+		if ( isAscii(cp, sz) )
+			return JNI_newStringUTF(cp);
 		if ( s_two_step_conversion )
 		{
 			utf8 = (char*)pg_do_encoding_conversion((unsigned char*)cp,
@@ -194,48 +447,73 @@ jstring String_createJavaStringFromNTS(const char* cp)
 
 static void appendCharBuffer(StringInfoData*, jobject);
 
+/*
+ * The varlena is assembled in place: the StringInfo reserves room for the
+ * header ahead of the encoded bytes, and is sized up front from the length of
+ * the Java string and the encoder's average bytes per char, so in the usual
+ * case the value is encoded once directly into the result, with no further
+ * copy. Only when a two-step conversion actually changes the bytes must they
+ * be copied into a second allocation.
+ */
 text* String_createText(jstring javaString)
 {
 	text* result = 0;
 	if(javaString != 0)
 	{
+		char* src;
 		char* denc;
 		Size dencLen;
-		Size varSize;
+		Size cap;
+		jint nchars;
 		jobject charbuf = JNI_callStaticObjectMethodLocked(s_CharBuffer_class,
 			s_CharBuffer_wrap, javaString);
 		StringInfoData sid;
-		initStringInfo(&sid);
-		appendCharBuffer(&sid, charbuf);
+
+		nchars = JNI_callIntMethodLocked(charbuf, s_Buffer_remaining);
+		cap = VARHDRSZ + 1 +
+			(Size)(s_CharsetEncoder_averageBytesPerChar * (double)nchars);
+		sid.data = palloc(cap);
+		sid.maxlen = (int)cap;
+		sid.len = VARHDRSZ;
+		sid.cursor = 0;
+		sid.data[sid.len] = '\0';
+
+		if ( 0 < nchars )
+			appendCharBuffer(&sid, charbuf);
 		JNI_deleteLocalRef(charbuf);
-		denc = sid.data;
-		dencLen = sid.len;
-		if ( s_two_step_conversion )
+
+		src = sid.data + VARHDRSZ;
+		dencLen = sid.len - VARHDRSZ;
+		denc = src;
+		if ( s_two_step_conversion  &&  0 < dencLen )
 		{
 			denc = (char*)pg_do_encoding_conversion(
-				(unsigned char*)denc, (int)dencLen, PG_UTF8, s_server_encoding);
+				(unsigned char*)src, (int)dencLen, PG_UTF8, s_server_encoding);
 			/* pg_do_encoding_conversion may return the source argument
 			 * unchanged in more circumstances than you'd expect. As the source
 			 * argument isn't NUL-terminated, don't call strlen on it.
 			 */
-			if (denc != sid.data)
+			if (denc != src)
 				dencLen = strlen(denc);
 		}
-		varSize = dencLen + VARHDRSZ;
 
-		/* Allocate and initialize the text structure.
-		 */
-		result = (text*)palloc(varSize);
+		if ( denc == src )
+			result = (text*)sid.data;
+		else
+		{
+			result = (text*)palloc(dencLen + VARHDRSZ);
+			memcpy(VARDATA(result), denc, dencLen);
+			pfree(denc);
+			pfree(sid.data);
+		}
+
+		JNI_counters.bytesFromJava += dencLen;
+
 #if PG_VERSION_NUM < 80300
-		VARATT_SIZEP(result) = varSize;	/* Total size of structure, not just data */
+		VARATT_SIZEP(result) = dencLen + VARHDRSZ;	/* Total size of structure, not just data */
 #else
-		SET_VARSIZE(result, varSize);	/* Total size of structure, not just data */
+		SET_VARSIZE(result, dencLen + VARHDRSZ);	/* Total size of structure, not just data */
 #endif
-		memcpy(VARDATA(result), denc, dencLen);
-
-		if(denc != sid.data)
-			pfree(denc);
-		pfree(sid.data);
 	}
 	return result;
 }
@@ -272,6 +550,9 @@ char* String_createNTS(jstring javaString)
 		appendCharBuffer(&sid, charbuf);
 		JNI_deleteLocalRef(charbuf);
 
+		if ( ! s_two_step_conversion )
+			return sid.data;
+
 		result = (char*)pg_do_encoding_conversion(
 			(unsigned char *)sid.data, sid.len, PG_UTF8, s_server_encoding);
 
@@ -373,13 +654,23 @@ void String_initialize(void)
 	s_StringClass->canReplaceType = _String_canReplaceType;
 	s_StringClass->coerceDatum    = _String_coerceDatum;
 	s_StringClass->coerceObject   = _String_coerceObject;
+	s_StringClass->createArrayType = _String_createArrayType;
+
+	s_StringArrays_class = (jclass)JNI_newGlobalRef(PgObject_getJavaClass(
+		"org/postgresql/pljava/internal/StringArrays"));
+	s_StringArrays_decode = PgObject_getStaticJavaMethod(s_StringArrays_class,
+		"decode", "(Ljava/nio/ByteBuffer;[I)[Ljava/lang/String;");
+	s_StringArrays_encode = PgObject_getStaticJavaMethod(s_StringArrays_class,
+		"encode", "([Ljava/lang/String;[I)[B");
+	s_StringArrays_setCharset = PgObject_getStaticJavaMethod(
+		s_StringArrays_class, "setCharset", "(Ljava/nio/charset/Charset;)V");
 
 	/*
 	 * Frame push/pop hoisted here out of String_initialize_codec to mollify
 	 * pre-C99 compilers that don't want that function to have declarations
 	 * after a statement.
 	 */
-	JNI_pushLocalFrame(16);
+	JNI_pushLocalFrame(24);
 	String_initialize_codec();
 	JNI_popLocalFrame(NULL);
 
@@ -421,7 +712,11 @@ static void String_initialize_codec()
 	jfieldID underflow = PgObject_getStaticJavaField(result_class, "UNDERFLOW",
 		"Ljava/nio/charset/CoderResult;");
 	jclass buffer_class = PgObject_getJavaClass("java/nio/Buffer");
+	jmethodID forname = PgObject_getStaticJavaMethod(charset_class,
+		"forName", "(Ljava/lang/String;)Ljava/nio/charset/Charset;");
 	jobject servercs;
+	const char *directName;
+	jstring jdirectName = NULL;
 
 	/*
 	 * Records what the final state of s_two_step_conversion will be, but the
@@ -431,11 +726,19 @@ static void String_initialize_codec()
 
 	s_server_encoding = GetDatabaseEncoding();
 
+	directName = directCharsetName(s_server_encoding);
+	if ( NULL != directName )
+	{
+		jmethodID issupported = PgObject_getStaticJavaMethod(charset_class,
+			"isSupported", "(Ljava/lang/String;)Z");
+		jdirectName = JNI_newStringUTF(directName);
+		if ( ! JNI_callStaticBooleanMethod(charset_class, issupported,
+				jdirectName) )
+			directName = NULL;
+	}
+
 	if ( PG_SQL_ASCII == s_server_encoding )
 	{
-		jmethodID forname =
-			PgObject_getStaticJavaMethod(charset_class,
-				"forName", "(Ljava/lang/String;)Ljava/nio/charset/Charset;");
 		jstring sql_ascii = JNI_newStringUTF("X-PGSQL_ASCII");
 
 		two_step_when_ready = false;
@@ -443,6 +746,34 @@ static void String_initialize_codec()
 		servercs = JNI_callStaticObjectMethodLocked(charset_class,
 			forname, sql_ascii);
 	}
+	else if ( NULL != directName )
+	{
+		jclass system_class = PgObject_getJavaClass("java/lang/System");
+		jmethodID getproperty = PgObject_getStaticJavaMethod(system_class,
+			"getProperty", "(Ljava/lang/String;)Ljava/lang/String;");
+		jmethodID setproperty = PgObject_getStaticJavaMethod(system_class,
+			"setProperty",
+			"(Ljava/lang/String;Ljava/lang/String;)Ljava/lang/String;");
+		jstring encodingKey =
+			JNI_newStringUTF("org.postgresql.server.encoding");
+
+		two_step_when_ready = false;
+
+		servercs = JNI_callStaticObjectMethodLocked(charset_class,
+			forname, jdirectName);
+		JNI_callStaticVoidMethod(s_StringArrays_class,
+			s_StringArrays_setCharset, servercs);
+
+		/*
+		 * Unless the encoding property was given explicitly, set it to the
+		 * same charset, which InstallHelper will then find for the Java code
+		 * (SQLXML, for one) that decodes server-encoded bytes itself.
+		 */
+		if ( NULL == JNI_callStaticObjectMethod(system_class, getproperty,
+				encodingKey) )
+			JNI_callStaticObjectMethod(system_class, setproperty,
+				encodingKey, jdirectName);
+	}
 	else
 	{
 		jclass scharset_class =
@@ -79,7 +79,8 @@ static TypeClass s_OffsetDateTimeClass;
 static Type      s_LocalDateTimeInstance;
 static jclass    s_LocalDateTime_class;
 static jmethodID s_LocalDateTime_ofEpochSecond;
-static jmethodID s_LocalDateTime_atOffset;
+static jmethodID s_LocalDateTime_toEpochSecond;
+static jmethodID s_LocalDateTime_getNano;
 static Type      s_OffsetDateTimeInstance;
 static jclass    s_OffsetDateTime_class;
 static jmethodID s_OffsetDateTime_of;
@@ -138,13 +139,30 @@ static jvalue _LocalDateTime_coerceDatum(Type self, Datum arg)
 	return result;
 }
 
+/*
+ * The Datum for a timestamp (with or without time zone) given as seconds and
+ * nanoseconds from the Java (Unix) epoch.
+ */
+static Datum _epochToDatum(jlong epochSec, jint nanos)
+{
+	epochSec -= EPOCH_DIFF;
+#if PG_VERSION_NUM < 100000
+	if ( !integerDateTimes )
+		return Float8GetDatum((double)epochSec + ((double)nanos)/1e9);
+#endif
+	return Int64GetDatum(1000000L * epochSec + nanos / 1000);
+}
+
+/*
+ * Read the seconds and nanoseconds straight from the LocalDateTime, rather
+ * than make an OffsetDateTime of it to do the same.
+ */
 static Datum _LocalDateTime_coerceObject(Type self, jobject timestamp)
 {
-	jobject offsetDateTime = JNI_callObjectMethod(timestamp,
-		s_LocalDateTime_atOffset, s_ZoneOffset_UTC);
-	Datum result = Type_coerceObject(s_OffsetDateTimeInstance, offsetDateTime);
-	JNI_deleteLocalRef(offsetDateTime);
-	return result;
+	jlong epochSec = JNI_callLongMethod(
+		timestamp, s_LocalDateTime_toEpochSecond, s_ZoneOffset_UTC);
+	jint nanos = JNI_callIntMethod(timestamp, s_LocalDateTime_getNano);
+	return _epochToDatum(epochSec, nanos);
 }
 
 static Type _LocalDateTime_obtain(Oid typeId)
@@ -163,8 +181,10 @@ static Type _LocalDateTime_obtain(Oid typeId)
 		s_LocalDateTime_ofEpochSecond = PgObject_getStaticJavaMethod(
 			s_LocalDateTime_class, "ofEpochSecond",
 			"(JILjava/time/ZoneOffset;)Ljava/time/LocalDateTime;");
-		s_LocalDateTime_atOffset = PgObject_getJavaMethod(s_LocalDateTime_class,
-			"atOffset", "(Ljava/time/ZoneOffset;)Ljava/time/OffsetDateTime;");
+		s_LocalDateTime_toEpochSecond = PgObject_getJavaMethod(
+			s_LocalDateTime_class, "toEpochSecond", "(Ljava/time/ZoneOffset;)J");
+		s_LocalDateTime_getNano = PgObject_getJavaMethod(
+			s_LocalDateTime_class, "getNano", "()I");
 
 		s_OffsetDateTime_class = JNI_newGlobalRef(PgObject_getJavaClass(
 			"java/time/OffsetDateTime"));
@@ -205,23 +225,9 @@ static jvalue _OffsetDateTime_coerceDatum(Type self, Datum arg)
 static Datum _OffsetDateTime_coerceObject(Type self, jobject timestamp)
 {
 	jlong epochSec = JNI_callLongMethod(
-		timestamp, s_OffsetDateTime_toEpochSecond) - EPOCH_DIFF;
+		timestamp, s_OffsetDateTime_toEpochSecond);
 	jint nanos = JNI_callIntMethod(timestamp, s_OffsetDateTime_getNano);
-	Datum result;
-
-#if PG_VERSION_NUM < 100000
-	if ( !integerDateTimes )
-	{
-		double secs = (double)epochSec + ((double)nanos)/1e9;
-		result = Float8GetDatum(secs);
-	}
-	else
-#endif
-	{
-		result = Int64GetDatum(1000000L * epochSec + nanos / 1000);
-	}
-
-	return result;
+	return _epochToDatum(epochSec, nanos);
 }
 
 static Type _OffsetDateTime_obtain(Oid typeId)
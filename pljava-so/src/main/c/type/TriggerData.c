@@ -51,15 +51,26 @@ jobject pljava_TriggerData_create(TriggerData* triggerData)
 			p2ltd.longVal);
 }
 
-HeapTuple pljava_TriggerData_getTriggerReturnTuple(jobject jtd, bool* wasNull)
+HeapTuple pljava_TriggerData_getTriggerReturnTuple(
+	jobject jtd, TriggerData* td, bool* wasNull)
 {
 	Ptr2Long p2l;
 	HeapTuple ret = 0;
 	p2l.longVal = JNI_callLongMethod(jtd, s_TriggerData_getTriggerReturnTuple);
-	if(p2l.longVal != 0)
-		ret = heap_copytuple((HeapTuple)p2l.ptrVal); /* unconditional copy?? */
-	else
+	if(p2l.longVal == 0)
 		*wasNull = true;
+	else
+	{
+		/*
+		 * The trigger's own tuple, returned unmodified, is handed back as is:
+		 * the trigger manager recognizes it and does no more with it. Any other
+		 * tuple belongs to a Java Tuple object, which may free it, so a copy
+		 * must be returned instead.
+		 */
+		ret = (HeapTuple)p2l.ptrVal;
+		if(ret != td->tg_trigtuple && ret != td->tg_newtuple)
+			ret = heap_copytuple(ret);
+	}
 	return ret;
 }
 
@@ -87,6 +98,11 @@ void pljava_TriggerData_initialize(void)
 		Java_org_postgresql_pljava_internal_TriggerData__1getNewTuple
 		},
 		{
+		"_getUnmodifiedReturnTuple",
+		"(J)J",
+		Java_org_postgresql_pljava_internal_TriggerData__1getUnmodifiedReturnTuple
+		},
+		{
 		"_getArguments",
 	  	"(J)[Ljava/lang/String;",
 	  	Java_org_postgresql_pljava_internal_TriggerData__1getArguments
@@ -97,6 +113,11 @@ void pljava_TriggerData_initialize(void)
 	  	Java_org_postgresql_pljava_internal_TriggerData__1getName
 		},
 		{
+		"_getTransitionTableName",
+	  	"(JZ)Ljava/lang/String;",
+	  	Java_org_postgresql_pljava_internal_TriggerData__1getTransitionTableName
+		},
+		{
 		"_isFiredAfter",
 	  	"(J)Z",
 	  	Java_org_postgresql_pljava_internal_TriggerData__1isFiredAfter
@@ -222,6 +243,29 @@ Java_org_postgresql_pljava_internal_TriggerData__1getNewTuple(JNIEnv* env, jclas
 	return result;
 }
 
+/*
+ * Class:     org_postgresql_pljava_TriggerData
+ * Method:    _getUnmodifiedReturnTuple
+ * Signature: (J)J
+ *
+ * The pointer to the trigger manager's own tuple that a row trigger returns
+ * when it makes no change: the new tuple for an UPDATE, else the trigger tuple.
+ * No Java Tuple is made of it.
+ */
+JNIEXPORT jlong JNICALL
+Java_org_postgresql_pljava_internal_TriggerData__1getUnmodifiedReturnTuple(JNIEnv* env, jclass clazz, jlong _this)
+{
+	TriggerData* self;
+	Ptr2Long p2l;
+	p2l.longVal = _this;
+	self = (TriggerData*)p2l.ptrVal;
+	p2l.longVal = 0L;
+	if(self != 0)
+		p2l.ptrVal = TRIGGER_FIRED_BY_UPDATE(self->tg_event)
+			? self->tg_newtuple : self->tg_trigtuple;
+	return p2l.longVal;
+}
+
 /*
  * Class:     org_postgresql_pljava_TriggerData
  * Method:    _getArguments
@@ -278,6 +322,40 @@ Java_org_postgresql_pljava_internal_TriggerData__1getName(JNIEnv* env, jclass cl
 	return result;
 }
 
+/*
+ * Class:     org_postgresql_pljava_TriggerData
+ * Method:    _getTransitionTableName
+ * Signature: (JZ)Ljava/lang/String;
+ *
+ * The name given by REFERENCING OLD TABLE or NEW TABLE, or null if there is
+ * none or the table is not populated for this firing (only possible in
+ * PostgreSQL 10 and later).
+ */
+JNIEXPORT jstring JNICALL
+Java_org_postgresql_pljava_internal_TriggerData__1getTransitionTableName(JNIEnv* env, jclass clazz, jlong _this, jboolean isNew)
+{
+	jstring result = 0;
+#if PG_VERSION_NUM >= 100000
+	TriggerData* self;
+	Ptr2Long p2l;
+	p2l.longVal = _this;
+	self = (TriggerData*)p2l.ptrVal;
+	if(self != 0)
+	{
+		char* name = isNew ? self->tg_trigger->tgnewtable
+			: self->tg_trigger->tgoldtable;
+		Tuplestorestate* table = isNew ? self->tg_newtable : self->tg_oldtable;
+		if(name != 0 && table != 0)
+		{
+			BEGIN_NATIVE
+			result = String_createJavaStringFromNTS(name);
+			END_NATIVE
+		}
+	}
+#endif
+	return result;
+}
+
 /*
  * Class:     org_postgresql_pljava_TriggerData
  * Method:    _isFiredAfter
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2004-2019 Tada AB and other contributors, as listed below.
+ * Copyright (c) 2004-2026 Tada AB and other contributors, as listed below.
  *
  * All rights reserved. This program and the accompanying materials
  * are made available under the terms of the The BSD 3-Clause License
@@ -15,8 +15,11 @@
 #include <postgres.h>
 #include <executor/spi.h>
 #include <executor/tuptable.h>
+#include <catalog/pg_type.h>
+#include <utils/memutils.h>
 
 #include "org_postgresql_pljava_internal_Tuple.h"
+#include "org_postgresql_pljava_internal_TupleAccessorImpl.h"
 #include "pljava/Backend.h"
 #include "pljava/DualState.h"
 #include "pljava/Exception.h"
@@ -27,6 +30,19 @@
 static jclass    s_Tuple_class;
 static jmethodID s_Tuple_init;
 
+static jclass    s_TupleAccessorImpl_class;
+static jmethodID s_TupleAccessorImpl_init;
+
+#if PG_VERSION_NUM < 100000
+#define TupleDescAttr(tupdesc, i) ((tupdesc)->attrs[(i)])
+#endif
+
+static jobject getObjectOfType(
+	TupleDesc tupleDesc, HeapTuple tuple, int index, Type type, jclass rqcls);
+static Datum getPrimitive(
+	jlong _this, jlong _tupleDesc, jint index, jbooleanArray wasNull,
+	Oid *typeId);
+
 /*
  * org.postgresql.pljava.type.Tuple type.
  */
@@ -44,13 +60,27 @@ jobject pljava_Tuple_create(HeapTuple ht)
 
 jobjectArray pljava_Tuple_createArray(HeapTuple* vals, jint size, bool mustCopy)
 {
+	JNI_LocalChunks lc;
 	jobjectArray tuples = JNI_newObjectArray(size, s_Tuple_class, 0);
-	while(--size >= 0)
+
+	JNI_beginLocalChunks(&lc, 1);
+	PG_TRY();
+	{
+		while(--size >= 0)
+		{
+			jobject heapTuple =
+				pljava_Tuple_internalCreate(vals[size], mustCopy);
+			JNI_setObjectArrayElement(tuples, size, heapTuple);
+			JNI_nextLocalChunk(&lc);
+		}
+		JNI_endLocalChunks(&lc);
+	}
+	PG_CATCH();
 	{
-		jobject heapTuple = pljava_Tuple_internalCreate(vals[size], mustCopy);
-		JNI_setObjectArrayElement(tuples, size, heapTuple);
-		JNI_deleteLocalRef(heapTuple);
+		JNI_endLocalChunks(&lc);
+		PG_RE_THROW();
 	}
+	PG_END_TRY();
 	return tuples;
 }
 
@@ -92,9 +122,43 @@ void pljava_Tuple_initialize(void)
 	JNINativeMethod methods[] = {
 		{
 		"_getObject",
-		"(JJILjava/lang/Class;)Ljava/lang/Object;",
+		"(JJIJLjava/lang/Class;)Ljava/lang/Object;",
 	  	Java_org_postgresql_pljava_internal_Tuple__1getObject
 		},
+		{
+		"_getInt",
+		"(JJI[Z)I",
+	  	Java_org_postgresql_pljava_internal_Tuple__1getInt
+		},
+		{
+		"_getLong",
+		"(JJI[Z)J",
+	  	Java_org_postgresql_pljava_internal_Tuple__1getLong
+		},
+		{
+		"_getDouble",
+		"(JJI[Z)D",
+	  	Java_org_postgresql_pljava_internal_Tuple__1getDouble
+		},
+		{
+		"_getBoolean",
+		"(JJI[Z)Z",
+	  	Java_org_postgresql_pljava_internal_Tuple__1getBoolean
+		},
+		{
+		"_accessor",
+		"(Lorg/postgresql/pljava/internal/Tuple;"
+		"Lorg/postgresql/pljava/internal/TupleDesc;JJ)"
+		"Lorg/postgresql/pljava/internal/TupleAccessorImpl;",
+	  	Java_org_postgresql_pljava_internal_Tuple__1accessor
+		},
+		{ 0, 0, 0 }};
+	JNINativeMethod accessorMethods[] = {
+		{
+		"_bytes",
+		"(JJIJ)Ljava/nio/ByteBuffer;",
+	  	Java_org_postgresql_pljava_internal_TupleAccessorImpl__1bytes
+		},
 		{ 0, 0, 0 }};
 
 	s_Tuple_class = JNI_newGlobalRef(PgObject_getJavaClass("org/postgresql/pljava/internal/Tuple"));
@@ -102,6 +166,15 @@ void pljava_Tuple_initialize(void)
 	s_Tuple_init = PgObject_getJavaMethod(s_Tuple_class, "<init>",
 		"(Lorg/postgresql/pljava/internal/DualState$Key;JJ)V");
 
+	s_TupleAccessorImpl_class = JNI_newGlobalRef(PgObject_getJavaClass(
+		"org/postgresql/pljava/internal/TupleAccessorImpl"));
+	PgObject_registerNatives2(s_TupleAccessorImpl_class, accessorMethods);
+	s_TupleAccessorImpl_init = PgObject_getJavaMethod(
+		s_TupleAccessorImpl_class, "<init>",
+		"(Lorg/postgresql/pljava/internal/DualState$Key;JLjava/nio/ByteBuffer;"
+		"IZ[ILorg/postgresql/pljava/internal/Tuple;"
+		"Lorg/postgresql/pljava/internal/TupleDesc;)V");
+
 	cls = TypeClass_alloc("type.Tuple");
 	cls->JNISignature = "Lorg/postgresql/pljava/internal/Tuple;";
 	cls->javaTypeName = "org.postgresql.pljava.internal.Tuple";
@@ -112,11 +185,22 @@ void pljava_Tuple_initialize(void)
 jobject
 pljava_Tuple_getObject(
 	TupleDesc tupleDesc, HeapTuple tuple, int index, jclass rqcls)
+{
+	return getObjectOfType(tupleDesc, tuple, index, NULL, rqcls);
+}
+
+/*
+ * As pljava_Tuple_getObject, with the column's Type already known, or NULL to
+ * look it up.
+ */
+static jobject getObjectOfType(
+	TupleDesc tupleDesc, HeapTuple tuple, int index, Type type, jclass rqcls)
 {
 	jobject result = 0;
 	PG_TRY();
 	{
-		Type type = pljava_TupleDesc_getColumnType(tupleDesc, index);
+		if(type == 0)
+			type = pljava_TupleDesc_getColumnType(tupleDesc, index);
 		if(type != 0)
 		{
 			bool wasNull = false;
@@ -133,6 +217,48 @@ pljava_Tuple_getObject(
 	return result;
 }
 
+/*
+ * Fetch the Datum of a column for one of the primitive getters, storing
+ * whether it was null into wasNull[0] and the column's type into *typeId.
+ * The Java caller has already checked the type is one the getter accepts;
+ * the getter checks again, as a wrong guess would misread the Datum.
+ */
+static Datum getPrimitive(
+	jlong _this, jlong _tupleDesc, jint index, jbooleanArray wasNull,
+	Oid *typeId)
+{
+	Datum result = 0;
+	bool isNull = true;
+	jboolean jIsNull;
+	Ptr2Long p2l;
+	HeapTuple self;
+	TupleDesc tupleDesc;
+
+	p2l.longVal = _this;
+	self = (HeapTuple)p2l.ptrVal;
+	p2l.longVal = _tupleDesc;
+	tupleDesc = (TupleDesc)p2l.ptrVal;
+	*typeId = InvalidOid;
+
+	PG_TRY();
+	{
+		*typeId = SPI_gettypeid(tupleDesc, (int)index);
+		result = SPI_getbinval(self, tupleDesc, (int)index, &isNull);
+	}
+	PG_CATCH();
+	{
+		*typeId = InvalidOid;
+		Exception_throw_ERROR("SPI_getbinval");
+	}
+	PG_END_TRY();
+
+	if ( InvalidOid == *typeId )
+		return 0; /* an exception is pending; leave wasNull alone */
+	jIsNull = isNull ? JNI_TRUE : JNI_FALSE;
+	JNI_setBooleanArrayRegion(wasNull, 0, 1, &jIsNull);
+	return isNull ? 0 : result;
+}
+
 /****************************************
  * JNI methods
  ****************************************/
@@ -140,19 +266,274 @@ pljava_Tuple_getObject(
 /*
  * Class:     org_postgresql_pljava_internal_Tuple
  * Method:    _getObject
- * Signature: (JJILjava/lang/Class;)Ljava/lang/Object;
+ * Signature: (JJIJLjava/lang/Class;)Ljava/lang/Object;
  */
 JNIEXPORT jobject JNICALL
-Java_org_postgresql_pljava_internal_Tuple__1getObject(JNIEnv* env, jclass cls, jlong _this, jlong _tupleDesc, jint index, jclass rqcls)
+Java_org_postgresql_pljava_internal_Tuple__1getObject(JNIEnv* env, jclass cls, jlong _this, jlong _tupleDesc, jint index, jlong _type, jclass rqcls)
 {
 	jobject result = 0;
 	Ptr2Long p2l;
+	HeapTuple self;
+	TupleDesc tupleDesc;
 	p2l.longVal = _this;
 
 	BEGIN_NATIVE
-	HeapTuple self = (HeapTuple)p2l.ptrVal;
+	self = (HeapTuple)p2l.ptrVal;
 	p2l.longVal = _tupleDesc;
-	result = pljava_Tuple_getObject((TupleDesc)p2l.ptrVal, self, (int)index, rqcls);
+	tupleDesc = (TupleDesc)p2l.ptrVal;
+	p2l.longVal = _type;
+	result = getObjectOfType(
+		tupleDesc, self, (int)index, (Type)p2l.ptrVal, rqcls);
+	END_NATIVE
+	return result;
+}
+
+/*
+ * Class:     org_postgresql_pljava_internal_Tuple
+ * Method:    _getInt
+ * Signature: (JJI[Z)I
+ */
+JNIEXPORT jint JNICALL
+Java_org_postgresql_pljava_internal_Tuple__1getInt(JNIEnv* env, jclass cls, jlong _this, jlong _tupleDesc, jint index, jbooleanArray wasNull)
+{
+	jint result = 0;
+	Oid typeId;
+	Datum d;
+
+	BEGIN_NATIVE
+	d = getPrimitive(_this, _tupleDesc, index, wasNull, &typeId);
+	switch ( typeId )
+	{
+	case INT2OID:
+		result = DatumGetInt16(d);
+		break;
+	case INT4OID:
+		result = DatumGetInt32(d);
+		break;
+	case InvalidOid:
+		break; /* an exception is pending */
+	default:
+		Exception_throw(ERRCODE_DATATYPE_MISMATCH,
+			"column %d of type %u has no int value", (int)index, typeId);
+	}
+	END_NATIVE
+	return result;
+}
+
+/*
+ * Class:     org_postgresql_pljava_internal_Tuple
+ * Method:    _getLong
+ * Signature: (JJI[Z)J
+ */
+JNIEXPORT jlong JNICALL
+Java_org_postgresql_pljava_internal_Tuple__1getLong(JNIEnv* env, jclass cls, jlong _this, jlong _tupleDesc, jint index, jbooleanArray wasNull)
+{
+	jlong result = 0;
+	Oid typeId;
+	Datum d;
+
+	BEGIN_NATIVE
+	d = getPrimitive(_this, _tupleDesc, index, wasNull, &typeId);
+	switch ( typeId )
+	{
+	case INT2OID:
+		result = DatumGetInt16(d);
+		break;
+	case INT4OID:
+		result = DatumGetInt32(d);
+		break;
+	case INT8OID:
+		result = DatumGetInt64(d);
+		break;
+	case InvalidOid:
+		break; /* an exception is pending */
+	default:
+		Exception_throw(ERRCODE_DATATYPE_MISMATCH,
+			"column %d of type %u has no long value", (int)index, typeId);
+	}
+	END_NATIVE
+	return result;
+}
+
+/*
+ * Class:     org_postgresql_pljava_internal_Tuple
+ * Method:    _getDouble
+ * Signature: (JJI[Z)D
+ */
+JNIEXPORT jdouble JNICALL
+Java_org_postgresql_pljava_internal_Tuple__1getDouble(JNIEnv* env, jclass cls, jlong _this, jlong _tupleDesc, jint index, jbooleanArray wasNull)
+{
+	jdouble result = 0;
+	Oid typeId;
+	Datum d;
+
+	BEGIN_NATIVE
+	d = getPrimitive(_this, _tupleDesc, index, wasNull, &typeId);
+	switch ( typeId )
+	{
+	case FLOAT4OID:
+		result = DatumGetFloat4(d);
+		break;
+	case FLOAT8OID:
+		result = DatumGetFloat8(d);
+		break;
+	case InvalidOid:
+		break; /* an exception is pending */
+	default:
+		Exception_throw(ERRCODE_DATATYPE_MISMATCH,
+			"column %d of type %u has no double value", (int)index, typeId);
+	}
+	END_NATIVE
+	return result;
+}
+
+/*
+ * Class:     org_postgresql_pljava_internal_Tuple
+ * Method:    _getBoolean
+ * Signature: (JJI[Z)Z
+ */
+JNIEXPORT jboolean JNICALL
+Java_org_postgresql_pljava_internal_Tuple__1getBoolean(JNIEnv* env, jclass cls, jlong _this, jlong _tupleDesc, jint index, jbooleanArray wasNull)
+{
+	jboolean result = JNI_FALSE;
+	Oid typeId;
+	Datum d;
+
+	BEGIN_NATIVE
+	d = getPrimitive(_this, _tupleDesc, index, wasNull, &typeId);
+	switch ( typeId )
+	{
+	case BOOLOID:
+		result = DatumGetBool(d) ? JNI_TRUE : JNI_FALSE;
+		break;
+	case InvalidOid:
+		break; /* an exception is pending */
+	default:
+		Exception_throw(ERRCODE_DATATYPE_MISMATCH,
+			"column %d of type %u has no boolean value", (int)index, typeId);
+	}
+	END_NATIVE
+	return result;
+}
+
+/*
+ * Class:     org_postgresql_pljava_internal_Tuple
+ * Method:    _accessor
+ * Signature: (Lorg/postgresql/pljava/internal/Tuple;Lorg/postgresql/pljava/internal/TupleDesc;JJ)Lorg/postgresql/pljava/internal/TupleAccessorImpl;
+ *
+ * Deform the tuple once into an array of Datums followed by an array of null
+ * flags, as a TupleTableSlot would hold them, in a memory context that belongs
+ * to the new TupleAccessorImpl, which reads them through a direct buffer.
+ */
+JNIEXPORT jobject JNICALL
+Java_org_postgresql_pljava_internal_Tuple__1accessor(JNIEnv* env, jclass cls, jobject tuple, jobject tupleDesc, jlong _this, jlong _tupleDesc)
+{
+	jobject result = 0;
+	MemoryContext volatile cxt = NULL;
+
+	BEGIN_NATIVE
+	PG_TRY();
+	{
+		Ptr2Long p2l;
+		HeapTuple self;
+		TupleDesc td;
+		Size size;
+		Datum* values;
+		bool* isnull;
+		jint* typeIds;
+		jintArray types;
+		jobject block;
+		int i;
+
+		p2l.longVal = _this;
+		self = (HeapTuple)p2l.ptrVal;
+		p2l.longVal = _tupleDesc;
+		td = (TupleDesc)p2l.ptrVal;
+
+		cxt = AllocSetContextCreate(JavaMemoryContext,
+			"PL/Java TupleAccessor", ALLOCSET_START_SMALL_SIZES);
+		size = td->natts * (sizeof(Datum) + sizeof(bool));
+		values = (Datum*)MemoryContextAlloc(cxt, size + 1);
+		isnull = (bool*)(values + td->natts);
+		heap_deform_tuple(self, td, values, isnull);
+
+		typeIds = (jint*)palloc((td->natts + 1) * sizeof(jint));
+		for ( i = 0 ; i < td->natts ; ++ i )
+			typeIds[i] = (jint)TupleDescAttr(td, i)->atttypid;
+		types = JNI_newIntArray(td->natts);
+		JNI_setIntArrayRegion(types, 0, td->natts, typeIds);
+		pfree(typeIds);
+
+		block = JNI_newDirectByteBuffer(values, (jlong)size);
+
+		p2l.longVal = 0L;
+		p2l.ptrVal = cxt;
+		result = JNI_newObject(s_TupleAccessorImpl_class,
+			s_TupleAccessorImpl_init, pljava_DualState_key(), p2l.longVal,
+			block, (jint)sizeof(Datum),
+			FLOAT8PASSBYVAL ? JNI_TRUE : JNI_FALSE,
+			types, tuple, tupleDesc);
+		JNI_deleteLocalRef(block);
+		JNI_deleteLocalRef(types);
+	}
+	PG_CATCH();
+	{
+		if ( NULL != cxt )
+			MemoryContextDelete(cxt);
+		Exception_throw_ERROR("heap_deform_tuple");
+	}
+	PG_END_TRY();
+	END_NATIVE
+	return result;
+}
+
+/*
+ * Class:     org_postgresql_pljava_internal_TupleAccessorImpl
+ * Method:    _bytes
+ * Signature: (JJIJ)Ljava/nio/ByteBuffer;
+ *
+ * A direct buffer over the bytes of a varlena Datum, which is viewed in place
+ * unless it is compressed or stored out of line, in which case it is first
+ * expanded into the accessor's memory context.
+ */
+JNIEXPORT jobject JNICALL
+Java_org_postgresql_pljava_internal_TupleAccessorImpl__1bytes(JNIEnv* env, jclass cls, jlong _cxt, jlong _tupleDesc, jint index, jlong datum)
+{
+	jobject result = 0;
+
+	BEGIN_NATIVE
+	PG_TRY();
+	{
+		Ptr2Long p2l;
+		MemoryContext cxt;
+		MemoryContext curr;
+		TupleDesc td;
+		struct varlena* v;
+
+		p2l.longVal = _cxt;
+		cxt = (MemoryContext)p2l.ptrVal;
+		p2l.longVal = _tupleDesc;
+		td = (TupleDesc)p2l.ptrVal;
+
+		if ( index < 1  ||  index > td->natts
+			||  -1 != TupleDescAttr(td, index - 1)->attlen )
+			ereport(ERROR, (
+				errcode(ERRCODE_DATATYPE_MISMATCH),
+				errmsg("column %d is not of a variable-length type",
+					(int)index)));
+
+		curr = MemoryContextSwitchTo(cxt);
+		v = PG_DETOAST_DATUM_PACKED((Datum)datum);
+		MemoryContextSwitchTo(curr);
+
+		result = JNI_newDirectByteBuffer(
+			VARDATA_ANY(v), (jlong)VARSIZE_ANY_EXHDR(v));
+	}
+	PG_CATCH();
+	{
+		Exception_throw_ERROR("PG_DETOAST_DATUM_PACKED");
+	}
+	PG_END_TRY();
 	END_NATIVE
 	return result;
 }
@@ -28,6 +28,64 @@
 static jclass    s_TupleDesc_class;
 static jmethodID s_TupleDesc_init;
 
+#if PG_VERSION_NUM < 100000
+#define TupleDescAttr(tupdesc, i) ((tupdesc)->attrs[(i)])
+#endif
+
+/*
+ * Convert one value written by SingleRowWriter as a Java primitive, with kind
+ * one of the PRIM_ constants of TupleDesc.java, to a Datum for the attribute.
+ * The Java side only writes a primitive for a column whose Java class is the
+ * corresponding boxed type; the check of attlen here is a backstop against
+ * a type mapping that would make the Datum the wrong shape.
+ */
+static Datum primitiveDatum(Form_pg_attribute att, jbyte kind, jlong raw)
+{
+	union { jint i; jfloat f; } f4;
+	union { jlong j; jdouble d; } f8;
+	int16 wantLen;
+
+	switch ( kind )
+	{
+	case org_postgresql_pljava_internal_TupleDesc_PRIM_BOOLEAN:
+		wantLen = 1;
+		break;
+	case org_postgresql_pljava_internal_TupleDesc_PRIM_SHORT:
+		wantLen = 2;
+		break;
+	case org_postgresql_pljava_internal_TupleDesc_PRIM_INT:
+	case org_postgresql_pljava_internal_TupleDesc_PRIM_FLOAT:
+		wantLen = 4;
+		break;
+	default:
+		wantLen = 8;
+	}
+
+	if ( wantLen != att->attlen )
+		ereport(ERROR, (
+			errcode(ERRCODE_DATATYPE_MISMATCH),
+			errmsg("primitive value of length %d for column \"%s\" of "
+				"length %d", wantLen, NameStr(att->attname), att->attlen)));
+
+	switch ( kind )
+	{
+	case org_postgresql_pljava_internal_TupleDesc_PRIM_BOOLEAN:
+		return BoolGetDatum(0 != raw);
+	case org_postgresql_pljava_internal_TupleDesc_PRIM_SHORT:
+		return Int16GetDatum((int16)raw);
+	case org_postgresql_pljava_internal_TupleDesc_PRIM_INT:
+		return Int32GetDatum((int32)raw);
+	case org_postgresql_pljava_internal_TupleDesc_PRIM_FLOAT:
+		f4.i = (jint)raw;
+		return Float4GetDatum(f4.f);
+	case org_postgresql_pljava_internal_TupleDesc_PRIM_DOUBLE:
+		f8.j = raw;
+		return Float8GetDatum(f8.d);
+	default:
+		return Int64GetDatum(raw);
+	}
+}
+
 /*
  * org.postgresql.pljava.TupleDesc type.
  * This makes a non-reference-counted copy in JavaMemoryContext of the supplied
@@ -112,7 +170,7 @@ void pljava_TupleDesc_initialize(void)
 		},
 		{
 		"_formTuple",
-		"(J[Ljava/lang/Object;)Lorg/postgresql/pljava/internal/Tuple;",
+		"(J[Ljava/lang/Object;Ljava/nio/ByteBuffer;)Lorg/postgresql/pljava/internal/Tuple;",
 		Java_org_postgresql_pljava_internal_TupleDesc__1formTuple
 		},
 		{
@@ -120,6 +178,11 @@ void pljava_TupleDesc_initialize(void)
 		"(JI)Lorg/postgresql/pljava/internal/Oid;",
 		Java_org_postgresql_pljava_internal_TupleDesc__1getOid
 		},
+		{
+		"_getColumnType",
+		"(JI)J",
+		Java_org_postgresql_pljava_internal_TupleDesc__1getColumnType
+		},
 		{ 0, 0, 0 }};
 
 	s_TupleDesc_class = JNI_newGlobalRef(PgObject_getJavaClass("org/postgresql/pljava/internal/TupleDesc"));
@@ -214,10 +277,10 @@ Java_org_postgresql_pljava_internal_TupleDesc__1getColumnIndex(JNIEnv* env, jcla
 /*
  * Class:     org_postgresql_pljava_internal_TupleDesc
  * Method:    _formTuple
- * Signature: (J[Ljava/lang/Object;)Lorg/postgresql/pljava/internal/Tuple;
+ * Signature: (J[Ljava/lang/Object;Ljava/nio/ByteBuffer;)Lorg/postgresql/pljava/internal/Tuple;
  */
 JNIEXPORT jobject JNICALL
-Java_org_postgresql_pljava_internal_TupleDesc__1formTuple(JNIEnv* env, jclass cls, jlong _this, jobjectArray jvalues)
+Java_org_postgresql_pljava_internal_TupleDesc__1formTuple(JNIEnv* env, jclass cls, jlong _this, jobjectArray jvalues, jobject jprims)
 {
 	jobject result = 0;
 
@@ -234,13 +297,33 @@ Java_org_postgresql_pljava_internal_TupleDesc__1formTuple(JNIEnv* env, jclass cl
 		Datum* values  = (Datum*)palloc(count * sizeof(Datum));
 		bool*  nulls   = palloc(count * sizeof(bool));
 		jobject typeMap = Invocation_getTypeMap(); /* a global ref */
+		jlong* prims = NULL;
+		jbyte* kinds = NULL;
 
 		memset(values, 0,  count * sizeof(Datum));
 		memset(nulls, true, count * sizeof(bool));/*all values null initially*/
+
+		/*
+		 * If given, jprims holds count jlongs of primitive values, followed by
+		 * count bytes saying which columns have one and of what kind.
+		 */
+		if ( NULL != jprims )
+		{
+			prims = (jlong*)JNI_getDirectBufferAddress(jprims);
+			kinds = (jbyte*)(prims + count);
+		}
 	
 		for(idx = 0; idx < count; ++idx)
 		{
-			jobject value = JNI_getObjectArrayElement(jvalues, idx);
+			jobject value;
+			if ( NULL != kinds  &&  0 != kinds[idx] )
+			{
+				values[idx] = primitiveDatum(
+					TupleDescAttr(self, idx), kinds[idx], prims[idx]);
+				nulls[idx] = false;
+				continue;
+			}
+			value = JNI_getObjectArrayElement(jvalues, idx);
 			if(value != 0)
 			{
 				/* Obtain boxed types here too, when that matters. */
@@ -267,6 +350,55 @@ Java_org_postgresql_pljava_internal_TupleDesc__1formTuple(JNIEnv* env, jclass cl
 	return result;
 }
 
+void pljava_TupleDesc_putBatch(TupleDesc self, Tuplestorestate *tupstore,
+	jobjectArray jvalues, jbyte *prims, int nrows)
+{
+	int    count  = self->natts;
+	int    stride = 8 * count + TYPEALIGN(8, count);
+	Datum* values = (Datum*)palloc(count * sizeof(Datum));
+	bool*  nulls  = (bool*)palloc(count * sizeof(bool));
+	Type*  types  = (Type*)palloc0(count * sizeof(Type));
+	jobject typeMap = Invocation_getTypeMap(); /* a global ref */
+	int    row;
+	int    idx;
+
+	for ( row = 0 ; row < nrows ; ++ row )
+	{
+		jlong* rowPrims = (jlong*)(prims + row * stride);
+		jbyte* kinds    = (jbyte*)(rowPrims + count);
+
+		for ( idx = 0 ; idx < count ; ++ idx )
+		{
+			jobject value;
+			if ( 0 != kinds[idx] )
+			{
+				values[idx] = primitiveDatum(
+					TupleDescAttr(self, idx), kinds[idx], rowPrims[idx]);
+				nulls[idx] = false;
+				continue;
+			}
+			value = JNI_getObjectArrayElement(jvalues, row * count + idx);
+			if ( 0 == value )
+			{
+				values[idx] = 0;
+				nulls[idx] = true;
+				continue;
+			}
+			if ( NULL == types[idx] )
+				types[idx] = Type_objectTypeFromOid(
+					SPI_gettypeid(self, idx + 1), typeMap);
+			values[idx] = Type_coerceObjectBridged(types[idx], value);
+			nulls[idx] = false;
+			JNI_deleteLocalRef(value);
+		}
+		tuplestore_putvalues(tupstore, self, values, nulls);
+	}
+
+	pfree(types);
+	pfree(nulls);
+	pfree(values);
+}
+
 /*
  * Class:     org_postgresql_pljava_internal_TupleDesc
  * Method:    _getOid
@@ -302,3 +434,33 @@ Java_org_postgresql_pljava_internal_TupleDesc__1getOid(JNIEnv* env, jclass cls,
 
 	return result;
 }
+
+/*
+ * Class:     org_postgresql_pljava_internal_TupleDesc
+ * Method:    _getColumnType
+ * Signature: (JI)J
+ */
+JNIEXPORT jlong JNICALL
+Java_org_postgresql_pljava_internal_TupleDesc__1getColumnType(JNIEnv* env, jclass cls, jlong _this, jint index)
+{
+	jlong result = 0;
+
+	BEGIN_NATIVE
+	Ptr2Long p2l;
+	p2l.longVal = _this;
+	PG_TRY();
+	{
+		Type type = pljava_TupleDesc_getColumnType(
+			(TupleDesc)p2l.ptrVal, (int)index);
+		p2l.longVal = 0L; /* ensure that the rest is zeroed out */
+		p2l.ptrVal = type;
+		result = p2l.longVal;
+	}
+	PG_CATCH();
+	{
+		Exception_throw_ERROR("pljava_TupleDesc_getColumnType");
+	}
+	PG_END_TRY();
+	END_NATIVE
+	return result;
+}
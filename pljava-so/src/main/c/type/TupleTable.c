@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2004-2020 Tada AB and other contributors, as listed below.
+ * Copyright (c) 2004-2026 Tada AB and other contributors, as listed below.
  *
  * All rights reserved. This program and the accompanying materials
  * are made available under the terms of the The BSD 3-Clause License
@@ -13,7 +13,12 @@
 #include <postgres.h>
 #include <executor/spi.h>
 #include <executor/tuptable.h>
+#include <catalog/pg_type.h>
+#include <utils/memutils.h>
 
+#include "pljava/Backend.h"
+#include "pljava/DualState.h"
+#include "pljava/Invocation.h"
 #include "pljava/type/Type_priv.h"
 #include "pljava/type/TupleTable.h"
 #include "pljava/type/Tuple.h"
@@ -25,6 +30,169 @@
 
 static jclass    s_TupleTable_class;
 static jmethodID s_TupleTable_init;
+static jmethodID s_TupleTable_initColumnar;
+static jmethodID s_TupleTable_initBorrowed;
+static jmethodID s_TupleTable_initCopied;
+static jclass    s_Object_class;
+static jclass    s_longArray_class;
+
+/*
+ * For the columnar fetch: the types whose columns are deformed natively into
+ * Java primitive arrays, which are of the classes the types map to by default.
+ */
+static bool isColumnarType(Oid typeId)
+{
+	switch ( typeId )
+	{
+		case BOOLOID:
+		case INT2OID:
+		case INT4OID:
+		case INT8OID:
+		case FLOAT4OID:
+		case FLOAT8OID:
+			return true;
+		default:
+			return false;
+	}
+}
+
+/*
+ * Deform each of the tupcount tuples once, and return an Object[] with one entry
+ * per column: a primitive array of the column values for a column of a type
+ * accepted by isColumnarType, and otherwise null. In *nullsOut is returned a
+ * parallel long[][] whose entry for a column is null if no value in the column
+ * is null, or else a bitmap in the form accepted by java.util.BitSet.valueOf,
+ * with a bit set for each null row. Returns null if no column qualifies.
+ */
+static jobjectArray deformColumns(
+	TupleDesc td, HeapTuple* vals, jint tupcount, jobjectArray* nullsOut)
+{
+	int natts = td->natts;
+	int nwords = (tupcount + 63) / 64;
+	Oid* typeIds = (Oid*)palloc(natts * sizeof(Oid));
+	Datum* values = (Datum*)palloc(natts * sizeof(Datum));
+	bool* isnull = (bool*)palloc(natts * sizeof(bool));
+	void** buffers = (void**)palloc0(natts * sizeof(void*));
+	jlong** bitmaps = (jlong**)palloc0(natts * sizeof(jlong*));
+	jobjectArray columns = 0;
+	jobjectArray nulls;
+	bool any = false;
+	int col;
+	jint row;
+
+	for ( col = 0 ; col < natts ; ++ col )
+	{
+		typeIds[col] = SPI_gettypeid(td, col + 1);
+		if ( isColumnarType(typeIds[col]) )
+		{
+			buffers[col] = palloc0((Size)tupcount * sizeof(jlong));
+			any = true;
+		}
+	}
+
+	if ( ! any )
+	{
+		*nullsOut = 0;
+		return 0;
+	}
+
+	for ( row = 0 ; row < tupcount ; ++ row )
+	{
+		heap_deform_tuple(vals[row], td, values, isnull);
+		for ( col = 0 ; col < natts ; ++ col )
+		{
+			void* buf = buffers[col];
+			Datum d = values[col];
+			if ( NULL == buf )
+				continue;
+			if ( isnull[col] )
+			{
+				if ( NULL == bitmaps[col] )
+					bitmaps[col] = (jlong*)palloc0(nwords * sizeof(jlong));
+				bitmaps[col][row / 64] |= (jlong)1 << (row % 64);
+				continue;
+			}
+			switch ( typeIds[col] )
+			{
+				case BOOLOID:
+					((jboolean*)buf)[row] = DatumGetBool(d) ? JNI_TRUE : JNI_FALSE;
+					break;
+				case INT2OID:
+					((jshort*)buf)[row] = DatumGetInt16(d);
+					break;
+				case INT4OID:
+					((jint*)buf)[row] = DatumGetInt32(d);
+					break;
+				case INT8OID:
+					((jlong*)buf)[row] = DatumGetInt64(d);
+					break;
+				case FLOAT4OID:
+					((jfloat*)buf)[row] = DatumGetFloat4(d);
+					break;
+				case FLOAT8OID:
+					((jdouble*)buf)[row] = DatumGetFloat8(d);
+					break;
+			}
+		}
+	}
+
+	columns = JNI_newObjectArray(natts, s_Object_class, 0);
+	nulls = JNI_newObjectArray(natts, s_longArray_class, 0);
+	for ( col = 0 ; col < natts ; ++ col )
+	{
+		jarray array;
+		void* buf = buffers[col];
+		if ( NULL == buf )
+			continue;
+		switch ( typeIds[col] )
+		{
+			case BOOLOID:
+				array = JNI_newBooleanArray(tupcount);
+				JNI_setBooleanArrayRegion(array, 0, tupcount, buf);
+				break;
+			case INT2OID:
+				array = JNI_newShortArray(tupcount);
+				JNI_setShortArrayRegion(array, 0, tupcount, buf);
+				break;
+			case INT4OID:
+				array = JNI_newIntArray(tupcount);
+				JNI_setIntArrayRegion(array, 0, tupcount, buf);
+				break;
+			case INT8OID:
+				array = JNI_newLongArray(tupcount);
+				JNI_setLongArrayRegion(array, 0, tupcount, buf);
+				break;
+			case FLOAT4OID:
+				array = JNI_newFloatArray(tupcount);
+				JNI_setFloatArrayRegion(array, 0, tupcount, buf);
+				break;
+			default: /* FLOAT8OID */
+				array = JNI_newDoubleArray(tupcount);
+				JNI_setDoubleArrayRegion(array, 0, tupcount, buf);
+				break;
+		}
+		JNI_setObjectArrayElement(columns, col, array);
+		JNI_deleteLocalRef(array);
+		pfree(buf);
+
+		if ( NULL != bitmaps[col] )
+		{
+			jlongArray bitmap = JNI_newLongArray(nwords);
+			JNI_setLongArrayRegion(bitmap, 0, nwords, bitmaps[col]);
+			JNI_setObjectArrayElement(nulls, col, bitmap);
+			JNI_deleteLocalRef(bitmap);
+			pfree(bitmaps[col]);
+		}
+	}
+
+	pfree(typeIds);
+	pfree(values);
+	pfree(isnull);
+	pfree(buffers);
+	pfree(bitmaps);
+	*nullsOut = nulls;
+	return columns;
+}
 
 jobject TupleTable_createFromSlot(TupleTableSlot* tts)
 {
@@ -47,14 +215,9 @@ jobject TupleTable_createFromSlot(TupleTableSlot* tts)
 	return JNI_newObject(s_TupleTable_class, s_TupleTable_init, tupdesc, tuples);
 }
 
-jobject TupleTable_create(SPITupleTable* tts, jobject knownTD)
+static jint tupleCount(SPITupleTable* tts)
 {
-	jobjectArray tuples;
 	uint64 tupcount;
-	MemoryContext curr;
-
-	if(tts == 0)
-		return 0;
 
 #if PG_VERSION_NUM < 130000
 	tupcount = tts->alloced - tts->free;
@@ -66,16 +229,190 @@ jobject TupleTable_create(SPITupleTable* tts, jobject knownTD)
 				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
 				 errmsg("a PL/Java TupleTable cannot represent more than "
 					"INT32_MAX rows")));
+	return (jint)tupcount;
+}
 
-	curr = MemoryContextSwitchTo(JavaMemoryContext);
+/*
+ * Return a Java long[] of the count tuple pointers in vals.
+ */
+static jlongArray pointerArray(HeapTuple* vals, jint count)
+{
+	jlongArray pointers;
+	jlong* buf;
+	jint i;
+
+	buf = (jlong*)palloc(((Size)count + 1) * sizeof(jlong));
+	for ( i = 0 ; i < count ; ++ i )
+	{
+		Ptr2Long p2l;
+		p2l.longVal = 0L;
+		p2l.ptrVal = vals[i];
+		buf[i] = p2l.longVal;
+	}
+	pointers = JNI_newLongArray(count);
+	JNI_setLongArrayRegion(pointers, 0, count, buf);
+	pfree(buf);
+	return pointers;
+}
+
+/*
+ * Copy the tuples into a memory context of their own, made for the table, so
+ * that releasing the table frees them with one MemoryContextDelete, rather
+ * than a heap_freetuple for each Tuple as it becomes unreachable.
+ */
+jobject TupleTable_create(SPITupleTable* tts, jobject knownTD)
+{
+	jobject result = 0;
+	jint tupcount;
+	MemoryContext cxt;
+	MemoryContext curr;
+
+	if(tts == 0)
+		return 0;
+
+	tupcount = tupleCount(tts);
 
 	if(knownTD == 0)
+	{
+		curr = MemoryContextSwitchTo(JavaMemoryContext);
 		knownTD = pljava_TupleDesc_internalCreate(tts->tupdesc);
+		MemoryContextSwitchTo(curr);
+	}
+
+	cxt = AllocSetContextCreate(JavaMemoryContext,
+		"PL/Java TupleTable", ALLOCSET_START_SMALL_SIZES);
+
+	PG_TRY();
+	{
+		jobjectArray columns = 0;
+		jobjectArray nulls = 0;
+		jlongArray pointers;
+		HeapTuple* copies;
+		Ptr2Long p2lcx;
+		jint i;
 
-	tuples = pljava_Tuple_createArray(tts->vals, (jint)tupcount, true);
+		copies = (HeapTuple*)palloc(((Size)tupcount + 1) * sizeof(HeapTuple));
+		curr = MemoryContextSwitchTo(cxt);
+		for ( i = 0 ; i < tupcount ; ++ i )
+			copies[i] = heap_copytuple(tts->vals[i]);
+		MemoryContextSwitchTo(curr);
+		pointers = pointerArray(copies, tupcount);
+		pfree(copies);
+
+		if ( Backend_isSPIColumnarFetch() )
+			columns = deformColumns(tts->tupdesc, tts->vals, tupcount, &nulls);
+
+		p2lcx.longVal = 0L;
+		p2lcx.ptrVal = cxt;
+
+		result = JNI_newObject(s_TupleTable_class, s_TupleTable_initCopied,
+			pljava_DualState_key(), p2lcx.longVal,
+			knownTD, pointers, columns, nulls);
+	}
+	PG_CATCH();
+	{
+		MemoryContextDelete(cxt);
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+	return result;
+}
+
+#if PG_VERSION_NUM >= 90500
+/*
+ * Called as the memory context of a borrowed SPI tuple table is deleted,
+ * whether by SPI_freetuptable when the Java table is released, by SPI_finish,
+ * or by SPI's cleanup when the subtransaction the table was read in is rolled
+ * back, so that Java cannot go on using the table's tuples. The DualState is
+ * scoped to the context itself.
+ */
+static void borrowedTableFreed(void *arg)
+{
+	pljava_DualState_nativeRelease(arg);
+}
+#endif
+
+/*
+ * Take over the SPI tuple table in place. Its DualState is scoped to the
+ * table's own memory context, released when that is deleted (see
+ * borrowedTableFreed), rather than to the Invocation, which a rollback to a
+ * savepoint would not end. Before PostgreSQL 9.5, which has no memory context
+ * callbacks, it is scoped to the Invocation as before.
+ *
+ * Nothing handed to Java from these tuples may point into them, as they are
+ * freed on the ResultSet's next move past the batch while the values read from
+ * them may still be held: a composite value's SingleRowReader copies its tuple,
+ * and a primitive buffer its array's data, and the Tuple objects themselves
+ * are invalidated with the table.
+ */
+jobject TupleTable_createBorrowed(SPITupleTable* tts, jobject knownTD)
+{
+	jobjectArray columns = 0;
+	jobjectArray nulls = 0;
+	jlongArray pointers;
+	jint tupcount;
+	Ptr2Long p2lro;
+	Ptr2Long p2ltt;
+	MemoryContext curr;
+
+	if(tts == 0)
+		return 0;
+
+	tupcount = tupleCount(tts);
+
+	if(knownTD == 0)
+	{
+		curr = MemoryContextSwitchTo(JavaMemoryContext);
+		knownTD = pljava_TupleDesc_internalCreate(tts->tupdesc);
+		MemoryContextSwitchTo(curr);
+	}
+
+	pointers = pointerArray(tts->vals, tupcount);
+
+	if ( Backend_isSPIColumnarFetch() )
+		columns = deformColumns(tts->tupdesc, tts->vals, tupcount, &nulls);
+
+	p2lro.longVal = 0L;
+#if PG_VERSION_NUM >= 90500
+	{
+		MemoryContextCallback *cb = (MemoryContextCallback *)
+			MemoryContextAlloc(tts->tuptabcxt, sizeof *cb);
+		cb->func = borrowedTableFreed;
+		cb->arg = tts->tuptabcxt;
+		MemoryContextRegisterResetCallback(tts->tuptabcxt, cb);
+	}
+	p2lro.ptrVal = tts->tuptabcxt;
+#else
+	p2lro.ptrVal = currentInvocation;
+#endif
+	p2ltt.longVal = 0L;
+	p2ltt.ptrVal = tts;
+
+	return JNI_newObject(s_TupleTable_class, s_TupleTable_initBorrowed,
+		pljava_DualState_key(), p2lro.longVal, p2ltt.longVal,
+		knownTD, pointers, columns, nulls);
+}
+
+jobject TupleTable_createFromTuples(TupleDesc td, HeapTuple* vals, jint count)
+{
+	jobject tupdesc;
+	jobjectArray tuples;
+	jobjectArray columns;
+	jobjectArray nulls = 0;
+	MemoryContext curr;
+
+	curr = MemoryContextSwitchTo(JavaMemoryContext);
+	tupdesc = pljava_TupleDesc_internalCreate(td);
+	tuples = pljava_Tuple_createArray(vals, count, true);
 	MemoryContextSwitchTo(curr);
 
-	return JNI_newObject(s_TupleTable_class, s_TupleTable_init, knownTD, tuples);
+	columns = deformColumns(td, vals, count, &nulls);
+	if ( 0 == columns )
+		return JNI_newObject(
+			s_TupleTable_class, s_TupleTable_init, tupdesc, tuples);
+
+	return JNI_newObject(s_TupleTable_class, s_TupleTable_initColumnar,
+		tupdesc, tuples, columns, nulls);
 }
 
 /* Make this datatype available to the postgres system.
@@ -87,4 +424,15 @@ void TupleTable_initialize(void)
 	s_TupleTable_init = PgObject_getJavaMethod(
 				s_TupleTable_class, "<init>",
 				"(Lorg/postgresql/pljava/internal/TupleDesc;[Lorg/postgresql/pljava/internal/Tuple;)V");
+	s_TupleTable_initColumnar = PgObject_getJavaMethod(
+				s_TupleTable_class, "<init>",
+				"(Lorg/postgresql/pljava/internal/TupleDesc;[Lorg/postgresql/pljava/internal/Tuple;[Ljava/lang/Object;[[J)V");
+	s_TupleTable_initBorrowed = PgObject_getJavaMethod(
+				s_TupleTable_class, "<init>",
+				"(Lorg/postgresql/pljava/internal/DualState$Key;JJLorg/postgresql/pljava/internal/TupleDesc;[J[Ljava/lang/Object;[[J)V");
+	s_TupleTable_initCopied = PgObject_getJavaMethod(
+				s_TupleTable_class, "<init>",
+				"(Lorg/postgresql/pljava/internal/DualState$Key;JLorg/postgresql/pljava/internal/TupleDesc;[J[Ljava/lang/Object;[[J)V");
+	s_Object_class = JNI_newGlobalRef(PgObject_getJavaClass("java/lang/Object"));
+	s_longArray_class = JNI_newGlobalRef(PgObject_getJavaClass("[J"));
 }
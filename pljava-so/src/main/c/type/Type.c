@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2004-2022 Tada AB and other contributors, as listed below.
+ * Copyright (c) 2004-2026 Tada AB and other contributors, as listed below.
  *
  * All rights reserved. This program and the accompanying materials
  * are made available under the terms of the The BSD 3-Clause License
@@ -13,11 +13,16 @@
 #include <postgres.h>
 #include <fmgr.h>
 #include <funcapi.h>
+#include <miscadmin.h>
 #include <parser/parse_coerce.h>
 #include <utils/builtins.h>
+#include <utils/tuplestore.h>
 #include <utils/typcache.h>
 #include <utils/lsyscache.h>
+#include <utils/inval.h>
+#include <utils/syscache.h>
 
+#include "org_postgresql_pljava_jdbc_ColumnBatchWriter.h"
 #include "pljava/type/String_priv.h"
 #include "pljava/type/Array.h"
 #include "pljava/type/Coerce.h"
@@ -25,9 +30,12 @@
 #include "pljava/type/TupleDesc.h"
 #include "pljava/type/Oid.h"
 #include "pljava/type/UDT.h"
+#include "pljava/Backend.h"
+#include "pljava/Exception.h"
 #include "pljava/Function.h"
 #include "pljava/Invocation.h"
 #include "pljava/HashMap.h"
+#include "pljava/OidMap.h"
 #include "pljava/SPI.h"
 
 #if PG_VERSION_NUM < 80300
@@ -68,10 +76,13 @@ static Oid INT2ARRAYOID;
 #endif
 #endif
 
-static HashMap s_typeByOid;
-static HashMap s_obtainerByOid;
+static OidMap  s_typeByOid;
+static OidMap  s_fallbackByOid;
+static OidMap  s_obtainerByOid;
 static HashMap s_obtainerByJavaName;
 
+static bool initializeDeferredTypes(void);
+
 static jclass s_Map_class;
 static jmethodID s_Map_get;
 
@@ -88,10 +99,47 @@ static jclass s_Iterator_class;
 static jmethodID s_Iterator_hasNext;
 static jmethodID s_Iterator_next;
 
+static jclass s_ResultSetProvider_Batched_class;
+static jclass s_ResultSetProvider_Writing_class;
+static jclass s_ColumnBatchWriter_class;
+static jmethodID s_ColumnBatchWriter_init;
+static jmethodID s_ColumnBatchWriter_values;
+static jmethodID s_ColumnBatchWriter_primitives;
+static jclass s_PrimitiveIterator_OfLong_class;
+static jclass s_PrimitiveIterator_OfInt_class;
+static jclass s_PrimitiveIterator_OfDouble_class;
+static jclass s_PrimitiveBatchReader_class;
+static jmethodID s_PrimitiveBatchReader_init;
+static jmethodID s_PrimitiveBatchReader_values;
+
+/*
+ * The most rows in one batch filled by a ResultSetProvider.Batched, however
+ * large pljava.srf_materialize_rows is.
+ */
+#define SRF_BATCH_MAX_ROWS 1024
+
 static jclass s_TypeBridge_Holder_class;
 static jmethodID s_TypeBridge_Holder_className;
 static jmethodID s_TypeBridge_Holder_defaultOid;
 static jmethodID s_TypeBridge_Holder_payload;
+static jfieldID s_TypeBridge_Holder_m_payload;
+static jfieldID s_TypeBridge_Holder_m_bridgeIndex;
+
+/*
+ * The Type resolved for each TypeBridge (by its m_index), for the typeId of
+ * the Type it last replaced, so that Type_coerceObjectBridged need not fetch
+ * and look up the class name for every Holder it is passed. There are only
+ * the few TypeBridges made in initializeTypeBridges, and a bridge is rarely
+ * used in place of more than one type, so one entry per bridge suffices.
+ */
+typedef struct
+{
+	Oid  typeId;
+	Type rqtype;
+} BridgeCacheEntry;
+
+static BridgeCacheEntry *s_bridgeCache;
+static jint s_bridgeCacheSize;
 
 /*
  * Structure used to retain state of set-returning functions using the
@@ -278,7 +326,12 @@ static Type _getCoerce(Type self, Type other, Oid fromOid, Oid toOid,
 		if ( ! IsBinaryCoercible(fromOid, toOid) && DomainHasConstraints(toOid))
 			elog(WARNING, "disregarding domain constraints of (regtype) %d",
 				 toOid);
-		return self;
+		/*
+		 * Remember that, too, so the next lookup finds self in the map and
+		 * neither repeats the catalog search nor puts any call in the way.
+		 */
+		funcId = InvalidOid;
+		break;
 	case COERCION_PATH_COERCEVIAIO:
 		elog(ERROR, "COERCEVIAIO not implemented from (regtype) %d to %d",
 			 fromOid, toOid);
@@ -294,7 +347,7 @@ static Type _getCoerce(Type self, Type other, Oid fromOid, Oid toOid,
 	if(*map == 0)
 		*map = HashMap_create(7, GetMemoryChunkContext(self));
 
-	coercer = builder(self, other, funcId);
+	coercer = OidIsValid(funcId) ? builder(self, other, funcId) : self;
 	HashMap_putByOid(*map, other->typeId, coercer);
 	return coercer;
 }
@@ -319,6 +372,11 @@ jvalue Type_coerceDatum(Type self, Datum value)
 	return self->typeClass->coerceDatum(self, value);
 }
 
+DatumCoercer Type_getDatumCoercer(Type self)
+{
+	return self->typeClass->coerceDatum;
+}
+
 jvalue Type_coerceDatumAs(Type self, Datum value, jclass rqcls)
 {
 	jstring rqcname;
@@ -343,15 +401,57 @@ Datum Type_coerceObject(Type self, jobject object)
 	return self->typeClass->coerceObject(self, object);
 }
 
+static Type resolveBridge(Type self, jobject object);
+
 Datum Type_coerceObjectBridged(Type self, jobject object)
 {
-	jstring rqcname;
-	char *rqcname0;
 	Type rqtype;
+	jint index;
+	jobject payload;
+	Datum result;
 
 	if ( JNI_FALSE == JNI_isInstanceOf(object, s_TypeBridge_Holder_class) )
 		return Type_coerceObject(self, object);
 
+	index = JNI_getIntField(object, s_TypeBridge_Holder_m_bridgeIndex);
+	if ( index < s_bridgeCacheSize
+		&&  NULL != s_bridgeCache[index].rqtype
+		&&  self->typeId == s_bridgeCache[index].typeId )
+		rqtype = s_bridgeCache[index].rqtype;
+	else
+	{
+		rqtype = resolveBridge(self, object);
+		if ( index >= s_bridgeCacheSize )
+		{
+			jint newSize = Max(index + 1, 2 * s_bridgeCacheSize);
+			s_bridgeCache = NULL == s_bridgeCache
+				? MemoryContextAllocZero(TopMemoryContext,
+					newSize * sizeof *s_bridgeCache)
+				: repalloc(s_bridgeCache, newSize * sizeof *s_bridgeCache);
+			memset(s_bridgeCache + s_bridgeCacheSize, 0,
+				(newSize - s_bridgeCacheSize) * sizeof *s_bridgeCache);
+			s_bridgeCacheSize = newSize;
+		}
+		s_bridgeCache[index].typeId = self->typeId;
+		s_bridgeCache[index].rqtype = rqtype;
+	}
+
+	payload = JNI_getObjectField(object, s_TypeBridge_Holder_m_payload);
+	result = Type_coerceObject(rqtype, payload);
+	JNI_deleteLocalRef(payload);
+	return result;
+}
+
+/*
+ * Resolve, by its class name, the Type to be used for the payload of a
+ * TypeBridge.Holder in place of self.
+ */
+static Type resolveBridge(Type self, jobject object)
+{
+	jstring rqcname;
+	char *rqcname0;
+	Type rqtype;
+
 	rqcname = JNI_callObjectMethod(object, s_TypeBridge_Holder_className);
 	rqcname0 = String_createNTS(rqcname);
 	JNI_deleteLocalRef(rqcname);
@@ -368,8 +468,7 @@ Datum Type_coerceObjectBridged(Type self, jobject object)
 		else
 			elog(ERROR, "type bridge failure");
 	}
-	object = JNI_callObjectMethod(object, s_TypeBridge_Holder_payload);
-	return Type_coerceObject(rqtype, object);
+	return rqtype;
 }
 
 char Type_getAlign(Type self)
@@ -484,12 +583,359 @@ Datum Type_invoke(Type self, Function fn, PG_FUNCTION_ARGS)
 	return self->typeClass->invoke(self, fn, fcinfo);
 }
 
+/*
+ * Produce the rows of a ResultSetProvider.Batched into tupstore a batch at a
+ * time: one call into Java fills a batch, and the native code forms all its
+ * rows, reading primitive values in place. Row memory is reclaimed, and
+ * interrupts checked for, after each batch. rowProducer is the function's
+ * value-per-call Invocable, through which the provider is called.
+ */
+static void putBatches(jobject rowProducer, jobject rowCollector,
+	TupleDesc tupdesc, Tuplestorestate* tupstore, int chunkRows,
+	MemoryContext rowCtx)
+{
+	jint capacity = Min(chunkRows, SRF_BATCH_MAX_ROWS);
+	jobject batch = JNI_newObject(s_ColumnBatchWriter_class,
+		s_ColumnBatchWriter_init, rowCollector, capacity);
+	jobjectArray values = (jobjectArray)
+		JNI_callObjectMethod(batch, s_ColumnBatchWriter_values);
+	jobject primBuffer =
+		JNI_callObjectMethod(batch, s_ColumnBatchWriter_primitives);
+	jbyte* prims = (jbyte*)JNI_getDirectBufferAddress(primBuffer);
+	jint rows;
+
+	while ( 0 < (rows = pljava_Function_srfBatchFill(rowProducer, batch)) )
+	{
+		pljava_TupleDesc_putBatch(tupdesc, tupstore, values, prims, rows);
+		MemoryContextReset(rowCtx);
+		CHECK_FOR_INTERRUPTS();
+	}
+
+	JNI_deleteLocalRef(primBuffer);
+	JNI_deleteLocalRef(values);
+	JNI_deleteLocalRef(batch);
+}
+
+/*
+ * Where the rows flushed by a ResultSetProvider.Writing go, for the duration
+ * of its writeRows call. The memory used in forming each flushed batch is
+ * reclaimed in flushCtx.
+ */
+typedef struct
+{
+	TupleDesc tupdesc;
+	Tuplestorestate* tupstore;
+	MemoryContext flushCtx;
+} WriteTarget;
+
+/*
+ * Have a ResultSetProvider.Writing write all its rows in one call into Java,
+ * through a ColumnBatchWriter whose flush passes each batch to _putBatch
+ * below, which stores its rows in tupstore at once; Java holds no more than
+ * one batch of rows at a time, and the tuplestore spills to disk past
+ * work_mem.
+ */
+static void putWritten(jobject rowProducer, jobject rowCollector,
+	TupleDesc tupdesc, Tuplestorestate* tupstore, int chunkRows,
+	MemoryContext rowCtx)
+{
+	jint capacity = Min(chunkRows, SRF_BATCH_MAX_ROWS);
+	WriteTarget target;
+	Ptr2Long p2l;
+	jobject batch = JNI_newObject(s_ColumnBatchWriter_class,
+		s_ColumnBatchWriter_init, rowCollector, capacity);
+
+	target.tupdesc = tupdesc;
+	target.tupstore = tupstore;
+	target.flushCtx = AllocSetContextCreate(rowCtx, "PL/Java SRF flush",
+		ALLOCSET_DEFAULT_SIZES);
+	p2l.longVal = 0L;
+	p2l.ptrVal = &target;
+
+	pljava_Function_srfWrite(rowProducer, batch, p2l.longVal);
+
+	MemoryContextDelete(target.flushCtx);
+	JNI_deleteLocalRef(batch);
+}
+
+/*
+ * Class:     org_postgresql_pljava_jdbc_ColumnBatchWriter
+ * Method:    _putBatch
+ * Signature: (J[Ljava/lang/Object;Ljava/nio/ByteBuffer;I)V
+ */
+JNIEXPORT void JNICALL
+Java_org_postgresql_pljava_jdbc_ColumnBatchWriter__1putBatch(JNIEnv* env, jclass cls, jlong _target, jobjectArray values, jobject primBuffer, jint rows)
+{
+	BEGIN_NATIVE
+	PG_TRY();
+	{
+		Ptr2Long p2l;
+		WriteTarget* target;
+		MemoryContext curr;
+
+		p2l.longVal = _target;
+		target = (WriteTarget*)p2l.ptrVal;
+		curr = MemoryContextSwitchTo(target->flushCtx);
+		pljava_TupleDesc_putBatch(target->tupdesc, target->tupstore, values,
+			(jbyte*)JNI_getDirectBufferAddress(primBuffer), rows);
+		MemoryContextSwitchTo(curr);
+		MemoryContextReset(target->flushCtx);
+		CHECK_FOR_INTERRUPTS();
+	}
+	PG_CATCH();
+	{
+		Exception_throw_ERROR("tuplestore_putvalues");
+	}
+	PG_END_TRY();
+	END_NATIVE
+}
+
+/*
+ * Produce the values of a PrimitiveIterator, for a set of int8, int4, or
+ * float8 of the matching kind, into tupstore a batch at a time: one call into
+ * Java fills a batch of unboxed values, which are read in place. Returns false
+ * (having done nothing) if producer (what the function's value-per-call
+ * Invocable rowProducer was made over) is not a PrimitiveIterator matching the
+ * result type.
+ */
+static bool putPrimitiveBatches(jobject rowProducer, jobject producer,
+	Oid resultTypeId, TupleDesc tupdesc, Tuplestorestate* tupstore,
+	int chunkRows, MemoryContext rowCtx)
+{
+	jint capacity = Min(chunkRows, SRF_BATCH_MAX_ROWS);
+	jobject reader;
+	jobject valueBuffer;
+	jlong* values;
+	jint rows;
+	jint i;
+	bool isNull = false;
+
+	if ( 0 == producer )
+		return false;
+	if ( ! ( ( INT8OID == resultTypeId  &&  JNI_isInstanceOf(
+				producer, s_PrimitiveIterator_OfLong_class) )
+		||  ( INT4OID == resultTypeId  &&  JNI_isInstanceOf(
+				producer, s_PrimitiveIterator_OfInt_class) )
+		||  ( FLOAT8OID == resultTypeId  &&  JNI_isInstanceOf(
+				producer, s_PrimitiveIterator_OfDouble_class) ) ) )
+		return false;
+
+	reader = JNI_newObject(s_PrimitiveBatchReader_class,
+		s_PrimitiveBatchReader_init, capacity);
+	valueBuffer = JNI_callObjectMethod(reader, s_PrimitiveBatchReader_values);
+	values = (jlong*)JNI_getDirectBufferAddress(valueBuffer);
+
+	while ( 0 < (rows = pljava_Function_srfPrimitiveFill(rowProducer, reader)) )
+	{
+		for ( i = 0 ; i < rows ; ++ i )
+		{
+			Datum value;
+			switch ( resultTypeId )
+			{
+			case INT8OID:
+				value = Int64GetDatum(values[i]);
+				break;
+			case INT4OID:
+				value = Int32GetDatum((int32)values[i]);
+				break;
+			default:
+				value = Float8GetDatum(((jdouble*)values)[i]);
+			}
+			tuplestore_putvalues(tupstore, tupdesc, &value, &isNull);
+		}
+		MemoryContextReset(rowCtx);
+		CHECK_FOR_INTERRUPTS();
+	}
+
+	JNI_deleteLocalRef(valueBuffer);
+	JNI_deleteLocalRef(reader);
+	return true;
+}
+
+/*
+ * The materialize-mode alternative to the value-per-call protocol below, used
+ * when pljava.srf_materialize_rows is positive and the executor allows it.
+ * The whole set is produced in this one call into a tuplestore, with one
+ * Invocation and parameter frame for all the rows instead of one per row.
+ * Each row still takes one vpcInvoke into Java (the ResultSetProvider and
+ * Iterator interfaces deliver a row at a time), but no longer a return to
+ * the executor, a new Invocation, and restoring the stashed call context
+ * between rows. Memory used in producing and converting rows is reclaimed,
+ * and interrupts checked for, once every chunkRows rows. A provider that is a
+ * ResultSetProvider.Writing is instead driven by putWritten, one that is a
+ * ResultSetProvider.Batched by putBatches, and a PrimitiveIterator of a
+ * scalar int8, int4, or float8 result by putPrimitiveBatches.
+ *
+ * rowProducer is what the call of the Java function returned.
+ */
+static Datum invokeSRFMaterialize(Type self, Function fn, PG_FUNCTION_ARGS,
+	jobject rowProducer, int chunkRows)
+{
+	ReturnSetInfo* rsi = (ReturnSetInfo*)fcinfo->resultinfo;
+	MemoryContext perQueryCtx = rsi->econtext->ecxt_per_query_memory;
+	MemoryContext currCtx;
+	MemoryContext rowCtx;
+	MemoryContext savedUpper;
+	Tuplestorestate* tupstore;
+	TupleDesc tupdesc;
+	TypeFuncClass funcClass;
+	Oid resultTypeId;
+	jobject rowCollector;
+	jobject producer;
+	jobject row;
+	jlong rowNumber = 0;
+	Datum* nullValues;
+	bool* allNull;
+	bool isComposite;
+
+	if(rowProducer == 0)
+	{
+		Invocation_assertDisconnect();
+		rsi->returnMode = SFRM_Materialize;
+		rsi->setResult = NULL;
+		rsi->setDesc = NULL;
+		PG_RETURN_NULL();
+	}
+
+	rowCollector = Type_getSRFCollector(self, fcinfo);
+
+	funcClass = get_call_result_type(fcinfo, &resultTypeId, NULL);
+	isComposite =
+		TYPEFUNC_COMPOSITE == funcClass  ||  TYPEFUNC_RECORD == funcClass;
+
+	currCtx = MemoryContextSwitchTo(perQueryCtx);
+	if ( isComposite )
+		tupdesc = CreateTupleDescCopy(Type_getTupleDesc(self, fcinfo));
+	else
+	{
+#if PG_VERSION_NUM >= 120000
+		tupdesc = CreateTemplateTupleDesc(1);
+#else
+		tupdesc = CreateTemplateTupleDesc(1, false);
+#endif
+		TupleDescInitEntry(tupdesc, (AttrNumber)1, "result",
+			resultTypeId, -1, 0);
+	}
+	tupstore = tuplestore_begin_heap(
+		0 != (rsi->allowedModes & SFRM_Materialize_Random), false, work_mem);
+	nullValues = (Datum*)palloc0(tupdesc->natts * sizeof(Datum));
+	allNull = (bool*)palloc(tupdesc->natts * sizeof(bool));
+	memset(allNull, true, tupdesc->natts * sizeof(bool));
+	MemoryContextSwitchTo(currCtx);
+
+	/*
+	 * Conversions that allocate their results in the Invocation's upper
+	 * context would otherwise accumulate there for the whole set; point it at
+	 * the per-chunk context for the duration, and put it back even on error,
+	 * as the per-chunk context goes away with the caller's.
+	 */
+	rowCtx = AllocSetContextCreate(currCtx, "PL/Java SRF rows",
+		ALLOCSET_DEFAULT_SIZES);
+	savedUpper = currentInvocation->upperContext;
+	currentInvocation->upperContext = rowCtx;
+	MemoryContextSwitchTo(rowCtx);
+
+	PG_TRY();
+	{
+		producer = pljava_Function_srfProducer(rowProducer);
+		if ( isComposite  &&  0 != rowCollector  &&  0 != producer
+			&&  JNI_isInstanceOf(producer, s_ResultSetProvider_Writing_class) )
+			putWritten(rowProducer, rowCollector, tupdesc, tupstore, chunkRows,
+				rowCtx);
+		else if ( isComposite  &&  0 != rowCollector  &&  0 != producer
+			&&  JNI_isInstanceOf(producer, s_ResultSetProvider_Batched_class) )
+			putBatches(rowProducer, rowCollector, tupdesc, tupstore, chunkRows,
+				rowCtx);
+		else if ( isComposite  ||  ! putPrimitiveBatches(rowProducer, producer,
+			resultTypeId, tupdesc, tupstore, chunkRows, rowCtx) )
+		{
+			while(JNI_TRUE == pljava_Function_vpcInvoke(fn,
+				rowProducer, rowCollector, rowNumber, JNI_FALSE, &row))
+			{
+				Datum value = Type_datumFromSRF(self, row, rowCollector);
+				bool isNull = isComposite ? (0 == value) : (0 == row);
+				JNI_deleteLocalRef(row);
+
+				if ( isNull )
+					tuplestore_putvalues(
+						tupstore, tupdesc, nullValues, allNull);
+				else if ( isComposite )
+				{
+					HeapTupleData tuple;
+					HeapTupleHeader hth = DatumGetHeapTupleHeader(value);
+					tuple.t_len = HeapTupleHeaderGetDatumLength(hth);
+					ItemPointerSetInvalid(&tuple.t_self);
+					tuple.t_tableOid = InvalidOid;
+					tuple.t_data = hth;
+					tuplestore_puttuple(tupstore, &tuple);
+				}
+				else
+					tuplestore_putvalues(tupstore, tupdesc, &value, &isNull);
+
+				if ( 0 == ++ rowNumber % chunkRows )
+				{
+					MemoryContextReset(rowCtx);
+					CHECK_FOR_INTERRUPTS();
+				}
+				MemoryContextSwitchTo(rowCtx);
+			}
+		}
+
+		/*
+		 * As in _closeIteration, but the producer and collector here are only
+		 * local references.
+		 */
+		pljava_Function_vpcInvoke(fn, rowProducer, NULL, 1, JNI_TRUE, &row);
+		JNI_deleteLocalRef(producer);
+		JNI_deleteLocalRef(rowProducer);
+		if(rowCollector != 0)
+			JNI_deleteLocalRef(rowCollector);
+	}
+	PG_CATCH();
+	{
+		currentInvocation->upperContext = savedUpper;
+		MemoryContextSwitchTo(currCtx);
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+
+	currentInvocation->upperContext = savedUpper;
+	MemoryContextSwitchTo(currCtx);
+	MemoryContextDelete(rowCtx);
+
+	rsi->returnMode = SFRM_Materialize;
+	rsi->setResult = tupstore;
+	rsi->setDesc = tupdesc;
+	return (Datum)0;
+}
+
+/*
+ * Whether the value-per-call Invocable rowProducer was made over a
+ * ResultSetProvider.Writing.
+ */
+static bool isWriting(jobject rowProducer)
+{
+	jobject producer = pljava_Function_srfProducer(rowProducer);
+	bool result = 0 != producer
+		&&  JNI_isInstanceOf(producer, s_ResultSetProvider_Writing_class);
+	JNI_deleteLocalRef(producer);
+	return result;
+}
+
 Datum Type_invokeSRF(Type self, Function fn, PG_FUNCTION_ARGS)
 {
 	jobject row;
 	CallContextData* ctxData;
 	FuncCallContext* context;
 	MemoryContext currCtx;
+	ReturnSetInfo* rsi = (ReturnSetInfo*)fcinfo->resultinfo;
+	int chunkRows = Backend_getSRFMaterializeRows();
+
+	if ( 0 < chunkRows  &&  SRF_IS_FIRSTCALL()
+		&&  NULL != rsi  &&  IsA(rsi, ReturnSetInfo)
+		&&  0 != (rsi->allowedModes & SFRM_Materialize) )
+		return invokeSRFMaterialize(self, fn, fcinfo,
+			pljava_Function_refInvoke(fn), chunkRows);
 
 	/* stuff done only on the first call of the function
 	 */
@@ -525,6 +971,23 @@ Datum Type_invokeSRF(Type self, Function fn, PG_FUNCTION_ARGS)
 			SRF_RETURN_DONE(context);
 		}
 
+		/*
+		 * A ResultSetProvider.Writing writes all its rows in one call, so its
+		 * result is materialized whatever pljava.srf_materialize_rows says,
+		 * if the executor allows; the value-per-call state just made is then
+		 * not needed. If the executor does not allow, the provider's
+		 * assignRowValues will report the problem.
+		 */
+		if ( NULL != rsi  &&  IsA(rsi, ReturnSetInfo)
+			&&  0 != (rsi->allowedModes & SFRM_Materialize)
+			&&  isWriting(tmp) )
+		{
+			MemoryContextSwitchTo(currCtx);
+			end_MultiFuncCall(fcinfo, context);
+			return invokeSRFMaterialize(self, fn, fcinfo, tmp,
+				0 < chunkRows ? chunkRows : SRF_BATCH_MAX_ROWS);
+		}
+
 		ctxData = (CallContextData*)palloc0(sizeof(CallContextData));
 		context->user_fctx = ctxData;
 
@@ -632,6 +1095,9 @@ Type Type_fromJavaType(Oid typeId, const char* javaTypeName)
 		ce = (CacheEntry)HashMap_getByStringOid(
 			s_obtainerByJavaName, javaTypeName, typeId);
 
+	if ( NULL == ce  &&  initializeDeferredTypes() )
+		return Type_fromJavaType(typeId, javaTypeName);
+
 	if(ce == 0)
 	{
 		size_t jtlen = strlen(javaTypeName) - 2;
@@ -657,12 +1123,12 @@ Type Type_fromJavaType(Oid typeId, const char* javaTypeName)
 
 void Type_cacheByOid(Oid typeId, Type type)
 {
-	HashMap_putByOid(s_typeByOid, typeId, type);
+	OidMap_put(s_typeByOid, typeId, type);
 }
 
 Type Type_fromOidCache(Oid typeId)
 {
-	return (Type)HashMap_getByOid(s_typeByOid, typeId);
+	return (Type)OidMap_get(s_typeByOid, typeId);
 }
 
 /*
@@ -741,15 +1207,97 @@ checkTypeMappedUDT(Oid typeId, jobject typeMap, Form_pg_type typeStruct)
 	return type;
 }
 
+/*
+ * What Type_fromOid remembers about a type it resolved by falling back: to the
+ * Type of a domain's base type, or to String for a type with no mapping of its
+ * own. Such a Type, unlike one registered for the Oid or a UDT, is only a
+ * conclusion drawn from the pg_type entry and the type map in use at the time,
+ * so it is dropped from s_typeByOid when the entry changes (typeInvalCallback),
+ * and a String fallback is checked again against any type map that comes with
+ * a later lookup.
+ */
+typedef struct
+{
+	uint32  typeHash;
+	bool    mappable;
+	jobject checkedMap; /* global ref to the type map last found not to map it */
+} FallbackEntry;
+
+static void rememberFallback(Oid typeId, bool mappable, jobject typeMap)
+{
+	FallbackEntry *fe = (FallbackEntry *)OidMap_get(s_fallbackByOid, typeId);
+	if ( NULL == fe )
+	{
+		fe = MemoryContextAllocZero(TopMemoryContext, sizeof *fe);
+#if PG_VERSION_NUM >= 90200
+		fe->typeHash = GetSysCacheHashValue1(TYPEOID, ObjectIdGetDatum(typeId));
+#endif
+		OidMap_put(s_fallbackByOid, typeId, fe);
+	}
+	fe->mappable = mappable;
+	if ( NULL != fe->checkedMap )
+	{
+		JNI_deleteGlobalRef(fe->checkedMap);
+		fe->checkedMap = NULL;
+	}
+	if ( mappable  &&  NULL != typeMap )
+		fe->checkedMap = JNI_newGlobalRef(typeMap);
+}
+
+/*
+ * Invalidation callback for pg_type, forgetting the fallback Types for entries
+ * that have changed (or all of them, when the hash value is zero, or not
+ * supplied in older PostgreSQL versions), so the next Type_fromOid resolves
+ * them afresh. Only s_typeByOid loses entries here, so iterating over
+ * s_fallbackByOid is not disturbed; the Types themselves are not freed, as
+ * Functions and coercions resolved earlier may still refer to them.
+ */
+#if PG_VERSION_NUM >= 90200
+static void typeInvalCallback(Datum arg, int cacheId, uint32 hashValue)
+#else
+static void typeInvalCallback(Datum arg, int cacheId, ItemPointer tuplePtr)
+#endif
+{
+	uint32 cursor = 0;
+	Oid typeId;
+	void *value;
+#if PG_VERSION_NUM < 90200
+	uint32 hashValue = 0;
+#endif
+
+	while ( OidMap_next(s_fallbackByOid, &cursor, &typeId, &value) )
+	{
+		FallbackEntry *fe = (FallbackEntry *)value;
+		if ( 0 == hashValue  ||  fe->typeHash == hashValue )
+			OidMap_remove(s_typeByOid, typeId);
+	}
+}
+
 Type Type_fromOid(Oid typeId, jobject typeMap)
 {
 	CacheEntry   ce;
 	HeapTuple    typeTup;
 	Form_pg_type typeStruct;
-	Type         type = Type_fromOidCache(typeId);
+	FallbackEntry *fe;
+	bool         fallback = false;
+	bool         mappable = false;
+	Type         cached = Type_fromOidCache(typeId);
+	Type         type;
 
-	if ( NULL != type )
-		return type;
+	if ( NULL != cached )
+	{
+		if ( NULL == typeMap )
+			return cached;
+		fe = (FallbackEntry *)OidMap_get(s_fallbackByOid, typeId);
+		if ( NULL == fe  ||  ! fe->mappable
+			||  ( NULL != fe->checkedMap
+				&&  JNI_isSameObject(fe->checkedMap, typeMap) ) )
+			return cached;
+		/*
+		 * A String fallback, found now with a type map not yet checked; if the
+		 * map has nothing for it still, the String made before is kept.
+		 */
+	}
 
 	typeTup    = PgObject_getValidTuple(TYPEOID, typeId, "type");
 	typeStruct = (Form_pg_type)GETSTRUCT(typeTup);
@@ -777,6 +1325,7 @@ Type Type_fromOid(Oid typeId, jobject typeMap)
 		 * also be a domain)
 		 */
 		type = Type_fromOid(typeStruct->typbasetype, typeMap);
+		fallback = true;
 		goto finally;
 	}
 
@@ -797,7 +1346,9 @@ Type Type_fromOid(Oid typeId, jobject typeMap)
 		goto finally;
 	}
 
-	ce = (CacheEntry)HashMap_getByOid(s_obtainerByOid, typeId);
+	ce = (CacheEntry)OidMap_get(s_obtainerByOid, typeId);
+	if ( NULL == ce  &&  initializeDeferredTypes() )
+		ce = (CacheEntry)OidMap_get(s_obtainerByOid, typeId);
 	if ( NULL == ce )
 	{
 		/*
@@ -814,7 +1365,8 @@ Type Type_fromOid(Oid typeId, jobject typeMap)
 		 * Type_fromJavaType to see if a mapping is registered that way. If not,
 		 * *that* function reports 'No java type mapping installed for "%s"'.
 		 */
-		type = String_obtain(typeId);
+		type = NULL != cached ? cached : String_obtain(typeId);
+		fallback = mappable = true;
 	}
 	else
 	{
@@ -826,6 +1378,14 @@ Type Type_fromOid(Oid typeId, jobject typeMap)
 finally:
 	ReleaseSysCache(typeTup);
 	Type_cacheByOid(typeId, type);
+	if ( fallback )
+		rememberFallback(typeId, mappable, typeMap);
+	else if ( NULL != (fe = OidMap_remove(s_fallbackByOid, typeId)) )
+	{
+		if ( NULL != fe->checkedMap )
+			JNI_deleteGlobalRef(fe->checkedMap);
+		pfree(fe);
+	}
 	return type;
 }
 
@@ -970,12 +1530,17 @@ static void initializeTypeBridges()
 		"()I");
 	s_TypeBridge_Holder_payload = PgObject_getJavaMethod(cls, "payload",
 		"()Ljava/lang/Object;");
+	s_TypeBridge_Holder_m_payload = PgObject_getJavaField(cls, "m_payload",
+		"Ljava/lang/Object;");
+	s_TypeBridge_Holder_m_bridgeIndex = PgObject_getJavaField(cls,
+		"m_bridgeIndex", "I");
 }
 
 /*
  * Shortcuts to initializers of known types
  */
 extern void Any_initialize(void);
+extern void AggState_initialize(void);
 extern void Coerce_initialize(void);
 extern void Void_initialize(void);
 extern void Boolean_initialize(void);
@@ -986,6 +1551,7 @@ extern void Long_initialize(void);
 extern void Float_initialize(void);
 extern void Double_initialize(void);
 extern void BigDecimal_initialize(void);
+extern void Array_initialize(void);
 
 extern void Date_initialize(void);
 extern void Time_initialize(void);
@@ -996,18 +1562,69 @@ extern void AclId_initialize(void);
 
 extern void String_initialize(void);
 extern void byte_array_initialize(void);
+extern void PrimitiveBuffer_initialize(void);
 
 extern void TupleTable_initialize(void);
 
 extern void Composite_initialize(void);
 
 extern void pljava_SQLXMLImpl_initialize(void);
+extern void Jsonb_initialize(void);
+
+/*
+ * Initializers of type mappings that register no natives and are not needed
+ * by PL/Java itself as it starts, so their Java classes need not be looked up
+ * until some function first needs a mapping not yet registered. They are then
+ * all run together, as a miss on one oid or Java name cannot tell which of
+ * them would supply it.
+ */
+static void (* const s_deferredInitializers[])(void) =
+{
+	BigDecimal_initialize,
+	Date_initialize,
+	Time_initialize,
+	Timestamp_initialize,
+	byte_array_initialize,
+	PrimitiveBuffer_initialize,
+	AggState_initialize
+};
+
+static bool s_deferredTypesInitialized;
+
+/*
+ * Run the deferred initializers if they have not yet been run, returning true
+ * if they were (and so a failed lookup is worth retrying).
+ */
+static bool initializeDeferredTypes(void)
+{
+	size_t i;
+
+	if ( s_deferredTypesInitialized )
+		return false;
+	s_deferredTypesInitialized = true;
+
+	for ( i = 0 ; i < lengthof(s_deferredInitializers) ; ++ i )
+		s_deferredInitializers[i]();
+	return true;
+}
 
 extern void Type_initialize(void);
 void Type_initialize(void)
 {
-	s_typeByOid          = HashMap_create(59, TopMemoryContext);
-	s_obtainerByOid      = HashMap_create(59, TopMemoryContext);
+	JNINativeMethod columnBatchMethods[] =
+	{
+		{
+		"_putBatch",
+		"(J[Ljava/lang/Object;Ljava/nio/ByteBuffer;I)V",
+		Java_org_postgresql_pljava_jdbc_ColumnBatchWriter__1putBatch
+		},
+		{ 0, 0, 0 }
+	};
+
+	s_typeByOid          = OidMap_create(59, TopMemoryContext);
+	s_fallbackByOid      = OidMap_create(59, TopMemoryContext);
+	CacheRegisterSyscacheCallback(TYPEOID, typeInvalCallback, (Datum)0);
+	s_obtainerByOid      = OidMap_create(59, TopMemoryContext);
 	s_obtainerByJavaName = HashMap_create(59, TopMemoryContext);
 
 	String_initialize();
@@ -1022,22 +1639,16 @@ void Type_initialize(void)
 	Long_initialize();
 	Float_initialize();
 	Double_initialize();
-
-	BigDecimal_initialize();
-
-	Date_initialize();
-	Time_initialize();
-	Timestamp_initialize();
+	Array_initialize();
 
 	Oid_initialize();
 	AclId_initialize();
 
-	byte_array_initialize();
-
 	TupleTable_initialize();
 
 	Composite_initialize();
 	pljava_SQLXMLImpl_initialize();
+	Jsonb_initialize();
 
 	s_Map_class = JNI_newGlobalRef(PgObject_getJavaClass("java/util/Map"));
 	s_Map_get = PgObject_getJavaMethod(
@@ -1050,6 +1661,34 @@ void Type_initialize(void)
 	s_Iterator_next = PgObject_getJavaMethod(
 		s_Iterator_class, "next", "()Ljava/lang/Object;");
 
+	s_ResultSetProvider_Batched_class = JNI_newGlobalRef(PgObject_getJavaClass(
+		"org/postgresql/pljava/ResultSetProvider$Batched"));
+	s_ResultSetProvider_Writing_class = JNI_newGlobalRef(PgObject_getJavaClass(
+		"org/postgresql/pljava/ResultSetProvider$Writing"));
+	s_ColumnBatchWriter_class = JNI_newGlobalRef(PgObject_getJavaClass(
+		"org/postgresql/pljava/jdbc/ColumnBatchWriter"));
+	PgObject_registerNatives2(s_ColumnBatchWriter_class, columnBatchMethods);
+	s_ColumnBatchWriter_init = PgObject_getJavaMethod(
+		s_ColumnBatchWriter_class, "<init>",
+		"(Lorg/postgresql/pljava/jdbc/SingleRowWriter;I)V");
+	s_ColumnBatchWriter_values = PgObject_getJavaMethod(
+		s_ColumnBatchWriter_class, "values", "()[Ljava/lang/Object;");
+	s_ColumnBatchWriter_primitives = PgObject_getJavaMethod(
+		s_ColumnBatchWriter_class, "primitives", "()Ljava/nio/ByteBuffer;");
+
+	s_PrimitiveIterator_OfLong_class = JNI_newGlobalRef(PgObject_getJavaClass(
+		"java/util/PrimitiveIterator$OfLong"));
+	s_PrimitiveIterator_OfInt_class = JNI_newGlobalRef(PgObject_getJavaClass(
+		"java/util/PrimitiveIterator$OfInt"));
+	s_PrimitiveIterator_OfDouble_class = JNI_newGlobalRef(
+		PgObject_getJavaClass("java/util/PrimitiveIterator$OfDouble"));
+	s_PrimitiveBatchReader_class = JNI_newGlobalRef(PgObject_getJavaClass(
+		"org/postgresql/pljava/jdbc/PrimitiveBatchReader"));
+	s_PrimitiveBatchReader_init = PgObject_getJavaMethod(
+		s_PrimitiveBatchReader_class, "<init>", "(I)V");
+	s_PrimitiveBatchReader_values = PgObject_getJavaMethod(
+		s_PrimitiveBatchReader_class, "values", "()Ljava/nio/ByteBuffer;");
+
 #if PG_VERSION_NUM < 110000
 	BOOLARRAYOID   = get_array_type(BOOLOID);
 	CHARARRAYOID   = get_array_type(CHAROID);
@@ -1165,8 +1804,8 @@ static void _registerType(
 		HashMap_putByStringOid(s_obtainerByJavaName, javaTypeName, keyOid, ce);
 	}
 
-	if(typeId != InvalidOid && HashMap_getByOid(s_obtainerByOid, typeId) == 0)
-		HashMap_putByOid(s_obtainerByOid, typeId, ce);
+	if(typeId != InvalidOid && OidMap_get(s_obtainerByOid, typeId) == 0)
+		OidMap_put(s_obtainerByOid, typeId, ce);
 }
 
 void Type_registerType(const char* javaTypeName, Type type)
@@ -13,6 +13,7 @@
  * @author Thomas Hallgren
  */
 #include <postgres.h>
+#include <access/tupmacs.h>
 #include <catalog/pg_namespace.h>
 #include <utils/builtins.h>
 #include <utils/typcache.h>
@@ -33,6 +34,12 @@
 #include <utils/bytea.h>
 #endif
 
+#if PG_VERSION_NUM >= 130000
+#include <common/hashfn.h>
+#else
+#include <access/hash.h>
+#endif
+
 /*
  * This code, as currently constituted, makes these assumptions that limit how
  * Java can implement a (scalar) UDT:
@@ -63,8 +70,82 @@
  * Idea for future: add another scalar UDT pattern using different methods, and
  * without the current readSQL/writeSQL limitations. Continue to recognize the
  * parse/toString pattern and provide the old behavior for compatibility.
+ *
+ * A start on that: a class implementing BinarySQLData has its internal
+ * representation (unless of length -2) read from and written to a ByteBuffer
+ * over a Java byte array, copied from or to the datum in one region copy, with
+ * no SQLInput or SQLOutput object made per value and no limit on lengths but
+ * the varlena's own. The buffer is not a view of the datum itself, as user code
+ * could keep it past the life of the datum's memory.
  */
 
+static jclass s_BinarySQLData_class;
+static jclass s_ImmutableUDT_class;
+static jmethodID s_Class_isAnnotationPresent;
+
+static jobject coerceBinaryDatum(UDT self, char *data, int32 dataLen)
+{
+	jobject result;
+	jbyteArray ba = JNI_newByteArray(dataLen);
+	JNI_setByteArrayRegion(ba, 0, dataLen, (jbyte*)data);
+	result = pljava_Function_udtReadBinaryInvoke(
+		self->readSQL, ba, self->sqlTypeName);
+	JNI_deleteLocalRef(ba);
+	return result;
+}
+
+/*
+ * Allocate, in the upper context, the image of a BinarySQLData value and have
+ * its writeBinary method fill it; for a varlena, the header is set. Returns the
+ * image, and its data length in *lenp.
+ */
+static char *coerceBinaryObject(UDT self, jobject value, int32 *lenp)
+{
+	int32 dataLen = Type_getLength((Type)self);
+	int32 hdrLen = dataLen < 0 ? VARHDRSZ : 0;
+	jint len = pljava_Function_udtBinaryLengthInvoke(self->writeSQL, value);
+	jint written;
+	jbyteArray ba;
+	char *image;
+	MemoryContext currCtx;
+
+	if ( len < 0  ||  (Size)len > MaxAllocSize - VARHDRSZ
+		||  (dataLen >= 0  &&  len != dataLen) )
+		ereport(ERROR, (
+			errcode(ERRCODE_CANNOT_COERCE),
+			errmsg(
+				"UDT for Oid %d reported image with incorrect size. "
+				"Expected %d, was %d",
+				Type_getOid((Type)self), dataLen, len)
+			));
+
+	currCtx = Invocation_switchToUpperContext();
+	image = palloc(hdrLen + len);
+	MemoryContextSwitchTo(currCtx);
+
+	ba = JNI_newByteArray(len);
+	written = pljava_Function_udtWriteBinaryInvoke(self->writeSQL, value, ba);
+
+	if ( written != len )
+	{
+		JNI_deleteLocalRef(ba);
+		ereport(ERROR, (
+			errcode(ERRCODE_CANNOT_COERCE),
+			errmsg(
+				"UDT for Oid %d wrote %d bytes of an image of %d",
+				Type_getOid((Type)self), written, len)
+			));
+	}
+
+	JNI_getByteArrayRegion(ba, 0, len, (jbyte*)(image + hdrLen));
+	JNI_deleteLocalRef(ba);
+
+	if ( dataLen < 0 )
+		SET_VARSIZE(image, hdrLen + len);
+	*lenp = len;
+	return image;
+}
+
 static jobject coerceScalarDatum(UDT self, Datum arg)
 {
 	jobject result;
@@ -119,11 +200,23 @@ static jobject coerceScalarDatum(UDT self, Datum arg)
 			}
 		}
 
-		inputStream = SQLInputFromChunk_create(data, dataLen,
+		if ( self->binaryCodec )
+			return coerceBinaryDatum(self, data, dataLen);
+
+		inputStream = SQLInputFromChunk_acquire(&self->reader, data, dataLen,
 			isJavaBasedScalar);
-		result = pljava_Function_udtReadInvoke(
-			self->readSQL, inputStream, self->sqlTypeName);
-		SQLInputFromChunk_close(inputStream);
+		PG_TRY();
+		{
+			result = pljava_Function_udtReadInvoke(
+				self->readSQL, inputStream, self->sqlTypeName);
+		}
+		PG_CATCH();
+		{
+			SQLInputFromChunk_abandon(&self->reader, inputStream);
+			PG_RE_THROW();
+		}
+		PG_END_TRY();
+		SQLInputFromChunk_release(&self->reader, inputStream);
 	}
 	return result;
 }
@@ -156,47 +249,78 @@ static Datum coerceScalarObject(UDT self, jobject value)
 		result = CStringGetDatum(tmp);
 		JNI_deleteLocalRef(jstr);
 	}
+	else if ( self->binaryCodec )
+	{
+		int32 len;
+		char *image = coerceBinaryObject(self, value, &len);
+		if ( Type_isByValue((Type)self) )
+		{
+			memset(&result, 0, SIZEOF_DATUM);
+#ifdef WORDS_BIGENDIAN
+			memcpy(((char *)&result) + SIZEOF_DATUM - len, image, len);
+#else
+			memcpy(&result, image, len);
+#endif
+			pfree(image);
+		}
+		else
+			result = PointerGetDatum(image);
+	}
 	else
 	{
 		jobject outputStream;
-		StringInfoData buffer;
+		StringInfo buffer;
 		bool passByValue = Type_isByValue((Type)self);
 
-		MemoryContext currCtx = Invocation_switchToUpperContext();
-		initStringInfo(&buffer);
-		MemoryContextSwitchTo(currCtx); /* buffer remembers its context */
+		/*
+		 * The pooled buffer, if free, is reused for each value written, and
+		 * the bytes are copied out of it below; otherwise a new one in the
+		 * upper context is built in place.
+		 */
+		buffer = SQLOutputToChunk_buffer(&self->writer);
 
-		if(dataLen < 0)
-			/*
-			 * Reserve space for an int32 at the beginning. We are building
-			 * a varlena
-			 */
-			appendBinaryStringInfo(&buffer, (char*)&dataLen, sizeof(int32));
-		else
-			enlargeStringInfo(&buffer, dataLen);
+		PG_TRY();
+		{
+			if(dataLen < 0)
+				/*
+				 * Reserve space for an int32 at the beginning. We are building
+				 * a varlena
+				 */
+				appendBinaryStringInfo(buffer, (char*)&dataLen, sizeof(int32));
+			else
+				enlargeStringInfo(buffer, dataLen);
 
-		outputStream = SQLOutputToChunk_create(&buffer, isJavaBasedScalar);
-		pljava_Function_udtWriteInvoke(self->writeSQL, value, outputStream);
-		SQLOutputToChunk_close(outputStream);
+			outputStream = SQLOutputToChunk_acquire(&self->writer, buffer,
+				isJavaBasedScalar);
+			pljava_Function_udtWriteInvoke(self->writeSQL, value, outputStream);
+			SQLOutputToChunk_close(outputStream);
+		}
+		PG_CATCH();
+		{
+			SQLOutputToChunk_abandon(&self->writer, buffer);
+			PG_RE_THROW();
+		}
+		PG_END_TRY();
 
 		if(dataLen < 0)
 		{
 			/* Assign the correct length.
 			 */
 #if PG_VERSION_NUM < 80300
-			VARATT_SIZEP(buffer.data) = buffer.len;
+			VARATT_SIZEP(buffer->data) = buffer->len;
 #else
-			SET_VARSIZE(buffer.data, buffer.len);
+			SET_VARSIZE(buffer->data, buffer->len);
 #endif
 		}
-		else if(dataLen != buffer.len)
+		else if(dataLen != buffer->len)
 		{
+			SQLOutputToChunk_abandon(&self->writer, buffer);
 			ereport(ERROR, (
 				errcode(ERRCODE_CANNOT_COERCE),
 				errmsg(
 					"UDT for Oid %d produced image with incorrect size. "
 					"Expected %d, was %d",
-					Type_getOid((Type)self), dataLen, buffer.len)
+					Type_getOid((Type)self), dataLen, buffer->len)
 				));
 		}
 		if (passByValue) {
@@ -204,14 +328,19 @@ static Datum coerceScalarObject(UDT self, jobject value)
 			/* pass by value data is stored in the least
 			 * significant bits of a Datum. */
 #ifdef WORDS_BIGENDIAN
-			memcpy(&result + SIZEOF_DATUM - dataLen, buffer.data, dataLen);
+			memcpy(((char *)&result) + SIZEOF_DATUM - dataLen,
+				buffer->data, dataLen);
 #else
-			memcpy(&result, buffer.data, dataLen);
+			memcpy(&result, buffer->data, dataLen);
 #endif
+		} else if ( buffer == &self->writer.buffer ) {
+			result = PointerGetDatum(MemoryContextAlloc(
+				currentInvocation->upperContext, buffer->len));
+			memcpy(DatumGetPointer(result), buffer->data, buffer->len);
 		} else {
-			result = PointerGetDatum(buffer.data);
+			result = PointerGetDatum(buffer->data);
 		}
-
+		SQLOutputToChunk_release(&self->writer, outputStream, buffer);
 	}
 	return result;
 }
@@ -256,6 +385,144 @@ Datum _UDT_coerceObject(Type self, jobject value)
 	return result;
 }
 
+bool UDT_isDecodeCached(Type t)
+{
+	return t->typeClass->coerceDatum == _UDT_coerceDatum
+		&&  ((UDT)t)->decodeOnce;
+}
+
+#if PG_VERSION_NUM >= 90500
+/*
+ * The decode cache for ImmutableUDT types: a few slots, chosen by a hash of the
+ * value's bytes, each holding a copy of the bytes and a global reference to the
+ * instance made from them. A value longer than DECODE_CACHE_MAXLEN is decoded
+ * every time, rather than copied into the cache.
+ */
+#define DECODE_CACHE_SLOTS 8
+#define DECODE_CACHE_MAXLEN 1024
+
+typedef struct
+{
+	Oid     typeId;
+	int32   len;
+	uint32  hash;
+	char   *image;
+	jobject value;
+} DecodeEntry;
+
+struct UDTDecodeCache_
+{
+	MemoryContextCallback cb;
+	DecodeEntry slot [ DECODE_CACHE_SLOTS ];
+};
+
+static void releaseDecodeCache(void *arg)
+{
+	UDTDecodeCache cache = (UDTDecodeCache)arg;
+	int i;
+	for ( i = 0 ; i < DECODE_CACHE_SLOTS ; ++ i )
+		if ( NULL != cache->slot[i].value )
+			JNI_deleteGlobalRef(cache->slot[i].value);
+}
+
+jvalue UDT_coerceDatumCached(
+	Type self, Datum arg, UDTDecodeCache *cachep, MemoryContext cxt)
+{
+	int32 dataLen = Type_getLength(self);
+	UDTDecodeCache cache = *cachep;
+	DecodeEntry *e;
+	char *image;
+	int32 len;
+	uint32 hash;
+	jvalue result;
+
+	/*
+	 * The bytes compared are the whole stored form: the string for length -2,
+	 * the (detoasted) varlena with its header for -1, or the Datum itself for
+	 * a type passed by value. A varlena detoasted here is what gets decoded, if
+	 * it must be, so it is not detoasted twice.
+	 */
+	if ( -2 == dataLen )
+	{
+		image = DatumGetCString(arg);
+		len = (int32)strlen(image);
+	}
+	else if ( -1 == dataLen )
+	{
+		bytea *bytes = DatumGetByteaP(arg);
+		arg = PointerGetDatum(bytes);
+		image = (char *)bytes;
+		len = VARSIZE(bytes);
+	}
+	else if ( Type_isByValue(self) )
+	{
+		image = (char *)&arg;
+		len = SIZEOF_DATUM;
+	}
+	else
+	{
+		image = DatumGetPointer(arg);
+		len = dataLen;
+	}
+
+	if ( len > DECODE_CACHE_MAXLEN )
+		return _UDT_coerceDatum(self, arg);
+
+	hash = DatumGetUInt32(hash_any((unsigned char *)image, len));
+
+	if ( NULL != cache )
+	{
+		e = cache->slot + ((hash ^ Type_getOid(self)) % DECODE_CACHE_SLOTS);
+		if ( NULL != e->value  &&  e->hash == hash  &&  e->len == len
+			&&  e->typeId == Type_getOid(self)
+			&&  0 == memcmp(e->image, image, len) )
+		{
+			result.l = e->value;
+			return result;
+		}
+	}
+
+	result = _UDT_coerceDatum(self, arg);
+	if ( NULL == result.l )
+		return result;
+
+	if ( NULL == cache )
+	{
+		cache = (UDTDecodeCache)MemoryContextAllocZero(cxt, sizeof *cache);
+		cache->cb.func = releaseDecodeCache;
+		cache->cb.arg = cache;
+		MemoryContextRegisterResetCallback(cxt, &cache->cb);
+		*cachep = cache;
+	}
+
+	e = cache->slot + ((hash ^ Type_getOid(self)) % DECODE_CACHE_SLOTS);
+	if ( NULL != e->value )
+	{
+		JNI_deleteGlobalRef(e->value);
+		pfree(e->image);
+	}
+	e->typeId = Type_getOid(self);
+	e->len = len;
+	e->hash = hash;
+	e->image = MemoryContextAlloc(cxt, len);
+	memcpy(e->image, image, len);
+	e->value = JNI_newGlobalRef(result.l);
+	JNI_deleteLocalRef(result.l);
+	result.l = e->value;
+	return result;
+}
+#else
+/*
+ * Before PostgreSQL 9.5 there are no memory context reset callbacks to release
+ * the cached references, so decodeOnce is never set and this is not reached.
+ */
+jvalue UDT_coerceDatumCached(
+	Type self, Datum arg, UDTDecodeCache *cachep, MemoryContext cxt)
+{
+	return _UDT_coerceDatum(self, arg);
+}
+#endif
+
 /*
  * Fail openly rather than mysteriously if an INPUT or RECEIVE function is
  * called with a non-default typmod. It seems possible that, aside from COPY
@@ -424,6 +691,96 @@ Datum UDT_send(UDT udt, PG_FUNCTION_ARGS)
     PG_RETURN_BYTEA_P(pq_endtypsend(&buf));
 }
 
+/*
+ * Find the bytes of the internal representation of a scalar UDT value, and
+ * their length. A value passed by value is first stored into buf, which must
+ * have room for a Datum. A varlena is detoasted if need be; *copyp is set to
+ * the copy to be freed, or to NULL.
+ */
+static const char *binaryImage(
+	UDT udt, Datum d, char *buf, Size *lenp, Pointer *copyp)
+{
+	int16 dataLen = Type_getLength((Type)udt);
+	struct varlena *v;
+
+	*copyp = NULL;
+
+	if ( -1 == dataLen )
+	{
+		v = PG_DETOAST_DATUM_PACKED(d);
+		if ( (Pointer)v != DatumGetPointer(d) )
+			*copyp = (Pointer)v;
+		*lenp = VARSIZE_ANY_EXHDR(v);
+		return VARDATA_ANY(v);
+	}
+
+	if ( -2 == dataLen )
+	{
+		*lenp = strlen(DatumGetCString(d));
+		return DatumGetCString(d);
+	}
+
+	*lenp = dataLen;
+	if ( Type_isByValue((Type)udt) )
+	{
+		store_att_byval(buf, d, dataLen);
+		return buf;
+	}
+	return DatumGetPointer(d);
+}
+
+static void requireScalar(UDT udt)
+{
+	if(!UDT_isScalar(udt))
+		ereport(ERROR, (
+			errcode(ERRCODE_CANNOT_COERCE),
+			errmsg("UDT with Oid %d is not scalar", Type_getOid((Type)udt))));
+}
+
+Datum UDT_binaryEquals(UDT udt, PG_FUNCTION_ARGS)
+{
+	char buf1[sizeof (Datum)];
+	char buf2[sizeof (Datum)];
+	Size len1;
+	Size len2;
+	Pointer copy1;
+	Pointer copy2;
+	const char *img1;
+	const char *img2;
+	bool result;
+
+	requireScalar(udt);
+
+	img1 = binaryImage(udt, PG_GETARG_DATUM(0), buf1, &len1, &copy1);
+	img2 = binaryImage(udt, PG_GETARG_DATUM(1), buf2, &len2, &copy2);
+
+	result = len1 == len2  &&  0 == memcmp(img1, img2, len1);
+
+	if ( NULL != copy1 )
+		pfree(copy1);
+	if ( NULL != copy2 )
+		pfree(copy2);
+	PG_RETURN_BOOL(result);
+}
+
+Datum UDT_binaryHash(UDT udt, PG_FUNCTION_ARGS)
+{
+	char buf[sizeof (Datum)];
+	Size len;
+	Pointer copy;
+	const char *img;
+	Datum result;
+
+	requireScalar(udt);
+
+	img = binaryImage(udt, PG_GETARG_DATUM(0), buf, &len, &copy);
+	result = hash_any((const unsigned char *)img, (int)len);
+
+	if ( NULL != copy )
+		pfree(copy);
+	PG_RETURN_DATUM(result);
+}
+
 bool UDT_isScalar(UDT udt)
 {
 	return ! udt->hasTupleDesc;
@@ -557,6 +914,26 @@ UDT UDT_registerUDT(jclass clazz, Oid typeId, Form_pg_type pgType,
 	}
 
 	udt->hasTupleDesc = hasTupleDesc;
+
+	if ( NULL == s_BinarySQLData_class )
+		s_BinarySQLData_class = JNI_newGlobalRef(
+			PgObject_getJavaClass("org/postgresql/pljava/BinarySQLData"));
+	udt->binaryCodec = ! hasTupleDesc
+		&&  JNI_isAssignableFrom(clazz, s_BinarySQLData_class);
+
+	if ( NULL == s_ImmutableUDT_class )
+	{
+		s_ImmutableUDT_class = JNI_newGlobalRef(PgObject_getJavaClass(
+			"org/postgresql/pljava/annotation/ImmutableUDT"));
+		s_Class_isAnnotationPresent = PgObject_getJavaMethod(Class_class,
+			"isAnnotationPresent", "(Ljava/lang/Class;)Z");
+	}
+#if PG_VERSION_NUM >= 90500
+	udt->decodeOnce = JNI_TRUE == JNI_callBooleanMethod(
+		clazz, s_Class_isAnnotationPresent, s_ImmutableUDT_class);
+#else
+	udt->decodeOnce = false;
+#endif
 	if ( NULL == readMH  ||  NULL == writeMH )
 		elog(ERROR,
 			"PL/Java UDT with oid %u registered without both r/w handles",
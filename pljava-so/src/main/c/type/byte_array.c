@@ -7,12 +7,23 @@
  * @author Thomas Hallgren
  */
 #include "pljava/Exception.h"
+#include "pljava/VarlenaWrapper.h"
 #include "pljava/type/Type_priv.h"
 
 static jclass s_byteArray_class;
 static jclass s_BlobValue_class;
 static jmethodID s_BlobValue_length;
 static jmethodID s_BlobValue_getContents;
+static jclass s_VarlenaBlob_class;
+static jmethodID s_VarlenaBlob_init;
+static jclass s_ByteBuffer_class;
+static jmethodID s_ByteBuffer_asReadOnlyBuffer;
+static jmethodID s_ByteBuffer_duplicate;
+static jmethodID s_ByteBuffer_remaining;
+static jmethodID s_ByteBuffer_put;
+static jmethodID s_ByteBuffer_position;
+static jmethodID s_ByteBuffer_isDirect;
+static jmethodID s_ByteBuffer_wrap;
 
 /*
  * byte[] type. Copies data to/from a bytea struct.
@@ -74,6 +85,98 @@ static Datum _byte_array_coerceObject(Type self, jobject byteArray)
 	PG_RETURN_BYTEA_P(bytes);
 }
 
+/*
+ * java.sql.Blob type. A bytea is not copied into Java, but wrapped in
+ * a VarlenaBlob over a VarlenaWrapper.Input, which can read ranges of it
+ * without detoasting the rest. A Blob going the other way must be a BlobValue,
+ * and is copied as for byte[].
+ */
+static bool _Blob_canReplaceType(Type self, Type other)
+{
+	return Type_getClass(self) == Type_getClass(other)
+		||  BYTEAOID == Type_getOid(other);
+}
+
+static jvalue _Blob_coerceDatum(Type self, Datum arg)
+{
+	jvalue result;
+	jobject vwi = pljava_VarlenaWrapper_Input(
+		arg, TopTransactionContext, TopTransactionResourceOwner);
+	result.l = JNI_newObject(s_VarlenaBlob_class, s_VarlenaBlob_init, vwi);
+	JNI_deleteLocalRef(vwi);
+	return result;
+}
+
+/*
+ * java.nio.ByteBuffer type. A bytea arrives as a read-only buffer over a copy
+ * of its bytes in the Java heap, made in one region copy; a value stored inline
+ * (even with a short header) is copied from where it lies, and only one
+ * compressed or stored out of line is first detoasted. It is not a view of the
+ * value itself, as user code may keep the buffer well past the life of the
+ * tuple or argument memory holding it. A buffer going the other way has its
+ * remaining bytes copied straight into the new bytea: with memcpy if it is a
+ * direct buffer, else in one bulk put. That suits, for example, the serialize
+ * and deserialize functions of an aggregate with a Java state, or a function
+ * hashing or compressing large values.
+ */
+static bool _ByteBuffer_canReplaceType(Type self, Type other)
+{
+	return Type_getClass(self) == Type_getClass(other)
+		||  BYTEAOID == Type_getOid(other);
+}
+
+static jvalue _ByteBuffer_coerceDatum(Type self, Datum arg)
+{
+	jvalue result;
+	struct varlena* bytes = PG_DETOAST_DATUM_PACKED(arg);
+	jsize length = VARSIZE_ANY_EXHDR(bytes);
+	jbyteArray ba = JNI_newByteArray(length);
+	jobject bb;
+	JNI_setByteArrayRegion(ba, 0, length, (jbyte*)VARDATA_ANY(bytes));
+	bb = JNI_callStaticObjectMethod(s_ByteBuffer_class, s_ByteBuffer_wrap, ba);
+	result.l = JNI_callObjectMethod(bb, s_ByteBuffer_asReadOnlyBuffer);
+	JNI_deleteLocalRef(bb);
+	JNI_deleteLocalRef(ba);
+	return result;
+}
+
+static Datum _ByteBuffer_coerceObject(Type self, jobject buffer)
+{
+	bytea* bytes;
+	jint length;
+	jobject dst;
+	jobject src;
+	jobject ret;
+
+	if(buffer == 0)
+		return 0;
+
+	length = JNI_callIntMethod(buffer, s_ByteBuffer_remaining);
+	bytes = (bytea*)palloc(length + VARHDRSZ);
+	SET_VARSIZE(bytes, length + VARHDRSZ);
+
+	if ( JNI_TRUE == JNI_callBooleanMethod(buffer, s_ByteBuffer_isDirect) )
+	{
+		char* addr = JNI_getDirectBufferAddress(buffer);
+		if ( NULL != addr )
+		{
+			jint pos = JNI_callIntMethod(buffer, s_ByteBuffer_position);
+			memcpy(VARDATA(bytes), addr + pos, length);
+			PG_RETURN_BYTEA_P(bytes);
+		}
+	}
+
+	dst = JNI_newDirectByteBuffer(VARDATA(bytes), (jlong)length);
+	/* a duplicate, so the caller's buffer position is left undisturbed */
+	src = JNI_callObjectMethod(buffer, s_ByteBuffer_duplicate);
+	ret = JNI_callObjectMethod(dst, s_ByteBuffer_put, src);
+	JNI_deleteLocalRef(ret);
+	JNI_deleteLocalRef(src);
+	JNI_deleteLocalRef(dst);
+
+	PG_RETURN_BYTEA_P(bytes);
+}
+
 /* Make this datatype available to the postgres system.
  */
 extern void byte_array_initialize(void);
@@ -90,5 +193,44 @@ void byte_array_initialize(void)
 	s_BlobValue_class = JNI_newGlobalRef(PgObject_getJavaClass("org/postgresql/pljava/jdbc/BlobValue"));
 	s_BlobValue_length = PgObject_getJavaMethod(s_BlobValue_class, "length", "()J");
 	s_BlobValue_getContents = PgObject_getJavaMethod(s_BlobValue_class, "getContents", "(Ljava/nio/ByteBuffer;)V");
+
+	s_VarlenaBlob_class = JNI_newGlobalRef(PgObject_getJavaClass(
+		"org/postgresql/pljava/jdbc/VarlenaBlob"));
+	s_VarlenaBlob_init = PgObject_getJavaMethod(s_VarlenaBlob_class, "<init>",
+		"(Lorg/postgresql/pljava/internal/VarlenaWrapper$Input;)V");
+
+	cls = TypeClass_alloc("type.Blob");
+	cls->JNISignature = "Ljava/sql/Blob;";
+	cls->javaTypeName = "java.sql.Blob";
+	cls->canReplaceType = _Blob_canReplaceType;
+	cls->coerceDatum  = _Blob_coerceDatum;
+	cls->coerceObject = _byte_array_coerceObject;
+	Type_registerType("java.sql.Blob", TypeClass_allocInstance(cls, BYTEAOID));
+
+	s_ByteBuffer_class = JNI_newGlobalRef(
+		PgObject_getJavaClass("java/nio/ByteBuffer"));
+	s_ByteBuffer_asReadOnlyBuffer = PgObject_getJavaMethod(s_ByteBuffer_class,
+		"asReadOnlyBuffer", "()Ljava/nio/ByteBuffer;");
+	s_ByteBuffer_duplicate = PgObject_getJavaMethod(s_ByteBuffer_class,
+		"duplicate", "()Ljava/nio/ByteBuffer;");
+	s_ByteBuffer_remaining = PgObject_getJavaMethod(s_ByteBuffer_class,
+		"remaining", "()I");
+	s_ByteBuffer_put = PgObject_getJavaMethod(s_ByteBuffer_class,
+		"put", "(Ljava/nio/ByteBuffer;)Ljava/nio/ByteBuffer;");
+	s_ByteBuffer_position = PgObject_getJavaMethod(s_ByteBuffer_class,
+		"position", "()I");
+	s_ByteBuffer_isDirect = PgObject_getJavaMethod(s_ByteBuffer_class,
+		"isDirect", "()Z");
+	s_ByteBuffer_wrap = PgObject_getStaticJavaMethod(s_ByteBuffer_class,
+		"wrap", "([B)Ljava/nio/ByteBuffer;");
+
+	cls = TypeClass_alloc("type.ByteBuffer");
+	cls->JNISignature = "Ljava/nio/ByteBuffer;";
+	cls->javaTypeName = "java.nio.ByteBuffer";
+	cls->canReplaceType = _ByteBuffer_canReplaceType;
+	cls->coerceDatum  = _ByteBuffer_coerceDatum;
+	cls->coerceObject = _ByteBuffer_coerceObject;
+	Type_registerType(
+		"java.nio.ByteBuffer", TypeClass_allocInstance(cls, BYTEAOID));
 }
 
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2004-2021 Tada AB and other contributors, as listed below.
+ * Copyright (c) 2004-2026 Tada AB and other contributors, as listed below.
  *
  * All rights reserved. This program and the accompanying materials
  * are made available under the terms of the The BSD 3-Clause License
@@ -38,6 +38,94 @@ extern bool integerDateTimes;
 
 int Backend_setJavaLogLevel(int logLevel);
 
+/*
+ * Advanced wherever PostgreSQL settings may have changed since Java last read
+ * them: as a PL/Java function is entered or returns, after SQL is run or
+ * cursor rows fetched through SPI from Java, and after a rollback to a
+ * savepoint. Java reads it through a direct buffer, and keeps the values it
+ * has from Backend.getConfigOption only while it is unchanged, which is at most
+ * for the length of one PL/Java call: PostgreSQL has no notice of a setting
+ * changed between calls (by set_config in the same query, say), so it must be
+ * advanced on every entry and return.
+ */
+extern int64 pljavaConfigGeneration;
+#define Backend_configMayHaveChanged() (++ pljavaConfigGeneration)
+
+/*
+ * The pljava.srf_materialize_rows setting: zero if set-returning functions
+ * use the value-per-call protocol, else the number of rows between resets of
+ * the row memory context when materializing.
+ */
+int Backend_getSRFMaterializeRows(void);
+
+/*
+ * The pljava.dualstate_cleanup_memory setting, in bytes: growth of
+ * JavaMemoryContext since the last cleanup that prompts cleaning of enqueued
+ * DualState instances, or zero if only the usual points clean them.
+ */
+Size Backend_getDualStateCleanupMemory(void);
+
+/*
+ * The pljava.varlena_eager_size setting, in bytes: a varlena passed to Java
+ * that is smaller when detoasted is detoasted at once.
+ */
+Size Backend_getVarlenaEagerSize(void);
+
+/*
+ * The pljava.varlena_park_ratio setting: the largest percentage of its
+ * detoasted size that a varlena passed to Java can occupy as stored and still
+ * be parked, undetoasted, until Java reads it.
+ */
+int Backend_getVarlenaParkRatio(void);
+
+/*
+ * The pljava.log_cancel_stack setting: whether the Java stack is logged when
+ * a query cancel is noticed by a call from Java.
+ */
+bool Backend_isLogCancelStack(void);
+
+/*
+ * The pljava.track_functions setting: whether calls of PL/Java functions are
+ * counted and timed.
+ */
+bool Backend_isTrackFunctions(void);
+
+/*
+ * The pljava.spi_borrowed_tuples setting.
+ */
+bool Backend_isSPIBorrowedTuples(void);
+
+/*
+ * The pljava.spi_columnar_fetch setting.
+ */
+bool Backend_isSPIColumnarFetch(void);
+
+/*
+ * Whether pljava.stackless_sqlstates lists the given error code: a PostgreSQL
+ * error with that code is made into a Java exception without a stack trace.
+ */
+bool Backend_isStacklessSQLState(int sqlerrcode);
+
+/*
+ * The pljava.job_workers setting: the most background workers running PL/Java
+ * jobs for one role in one database.
+ */
+int Backend_getJobWorkers(void);
+
+/*
+ * The pljava.job_idle_timeout setting, in seconds: how long a background
+ * worker running PL/Java jobs waits for another before exiting.
+ */
+int Backend_getJobIdleTimeout(void);
+
+/*
+ * In a background worker that has connected to its database, and in
+ * a transaction, complete PL/Java's initialization now (starting the JVM and
+ * acting on pljava.preload_functions), rather than at the first call of
+ * a PL/Java function, as would otherwise happen in a background worker.
+ */
+void Backend_initializeInWorker(void);
+
 /*
  * Called at the ends of committing transactions to emit a warning about future
  * JEP 411 impacts, at most once per session, if any PL/Java functions were
@@ -49,6 +137,12 @@ int Backend_setJavaLogLevel(int logLevel);
  */
 void Backend_warnJEP411(bool isCommit);
 
+/*
+ * Called at the ends of top-level transactions to report, if
+ * pljava.track_jni is on, the JNI crossings counted in the transaction.
+ */
+void Backend_reportJNICounters(void);
+
 #ifdef PG_GETCONFIGOPTION
 #error The macro PG_GETCONFIGOPTION needs to be renamed.
 #endif
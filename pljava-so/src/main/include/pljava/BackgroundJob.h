@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+#ifndef __pljava_BackgroundJob_h
+#define __pljava_BackgroundJob_h
+
+#include <postgres.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Background workers that run the jobs queued in sqlj.background_job.
+ *
+ * A worker is started for one role in the current database, connects as that
+ * role, starts the JVM at once, and then claims and runs that role's queued
+ * jobs, one at a time, until none has been queued for pljava.job_idle_timeout.
+ * Each job calls the function recorded for it with its text argument, and
+ * records the result, or the error message, in the job's row.
+ *
+ * pljava_BackgroundJob_launch registers a dynamic background worker for the
+ * role, loading PL/Java from libraryPath, and returns false if no background
+ * worker slot was free. pljava_BackgroundJob_main is the worker's entry point.
+ */
+extern bool pljava_BackgroundJob_launch(char const *libraryPath, Oid roleId);
+
+extern PGDLLEXPORT void pljava_BackgroundJob_main(Datum arg);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
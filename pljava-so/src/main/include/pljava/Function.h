@@ -42,6 +42,32 @@ extern "C" {
  */
 extern void Function_clearFunctionCache(void);
 
+/*
+ * Clear only the cached functions that use the given schema class loader.
+ * This is called when the class path of the schema or schemas using that
+ * loader may have changed.
+ */
+extern void Function_clearFunctionCacheForLoader(jobject loader);
+
+/*
+ * Create and cache the Function for a function Oid ahead of its first call,
+ * as if it were being called through the (trusted or untrusted) handler.
+ * Returns false, doing nothing, if the Function was already cached.
+ * Must be called within a pushed Invocation.
+ */
+extern bool Function_preload(Oid funcOid, bool trusted);
+
+#if PG_VERSION_NUM >= 120000
+/*
+ * Answer a planner support request (SupportRequestRows, SupportRequestCost,
+ * or SupportRequestSimplify) about a call of a function declared with the
+ * [support=class] transformation, by asking its PlannerSupport instance.
+ * Returns what a support function returns: the updated request, a replacement
+ * expression, or NULL to decline. Must be called within a pushed Invocation.
+ */
+extern Node *Function_planSupport(Oid funcOid, bool trusted, Node *req);
+#endif
+
 /*
  * Determine whether the type represented by typeId is declared as a
  * "Java-based scalar" a/k/a BaseUDT and, if so, return a freshly-registered
@@ -76,6 +102,23 @@ extern Datum Function_invoke(
  */
 extern void pljava_Function_setParameter(Function self, int idx, jvalue val);
 
+/*
+ * Return the address of a pointer, initially NULL, that the invoke method of
+ * the return type may use to keep state across the calls at one call site of
+ * a function, such as a result writer that can be reused from row to row.
+ * Whatever it points to must be allocated in fcinfo->flinfo->fn_mcxt, and
+ * anything needing cleanup beyond that must register a reset callback there.
+ * Returns NULL for a multi-call function (whose fn_extra belongs to funcapi)
+ * or a call without FmgrInfo, where no such state can be kept.
+ */
+extern void **pljava_Function_callSiteState(Function self, PG_FUNCTION_ARGS);
+
+/*
+ * Return the declared Type of the function's parameter at idx, or NULL if
+ * there is no such parameter (or the function is a UDT support function).
+ */
+extern Type pljava_Function_paramType(Function self, uint16 idx);
+
 /*
  * Not intended for any caller other than Invocation_popInvocation.
  * 'heavy' indicates that the heavy form of parameter-frame saving has been used
@@ -112,6 +155,22 @@ extern jboolean pljava_Function_vpcInvoke(
 	Function self, jobject invocable, jobject rowcollect, jlong call_cntr,
 	jboolean close, jobject *result);
 
+/*
+ * Given the same invocable, when the rows are being materialized: return the
+ * Iterator or ResultSetProvider it was made over, have a ResultSetProvider
+ * that is Batched fill a ColumnBatchWriter (returning the rows filled) or one
+ * that is Writing write all its rows through one (dest being the native state
+ * it flushes to), or fill a PrimitiveBatchReader from a PrimitiveIterator
+ * (returning the values read). The user code runs under the function's access
+ * control context, as through vpcInvoke.
+ */
+extern jobject pljava_Function_srfProducer(jobject invocable);
+extern jint pljava_Function_srfBatchFill(jobject invocable, jobject batch);
+extern void pljava_Function_srfWrite(
+	jobject invocable, jobject batch, jlong dest);
+extern jint pljava_Function_srfPrimitiveFill(
+	jobject invocable, jobject reader);
+
 /*
  * These are exposed so they can be called back from type/UDT.c.
  * There is one for each flavor of UDT supporting function.
@@ -125,6 +184,31 @@ extern jobject pljava_Function_udtReadInvoke(
 extern jobject pljava_Function_udtParseInvoke(
 	jobject invocable, jstring stringRep, jstring typeName);
 
+/*
+ * The same, for a UDT implementing BinarySQLData, given the readSQL or
+ * writeSQL handle: read a new instance from a byte array holding a copy of its
+ * representation, report how many bytes an instance will write, and write an
+ * instance into a byte array (returning the number of bytes written).
+ */
+extern jobject pljava_Function_udtReadBinaryInvoke(
+	jobject invocable, jobject buffer, jstring typeName);
+extern jint pljava_Function_udtBinaryLengthInvoke(
+	jobject invocable, jobject value);
+extern jint pljava_Function_udtWriteBinaryInvoke(
+	jobject invocable, jobject value, jobject buffer);
+
+/*
+ * Calls into a SortSupport provider, given the Invocable stored for a function
+ * declared AS 'sortsupport[class]': whether it makes abbreviated keys, a full
+ * comparison of two decoded values, and the abbreviated key of one. Used by
+ * SortSupport.c, within an Invocation it has pushed.
+ */
+extern jboolean pljava_Function_sortSupportAbbreviates(jobject invocable);
+extern jint pljava_Function_sortSupportCompare(
+	jobject invocable, jobject a, jobject b);
+extern jlong pljava_Function_sortSupportAbbreviate(
+	jobject invocable, jobject value);
+
 /*
  * These are exposed so they can be called back from type/Type.c when it is
  * registering a MappedUDT. A MappedUDT has these two support functions,
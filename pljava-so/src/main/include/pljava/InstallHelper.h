@@ -70,6 +70,13 @@ extern bool pljavaLoadingAsExtension;
  */
 extern char *pljavaFnOidToLibPath(Oid fn, char **langName, bool *trusted);
 
+/*
+ * Where no PL/Java function has yet been called to establish pljavaLoadPath,
+ * set it to the library of the call handler of the language named langName,
+ * if there is one with a C handler. Does nothing if pljavaLoadPath is set.
+ */
+extern void InstallHelper_assumeLoadPathOf(char const *langName);
+
 extern Oid pljavaTrustedOid, pljavaUntrustedOid;
 
 extern bool InstallHelper_isPLJavaFunction(
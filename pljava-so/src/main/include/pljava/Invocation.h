@@ -16,6 +16,7 @@
 #define __pljava_Invocation_h
 
 #include <postgres.h>
+#include <portability/instr_time.h>
 #if PG_VERSION_NUM >= 100000
 #include <commands/trigger.h>
 #endif
@@ -55,10 +56,10 @@ struct Invocation_
 	 * The saved limits reserved in Function.c's static parameter frame, as a
 	 * count of reference and primitive parameters combined in a short.
 	 * FRAME_LIMITS_PUSHED is an otherwise invalid value used to record that the
-	 * more heavyweight saving of the frame as a Java ParameterFrame instance
-	 * has occurred. Otherwise, this value (and the primitive slot 0 value
-	 * below) are simply restored when this Invocation is exited normally or
-	 * exceptionally.
+	 * more heavyweight saving of the whole frame on Function.c's native stack
+	 * of saved frames has occurred. Otherwise, this value (and the primitive
+	 * slot 0 value below) are simply restored when this Invocation is exited
+	 * normally or exceptionally.
 	 */
 	jshort frameLimits;
 #define FRAME_LIMITS_PUSHED ((jshort)-1)
@@ -89,6 +90,14 @@ struct Invocation_
 	 */
 	bool          errorOccurred;
 
+	/**
+	 * Set if this invocation's call is being timed for pljava.track_functions,
+	 * and cleared while the call is in Java. The time spent in Java within the
+	 * call accumulates in javaTime.
+	 */
+	bool          timed;
+	instr_time    javaTime;
+
 #if PG_VERSION_NUM >= 100000
 	/**
 	 * TriggerData pointer, if the function is being called as a trigger,
@@ -43,6 +43,24 @@ extern jint (JNICALL *pljava_createvm)(JavaVM **, void **, void *);
 extern bool beginNative(JNIEnv* env);
 extern bool beginNativeNoErrCheck(JNIEnv* env);
 
+/*
+ * Counts, for the life of the backend, of crossings of the JNI boundary: calls
+ * into Java made through the JNI_call* and JNI_newObject* wrappers (upcalls),
+ * entries from Java into native code through BEGIN_NATIVE (downcalls), new
+ * local references handed to native code by the wrappers, and the bytes of
+ * string content converted by String.c toward Java and from Java.
+ */
+typedef struct
+{
+	uint64 upcalls;
+	uint64 downcalls;
+	uint64 localRefs;
+	uint64 bytesToJava;
+	uint64 bytesFromJava;
+} JNI_Counters;
+
+extern JNI_Counters JNI_counters;
+
 extern jclass    ServerException_class;
 extern jmethodID ServerException_getErrorData;
 extern jmethodID ServerException_init;
@@ -203,6 +221,7 @@ extern jlong        JNI_getLongField(jobject object, jfieldID field);
 extern jmethodID    JNI_getMethodID(jclass clazz, const char* name, const char* sig);
 extern jobject      JNI_getObjectArrayElement(jobjectArray array, jsize index);
 extern jclass       JNI_getObjectClass(jobject obj);
+extern jobject      JNI_getObjectField(jobject object, jfieldID field);
 extern jshort*      JNI_getShortArrayElements(jshortArray array, jboolean* isCopy);
 extern void         JNI_getShortArrayRegion(jshortArray array, jsize start, jsize len, jshort* buf);
 extern jfieldID     JNI_getStaticFieldID(jclass clazz, const char* name, const char* sig);
@@ -215,10 +234,12 @@ extern const char*  JNI_getStringUTFChars(jstring string, jboolean* isCopy);
 extern jboolean     JNI_hasNullArrayElement(jobjectArray array);
 extern jboolean     JNI_isCallingJava(void);
 extern jboolean     JNI_isInstanceOf(jobject obj, jclass clazz);
+extern jboolean     JNI_isAssignableFrom(jclass sub, jclass sup);
 extern jboolean     JNI_isSameObject(jobject obj1, jobject obj2);
 extern jbyteArray   JNI_newByteArray(jsize length);
 extern jbooleanArray JNI_newBooleanArray(jsize length);
 extern jobject      JNI_newDirectByteBuffer(void* address, jlong capacity);
+extern void*        JNI_getDirectBufferAddress(jobject buffer);
 extern jdoubleArray JNI_newDoubleArray(jsize length);
 extern jfloatArray  JNI_newFloatArray(jsize length);
 extern jobject      JNI_newGlobalRef(jobject object);
@@ -256,6 +277,34 @@ extern void         JNI_setObjectArrayElement(jobjectArray array, jsize index, j
 extern void			JNI_setThreadLock(jobject lockObject);
 extern jint         JNI_throw(jthrowable obj);
 
+/*
+ * Local reference frames for a loop that makes local references for each of
+ * many elements: JNI_beginLocalChunks pushes a frame with room for
+ * refsPerElement references for each of JNI_LOCAL_CHUNK elements;
+ * JNI_nextLocalChunk, called at the end of each element, pops it and pushes
+ * another after every JNI_LOCAL_CHUNK elements; JNI_endLocalChunks pops the
+ * last. The table of local references so never grows past one chunk, however
+ * many references (deleted or not) each element makes, and the elements need
+ * not delete their own. Anything to outlast the loop, such as the array being
+ * filled, must be made before JNI_beginLocalChunks.
+ *
+ * As PostgreSQL errors skip the pops, the loop belongs in a PG_TRY whose
+ * PG_CATCH calls JNI_endLocalChunks before PG_RE_THROW; it is harmless to call
+ * more than once.
+ */
+#define JNI_LOCAL_CHUNK 64
+
+typedef struct
+{
+	jint capacity;
+	int  left;
+	bool pushed;
+} JNI_LocalChunks;
+
+extern void JNI_beginLocalChunks(JNI_LocalChunks* lc, jint refsPerElement);
+extern void JNI_nextLocalChunk(JNI_LocalChunks* lc);
+extern void JNI_endLocalChunks(JNI_LocalChunks* lc);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+#ifndef __pljava_OidMap_h
+#define __pljava_OidMap_h
+
+#include <postgres.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*************************************************************
+ * The OidMap, a map from Oid to pointer for the caches consulted on every
+ * function call, where a HashMap would cost a HashKey for each lookup and an
+ * Entry object for each mapping. The keys and values are kept inline in one
+ * open-addressed array, probed linearly, that grows as needed and is the only
+ * allocation, made in the MemoryContext given at creation.
+ *
+ * InvalidOid cannot be used as a key, and NULL cannot be stored as a value.
+ *************************************************************/
+
+struct OidMap_;
+typedef struct OidMap_* OidMap;
+
+/*
+ * Creates a new OidMap able to hold initialCapacity entries before it must
+ * grow. If ctx is NULL, CurrentMemoryContext will be used.
+ */
+extern OidMap OidMap_create(uint32 initialCapacity, MemoryContext ctx);
+
+/*
+ * Frees the OidMap (but not the values it holds).
+ */
+extern void OidMap_free(OidMap self);
+
+/*
+ * Returns the value stored under the given Oid or NULL if there is none.
+ */
+extern void* OidMap_get(OidMap self, Oid key);
+
+/*
+ * Stores the given value under the given Oid. If an old value was stored
+ * under it, the old value is returned. Otherwise this returns NULL.
+ */
+extern void* OidMap_put(OidMap self, Oid key, void* value);
+
+/*
+ * Removes the value stored under the given Oid, returning it, or NULL if
+ * there was none.
+ */
+extern void* OidMap_remove(OidMap self, Oid key);
+
+/*
+ * Returns the number of entries currently in the OidMap.
+ */
+extern uint32 OidMap_size(OidMap self);
+
+/*
+ * Steps through the entries, in no particular order. *cursor must be zero
+ * before the first call. Each call that returns true has stored the key and
+ * value of the next entry through key and value (either of which may be NULL
+ * if not wanted); false is returned when there are no more. The map must not
+ * be added to or removed from while the loop is under way.
+ */
+extern bool OidMap_next(OidMap self, uint32* cursor, Oid* key, void** value);
+
+#ifdef __cplusplus
+} /* end of extern "C" declaration */
+#endif
+#endif
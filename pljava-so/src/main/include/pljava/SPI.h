@@ -21,6 +21,18 @@
 extern "C" {
 #endif
 
+/*
+ * Total t_len of the tuples in SPI_tuptable, or zero if there is none.
+ */
+extern jlong pljava_SPI_tupTableBytes(void);
+
+/*
+ * Wrap SPI_tuptable in a Java TupleTable with the given TupleDesc, leaving
+ * SPI_tuptable zero if the TupleTable has taken it over (borrowed tuples),
+ * or for the caller to free otherwise. Returns 0 if there is no SPI_tuptable.
+ */
+extern jobject pljava_SPI_createTupleTable(jobject tupleDesc);
+
 #ifdef __cplusplus
 } /* end of extern "C" declaration */
 #endif
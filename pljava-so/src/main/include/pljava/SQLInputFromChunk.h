@@ -27,6 +27,31 @@ jobject SQLInputFromChunk_create(void* data, size_t dataSize,
 	bool isJavaBasedScalar);
 void SQLInputFromChunk_close(jobject input);
 
+/*
+ * One reader kept for reuse by a UDT, with a buffer of its own (grown as
+ * needed, up to a limit) into which each value is copied, so that reading a
+ * small value makes no new Java objects. Zeroed memory is a valid empty pool.
+ */
+typedef struct
+{
+	jobject stream;
+	jobject byteBuffer;
+	char   *data;
+	size_t  capacity;
+	bool    busy;
+} SQLInputFromChunkPool;
+
+/*
+ * Return the pool's reader, reset to read a copy of the data, or a new reader
+ * as by SQLInputFromChunk_create if the pool's is in use or the data too large.
+ * SQLInputFromChunk_release must follow, or, if an error is caught instead,
+ * SQLInputFromChunk_abandon.
+ */
+jobject SQLInputFromChunk_acquire(SQLInputFromChunkPool *pool,
+	void* data, size_t dataSize, bool isJavaBasedScalar);
+void SQLInputFromChunk_release(SQLInputFromChunkPool *pool, jobject input);
+void SQLInputFromChunk_abandon(SQLInputFromChunkPool *pool, jobject input);
+
 #ifdef __cplusplus
 } /* end of extern "C" declaration */
 #endif
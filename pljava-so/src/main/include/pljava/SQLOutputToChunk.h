@@ -27,6 +27,38 @@ extern "C" {
 jobject SQLOutputToChunk_create(StringInfo buffer, bool isJavaBasedScalar);
 void SQLOutputToChunk_close(jobject output);
 
+/*
+ * One writer kept for reuse by a UDT, writing into a StringInfo of its own
+ * that lasts between values, and the running average of the lengths written,
+ * by which a buffer made when the pool is in use is sized at the start.
+ * Zeroed memory is a valid empty pool.
+ */
+typedef struct
+{
+	jobject        stream;
+	StringInfoData buffer;
+	char          *javaData;   /* where the writer's ByteBuffer was left */
+	int            javaMaxlen;
+	int32          averageLen;
+	bool           busy;
+} SQLOutputToChunkPool;
+
+/*
+ * Return the pool's buffer, emptied, if it is not in use; otherwise a new
+ * StringInfo in the upper context of the current invocation. After anything
+ * the caller wants ahead of the Java-written bytes is appended to it, the
+ * buffer is passed to SQLOutputToChunk_acquire for a writer. Once the writer
+ * is closed and the contents copied out (they do not outlast the release,
+ * when the buffer was the pool's), SQLOutputToChunk_release must follow, or,
+ * if an error is caught instead, SQLOutputToChunk_abandon.
+ */
+StringInfo SQLOutputToChunk_buffer(SQLOutputToChunkPool *pool);
+jobject SQLOutputToChunk_acquire(SQLOutputToChunkPool *pool,
+	StringInfo buffer, bool isJavaBasedScalar);
+void SQLOutputToChunk_release(SQLOutputToChunkPool *pool,
+	jobject output, StringInfo buffer);
+void SQLOutputToChunk_abandon(SQLOutputToChunkPool *pool, StringInfo buffer);
+
 #ifdef __cplusplus
 } /* end of extern "C" declaration */
 #endif
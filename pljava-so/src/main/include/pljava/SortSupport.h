@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+#ifndef __pljava_SortSupport_h
+#define __pljava_SortSupport_h
+
+#include <postgres.h>
+#include <utils/sortsupport.h>
+
+#include "pljava/pljava.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Sort support for a btree operator class whose FUNCTION 2 is a PL/Java
+ * function declared AS 'sortsupport[class]', the class implementing
+ * org.postgresql.pljava.SortSupport.
+ *
+ * pljava_SortSupport_typeFor finds the type of the operator class(es) naming
+ * the function; pljava_SortSupport_prepare fills in ssup to compare values of
+ * that type with the given provider (an EntryPoints.Invocable), making and
+ * comparing abbreviated keys if the provider offers them.
+ */
+extern Oid pljava_SortSupport_typeFor(Oid funcOid);
+
+extern void pljava_SortSupport_prepare(
+	SortSupport ssup, jobject provider, Oid typeId, jobject typeMap);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
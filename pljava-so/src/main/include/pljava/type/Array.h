@@ -23,8 +23,11 @@ extern "C" {
  ***********************************************************************/
 
 extern ArrayType* createArrayType(jsize nElems, size_t elemSize, Oid elemType, bool withNulls);
+extern ArrayType* createArrayTypeMD(int ndim, const int* dims, size_t elemSize, Oid elemType, bool withNulls);
 extern void arraySetNull(bits8* bitmap, int offset, bool flag);
 extern bool arrayIsNull(const bits8* bitmap, int offset);
+extern int arrayExpandNulls(char* dest, const char* src, const bits8* bitmap, int offset, int nElems, size_t elemSize);
+extern int arrayCompactNulls(char* dest, bits8* bitmap, const char* src, const jboolean* isNull, int nElems, size_t elemSize);
 
 extern Type Array_fromOid(Oid typeId, Type elementType);
 extern Type Array_fromOid2(Oid typeId, Type elementType, DatumCoercer coerceDatum, ObjectCoercer coerceObject);
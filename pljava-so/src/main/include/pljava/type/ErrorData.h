@@ -27,9 +27,11 @@ extern "C" {
 
 /*
  * Create the org.postgresql.pljava.internal.ErrorData that represents
- * the current error obtaind from CopyErrorData().
+ * the current error obtaind from CopyErrorData(). If copy is not NULL, the
+ * copied ErrorData is also stored there, so its fields can be read without
+ * calling through the Java object.
  */
-extern jobject pljava_ErrorData_getCurrentError(void);
+extern jobject pljava_ErrorData_getCurrentError(ErrorData **copy);
 
 /*
  * Extract the native ErrorData from a Java ErrorData.
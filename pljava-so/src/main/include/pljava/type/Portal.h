@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2004-2019 Tada AB and other contributors, as listed below.
+ * Copyright (c) 2004-2026 Tada AB and other contributors, as listed below.
  *
  * All rights reserved. This program and the accompanying materials
  * are made available under the terms of the The BSD 3-Clause License
@@ -32,9 +32,16 @@ extern "C" {
 extern void pljava_Portal_initialize(void);
 
 /*
- * Create the org.postgresql.pljava.Portal instance
+ * Create the org.postgresql.pljava.Portal instance. If hold, the portal is
+ * made holdable (as by DECLARE ... WITH HOLD), and the Java instance stays
+ * usable, past the end of the transaction, until the portal is dropped.
  */
-extern jobject pljava_Portal_create(Portal portal, jobject jplan);
+extern jobject pljava_Portal_create(Portal portal, jobject jplan, bool hold);
+
+/*
+ * Close a portal whose Java instance is being released from Java.
+ */
+extern void pljava_Portal_close(Portal portal);
 
 #ifdef __cplusplus
 }
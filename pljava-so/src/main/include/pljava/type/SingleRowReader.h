@@ -36,6 +36,16 @@ extern jobject pljava_SingleRowReader_getTupleDesc(HeapTupleHeader);
 
 extern jobject pljava_SingleRowReader_create(HeapTupleHeader);
 
+/*
+ * The native state of a reader of the tuple, as the Java long to be passed to
+ * the constructor of SingleRowReader or a subclass made elsewhere (such as
+ * SQLInputFromTuple). If values is not NULL, the tuple is deformed at once and
+ * *values set to a new Java array holding each field as its default Java class
+ * (or null), to be read without another call into native code.
+ */
+extern jlong pljava_SingleRowReader_newState(
+	HeapTupleHeader ht, jobjectArray *values);
+
 #ifdef __cplusplus
 }
 #endif
@@ -36,13 +36,15 @@ extern "C" {
 extern jobject pljava_TriggerData_create(TriggerData* triggerData);
 
 /*
- * Obtains the returned Tuple after trigger has been processed.
+ * Obtains the returned Tuple after trigger has been processed. If the trigger
+ * made no change, it is td's own trigger or new tuple, not a copy; otherwise
+ * it is a copy made in the current memory context.
  * Note: starting with PG 10, it is the caller's responsibility to ensure SPI
  * is connected (and that a longer-lived memory context than SPI's is selected,
  * if the caller wants the result to survive SPI_finish).
  */
 extern HeapTuple pljava_TriggerData_getTriggerReturnTuple(
-	jobject jtd, bool* wasNull);
+	jobject jtd, TriggerData* td, bool* wasNull);
 extern void pljava_TriggerData_initialize(void);
 
 #ifdef __cplusplus
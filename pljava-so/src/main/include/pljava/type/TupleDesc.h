@@ -20,6 +20,7 @@ extern "C" {
 #endif
 
 #include <access/tupdesc.h>
+#include <utils/tuplestore.h>
 
 /********************************************************************
  * The TupleDesc java class provides JNI
@@ -40,6 +41,14 @@ extern Type pljava_TupleDesc_getColumnType(TupleDesc tupleDesc, int index);
  */
 extern jobject pljava_TupleDesc_create(TupleDesc tDesc);
 extern jobject pljava_TupleDesc_internalCreate(TupleDesc tDesc);
+
+/*
+ * Form rows 0 through nrows-1 of a batch filled through ColumnBatchWriter,
+ * whose values array and primitives buffer (at prims) are in the layout that
+ * class describes, and put them in tupstore.
+ */
+extern void pljava_TupleDesc_putBatch(TupleDesc tupleDesc,
+	Tuplestorestate *tupstore, jobjectArray values, jbyte *prims, int nrows);
 extern void pljava_TupleDesc_initialize(void);
 
 #ifdef __cplusplus
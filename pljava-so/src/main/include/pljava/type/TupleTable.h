@@ -30,6 +30,22 @@ extern "C" {
 extern jobject TupleTable_createFromSlot(TupleTableSlot* tupleTableSlot);
 extern jobject TupleTable_create(SPITupleTable* tupleTable, jobject knownTD);
 
+/*
+ * Create a TupleTable that takes over the SPITupleTable in place, rather than
+ * copying its tuples; the caller must see that SPI_tuptable no longer refers to
+ * it. The Java object frees it when released, or it is left for SPI_finish.
+ */
+extern jobject TupleTable_createBorrowed(
+	SPITupleTable* tupleTable, jobject knownTD);
+
+/*
+ * Create a TupleTable holding copies of count tuples of the descriptor td, with
+ * its columns of primitive types also deformed into arrays, as for the
+ * columnar fetch, whatever pljava.spi_columnar_fetch says.
+ */
+extern jobject TupleTable_createFromTuples(
+	TupleDesc td, HeapTuple* tuples, jint count);
+
 #ifdef __cplusplus
 }
 #endif
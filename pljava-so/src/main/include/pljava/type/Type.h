@@ -239,6 +239,12 @@ typedef jvalue (*DatumCoercer)(Type, Datum);
  */
 typedef Datum (*ObjectCoercer)(Type, jobject);
 
+/*
+ * Return the function Type_coerceDatum would dispatch to for this type, so
+ * a caller coercing many values of one type can call it directly.
+ */
+extern DatumCoercer Type_getDatumCoercer(Type self);
+
 /*
  * Register this type as the default mapping for a postgres type.
  */
@@ -37,6 +37,13 @@ extern Datum UDT_output(UDT udt, PG_FUNCTION_ARGS);
 extern Datum UDT_receive(UDT udt, PG_FUNCTION_ARGS);
 extern Datum UDT_send(UDT udt, PG_FUNCTION_ARGS);
 
+/*
+ * Equality and hashing of a scalar UDT by the bytes of its internal
+ * representation, for a type declared with binaryEquality; no Java is called.
+ */
+extern Datum UDT_binaryEquals(UDT udt, PG_FUNCTION_ARGS);
+extern Datum UDT_binaryHash(UDT udt, PG_FUNCTION_ARGS);
+
 extern bool UDT_isScalar(UDT udt);
 
 /*
@@ -58,6 +65,31 @@ extern UDT UDT_registerUDT(jclass clazz, Oid typeId, Form_pg_type pgType,
 
 typedef Datum (*UDTFunction)(UDT udt, PG_FUNCTION_ARGS);
 
+/*
+ * A small cache of the instances decoded from recently seen values, for a call
+ * site, keyed by the values' bytes. A pointer to a NULL UDTDecodeCache is
+ * passed to UDT_coerceDatumCached the first time; the cache is then allocated
+ * in the memory context given, and the Java references it holds are released
+ * when that context is reset or deleted.
+ */
+struct UDTDecodeCache_;
+typedef struct UDTDecodeCache_* UDTDecodeCache;
+
+/*
+ * True if the Type is a UDT whose class is annotated ImmutableUDT.
+ */
+extern bool UDT_isDecodeCached(Type t);
+
+/*
+ * Like coerceDatum for the UDT (which must be one for which UDT_isDecodeCached
+ * is true), but returns the instance remembered in *cachep if one was made
+ * from identical bytes, and otherwise remembers the one it makes, if the value
+ * is not too large. The reference returned belongs to the cache and must not
+ * be deleted by the caller.
+ */
+extern jvalue UDT_coerceDatumCached(
+	Type self, Datum arg, UDTDecodeCache *cachep, MemoryContext cxt);
+
 #ifdef __cplusplus
 }
 #endif
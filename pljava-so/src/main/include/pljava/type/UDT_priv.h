@@ -17,6 +17,8 @@
 
 #include "pljava/type/Type_priv.h"
 #include "pljava/type/UDT.h"
+#include "pljava/SQLInputFromChunk.h"
+#include "pljava/SQLOutputToChunk.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -37,6 +39,22 @@ struct UDT_
 
 	jstring   sqlTypeName;
 	bool      hasTupleDesc;
+
+	/*
+	 * True if the class implements BinarySQLData, so a scalar value is read
+	 * and written through a ByteBuffer over a Java byte[], into which the
+	 * datum's bytes are copied (or from which the new datum's are), using the
+	 * readSQL and writeSQL handles below, rather than through an SQLInput or
+	 * SQLOutput.
+	 */
+	bool      binaryCodec;
+
+	/*
+	 * True if the class is annotated ImmutableUDT, so an instance decoded from
+	 * a parameter value may be kept and passed again for the same bytes at the
+	 * same call site; see UDT_coerceDatumCached.
+	 */
+	bool      decodeOnce;
 	jobject parse;
 	jobject readSQL;
 
@@ -49,6 +67,13 @@ struct UDT_
 	 */
 	jobject writeSQL;
 	jobject toString;
+
+	/*
+	 * A reader and a writer kept for reusing with each scalar value read or
+	 * written through readSQL and writeSQL.
+	 */
+	SQLInputFromChunkPool reader;
+	SQLOutputToChunkPool  writer;
 };
 
 extern Datum _UDT_coerceObject(Type self, jobject jstr);
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2004-2020 Tada AB and other contributors, as listed below.
+ * Copyright (c) 2004-2026 Tada AB and other contributors, as listed below.
  *
  * All rights reserved. This program and the accompanying materials
  * are made available under the terms of the The BSD 3-Clause License
@@ -105,7 +105,111 @@ public class ELogHandler extends Handler
 			pgLevel = LOG_DEBUG3;
 		else
 			pgLevel = LOG_LOG;
-		Backend.log(pgLevel, this.getFormatter().format(record));
+
+		/*
+		 * The logger levels were set from the configuration when PL/Java
+		 * started; the settings may have changed since, so a record passing
+		 * those may still be one PostgreSQL would discard. Drop it here, and
+		 * save formatting it and passing it to PostgreSQL.
+		 */
+		if ( ! Backend.isMessageLevelWanted(pgLevel) )
+			return;
+
+		String message = this.getFormatter().format(record);
+
+		/*
+		 * ERROR and above are not buffered, and anything buffered goes ahead
+		 * of them, so they are seen in the order they were published.
+		 */
+		if ( LOG_ERROR <= pgLevel  ||  ! Buffer.add(pgLevel, message) )
+		{
+			Buffer.flush();
+			Backend.log(pgLevel, message);
+		}
+	}
+
+	/**
+	 * Passes to PostgreSQL any records held back while
+	 * {@code pljava.log_buffer} is positive.
+	 *<p>
+	 * Called when a PL/Java function returns, and by {@link #flush flush}.
+	 */
+	public static void flushBuffered()
+	{
+		Buffer.flush();
+	}
+
+	/**
+	 * Records held back while {@code pljava.log_buffer} is positive, to be
+	 * passed to PostgreSQL in one call.
+	 *<p>
+	 * The arrays and count are only changed on the PG thread, under
+	 * {@code doInPG}, as a monitor of their own could deadlock with a thread
+	 * holding that lock and publishing a record.
+	 */
+	private static final class Buffer
+	{
+		private static int[] s_levels = new int[0];
+		private static String[] s_messages = new String[0];
+		private static volatile int s_count;
+
+		/**
+		 * Adds a record to the buffer, passing the buffer to PostgreSQL if that
+		 * fills it.
+		 * @return false if buffering is off, and nothing was added
+		 */
+		static boolean add(int level, String message)
+		{
+			if ( 0 == Backend.getLogBufferSize() )
+				return false;
+			return doInPG(() ->
+			{
+				int size = Backend.getLogBufferSize();
+				if ( 0 == size )
+					return false;
+				if ( s_count >= Math.min(size, s_levels.length) )
+					flush(); // the setting has changed since it last filled
+				if ( 0 == s_count )
+				{
+					if ( s_levels.length < size )
+					{
+						s_levels = new int[size];
+						s_messages = new String[size];
+					}
+					/*
+					 * Registering the invocation gets its onExit callback,
+					 * which flushes the buffer when the function returns.
+					 */
+					Invocation.current();
+				}
+				s_levels[s_count] = level;
+				s_messages[s_count] = message;
+				if ( ++ s_count >= size )
+					flush();
+				return true;
+			});
+		}
+
+		static void flush()
+		{
+			if ( 0 == s_count )
+				return;
+			doInPG(() ->
+			{
+				int count = s_count;
+				if ( 0 == count )
+					return;
+				try
+				{
+					Backend.logBuffered(s_levels, s_messages, count);
+				}
+				finally
+				{
+					fill(s_messages, 0, count, null);
+					s_count = 0;
+				}
+			});
+		}
 	}
 
 	public ELogHandler()
@@ -114,10 +218,11 @@ public class ELogHandler extends Handler
 	}
 
 	/**
-	 * This is a no-op.
+	 * Passes any buffered records to PostgreSQL.
 	 */
 	public void flush()
 	{
+		Buffer.flush();
 	}
 
 	/**
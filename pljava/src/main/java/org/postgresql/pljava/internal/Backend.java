@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2004-2022 Tada AB and other contributors, as listed below.
+ * Copyright (c) 2004-2026 Tada AB and other contributors, as listed below.
  *
  * All rights reserved. This program and the accompanying materials
  * are made available under the terms of the The BSD 3-Clause License
@@ -14,16 +14,22 @@ package org.postgresql.pljava.internal;
 
 import java.io.InputStream;
 import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.IntBuffer;
+import java.nio.LongBuffer;
 
 import java.sql.SQLException;
 import java.sql.SQLDataException;
 import java.util.ArrayList;
 import java.util.Collections;
+import java.util.HashMap;
 import java.util.List;
+import java.util.Map;
 import java.util.regex.Matcher;
 import java.util.regex.Pattern;
 
-import org.postgresql.pljava.elog.ELogHandler; // for javadoc
+import org.postgresql.pljava.elog.ELogHandler;
 
 import org.postgresql.pljava.sqlgen.Lexicals.Identifier;
 import static org.postgresql.pljava.sqlgen.Lexicals.identifierFrom;
@@ -84,10 +90,13 @@ public class Backend
 	throws E
 	{
 		if ( null != THREADLOCK )
+		{
+			assertNotComputeWorker();
 			synchronized(THREADLOCK)
 			{
 				return op.get();
 			}
+		}
 		assertThreadMayEnterPG();
 		return op.get();
 	}
@@ -102,11 +111,14 @@ public class Backend
 	throws E
 	{
 		if ( null != THREADLOCK )
+		{
+			assertNotComputeWorker();
 			synchronized(THREADLOCK)
 			{
 				op.run();
 				return;
 			}
+		}
 		assertThreadMayEnterPG();
 		op.run();
 	}
@@ -123,10 +135,13 @@ public class Backend
 	throws E
 	{
 		if ( null != THREADLOCK )
+		{
+			assertNotComputeWorker();
 			synchronized(THREADLOCK)
 			{
 				return op.getAsBoolean();
 			}
+		}
 		assertThreadMayEnterPG();
 		return op.getAsBoolean();
 	}
@@ -143,10 +158,13 @@ public class Backend
 	throws E
 	{
 		if ( null != THREADLOCK )
+		{
+			assertNotComputeWorker();
 			synchronized(THREADLOCK)
 			{
 				return op.getAsDouble();
 			}
+		}
 		assertThreadMayEnterPG();
 		return op.getAsDouble();
 	}
@@ -162,10 +180,13 @@ public class Backend
 	throws E
 	{
 		if ( null != THREADLOCK )
+		{
+			assertNotComputeWorker();
 			synchronized(THREADLOCK)
 			{
 				return op.getAsInt();
 			}
+		}
 		assertThreadMayEnterPG();
 		return op.getAsInt();
 	}
@@ -181,10 +202,13 @@ public class Backend
 	throws E
 	{
 		if ( null != THREADLOCK )
+		{
+			assertNotComputeWorker();
 			synchronized(THREADLOCK)
 			{
 				return op.getAsLong();
 			}
+		}
 		assertThreadMayEnterPG();
 		return op.getAsLong();
 	}
@@ -214,6 +238,20 @@ public class Backend
 		return Boolean.TRUE == IAMPGTHREAD.get();
 	}
 
+	/**
+	 * Throw {@code IllegalStateException} if the current thread is a worker of
+	 * {@link ParallelComputeImpl}, which may never enter PG, whatever the
+	 * setting of {@code pljava.java_thread_pg_entry}. Only needed where
+	 * {@code THREADLOCK} is in use; otherwise, such a thread is refused anyway.
+	 */
+	private static void assertNotComputeWorker()
+	{
+		if ( Thread.currentThread() instanceof ParallelComputeImpl.Worker )
+			throw new IllegalStateException(
+				"Attempt by a parallel compute worker thread to enter " +
+				"PostgreSQL");
+	}
+
 	/**
 	 * Throw {@code IllegalStateException} if {@code threadMayEnterPG()} would
 	 * return false.
@@ -232,12 +270,54 @@ public class Backend
 	/**
 	 * Returns the configuration option as read from the Global
 	 * Unified Config package (GUC).
+	 *<p>
+	 * Values are cached, and a value read again is taken from the cache with
+	 * no call into PostgreSQL, as long as nothing has happened since it was
+	 * read that could have changed a setting: no PL/Java function has been
+	 * entered or has returned, no SQL has been run or rows fetched through SPI
+	 * from Java, and no savepoint has been rolled back.
+	 *<p>
+	 * So the cache helps only within a single call of a PL/Java function, as
+	 * for library code reading the same setting for each of many values or
+	 * rows passed to it; every call starts with an empty cache. It is not kept
+	 * from one call to the next, because settings can change between calls in
+	 * ways PostgreSQL does not announce (a {@code SET} statement, a
+	 * {@code set_config} call in the same query, a function's {@code SET}
+	 * clause, the end of a transaction undoing {@code SET LOCAL}).
 	 * @param key The name of the option.
 	 * @return The value of the option.
 	 */
 	public static String getConfigOption(String key)
 	{
-		return doInPG(() -> _getConfigOption(key));
+		return doInPG(() ->
+		{
+			long generation = ConfigCache.s_generation.get(0);
+			if ( generation != ConfigCache.s_seen )
+			{
+				ConfigCache.s_values.clear();
+				ConfigCache.s_seen = generation;
+			}
+			String value = ConfigCache.s_values.get(key);
+			if ( null == value  &&  ! ConfigCache.s_values.containsKey(key) )
+			{
+				value = _getConfigOption(key);
+				ConfigCache.s_values.put(key, value);
+			}
+			return value;
+		});
+	}
+
+	/**
+	 * Values read by {@code getConfigOption}, and the live view of the native
+	 * generation count at which they were read; only touched within doInPG.
+	 */
+	private static class ConfigCache
+	{
+		static final LongBuffer s_generation =
+			doInPG(Backend::_configGeneration)
+			.order(ByteOrder.nativeOrder()).asLongBuffer();
+		static final Map<String,String> s_values = new HashMap<>();
+		static long s_seen = s_generation.get(0);
 	}
 
 	public static List<Identifier.Simple> getListConfigOption(String key)
@@ -268,6 +348,26 @@ public class Backend
 		return doInPG(Backend::_getStatementCacheSize);
 	}
 
+	/**
+	 * Returns the {@code pljava.statement_cache_memory} setting in bytes, the
+	 * memory the prepared statement cache may occupy, or zero if only the
+	 * number of statements is limited.
+	 */
+	public static long getStatementCacheMemory()
+	{
+		return 1024L * doInPG(Backend::_getStatementCacheMemory);
+	}
+
+	/**
+	 * Returns the {@code pljava.spi_fetch_memory} setting in bytes, the memory
+	 * to aim for in each batch of rows fetched by an {@code SPIResultSet}, or
+	 * zero if the fetch size is not to be adjusted.
+	 */
+	public static long getSPIFetchMemory()
+	{
+		return 1024L * doInPG(Backend::_getSPIFetchMemory);
+	}
+
 	/**
 	 * Log a message using the internal elog command.
 	 * @param logLevel The log level as defined in
@@ -279,16 +379,108 @@ public class Backend
 		doInPG(() -> _log(logLevel, str));
 	}
 
+	/**
+	 * Log several messages, in order, using the internal elog command.
+	 * @param logLevels The log level of each message, as defined in
+	 * {@link ELogHandler}.
+	 * @param strs The messages
+	 * @param count How many of the leading elements of the arrays to log
+	 */
+	public static void logBuffered(int[] logLevels, String[] strs, int count)
+	{
+		doInPG(() -> _logBuffered(logLevels, strs, count));
+	}
+
+	/**
+	 * The current {@code pljava.log_buffer} setting, read with no call into
+	 * PostgreSQL.
+	 * @return How many log records {@link ELogHandler} may hold before passing
+	 * them to PostgreSQL, or zero if it should hold none.
+	 */
+	public static int getLogBufferSize()
+	{
+		return LogBufferSize.s_view.get(0);
+	}
+
+	/**
+	 * Live view of the {@code pljava.log_buffer} setting.
+	 */
+	private static class LogBufferSize
+	{
+		static final IntBuffer s_view = doInPG(Backend::_logBufferSize)
+			.order(ByteOrder.nativeOrder()).asIntBuffer();
+	}
+
+	/**
+	 * Whether a message at the given level, as defined in {@link ELogHandler},
+	 * would now be sent to the client or written to the server log, according
+	 * to the current {@code client_min_messages} and {@code log_min_messages}.
+	 *<p>
+	 * The settings are read as they are at the moment, with no call into
+	 * PostgreSQL, so a message that would be discarded can be dropped before
+	 * it is even formatted. Messages at {@code LOG}, {@code INFO}, or
+	 * {@code WARNING} and above are always taken to be wanted: {@code INFO}
+	 * always goes to the client, and deciding the others needs level values
+	 * that differ among PostgreSQL versions.
+	 */
+	public static boolean isMessageLevelWanted(int logLevel)
+	{
+		if ( ELogHandler.LOG_WARNING <= logLevel
+			||  ELogHandler.LOG_INFO == logLevel
+			||  ELogHandler.LOG_LOG == logLevel )
+			return true;
+
+		if ( MessageLevels.s_client.get(0) <= logLevel )
+			return true;
+
+		int server = MessageLevels.s_server.get(0);
+		return ELogHandler.LOG_LOG != server  &&  server <= logLevel;
+	}
+
+	/**
+	 * Live views of the {@code client_min_messages} and
+	 * {@code log_min_messages} settings.
+	 */
+	private static class MessageLevels
+	{
+		static final IntBuffer s_client = view(true);
+		static final IntBuffer s_server = view(false);
+
+		private static IntBuffer view(boolean client)
+		{
+			return doInPG(() -> _messageLevel(client))
+				.order(ByteOrder.nativeOrder()).asIntBuffer();
+		}
+	}
+
 	public static void clearFunctionCache()
 	{
 		doInPG(Backend::_clearFunctionCache);
 	}
 
+	/**
+	 * Clear only the cached functions that use the given schema class loader.
+	 */
+	public static void clearFunctionCache(ClassLoader loader)
+	{
+		doInPG(() -> _clearFunctionCacheForLoader(loader));
+	}
+
 	public static boolean isCreatingExtension()
 	{
 		return doInPG(Backend::_isCreatingExtension);
 	}
 
+	/**
+	 * Return the counts of JNI crossings in this session: calls into Java,
+	 * calls into PostgreSQL, local references made, and string bytes
+	 * converted to Java and from Java, in that order.
+	 */
+	public static long[] jniStatistics()
+	{
+		return doInPG(Backend::_jniStatistics);
+	}
+
 	/**
 	 * Returns the path of PL/Java's shared library.
 	 * @throws SQLException if for some reason it can't be determined.
@@ -303,6 +495,36 @@ public class Backend
 		throw new SQLException("Unable to retrieve PL/Java's library path");
 	}
 
+	/**
+	 * Returns the {@code pljava.job_workers} setting, the most background
+	 * workers to run the queued jobs of one role in one database.
+	 */
+	public static int getJobWorkers()
+	{
+		return doInPG(Backend::_getJobWorkers);
+	}
+
+	/**
+	 * Returns whether PostgreSQL has an interrupt waiting to be serviced, such
+	 * as a query cancel or a request to terminate the backend, which will be
+	 * acted on once control returns to PostgreSQL.
+	 */
+	public static boolean isInterruptPending()
+	{
+		return doInPG(Backend::_isInterruptPending);
+	}
+
+	/**
+	 * Start a background worker to run the queued jobs of a role in the
+	 * current database.
+	 * @param roleId The role's oid, as an int.
+	 * @return false if no background worker slot was free.
+	 */
+	public static boolean launchJobWorker(int roleId)
+	{
+		return doInPG(() -> _launchJobWorker(roleId));
+	}
+
 	/**
 	 * Attempt (best effort, unexposed JDK internals) to suppress
 	 * the layer-inappropriate JEP 411 warning when {@code InstallHelper}
@@ -330,11 +552,23 @@ public class Backend
 	private static native String _getConfigOption(String key);
 
 	private static native int  _getStatementCacheSize();
+	private static native int  _getStatementCacheMemory();
+	private static native int  _getSPIFetchMemory();
 	private static native void _log(int logLevel, String str);
 	private static native void _clearFunctionCache();
+	private static native void _clearFunctionCacheForLoader(ClassLoader l);
 	private static native boolean _isCreatingExtension();
 	private static native String _myLibraryPath();
 	private static native void _pokeJEP411(Class<?> caller, Object token);
+	private static native long[] _jniStatistics();
+	private static native ByteBuffer _messageLevel(boolean client);
+	private static native ByteBuffer _logBufferSize();
+	private static native ByteBuffer _configGeneration();
+	private static native void _logBuffered(
+		int[] logLevels, String[] strs, int count);
+	private static native int  _getJobWorkers();
+	private static native boolean _launchJobWorker(int roleId);
+	private static native boolean _isInterruptPending();
 
 	private static class EarlyNatives
 	{
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+package org.postgresql.pljava.internal;
+
+import java.sql.Connection;
+import java.sql.PreparedStatement;
+import java.sql.ResultSet;
+import java.sql.SQLException;
+
+import org.postgresql.pljava.BackgroundJobs;
+
+import static org.postgresql.pljava.jdbc.SQLUtils.getDefaultConnection;
+
+/**
+ * Implementation of {@link BackgroundJobs} through the SQL functions
+ * {@code sqlj.submit_job} and {@code sqlj.job_status}, which act for the outer
+ * user on the queue table only they can read or change.
+ */
+class BackgroundJobsImpl implements BackgroundJobs
+{
+	static final BackgroundJobsImpl INSTANCE = new BackgroundJobsImpl();
+
+	private BackgroundJobsImpl()
+	{
+	}
+
+	@Override
+	public long submit(String function, String argument) throws SQLException
+	{
+		try (
+			Connection c = getDefaultConnection();
+			PreparedStatement ps =
+				c.prepareStatement("SELECT sqlj.submit_job(?, ?)");
+		)
+		{
+			ps.setString(1, function);
+			ps.setString(2, argument);
+			try ( ResultSet rs = ps.executeQuery() )
+			{
+				rs.next();
+				return rs.getLong(1);
+			}
+		}
+	}
+
+	@Override
+	public State state(long jobId) throws SQLException
+	{
+		try (
+			Connection c = getDefaultConnection();
+			PreparedStatement ps =
+				c.prepareStatement("SELECT state FROM sqlj.job_status(?)");
+		)
+		{
+			ps.setLong(1, jobId);
+			try ( ResultSet rs = ps.executeQuery() )
+			{
+				if ( ! rs.next() || null == rs.getString(1) )
+					return null;
+				return State.valueOf(rs.getString(1).toUpperCase());
+			}
+		}
+	}
+
+	@Override
+	public String result(long jobId) throws SQLException
+	{
+		try (
+			Connection c = getDefaultConnection();
+			PreparedStatement ps = c.prepareStatement(
+				"SELECT state, result, error FROM sqlj.job_status(?)");
+		)
+		{
+			ps.setLong(1, jobId);
+			try ( ResultSet rs = ps.executeQuery() )
+			{
+				if ( ! rs.next() || null == rs.getString(1) )
+					throw new SQLException(
+						"no background job " + jobId, "22023");
+				switch ( rs.getString(1) )
+				{
+				case "done":
+					return rs.getString(2);
+				case "failed":
+					throw new SQLException(
+						"background job " + jobId + " failed: " +
+						rs.getString(3), "38000");
+				default:
+					return null;
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+package org.postgresql.pljava.internal;
+
+/**
+ * Bulk unboxing of arrays of the boxed numeric types, called from
+ * {@code Array.c} so that an {@code Integer[]} (say) returned to PostgreSQL
+ * crosses from Java to C in one call rather than one call per element.
+ *<p>
+ * Each {@code unbox} method stores the values of the elements of {@code a}
+ * into {@code values}, and marks the null ones in {@code isNull}, both of the
+ * same length as {@code a}, and returns the number of nulls. The C code then
+ * builds the PostgreSQL array, null bitmap and all, from the primitive array
+ * and that null mask.
+ */
+class BoxedArrays
+{
+	private BoxedArrays() // do not instantiate
+	{
+	}
+
+	static int unbox(Short[] a, short[] values, boolean[] isNull)
+	{
+		int nulls = 0;
+		for ( int i = 0 ; i < a.length ; ++ i )
+		{
+			Short v = a[i];
+			if ( null == v )
+			{
+				isNull[i] = true;
+				++ nulls;
+			}
+			else
+				values[i] = v;
+		}
+		return nulls;
+	}
+
+	static int unbox(Integer[] a, int[] values, boolean[] isNull)
+	{
+		int nulls = 0;
+		for ( int i = 0 ; i < a.length ; ++ i )
+		{
+			Integer v = a[i];
+			if ( null == v )
+			{
+				isNull[i] = true;
+				++ nulls;
+			}
+			else
+				values[i] = v;
+		}
+		return nulls;
+	}
+
+	static int unbox(Long[] a, long[] values, boolean[] isNull)
+	{
+		int nulls = 0;
+		for ( int i = 0 ; i < a.length ; ++ i )
+		{
+			Long v = a[i];
+			if ( null == v )
+			{
+				isNull[i] = true;
+				++ nulls;
+			}
+			else
+				values[i] = v;
+		}
+		return nulls;
+	}
+
+	static int unbox(Float[] a, float[] values, boolean[] isNull)
+	{
+		int nulls = 0;
+		for ( int i = 0 ; i < a.length ; ++ i )
+		{
+			Float v = a[i];
+			if ( null == v )
+			{
+				isNull[i] = true;
+				++ nulls;
+			}
+			else
+				values[i] = v;
+		}
+		return nulls;
+	}
+
+	static int unbox(Double[] a, double[] values, boolean[] isNull)
+	{
+		int nulls = 0;
+		for ( int i = 0 ; i < a.length ; ++ i )
+		{
+			Double v = a[i];
+			if ( null == v )
+			{
+				isNull[i] = true;
+				++ nulls;
+			}
+			else
+				values[i] = v;
+		}
+		return nulls;
+	}
+}
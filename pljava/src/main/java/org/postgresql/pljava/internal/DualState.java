@@ -30,6 +30,7 @@ import java.util.NoSuchElementException;
 import java.util.Queue;
 
 import java.util.concurrent.CancellationException;
+import java.util.concurrent.ConcurrentHashMap;
 import java.util.concurrent.ConcurrentLinkedQueue;
 import java.util.concurrent.atomic.LongAdder;
 import static java.util.concurrent.locks.LockSupport.park;
@@ -583,6 +584,39 @@ public abstract class DualState<T> extends WeakReference<T>
 	 */
 	private static final Statistics s_stats = new Statistics();
 
+	/**
+	 * Counts kept for each concrete {@code DualState} subclass.
+	 *<p>
+	 * Instances are only constructed and released on the PG thread, but the
+	 * counts may be read from another (as through JMX), so every class counted
+	 * is also recorded in {@code s_perClass} for enumeration.
+	 */
+	private static final ClassValue<ClassCounts> s_classCounts =
+		new ClassValue<ClassCounts>()
+		{
+			@Override
+			protected ClassCounts computeValue(Class<?> c)
+			{
+				ClassCounts counts = new ClassCounts(c.getName());
+				ClassCounts prior = s_perClass.putIfAbsent(c.getName(), counts);
+				return null == prior ? counts : prior;
+			}
+		};
+
+	private static final Map<String,ClassCounts> s_perClass =
+		new ConcurrentHashMap<>();
+
+	/**
+	 * Number of constructions between checks for native memory pressure.
+	 */
+	private static final int PRESSURE_CHECK_INTERVAL = 256;
+
+	/**
+	 * Constructions since the last check for native memory pressure; only
+	 * touched on the PG thread.
+	 */
+	private static int s_sinceCheck;
+
 	static {
 		try
 		{
@@ -717,8 +751,24 @@ public abstract class DualState<T> extends WeakReference<T>
 			s_unscopedInstances.put(this, this);
 
 		s_stats.construct(scoped);
+		s_classCounts.get(getClass()).constructed.increment();
+
+		/*
+		 * Otherwise, enqueued instances are only cleaned at fetches and at
+		 * returns from functions; a function making many objects between those
+		 * points could let a lot of native memory be held by instances already
+		 * found unreachable. The native method decides, from the growth of the
+		 * memory holding such state, whether to clean them now.
+		 */
+		if ( PRESSURE_CHECK_INTERVAL <= ++ s_sinceCheck )
+		{
+			s_sinceCheck = 0;
+			_cleanIfPressured();
+		}
 	}
 
+	private static native void _cleanIfPressured();
+
 	/**
 	 * Private constructor only for dummy instances to use as the list heads
 	 * for per-resource-owner lists.
@@ -1723,6 +1773,7 @@ public abstract class DualState<T> extends WeakReference<T>
 			t = s.m_next;
 			s.m_prev = s.m_next = null;
 			++ total;
+			s_classCounts.get(s.getClass()).released.increment();
 			/*
 			 * This lock() is part of DualState's contract with clients.
 			 * They are responsible for pinning the state instance
@@ -1827,7 +1878,10 @@ public abstract class DualState<T> extends WeakReference<T>
 		if ( 0 == m_resourceOwner )
 		{
 			if ( null != s_unscopedInstances.remove(this) )
+			{
 				s_stats.delistUnscoped();
+				s_classCounts.get(getClass()).released.increment();
+			}
 			return;
 		}
 
@@ -1839,6 +1893,65 @@ public abstract class DualState<T> extends WeakReference<T>
 			m_next.m_prev = m_prev;
 		m_prev = m_next = null;
 		s_stats.delistScoped();
+		s_classCounts.get(getClass()).released.increment();
+	}
+
+	/**
+	 * Return the bytes of native memory held by this instance's native state,
+	 * for the per-class statistics; zero unless overridden.
+	 *<p>
+	 * Called only on the PG thread, and only while the native state has not
+	 * been released.
+	 */
+	long nativeBytes()
+	{
+		return 0L;
+	}
+
+	/**
+	 * Return the per-class counts, first measuring the native memory held by
+	 * the live instances of each class, and how many of them are awaiting
+	 * release.
+	 *<p>
+	 * Must be called on the PG thread, as it walks the lists of live instances
+	 * and may call native code to size their native state. The counts of
+	 * instances constructed and released are kept as they happen; the
+	 * measured values are as of the most recent call of this method, which is
+	 * what a JMX client will see.
+	 */
+	public static DualStateStatistics.PerClass[] measurePerClass()
+	{
+		assert Backend.threadMayEnterPG() : m("measurePerClass thread");
+
+		Map<ClassCounts,long[]> sums = new IdentityHashMap<>();
+
+		for ( DualState s : s_unscopedInstances.keySet() )
+			measure(s, sums);
+
+		for ( DualState head : s_scopedInstances.values() )
+			for ( DualState s = head.m_next; s != head; s = s.m_next )
+				measure(s, sums);
+
+		for ( ClassCounts counts : s_perClass.values() )
+		{
+			long[] sum = sums.getOrDefault(counts, new long[2]);
+			counts.nativeBytes = sum[0];
+			counts.pendingRelease = sum[1];
+		}
+
+		return s_stats.getPerClass();
+	}
+
+	private static void measure(DualState s, Map<ClassCounts,long[]> sums)
+	{
+		long[] sum =
+			sums.computeIfAbsent(s_classCounts.get(s.getClass()),
+				k -> new long[2]);
+		int state = (int)s_stateVH.getVolatile(s);
+		if ( !z(JAVA_RELEASED & state)  ||  null == s.referent() )
+			++ sum[1];
+		if ( z(NATIVE_RELEASED & state) )
+			sum[0] += s.nativeBytes();
 	}
 
 	/**
@@ -1926,6 +2039,21 @@ public abstract class DualState<T> extends WeakReference<T>
 			return "%s GuardedLong(%x)";
 		}
 
+		@Override
+		final long nativeBytes()
+		{
+			return nativeBytes(m_guardedLong);
+		}
+
+		/**
+		 * Return the bytes of native memory held at the guarded value, which
+		 * has not been released; zero unless overridden.
+		 */
+		protected long nativeBytes(long guardedLong)
+		{
+			return 0L;
+		}
+
 		protected final long guardedLong()
 		{
 			assert pinnedByCurrentThread() : m("guardedLong() without pin");
@@ -1965,6 +2093,17 @@ public abstract class DualState<T> extends WeakReference<T>
 		}
 
 		private native void _pfree(long pointer);
+
+		/**
+		 * Return the bytes allocated for the chunk to be freed.
+		 */
+		@Override
+		protected long nativeBytes(long guardedLong)
+		{
+			return _nativeBytes(guardedLong);
+		}
+
+		private native long _nativeBytes(long pointer);
 	}
 
 	/**
@@ -2007,6 +2146,18 @@ public abstract class DualState<T> extends WeakReference<T>
 		}
 
 		private native void _memContextDelete(long pointer);
+
+		/**
+		 * Return the bytes allocated for the context and its descendants, on
+		 * PostgreSQL 13 and later.
+		 */
+		@Override
+		protected long nativeBytes(long guardedLong)
+		{
+			return _nativeBytes(guardedLong);
+		}
+
+		private native long _nativeBytes(long pointer);
 	}
 
 	/**
@@ -2043,6 +2194,17 @@ public abstract class DualState<T> extends WeakReference<T>
 		}
 
 		private native void _freeTupleDesc(long pointer);
+
+		/**
+		 * Return the bytes allocated for the descriptor.
+		 */
+		@Override
+		protected long nativeBytes(long guardedLong)
+		{
+			return _nativeBytes(guardedLong);
+		}
+
+		private native long _nativeBytes(long pointer);
 	}
 
 	/**
@@ -2079,6 +2241,17 @@ public abstract class DualState<T> extends WeakReference<T>
 		}
 
 		private native void _heapFreeTuple(long pointer);
+
+		/**
+		 * Return the bytes allocated for the tuple.
+		 */
+		@Override
+		protected long nativeBytes(long guardedLong)
+		{
+			return _nativeBytes(guardedLong);
+		}
+
+		private native long _nativeBytes(long pointer);
 	}
 
 	/**
@@ -2200,6 +2373,118 @@ public abstract class DualState<T> extends WeakReference<T>
 		 * or during an end-of-expression-context callback from the executor.
 		 */
 		private native void _spiCursorClose(long pointer);
+
+		/**
+		 * Return the bytes allocated for the portal's context, on PostgreSQL 13
+		 * and later.
+		 */
+		@Override
+		protected long nativeBytes(long guardedLong)
+		{
+			return _nativeBytes(guardedLong);
+		}
+
+		private native long _nativeBytes(long pointer);
+	}
+
+	/**
+	 * A {@code DualState} subclass whose only native resource releasing action
+	 * needed is {@code SPI_freetuptable} of a single pointer.
+	 *<p>
+	 * Unlike the other classes here, only an explicit release from Java frees
+	 * the native table. One that merely becomes unreachable is left for
+	 * {@code SPI_finish} to reclaim with the rest of the SPI procedure memory,
+	 * as the garbage collector may notice it while some other SPI connection is
+	 * current, which {@code SPI_freetuptable} would reject.
+	 */
+	public static abstract class SingleSPIfreetuptable<T>
+	extends SingleGuardedLong<T>
+	{
+		protected SingleSPIfreetuptable(
+			Key cookie, T referent, long resourceOwner, long fttTarget)
+		{
+			super(cookie, referent, resourceOwner, fttTarget);
+		}
+
+		@Override
+		public String formatString()
+		{
+			return "%s SPI_freetuptable(%x)";
+		}
+
+		/**
+		 * When the Java state is explicitly released, an
+		 * {@code SPI_freetuptable} call is made so the native memory is
+		 * released without having to wait for {@code SPI_finish}.
+		 */
+		@Override
+		protected void javaStateReleased(boolean nativeStateLive)
+		{
+			assert Backend.threadMayEnterPG();
+			if ( nativeStateLive )
+				_spiFreeTupTable(guardedLong());
+		}
+
+		private native void _spiFreeTupTable(long pointer);
+
+		/**
+		 * Return the bytes allocated for the table's context, on PostgreSQL 13
+		 * and later.
+		 */
+		@Override
+		protected long nativeBytes(long guardedLong)
+		{
+			return _nativeBytes(guardedLong);
+		}
+
+		private native long _nativeBytes(long pointer);
+	}
+
+	/**
+	 * Counts for one concrete {@code DualState} subclass.
+	 */
+	static class ClassCounts implements DualStateStatistics.PerClass
+	{
+		private final String m_className;
+		private final LongAdder constructed = new LongAdder();
+		private final LongAdder    released = new LongAdder();
+		private volatile long nativeBytes;
+		private volatile long pendingRelease;
+
+		ClassCounts(String className)
+		{
+			m_className = className;
+		}
+
+		public String getClassName()
+		{
+			return m_className;
+		}
+
+		public long getConstructed()
+		{
+			return constructed.sum();
+		}
+
+		public long getReleased()
+		{
+			return released.sum();
+		}
+
+		public long getLive()
+		{
+			return constructed.sum() - released.sum();
+		}
+
+		public long getNativeBytes()
+		{
+			return nativeBytes;
+		}
+
+		public long getPendingRelease()
+		{
+			return pendingRelease;
+		}
 	}
 
 	/**
@@ -2288,6 +2573,12 @@ public abstract class DualState<T> extends WeakReference<T>
 			return relRelRaces.sum();
 		}
 
+		public DualStateStatistics.PerClass[] getPerClass()
+		{
+			return s_perClass.values()
+				.toArray(new DualStateStatistics.PerClass[0]);
+		}
+
 
 		private LongAdder          constructed = new LongAdder();
 		private LongAdder       enlistedScoped = new LongAdder();
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2020-2021 Tada AB and other contributors, as listed below.
+ * Copyright (c) 2020-2026 Tada AB and other contributors, as listed below.
  *
  * All rights reserved. This program and the accompanying materials
  * are made available under the terms of the The BSD 3-Clause License
@@ -15,6 +15,8 @@ import java.lang.invoke.MethodHandle;
 import java.lang.invoke.MethodType;
 import static java.lang.invoke.MethodType.methodType;
 
+import java.nio.ByteBuffer;
+
 import java.security.AccessControlContext;
 import static java.security.AccessController.doPrivileged;
 import java.security.PrivilegedAction;
@@ -27,7 +29,14 @@ import java.sql.SQLInput;
 import java.sql.SQLOutput;
 
 import static java.util.Objects.requireNonNull;
+import java.util.PrimitiveIterator;
 
+import org.postgresql.pljava.BinarySQLData;
+import org.postgresql.pljava.PlannerSupport;
+import org.postgresql.pljava.ResultSetProvider;
+import org.postgresql.pljava.SortSupport;
+import org.postgresql.pljava.jdbc.ColumnBatchWriter;
+import org.postgresql.pljava.jdbc.PrimitiveBatchReader;
 import org.postgresql.pljava.internal.UncheckedException;
 import static org.postgresql.pljava.internal.UncheckedException.unchecked;
 
@@ -142,6 +151,19 @@ class EntryPoints
 		return new Invocable<PrivilegedAction<Object>>(a, acc);
 	}
 
+	/**
+	 * Like {@link #invocable(MethodHandle,AccessControlContext)}, for the
+	 * {@code Invocable} a value-per-call set-returning function's handle
+	 * makes over the Iterator or ResultSetProvider the function returned,
+	 * recording that object as the producer for the {@code srf*} entry points.
+	 */
+	static Invocable<?> invocable(
+		MethodHandle mh, Object producer, AccessControlContext acc)
+	{
+		Invocable<?> i = invocable(mh, acc);
+		return new Invocable<Object>(i.payload, acc, producer);
+	}
+
 	/**
 	 * Entry point for a general PL/Java function.
 	 * @param target Invocable obtained from Function.create that will
@@ -167,7 +189,7 @@ class EntryPoints
 	 * during a function's execution, if it stores values of user-defined type
 	 * into result sets, prepared-statement bindings, etc. Such uses are not
 	 * individually surrounded by {@code pushInvocation}/{@code popInvocation}
-	 * as ordinary function calls are, and the {@code ParameterFrame} save and
+	 * as ordinary function calls are, and the parameter frame save and
 	 * restore mechanism relies on those, so it is better for this entry point
 	 * also to be handled specially.
 	 * @param t Invocable carrying the appropriate AccessControlContext (t's
@@ -298,9 +320,324 @@ class EntryPoints
 		return doPrivilegedAndUnwrap(action, target.acc);
 	}
 
+	/**
+	 * Entry point for calling the {@code readBinary} method of a
+	 * {@link BinarySQLData} UDT, after constructing an instance first.
+	 *<p>
+	 * Otherwise like {@code udtReadInvoke}.
+	 * @param target an Invocable that returns a new instance, on which
+	 * readBinary will then be called.
+	 * @param src a copy of the UDT's internal representation, of which only a
+	 * read-only buffer view is passed to readBinary
+	 * @param typeName the SQL type name to be associated with the instance
+	 * @return the allocated and initialized instance
+	 */
+	private static SQLData udtReadBinaryInvoke(
+		Invocable<MethodHandle> target, byte[] src, String typeName)
+	throws Throwable
+	{
+		PrivilegedAction<SQLData> action = () ->
+		{
+			try
+			{
+				SQLData o = (SQLData)target.payload.invokeExact();
+				((BinarySQLData)o).readBinary(
+					ByteBuffer.wrap(src).asReadOnlyBuffer(), typeName);
+				return o;
+			}
+			catch ( Error | RuntimeException e )
+			{
+				throw e;
+			}
+			catch ( Throwable t )
+			{
+				throw unchecked(t);
+			}
+		};
+
+		return doPrivilegedAndUnwrap(action, target.acc);
+	}
+
+	/**
+	 * Entry point for calling the {@code binaryLength} method of a
+	 * {@link BinarySQLData} UDT, so the native code can allocate the space
+	 * {@code udtWriteBinaryInvoke} will then fill.
+	 * @param target Invocable carrying the appropriate AccessControlContext
+	 * (target's action is unused and expected to be null)
+	 * @param o the UDT instance
+	 * @return the length in bytes of its internal representation
+	 */
+	private static int udtBinaryLengthInvoke(Invocable<Void> target, SQLData o)
+	throws Throwable
+	{
+		PrivilegedAction<Integer> action = () ->
+		{
+			try
+			{
+				return ((BinarySQLData)o).binaryLength();
+			}
+			catch ( SQLException e )
+			{
+				throw unchecked(e);
+			}
+		};
+
+		return doPrivilegedAndUnwrap(action, target.acc);
+	}
+
+	/**
+	 * Entry point for calling the {@code writeBinary} method of a
+	 * {@link BinarySQLData} UDT.
+	 * @param target Invocable carrying the appropriate AccessControlContext
+	 * (target's action is unused and expected to be null)
+	 * @param o the UDT instance
+	 * @param dst an array of exactly the reported length, to hold the internal
+	 * representation until the native code copies it out
+	 * @return the number of bytes written, which the native code checks
+	 * against the length it allocated
+	 */
+	private static int udtWriteBinaryInvoke(
+		Invocable<Void> target, SQLData o, byte[] dst)
+	throws Throwable
+	{
+		PrivilegedAction<Integer> action = () ->
+		{
+			try
+			{
+				ByteBuffer b = ByteBuffer.wrap(dst);
+				((BinarySQLData)o).writeBinary(b);
+				return b.position();
+			}
+			catch ( SQLException e )
+			{
+				throw unchecked(e);
+			}
+		};
+
+		return doPrivilegedAndUnwrap(action, target.acc);
+	}
+
+	/**
+	 * Entry point for asking a function's {@link PlannerSupport} for an
+	 * estimate or simplification of a call being planned.
+	 *<p>
+	 * Like the UDT entry points, this is called without the static parameter
+	 * area, as planning can happen while a PL/Java function is executing.
+	 * @param target Invocable carrying the PlannerSupport instance and the
+	 * function's AccessControlContext
+	 * @param kind one of the {@code Function.SUPPORT_*} constants
+	 * @param values the values of the call's constant arguments, null where
+	 * not constant
+	 * @param constant which of the arguments are constant
+	 * @return for rows or cost, a Double, or null for no estimate; for
+	 * simplify, a one-element array holding the simplified value, or null
+	 * to leave the call as it is
+	 */
+	private static Object planSupportInvoke(
+		Invocable<PlannerSupport> target, int kind,
+		Object[] values, boolean[] constant)
+	throws Throwable
+	{
+		PlannerSupport s = target.payload;
+		PlannerSupport.Arguments args = new PlannerSupport.Arguments()
+		{
+			@Override
+			public int size()
+			{
+				return values.length;
+			}
+
+			@Override
+			public boolean isConstant(int index)
+			{
+				return constant[index];
+			}
+
+			@Override
+			public Object get(int index)
+			{
+				return values[index];
+			}
+		};
+
+		PrivilegedAction<Object> action = () ->
+		{
+			try
+			{
+				switch ( kind )
+				{
+				case Function.SUPPORT_ROWS:
+				case Function.SUPPORT_COST:
+					double d = Function.SUPPORT_ROWS == kind
+						? s.rows(args) : s.cost(args);
+					return 0 <= d ? (Object)d : null;
+				default:
+					Object o = s.simplify(args);
+					return PlannerSupport.NOT_SIMPLIFIED == o
+						? null : new Object[] { o };
+				}
+			}
+			catch ( SQLException e )
+			{
+				throw unchecked(e);
+			}
+		};
+
+		return doPrivilegedAndUnwrap(action, target.acc);
+	}
+
+	/**
+	 * Entry point asking a {@link SortSupport} whether it makes abbreviated
+	 * keys, as a sort is being set up.
+	 * @param target Invocable carrying the SortSupport instance and the
+	 * function's AccessControlContext
+	 */
+	private static boolean sortSupportAbbreviates(
+		Invocable<SortSupport<Object>> target)
+	throws Throwable
+	{
+		PrivilegedAction<Boolean> action = () -> target.payload.abbreviates();
+		return doPrivilegedAndUnwrap(action, target.acc);
+	}
+
+	/**
+	 * Entry point for a full comparison of two decoded values in a sort.
+	 *<p>
+	 * This and {@code sortSupportAbbreviate} are called from the comparator
+	 * and abbreviated-key converter that PostgreSQL calls while sorting,
+	 * not through a function call, and so do not use the static parameter
+	 * area.
+	 */
+	private static int sortSupportCompare(
+		Invocable<SortSupport<Object>> target, Object a, Object b)
+	throws Throwable
+	{
+		PrivilegedAction<Integer> action = () ->
+		{
+			try
+			{
+				return target.payload.compare(a, b);
+			}
+			catch ( SQLException e )
+			{
+				throw unchecked(e);
+			}
+		};
+
+		return doPrivilegedAndUnwrap(action, target.acc);
+	}
+
+	/**
+	 * Entry point for making the abbreviated key of a decoded value in a sort.
+	 */
+	private static long sortSupportAbbreviate(
+		Invocable<SortSupport<Object>> target, Object v)
+	throws Throwable
+	{
+		PrivilegedAction<Long> action = () ->
+		{
+			try
+			{
+				return target.payload.abbreviate(v);
+			}
+			catch ( SQLException e )
+			{
+				throw unchecked(e);
+			}
+		};
+
+		return doPrivilegedAndUnwrap(action, target.acc);
+	}
+
+	/**
+	 * Return the Iterator or ResultSetProvider a value-per-call Invocable was
+	 * made over, so the native code can choose how to gather its rows when
+	 * materializing them. No user code is run.
+	 */
+	private static Object srfProducer(Invocable<?> target)
+	{
+		return target.producer;
+	}
+
+	/**
+	 * Entry point for having a {@link ResultSetProvider.Batched} fill a batch
+	 * when the rows of its set are materialized.
+	 *<p>
+	 * This and the other {@code srf*} entry points are called with the
+	 * set-returning function's Invocable, so the user code runs under the
+	 * function's access control context, as it does when its rows are
+	 * requested one per call through {@code invoke}. Like the UDT entry
+	 * points, they do not use the static parameter area.
+	 * @return the number of rows filled, zero at the end
+	 */
+	private static int srfBatchFill(
+		Invocable<?> target, ColumnBatchWriter batch)
+	throws Throwable
+	{
+		ResultSetProvider.Batched p = (ResultSetProvider.Batched)target.producer;
+		PrivilegedAction<Integer> action = () ->
+		{
+			try
+			{
+				return batch.fill(p);
+			}
+			catch ( SQLException e )
+			{
+				throw unchecked(e);
+			}
+		};
+
+		return doPrivilegedAndUnwrap(action, target.acc);
+	}
+
+	/**
+	 * Entry point for having a {@link ResultSetProvider.Writing} write all its
+	 * rows, each flushed batch going to the native state <var>dest</var>.
+	 */
+	private static void srfWrite(
+		Invocable<?> target, ColumnBatchWriter batch, long dest)
+	throws Throwable
+	{
+		ResultSetProvider.Writing p = (ResultSetProvider.Writing)target.producer;
+		PrivilegedAction<Void> action = () ->
+		{
+			try
+			{
+				batch.write(p, dest);
+				return null;
+			}
+			catch ( SQLException e )
+			{
+				throw unchecked(e);
+			}
+		};
+
+		doPrivilegedAndUnwrap(action, target.acc);
+	}
+
+	/**
+	 * Entry point for reading a batch of values from a
+	 * {@code PrimitiveIterator} returned by a set-returning function.
+	 * @return the number of values read, zero at the end
+	 */
+	private static int srfPrimitiveFill(
+		Invocable<?> target, PrimitiveBatchReader reader)
+	throws Throwable
+	{
+		PrimitiveIterator<?,?> it = (PrimitiveIterator<?,?>)target.producer;
+		PrivilegedAction<Integer> action = () -> reader.fill(it);
+		return doPrivilegedAndUnwrap(action, target.acc);
+	}
+
 	/**
 	 * Factors out the common {@code doPrivileged} and unwrapping of possible
 	 * wrapped checked exceptions for the above entry points.
+	 *<p>
+	 * When no security manager is in force (as when running with
+	 * {@code org.postgresql.pljava.policy.enforcement=none}), an
+	 * {@code AccessControlContext} has no effect on what the action may do,
+	 * and the action is simply run, sparing every call the cost of
+	 * {@code doPrivileged}.
 	 */
 	private static <T> T doPrivilegedAndUnwrap(
 		PrivilegedAction<T> action, AccessControlContext context)
@@ -309,6 +646,8 @@ class EntryPoints
 		Throwable t;
 		try
 		{
+			if ( null == System.getSecurityManager() )
+				return action.run();
 			return doPrivileged(action, context);
 		}
 		catch ( ExceptionInInitializerError e )
@@ -374,6 +713,35 @@ class EntryPoints
 		return doPrivilegedAndUnwrap(action, acc);
 	}
 
+	/**
+	 * Called from {@code Function} to construct the {@link PlannerSupport} or
+	 * {@link SortSupport} instance named for a function, under the function's
+	 * access control context, returning it in an {@code Invocable} for
+	 * {@link #planSupportInvoke planSupportInvoke} or the
+	 * {@code sortSupport*} entry points.
+	 */
+	static <T> Invocable<T> providerInstance(
+		Class<? extends T> clazz, AccessControlContext acc)
+	throws SQLException
+	{
+		PrivilegedAction<T> action = () ->
+		{
+			try
+			{
+				return clazz.getConstructor().newInstance();
+			}
+			catch ( ReflectiveOperationException e )
+			{
+				throw unchecked(new SQLSyntaxErrorException(
+					"class " + clazz.getName() +
+					" must have a public constructor with no parameters" +
+					" that completes normally: " + e, "42P13", e));
+			}
+		};
+
+		return new Invocable<>(doPrivilegedAndUnwrap(action, acc), acc);
+	}
+
 	/**
 	 * A class carrying a payload of some kind and an access control context
 	 * to impose when it is invoked.
@@ -386,10 +754,22 @@ class EntryPoints
 		final T payload;
 		final AccessControlContext acc;
 
+		/**
+		 * For a value-per-call set-returning function's rows, the Iterator or
+		 * ResultSetProvider that produces them; otherwise null.
+		 */
+		final Object producer;
+
 		Invocable(T payload, AccessControlContext acc)
+		{
+			this(payload, acc, null);
+		}
+
+		Invocable(T payload, AccessControlContext acc, Object producer)
 		{
 			this.payload = payload;
 			this.acc = acc;
+			this.producer = producer;
 		}
 	}
 }
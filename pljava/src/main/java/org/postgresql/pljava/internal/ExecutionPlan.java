@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2004-2019 Tada AB and other contributors, as listed below.
+ * Copyright (c) 2004-2026 Tada AB and other contributors, as listed below.
  *
  * All rights reserved. This program and the accompanying materials
  * are made available under the terms of the The BSD 3-Clause License
@@ -14,10 +14,19 @@ package org.postgresql.pljava.internal;
 
 import static org.postgresql.pljava.internal.Backend.doInPG;
 
+import static java.lang.management.ManagementFactory.getPlatformMBeanServer;
+
 import java.sql.SQLException;
 import java.util.Collections;
+import java.util.Iterator;
 import java.util.Map;
 import java.util.LinkedHashMap;
+import java.util.concurrent.atomic.LongAdder;
+
+import javax.management.JMException;
+import javax.management.ObjectName;
+
+import org.postgresql.pljava.mbeans.PlanCacheStatistics;
 
 /**
  * The {@code ExecutionPlan} corresponds to the execution plan obtained
@@ -59,7 +68,9 @@ import java.util.LinkedHashMap;
  * SQL and parameter types; it will also happen if a {@code PreparedStatement}
  * using the plan becomes unreferenced and garbage-collected without
  * {@code close} being called (which would have moved the plan back to the
- * cache).
+ * cache). If {@code pljava.statement_cache_memory} is set, the oldest plans
+ * are also evicted while the cached plans together occupy more memory than
+ * that.
  * 
  * @author Thomas Hallgren
  */
@@ -74,6 +85,17 @@ public class ExecutionPlan
 	public static final short SPI_READONLY_FORCED  = 1;
 	public static final short SPI_READONLY_CLEARED = 2;
 
+	/* These three values must match those in ExecutionPlan.c */
+	public static final short PLAN_MODE_DEFAULT = 0;
+	public static final short PLAN_MODE_GENERIC = 1;
+	public static final short PLAN_MODE_CUSTOM  = 2;
+
+	/**
+	 * May be OR'd into a plan mode, to plan for a scrollable cursor (as by
+	 * {@code DECLARE ... SCROLL}), which can be fetched from in any direction.
+	 */
+	public static final short PLAN_SCROLL       = 4;
+
 	private final State m_state;
 
 	private static class State
@@ -85,6 +107,16 @@ public class ExecutionPlan
 			super(cookie, jep, ro, ep);
 		}
 
+		/**
+		 * Return the bytes used by the plan, as measured when it was saved.
+		 */
+		@Override
+		protected long nativeBytes(long guardedLong)
+		{
+			ExecutionPlan plan = referent();
+			return null == plan ? 0L : plan.m_bytes;
+		}
+
 		/**
 		 * Return the SPI execution-plan pointer.
 		 *<p>
@@ -119,15 +151,71 @@ public class ExecutionPlan
 	 * The key type is Object, not PlanKey, because for a statement with no
 	 * parameters, the statement itself is used as the key, rather than
 	 * constructing a PlanKey.
+	 *<p>
+	 * Keeps the total of its plans' {@code m_bytes}, and on each {@code put},
+	 * evicts the eldest entries while that exceeds its memory limit (if
+	 * nonzero), as well as when its size exceeds its count limit. The keys of
+	 * recently evicted plans are remembered, so that preparing one again can be
+	 * counted as a reprepare.
 	 */
 	static final class PlanCache extends LinkedHashMap<Object,ExecutionPlan>
 	{
 		private final int m_cacheSize;
 
-		public PlanCache(int cacheSize)
+		private final long m_cacheMemory;
+
+		private long m_bytes;
+
+		private final Map<Object,Boolean> m_evictedKeys;
+
+		public PlanCache(int cacheSize, long cacheMemory)
 		{
 			super(INITIAL_CACHE_CAPACITY, CACHE_LOAD_FACTOR, true);
 			m_cacheSize = cacheSize;
+			m_cacheMemory = cacheMemory;
+			m_evictedKeys = new LinkedHashMap<Object,Boolean>(
+				INITIAL_CACHE_CAPACITY, CACHE_LOAD_FACTOR, false)
+			{
+				@Override
+				protected boolean removeEldestEntry(
+					Map.Entry<Object,Boolean> eldest)
+				{
+					return size() > m_cacheSize;
+				}
+			};
+		}
+
+		@Override
+		public ExecutionPlan put(Object key, ExecutionPlan plan)
+		{
+			ExecutionPlan old = super.put(key, plan);
+			m_bytes += plan.m_bytes;
+			if ( null != old )
+			{
+				m_bytes -= old.m_bytes;
+				s_stats.evictions.increment();
+			}
+
+			if ( 0 < m_cacheMemory )
+			{
+				Iterator<ExecutionPlan> it = values().iterator();
+				while ( m_bytes > m_cacheMemory && it.hasNext() )
+				{
+					ExecutionPlan evicted = it.next();
+					it.remove();
+					evicted(evicted);
+				}
+			}
+			return old;
+		}
+
+		@Override
+		public ExecutionPlan remove(Object key)
+		{
+			ExecutionPlan plan = super.remove(key);
+			if ( null != plan )
+				m_bytes -= plan.m_bytes;
+			return plan;
 		}
 
 		@Override
@@ -138,11 +226,33 @@ public class ExecutionPlan
 				return false;
 
 			ExecutionPlan evicted = eldest.getValue();
+			evicted(evicted);
 			/*
 			 * See close() below for why 'evicted' is not enqueue()d right here.
 			 */
 			return true;
 		}
+
+		private void evicted(ExecutionPlan plan)
+		{
+			m_bytes -= plan.m_bytes;
+			m_evictedKeys.put(plan.m_key, Boolean.TRUE);
+			s_stats.evictions.increment();
+		}
+
+		/**
+		 * Note a miss for <var>key</var>, returning true if its plan had been
+		 * evicted recently.
+		 */
+		boolean missed(Object key)
+		{
+			return null != m_evictedKeys.remove(key);
+		}
+
+		long bytes()
+		{
+			return m_bytes;
+		}
 	};
 
 	static final class PlanKey
@@ -153,11 +263,14 @@ public class ExecutionPlan
 
 		private final Oid[] m_argTypes;
 
-		PlanKey(String stmt, Oid[] argTypes)
+		private final short m_planMode;
+
+		PlanKey(String stmt, Oid[] argTypes, short planMode)
 		{
 			m_stmt = stmt;
-			m_hashCode = stmt.hashCode() + 1;
+			m_hashCode = stmt.hashCode() + 1 + planMode;
 			m_argTypes = argTypes;
+			m_planMode = planMode;
 		}
 
 		public boolean equals(Object o)
@@ -166,7 +279,7 @@ public class ExecutionPlan
 				return false;
 
 			PlanKey pk = (PlanKey)o;
-			if(!pk.m_stmt.equals(m_stmt))
+			if(pk.m_planMode != m_planMode || !pk.m_stmt.equals(m_stmt))
 				return false;
 
 			Oid[] pat = pk.m_argTypes;
@@ -188,22 +301,49 @@ public class ExecutionPlan
 		}
 	}
 
+	private static final PlanCache s_planCacheImpl;
+
 	private static final Map<Object,ExecutionPlan> s_planCache;
 
+	private static final Statistics s_stats = new Statistics();
+
 	private final Object m_key;
 
+	/**
+	 * Approximate memory occupied by the native plan, measured when prepared.
+	 */
+	private final long m_bytes;
+
+	/**
+	 * Address of the native record of this plan's resolved parameter
+	 * {@code Type}s, which lives as long as the plan itself.
+	 */
+	private final long m_argTypes;
+
 	static
 	{
 		int cacheSize = Backend.getStatementCacheSize();
-		s_planCache = Collections.synchronizedMap(new PlanCache(cacheSize < 11
+		s_planCacheImpl = new PlanCache(cacheSize < 11
 			? 11
-			: cacheSize));
+			: cacheSize, Backend.getStatementCacheMemory());
+		s_planCache = Collections.synchronizedMap(s_planCacheImpl);
+
+		try
+		{
+			ObjectName n = new ObjectName(
+				"org.postgresql.pljava:type=ExecutionPlan," +
+				"name=PlanCacheStatistics");
+			getPlatformMBeanServer().registerMBean(s_stats, n);
+		}
+		catch ( JMException e ) { /* XXX */ }
 	}
 
 	private ExecutionPlan(DualState.Key cookie, long resourceOwner,
-		Object planKey, long spiPlan)
+		Object planKey, long spiPlan, long argTypes, long bytes)
 	{
 		m_key = planKey;
+		m_argTypes = argTypes;
+		m_bytes = bytes;
 		m_state = new State(cookie, this, resourceOwner, spiPlan);
 	}
 
@@ -241,10 +381,27 @@ public class ExecutionPlan
 	public Portal cursorOpen(
 		String cursorName, Object[] parameters, short read_only)
 	throws SQLException
+	{
+		return cursorOpen(cursorName, parameters, read_only, false);
+	}
+
+	/**
+	 * Set up a cursor as by {@link #cursorOpen(String,Object[],short)
+	 * cursorOpen}, optionally holdable.
+	 * 
+	 * @param hold Whether the cursor should be made holdable (as by
+	 *            {@code DECLARE ... WITH HOLD}), so it outlives the
+	 *            transaction that opened it, until it is closed.
+	 * @return The <code>Portal</code> that represents the opened cursor.
+	 * @throws SQLException If the underlying native structure has gone stale.
+	 */
+	public Portal cursorOpen(
+		String cursorName, Object[] parameters, short read_only, boolean hold)
+	throws SQLException
 	{
 		return doInPG(() ->
-			_cursorOpen(m_state.getExecutionPlanPtr(),
-				cursorName, parameters, read_only));
+			_cursorOpen(m_state.getExecutionPlanPtr(), m_argTypes,
+				cursorName, parameters, read_only, hold));
 	}
 
 	/**
@@ -263,6 +420,11 @@ public class ExecutionPlan
 
 	/**
 	 * Execute the plan using the internal <code>SPI_execp</code> function.
+	 *<p>
+	 * Only the count of rows is kept, in {@link SPI#getProcessed}; on
+	 * PostgreSQL 14 and later, rows the plan returns are discarded as they are
+	 * made, rather than held in {@code SPI_tuptable}, so a query meant to be
+	 * read should be run through {@link #cursorOpen cursorOpen} instead.
 	 * 
 	 * @param parameters Values for the parameters.
 	 * @param read_only One of the values {@code SPI_READONLY_DEFAULT},
@@ -279,10 +441,30 @@ public class ExecutionPlan
 	throws SQLException
 	{
 		return doInPG(() ->
-			_execute(m_state.getExecutionPlanPtr(),
+			_execute(m_state.getExecutionPlanPtr(), m_argTypes,
 				parameters, read_only, rowCount));
 	}
 
+	/**
+	 * Execute the plan once for each row of parameter values, in a single call
+	 * into native code.
+	 * Any rows the plan returns are discarded.
+	 * 
+	 * @param rows Values for the parameters, one array per execution.
+	 * @param read_only As for {@link #execute execute}.
+	 * @param rowCount As for {@link #execute execute}.
+	 * @return The number of rows processed by each execution.
+	 * @throws SQLException If the underlying native structure has gone stale,
+	 * or any execution fails.
+	 */
+	public long[] executeBatch(Object[][] rows, short read_only, int rowCount)
+	throws SQLException
+	{
+		return doInPG(() ->
+			_executeBatch(m_state.getExecutionPlanPtr(), m_argTypes,
+				rows, read_only, rowCount));
+	}
+
 	/**
 	 * Create an execution plan for a statement to be executed later using the
 	 * internal <code>SPI_prepare</code> function.
@@ -296,31 +478,117 @@ public class ExecutionPlan
 	public static ExecutionPlan prepare(String statement, Oid[] argTypes)
 	throws SQLException
 	{
-		Object key = (argTypes == null)
+		return prepare(statement, argTypes, PLAN_MODE_DEFAULT);
+	}
+
+	/**
+	 * Create an execution plan for a statement to be executed later, with
+	 * control over PostgreSQL's choice between custom and generic plans.
+	 * 
+	 * @param statement The command string.
+	 * @param argTypes SQL types of argument types.
+	 * @param planMode One of {@code PLAN_MODE_DEFAULT},
+	 *     {@code PLAN_MODE_GENERIC}, or {@code PLAN_MODE_CUSTOM}, optionally
+	 *     OR'd with {@code PLAN_SCROLL}.
+	 * @return An execution plan for the prepared statement.
+	 * @throws SQLException
+	 */
+	public static ExecutionPlan prepare(
+		String statement, Oid[] argTypes, short planMode)
+	throws SQLException
+	{
+		Object key = (argTypes == null && PLAN_MODE_DEFAULT == planMode)
 			? (Object)statement
-			: (Object)new PlanKey(statement, argTypes);
+			: (Object)new PlanKey(statement,
+				null == argTypes ? new Oid[0] : argTypes, planMode);
 
 		ExecutionPlan plan = s_planCache.remove(key);
-		if(plan == null)
-			plan = doInPG(() -> _prepare(key, statement, argTypes));
-		return plan;
+		if(plan != null)
+		{
+			s_stats.hits.increment();
+			return plan;
+		}
+
+		s_stats.misses.increment();
+		synchronized ( s_planCache )
+		{
+			if ( s_planCacheImpl.missed(key) )
+				s_stats.reprepares.increment();
+		}
+		return doInPG(() -> _prepare(key, statement, argTypes, planMode));
+	}
+
+	/**
+	 * Return the statistics of the plan cache.
+	 */
+	public static PlanCacheStatistics statistics()
+	{
+		return s_stats;
+	}
+
+	/**
+	 * Bean exposing the plan cache statistics for viewing in a JMX management
+	 * client.
+	 */
+	static class Statistics implements PlanCacheStatistics
+	{
+		final LongAdder hits = new LongAdder();
+		final LongAdder misses = new LongAdder();
+		final LongAdder evictions = new LongAdder();
+		final LongAdder reprepares = new LongAdder();
+
+		public long getHits()
+		{
+			return hits.sum();
+		}
+
+		public long getMisses()
+		{
+			return misses.sum();
+		}
+
+		public long getEvictions()
+		{
+			return evictions.sum();
+		}
+
+		public long getReprepares()
+		{
+			return reprepares.sum();
+		}
+
+		public int getEntries()
+		{
+			return s_planCache.size();
+		}
+
+		public long getBytes()
+		{
+			synchronized ( s_planCache )
+			{
+				return s_planCacheImpl.bytes();
+			}
+		}
 	}
 
 	/*
 	 * Not static, so the Portal can hold a live reference to us in case we are
 	 * evicted from the cache while it is still using the plan.
 	 */
-	private native Portal _cursorOpen(long pointer,
-		String cursorName, Object[] parameters, short read_only)
+	private native Portal _cursorOpen(long pointer, long argTypes,
+		String cursorName, Object[] parameters, short read_only, boolean hold)
 		throws SQLException;
 
 	private static native boolean _isCursorPlan(long pointer)
 	throws SQLException;
 
-	private static native int _execute(long pointer,
+	private static native int _execute(long pointer, long argTypes,
 		Object[] parameters, short read_only, int rowCount) throws SQLException;
 
+	private static native long[] _executeBatch(long pointer, long argTypes,
+		Object[][] rows, short read_only, int rowCount) throws SQLException;
+
 	private static native ExecutionPlan _prepare(
-		Object key, String statement, Oid[] argTypes)
+		Object key, String statement, Oid[] argTypes, short planMode)
 	throws SQLException;
 }
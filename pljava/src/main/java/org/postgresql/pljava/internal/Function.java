@@ -14,10 +14,12 @@ package org.postgresql.pljava.internal;
 import java.lang.invoke.MethodHandle;
 import java.lang.invoke.MethodHandles;
 import java.lang.invoke.MethodHandles.Lookup;
+import static java.lang.invoke.MethodHandles.arrayConstructor;
 import static java.lang.invoke.MethodHandles.arrayElementGetter;
 import static java.lang.invoke.MethodHandles.arrayElementSetter;
 import static java.lang.invoke.MethodHandles.collectArguments;
 import static java.lang.invoke.MethodHandles.constant;
+import static java.lang.invoke.MethodHandles.countedLoop;
 import static java.lang.invoke.MethodHandles.dropArguments;
 import static java.lang.invoke.MethodHandles.empty;
 import static java.lang.invoke.MethodHandles.exactInvoker;
@@ -54,6 +56,7 @@ import java.security.ProtectionDomain;
 
 import java.sql.ResultSet;
 import java.sql.SQLData;
+import java.sql.SQLDataException;
 import java.sql.SQLException;
 import java.sql.SQLFeatureNotSupportedException;
 import java.sql.SQLInput;
@@ -61,24 +64,31 @@ import java.sql.SQLOutput;
 import java.sql.SQLNonTransientException;
 import java.sql.SQLSyntaxErrorException;
 
-import static java.util.Arrays.copyOf;
 import static java.util.Collections.addAll;
+import java.util.HashMap;
 import java.util.Iterator;
 import java.util.LinkedList;
 import java.util.List;
 import java.util.Map;
 import java.util.Objects;
+import java.util.PrimitiveIterator;
 import java.util.Set;
 import java.util.regex.Matcher;
 import java.util.regex.Pattern;
 import static java.util.regex.Pattern.compile;
+import java.util.stream.BaseStream;
+import java.util.stream.DoubleStream;
+import java.util.stream.IntStream;
+import java.util.stream.LongStream;
 
 import javax.security.auth.Subject;
 import javax.security.auth.SubjectDomainCombiner;
 
 import org.postgresql.pljava.PLPrincipal;
+import org.postgresql.pljava.PlannerSupport;
 import org.postgresql.pljava.ResultSetHandle;
 import org.postgresql.pljava.ResultSetProvider;
+import org.postgresql.pljava.SortSupport;
 import org.postgresql.pljava.sqlgen.Lexicals.Identifier;
 
 import static org.postgresql.pljava.internal.Backend.doInPG;
@@ -86,9 +96,12 @@ import org.postgresql.pljava.internal.EntryPoints;
 import org.postgresql.pljava.internal.EntryPoints.Invocable;
 import static org.postgresql.pljava.internal.EntryPoints.invocable;
 import static org.postgresql.pljava.internal.EntryPoints.loadAndInitWithACC;
+import static org.postgresql.pljava.internal.EntryPoints.providerInstance;
 import static org.postgresql.pljava.internal.Privilege.doPrivileged;
+import static org.postgresql.pljava.jdbc.TypeOid.INTERNALOID;
 import static org.postgresql.pljava.jdbc.TypeOid.INVALID;
 import static org.postgresql.pljava.jdbc.TypeOid.TRIGGEROID;
+import static org.postgresql.pljava.jdbc.TypeOid.VOIDOID;
 import org.postgresql.pljava.management.Commands;
 import org.postgresql.pljava.sqlj.Loader;
 
@@ -315,6 +328,14 @@ public class Function
 			ex1 = e;
 		}
 
+		if ( isMultiCall  &&  Iterator.class == mt.returnType() )
+		{
+			MethodHandle h = primitiveSetHandle(clazz, methodName, mt,
+				loadClass(schemaLoader, jTypes[jTypes.length-1], acc));
+			if ( null != h )
+				return h;
+		}
+
 		MethodType origMT = mt;
 		Class<?> altType = null;
 		Class<?> realRetType =
@@ -386,6 +407,73 @@ public class Function
 			memberException(clazz, methodName, origMT, ex1, true /*isStatic*/);
 	}
 
+	/**
+	 * Find a set-returning method whose result is a primitive iterator or
+	 * stream of the set's element type (a {@code PrimitiveIterator.OfLong} or
+	 * {@code LongStream} for {@code long}, and likewise for {@code int} and
+	 * {@code double}), and return a handle presenting that as the
+	 * {@code Iterator} expected, or null if there is no such method.
+	 *<p>
+	 * Such an iterator is driven like any other, but in materialize mode
+	 * ({@code pljava.srf_materialize_rows}) the native code reads its values a
+	 * batch at a time without boxing them.
+	 */
+	private static MethodHandle primitiveSetHandle(
+		Class<?> clazz, String methodName, MethodType mt, Class<?> elemType)
+	{
+		Class<?> prim = methodType(elemType).unwrap().returnType();
+		Class<?> iter;
+		Class<?> stream;
+		if ( long.class == prim )
+		{
+			iter = PrimitiveIterator.OfLong.class;
+			stream = LongStream.class;
+		}
+		else if ( int.class == prim )
+		{
+			iter = PrimitiveIterator.OfInt.class;
+			stream = IntStream.class;
+		}
+		else if ( double.class == prim )
+		{
+			iter = PrimitiveIterator.OfDouble.class;
+			stream = DoubleStream.class;
+		}
+		else
+			return null;
+
+		Lookup l = lookupFor(clazz);
+		try
+		{
+			return l.findStatic(clazz, methodName, mt.changeReturnType(iter))
+				.asType(mt);
+		}
+		catch ( ReflectiveOperationException e )
+		{
+		}
+
+		try
+		{
+			MethodHandle h =
+				l.findStatic(clazz, methodName, mt.changeReturnType(stream));
+			h = h.asType(h.type().changeReturnType(BaseStream.class));
+			return filterReturnValue(h, s_streamIterator);
+		}
+		catch ( ReflectiveOperationException e )
+		{
+			return null;
+		}
+	}
+
+	/**
+	 * The iterator of a stream returned by a set-returning function, or null
+	 * if the function returned null.
+	 */
+	private static Iterator<?> streamIterator(BaseStream<?,?> s)
+	{
+		return null == s ? null : s.iterator();
+	}
+
 	/**
 	 * Produce an exception for a class member not found, with a message that
 	 * may include details from further down an exception's chain of causes.
@@ -645,6 +733,8 @@ public class Function
 	private static final MethodHandle s_nonNull;
 	private static final MethodHandle s_not;
 	private static final MethodHandle s_boxedNot;
+	private static final MethodHandle s_batchLength;
+	private static final MethodHandle s_batchAnyNull;
 
 	/*
 	 * Handles used to retrieve rows using SFRM_ValuePerCall protocol, from a
@@ -655,9 +745,18 @@ public class Function
 	private static final MethodHandle s_iteratorVPC;
 	private static final MethodHandle s_resultSetProviderVPC;
 	private static final MethodHandle s_wrapWithPicker;
+	private static final MethodHandle s_streamIterator;
 
 	private static final int s_sizeof_jvalue = 8; // Function.c StaticAssertStmt
 
+	/*
+	 * The kinds of planner support request passed from Function.c to
+	 * EntryPoints.planSupportInvoke.
+	 */
+	static final int SUPPORT_ROWS     = 0;
+	static final int SUPPORT_COST     = 1;
+	static final int SUPPORT_SIMPLIFY = 2;
+
 	/**
 	 * An {@code AccessControlContext} representing "nobody special": it should
 	 * enjoy whatever permissions the {@code Policy} grants to everyone, but no
@@ -693,8 +792,9 @@ public class Function
 	 * that happens before the target is invoked, and calls must happen on the
 	 * PG thread, the static areas are safe for reentrant calls (but for an edge
 	 * case involving UDTs among the parameters and a UDT function that incurs
-	 * a reentrant call; it may never happen, but that's what the ParameterFrame
-	 * class is for, below).
+	 * a reentrant call, for which the native code in Function.c saves the
+	 * in-progress contents on a stack of its own, and restores them when the
+	 * reentrant call returns).
 	 *
 	 * Such a constructed method handle will be passed, wrapped in
 	 * an Invocable, to EntryPoints.invoke, which is declared to return
@@ -716,91 +816,6 @@ public class Function
 		.order(ByteOrder.nativeOrder());
 	private static final int s_offset_paramCounts = 255 * s_sizeof_jvalue;
 
-	/**
-	 * Class used to stack parameters for an in-construction call if needed for
-	 * the (unlikely) re-entrant use of the static parameter area.
-	 *<p>
-	 * The need for this should be rare, as the only obvious cases for PL/Java
-	 * upcalls that can occur while assembling another call's parameter list
-	 * will be for UDTs that appear among those parameters. On the other hand,
-	 * nothing restricts what a UDT method is allowed to do, so in the unlikely
-	 * case it does something heavy enough to involve another upcall, there has
-	 * to be a way for that to work.
-	 */
-	static class ParameterFrame
-	{
-		private static ParameterFrame s_stack = null;
-		private ParameterFrame m_prev;
-		private Object[] m_refs;
-		private byte[] m_prims;
-
-		/**
-		 * Construct a copy of the current in-progress parameter area.
-		 */
-		private ParameterFrame()
-		{
-			short counts = s_primitiveParameters.getShort(s_offset_paramCounts);
-			assert 0 != counts : "ParameterFrame() called when no parameters";
-
-			int refs = counts >>> 8;
-			int prims = counts & 0xff;
-
-			if ( 0 < refs )
-				m_refs = copyOf(s_referenceParameters, refs);
-
-			if ( 0 < prims )
-			{
-				m_prims = new byte [ prims * s_sizeof_jvalue ];
-				// Java 13: s_primitiveParameters.get(0, m_prims);
-				s_primitiveParameters.get(m_prims).position(0);
-			}
-
-			m_prev = s_stack;
-		}
-
-		/**
-		 * Push a copy of the current in-progress parameter area; called only
-		 * via JNI.
-		 *<p>
-		 * Only happens on the PG thread.
-		 */
-		private static void push()
-		{
-			s_stack = new ParameterFrame();
-			s_primitiveParameters.putShort(s_offset_paramCounts, (short)0);
-		}
-
-		/**
-		 * Pop a stacked parameter frame; called only vi JNI, only when
-		 * the current invocation is known to have pushed one.
-		 */
-		private static void pop()
-		{
-			ParameterFrame f = s_stack;
-			s_stack = f.m_prev;
-
-			int refs = 0;
-			int prims = 0;
-
-			if ( null != f.m_refs )
-			{
-				refs = f.m_refs.length;
-				System.arraycopy(f.m_refs, 0, s_referenceParameters, 0, refs);
-			}
-
-			if ( null != f.m_prims )
-			{
-				int len = f.m_prims.length;
-				prims = len / s_sizeof_jvalue;
-				// Java 13: s_primitiveParameters.put(0, f.m_prims);
-				s_primitiveParameters.put(f.m_prims).position(0);
-			}
-
-			s_primitiveParameters.putShort(s_offset_paramCounts,
-				(short)((refs << 8) | (prims & 0xff)));
-		}
-	}
-
 	static
 	{
 		Lookup l = publicLookup();
@@ -848,6 +863,11 @@ public class Function
 
 			s_voidToNull = zero(Object.class);
 
+			mt = methodType(int.class, Object[].class);
+			s_batchLength = myL.findStatic(Function.class, "batchLength", mt);
+			mt = mt.changeReturnType(boolean.class);
+			s_batchAnyNull = myL.findStatic(Function.class, "batchAnyNull", mt);
+
 			mt = methodType(ByteBuffer.class, int.class, byte.class);
 			mh = l.findVirtual(ByteBuffer.class, "put", mt)
 				.bindTo(s_primitiveParameters);
@@ -937,19 +957,27 @@ public class Function
 			 * common part. It will have an extra first argument of type
 			 * MethodHandle that can be bound to the ResultSetProvider- or
 			 * Iterator-specific handle. If the user function returns null, so
-			 * will this.
+			 * will this. The new Invocable also records the Iterator or
+			 * ResultSetProvider itself, so the native code can drive a batched
+			 * or writing provider, or a primitive iterator, through the
+			 * EntryPoints srf* methods under the same acc.
 			 */
 
 			MethodHandle invocableMH =
 				myL.findStatic(EntryPoints.class, "invocable", methodType(
-					Invocable.class,
-					MethodHandle.class, AccessControlContext.class));
+					Invocable.class, MethodHandle.class, Object.class,
+					AccessControlContext.class));
 
 			mh = l.findVirtual(MethodHandle.class, "bindTo",
 					methodType(MethodHandle.class, Object.class));
 
 			mh = collectArguments(invocableMH, 0, mh);
-			// (hdl, obj, acc) -> Invocable(hdl-bound-to-obj, acc)
+			// (hdl, obj, producer, acc) -> Invocable(hdl-bound-to-obj, ...)
+
+			mh = permuteArguments(mh, methodType(Invocable.class,
+					MethodHandle.class, Object.class, AccessControlContext.class),
+				0, 1, 1, 2);
+			// (hdl, obj, acc) -> Invocable(hdl-bound-to-obj, obj, acc)
 
 			mh = guardWithTest(dropArguments(s_nonNull, 0, MethodHandle.class),
 				mh, empty(methodType(Invocable.class,
@@ -1113,6 +1141,9 @@ public class Function
 			mh = myL.findConstructor(ResultSetPicker.class, mt);
 			s_wrapWithPicker =
 				mh.asType(mh.type().changeReturnType(ResultSetProvider.class));
+
+			s_streamIterator = myL.findStatic(Function.class, "streamIterator",
+				methodType(Iterator.class, BaseStream.class));
 		}
 		catch ( ReflectiveOperationException e )
 		{
@@ -1197,6 +1228,151 @@ public class Function
 				(got >>> 8), (got & 0xff)));
 	}
 
+	/**
+	 * Return the common length of the argument arrays passed to a function
+	 * using the {@code [batch]} transformation, or throw an exception if they
+	 * differ.
+	 */
+	private static int batchLength(Object[] arrays) throws SQLException
+	{
+		int length = Array.getLength(arrays[0]);
+		for ( int i = 1 ; i < arrays.length ; ++ i )
+			if ( length != Array.getLength(arrays[i]) )
+				throw new SQLDataException(String.format(
+					"transformation [batch] requires arrays of equal length, " +
+					"argument %d has %d elements, argument 1 has %d",
+					i + 1, Array.getLength(arrays[i]), length), "2202E");
+		return length;
+	}
+
+	/**
+	 * Whether any argument array passed to a function using the
+	 * {@code [batch]} transformation is null, in which case the result is null.
+	 */
+	private static boolean batchAnyNull(Object[] arrays)
+	{
+		for ( Object a : arrays )
+			if ( null == a )
+				return true;
+		return false;
+	}
+
+	/**
+	 * Given the resolved types for a function using the {@code [batch]}
+	 * transformation, which must all be array types, return the corresponding
+	 * element types, to be used in finding the Java method.
+	 */
+	private static String[] batchElementTypes(String[] resolvedTypes)
+	throws SQLException
+	{
+		if ( 2 > resolvedTypes.length )
+			throw new SQLSyntaxErrorException(
+				"transformation [batch] requires at least one parameter",
+				"42P13");
+
+		String[] elementTypes = new String [ resolvedTypes.length ];
+		for ( int i = 0 ; i < resolvedTypes.length ; ++ i )
+		{
+			String t = resolvedTypes[i];
+			if ( ! t.endsWith("[]") )
+				throw new SQLSyntaxErrorException(
+					"transformation [batch] requires array parameter and " +
+					"return types, found " + t, "42P13");
+			elementTypes[i] = t.substring(0, t.length() - 2);
+		}
+		return elementTypes;
+	}
+
+	/**
+	 * Adapt the handle of a method that accepts and returns single values to
+	 * one that accepts equal-length arrays of those values, and returns an
+	 * array of the results, for the {@code [batch]} transformation.
+	 *<p>
+	 * The PostgreSQL calling convention offers no way to defer the result of
+	 * a scalar function from one row to the next, so the batching is explicit
+	 * in SQL: the caller aggregates the input values into arrays (with
+	 * {@code array_agg} or an {@code ARRAY} subquery, for example), and the
+	 * cost of crossing from PostgreSQL to Java, and of the parameter frame and
+	 * access control context setup that come with it, is paid once per batch
+	 * rather than once per element. Elements are passed to the method in
+	 * order, by a loop entirely in the method handle tree.
+	 *<p>
+	 * If any of the arrays is null, the result is null and the method is not
+	 * called.
+	 */
+	private static MethodHandle batchHandle(
+		MethodHandle mh, ClassLoader schemaLoader, String[] resolvedTypes)
+	throws SQLException
+	{
+		int n = resolvedTypes.length - 1;
+		Class<?>[] arrays = new Class<?> [ n ];
+		Class<?>[] elements = new Class<?> [ n ];
+		for ( int i = 0 ; i < n ; ++ i )
+		{
+			arrays[i] = loadClass(schemaLoader, resolvedTypes[i], null);
+			elements[i] = arrays[i].getComponentType();
+		}
+		Class<?> retArray = loadClass(schemaLoader, resolvedTypes[n], null);
+		Class<?> retElement = retArray.getComponentType();
+
+		try
+		{
+			mh = mh.asType(methodType(retElement, elements));
+		}
+		catch ( WrongMethodTypeException e )
+		{
+			throw new SQLSyntaxErrorException(
+				"wrong parameter or return type for transformation [batch]: " +
+				e.getMessage(), "42P13", e);
+		}
+
+		MethodType arraysType = methodType(retArray, arrays);
+
+		/*
+		 * Make each parameter an (array, index) pair, then permute so a single
+		 * leading index is shared: (int, a0[], ..., an-1[]) -> element result.
+		 */
+		for ( int i = n ; i --> 0 ; )
+			mh = collectArguments(mh, i, arrayElementGetter(arrays[i]));
+		int[] reorder = new int [ 2 * n ];
+		for ( int i = 0 ; i < n ; ++ i )
+		{
+			reorder [ 2 * i ] = i + 1;
+			reorder [ 2 * i + 1 ] = 0;
+		}
+		mh = permuteArguments(mh, arraysType
+			.changeReturnType(retElement)
+			.insertParameterTypes(0, int.class), reorder);
+
+		/*
+		 * Loop body: (result[], int, a0[], ..., an-1[]) -> result[], storing
+		 * the element result at the index and returning the same result array.
+		 */
+		MethodType bodyType =
+			arraysType.insertParameterTypes(0, retArray, int.class);
+		mh = collectArguments(arrayElementSetter(retArray), 2, mh);
+		int[] merge = new int [ 3 + n ];
+		merge [ 1 ] = merge [ 2 ] = 1;
+		for ( int i = 0 ; i < n ; ++ i )
+			merge [ 3 + i ] = 2 + i;
+		mh = permuteArguments(mh, bodyType.changeReturnType(void.class), merge);
+		MethodHandle body = foldArguments(dropArguments(identity(retArray), 1,
+			bodyType.parameterList().subList(1, n + 2)), mh);
+
+		MethodHandle iterations = s_batchLength
+			.asCollector(Object[].class, n)
+			.asType(arraysType.changeReturnType(int.class));
+		MethodHandle init =
+			collectArguments(arrayConstructor(retArray), 0, iterations);
+
+		return guardWithTest(
+			s_batchAnyNull
+				.asCollector(Object[].class, n)
+				.asType(arraysType.changeReturnType(boolean.class)),
+			dropArguments(zero(retArray), 0, arrays),
+			countedLoop(iterations, init, body));
+	}
+
 	/**
 	 * Return an {@code Invocable} for the {@code writeSQL} method of
 	 * a given UDT class.
@@ -1205,7 +1381,7 @@ public class Function
 	 * another function call as the UDT-read handle would be, it can still be
 	 * used during a function's execution and without being separately wrapped
 	 * in {@code pushInvocation}/{@code popInvocation}. The pushing and popping
-	 * of {@code ParameterFrame} rely on invocation scoping, so it is better for
+	 * of saved parameter frames rely on invocation scoping, so it is better for
 	 * the UDT-write method also to avoid using the static parameter area.
 	 *<p>
 	 * The access control context of the {@code Invocable} returned here is used
@@ -1370,6 +1546,10 @@ public class Function
 		String language, boolean trusted)
 	throws SQLException
 	{
+		if ( null != info.group("srtcls") )
+			return setupSortSupport(
+				wrappedPtr, info, procTup, schema, language, trusted);
+
 		Map<Oid,Class<? extends SQLData>> typeMap = null;
 		String className = info.group("udtcls");
 		boolean isUDT = (null != className);
@@ -1412,12 +1592,16 @@ public class Function
 		boolean retTypeIsOutParameter = false;
 		boolean commute = (null != info.group("com"));
 		boolean negate  = (null != info.group("neg"));
+		boolean batch   = (null != info.group("bat"));
 
 		if ( forValidator )
 			calledAsTrigger = isTrigger(procTup);
 
 		if ( calledAsTrigger )
 		{
+			if ( batch )
+				throw new SQLSyntaxErrorException(
+					"transformation [batch] not valid for a trigger", "42P13");
 			typeMap = null;
 			resolvedTypes =	setupTriggerParams(
 				wrappedPtr, info, schemaLoader, clazz, readOnly);
@@ -1427,17 +1611,57 @@ public class Function
 			boolean[] multi = new boolean[] { isMultiCall };
 			boolean[] rtiop = new boolean[] { retTypeIsOutParameter };
 			resolvedTypes = setupFunctionParams(wrappedPtr, info, procTup,
-				schemaLoader, clazz, readOnly, typeMap, multi, rtiop, commute);
+				schemaLoader, clazz, readOnly, typeMap, multi, rtiop, commute,
+				batch);
 			isMultiCall = multi [ 0 ];
 			retTypeIsOutParameter = rtiop [ 0 ];
 		}
 
+		if ( batch  &&  ( isMultiCall || retTypeIsOutParameter ) )
+			throw new SQLSyntaxErrorException(
+				"transformation [batch] not valid for a set-returning or " +
+				"composite-returning function", "42P13");
+
+		if ( null != info.group("memo") )
+		{
+			int memoize = Integer.parseInt(info.group("memo"));
+			if ( calledAsTrigger || isMultiCall || retTypeIsOutParameter )
+				throw new SQLSyntaxErrorException(
+					"transformation [memoize] not valid for a trigger, or a " +
+					"set-returning or composite-returning function", "42P13");
+			if ( (byte)'i' != procTup.getByte("provolatile") )
+				throw new SQLSyntaxErrorException(
+					"transformation [memoize] requires an IMMUTABLE function",
+					"42P13");
+			if ( 0 < memoize )
+				doInPG(() -> _setMemoize(wrappedPtr, memoize));
+		}
+
+		Invocable<PlannerSupport> support = null;
+		if ( null != info.group("sup") )
+		{
+			if ( calledAsTrigger )
+				throw new SQLSyntaxErrorException(
+					"transformation [support] not valid for a trigger",
+					"42P13");
+			Class<?> supportClass =
+				loadClass(schemaLoader, info.group("sup"), null);
+			if ( ! PlannerSupport.class.isAssignableFrom(supportClass) )
+				throw new SQLSyntaxErrorException(
+					"transformation [support] names class " +
+					supportClass.getName() + ", which does not implement " +
+					PlannerSupport.class.getName(), "42P13");
+			support = providerInstance(
+				supportClass.asSubclass(PlannerSupport.class), acc);
+		}
+
 		String methodName = info.group("meth");
 
 		MethodHandle handle =
 			getMethodHandle(schemaLoader, clazz, methodName,
 				null, // or acc to initialize parameter classes; overkill.
-				commute, resolvedTypes, retTypeIsOutParameter, isMultiCall)
+				commute, batch ? batchElementTypes(resolvedTypes)
+					: resolvedTypes, retTypeIsOutParameter, isMultiCall)
 			.asFixedArity();
 		MethodType mt = handle.type();
 
@@ -1468,6 +1692,9 @@ public class Function
 			handle = filterReturnValue(handle, inverter);
 		}
 
+		if ( batch )
+			handle = batchHandle(handle, schemaLoader, resolvedTypes);
+
 		handle = adaptHandle(handle);
 
 		if ( isMultiCall )
@@ -1477,9 +1704,63 @@ public class Function
 		else
 			handle = dropArguments(handle, 0, AccessControlContext.class);
 
+		/*
+		 * Handed to the C structure only now, when nothing more can fail and
+		 * leave it to be freed without its finalizer.
+		 */
+		if ( null != support )
+		{
+			Invocable<PlannerSupport> s = support;
+			doInPG(() -> _setSupport(wrappedPtr, s));
+		}
+
 		return invocable(handle, acc);
 	}
 
+	/**
+	 * Set up a function declared with {@code AS 'sortsupport[class]'}, the
+	 * sort support function of a {@code btree} operator class, whose named
+	 * class implements {@link SortSupport}.
+	 *<p>
+	 * The SQL type being sorted is not known here; the native code finds it
+	 * from the operator class when the function is first called.
+	 * @return an Invocable with no target, as the function is only ever
+	 * handled by the native code
+	 */
+	private static Invocable<?> setupSortSupport(
+		long wrappedPtr, Matcher info, ResultSet procTup,
+		Identifier.Simple schema, String language, boolean trusted)
+	throws SQLException
+	{
+		Oid[] paramTypes = (Oid[])procTup.getObject("proargtypes");
+		if ( 1 != paramTypes.length
+			|| INTERNALOID != paramTypes[0].intValue()
+			|| VOIDOID != procTup.getInt("prorettype") )
+			throw new SQLSyntaxErrorException(
+				"a sortsupport function must take internal and return void",
+				"42P13");
+
+		String className = info.group("srtcls");
+		ClassLoader schemaLoader = Loader.getSchemaLoader(schema);
+		Class<?> clazz = loadClass(schemaLoader, className, null);
+		if ( ! SortSupport.class.isAssignableFrom(clazz) )
+			throw new SQLSyntaxErrorException(
+				"sortsupport class " + className + " does not implement " +
+				SortSupport.class.getName(), "42P13");
+
+		AccessControlContext acc =
+			accessControlContextFor(clazz, language, trusted);
+		Invocable<?> support =
+			providerInstance(clazz.asSubclass(SortSupport.class), acc);
+		Map<Oid,Class<? extends SQLData>> typeMap = Loader.getTypeMap(schema);
+
+		doInPG(() ->
+			_storeToSortSupport(wrappedPtr, schemaLoader, clazz, typeMap,
+				support));
+
+		return invocable(null, acc);
+	}
+
 	/**
 	 * Determine from a function's {@code pg_proc} entry whether it is a
 	 * trigger function.
@@ -1507,9 +1788,35 @@ public class Function
 	 * conditions. No exception is made here for the few functions supplied by
 	 * PL/Java's own {@code Commands} class; they get a lid. It is reasonable to
 	 * ask them to use {@code doPrivileged} when appropriate.
+	 *<p>
+	 * The context depends only on whether the class was loaded by a PL/Java
+	 * {@code Loader} and on the language and its trust, so one is built for
+	 * each such combination and kept in {@link #s_accCache} for every function
+	 * after the first to share.
 	 */
 	private static AccessControlContext accessControlContextFor(
 		Class<?> clazz, String language, boolean trusted)
+	{
+		boolean fromLoader = clazz.getClassLoader() instanceof Loader;
+		String key = (fromLoader ? "L" : "J") + (trusted ? "+" : "-")
+			+ (null == language ? "" : ":" + language);
+
+		return s_accCache.computeIfAbsent(key,
+			k -> buildAccessControlContext(fromLoader, language, trusted));
+	}
+
+	/**
+	 * Cache of contexts built by {@link #buildAccessControlContext}, only
+	 * used on the PG thread.
+	 */
+	private static final Map<String,AccessControlContext> s_accCache =
+		new HashMap<>();
+
+	/**
+	 * Build the context described at {@link #accessControlContextFor}.
+	 */
+	private static AccessControlContext buildAccessControlContext(
+		boolean fromLoader, String language, boolean trusted)
 	{
 		Set<Principal> p =
 			(null == language)
@@ -1520,15 +1827,12 @@ public class Function
 				: new PLPrincipal.Unsandboxed(language)
 			);
 
-		AccessControlContext acc = clazz.getClassLoader() instanceof Loader
+		AccessControlContext acc = fromLoader
 			? s_noLid // policy already applies appropriate permissions
 			: p.isEmpty() // put a lid on permissions if calling JRE directly
 			? s_lid
 			: lidWithPrincipals(p.toArray(new Principal[1]));
 
-		/*
-		 * A cache to avoid the following machinations might be good.
-		 */
 		return doPrivileged(() ->
 			new AccessControlContext(acc, new SubjectDomainCombiner(
 				new Subject(true, p, Set.of(), Set.of()))));
@@ -1565,8 +1869,17 @@ public class Function
 			break;
 		case 's':
 		case 'o':
+		case 'h':
 			udtId = ((Oid[])procTup.getObject("proargtypes"))[0];
 			break;
+		case 'e':
+			Oid[] args = (Oid[])procTup.getObject("proargtypes");
+			udtId = args[0];
+			if ( 2 != args.length  ||  ! udtId.equals(args[1]) )
+				throw new SQLSyntaxErrorException(
+					"UDT equals function must take two arguments of the UDT",
+					"42P13");
+			break;
 		default:
 			throw new SQLException("internal error in PL/Java UDT parsing");
 		}
@@ -1606,7 +1919,8 @@ public class Function
 		long wrappedPtr, Matcher info, ResultSet procTup,
 		ClassLoader schemaLoader, Class<?> clazz,
 		boolean readOnly, Map<Oid,Class<? extends SQLData>> typeMap,
-		boolean[] multi, boolean[] returnTypeIsOP, boolean commute)
+		boolean[] multi, boolean[] returnTypeIsOP, boolean commute,
+		boolean batch)
 		throws SQLException
 	{
 		int numParams = procTup.getInt("pronargs");
@@ -1636,7 +1950,7 @@ public class Function
 			 * resolvedTypes that the mapping from SQL types suggested above.
 			 */
 			parseParameters( wrappedPtr, resolvedTypes, explicitSignature,
-				isMultiCall, returnTypeIsOutputParameter, commute);
+				isMultiCall, returnTypeIsOutputParameter, commute, batch);
 		}
 
 		/* As in the original C setupFunctionParams, if an explicit Java return
@@ -1655,7 +1969,8 @@ public class Function
 		 * original behavior.
 		 */
 
-		String explicitReturnType = info.group("ret");
+		String explicitReturnType = batch && null != info.group("ret")
+			? info.group("ret") + "[]" : info.group("ret");
 		if ( null != explicitReturnType )
 		{
 			String resolvedReturnType = resolvedTypes[resolvedTypes.length - 1];
@@ -1683,13 +1998,21 @@ public class Function
 	private static void parseParameters(
 		long wrappedPtr, String[] resolvedTypes, String explicitSignature,
 		boolean isMultiCall, boolean returnTypeIsOutputParameter,
-		boolean commute)
+		boolean commute, boolean batch)
 		throws SQLException
 	{
 		boolean lastIsOut = ( ! isMultiCall ) && returnTypeIsOutputParameter;
 		String[] explicitTypes = explicitSignature.isEmpty() ?
 			new String[0] : COMMA.split(explicitSignature);
 
+		/*
+		 * With [batch], the explicit signature names the element types the
+		 * Java method accepts; the SQL parameters are arrays of those.
+		 */
+		if ( batch )
+			for ( int i = 0 ; i < explicitTypes.length ; ++ i )
+				explicitTypes[i] += "[]";
+
 		int expect = resolvedTypes.length - (lastIsOut ? 0 : 1);
 
 		if ( expect != explicitTypes.length )
@@ -1866,13 +2189,20 @@ public class Function
 	 */
 	private static final Pattern specForms = compile(String.format(
 		/* the UDT notation, which is case insensitive */
-		"(?i:udt\\[(?<udtcls>%1$s)\\](?<udtfun>input|output|receive|send))" +
+		"(?i:udt\\[(?<udtcls>%1$s)\\](?<udtfun>input|output|receive|send|equals|hash))" +
+
+		/* or the sort support form, also case insensitive */
+		"|(?i:sortsupport\\[(?<srtcls>%1$s)\\])" +
 
 		/* or the non-UDT form (which can't begin, insensitively, with UDT) */
 		"|(?!(?i:udt\\[))" +
-		/* allow a prefix like [commute] or [negate] or [commute,negate] */
+		/* allow a prefix like [commute] or [negate] or [commute,negate],
+		 * or [batch] or [memoize=n] or [support=class] in any combination
+		 * with those */
 		"(?:\\[(?:" +
-			"(?:(?:(?<com>commute)|(?<neg>negate))(?:(?=\\])|,(?!\\])))" +
+			"(?:(?:(?<com>commute)|(?<neg>negate)|(?<bat>batch)" +
+			"|memoize=(?<memo>\\d{1,7}+)|support=(?<sup>%1$s))" +
+			"(?:(?=\\])|,(?!\\])))" +
 		")++\\])?+" +
 		/* and the long-standing method spec syntax */
 		"(?:(?<ret>%2$s)=)?+(?<cls>%1$s)\\.(?<meth>%3$s)" +
@@ -2087,6 +2417,15 @@ public class Function
 		Class<? extends SQLData> clazz,
 		boolean readOnly, int funcInitial, int udtOid);
 
+	private static native void _setMemoize(long wrappedPtr, int size);
+
+	private static native void _setSupport(
+		long wrappedPtr, Invocable<PlannerSupport> support);
+
+	private static native void _storeToSortSupport(
+		long wrappedPtr, ClassLoader schemaLoader, Class<?> clazz,
+		Map<Oid,Class<? extends SQLData>> typeMap, Invocable<?> support);
+
 	private static native void _reconcileTypes(
 		long wrappedPtr, String[] resolvedTypes, String[] explicitTypes, int i);
 }
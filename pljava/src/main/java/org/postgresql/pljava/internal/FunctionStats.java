@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+package org.postgresql.pljava.internal;
+
+import static java.lang.management.ManagementFactory.getPlatformMBeanServer;
+import java.lang.annotation.Native;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.LongBuffer;
+
+import javax.management.JMException;
+import javax.management.ObjectName;
+
+import org.postgresql.pljava.mbeans.FunctionStatistics;
+import org.postgresql.pljava.mbeans.FunctionStatistics.Timing;
+
+/**
+ * Java side of the per-function timings Function.c keeps while
+ * {@code pljava.track_functions} is on.
+ *<p>
+ * The native code keeps the counts in an array of slots of
+ * {@code s_slotLongs} longs each, which it hands over as a direct buffer the
+ * first time it tracks a call. The first slot is a header, holding the number
+ * of slots in use and the count of untracked calls; each other slot in use
+ * holds one function's counts. The array is only written by the PG thread
+ * and is read here without any locking, so a reading on another thread (as
+ * through JMX) does not have to wait for the PG thread, at the cost of
+ * possibly seeing a function's counts partly updated.
+ */
+public class FunctionStats
+{
+	private FunctionStats() { }
+
+	@Native private static final int s_slotLongs = 8;
+	@Native private static final int s_capacity = 1023;
+
+	@Native private static final int s_header_used = 0;
+	@Native private static final int s_header_untracked = 1;
+
+	@Native private static final int s_oid = 0;
+	@Native private static final int s_calls = 1;
+	@Native private static final int s_totalNanos = 2;
+	@Native private static final int s_maxNanos = 3;
+	@Native private static final int s_javaNanos = 4;
+	@Native private static final int s_argumentNanos = 5;
+	@Native private static final int s_returnNanos = 6;
+	@Native private static final int s_memoHits = 7;
+
+	private static volatile LongBuffer s_slots;
+
+	private static final Statistics s_stats = new Statistics();
+
+	/**
+	 * Called from the native code with the slot array, when it is allocated.
+	 */
+	private static void publish(ByteBuffer slots)
+	{
+		s_slots = slots.order(ByteOrder.nativeOrder()).asLongBuffer();
+
+		try
+		{
+			ObjectName n = new ObjectName(
+				"org.postgresql.pljava:type=Function,name=FunctionStatistics");
+			getPlatformMBeanServer().registerMBean(s_stats, n);
+		}
+		catch ( JMException e ) { /* XXX */ }
+	}
+
+	/**
+	 * Return the statistics of the functions tracked in this session.
+	 */
+	public static FunctionStatistics statistics()
+	{
+		return s_stats;
+	}
+
+	/**
+	 * Bean exposing the function timings for viewing in a JMX management
+	 * client.
+	 */
+	static class Statistics implements FunctionStatistics
+	{
+		public int getCapacity()
+		{
+			return s_capacity;
+		}
+
+		public long getUntrackedCalls()
+		{
+			LongBuffer slots = s_slots;
+			return null == slots ? 0L : slots.get(s_header_untracked);
+		}
+
+		public Timing[] getFunctions()
+		{
+			LongBuffer slots = s_slots;
+			if ( null == slots )
+				return new Timing[0];
+
+			int used = (int)Math.min(s_capacity, slots.get(s_header_used));
+			Timing[] result = new Timing[used];
+			for ( int i = 0; i < used; ++ i )
+			{
+				int base = (1 + i) * s_slotLongs;
+				long[] counts = new long [ s_slotLongs ];
+				for ( int j = 0; j < s_slotLongs; ++ j )
+					counts[j] = slots.get(base + j);
+				result[i] = new Counts(counts);
+			}
+			return result;
+		}
+	}
+
+	/**
+	 * One function's counts, copied out of its slot.
+	 */
+	static class Counts implements Timing
+	{
+		private final long[] m_counts;
+
+		Counts(long[] counts)
+		{
+			m_counts = counts;
+		}
+
+		public long getOid()           { return m_counts[s_oid]; }
+		public long getCalls()         { return m_counts[s_calls]; }
+		public long getTotalNanos()    { return m_counts[s_totalNanos]; }
+		public long getMaxNanos()      { return m_counts[s_maxNanos]; }
+		public long getJavaNanos()     { return m_counts[s_javaNanos]; }
+		public long getArgumentNanos() { return m_counts[s_argumentNanos]; }
+		public long getReturnNanos()   { return m_counts[s_returnNanos]; }
+		public long getMemoHits()      { return m_counts[s_memoHits]; }
+	}
+}
@@ -645,6 +645,29 @@ public class InstallHelper
 				"sqlj.java_validator(pg_catalog.oid) IS '" +
 				"Function declaration validator for PL/Java''s " +
 				"trusted/sandboxed language.'");
+
+		s.execute(
+			"CREATE OR REPLACE FUNCTION sqlj.java_support(pg_catalog.internal)" +
+			" RETURNS pg_catalog.internal" +
+			" AS " + eQuote(module_path) +
+			" LANGUAGE C");
+		s.execute("REVOKE ALL PRIVILEGES" +
+			" ON FUNCTION sqlj.java_support(pg_catalog.internal) FROM public");
+		rs = s.executeQuery(
+			"SELECT pg_catalog.obj_description(CAST(" +
+			"'sqlj.java_support(pg_catalog.internal)' " +
+			"AS pg_catalog.regprocedure), " +
+			"'pg_proc')");
+		rs.next();
+		rs.getString(1);
+		noComment = rs.wasNull();
+		rs.close();
+		if ( noComment )
+			s.execute(
+				"COMMENT ON FUNCTION " +
+				"sqlj.java_support(pg_catalog.internal) IS '" +
+				"Planner support function for PL/Java functions declared " +
+				"with a PlannerSupport class.'");
 	}
 
 	/**
@@ -821,6 +844,10 @@ public class InstallHelper
 	throws SQLException
 	{
 		DatabaseMetaData md = c.getMetaData();
+
+		if ( hasColumn( md, "background_job", null) )
+			return SchemaVariant.UNREL20261015;
+
 		try (
 			ResultSet rs =
 				md.getProcedures( null, "sqlj", "alias_java_language")
@@ -926,10 +953,22 @@ public class InstallHelper
 	 * up to date.
 	 */
 	private static final SchemaVariant currentSchema =
-		SchemaVariant.REL_1_6_0;
+		SchemaVariant.UNREL20261015;
 
 	private enum SchemaVariant
 	{
+		UNREL20261015 ("8044d47a146cf88d0b6d1bac051e2ce241a0c116")
+		{
+			@Override
+			void migrateFrom( SchemaVariant sv, Connection c, Statement s)
+			throws SQLException
+			{
+				if ( REL_1_6_0 != sv )
+					REL_1_6_0.migrateFrom( sv, c, s);
+
+				deployViaDescriptor( c, s, "background_job");
+			}
+		},
 		REL_1_6_0 ("5565a3c9c4b8d6dd0b0f7fff4090d4e8120dc10a")
 		{
 			@Override
@@ -0,0 +1,278 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+package org.postgresql.pljava.internal;
+
+import java.security.AccessControlContext;
+import static java.security.AccessController.getContext;
+
+import java.sql.SQLException;
+
+import java.util.ArrayList;
+import java.util.Collection;
+import java.util.List;
+import java.util.Queue;
+import java.util.Set;
+import java.util.concurrent.Callable;
+import java.util.concurrent.CancellationException;
+import java.util.concurrent.ConcurrentHashMap;
+import java.util.concurrent.ConcurrentLinkedQueue;
+import java.util.concurrent.ExecutionException;
+import java.util.concurrent.ForkJoinPool;
+import java.util.concurrent.ForkJoinTask;
+import java.util.concurrent.ForkJoinWorkerThread;
+import java.util.concurrent.Future;
+import static java.util.concurrent.TimeUnit.MILLISECONDS;
+import java.util.concurrent.TimeoutException;
+
+import org.postgresql.pljava.ParallelCompute;
+
+import static org.postgresql.pljava.internal.Privilege.doPrivileged;
+
+/**
+ * Implementation of {@link ParallelCompute}, one instance per invocation that
+ * asks for one, all sharing one {@code ForkJoinPool} created for the session
+ * when first needed.
+ */
+public class ParallelComputeImpl implements ParallelCompute
+{
+	/**
+	 * The class of the pool's worker threads, recognized by
+	 * {@code Backend.doInPG} to refuse them entry to PostgreSQL.
+	 *<p>
+	 * A worker is created with PL/Java's own access control context and no
+	 * context class loader, whatever thread's submission led to its creation;
+	 * each task sets those it runs with for itself.
+	 */
+	static final class Worker extends ForkJoinWorkerThread
+	{
+		Worker(ForkJoinPool pool)
+		{
+			super(pool);
+			setName("PL/Java compute " + getPoolIndex());
+			setContextClassLoader(null);
+		}
+	}
+
+	/**
+	 * How long {@code close} waits on a task before looking again for
+	 * a pending interrupt.
+	 */
+	private static final long INTERRUPT_POLL_MS = 100;
+
+	private static ForkJoinPool s_pool;
+
+	private static ForkJoinPool pool()
+	{
+		if ( null != s_pool )
+			return s_pool;
+
+		int parallelism = 0;
+		String setting =
+			Backend.getConfigOption("pljava.compute_parallelism");
+		if ( null != setting )
+			parallelism = Integer.parseInt(setting);
+		if ( 0 >= parallelism )
+			parallelism = Runtime.getRuntime().availableProcessors();
+
+		int p = parallelism;
+		s_pool = doPrivileged(() -> new ForkJoinPool(p,
+			pool -> doPrivileged(() -> new Worker(pool)), null, false));
+		return s_pool;
+	}
+
+	/**
+	 * Whether the current thread is one of the pool's workers, which may never
+	 * enter PostgreSQL.
+	 */
+	public static boolean isWorker()
+	{
+		return Thread.currentThread() instanceof Worker;
+	}
+
+	/**
+	 * Run tasks of PL/Java's own on the pool's workers, outside of any
+	 * invocation, returning when all have finished. A task is expected to
+	 * handle its own failures; any that escape are not reported.
+	 */
+	public static void runAll(Collection<? extends Runnable> tasks)
+	{
+		ForkJoinPool pool = pool();
+		List<ForkJoinTask<?>> started = new ArrayList<>(tasks.size());
+		for ( Runnable task : tasks )
+			started.add(pool.submit(task));
+		for ( ForkJoinTask<?> t : started )
+			t.quietlyJoin();
+	}
+
+	/**
+	 * The tasks submitted in this invocation, to be finished before it exits.
+	 * A queue safe for concurrent use, as a task may itself submit more.
+	 */
+	private final Queue<ForkJoinTask<?>> m_tasks =
+		new ConcurrentLinkedQueue<>();
+
+	/**
+	 * The worker threads now running tasks of this invocation, to be
+	 * interrupted if it must exit without waiting for them.
+	 */
+	private final Set<Thread> m_running = ConcurrentHashMap.newKeySet();
+
+	/**
+	 * Set as the invocation exits, so tasks not yet started will not start.
+	 */
+	private volatile boolean m_closed;
+
+	/**
+	 * Submit a task, to be run on a worker under the access control context
+	 * and with the context class loader of the submitting code, captured here,
+	 * rather than any the worker may have had from earlier tasks.
+	 */
+	@Override
+	public <T> Future<T> submit(Callable<T> task)
+	{
+		AccessControlContext acc = getContext();
+		ClassLoader loader = Thread.currentThread().getContextClassLoader();
+		ForkJoinTask<T> t = ForkJoinTask.adapt(() ->
+		{
+			if ( m_closed )
+				throw new CancellationException("invocation has exited");
+			return run(task, acc, loader);
+		});
+		m_tasks.add(t);
+		pool().execute(t);
+		return t;
+	}
+
+	private <T> T run(Callable<T> task, AccessControlContext acc,
+		ClassLoader loader)
+	throws Exception
+	{
+		Thread thread = Thread.currentThread();
+		ClassLoader saved = thread.getContextClassLoader();
+		boolean added = m_running.add(thread);
+		doPrivileged(() -> thread.setContextClassLoader(loader));
+		try
+		{
+			return doPrivileged(task::call, acc);
+		}
+		finally
+		{
+			doPrivileged(() -> thread.setContextClassLoader(saved));
+			if ( added )
+			{
+				m_running.remove(thread);
+				Thread.interrupted(); // not to be seen by the next task
+			}
+		}
+	}
+
+	@Override
+	public <T> List<T> invokeAll(Collection<? extends Callable<T>> tasks)
+	throws SQLException
+	{
+		List<ForkJoinTask<T>> started = new ArrayList<>(tasks.size());
+		for ( Callable<T> task : tasks )
+			started.add((ForkJoinTask<T>)submit(task));
+
+		List<T> results = new ArrayList<>(started.size());
+		try
+		{
+			for ( ForkJoinTask<T> t : started )
+			{
+				while ( ! isDone(t) )
+					if ( ! isWorker()  &&  Backend.isInterruptPending() )
+						throw new CancellationException();
+				results.add(t.get());
+			}
+		}
+		catch ( ExecutionException e )
+		{
+			throw new SQLException(
+				"parallel compute task failed: " + e.getCause(),
+				"38000", e.getCause());
+		}
+		catch ( CancellationException | InterruptedException e )
+		{
+			throw new SQLException(
+				"parallel compute interrupted", "57014", e);
+		}
+		return results;
+	}
+
+	/**
+	 * Called as the owning invocation exits: keeps the tasks not yet started
+	 * from starting, and waits for those already running to finish.
+	 *<p>
+	 * The wait ends early if PostgreSQL has an interrupt pending, as for
+	 * a query cancel, or the waiting thread is interrupted: the running tasks
+	 * are then interrupted and left to finish on their own, and the interrupt
+	 * is serviced once control returns to PostgreSQL.
+	 */
+	public void close()
+	{
+		ForkJoinTask<?> t;
+
+		m_closed = true;
+		while ( null != (t = m_tasks.poll()) )
+		{
+			try
+			{
+				while ( ! isDone(t) )
+				{
+					if ( Backend.isInterruptPending() )
+					{
+						abandon(t);
+						return;
+					}
+				}
+			}
+			catch ( InterruptedException e )
+			{
+				abandon(t);
+				return;
+			}
+		}
+	}
+
+	/**
+	 * Wait a short time for a task, returning whether it is done.
+	 */
+	private static boolean isDone(ForkJoinTask<?> t)
+	throws InterruptedException
+	{
+		try
+		{
+			t.get(INTERRUPT_POLL_MS, MILLISECONDS);
+		}
+		catch ( TimeoutException e )
+		{
+			return false;
+		}
+		catch ( ExecutionException | CancellationException e )
+		{
+			/* done, however it ended; submit's Future reports how */
+		}
+		return true;
+	}
+
+	/**
+	 * Stop waiting: cancel the given task and those not yet waited for, and
+	 * interrupt the workers running any of them.
+	 */
+	private void abandon(ForkJoinTask<?> t)
+	{
+		t.cancel(false);
+		while ( null != (t = m_tasks.poll()) )
+			t.cancel(false);
+		doPrivileged(() -> m_running.forEach(Thread::interrupt));
+	}
+}
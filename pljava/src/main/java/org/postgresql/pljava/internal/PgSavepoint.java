@@ -22,6 +22,8 @@ import java.util.Iterator;
 import java.util.WeakHashMap;
 import java.util.logging.Logger;
 
+import org.postgresql.pljava.Session.SubtransactionAction;
+
 /**
  * Implementation of {@link Savepoint} for the SPI connection.
  *<p>
@@ -176,6 +178,58 @@ public class PgSavepoint implements Savepoint
 		});
 	}
 
+	/**
+	 * Implementation of
+	 * {@link org.postgresql.pljava.Session#runInSubtransaction
+	 * Session.runInSubtransaction}.
+	 *<p>
+	 * Only when a savepoint listener is registered is a {@code PgSavepoint}
+	 * made, by {@link #set set}, for the listener to be called with. Either way
+	 * the subtransaction is ended here directly by its id and nesting level,
+	 * and any savepoints set within it are forgotten.
+	 */
+	static <E extends Exception> void runInSubtransaction(
+		SubtransactionAction<E> action)
+	throws SQLException, E
+	{
+		long ids = doInPG(() ->
+		{
+			if ( ! SubXactListener.hasListeners() )
+				return _begin();
+			PgSavepoint sp = set(null);
+			return (long)sp.m_nestLevel << 32  |  0xffffffffL & sp.m_xactId;
+		});
+		int xid = (int)ids;
+		int nestLevel = (int)(ids >>> 32);
+
+		try
+		{
+			action.run();
+		}
+		catch ( Throwable t )
+		{
+			try
+			{
+				doInPG(() ->
+				{
+					_abort(xid, nestLevel);
+					forgetNestLevelsGE(nestLevel);
+				});
+			}
+			catch ( SQLException e )
+			{
+				t.addSuppressed(e);
+			}
+			throw t;
+		}
+
+		doInPG(() ->
+		{
+			_release(xid, nestLevel);
+			forgetNestLevelsGE(nestLevel);
+		});
+	}
+
 	@Override
 	public int hashCode()
 	{
@@ -310,4 +364,18 @@ public class PgSavepoint implements Savepoint
 
 	private static native void _rollback(int xid, int nestLevel)
 	throws SQLException;
+
+	/**
+	 * Begin an internal subtransaction with no {@code PgSavepoint}, returning
+	 * its nesting level in the high 32 bits and its id in the low.
+	 */
+	private static native long _begin()
+	throws SQLException;
+
+	/**
+	 * Roll back as {@link #_rollback _rollback} does, first clearing the
+	 * invocation's error condition, as {@code Connection.rollback} does.
+	 */
+	private static native void _abort(int xid, int nestLevel)
+	throws SQLException;
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2004-2019 Tada AB and other contributors, as listed below.
+ * Copyright (c) 2004-2026 Tada AB and other contributors, as listed below.
  *
  * All rights reserved. This program and the accompanying materials
  * are made available under the terms of the The BSD 3-Clause License
@@ -25,6 +25,19 @@ import java.sql.SQLException;
  */
 public class Portal
 {
+	/*
+	 * Directions for scrollFetchTable and scrollMove; these four values must
+	 * match those in Portal.c.
+	 */
+	/** Fetch or move forward {@code count} rows. */
+	public static final int FETCH_FORWARD  = 0;
+	/** Fetch or move backward {@code count} rows. */
+	public static final int FETCH_BACKWARD = 1;
+	/** Fetch or move to row {@code count} (from the end, if negative). */
+	public static final int FETCH_ABSOLUTE = 2;
+	/** Fetch or move to row {@code count} from the current one. */
+	public static final int FETCH_RELATIVE = 3;
+
 	/*
 	 * Hold a reference to the Java ExecutionPlan object as long as we might be
 	 * using it, just to make sure Java unreachability doesn't cause it to
@@ -151,6 +164,67 @@ public class Portal
 		return fetched;
 	}
 
+	/**
+	 * Performs an <code>SPI_cursor_fetch</code> and returns the fetched rows
+	 * as a {@link TupleTable}, all in one call into native code, leaving
+	 * nothing parked at {@code SPI_tuptable}.
+	 * @param forward Set to <code>true</code> for forward, <code>false</code> for backward.
+	 * @param count Maximum number of rows to fetch.
+	 * @param td The TupleDesc of the rows.
+	 * @param counts Null, or an array whose first two elements will receive
+	 * the number of rows fetched and their total size in bytes.
+	 * @return The fetched rows, or null if none were fetched.
+	 * @throws SQLException if the handle to the native structure is stale.
+	 */
+	public TupleTable fetchTable(
+		boolean forward, long count, TupleDesc td, long[] counts)
+	throws SQLException
+	{
+		return doInPG(() ->
+			_fetchTable(m_state.getPortalPtr(), forward, count, td, counts));
+	}
+
+	/**
+	 * Performs an <code>SPI_scroll_cursor_fetch</code> and returns the fetched
+	 * rows as a {@link TupleTable}, as {@link #fetchTable fetchTable} does.
+	 * The portal must be scrollable for any direction but forward.
+	 * @param direction One of {@code FETCH_FORWARD}, {@code FETCH_BACKWARD},
+	 * {@code FETCH_ABSOLUTE}, or {@code FETCH_RELATIVE}.
+	 * @param count Maximum number of rows to fetch, or, for
+	 * {@code FETCH_ABSOLUTE} or {@code FETCH_RELATIVE}, the position of the
+	 * single row to fetch.
+	 * @param td The TupleDesc of the rows.
+	 * @param counts As for {@link #fetchTable fetchTable}.
+	 * @return The fetched rows, or null if none were fetched.
+	 * @throws SQLException if the handle to the native structure is stale.
+	 */
+	public TupleTable scrollFetchTable(
+		int direction, long count, TupleDesc td, long[] counts)
+	throws SQLException
+	{
+		return doInPG(() ->
+			_scrollFetchTable(
+				m_state.getPortalPtr(), direction, count, td, counts));
+	}
+
+	/**
+	 * Performs an <code>SPI_scroll_cursor_move</code>.
+	 * @param direction As for {@link #scrollFetchTable scrollFetchTable}.
+	 * @param count As for {@link #scrollFetchTable scrollFetchTable}.
+	 * @return The actual number of rows moved.
+	 * @throws SQLException if the handle to the native structure is stale.
+	 */
+	public long scrollMove(int direction, long count)
+	throws SQLException
+	{
+		long moved =
+			doInPG(() -> _scrollMove(m_state.getPortalPtr(), direction, count));
+		if ( moved < 0 )
+			throw new ArithmeticException(
+				"moved too many rows to report in a Java signed long");
+		return moved;
+	}
+
 	/**
 	 * Returns the value of the <code>atEnd</code> attribute.
 	 * @throws SQLException if the handle to the native structure is stale.
@@ -201,6 +275,14 @@ public class Portal
 	private static native long _fetch(long pointer, boolean forward, long count)
 	throws SQLException;
 
+	private static native TupleTable _fetchTable(long pointer,
+		boolean forward, long count, TupleDesc td, long[] counts)
+	throws SQLException;
+
+	private static native TupleTable _scrollFetchTable(long pointer,
+		int direction, long count, TupleDesc td, long[] counts)
+	throws SQLException;
+
 	private static native void _close(long pointer);
 
 	private static native boolean _isAtEnd(long pointer)
@@ -211,4 +293,8 @@ public class Portal
 
 	private static native long _move(long pointer, boolean forward, long count)
 	throws SQLException;
+
+	private static native long _scrollMove(
+		long pointer, int direction, long count)
+	throws SQLException;
 }
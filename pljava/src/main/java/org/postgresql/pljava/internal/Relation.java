@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2004-2019 Tada AB and other contributors, as listed below.
+ * Copyright (c) 2004-2026 Tada AB and other contributors, as listed below.
  *
  * All rights reserved. This program and the accompanying materials
  * are made available under the terms of the The BSD 3-Clause License
@@ -131,6 +131,29 @@ public class Relation
 				original.getNativePointer(), fieldNumbers, values));
 	}
 
+	/**
+	 * Reads the rows of a table whose key columns equal the given keys,
+	 * directly with the table or index access method, under the active
+	 * snapshot, and returns them in one {@code TupleTable} with its columns
+	 * of primitive types deformed, as for {@code pljava.spi_columnar_fetch}.
+	 *<p>
+	 * A null key matches no row.
+	 * @param relOid Oid of the table.
+	 * @param indexOid Oid of a btree or hash index of the table, whose leading
+	 * key columns are compared to the keys; or zero, to compare the columns
+	 * named in {@code attnums} during a sequential scan.
+	 * @param attnums Column numbers, one per key, when {@code indexOid} is
+	 * zero; otherwise ignored.
+	 * @param keys Values to be compared, for equality, to the key columns.
+	 * @param maxRows The most rows to return, or zero for all.
+	 */
+	public static TupleTable scan(
+		int relOid, int indexOid, int[] attnums, Object[] keys, int maxRows)
+	throws SQLException
+	{
+		return doInPG(() -> _scan(relOid, indexOid, attnums, keys, maxRows));
+	}
+
 	private static native String _getName(long pointer)
 	throws SQLException;
 
@@ -142,4 +165,8 @@ public class Relation
 
 	private static native Tuple _modifyTuple(long pointer, long original, int[] fieldNumbers, Object[] values)
 	throws SQLException;
+
+	private static native TupleTable _scan(
+		int relOid, int indexOid, int[] attnums, Object[] keys, int maxRows)
+	throws SQLException;
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2004-2019 Tada AB and other contributors, as listed below.
+ * Copyright (c) 2004-2026 Tada AB and other contributors, as listed below.
  *
  * All rights reserved. This program and the accompanying materials
  * are made available under the terms of the The BSD 3-Clause License
@@ -102,6 +102,15 @@ public class SPI
 		return doInPG(() -> _getTupTable(known));
 	}
 
+	/**
+	 * Returns the total size in bytes of the tuples in the global variable
+	 * <code>SPI_tuptable</code>, or zero if there is none.
+	 */
+	public static long getTupTableBytes()
+	{
+		return doInPG(SPI::_getTupTableBytes);
+	}
+
 	/**
 	 * Returns a textual representation of a result code.
 	 */
@@ -156,4 +165,5 @@ public class SPI
 	private native static int _getResult();
 	private native static void _freeTupTable();
 	private native static TupleTable _getTupTable(TupleDesc known);
+	private native static long _getTupTableBytes();
 }
@@ -14,6 +14,9 @@ package org.postgresql.pljava.internal;
 
 import java.sql.SQLException;
 
+import java.util.logging.Level;
+import java.util.logging.Logger;
+
 /**
  * A Java exception constructed over a PostgreSQL error report.
  * @author Thomas Hallgren
@@ -26,7 +29,18 @@ public class ServerException extends SQLException
 
 	public ServerException(ErrorData errorData)
 	{
-		super(errorData.getMessage(), errorData.getSqlState());
+		this(errorData, errorData.getMessage(), errorData.getSqlState());
+	}
+
+	/**
+	 * Called from native code, which has the message and SQLSTATE at hand
+	 * already and passes them, rather than have them read back through
+	 * {@code errorData}.
+	 */
+	public ServerException(
+		ErrorData errorData, String message, String sqlState)
+	{
+		super(message, sqlState);
 		m_errorData = errorData;
 	}
 
@@ -34,4 +48,45 @@ public class ServerException extends SQLException
 	{
 		return m_errorData;
 	}
+
+	/**
+	 * A {@code ServerException} that does not capture the Java stack, made by
+	 * native code for the SQLSTATEs listed in
+	 * {@code pljava.stackless_sqlstates}: errors Java code is likely to catch
+	 * and handle, perhaps once per row, where the stack trace would only be
+	 * thrown away.
+	 */
+	public static final class Stackless extends ServerException
+	{
+		private static final long serialVersionUID = -2218734961208816741L;
+
+		public Stackless(ErrorData errorData, String message, String sqlState)
+		{
+			super(errorData, message, sqlState);
+		}
+
+		@Override
+		public Throwable fillInStackTrace()
+		{
+			return this;
+		}
+	}
+
+	/**
+	 * Called from native code, while {@code pljava.log_cancel_stack} is on,
+	 * with each exception made from a PostgreSQL error, to log its stack
+	 * (which is where the Java code called into PostgreSQL) if the error is
+	 * a query cancel.
+	 *<p>
+	 * Java code that never calls into PostgreSQL will not see a cancel at all
+	 * until it returns; this shows where a long-running function was when the
+	 * cancel did reach it.
+	 */
+	private static void logCancelStack(ServerException e)
+	{
+		if ( ! "57014".equals(e.getSQLState()) )
+			return;
+		Logger.getLogger(ServerException.class.getName()).log(Level.WARNING,
+			"Java stack where the query cancel was noticed", e);
+	}
 }
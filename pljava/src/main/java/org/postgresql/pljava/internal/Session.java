@@ -20,12 +20,15 @@ import java.sql.SQLException;
 import java.sql.Statement;
 import java.util.HashMap;
 
+import org.postgresql.pljava.BackgroundJobs;
 import org.postgresql.pljava.ObjectPool;
+import org.postgresql.pljava.ParallelCompute;
 import org.postgresql.pljava.PooledObject;
 import org.postgresql.pljava.SavepointListener;
 import org.postgresql.pljava.TransactionListener;
 import org.postgresql.pljava.sqlgen.Lexicals.Identifier;
 
+import org.postgresql.pljava.jdbc.Invocation;
 import org.postgresql.pljava.jdbc.SQLUtils;
 
 import org.postgresql.pljava.elog.ELogHandler;
@@ -58,8 +61,14 @@ public class Session implements org.postgresql.pljava.Session
 		static final Session INSTANCE = new Session();
 	}
 
-	@SuppressWarnings("removal")
-	private final TransactionalMap m_attributes = new TransactionalMap(new HashMap());
+	/*
+	 * The deprecated attribute store. It was a TransactionalMap, but one never
+	 * committed or aborted, so every entry lived in its overlay, and a miss
+	 * there cost a second lookup in the (always empty) base map. A plain
+	 * HashMap behaves identically, with one lookup. Like the TransactionalMap,
+	 * it is not synchronized.
+	 */
+	private final HashMap<String,Object> m_attributes = new HashMap<>();
 
 	/**
 	 * The Java charset corresponding to the server encoding, or null if none
@@ -121,6 +130,26 @@ public class Session implements org.postgresql.pljava.Session
 		return m_attributes.get(attributeName);
 	}
 
+	@Override
+	public ParallelCompute parallelCompute() throws SQLException
+	{
+		return Invocation.current().parallelCompute();
+	}
+
+	@Override
+	public BackgroundJobs backgroundJobs()
+	{
+		return BackgroundJobsImpl.INSTANCE;
+	}
+
+	@Override
+	public <E extends Exception> void runInSubtransaction(
+		SubtransactionAction<E> action)
+	throws SQLException, E
+	{
+		PgSavepoint.runInSubtransaction(action);
+	}
+
 	public <T extends PooledObject> ObjectPool<T> getObjectPool(Class<T> cls)
 	{
 		return ObjectPoolImpl.getObjectPool(cls);
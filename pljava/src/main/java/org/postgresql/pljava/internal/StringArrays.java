@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+package org.postgresql.pljava.internal;
+
+import java.nio.ByteBuffer;
+import java.nio.CharBuffer;
+import java.nio.charset.CharacterCodingException;
+import java.nio.charset.Charset;
+import java.nio.charset.CharsetDecoder;
+import java.nio.charset.CharsetEncoder;
+import static java.nio.charset.StandardCharsets.UTF_8;
+
+import java.sql.SQLDataException;
+
+/**
+ * Bulk conversion between arrays of PostgreSQL text-like values and Java
+ * {@code String[]}, called from {@code String.c} so that an entire array
+ * crosses between C and Java in one call rather than one call per element.
+ *<p>
+ * In both directions, the element values are carried as bytes in
+ * {@code s_charset} concatenated without separators, along with
+ * an {@code int[]} of end offsets having one entry per element. An entry of
+ * -1 represents a null element, and the start of each non-null element is the
+ * end of the nearest preceding non-null one (or zero).
+ *<p>
+ * The bytes are UTF-8 unless {@code String.c} is decoding the server encoding
+ * directly (see {@link #setCharset setCharset}).
+ */
+class StringArrays
+{
+	private StringArrays() // do not instantiate
+	{
+	}
+
+	private static Charset s_charset = UTF_8;
+
+	/**
+	 * Called from {@code String.c} at initialization when the server encoding
+	 * has a Java charset that is used directly, without conversion to UTF-8.
+	 */
+	private static void setCharset(Charset cs)
+	{
+		s_charset = cs;
+	}
+
+	/**
+	 * Decode the elements in {@code encoded} delimited by {@code ends}.
+	 * @throws SQLDataException if, in a server encoding decoded directly, any
+	 * byte has no character assigned, rather than replacing it with U+FFFD.
+	 */
+	static String[] decode(ByteBuffer encoded, int[] ends)
+	throws SQLDataException
+	{
+		byte[] bytes = new byte [ encoded.remaining() ];
+		encoded.get(bytes);
+
+		CharsetDecoder decoder =
+			UTF_8 == s_charset ? null : s_charset.newDecoder();
+		String[] result = new String [ ends.length ];
+		int start = 0;
+		for ( int i = 0 ; i < ends.length ; ++ i )
+		{
+			int end = ends[i];
+			if ( -1 == end )
+				continue;
+			if ( null == decoder )
+				result[i] = new String(bytes, start, end - start, UTF_8);
+			else
+				result[i] = decodeStrictly(decoder, bytes, start, end);
+			start = end;
+		}
+		return result;
+	}
+
+	/**
+	 * Decode the bytes from {@code start} to {@code end} with
+	 * {@code decoder}, which (unlike the {@code String} constructor) reports
+	 * rather than replaces a byte that cannot be decoded. The UTF-8 bytes
+	 * have already been validated by PostgreSQL, and are not decoded this way.
+	 */
+	private static String decodeStrictly(
+		CharsetDecoder decoder, byte[] bytes, int start, int end)
+	throws SQLDataException
+	{
+		try
+		{
+			return decoder.decode(
+				ByteBuffer.wrap(bytes, start, end - start)).toString();
+		}
+		catch ( CharacterCodingException e )
+		{
+			throw new SQLDataException(
+				"invalid byte sequence for encoding \"" +
+				s_charset.name() + "\"", "22021", e);
+		}
+	}
+
+	/**
+	 * Encode the elements of {@code strings}, returning the concatenated
+	 * encoded bytes and storing the end offsets into {@code ends}, which must be
+	 * of the same length.
+	 * @throws SQLDataException if any string contains the NUL character, which
+	 * PostgreSQL does not allow in text values, or a character the server
+	 * encoding cannot represent.
+	 */
+	static byte[] encode(String[] strings, int[] ends) throws SQLDataException
+	{
+		byte[][] encoded = new byte [ strings.length ] [];
+		CharsetEncoder encoder =
+			UTF_8 == s_charset ? null : s_charset.newEncoder();
+		int total = 0;
+		for ( int i = 0 ; i < strings.length ; ++ i )
+		{
+			String s = strings[i];
+			if ( null == s )
+			{
+				ends[i] = -1;
+				continue;
+			}
+			if ( -1 != s.indexOf('\0') )
+				throw new SQLDataException(
+					"invalid byte sequence for encoding \"UTF8\": 0x00",
+					"22021");
+			if ( null == encoder )
+				encoded[i] = s.getBytes(UTF_8);
+			else
+				encoded[i] = encodeStrictly(encoder, s);
+			total += encoded[i].length;
+			ends[i] = total;
+		}
+
+		byte[] result = new byte [ total ];
+		int start = 0;
+		for ( byte[] b : encoded )
+		{
+			if ( null == b )
+				continue;
+			System.arraycopy(b, 0, result, start, b.length);
+			start += b.length;
+		}
+		return result;
+	}
+
+	/**
+	 * Encode {@code s} with {@code encoder}, which (unlike
+	 * {@code String.getBytes}) reports rather than replaces a character that
+	 * cannot be encoded.
+	 */
+	private static byte[] encodeStrictly(CharsetEncoder encoder, String s)
+	throws SQLDataException
+	{
+		try
+		{
+			ByteBuffer bb = encoder.encode(CharBuffer.wrap(s));
+			byte[] b = new byte [ bb.remaining() ];
+			bb.get(b);
+			return b;
+		}
+		catch ( CharacterCodingException e )
+		{
+			throw new SQLDataException(
+				"character has no equivalent in encoding \"" +
+				s_charset.name() + "\"", "22P05", e);
+		}
+	}
+}
@@ -114,6 +114,14 @@ class SubXactListener
 		});
 	}
 
+	/**
+	 * Whether any listener is registered; only on the PG thread.
+	 */
+	static boolean hasListeners()
+	{
+		return ! s_listeners.isEmpty();
+	}
+
 	private static native void _register();
 
 	private static native void _unregister();
@@ -14,10 +14,12 @@ package org.postgresql.pljava.internal;
 
 import java.sql.ResultSet;
 import java.sql.SQLException;
+import java.sql.Statement;
 
 import static org.postgresql.pljava.internal.Backend.doInPG;
 
 import org.postgresql.pljava.TriggerException;
+import org.postgresql.pljava.jdbc.SQLUtils;
 import org.postgresql.pljava.jdbc.TriggerResultSet;
 
 /**
@@ -151,6 +153,46 @@ public class TriggerData implements org.postgresql.pljava.TriggerData
 		return m_old;
 	}
 
+	@Override
+	public ResultSet getOldTable() throws SQLException
+	{
+		return transitionTable(false);
+	}
+
+	@Override
+	public ResultSet getNewTable() throws SQLException
+	{
+		return transitionTable(true);
+	}
+
+	/**
+	 * Query the old or new transition table, by the name it was given in
+	 * {@code REFERENCING}, which is visible to SPI while the trigger runs
+	 * because the native code registers the trigger data on connecting. That
+	 * makes the result an ordinary portal-backed {@code ResultSet}, read in
+	 * batches like any other. The statement is closed when the caller closes
+	 * the result set.
+	 */
+	private ResultSet transitionTable(boolean isNew) throws SQLException
+	{
+		String name = doInPG(() ->
+			_getTransitionTableName(this.getNativePointer(), isNew));
+		if ( null == name )
+			return null;
+		Statement stmt = SQLUtils.getDefaultConnection().createStatement();
+		try
+		{
+			stmt.closeOnCompletion();
+			return stmt.executeQuery(
+				"SELECT * FROM \"" + name.replace("\"", "\"\"") + '"');
+		}
+		catch ( SQLException | RuntimeException e )
+		{
+			stmt.close();
+			throw e;
+		}
+	}
+
 	/**
 	 * Commits the changes made on the <code>ResultSet</code> representing
 	 * <code>new</code> and returns the native pointer of new tuple. This
@@ -188,9 +230,11 @@ public class TriggerData implements org.postgresql.pljava.TriggerData
 			}
 		}
 
-		// Return the original tuple.
+		// Return the original tuple: the trigger manager's own, not the copy
+		// in any Tuple made of it here, so the native code can hand it back
+		// without copying.
 		//
-		return (this.isFiredByUpdate() ? this.getNewTuple() : this.getTriggerTuple()).getNativePointer();
+		return doInPG(() -> _getUnmodifiedReturnTuple(this.getNativePointer()));
 	}
 
 	public String getTableName()
@@ -382,8 +426,12 @@ public class TriggerData implements org.postgresql.pljava.TriggerData
 	private static native Relation _getRelation(long pointer) throws SQLException;
 	private static native Tuple _getTriggerTuple(long pointer) throws SQLException;
 	private static native Tuple _getNewTuple(long pointer) throws SQLException;
+	private static native long _getUnmodifiedReturnTuple(long pointer)
+	throws SQLException;
 	private static native String[] _getArguments(long pointer) throws SQLException;
 	private static native String _getName(long pointer) throws SQLException;
+	private static native String _getTransitionTableName(
+		long pointer, boolean isNew) throws SQLException;
 	private static native boolean _isFiredAfter(long pointer) throws SQLException;
 	private static native boolean _isFiredBefore(long pointer) throws SQLException;
 	private static native boolean _isFiredForEachRow(long pointer) throws SQLException;
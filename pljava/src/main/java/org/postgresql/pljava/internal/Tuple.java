@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2004-2019 Tada AB and other contributors, as listed below.
+ * Copyright (c) 2004-2026 Tada AB and other contributors, as listed below.
  *
  * All rights reserved. This program and the accompanying materials
  * are made available under the terms of the The BSD 3-Clause License
@@ -16,6 +16,8 @@ import static org.postgresql.pljava.internal.Backend.doInPG;
 
 import java.sql.SQLException;
 
+import org.postgresql.pljava.TupleAccessor;
+
 /**
  * The <code>Tuple</code> correspons to the internal PostgreSQL
  * <code>HeapTuple</code>.
@@ -26,9 +28,31 @@ public class Tuple
 {
 	private final State m_state;
 
+	/*
+	 * For a Tuple borrowed from an SPI tuple table rather than copied: the
+	 * native state of the table, which must be live for the pointer to be
+	 * valid, and the pointer.
+	 */
+	private final DualState<?> m_owner;
+	private final long m_borrowed;
+
 	Tuple(DualState.Key cookie, long resourceOwner, long pointer)
 	{
 		m_state = new State(cookie, this, resourceOwner, pointer);
+		m_owner = null;
+		m_borrowed = 0L;
+	}
+
+	/**
+	 * Construct a {@code Tuple} over a {@code HeapTuple} that remains in, and
+	 * belongs to, the tuple table whose state is {@code owner}; it is usable
+	 * only as long as that state is live.
+	 */
+	Tuple(DualState<?> owner, long pointer)
+	{
+		m_state = null;
+		m_owner = owner;
+		m_borrowed = pointer;
 	}
 
 	private static class State
@@ -75,7 +99,17 @@ public class Tuple
 	 */
 	public final long getNativePointer() throws SQLException
 	{
-		return m_state.getHeapTuplePtr();
+		if ( null == m_owner )
+			return m_state.getHeapTuplePtr();
+		m_owner.pin();
+		try
+		{
+			return m_borrowed;
+		}
+		finally
+		{
+			m_owner.unpin();
+		}
 	}
 
 	/**
@@ -97,10 +131,108 @@ public class Tuple
 	{
 		return doInPG(() ->
 			_getObject(this.getNativePointer(),
-				tupleDesc.getNativePointer(), index, type));
+				tupleDesc.getNativePointer(), index,
+				tupleDesc.getColumnType(index), type));
+	}
+
+	/**
+	 * Obtains an {@code int} value directly from a column of type
+	 * {@code smallint} or {@code integer}, without boxing.
+	 * @param tupleDesc The Tuple descriptor for this instance.
+	 * @param index Index of value in the structure (one based).
+	 * @param wasNull Array whose first element is set true if the value was
+	 * null (and zero returned), false otherwise.
+	 * @return The value, or zero if null.
+	 * @throws SQLException If the column is of another type, or the
+	 * underlying native structure has gone stale.
+	 */
+	public int getInt(TupleDesc tupleDesc, int index, boolean[] wasNull)
+	throws SQLException
+	{
+		return doInPG(() ->
+			_getInt(this.getNativePointer(),
+				tupleDesc.getNativePointer(), index, wasNull));
+	}
+
+	/**
+	 * Obtains a {@code long} value directly from a column of type
+	 * {@code smallint}, {@code integer}, or {@code bigint}, without boxing.
+	 * @see #getInt getInt
+	 */
+	public long getLong(TupleDesc tupleDesc, int index, boolean[] wasNull)
+	throws SQLException
+	{
+		return doInPG(() ->
+			_getLong(this.getNativePointer(),
+				tupleDesc.getNativePointer(), index, wasNull));
+	}
+
+	/**
+	 * Obtains a {@code double} value directly from a column of type
+	 * {@code real} or {@code double precision}, without boxing.
+	 * @see #getInt getInt
+	 */
+	public double getDouble(TupleDesc tupleDesc, int index, boolean[] wasNull)
+	throws SQLException
+	{
+		return doInPG(() ->
+			_getDouble(this.getNativePointer(),
+				tupleDesc.getNativePointer(), index, wasNull));
+	}
+
+	/**
+	 * Obtains a {@code boolean} value directly from a column of type
+	 * {@code boolean}, without boxing.
+	 * @see #getInt getInt
+	 */
+	public boolean getBoolean(TupleDesc tupleDesc, int index, boolean[] wasNull)
+	throws SQLException
+	{
+		return doInPG(() ->
+			_getBoolean(this.getNativePointer(),
+				tupleDesc.getNativePointer(), index, wasNull));
 	}
 
+	/**
+	 * Obtains a {@link TupleAccessor} over this tuple, which is deformed once,
+	 * natively, for the accessor to read its values in place.
+	 * @param tupleDesc The Tuple descriptor for this instance.
+	 * @throws SQLException If the underlying native structure has gone stale.
+	 */
+	public TupleAccessor accessor(TupleDesc tupleDesc)
+	throws SQLException
+	{
+		return doInPG(() ->
+			_accessor(this, tupleDesc,
+				this.getNativePointer(), tupleDesc.getNativePointer()));
+	}
+
+	/*
+	 * The column's native Type is passed in, as cached by the TupleDesc,
+	 * saving its lookup for every value fetched.
+	 */
 	private static native Object _getObject(
-		long pointer, long tupleDescPointer, int index, Class<?> type)
+		long pointer, long tupleDescPointer, int index, long columnType,
+		Class<?> type)
+	throws SQLException;
+
+	private static native int _getInt(
+		long pointer, long tupleDescPointer, int index, boolean[] wasNull)
+	throws SQLException;
+
+	private static native long _getLong(
+		long pointer, long tupleDescPointer, int index, boolean[] wasNull)
+	throws SQLException;
+
+	private static native double _getDouble(
+		long pointer, long tupleDescPointer, int index, boolean[] wasNull)
+	throws SQLException;
+
+	private static native boolean _getBoolean(
+		long pointer, long tupleDescPointer, int index, boolean[] wasNull)
+	throws SQLException;
+
+	private static native TupleAccessorImpl _accessor(
+		Tuple tuple, TupleDesc tupleDesc, long pointer, long tupleDescPointer)
 	throws SQLException;
 }
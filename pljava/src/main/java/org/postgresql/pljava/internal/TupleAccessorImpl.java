@@ -0,0 +1,280 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+package org.postgresql.pljava.internal;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.sql.SQLDataException;
+import java.sql.SQLException;
+
+import org.postgresql.pljava.TupleAccessor;
+
+import static org.postgresql.pljava.internal.Backend.doInPG;
+import static org.postgresql.pljava.jdbc.TypeOid.BOOLOID;
+import static org.postgresql.pljava.jdbc.TypeOid.DATEOID;
+import static org.postgresql.pljava.jdbc.TypeOid.FLOAT4OID;
+import static org.postgresql.pljava.jdbc.TypeOid.FLOAT8OID;
+import static org.postgresql.pljava.jdbc.TypeOid.INT2OID;
+import static org.postgresql.pljava.jdbc.TypeOid.INT4OID;
+import static org.postgresql.pljava.jdbc.TypeOid.INT8OID;
+import static org.postgresql.pljava.jdbc.TypeOid.TIMEOID;
+import static org.postgresql.pljava.jdbc.TypeOid.TIMESTAMPOID;
+import static org.postgresql.pljava.jdbc.TypeOid.TIMESTAMPTZOID;
+
+/**
+ * Implementation of {@link TupleAccessor} over a {@link Tuple}, deformed by
+ * {@code Tuple.c} into a native array of {@code Datum}s followed by an array
+ * of {@code bool} null flags, in a memory context of the accessor's own,
+ * which the accessor reads through the direct buffer {@code m_block}.
+ *<p>
+ * A {@code Datum} of a by-value type holds the value itself, so it is read
+ * from the buffer and narrowed as PostgreSQL's {@code DatumGet} macros would.
+ * Where {@code int8} and {@code float8} are not passed by value (32-bit
+ * builds), values of those types are fetched by a call into the native code
+ * instead. A {@code Datum} of a variable-length type is a pointer into the
+ * tuple, over which {@code _bytes} makes a buffer; the accessor holds the
+ * {@code Tuple} so that its memory stays reachable as long as the accessor.
+ * That buffer is only read while the state is pinned, and its bytes are copied
+ * into the buffer returned, as the tuple's memory can be freed (by the next
+ * fetch of a borrowing result set, or the end of a trigger call) while the
+ * caller still holds the returned buffer.
+ */
+class TupleAccessorImpl implements TupleAccessor
+{
+	private final State m_state;
+	private final ByteBuffer m_block;
+	private final int m_datumSize;
+	private final boolean m_eightByValue;
+	private final int[] m_types;
+	private final Tuple m_tuple;
+	private final TupleDesc m_tupleDesc;
+	private final boolean[] m_wasNull = new boolean[1];
+
+	private static class State
+	extends DualState.SingleMemContextDelete<TupleAccessorImpl>
+	{
+		private State(DualState.Key cookie, TupleAccessorImpl a, long cxt)
+		{
+			super(cookie, a, 0L, cxt);
+		}
+
+		private long getContext() throws SQLException
+		{
+			pin();
+			try
+			{
+				return guardedLong();
+			}
+			finally
+			{
+				unpin();
+			}
+		}
+	}
+
+	/**
+	 * Called from {@code Tuple.c}.
+	 * @param block direct buffer over the Datum and null flag arrays
+	 * @param datumSize the size of a Datum
+	 * @param eightByValue whether int8 and float8 Datums hold the value
+	 * @param types the type Oid of each column
+	 */
+	private TupleAccessorImpl(
+		DualState.Key cookie, long cxt, ByteBuffer block, int datumSize,
+		boolean eightByValue, int[] types, Tuple tuple, TupleDesc tupleDesc)
+	{
+		m_state = new State(cookie, this, cxt);
+		m_block = block.order(ByteOrder.nativeOrder());
+		m_datumSize = datumSize;
+		m_eightByValue = eightByValue;
+		m_types = types;
+		m_tuple = tuple;
+		m_tupleDesc = tupleDesc;
+	}
+
+	@Override
+	public int getColumnCount()
+	{
+		return m_types.length;
+	}
+
+	@Override
+	public boolean isNull(int columnIndex) throws SQLException
+	{
+		checkIndex(columnIndex);
+		m_state.pin();
+		try
+		{
+			return isNullPinned(columnIndex);
+		}
+		finally
+		{
+			m_state.unpin();
+		}
+	}
+
+	@Override
+	public boolean getBoolean(int columnIndex) throws SQLException
+	{
+		checkType(columnIndex, "boolean", BOOLOID);
+		m_state.pin();
+		try
+		{
+			return 0L != datum(columnIndex);
+		}
+		finally
+		{
+			m_state.unpin();
+		}
+	}
+
+	@Override
+	public int getInt(int columnIndex) throws SQLException
+	{
+		checkType(columnIndex, "int", INT2OID, INT4OID, DATEOID);
+		m_state.pin();
+		try
+		{
+			return (int)datum(columnIndex);
+		}
+		finally
+		{
+			m_state.unpin();
+		}
+	}
+
+	@Override
+	public long getLong(int columnIndex) throws SQLException
+	{
+		int type = checkType(columnIndex, "long", INT2OID, INT4OID, INT8OID,
+			TIMEOID, TIMESTAMPOID, TIMESTAMPTZOID);
+		if ( INT2OID == type  ||  INT4OID == type )
+			return getInt(columnIndex);
+		if ( ! m_eightByValue )
+		{
+			if ( INT8OID == type )
+				return m_tuple.getLong(m_tupleDesc, columnIndex, m_wasNull);
+			Long v = (Long)m_tuple.getObject(
+				m_tupleDesc, columnIndex, Long.class);
+			return null == v ? 0L : v;
+		}
+		m_state.pin();
+		try
+		{
+			return datum(columnIndex);
+		}
+		finally
+		{
+			m_state.unpin();
+		}
+	}
+
+	@Override
+	public double getDouble(int columnIndex) throws SQLException
+	{
+		int type = checkType(columnIndex, "double", FLOAT4OID, FLOAT8OID);
+		if ( FLOAT8OID == type  &&  ! m_eightByValue )
+			return m_tuple.getDouble(m_tupleDesc, columnIndex, m_wasNull);
+		m_state.pin();
+		try
+		{
+			long d = datum(columnIndex);
+			if ( FLOAT4OID == type )
+				return Float.intBitsToFloat((int)d);
+			return Double.longBitsToDouble(d);
+		}
+		finally
+		{
+			m_state.unpin();
+		}
+	}
+
+	@Override
+	public ByteBuffer getBytes(int columnIndex) throws SQLException
+	{
+		checkIndex(columnIndex);
+		return doInPG(() ->
+		{
+			m_state.pin();
+			try
+			{
+				if ( isNullPinned(columnIndex) )
+					return null;
+				/* also confirms a borrowed tuple is still there */
+				m_tuple.getNativePointer();
+				ByteBuffer bb = _bytes(m_state.guardedLong(),
+					m_tupleDesc.getNativePointer(), columnIndex,
+					datum(columnIndex));
+				ByteBuffer copy = ByteBuffer.allocate(bb.remaining());
+				copy.put(bb).flip();
+				return copy.asReadOnlyBuffer();
+			}
+			finally
+			{
+				m_state.unpin();
+			}
+		});
+	}
+
+	@Override
+	public void close()
+	{
+		m_state.releaseFromJava();
+	}
+
+	private void checkIndex(int columnIndex) throws SQLException
+	{
+		if ( columnIndex < 1  ||  columnIndex > m_types.length )
+			throw new SQLException(
+				"Invalid column index: " + columnIndex, "07009");
+	}
+
+	/**
+	 * Check the index and that the column is of one of the types, returning
+	 * its type.
+	 */
+	private int checkType(int columnIndex, String what, int... types)
+	throws SQLException
+	{
+		checkIndex(columnIndex);
+		int type = m_types[columnIndex - 1];
+		for ( int t : types )
+			if ( t == type )
+				return type;
+		throw new SQLDataException(
+			"column " + columnIndex + " of type " + type + " has no " + what +
+			" value", "42804");
+	}
+
+	private boolean isNullPinned(int columnIndex)
+	{
+		return 0 != m_block.get(
+			m_types.length * m_datumSize + columnIndex - 1);
+	}
+
+	/**
+	 * The Datum of a column, zero if null; call only with the state pinned.
+	 */
+	private long datum(int columnIndex)
+	{
+		if ( isNullPinned(columnIndex) )
+			return 0L;
+		int offset = (columnIndex - 1) * m_datumSize;
+		if ( 8 == m_datumSize )
+			return m_block.getLong(offset);
+		return m_block.getInt(offset);
+	}
+
+	private static native ByteBuffer _bytes(
+		long cxt, long tupleDescPointer, int index, long datum)
+	throws SQLException;
+}
@@ -14,8 +14,11 @@ package org.postgresql.pljava.internal;
 
 import static org.postgresql.pljava.internal.Backend.doInPG;
 
+import java.nio.ByteBuffer;
+
 import java.sql.SQLException;
 
+
 /**
  * The <code>TupleDesc</code> correspons to the internal PostgreSQL
  * <code>TupleDesc</code>.
@@ -26,13 +29,51 @@ public class TupleDesc
 {
 	private final State m_state;
 	private final int m_size;
-	private Class[] m_columnClasses;
+	private final Columns m_columns;
+
+	/**
+	 * What has been learned of the columns: names, type Oids, Java classes,
+	 * and the native {@code Type}s used in fetching values, each looked up
+	 * when first needed.
+	 *<p>
+	 * Each descriptor has its own, never shared with another descriptor even
+	 * of the same row type: the native {@code Type}s depend on the type map in
+	 * use when they were looked up, and on fallbacks that may since have been
+	 * invalidated, so they are only kept as long as the descriptor itself.
+	 * Only used on the PG thread.
+	 */
+	private static final class Columns
+	{
+		final String[] names;
+		final Oid[] oids;
+		final long[] types;
+		Class[] classes;
+
+		Columns(int size)
+		{
+			names = new String[size];
+			oids = new Oid[size];
+			types = new long[size];
+		}
+	}
+
+	/**
+	 * Kinds of primitive value that can be passed to
+	 * {@link #formTuple(Object[],ByteBuffer)}.
+	 */
+	public static final byte PRIM_BOOLEAN = 1;
+	public static final byte PRIM_SHORT   = 2;
+	public static final byte PRIM_INT     = 3;
+	public static final byte PRIM_LONG    = 4;
+	public static final byte PRIM_FLOAT   = 5;
+	public static final byte PRIM_DOUBLE  = 6;
 
 	TupleDesc(DualState.Key cookie, long resourceOwner, long pointer, int size)
 	throws SQLException
 	{
 		m_state = new State(cookie, this, resourceOwner, pointer);
 		m_size = size;
+		m_columns = new Columns(size);
 	}
 
 	private static class State
@@ -92,7 +133,16 @@ public class TupleDesc
 	public String getColumnName(int index)
 	throws SQLException
 	{
-		return doInPG(() -> _getColumnName(this.getNativePointer(), index));
+		return doInPG(() ->
+		{
+			if ( index < 1  ||  index > m_size )
+				return _getColumnName(this.getNativePointer(), index);
+			String name = m_columns.names[index - 1];
+			if ( null == name )
+				m_columns.names[index - 1] = name =
+					_getColumnName(this.getNativePointer(), index);
+			return name;
+		});
 	}
 
 	/**
@@ -120,7 +170,30 @@ public class TupleDesc
 	public Tuple formTuple(Object[] values)
 	throws SQLException
 	{
-		return doInPG(() -> _formTuple(this.getNativePointer(), values));
+		return formTuple(values, null);
+	}
+
+	/**
+	 * Creates a <code>Tuple</code> as {@link #formTuple(Object[])} does, but
+	 * taking the values for some columns from Java primitives in a direct
+	 * buffer, without boxing.
+	 *<p>
+	 * The buffer, in native byte order, holds {@link #size()} {@code long}
+	 * slots (the primitive value of each column, widened, or the raw bits of
+	 * a {@code float} or {@code double}), followed by {@code size()} bytes,
+	 * each zero if the column's value is to be taken from <var>values</var>,
+	 * or one of the {@code PRIM_} constants giving the primitive type in the
+	 * column's slot. The caller must only use a {@code PRIM_} kind for a column
+	 * whose {@link #getColumnClass column class} is the corresponding boxed
+	 * class.
+	 * @param primitives The buffer, or null if all values are in
+	 * <var>values</var>.
+	 */
+	public Tuple formTuple(Object[] values, ByteBuffer primitives)
+	throws SQLException
+	{
+		return doInPG(() ->
+			_formTuple(this.getNativePointer(), values, primitives));
 	}
 
 	/**
@@ -137,17 +210,18 @@ public class TupleDesc
 	public Class getColumnClass(int index)
 	throws SQLException
 	{
-		if(m_columnClasses == null)
+		Class[] classes = m_columns.classes;
+		if(classes == null)
 		{
-			m_columnClasses = new Class[m_size];
+			Class[] found = new Class[m_size];
 			doInPG(() ->
 			{				
-				long _this = this.getNativePointer();
 				for(int idx = 0; idx < m_size; ++idx)
-					m_columnClasses[idx] = _getOid(_this, idx+1).getJavaClass();
+					found[idx] = getOid(idx+1).getJavaClass();
 			});
+			m_columns.classes = classes = found;
 		}
-		return m_columnClasses[index-1];
+		return classes[index-1];
 	}
 
 	/**
@@ -156,11 +230,37 @@ public class TupleDesc
 	public Oid getOid(int index)
 	throws SQLException
 	{
-		return doInPG(() -> _getOid(this.getNativePointer(), index));
+		return doInPG(() ->
+		{
+			if ( index < 1  ||  index > m_size )
+				return _getOid(this.getNativePointer(), index);
+			Oid oid = m_columns.oids[index - 1];
+			if ( null == oid )
+				m_columns.oids[index - 1] = oid =
+					_getOid(this.getNativePointer(), index);
+			return oid;
+		});
+	}
+
+	/**
+	 * Returns the native {@code Type} for fetching values of the column, as
+	 * {@code Tuple.getObject} does; for use only on the PG thread.
+	 */
+	long getColumnType(int index)
+	throws SQLException
+	{
+		if ( index < 1  ||  index > m_size )
+			return _getColumnType(this.getNativePointer(), index);
+		long type = m_columns.types[index - 1];
+		if ( 0L == type )
+			m_columns.types[index - 1] = type =
+				_getColumnType(this.getNativePointer(), index);
+		return type;
 	}
 
 	private static native String _getColumnName(long _this, int index) throws SQLException;
 	private static native int _getColumnIndex(long _this, String colName) throws SQLException;
-	private static native Tuple _formTuple(long _this, Object[] values) throws SQLException;
+	private static native Tuple _formTuple(long _this, Object[] values, ByteBuffer primitives) throws SQLException;
 	private static native Oid _getOid(long _this, int index) throws SQLException;
+	private static native long _getColumnType(long _this, int index) throws SQLException;
 }
@@ -6,6 +6,8 @@
  */
 package org.postgresql.pljava.internal;
 
+import java.util.BitSet;
+
 /**
  * The <code>SPITupleTable</code> correspons to the internal PostgreSQL
  * <code>SPITupleTable</code> type.
@@ -14,13 +16,137 @@ package org.postgresql.pljava.internal;
  */
 public class TupleTable
 {
+	/**
+	 * Returned by {@link #getColumnarObject getColumnarObject} for a column
+	 * not available in columnar form.
+	 */
+	public static final Object NOT_COLUMNAR = new Object();
+
 	private final TupleDesc m_tupleDesc;
 	private final Tuple[] m_tuples;
+	private final Object[] m_columns;
+	private final BitSet[] m_nulls;
+
+	/*
+	 * Only for a table whose tuples are borrowed from the SPI tuple table left
+	 * in place, or copied into a memory context of the table's own: its native
+	 * state, and the native tuple pointers, from which the Tuple objects are
+	 * made as needed.
+	 */
+	private final DualState<TupleTable> m_state;
+	private final long[] m_pointers;
+
+	private static class State
+	extends DualState.SingleSPIfreetuptable<TupleTable>
+	{
+		private State(
+			DualState.Key cookie, TupleTable tt, long ro, long spitt)
+		{
+			super(cookie, tt, ro, spitt);
+		}
+	}
+
+	private static class CopiedState
+	extends DualState.SingleMemContextDelete<TupleTable>
+	{
+		private CopiedState(DualState.Key cookie, TupleTable tt, long cxt)
+		{
+			super(cookie, tt, 0L, cxt);
+		}
+	}
 
 	TupleTable(TupleDesc tupleDesc, Tuple[] tuples)
 	{
 		m_tupleDesc = tupleDesc;
 		m_tuples = tuples;
+		m_columns = null;
+		m_nulls = null;
+		m_state = null;
+		m_pointers = null;
+	}
+
+	/**
+	 * Constructor used when {@code pljava.spi_columnar_fetch} is on, with the
+	 * values of some columns also deformed natively into primitive arrays.
+	 * @param columns one entry per column, a primitive array holding the
+	 * column's values, or null for a column not available in this form.
+	 * @param nulls one entry per column, null if the column has no nulls, or
+	 * else a bitmap (as for {@link BitSet#valueOf(long[])}) of the null rows.
+	 */
+	TupleTable(
+		TupleDesc tupleDesc, Tuple[] tuples, Object[] columns, long[][] nulls)
+	{
+		m_tupleDesc = tupleDesc;
+		m_tuples = tuples;
+		m_columns = columns;
+		m_nulls = bitSets(nulls);
+		m_state = null;
+		m_pointers = null;
+	}
+
+	/**
+	 * Constructor used when {@code pljava.spi_borrowed_tuples} is on, for a
+	 * table that takes over the SPI tuple table in place rather than copying
+	 * its tuples. The tuples are valid until {@link #release release} is
+	 * called, or SPI frees the table itself, at the end of its connection or
+	 * on rollback of the subtransaction the table was read in; use of a
+	 * {@code Tuple} from this table after either will throw an exception.
+	 * @param resourceOwner the table's memory context, whose deletion ends
+	 * the table's validity (the {@code Invocation}, before PostgreSQL 9.5)
+	 * @param columns as for the columnar constructor, or null
+	 * @param nulls as for the columnar constructor, or null
+	 */
+	TupleTable(
+		DualState.Key cookie, long resourceOwner, long spiTupTable,
+		TupleDesc tupleDesc, long[] pointers, Object[] columns, long[][] nulls)
+	{
+		m_state = new State(cookie, this, resourceOwner, spiTupTable);
+		m_tupleDesc = tupleDesc;
+		m_pointers = pointers;
+		m_tuples = new Tuple [ pointers.length ];
+		m_columns = columns;
+		m_nulls = null == nulls ? null : bitSets(nulls);
+	}
+
+	/**
+	 * Constructor used for a table whose tuples have been copied from the SPI
+	 * tuple table into a memory context of the table's own, which is deleted
+	 * all at once when the table is released or becomes unreachable. Use of a
+	 * {@code Tuple} from this table after {@link #release release} will throw
+	 * an exception.
+	 * @param columns as for the columnar constructor, or null
+	 * @param nulls as for the columnar constructor, or null
+	 */
+	TupleTable(
+		DualState.Key cookie, long memoryContext, TupleDesc tupleDesc,
+		long[] pointers, Object[] columns, long[][] nulls)
+	{
+		m_state = new CopiedState(cookie, this, memoryContext);
+		m_tupleDesc = tupleDesc;
+		m_pointers = pointers;
+		m_tuples = new Tuple [ pointers.length ];
+		m_columns = columns;
+		m_nulls = null == nulls ? null : bitSets(nulls);
+	}
+
+	private static BitSet[] bitSets(long[][] nulls)
+	{
+		BitSet[] result = new BitSet[nulls.length];
+		for ( int i = 0 ; i < nulls.length ; ++ i )
+			if ( null != nulls[i] )
+				result[i] = BitSet.valueOf(nulls[i]);
+		return result;
+	}
+
+	/**
+	 * Free the native tuples now, if this table borrowed them from SPI or holds
+	 * them in its own memory context; otherwise, do nothing. No {@code Tuple}
+	 * obtained from this table may be used afterward.
+	 */
+	public final void release()
+	{
+		if ( null != m_state )
+			m_state.releaseFromJava();
 	}
 
 	public final TupleDesc getTupleDesc()
@@ -42,6 +168,50 @@ public class TupleTable
 	 */
 	public final Tuple getSlot(int position)
 	{
-		return m_tuples[position];
+		Tuple t = m_tuples[position];
+		if ( null == t  &&  null != m_pointers )
+			m_tuples[position] = t = new Tuple(m_state, m_pointers[position]);
+		return t;
+	}
+
+	/**
+	 * Whether this table holds the values of the given column (one based) in
+	 * the natively deformed column arrays.
+	 */
+	public final boolean isColumnar(int index)
+	{
+		return null != m_columns  &&  0 < index  &&  index <= m_columns.length
+			&&  null != m_columns[index - 1];
+	}
+
+	/**
+	 * Returns the value at the given row and column from the natively deformed
+	 * column arrays, as the class {@link Tuple#getObject Tuple.getObject} would
+	 * return by default, without a call into native code; or
+	 * {@link #NOT_COLUMNAR} if this table does not hold the column in that form.
+	 * @param position Index of the row. First row has index zero.
+	 * @param index Index of the column (one based).
+	 */
+	public final Object getColumnarObject(int position, int index)
+	{
+		if ( null == m_columns  ||  1 > index  ||  index > m_columns.length )
+			return NOT_COLUMNAR;
+		Object column = m_columns[index - 1];
+		if ( null == column )
+			return NOT_COLUMNAR;
+		BitSet nulls = m_nulls[index - 1];
+		if ( null != nulls  &&  nulls.get(position) )
+			return null;
+		if ( column instanceof int[] )
+			return ((int[])column)[position];
+		if ( column instanceof long[] )
+			return ((long[])column)[position];
+		if ( column instanceof double[] )
+			return ((double[])column)[position];
+		if ( column instanceof float[] )
+			return ((float[])column)[position];
+		if ( column instanceof short[] )
+			return ((short[])column)[position];
+		return ((boolean[])column)[position];
 	}
 }
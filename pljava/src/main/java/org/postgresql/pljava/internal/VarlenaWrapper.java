@@ -118,6 +118,25 @@ public interface VarlenaWrapper extends Closeable
 				context, snapshot, varlenaPtr, buf);
 		}
 
+		/**
+		 * Return counts, for this session, of the values wrapped in instances
+		 * of this class: detoasted when wrapped; parked undetoasted, with
+		 * a snapshot if need be; parked as only fetched, still compressed, when
+		 * no snapshot was available; and parked values later detoasted because
+		 * they were read.
+		 *<p>
+		 * The proportions can guide the settings
+		 * {@code pljava.varlena_eager_size} and
+		 * {@code pljava.varlena_park_ratio}: a parked value that is almost
+		 * always read soon after might as well be detoasted at once.
+		 */
+		public static long[] statistics()
+		{
+			return doInPG(Input::_statistics);
+		}
+
+		private static native long[] _statistics();
+
 		public void pin() throws SQLException
 		{
 			m_state.pin();
@@ -138,6 +157,33 @@ public interface VarlenaWrapper extends Closeable
 			return m_state.buffer();
 		}
 
+		/**
+		 * Return the length of the content, once detoasted.
+		 */
+		public long length()
+		{
+			return m_bufferSize;
+		}
+
+		/**
+		 * Return a copy of a range of the content, without detoasting all of
+		 * it if it has not been already.
+		 * @param offset Offset, from zero, of the first byte wanted.
+		 * @param length Number of bytes wanted; fewer are returned if the
+		 * content ends sooner.
+		 */
+		public byte[] slice(long offset, int length) throws SQLException
+		{
+			if ( offset < 0  ||  length < 0 )
+				throw new IllegalArgumentException(
+					"negative offset or length for slice");
+			if ( offset > m_bufferSize )
+				offset = m_bufferSize;
+			if ( length > m_bufferSize - offset )
+				length = (int)(m_bufferSize - offset);
+			return m_state.slice(offset, length);
+		}
+
 		@Override
 		public void close() throws IOException
 		{
@@ -382,6 +428,27 @@ public interface VarlenaWrapper extends Closeable
 				}
 			}
 
+			private byte[] slice(long offset, int length) throws SQLException
+			{
+				pin();
+				try
+				{
+					if ( null != m_buf )
+					{
+						byte[] bytes = new byte[length];
+						ByteBuffer b = m_buf.duplicate();
+						b.position((int)offset);
+						b.get(bytes);
+						return bytes;
+					}
+					return doInPG(() -> _slice(m_varlena, offset, length));
+				}
+				finally
+				{
+					unpin();
+				}
+			}
+
 			private long adopt(DualState.Key cookie) throws SQLException
 			{
 				adoptionLock(cookie);
@@ -470,6 +537,13 @@ public interface VarlenaWrapper extends Closeable
 			 * form.
 			 */
 			private native long _fetch(long varlena, long memContext);
+
+			/**
+			 * Return a copy of a range of a parked value's content, fetching
+			 * or decompressing only as much as needed, and leaving the parked
+			 * value as it was.
+			 */
+			private native byte[] _slice(long varlena, long offset, int length);
 		}
 	}
 
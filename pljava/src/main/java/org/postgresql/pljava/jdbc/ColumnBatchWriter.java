@@ -0,0 +1,341 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+package org.postgresql.pljava.jdbc;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+
+import java.sql.ResultSetMetaData;
+import java.sql.SQLException;
+import java.sql.SQLNonTransientException;
+import java.util.Arrays;
+
+import org.postgresql.pljava.ColumnBatch;
+import org.postgresql.pljava.ResultSetProvider;
+
+import static org.postgresql.pljava.internal.Backend.doInPG;
+import org.postgresql.pljava.internal.TupleDesc;
+import static org.postgresql.pljava.internal.TupleDesc.PRIM_BOOLEAN;
+import static org.postgresql.pljava.internal.TupleDesc.PRIM_DOUBLE;
+import static org.postgresql.pljava.internal.TupleDesc.PRIM_FLOAT;
+import static org.postgresql.pljava.internal.TupleDesc.PRIM_INT;
+import static org.postgresql.pljava.internal.TupleDesc.PRIM_LONG;
+import static org.postgresql.pljava.internal.TupleDesc.PRIM_SHORT;
+
+/**
+ * The {@link ColumnBatch} filled by a {@link ResultSetProvider.Batched}, or
+ * written and flushed by a {@link ResultSetProvider.Writing}, when the rows of
+ * its result are gathered into a tuplestore; made and driven by the native
+ * code in {@code Type.c}.
+ *<p>
+ * Each row has the layout {@link SingleRowWriter} uses for one row: an
+ * {@code Object} per column in {@code m_values}, and in {@code m_primitives}
+ * a long per column followed by a byte per column giving the kind of
+ * primitive, if any, in that column's long. In {@code m_primitives} each row
+ * is padded to a multiple of eight bytes. The native code reads the
+ * primitives of all the rows in place, without a call into Java.
+ */
+public class ColumnBatchWriter implements ColumnBatch.Writer
+{
+	private final SingleRowWriter m_writer;
+	private final int m_columns;
+	private final int m_capacity;
+	private final int m_stride;
+	private final Class<?>[] m_classes;
+	private final Object[] m_values;
+	private final ByteBuffer m_primitives;
+	private long m_target;
+
+	private ColumnBatchWriter(SingleRowWriter writer, int capacity)
+	throws SQLException
+	{
+		TupleDesc td = writer.getTupleDesc();
+		m_writer = writer;
+		m_columns = td.size();
+		m_capacity = capacity;
+		m_stride = 8 * m_columns + ((m_columns + 7) & ~7);
+		m_classes = new Class<?>[m_columns];
+		for ( int i = 0 ; i < m_columns ; ++ i )
+			m_classes[i] = td.getColumnClass(1 + i);
+		m_values = new Object [ m_columns * capacity ];
+		m_primitives = ByteBuffer.allocateDirect(m_stride * capacity)
+			.order(ByteOrder.nativeOrder());
+	}
+
+	/**
+	 * Clear the batch and have <var>provider</var> fill it; called, under the
+	 * function's access control context, through {@code EntryPoints} by the
+	 * native code, which forms a row from each of the first (returned number)
+	 * rows.
+	 */
+	public int fill(ResultSetProvider.Batched provider) throws SQLException
+	{
+		clear();
+		int rows = provider.assignBatch(this, m_capacity);
+		if ( 0 > rows  ||  rows > m_capacity )
+			throw new SQLNonTransientException(
+				provider.getClass().getCanonicalName() + ".assignBatch " +
+				"returned " + rows + " for a batch of " + m_capacity + " rows",
+				"22023");
+		return rows;
+	}
+
+	/**
+	 * Have <var>provider</var> write all its rows; called, under the function's
+	 * access control context, through {@code EntryPoints} by the native code,
+	 * with <var>target</var> the native state to which {@link #flush} passes
+	 * each batch.
+	 */
+	public void write(ResultSetProvider.Writing provider, long target)
+	throws SQLException
+	{
+		clear();
+		m_target = target;
+		try
+		{
+			provider.writeRows(this);
+		}
+		finally
+		{
+			m_target = 0L;
+		}
+	}
+
+	@Override
+	public void flush(int rows) throws SQLException
+	{
+		if ( 0L == m_target )
+			throw new SQLNonTransientException(
+				"ColumnBatch.Writer flushed outside of writeRows", "55000");
+		if ( 0 > rows  ||  rows > m_capacity )
+			throw new SQLNonTransientException(
+				"flush of " + rows + " rows from a batch of " + m_capacity +
+				" rows", "22023");
+		if ( 0 < rows )
+			doInPG(() -> _putBatch(m_target, m_values, m_primitives, rows));
+		clear();
+	}
+
+	private void clear()
+	{
+		Arrays.fill(m_values, null);
+		for ( int i = 0, n = m_primitives.capacity() ; i < n ; i += 8 )
+			m_primitives.putLong(i, 0L);
+	}
+
+	private Object[] values()
+	{
+		return m_values;
+	}
+
+	private ByteBuffer primitives()
+	{
+		return m_primitives;
+	}
+
+	@Override
+	public int getCapacity()
+	{
+		return m_capacity;
+	}
+
+	@Override
+	public ResultSetMetaData getMetaData() throws SQLException
+	{
+		return m_writer.getMetaData();
+	}
+
+	@Override
+	public void setNull(int columnIndex, int row) throws SQLException
+	{
+		setObject(columnIndex, row, null);
+	}
+
+	@Override
+	public void setBoolean(int columnIndex, int row, boolean x)
+	throws SQLException
+	{
+		if ( primitiveSlot(columnIndex, row, Boolean.class, PRIM_BOOLEAN) )
+			m_primitives.putLong(slotOffset(columnIndex, row), x ? 1L : 0L);
+		else
+			setObject(columnIndex, row, x);
+	}
+
+	@Override
+	public void setShort(int columnIndex, int row, short x)
+	throws SQLException
+	{
+		if ( primitiveSlot(columnIndex, row, Short.class, PRIM_SHORT) )
+			m_primitives.putLong(slotOffset(columnIndex, row), x);
+		else
+			setObject(columnIndex, row, x);
+	}
+
+	@Override
+	public void setInt(int columnIndex, int row, int x)
+	throws SQLException
+	{
+		if ( primitiveSlot(columnIndex, row, Integer.class, PRIM_INT) )
+			m_primitives.putLong(slotOffset(columnIndex, row), x);
+		else
+			setObject(columnIndex, row, x);
+	}
+
+	@Override
+	public void setLong(int columnIndex, int row, long x)
+	throws SQLException
+	{
+		if ( primitiveSlot(columnIndex, row, Long.class, PRIM_LONG) )
+			m_primitives.putLong(slotOffset(columnIndex, row), x);
+		else
+			setObject(columnIndex, row, x);
+	}
+
+	@Override
+	public void setFloat(int columnIndex, int row, float x)
+	throws SQLException
+	{
+		if ( primitiveSlot(columnIndex, row, Float.class, PRIM_FLOAT) )
+			m_primitives.putLong(
+				slotOffset(columnIndex, row), Float.floatToRawIntBits(x));
+		else
+			setObject(columnIndex, row, x);
+	}
+
+	@Override
+	public void setDouble(int columnIndex, int row, double x)
+	throws SQLException
+	{
+		if ( primitiveSlot(columnIndex, row, Double.class, PRIM_DOUBLE) )
+			m_primitives.putLong(
+				slotOffset(columnIndex, row), Double.doubleToRawLongBits(x));
+		else
+			setObject(columnIndex, row, x);
+	}
+
+	@Override
+	public void setObject(int columnIndex, int row, Object x)
+	throws SQLException
+	{
+		check(columnIndex, row);
+		m_primitives.put(kindOffset(columnIndex, row), (byte)0);
+		m_values[row * m_columns + columnIndex - 1] = null == x ? null :
+			SingleRowWriter.coerce(m_classes[columnIndex - 1], x);
+	}
+
+	@Override
+	public void setInts(int columnIndex, int[] x, int count)
+	throws SQLException
+	{
+		if ( Integer.class != columnClass(columnIndex) )
+		{
+			ColumnBatch.super.setInts(columnIndex, x, count);
+			return;
+		}
+		if ( 0 < count )
+			check(columnIndex, count - 1);
+		for ( int row = 0 ; row < count ; ++ row )
+		{
+			m_primitives.put(kindOffset(columnIndex, row), PRIM_INT);
+			m_primitives.putLong(slotOffset(columnIndex, row), x[row]);
+			m_values[row * m_columns + columnIndex - 1] = null;
+		}
+	}
+
+	@Override
+	public void setLongs(int columnIndex, long[] x, int count)
+	throws SQLException
+	{
+		if ( Long.class != columnClass(columnIndex) )
+		{
+			ColumnBatch.super.setLongs(columnIndex, x, count);
+			return;
+		}
+		if ( 0 < count )
+			check(columnIndex, count - 1);
+		for ( int row = 0 ; row < count ; ++ row )
+		{
+			m_primitives.put(kindOffset(columnIndex, row), PRIM_LONG);
+			m_primitives.putLong(slotOffset(columnIndex, row), x[row]);
+			m_values[row * m_columns + columnIndex - 1] = null;
+		}
+	}
+
+	@Override
+	public void setDoubles(int columnIndex, double[] x, int count)
+	throws SQLException
+	{
+		if ( Double.class != columnClass(columnIndex) )
+		{
+			ColumnBatch.super.setDoubles(columnIndex, x, count);
+			return;
+		}
+		if ( 0 < count )
+			check(columnIndex, count - 1);
+		for ( int row = 0 ; row < count ; ++ row )
+		{
+			m_primitives.put(kindOffset(columnIndex, row), PRIM_DOUBLE);
+			m_primitives.putLong(slotOffset(columnIndex, row),
+				Double.doubleToRawLongBits(x[row]));
+			m_values[row * m_columns + columnIndex - 1] = null;
+		}
+	}
+
+	/**
+	 * If the column's class is <var>boxed</var>, mark the cell as holding a
+	 * primitive of the given kind and return true; the caller then stores the
+	 * value in the cell's slot. Otherwise return false, for the caller to fall
+	 * back to {@code setObject} and its coercions.
+	 */
+	private boolean primitiveSlot(
+		int columnIndex, int row, Class<?> boxed, byte kind)
+	throws SQLException
+	{
+		check(columnIndex, row);
+		if ( boxed != m_classes[columnIndex - 1] )
+			return false;
+		m_primitives.put(kindOffset(columnIndex, row), kind);
+		m_values[row * m_columns + columnIndex - 1] = null;
+		return true;
+	}
+
+	private Class<?> columnClass(int columnIndex) throws SQLException
+	{
+		check(columnIndex, 0);
+		return m_classes[columnIndex - 1];
+	}
+
+	private void check(int columnIndex, int row) throws SQLException
+	{
+		if ( columnIndex < 1  ||  columnIndex > m_columns )
+			throw new SQLNonTransientException(
+				"column " + columnIndex + " outside batch of " + m_columns +
+				" columns", "22023");
+		if ( row < 0  ||  row >= m_capacity )
+			throw new SQLNonTransientException(
+				"row " + row + " outside batch of " + m_capacity + " rows",
+				"22023");
+	}
+
+	private int slotOffset(int columnIndex, int row)
+	{
+		return row * m_stride + 8 * (columnIndex - 1);
+	}
+
+	private int kindOffset(int columnIndex, int row)
+	{
+		return row * m_stride + 8 * m_columns + columnIndex - 1;
+	}
+
+	private static native void _putBatch(
+		long target, Object[] values, ByteBuffer primitives, int rows);
+}
@@ -17,8 +17,10 @@ import java.sql.SQLException;
 import java.util.ArrayList;
 import java.util.logging.Logger;
 
+import org.postgresql.pljava.elog.ELogHandler;
 import org.postgresql.pljava.internal.Backend;
 import static org.postgresql.pljava.internal.Backend.doInPG;
+import org.postgresql.pljava.internal.ParallelComputeImpl;
 import org.postgresql.pljava.internal.PgSavepoint;
 
 /**
@@ -55,6 +57,11 @@ public class Invocation
 	 */
 	private PgSavepoint m_savepoint;
 
+	/**
+	 * Parallel computation begun in this invocation, or null if none.
+	 */
+	private ParallelComputeImpl m_parallelCompute;
+
 	private Invocation(int level)
 	{
 		m_nestingLevel = level;
@@ -84,6 +91,17 @@ public class Invocation
 		m_savepoint = savepoint;
 	}
 
+	/**
+	 * @return The {@code ParallelCompute} for this invocation, created when
+	 * first asked for.
+	 */
+	public ParallelComputeImpl parallelCompute()
+	{
+		if ( null == m_parallelCompute )
+			m_parallelCompute = new ParallelComputeImpl();
+		return m_parallelCompute;
+	}
+
 	/**
 	 * Called from the backend when the invokation exits. Should
 	 * not be invoked any other way.
@@ -93,12 +111,18 @@ public class Invocation
 	{
 		try
 		{
+			if(m_parallelCompute != null)
+			{
+				m_parallelCompute.close();
+				m_parallelCompute = null;
+			}
 			if(m_savepoint != null)
 				m_savepoint.onInvocationExit(withError);
 		}
 		finally
 		{
 			s_levels[m_nestingLevel] = null;
+			ELogHandler.flushBuffered();
 		}
 	}
 
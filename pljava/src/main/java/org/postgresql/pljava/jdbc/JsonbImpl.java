@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+package org.postgresql.pljava.jdbc;
+
+import java.math.BigDecimal;
+
+import java.sql.SQLDataException;
+import java.sql.SQLException;
+
+import java.util.Arrays;
+import java.util.Collections;
+import java.util.List;
+
+import org.postgresql.pljava.Jsonb;
+
+import static org.postgresql.pljava.internal.Backend.doInPG;
+import org.postgresql.pljava.internal.DualState;
+
+/**
+ * A view of a {@code jsonb} object or array in its stored binary form (a
+ * {@code JsonbContainer}), made by the native code in {@code type/Jsonb.c}.
+ *<p>
+ * Lookups are made natively in the container. A member or element found that
+ * is itself an object or array is another view into the same stored value; a
+ * scalar found is returned as a {@code Jsonb} made by a
+ * {@link Jsonb.Builder Builder}, and a {@code jsonb} value that is a bare
+ * scalar is passed to Java that way from the start.
+ */
+public class JsonbImpl implements Jsonb
+{
+	private final State m_state;
+	private final int m_length;
+	private final boolean m_isObject;
+
+	private static class State
+	extends DualState.SingleGuardedLong<JsonbImpl>
+	{
+		private State(
+			DualState.Key cookie, JsonbImpl ji, long ro, long container)
+		{
+			super(cookie, ji, ro, container);
+		}
+
+		/**
+		 * Return the JsonbContainer pointer.
+		 *<p>
+		 * As in {@code SingleRowReader}, the value is returned out from under
+		 * the pin, and is only to be used on the PG thread in instance methods
+		 * of the {@code JsonbImpl}.
+		 */
+		private long getContainerPtr() throws SQLException
+		{
+			pin();
+			try
+			{
+				return guardedLong();
+			}
+			finally
+			{
+				unpin();
+			}
+		}
+	}
+
+	/**
+	 * Construct a view of a {@code JsonbContainer}.
+	 * @param cookie Capability obtained from native code.
+	 * @param resourceOwner Value identifying the scope (the function call) in
+	 * which the container's memory is valid.
+	 * @param container Native pointer to the {@code JsonbContainer}.
+	 * @param length The container's length in bytes.
+	 * @param isObject True for an object, false for an array.
+	 */
+	private JsonbImpl(DualState.Key cookie, long resourceOwner, long container,
+		int length, boolean isObject)
+	{
+		m_state = new State(cookie, this, resourceOwner, container);
+		m_length = length;
+		m_isObject = isObject;
+	}
+
+	/**
+	 * Return a scalar found in a container as a {@code Jsonb}; called from the
+	 * native code.
+	 * @param value A String, BigDecimal, or Boolean, or null.
+	 * @param isJsonNull True if the value found is the JSON null.
+	 */
+	private static Jsonb scalar(Object value, boolean isJsonNull)
+	{
+		Jsonb.Builder b = Jsonb.builder();
+		if ( isJsonNull )
+			b.nullValue();
+		else if ( value instanceof String )
+			b.value((String)value);
+		else if ( value instanceof BigDecimal )
+			b.value((BigDecimal)value);
+		else
+			b.value((Boolean)value);
+		return b.build();
+	}
+
+	/**
+	 * The container pointer, for the native code to copy the container as
+	 * a {@code jsonb} result.
+	 */
+	private long pointer() throws SQLException
+	{
+		return m_state.getContainerPtr();
+	}
+
+	private int length()
+	{
+		return m_length;
+	}
+
+	@Override
+	public Kind kind()
+	{
+		return m_isObject ? Kind.OBJECT : Kind.ARRAY;
+	}
+
+	@Override
+	public int size() throws SQLException
+	{
+		return doInPG(() -> _size(m_state.getContainerPtr()));
+	}
+
+	@Override
+	public List<String> keys() throws SQLException
+	{
+		if ( ! m_isObject )
+			return Collections.emptyList();
+		String[] keys = doInPG(() -> _keys(m_state.getContainerPtr()));
+		return Collections.unmodifiableList(Arrays.asList(keys));
+	}
+
+	@Override
+	public Jsonb get(String key) throws SQLException
+	{
+		if ( ! m_isObject  ||  null == key )
+			return null;
+		return doInPG(() -> _get(m_state.getContainerPtr(), key));
+	}
+
+	@Override
+	public Jsonb get(int index) throws SQLException
+	{
+		if ( m_isObject  ||  0 > index )
+			return null;
+		return doInPG(() -> _getElement(m_state.getContainerPtr(), index));
+	}
+
+	@Override
+	public String getString() throws SQLException
+	{
+		throw notScalar("String");
+	}
+
+	@Override
+	public BigDecimal getNumber() throws SQLException
+	{
+		throw notScalar("BigDecimal");
+	}
+
+	@Override
+	public boolean getBoolean() throws SQLException
+	{
+		throw notScalar("Boolean");
+	}
+
+	private SQLException notScalar(String what)
+	{
+		return new SQLDataException(
+			"jsonb " + kind() + " value is not a " + what, "22023");
+	}
+
+	@Override
+	public String toJson() throws SQLException
+	{
+		return doInPG(() -> _toJson(m_state.getContainerPtr(), m_length));
+	}
+
+	@Override
+	public String toString()
+	{
+		try
+		{
+			return toJson();
+		}
+		catch ( SQLException e )
+		{
+			return super.toString() + " (" + e.getMessage() + ")";
+		}
+	}
+
+	private static native int _size(long container) throws SQLException;
+
+	private static native String[] _keys(long container) throws SQLException;
+
+	private static native Jsonb _get(long container, String key)
+	throws SQLException;
+
+	private static native Jsonb _getElement(long container, int index)
+	throws SQLException;
+
+	private static native String _toJson(long container, int length)
+	throws SQLException;
+}
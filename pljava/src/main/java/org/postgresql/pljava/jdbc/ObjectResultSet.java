@@ -55,6 +55,15 @@ public abstract class ObjectResultSet extends AbstractResultSet
 		return m_wasNull;
 	}
 
+	/**
+	 * Records whether a value was null, for a subclass getter that obtains
+	 * its value other than through the methods here.
+	 */
+	protected final void setWasNull(boolean wasNull)
+	{
+		m_wasNull = wasNull;
+	}
+
 	/**
 	 * This is a noop since warnings are not supported.
 	 */
@@ -144,14 +153,20 @@ public abstract class ObjectResultSet extends AbstractResultSet
 	}
 
 	/**
-	 * Implemented over {@link #getBytes(int) getBytes}.
+	 * Implemented over {@link #getObjectValue(int,Class) getObjectValue},
+	 * which, for a {@code bytea} column, gives a {@link VarlenaBlob} able to
+	 * read ranges without copying the whole value into Java; another value is
+	 * made into bytes as by {@link #getBytes(int) getBytes}.
 	 */
 	@Override
 	public Blob getBlob(int columnIndex)
 	throws SQLException
 	{
-		byte[] bytes = getBytes(columnIndex);
-		return (bytes == null) ? null :  new BlobValue(bytes);
+		Object value = getObjectValue(columnIndex, Blob.class);
+		m_wasNull = (value == null);
+		if ( m_wasNull  ||  value instanceof Blob )
+			return (Blob)value;
+		return new BlobValue(SPIConnection.basicCoercion(byte[].class, value));
 	}
 
 	/**
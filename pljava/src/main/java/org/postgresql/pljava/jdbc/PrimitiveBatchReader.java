@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+package org.postgresql.pljava.jdbc;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+
+import java.util.PrimitiveIterator;
+
+/**
+ * Reads the values of a {@code PrimitiveIterator} returned by a set-returning
+ * function a batch at a time, when the rows of its result are gathered into a
+ * tuplestore; made and driven by the native code in {@code Type.c}.
+ *<p>
+ * Each value is stored, unboxed, as a long (for {@code OfLong} or
+ * {@code OfInt}) or a double (for {@code OfDouble}) in consecutive eight-byte
+ * slots of {@code m_values}, which the native code reads in place.
+ */
+public class PrimitiveBatchReader
+{
+	private final int m_capacity;
+	private final ByteBuffer m_values;
+
+	private PrimitiveBatchReader(int capacity)
+	{
+		m_capacity = capacity;
+		m_values = ByteBuffer.allocateDirect(8 * capacity)
+			.order(ByteOrder.nativeOrder());
+	}
+
+	private ByteBuffer values()
+	{
+		return m_values;
+	}
+
+	/**
+	 * Store up to a batch of values from <var>it</var>, returning how many
+	 * were stored; zero means the iterator is exhausted. Called, under the
+	 * function's access control context, through {@code EntryPoints}.
+	 */
+	public int fill(PrimitiveIterator<?,?> it)
+	{
+		int n = 0;
+		if ( it instanceof PrimitiveIterator.OfLong )
+		{
+			PrimitiveIterator.OfLong l = (PrimitiveIterator.OfLong)it;
+			for ( ; n < m_capacity  &&  l.hasNext() ; ++ n )
+				m_values.putLong(8 * n, l.nextLong());
+		}
+		else if ( it instanceof PrimitiveIterator.OfInt )
+		{
+			PrimitiveIterator.OfInt i = (PrimitiveIterator.OfInt)it;
+			for ( ; n < m_capacity  &&  i.hasNext() ; ++ n )
+				m_values.putLong(8 * n, i.nextInt());
+		}
+		else
+		{
+			PrimitiveIterator.OfDouble d = (PrimitiveIterator.OfDouble)it;
+			for ( ; n < m_capacity  &&  d.hasNext() ; ++ n )
+				m_values.putDouble(8 * n, d.nextDouble());
+		}
+		return n;
+	}
+}
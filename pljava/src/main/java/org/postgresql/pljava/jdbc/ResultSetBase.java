@@ -26,7 +26,7 @@ import java.sql.SQLException;
 public abstract class ResultSetBase extends ReadOnlyResultSet
 {
 	private int m_fetchSize;
-	private int m_row;
+	private long m_row;
 
 	/**
 	 * Records a fetch size, and an initial position before the first row.
@@ -60,11 +60,21 @@ public abstract class ResultSetBase extends ReadOnlyResultSet
 
 	/**
 	 * Returns the row set by the constructor or with
-	 * {@link #setRow}.
+	 * {@link #setRow}, or zero for a row beyond {@code Integer.MAX_VALUE},
+	 * which the JDBC method cannot represent.
 	 */
 	@Override
 	public final int getRow()
 	throws SQLException
+	{
+		return m_row > Integer.MAX_VALUE ? 0 : (int)m_row;
+	}
+
+	/**
+	 * Returns the row set by the constructor or with {@link #setRow}, without
+	 * the limit of {@link #getRow}.
+	 */
+	final long getLargeRow()
 	{
 		return m_row;
 	}
@@ -234,7 +244,7 @@ public abstract class ResultSetBase extends ReadOnlyResultSet
 	 * Sets the row reported by this class; should probably have
 	 * {@code protected} access.
 	 */
-	final void setRow(int row)
+	final void setRow(long row)
 	{
 		m_row = row;
 	}
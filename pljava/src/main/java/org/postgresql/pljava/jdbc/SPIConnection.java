@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2004-2020 Tada AB and other contributors, as listed below.
+ * Copyright (c) 2004-2026 Tada AB and other contributors, as listed below.
  *
  * All rights reserved. This program and the accompanying materials
  * are made available under the terms of the The BSD 3-Clause License
@@ -30,8 +30,10 @@ import java.sql.PreparedStatement;
 import java.sql.ResultSet;
 import java.sql.ResultSetMetaData; // for javadoc link
 import java.sql.SQLClientInfoException;
+import java.sql.SQLDataException;
 import java.sql.SQLException;
 import java.sql.SQLFeatureNotSupportedException;
+import java.sql.SQLSyntaxErrorException;
 import java.sql.SQLWarning;
 import java.sql.SQLXML;
 import java.sql.Savepoint;
@@ -42,16 +44,24 @@ import java.sql.Timestamp;
 import java.sql.Types;
 import java.util.BitSet;
 import java.util.Calendar;
+import java.util.Collections;
 import java.util.HashMap;
 import java.util.Iterator;
+import java.util.LinkedHashMap;
 import java.util.Map;
 import java.util.Properties;
 import java.util.concurrent.Executor;
 import java.util.regex.Matcher;
 import java.util.regex.Pattern;
 import java.util.regex.PatternSyntaxException;
+import org.postgresql.pljava.BulkInsert;
+import org.postgresql.pljava.RelationScan;
+import org.postgresql.pljava.internal.Backend;
+import org.postgresql.pljava.internal.ExecutionPlan;
 import org.postgresql.pljava.internal.Oid;
 import org.postgresql.pljava.internal.PgSavepoint;
+import org.postgresql.pljava.internal.SPI;
+import org.postgresql.pljava.sqlgen.Lexicals.Identifier;
 
 /**
  * Provides access to the current connection (session) the Java stored
@@ -68,7 +78,7 @@ import org.postgresql.pljava.internal.PgSavepoint;
  * </ul>
  * @author Thomas Hallgren
  */
-public class SPIConnection implements Connection
+public class SPIConnection implements Connection, BulkInsert, RelationScan
 {
 	/**
 	 * The version number of the currently executing PostgreSQL
@@ -91,8 +101,48 @@ public class SPIConnection implements Connection
 	private static final HashMap<Class<?>,Integer> s_class2sqlType =
 		new HashMap<>(30);
 
+	/**
+	 * The result of translating one JDBC SQL string by
+	 * {@link #nativeSQL(String,int[])}: the PostgreSQL SQL, and the number of
+	 * parameters found.
+	 */
+	private static final class Translation
+	{
+		final String sql;
+		final int paramCount;
+
+		Translation(String sql, int paramCount)
+		{
+			this.sql = sql;
+			this.paramCount = paramCount;
+		}
+	}
+
+	/**
+	 * MRU cache of recent translations, keyed by the JDBC SQL string, so that
+	 * preparing the same statement repeatedly does not scan it every time.
+	 *<p>
+	 * It is bounded like the {@code ExecutionPlan} cache, and because a hit
+	 * returns the very {@code String} translated before, the plan cache key
+	 * made from it then compares equal by identity.
+	 */
+	private static final Map<String,Translation> s_translations;
+
 	static
 	{
+		int cacheSize = Backend.getStatementCacheSize();
+		int bound = cacheSize < 11 ? 11 : cacheSize;
+		s_translations = Collections.synchronizedMap(
+			new LinkedHashMap<String,Translation>(29, 0.75f, true)
+			{
+				@Override
+				protected boolean removeEldestEntry(
+					Map.Entry<String,Translation> eldest)
+				{
+					return size() > bound;
+				}
+			});
+
 		addType(String.class, Types.VARCHAR);
 		addType(Byte.class, Types.TINYINT);
 		addType(Short.class, Types.SMALLINT);
@@ -376,8 +426,9 @@ public class SPIConnection implements Connection
 	 * 
 	 * @throws SQLException
 	 *
-	 *             if the <code>resultSetType</code> differs from
-	 *             {@link ResultSet#TYPE_FORWARD_ONLY} or if the
+	 *             if the <code>resultSetType</code> is not
+	 *             {@link ResultSet#TYPE_FORWARD_ONLY} or
+	 *             {@link ResultSet#TYPE_SCROLL_INSENSITIVE}, or if the
 	 *             <code>resultSetConcurrencty</code> differs from
 	 *             {@link ResultSet#CONCUR_READ_ONLY}.
 	 */
@@ -387,22 +438,25 @@ public class SPIConnection implements Connection
 		int resultSetConcurrency)
 		throws SQLException
 	{
-		if(resultSetType != ResultSet.TYPE_FORWARD_ONLY)
-			throw new UnsupportedOperationException("TYPE_FORWARD_ONLY supported ResultSet type");
-
-		if(resultSetConcurrency != ResultSet.CONCUR_READ_ONLY)
-			throw new UnsupportedOperationException("CONCUR_READ_ONLY is the supported ResultSet concurrency");
-		return this.createStatement();
+		return this.createStatement(resultSetType, resultSetConcurrency,
+			ResultSet.CLOSE_CURSORS_AT_COMMIT);
 	}
 
 	/**
 	 * Creates a new instance of <code>SPIStatement</code>.
+	 *<p>
+	 * A {@link ResultSet#TYPE_SCROLL_INSENSITIVE} statement plans its queries
+	 * for scrollable cursors, and a {@link ResultSet#HOLD_CURSORS_OVER_COMMIT}
+	 * one opens its cursors {@code WITH HOLD}, so a {@code ResultSet} from it
+	 * can still be read after the transaction commits (as in a procedure),
+	 * until it is closed.
 	 * 
 	 * @throws SQLException
-	 *             if the <code>resultSetType</code> differs from {@link
-	 *             ResultSet#TYPE_FORWARD_ONLY}, if the <code>resultSetConcurrencty</code>
-	 *             differs from {@link ResultSet#CONCUR_READ_ONLY}, or if the
-	 *             resultSetHoldability differs from {@link ResultSet#CLOSE_CURSORS_AT_COMMIT}.
+	 *             if the <code>resultSetType</code> is not
+	 *             {@link ResultSet#TYPE_FORWARD_ONLY} or
+	 *             {@link ResultSet#TYPE_SCROLL_INSENSITIVE}, or if the
+	 *             <code>resultSetConcurrencty</code> differs from
+	 *             {@link ResultSet#CONCUR_READ_ONLY}.
 	 */
 	@Override
 	public Statement createStatement(
@@ -411,10 +465,35 @@ public class SPIConnection implements Connection
 		int resultSetHoldability)
 		throws SQLException
 	{
-		if(resultSetHoldability != ResultSet.CLOSE_CURSORS_AT_COMMIT)
+		checkResultSetOptions(
+			resultSetType, resultSetConcurrency, resultSetHoldability);
+		if(this.isClosed())
+			throw new SQLException("Connection is closed");
+		return new SPIStatement(this, resultSetType, resultSetHoldability);
+	}
+
+	/**
+	 * Checks the {@code ResultSet} type, concurrency, and holdability asked
+	 * for a statement.
+	 */
+	private static void checkResultSetOptions(
+		int resultSetType,
+		int resultSetConcurrency,
+		int resultSetHoldability)
+	{
+		if(resultSetType != ResultSet.TYPE_FORWARD_ONLY
+			&& resultSetType != ResultSet.TYPE_SCROLL_INSENSITIVE)
+			throw new UnsupportedOperationException(
+				"TYPE_FORWARD_ONLY and TYPE_SCROLL_INSENSITIVE are the " +
+				"supported ResultSet types");
+
+		if(resultSetConcurrency != ResultSet.CONCUR_READ_ONLY)
+			throw new UnsupportedOperationException("CONCUR_READ_ONLY is the supported ResultSet concurrency");
+
+		if(resultSetHoldability != ResultSet.CLOSE_CURSORS_AT_COMMIT
+			&& resultSetHoldability != ResultSet.HOLD_CURSORS_OVER_COMMIT)
 			throw new UnsupportedOperationException(
-					"CLOSE_CURSORS_AT_COMMIT is the only supported ResultSet holdability");
-		return this.createStatement(resultSetType, resultSetConcurrency);
+				"unknown ResultSet holdability " + resultSetHoldability);
 	}
 
 	/**
@@ -450,9 +529,23 @@ public class SPIConnection implements Connection
 	
 	/*
 	 * An internal nativeSQL that returns a count of substitutable parameters
-	 * detected, used in prepareStatement().
+	 * detected, used in prepareStatement(). Recent translations are remembered
+	 * in s_translations.
 	 */
 	public String nativeSQL(String sql, int[] paramCountRet)
+	{
+		Translation t = s_translations.get(sql);
+		if ( null == t )
+		{
+			t = translate(sql);
+			s_translations.put(sql, t);
+		}
+		if(paramCountRet != null)
+			paramCountRet[0] = t.paramCount;
+		return t.sql;
+	}
+
+	private static Translation translate(String sql)
 	{
 		StringBuffer buf = new StringBuffer();
 		int len = sql.length();
@@ -508,9 +601,7 @@ public class SPIConnection implements Connection
 			}
 			buf.append(c);
 		}
-		if(paramCountRet != null)
-			paramCountRet[0] = paramIndex - 1;
-		return buf.toString();
+		return new Translation(buf.toString(), paramIndex - 1);
 	}
 
 	/**
@@ -559,13 +650,8 @@ public class SPIConnection implements Connection
 	public PreparedStatement prepareStatement(String sql)
 	throws SQLException
 	{
-		if(this.isClosed())
-			throw new SQLException("Connection is closed");
-
-		int[] pcount = new int[] { 0 };
-		sql = this.nativeSQL(sql, pcount);
-		PreparedStatement stmt = new SPIPreparedStatement(this, sql, pcount[0]);
-		return stmt;
+		return this.prepareStatement(sql, ResultSet.TYPE_FORWARD_ONLY,
+			ResultSet.CONCUR_READ_ONLY, ResultSet.CLOSE_CURSORS_AT_COMMIT);
 	}
 
 	/**
@@ -583,9 +669,11 @@ public class SPIConnection implements Connection
 	 * Creates a new instance of <code>SPIPreparedStatement</code>.
 	 * 
 	 * @throws SQLException
-	 *             if the <code>resultSetType</code> differs from {@link
-	 *             ResultSet#TYPE_FORWARD_ONLY} or if the <code>resultSetConcurrencty</code>
-	 *             differs from {@link ResultSet#CONCUR_READ_ONLY}.
+	 *             if the <code>resultSetType</code> is not
+	 *             {@link ResultSet#TYPE_FORWARD_ONLY} or
+	 *             {@link ResultSet#TYPE_SCROLL_INSENSITIVE}, or if the
+	 *             <code>resultSetConcurrencty</code> differs from
+	 *             {@link ResultSet#CONCUR_READ_ONLY}.
 	 */
 	@Override
 	public PreparedStatement prepareStatement(
@@ -594,22 +682,21 @@ public class SPIConnection implements Connection
 		int resultSetConcurrency)
 		throws SQLException
 	{
-		if(resultSetType != ResultSet.TYPE_FORWARD_ONLY)
-			throw new UnsupportedOperationException("TYPE_FORWARD_ONLY supported ResultSet type");
-
-		if(resultSetConcurrency != ResultSet.CONCUR_READ_ONLY)
-			throw new UnsupportedOperationException("CONCUR_READ_ONLY is the supported ResultSet concurrency");
-		return prepareStatement(sql);
+		return this.prepareStatement(sql, resultSetType, resultSetConcurrency,
+			ResultSet.CLOSE_CURSORS_AT_COMMIT);
 	}
 
 	/**
-	 * Creates a new instance of <code>SPIPreparedStatement</code>.
+	 * Creates a new instance of <code>SPIPreparedStatement</code>, with
+	 * scrollable or holdable results as described for
+	 * {@link #createStatement(int,int,int) createStatement}.
 	 * 
 	 * @throws SQLException
-	 *             if the <code>resultSetType</code> differs from {@link
-	 *             ResultSet#TYPE_FORWARD_ONLY}, if the <code>resultSetConcurrencty</code>
-	 *             differs from {@link ResultSet#CONCUR_READ_ONLY}, or if the
-	 *             resultSetHoldability differs from {@link ResultSet#CLOSE_CURSORS_AT_COMMIT}.
+	 *             if the <code>resultSetType</code> is not
+	 *             {@link ResultSet#TYPE_FORWARD_ONLY} or
+	 *             {@link ResultSet#TYPE_SCROLL_INSENSITIVE}, or if the
+	 *             <code>resultSetConcurrencty</code> differs from
+	 *             {@link ResultSet#CONCUR_READ_ONLY}.
 	 */
 	@Override
 	public PreparedStatement prepareStatement(
@@ -619,10 +706,15 @@ public class SPIConnection implements Connection
 		int resultSetHoldability)
 		throws SQLException
 	{
-		if(resultSetHoldability != ResultSet.CLOSE_CURSORS_AT_COMMIT)
-			throw new UnsupportedOperationException(
-			"CLOSE_CURSORS_AT_COMMIT is the only supported ResultSet holdability");
-		return this.prepareStatement(sql, resultSetType, resultSetConcurrency);
+		checkResultSetOptions(
+			resultSetType, resultSetConcurrency, resultSetHoldability);
+		if(this.isClosed())
+			throw new SQLException("Connection is closed");
+
+		int[] pcount = new int[] { 0 };
+		sql = this.nativeSQL(sql, pcount);
+		return new SPIPreparedStatement(this, sql, pcount[0],
+			resultSetType, resultSetHoldability);
 	}
 
 	/**
@@ -1077,6 +1169,197 @@ public class SPIConnection implements Connection
 			     // ready, right?
 	}
 
+	/**
+	 * Insert rows given column by column, with one execution of
+	 * {@code INSERT ... SELECT * FROM unnest($1, $2, ...)}, each parameter
+	 * having the array type of its column.
+	 */
+	@Override
+	public long insertColumns(String table, String[] columns, Object... values)
+	throws SQLException
+	{
+		if ( columns.length != values.length  ||  0 == columns.length )
+			throw new SQLDataException(
+				"bulk insert needs one array of values for each of at least " +
+				"one column", "22023");
+
+		int rows = -1;
+		for ( Object v : values )
+		{
+			if ( null == v  ||  ! v.getClass().isArray() )
+				throw new SQLDataException(
+					"bulk insert values must be non-null arrays", "22023");
+			int len = java.lang.reflect.Array.getLength(v);
+			if ( -1 != rows  &&  len != rows )
+				throw new SQLDataException(
+					"bulk insert arrays must all be of the same length",
+					"22023");
+			rows = len;
+		}
+
+		Identifier.Qualified<Identifier.Simple> rel =
+			Identifier.Qualified.nameFromJava(table);
+		Oid[] types = new Oid [ columns.length ];
+		StringBuilder sql = new StringBuilder("INSERT INTO ").append(rel);
+		try (
+			PreparedStatement ps = prepareStatement(
+				"SELECT CAST(pg_catalog.coalesce(" +
+				"  pg_catalog.nullif(t.typarray, 0), b.typarray)" +
+				"  AS pg_catalog.int8)" +
+				" FROM" +
+				"  pg_catalog.pg_attribute AS a" +
+				"  JOIN pg_catalog.pg_type AS t" +
+				"   ON a.atttypid OPERATOR(pg_catalog.=) t.oid" +
+				"  LEFT JOIN pg_catalog.pg_type AS b" +
+				"   ON t.typbasetype OPERATOR(pg_catalog.=) b.oid" +
+				" WHERE" +
+				"  a.attrelid OPERATOR(pg_catalog.=)" +
+				"   CAST(CAST(? AS pg_catalog.text) AS pg_catalog.regclass)" +
+				"  AND a.attname OPERATOR(pg_catalog.=) ?" +
+				"  AND a.attnum OPERATOR(pg_catalog.>) 0" +
+				"  AND NOT a.attisdropped");
+		)
+		{
+			ps.setString(1, rel.toString());
+			for ( int i = 0 ; i < columns.length ; ++ i )
+			{
+				Identifier.Simple col = Identifier.Simple.fromJava(columns[i]);
+				ps.setString(2, col.pgFolded());
+				try ( ResultSet rs = ps.executeQuery() )
+				{
+					if ( ! rs.next() )
+						throw new SQLSyntaxErrorException(
+							"column " + col + " of relation " + rel +
+							" does not exist", "42703");
+					types[i] = new Oid((int)rs.getLong(1));
+				}
+				sql.append(0 == i ? " (" : ", ").append(col);
+			}
+		}
+
+		sql.append(") SELECT * FROM pg_catalog.unnest(");
+		for ( int i = 1 ; i <= columns.length ; ++ i )
+			sql.append(1 == i ? "$" : ", $").append(i);
+		sql.append(')');
+
+		ExecutionPlan plan = ExecutionPlan.prepare(sql.toString(), types);
+		try
+		{
+			plan.execute(values, ExecutionPlan.SPI_READONLY_DEFAULT, 0);
+			return SPI.getProcessed();
+		}
+		finally
+		{
+			SPI.freeTupTable();
+			plan.close();
+		}
+	}
+
+	/**
+	 * Resolve the table and index with one catalog query, which also checks
+	 * that the caller may read the table.
+	 */
+	@Override
+	public Lookup prepareIndexLookup(String table, String index)
+	throws SQLException
+	{
+		Identifier.Qualified<Identifier.Simple> rel =
+			Identifier.Qualified.nameFromJava(table);
+		Identifier.Simple idx = Identifier.Simple.fromJava(index);
+		try (
+			PreparedStatement ps = prepareStatement(
+				"SELECT" +
+				"  CAST(i.indrelid AS pg_catalog.int8)," +
+				"  CAST(i.indexrelid AS pg_catalog.int8)" +
+				" FROM" +
+				"  pg_catalog.pg_index AS i" +
+				"  JOIN pg_catalog.pg_class AS c" +
+				"   ON i.indexrelid OPERATOR(pg_catalog.=) c.oid" +
+				" WHERE" +
+				"  i.indrelid OPERATOR(pg_catalog.=)" +
+				"   CAST(CAST(? AS pg_catalog.text) AS pg_catalog.regclass)" +
+				"  AND c.relname OPERATOR(pg_catalog.=) ?" +
+				"  AND pg_catalog.has_table_privilege(i.indrelid, 'SELECT')");
+		)
+		{
+			ps.setString(1, rel.toString());
+			ps.setString(2, idx.pgFolded());
+			try ( ResultSet rs = ps.executeQuery() )
+			{
+				if ( ! rs.next() )
+					throw new SQLSyntaxErrorException(
+						"index " + idx + " of relation " + rel +
+						" does not exist or the relation may not be read",
+						"42704");
+				return new SPIRelationLookup(
+					(int)rs.getLong(1), (int)rs.getLong(2), null);
+			}
+		}
+	}
+
+	/**
+	 * Resolve the table and columns with catalog queries, the first of which
+	 * also checks that the caller may read the table.
+	 */
+	@Override
+	public Lookup prepareTableScan(String table, String... columns)
+	throws SQLException
+	{
+		if ( 0 == columns.length )
+			throw new SQLDataException(
+				"table scan lookup needs at least one column", "22023");
+
+		Identifier.Qualified<Identifier.Simple> rel =
+			Identifier.Qualified.nameFromJava(table);
+		int relOid;
+		int[] attnums = new int [ columns.length ];
+		try (
+			PreparedStatement ps = prepareStatement(
+				"SELECT CAST(r AS pg_catalog.int8)" +
+				" FROM" +
+				"  CAST(CAST(? AS pg_catalog.text) AS pg_catalog.regclass)" +
+				"  AS r" +
+				" WHERE pg_catalog.has_table_privilege(r, 'SELECT')");
+		)
+		{
+			ps.setString(1, rel.toString());
+			try ( ResultSet rs = ps.executeQuery() )
+			{
+				if ( ! rs.next() )
+					throw new SQLSyntaxErrorException(
+						"relation " + rel + " may not be read", "42501");
+				relOid = (int)rs.getLong(1);
+			}
+		}
+		try (
+			PreparedStatement ps = prepareStatement(
+				"SELECT a.attnum" +
+				" FROM pg_catalog.pg_attribute AS a" +
+				" WHERE" +
+				"  a.attrelid OPERATOR(pg_catalog.=) CAST(? AS pg_catalog.oid)" +
+				"  AND a.attname OPERATOR(pg_catalog.=) ?" +
+				"  AND a.attnum OPERATOR(pg_catalog.>) 0" +
+				"  AND NOT a.attisdropped");
+		)
+		{
+			ps.setLong(1, relOid & 0xffffffffL);
+			for ( int i = 0 ; i < columns.length ; ++ i )
+			{
+				Identifier.Simple col = Identifier.Simple.fromJava(columns[i]);
+				ps.setString(2, col.pgFolded());
+				try ( ResultSet rs = ps.executeQuery() )
+				{
+					if ( ! rs.next() )
+						throw new SQLSyntaxErrorException(
+							"column " + col + " of relation " + rel +
+							" does not exist", "42703");
+					attnums[i] = rs.getShort(1);
+				}
+			}
+		}
+		return new SPIRelationLookup(relOid, 0, attnums);
+	}
+
 	@Override
 	public boolean isWrapperFor(Class<?> iface)
 	throws SQLException
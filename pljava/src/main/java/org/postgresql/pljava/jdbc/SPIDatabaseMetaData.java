@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2005-2020 Tada AB and other contributors, as listed below.
+ * Copyright (c) 2005-2026 Tada AB and other contributors, as listed below.
  *
  * All rights reserved. This program and the accompanying materials
  * are made available under the terms of the The BSD 3-Clause License
@@ -2947,8 +2947,8 @@ public class SPIDatabaseMetaData implements DatabaseMetaData
 	 */
 	public boolean supportsResultSetType(int type) throws SQLException
 	{
-		// The only type we support
-		return type == java.sql.ResultSet.TYPE_FORWARD_ONLY;
+		return type == java.sql.ResultSet.TYPE_FORWARD_ONLY
+			|| type == java.sql.ResultSet.TYPE_SCROLL_INSENSITIVE;
 	}
 
 	/*
@@ -2962,7 +2962,7 @@ public class SPIDatabaseMetaData implements DatabaseMetaData
 	throws SQLException
 	{
 		// These combinations are not supported!
-		if(type != java.sql.ResultSet.TYPE_FORWARD_ONLY)
+		if(!supportsResultSetType(type))
 			return false;
 
 		// We support only Concur Read Only
@@ -3407,7 +3407,8 @@ public class SPIDatabaseMetaData implements DatabaseMetaData
 	public boolean supportsResultSetHoldability(int holdability)
 	throws SQLException
 	{
-		return ResultSet.CLOSE_CURSORS_AT_COMMIT == holdability;
+		return ResultSet.CLOSE_CURSORS_AT_COMMIT == holdability
+			|| ResultSet.HOLD_CURSORS_OVER_COMMIT == holdability;
 	}
 
 	/**
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2004-2020 Tada AB and other contributors, as listed below.
+ * Copyright (c) 2004-2026 Tada AB and other contributors, as listed below.
  *
  * All rights reserved. This program and the accompanying materials
  * are made available under the terms of the The BSD 3-Clause License
@@ -30,6 +30,7 @@ import java.sql.Ref;
 import java.sql.ResultSet;
 import java.sql.ResultSetMetaData;
 import java.sql.RowId;
+import java.sql.SQLDataException;
 import java.sql.SQLException;
 import java.sql.SQLFeatureNotSupportedException;
 import java.sql.Time;
@@ -38,7 +39,9 @@ import java.sql.Types;
 import java.sql.SQLXML;
 import java.util.Arrays;
 import java.util.Calendar;
+import java.util.List;
 
+import org.postgresql.pljava.PlanControl;
 import org.postgresql.pljava.internal.ExecutionPlan;
 import org.postgresql.pljava.internal.Oid;
 
@@ -46,17 +49,26 @@ import org.postgresql.pljava.internal.Oid;
  * Implementation of {@link PreparedStatement} for the SPI connection.
  * @author Thomas Hallgren
  */
-public class SPIPreparedStatement extends SPIStatement implements PreparedStatement
+public class SPIPreparedStatement extends SPIStatement
+implements PreparedStatement, PlanControl
 {
 	private final Oid[]    m_typeIds;
 	private final Object[] m_values;
 	private final int[]    m_sqlTypes;
 	private final String   m_statement;
 	private ExecutionPlan  m_plan;
+	private PlanMode       m_planMode = PlanMode.DEFAULT;
 
 	public SPIPreparedStatement(SPIConnection conn, String statement, int paramCount)
 	{
-		super(conn);
+		this(conn, statement, paramCount, ResultSet.TYPE_FORWARD_ONLY,
+			ResultSet.CLOSE_CURSORS_AT_COMMIT);
+	}
+
+	public SPIPreparedStatement(SPIConnection conn, String statement,
+		int paramCount, int resultSetType, int holdability)
+	{
+		super(conn, resultSetType, holdability);
 		m_statement = statement;
 		m_typeIds   = new Oid[paramCount];
 		m_values    = new Object[paramCount];
@@ -77,6 +89,41 @@ public class SPIPreparedStatement extends SPIStatement implements PreparedStatem
 		super.close();
 	}
 
+	@Override
+	public void setPlanMode(PlanMode mode) throws SQLException
+	{
+		if ( null == mode )
+			throw new SQLDataException(
+				"plan mode may not be null", "22004");
+		if ( mode == m_planMode )
+			return;
+		m_planMode = mode;
+		if(m_plan != null)
+		{
+			m_plan.close();
+			m_plan = null;
+		}
+	}
+
+	@Override
+	public PlanMode getPlanMode() throws SQLException
+	{
+		return m_planMode;
+	}
+
+	private ExecutionPlan prepare() throws SQLException
+	{
+		short mode;
+		switch ( m_planMode )
+		{
+		case GENERIC: mode = ExecutionPlan.PLAN_MODE_GENERIC; break;
+		case CUSTOM:  mode = ExecutionPlan.PLAN_MODE_CUSTOM;  break;
+		default:      mode = ExecutionPlan.PLAN_MODE_DEFAULT; break;
+		}
+		return ExecutionPlan.prepare(
+			m_statement, m_typeIds, (short)(mode | scrollPlanMode()));
+	}
+
 	@Override
 	public ResultSet executeQuery()
 	throws SQLException
@@ -338,7 +385,7 @@ public class SPIPreparedStatement extends SPIStatement implements PreparedStatem
 				throw new SQLException("Not all parameters have been set");
 
 		if(m_plan == null)
-			m_plan = ExecutionPlan.prepare(m_statement, m_typeIds);
+			m_plan = prepare();
 
 		boolean result = executePlan(m_plan, m_values);
 		clearParameters(); // Parameters are cleared upon successful completion.
@@ -517,6 +564,67 @@ public class SPIPreparedStatement extends SPIStatement implements PreparedStatem
 		return new SPIParameterMetaData(getSqlTypes());
 	}
 
+	/**
+	 * Executes the batch, in runs of consecutive entries with the same
+	 * parameter types: when the plan for such a run is not a cursor plan, all of
+	 * its entries are executed by a single
+	 * {@link ExecutionPlan#executeBatch ExecutionPlan.executeBatch} call;
+	 * otherwise, one entry at a time.
+	 */
+	@Override
+	public long[] executeLargeBatch()
+	throws SQLException
+	{
+		List<Object> batch = batchEntries();
+		int numBatches = batch.size();
+		long[] result = new long[numBatches];
+		int start = 0;
+		while(start < numBatches)
+		{
+			Oid[] typeIds = (Oid[])((Object[])batch.get(start))[2];
+			int end = start + 1;
+			while(end < numBatches && Arrays.equals(
+				typeIds, (Object[])((Object[])batch.get(end))[2]))
+				++end;
+
+			if(!Arrays.equals(typeIds, m_typeIds))
+			{
+				if(m_plan != null)
+				{
+					m_plan.close();
+					m_plan = null;
+				}
+				System.arraycopy(typeIds, 0, m_typeIds, 0, m_typeIds.length);
+			}
+			if(m_plan == null)
+				m_plan = prepare();
+
+			if(m_plan.isCursorPlan())
+			{
+				for(int idx = start; idx < end; ++idx)
+					result[idx] = executeBatchEntry(batch.get(idx));
+			}
+			else
+			{
+				Object[][] rows = new Object[end - start][];
+				for(int idx = start; idx < end; ++idx)
+				{
+					Object[] entry = (Object[])batch.get(idx);
+					for(int sqlType : (int[])entry[1])
+						if(sqlType == Types.NULL)
+							throw new SQLException(
+								"Not all parameters have been set");
+					rows[idx - start] = (Object[])entry[0];
+				}
+				long[] counts = executePlanBatch(m_plan, rows);
+				System.arraycopy(counts, 0, result, start, counts.length);
+			}
+			start = end;
+		}
+		clearParameters();
+		return result;
+	}
+
 	protected long executeBatchEntry(Object batchEntry)
 	throws SQLException
 	{
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+package org.postgresql.pljava.jdbc;
+
+import java.sql.ResultSet;
+import java.sql.SQLDataException;
+import java.sql.SQLException;
+
+import org.postgresql.pljava.RelationScan;
+import org.postgresql.pljava.internal.Relation;
+
+/**
+ * Implementation of {@link RelationScan.Lookup} over
+ * {@link Relation#scan Relation.scan}, for a table and index already resolved
+ * by {@link SPIConnection}.
+ */
+class SPIRelationLookup implements RelationScan.Lookup
+{
+	private final int m_relOid;
+	private final int m_indexOid;
+	private final int[] m_attnums;
+	private int m_maxRows;
+
+	/**
+	 * @param attnums null for an index lookup, else the column numbers to
+	 * compare in a sequential scan.
+	 */
+	SPIRelationLookup(int relOid, int indexOid, int[] attnums)
+	{
+		m_relOid = relOid;
+		m_indexOid = indexOid;
+		m_attnums = null == attnums ? new int [ 0 ] : attnums;
+	}
+
+	@Override
+	public void setMaxRows(int maxRows) throws SQLException
+	{
+		if ( 0 > maxRows )
+			throw new SQLDataException(
+				"lookup row limit must not be negative", "22023");
+		m_maxRows = maxRows;
+	}
+
+	@Override
+	public ResultSet find(Object... keys) throws SQLException
+	{
+		return new TupleTableResultSet(
+			Relation.scan(m_relOid, m_indexOid, m_attnums, keys, m_maxRows));
+	}
+}
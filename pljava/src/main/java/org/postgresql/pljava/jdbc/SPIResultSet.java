@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2004-2018 Tada AB and other contributors, as listed below.
+ * Copyright (c) 2004-2026 Tada AB and other contributors, as listed below.
  *
  * All rights reserved. This program and the accompanying materials
  * are made available under the terms of the The BSD 3-Clause License
@@ -16,16 +16,25 @@ import java.sql.SQLException;
 import java.sql.Statement;
 import java.sql.ResultSetMetaData;
 
+import org.postgresql.pljava.TupleAccessor;
+import org.postgresql.pljava.internal.Backend;
 import org.postgresql.pljava.internal.Portal;
-import org.postgresql.pljava.internal.SPI;
 import org.postgresql.pljava.internal.TupleTable;
 import org.postgresql.pljava.internal.Tuple;
 import org.postgresql.pljava.internal.TupleDesc;
 
+import static org.postgresql.pljava.jdbc.TypeOid.BOOLOID;
+import static org.postgresql.pljava.jdbc.TypeOid.FLOAT4OID;
+import static org.postgresql.pljava.jdbc.TypeOid.FLOAT8OID;
+import static org.postgresql.pljava.jdbc.TypeOid.INT2OID;
+import static org.postgresql.pljava.jdbc.TypeOid.INT4OID;
+import static org.postgresql.pljava.jdbc.TypeOid.INT8OID;
+
 /**
  * A Read-only ResultSet that provides direct access to a {@link
- * org.postgresql.pljava.internal.Portal Portal}. At present, only
- * forward positioning is implemented. Attempts to use reverse or
+ * org.postgresql.pljava.internal.Portal Portal}. Unless the statement was made
+ * {@link java.sql.ResultSet#TYPE_SCROLL_INSENSITIVE TYPE_SCROLL_INSENSITIVE},
+ * only forward positioning is implemented, and attempts to use reverse or
  * absolute positioning will fail.
  *
  * @author Thomas Hallgren
@@ -36,15 +45,37 @@ public class SPIResultSet extends ResultSetBase
 	private final Portal    m_portal;
 	private final TupleDesc m_tupleDesc;
 	private final long      m_maxRows;
+	private final boolean   m_scrollable;
+	private final int       m_holdability;
+	private int             m_fetchDirection;
 
 	private Tuple m_currentRow;
 	private Tuple m_nextRow;
 
+	/*
+	 * The table, and index within it, that m_currentRow (or m_nextRow) came
+	 * from, for access to its columnar values, if any.
+	 */
+	private TupleTable m_currentTable;
+	private int m_currentTableRow;
+	private TupleTable m_nextTable;
+
 	private TupleTable m_table;
 	private int m_tableRow;
 
 	private boolean m_open;
 
+	/*
+	 * Set by the primitive getters of Tuple to tell whether the value was null.
+	 */
+	private final boolean[] m_wasNullOut = new boolean[1];
+
+	/*
+	 * Bytes of rows to aim for in each fetch, when the fetch size is being
+	 * adjusted from batch to batch; else zero.
+	 */
+	private long m_fetchMemory;
+
 	SPIResultSet(SPIStatement statement, Portal portal, long maxRows)
 	throws SQLException
 	{
@@ -55,6 +86,39 @@ public class SPIResultSet extends ResultSetBase
 		m_tupleDesc = portal.getTupleDesc();
 		m_tableRow = -1;
 		m_open = true;
+		m_fetchMemory = Backend.getSPIFetchMemory();
+		m_scrollable =
+			TYPE_SCROLL_INSENSITIVE == statement.getResultSetType();
+		m_holdability = statement.getResultSetHoldability();
+		m_fetchDirection = statement.getFetchDirection();
+	}
+
+	/**
+	 * Sets the fetch size, which will then no longer be adjusted
+	 * automatically for {@code pljava.spi_fetch_memory}.
+	 */
+	@Override
+	public void setFetchSize(int fetchSize)
+	throws SQLException
+	{
+		super.setFetchSize(fetchSize);
+		m_fetchMemory = 0;
+	}
+
+	/**
+	 * Adjust the fetch size toward the number of rows, of the average size
+	 * seen in the last fetch, that would occupy {@code m_fetchMemory}.
+	 * It is allowed at most to double from one fetch to the next, so that a
+	 * sample of small rows does not lead straight to a huge fetch.
+	 */
+	private void adaptFetchSize(long rows, long bytes)
+	throws SQLException
+	{
+		long perRow = Math.max(1L, bytes / rows);
+		long target = m_fetchMemory / perRow;
+		long next = Math.min(target, 2L * this.getFetchSize());
+		next = Math.max(1L, Math.min(next, Integer.MAX_VALUE));
+		super.setFetchSize((int)next);
 	}
 
 	@Override
@@ -66,14 +130,184 @@ public class SPIResultSet extends ResultSetBase
 			m_open = false;
 			m_portal.close();
 			m_statement.resultSetClosed(this);
-			m_table      = null;
-			m_tableRow   = -1;
-			m_currentRow = null;
-			m_nextRow    = null;
+			discardRows();
 			super.close();
 		}
 	}
 
+	/**
+	 * Releases the rows held, fetched ahead or current, leaving no current
+	 * row.
+	 */
+	private void discardRows()
+	{
+		releaseTable(m_table);
+		m_table      = null;
+		m_tableRow   = -1;
+		m_currentRow = null;
+		m_nextRow    = null;
+		releaseTable(m_currentTable);
+		releaseTable(m_nextTable);
+		m_currentTable = null;
+		m_nextTable  = null;
+	}
+
+	@Override
+	public int getType()
+	throws SQLException
+	{
+		return m_scrollable ? TYPE_SCROLL_INSENSITIVE : TYPE_FORWARD_ONLY;
+	}
+
+	@Override
+	public int getHoldability()
+	throws SQLException
+	{
+		return m_holdability;
+	}
+
+	@Override
+	public int getFetchDirection()
+	throws SQLException
+	{
+		return m_fetchDirection;
+	}
+
+	/**
+	 * For a scrollable result set, records the direction as a hint; otherwise
+	 * only {@link #FETCH_FORWARD} is supported.
+	 */
+	@Override
+	public void setFetchDirection(int direction)
+	throws SQLException
+	{
+		if ( ! m_scrollable )
+		{
+			super.setFetchDirection(direction);
+			return;
+		}
+		if ( FETCH_FORWARD != direction  &&  FETCH_REVERSE != direction
+			&&  FETCH_UNKNOWN != direction )
+			throw new SQLException(
+				"invalid fetch direction " + direction, "22023");
+		m_fetchDirection = direction;
+	}
+
+	/**
+	 * Moves to the given row, counting from the end if negative, with
+	 * {@code FETCH ABSOLUTE} on the scrollable portal.
+	 *<p>
+	 * Rows fetched ahead are discarded; {@link #next next} afterward fetches
+	 * again from the new position. The {@code maxRows} limit of the statement
+	 * does not apply to scrolling.
+	 */
+	@Override
+	public boolean absolute(int row)
+	throws SQLException
+	{
+		if ( ! m_scrollable )
+			return super.absolute(row);
+		return fetchAbsolute(row);
+	}
+
+	@Override
+	public boolean relative(int rows)
+	throws SQLException
+	{
+		if ( ! m_scrollable )
+			return super.relative(rows);
+
+		long current = this.getLargeRow();
+		if ( current < 0 ) // after the last row
+		{
+			if ( rows >= 0 )
+				return false;
+			return fetchAbsolute(rows);
+		}
+		return fetchAbsolute(Math.max(0L, current + rows));
+	}
+
+	@Override
+	public boolean previous()
+	throws SQLException
+	{
+		if ( ! m_scrollable )
+			return super.previous();
+		return this.relative(-1);
+	}
+
+	@Override
+	public boolean first()
+	throws SQLException
+	{
+		if ( ! m_scrollable )
+			return super.first();
+		return fetchAbsolute(1);
+	}
+
+	@Override
+	public boolean last()
+	throws SQLException
+	{
+		if ( ! m_scrollable )
+			return super.last();
+		return fetchAbsolute(-1);
+	}
+
+	@Override
+	public void beforeFirst()
+	throws SQLException
+	{
+		if ( ! m_scrollable )
+		{
+			super.beforeFirst();
+			return;
+		}
+		Portal portal = this.getPortal();
+		discardRows();
+		portal.scrollMove(Portal.FETCH_ABSOLUTE, 0);
+		this.setRow(0);
+	}
+
+	@Override
+	public void afterLast()
+	throws SQLException
+	{
+		if ( ! m_scrollable )
+		{
+			super.afterLast();
+			return;
+		}
+		Portal portal = this.getPortal();
+		discardRows();
+		portal.scrollMove(Portal.FETCH_ABSOLUTE, -1);
+		portal.scrollMove(Portal.FETCH_FORWARD, 1);
+		this.setRow(-1);
+	}
+
+	/**
+	 * Fetches the one row at the given position, as {@code FETCH ABSOLUTE}
+	 * does, and makes it the current row.
+	 */
+	private boolean fetchAbsolute(long row)
+	throws SQLException
+	{
+		Portal portal = this.getPortal();
+		discardRows();
+		TupleTable table =
+			portal.scrollFetchTable(Portal.FETCH_ABSOLUTE, row, m_tupleDesc, null);
+		if ( null == table )
+		{
+			this.setRow(portal.isAtStart() ? 0 : -1);
+			return false;
+		}
+		m_currentTable = table;
+		m_currentTableRow = 0;
+		m_currentRow = table.getSlot(0);
+		this.setRow(portal.getPortalPos());
+		return true;
+	}
+
 	@Override
 	public boolean isLast() throws SQLException
 	{
@@ -85,9 +319,14 @@ public class SPIResultSet extends ResultSetBase
 	throws SQLException
 	{
 		m_currentRow = this.peekNext();
-		m_nextRow = null;
 		boolean result = (m_currentRow != null);
-		this.setRow(result ? this.getRow() + 1 : -1);
+		TupleTable previous = m_currentTable;
+		m_currentTable = result ? m_nextTable : null;
+		m_currentTableRow = m_tableRow;
+		m_nextRow = null;
+		if ( previous != m_currentTable )
+			releaseTable(previous);
+		this.setRow(result ? this.getLargeRow() + 1 : -1);
 		return result;
 	}
 
@@ -154,21 +393,28 @@ public class SPIResultSet extends ResultSetBase
 			else
 				mx = fetchSize;
 
-			try
-			{
-				long result = portal.fetch(true, mx);
-				if(result > 0)
-					m_table = SPI.getTupTable(m_tupleDesc);
-				m_tableRow = -1;
-			}
-			finally
-			{
-				SPI.freeTupTable();
-			}
+			long[] counts = m_fetchMemory > 0 ? new long [ 2 ] : null;
+			m_table = portal.fetchTable(true, mx, m_tupleDesc, counts);
+			if(m_table != null && counts != null)
+				adaptFetchSize(counts[0], counts[1]);
+			m_tableRow = -1;
 		}
 		return m_table;
 	}
 
+	/**
+	 * Release a table no longer needed, freeing its native tuples, whether
+	 * borrowed from SPI (see {@code pljava.spi_borrowed_tuples}) or copied. A
+	 * table is only released once the current row has moved past it, as
+	 * {@link #isLast} may already have fetched the next one. Values already
+	 * retrieved from its rows are copies, and remain usable after the release.
+	 */
+	private static void releaseTable(TupleTable table)
+	{
+		if ( null != table )
+			table.release();
+	}
+
 	/**
 	 * Return the {@link Tuple} most recently returned by {@link #next}.
 	 */
@@ -205,6 +451,7 @@ public class SPIResultSet extends ResultSetBase
 				return null;
 		}
 		m_nextRow = table.getSlot(++m_tableRow);
+		m_nextTable = table;
 		return m_nextRow;
 	}
 
@@ -216,7 +463,122 @@ public class SPIResultSet extends ResultSetBase
 	protected Object getObjectValue(int columnIndex, Class<?> type)
 	throws SQLException
 	{
-		return this.getCurrentRow().getObject(m_tupleDesc, columnIndex, type);
+		Tuple row = this.getCurrentRow();
+		if ( null == type )
+		{
+			Object value =
+				m_currentTable.getColumnarObject(m_currentTableRow, columnIndex);
+			if ( TupleTable.NOT_COLUMNAR != value )
+				return value;
+		}
+		return row.getObject(m_tupleDesc, columnIndex, type);
+	}
+
+	/**
+	 * Implemented over {@link Tuple#getInt Tuple.getInt} for a column of type
+	 * {@code smallint} or {@code integer} not held in columnar form, without
+	 * boxing the value; otherwise as in {@link ObjectResultSet}.
+	 */
+	@Override
+	public int getInt(int columnIndex)
+	throws SQLException
+	{
+		int oid = directOid(columnIndex);
+		if ( INT2OID != oid  &&  INT4OID != oid )
+			return super.getInt(columnIndex);
+		int result =
+			getCurrentRow().getInt(m_tupleDesc, columnIndex, m_wasNullOut);
+		setWasNull(m_wasNullOut[0]);
+		return result;
+	}
+
+	/**
+	 * Implemented over {@link Tuple#getLong Tuple.getLong} for a column of an
+	 * integral type not held in columnar form, without boxing the value;
+	 * otherwise as in {@link ObjectResultSet}.
+	 */
+	@Override
+	public long getLong(int columnIndex)
+	throws SQLException
+	{
+		int oid = directOid(columnIndex);
+		if ( INT2OID != oid  &&  INT4OID != oid  &&  INT8OID != oid )
+			return super.getLong(columnIndex);
+		long result =
+			getCurrentRow().getLong(m_tupleDesc, columnIndex, m_wasNullOut);
+		setWasNull(m_wasNullOut[0]);
+		return result;
+	}
+
+	/**
+	 * Implemented over {@link Tuple#getDouble Tuple.getDouble} for a column of
+	 * type {@code real} or {@code double precision} not held in columnar form,
+	 * without boxing the value; otherwise as in {@link ObjectResultSet}.
+	 */
+	@Override
+	public double getDouble(int columnIndex)
+	throws SQLException
+	{
+		int oid = directOid(columnIndex);
+		if ( FLOAT4OID != oid  &&  FLOAT8OID != oid )
+			return super.getDouble(columnIndex);
+		double result =
+			getCurrentRow().getDouble(m_tupleDesc, columnIndex, m_wasNullOut);
+		setWasNull(m_wasNullOut[0]);
+		return result;
+	}
+
+	/**
+	 * Implemented over {@link Tuple#getBoolean Tuple.getBoolean} for a column
+	 * of type {@code boolean} not held in columnar form, without boxing the
+	 * value; otherwise as in {@link ObjectResultSet}.
+	 */
+	@Override
+	public boolean getBoolean(int columnIndex)
+	throws SQLException
+	{
+		if ( BOOLOID != directOid(columnIndex) )
+			return super.getBoolean(columnIndex);
+		boolean result =
+			getCurrentRow().getBoolean(m_tupleDesc, columnIndex, m_wasNullOut);
+		setWasNull(m_wasNullOut[0]);
+		return result;
+	}
+
+	/**
+	 * The type Oid of the column, if its value is to be fetched from the
+	 * current row's native tuple, or zero if it is held in columnar form, or
+	 * the index is out of range (left for the general path to report).
+	 */
+	private int directOid(int columnIndex)
+	throws SQLException
+	{
+		if ( null == m_currentTable  ||  m_currentTable.isColumnar(columnIndex)
+			||  1 > columnIndex  ||  columnIndex > m_tupleDesc.size() )
+			return 0;
+		return m_tupleDesc.getOid(columnIndex).intValue();
+	}
+
+	/**
+	 * Also wraps a {@link TupleAccessor} over the current row.
+	 */
+	@Override
+	public boolean isWrapperFor(Class<?> iface)
+	throws SQLException
+	{
+		return TupleAccessor.class == iface  ||  super.isWrapperFor(iface);
+	}
+
+	/**
+	 * Also unwraps to a new {@link TupleAccessor} over the current row.
+	 */
+	@Override
+	public <T> T unwrap(Class<T> iface)
+	throws SQLException
+	{
+		if ( TupleAccessor.class == iface )
+			return iface.cast(getCurrentRow().accessor(m_tupleDesc));
+		return super.unwrap(iface);
 	}
 
 	/**
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2004-2020 Tada AB and other contributors, as listed below.
+ * Copyright (c) 2004-2026 Tada AB and other contributors, as listed below.
  *
  * All rights reserved. This program and the accompanying materials
  * are made available under the terms of the The BSD 3-Clause License
@@ -20,6 +20,8 @@ import java.sql.SQLFeatureNotSupportedException;
 import java.sql.SQLWarning;
 import java.sql.Statement;
 import java.util.ArrayList;
+import java.util.Collections;
+import java.util.List;
 
 import org.postgresql.pljava.internal.ExecutionPlan;
 import org.postgresql.pljava.internal.Portal;
@@ -43,11 +45,39 @@ public class SPIStatement implements Statement, SPIReadOnlyControl
 	private long      m_updateCount    = 0;
 	private ArrayList<Object> m_batch  = null;
 	private boolean   m_closed         = false;
+	private boolean   m_closeOnCompletion = false;
 	private short     m_readonly_spec  = ExecutionPlan.SPI_READONLY_DEFAULT;
+	private int       m_fetchDirection = ResultSet.FETCH_FORWARD;
+
+	private final int m_resultSetType;
+	private final int m_holdability;
 
 	public SPIStatement(SPIConnection conn)
+	{
+		this(conn, ResultSet.TYPE_FORWARD_ONLY,
+			ResultSet.CLOSE_CURSORS_AT_COMMIT);
+	}
+
+	/**
+	 * Creates a statement whose result sets have the given type, either
+	 * {@link ResultSet#TYPE_FORWARD_ONLY} or
+	 * {@link ResultSet#TYPE_SCROLL_INSENSITIVE}, and holdability.
+	 */
+	public SPIStatement(SPIConnection conn, int resultSetType, int holdability)
 	{
 		m_connection = conn;
+		m_resultSetType = resultSetType;
+		m_holdability = holdability;
+	}
+
+	/**
+	 * The plan mode bit to OR into a plan mode when preparing a plan for this
+	 * statement: {@code PLAN_SCROLL} if its result sets are scrollable.
+	 */
+	final short scrollPlanMode()
+	{
+		return ResultSet.TYPE_SCROLL_INSENSITIVE == m_resultSetType
+			? ExecutionPlan.PLAN_SCROLL : 0;
 	}
 
 	public void addBatch(String statement)
@@ -106,7 +136,8 @@ public class SPIStatement implements Statement, SPIReadOnlyControl
 		this.clear();
 
 		ExecutionPlan plan = ExecutionPlan.prepare(
-			m_connection.nativeSQL(statement), null);
+			m_connection.nativeSQL(statement), null,
+			(short)(ExecutionPlan.PLAN_MODE_DEFAULT | scrollPlanMode()));
 
 		int result = SPI.getResult();
 		if(plan == null)
@@ -131,8 +162,9 @@ public class SPIStatement implements Statement, SPIReadOnlyControl
 		boolean isResultSet = plan.isCursorPlan();
 		if(isResultSet)
 		{
-			Portal portal = plan.cursorOpen(
-				m_cursorName, paramValues, m_readonly_spec);
+			Portal portal = plan.cursorOpen(m_cursorName, paramValues,
+				m_readonly_spec,
+				ResultSet.HOLD_CURSORS_OVER_COMMIT == m_holdability);
 			m_resultSet = new SPIResultSet(this, portal, m_maxRows);
 		}
 		else
@@ -183,11 +215,11 @@ public class SPIStatement implements Statement, SPIReadOnlyControl
 	public int[] executeBatch()
 	throws SQLException
 	{
-		int numBatches = (m_batch == null) ? 0 : m_batch.size();
-		int[] result = new int[numBatches];
-		for(int idx = 0; idx < numBatches; ++idx)
+		long[] counts = this.executeLargeBatch();
+		int[] result = new int[counts.length];
+		for(int idx = 0; idx < counts.length; ++idx)
 		{
-			long count = this.executeBatchEntry(m_batch.get(idx));
+			long count = counts[idx];
 			result[idx] = (count > Integer.MAX_VALUE)
 				? SUCCESS_NO_INFO : (int)count;
 		}
@@ -267,7 +299,7 @@ public class SPIStatement implements Statement, SPIReadOnlyControl
 	public int getFetchDirection()
 	throws SQLException
 	{
-		return ResultSet.FETCH_FORWARD;
+		return m_fetchDirection;
 	}
 	
 	public int getFetchSize()
@@ -326,12 +358,12 @@ public class SPIStatement implements Statement, SPIReadOnlyControl
 	public int getResultSetHoldability()
 	throws SQLException
 	{
-		throw new SQLException("JDK 1.4 functionality not yet implemented");
+		return m_holdability;
 	}
 
 	public int getResultSetType()
 	{
-		return ResultSet.TYPE_FORWARD_ONLY;
+		return m_resultSetType;
 	}
 
 	public int getUpdateCount()
@@ -373,15 +405,24 @@ public class SPIStatement implements Statement, SPIReadOnlyControl
 
 
 	/**
-	 * Only {@link ResultSet#FETCH_FORWARD} is supported.
+	 * Only {@link ResultSet#FETCH_FORWARD} is supported, unless the statement
+	 * is {@link ResultSet#TYPE_SCROLL_INSENSITIVE}, when the direction is
+	 * accepted as the hint it is, and passed on to result sets.
 	 * @throws SQLException indicating that this feature is not supported
 	 * for other values on <code>direction</code>.
 	 */
 	public void setFetchDirection(int direction)
 	throws SQLException
 	{
-		if(direction != ResultSet.FETCH_FORWARD)
+		if(direction != ResultSet.FETCH_FORWARD
+			&& m_resultSetType != ResultSet.TYPE_SCROLL_INSENSITIVE)
 			throw new UnsupportedFeatureException("Non forward fetch direction");
+		if(direction != ResultSet.FETCH_FORWARD
+			&& direction != ResultSet.FETCH_REVERSE
+			&& direction != ResultSet.FETCH_UNKNOWN)
+			throw new SQLException(
+				"invalid fetch direction " + direction, "22023");
+		m_fetchDirection = direction;
 	}
 
 	public void setFetchSize(int size)
@@ -422,6 +463,27 @@ public class SPIStatement implements Statement, SPIReadOnlyControl
 		m_batch.add(batch);
 	}
 
+	/**
+	 * The entries added by {@link #internalAddBatch internalAddBatch}, in
+	 * order; an empty list if there are none.
+	 */
+	protected List<Object> batchEntries()
+	{
+		return (m_batch == null) ? Collections.emptyList() : m_batch;
+	}
+
+	/**
+	 * Execute a non-cursor plan once for each of {@code rows} of parameter
+	 * values, with this statement's read-only and max-rows settings.
+	 */
+	protected long[] executePlanBatch(ExecutionPlan plan, Object[][] rows)
+	throws SQLException
+	{
+		m_updateCount = -1;
+		m_resultSet   = null;
+		return plan.executeBatch(rows, m_readonly_spec, m_maxRows);
+	}
+
 	protected long executeBatchEntry(Object batchEntry)
 	throws SQLException
 	{
@@ -436,7 +498,14 @@ public class SPIStatement implements Statement, SPIReadOnlyControl
 	void resultSetClosed(ResultSet rs)
 	{
 		if(rs == m_resultSet)
+		{
 			m_resultSet = null;
+			if(m_closeOnCompletion)
+			{
+				m_batch = null;
+				m_closed = true;
+			}
+		}
 	}
 
 	// ************************************************************
@@ -463,9 +532,14 @@ public class SPIStatement implements Statement, SPIReadOnlyControl
 		  "0A000" );
 	}
 
+	public void closeOnCompletion() throws SQLException
+	{
+		m_closeOnCompletion = true;
+	}
+
 	public boolean isCloseOnCompletion() throws SQLException
 	{
-		return false;
+		return m_closeOnCompletion;
 	}
 
 	// ************************************************************
@@ -499,14 +573,6 @@ public class SPIStatement implements Statement, SPIReadOnlyControl
 		  "0A000" );
 	}
 
-	public void closeOnCompletion() throws SQLException
-	{
-	    throw new SQLFeatureNotSupportedException
-		( this.getClass()
-		  + ".closeOneCompletion() not implemented yet.",
-		  "0A000" );
-	}
-
 	// ************************************************************
 	// Implementation of the SPIReadOnlyControl extended interface
 	// ************************************************************
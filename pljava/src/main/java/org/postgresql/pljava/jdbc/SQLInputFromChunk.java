@@ -56,6 +56,12 @@ public class SQLInputFromChunk implements SQLInput
 {
 	private ByteBuffer m_bb;
 
+	/*
+	 * The buffer to read again when the native code reuses this instance,
+	 * as it does for values small enough to copy into a buffer of its own.
+	 */
+	private ByteBuffer m_kept;
+
 	private static ByteOrder scalarOrder;
 	private static ByteOrder mirrorOrder;
 
@@ -75,6 +81,21 @@ public class SQLInputFromChunk implements SQLInput
 				mirrorOrder = getOrder(false);
 			m_bb.order(mirrorOrder);
 		}
+		m_kept = m_bb;
+	}
+
+	/**
+	 * Called from native code to ready this instance to read the first
+	 * <var>length</var> bytes of its buffer, having just copied a new value
+	 * there; <var>bb</var>, if not null, replaces the buffer.
+	 */
+	private void reset(ByteBuffer bb, int length)
+	{
+		if ( null != bb )
+			m_kept = bb.order(m_kept.order());
+		m_bb = m_kept;
+		m_bb.clear();
+		m_bb.limit(length);
 	}
 
 	private ByteOrder getOrder(boolean isJavaBasedScalar) throws SQLException
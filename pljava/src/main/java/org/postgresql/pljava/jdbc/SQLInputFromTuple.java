@@ -39,6 +39,11 @@ import org.postgresql.pljava.internal.TupleDesc;
  * Implements the {@code SQLInput} interface for a user-defined type (UDT)
  * implemented in Java, for the case where a composite type in PostgreSQL is
  * used as the UDT's representation, so it can be accessed as a PG tuple.
+ *<p>
+ * The native code deforms the tuple and supplies every field, as its default
+ * Java class, when the instance is made; a read that asks for that class (as
+ * nearly all do) is answered from that array, and only a read asking for some
+ * other class goes back to the native tuple.
  *
  * @author Thomas Hallgren
  */
@@ -46,19 +51,35 @@ public class SQLInputFromTuple extends SingleRowReader implements SQLInput
 {
 	private int m_index;
 	private final int m_columns;
+	private final Object[] m_values;
 
 	/**
-	 * Construct an instance, given the (native) pointer to a PG
-	 * {@code HeapTupleHeader}, as well as the TupleDesc (Java object this time)
-	 * describing its structure.
+	 * Construct an instance, given the (native) pointer to the reader state
+	 * for a PG {@code HeapTupleHeader}, the TupleDesc (Java object this time)
+	 * describing its structure, and the values of its fields.
 	 */
 	public SQLInputFromTuple(DualState.Key cookie, long resourceOwner,
-		long heapTupleHeaderPointer, TupleDesc tupleDesc)
+		long heapTupleHeaderPointer, TupleDesc tupleDesc, Object[] values)
 	throws SQLException
 	{
 		super(cookie, resourceOwner, heapTupleHeaderPointer, tupleDesc);
 		m_index = 0;
 		m_columns = tupleDesc.size();
+		m_values = values;
+	}
+
+	/**
+	 * Return the value supplied at construction, unless a class other than the
+	 * default is requested.
+	 */
+	@Override
+	protected Object getObjectValue(int columnIndex, Class<?> type)
+	throws SQLException
+	{
+		if ( null == type  &&  0 < columnIndex
+			&&  columnIndex <= m_values.length )
+			return m_values[columnIndex - 1];
+		return super.getObjectValue(columnIndex, type);
 	}
 
 	protected int nextIndex() throws SQLException
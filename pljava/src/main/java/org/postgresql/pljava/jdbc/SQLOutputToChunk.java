@@ -66,6 +66,12 @@ public class SQLOutputToChunk implements SQLOutput
 	private long m_handle;
 	private ByteBuffer m_bb;
 
+	/*
+	 * The buffer to write again when the native code reuses this instance,
+	 * over a StringInfo that it keeps between values.
+	 */
+	private ByteBuffer m_kept;
+
 	private static ByteOrder scalarOrder;
 	private static ByteOrder mirrorOrder;
 
@@ -389,9 +395,26 @@ public class SQLOutputToChunk implements SQLOutput
 			return;
 		ensureCapacity(0); /* propagate final position to native stringinfo */
 		m_handle = 0;
+		m_kept = m_bb;
 		m_bb = null;
 	}
 
+	/**
+	 * Called from native code to ready this instance, once closed, to write
+	 * again to the StringInfo <var>handle</var>, starting at
+	 * <var>position</var>; <var>bb</var>, if not null, replaces the buffer,
+	 * which the native code has moved.
+	 */
+	private void reset(long handle, ByteBuffer bb, int position)
+	{
+		m_handle = handle;
+		if ( null != bb )
+			m_kept = bb.order(m_kept.order());
+		m_bb = m_kept;
+		m_bb.clear();
+		m_bb.position(position);
+	}
+
 	private void throwOrRetry(Exception e, int needed, String fn)
 		throws SQLException
 	{
@@ -95,7 +95,12 @@ import java.util.regex.Pattern;
 import java.io.BufferedInputStream;
 import java.io.ByteArrayOutputStream;
 
+import java.util.ArrayList;
 import java.util.Arrays;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Map;
+import java.util.function.Consumer;
 
 import java.sql.SQLDataException;
 
@@ -634,10 +639,7 @@ public abstract class SQLXMLImpl<V extends VarlenaWrapper> implements SQLXML
 		boolean mustBeDocument = false;
 		boolean cantBeDocument = false;
 
-		XMLInputFactory xif = XMLInputFactory.newDefaultFactory();
-		xif.setProperty(xif.IS_NAMESPACE_AWARE, true);
-		xif.setProperty(xif.SUPPORT_DTD, false);// will still report one it sees
-		xif.setProperty(xif.IS_REPLACING_ENTITY_REFERENCES, false);
+		XMLInputFactory xif = ParserCache.get().sniffingInputFactory();
 
 		XMLStreamReader xsr = null;
 		try
@@ -1408,8 +1410,8 @@ public abstract class SQLXMLImpl<V extends VarlenaWrapper> implements SQLXML
 				if ( rc.isAssignableFrom(SAXResult.class)
 					|| rc.isAssignableFrom(AdjustingSAXResult.class) )
 				{
-					SAXTransformerFactory saxtf = (SAXTransformerFactory)
-						SAXTransformerFactory.newDefaultInstance();
+					SAXTransformerFactory saxtf =
+						ParserCache.get().transformerFactory();
 					TransformerHandler th = saxtf.newTransformerHandler();
 					th.getTransformer().setOutputProperty(
 						ENCODING, m_serverCS.name());
@@ -1426,7 +1428,7 @@ public abstract class SQLXMLImpl<V extends VarlenaWrapper> implements SQLXML
 
 				if ( rc.isAssignableFrom(StAXResult.class) )
 				{
-					XMLOutputFactory xof = XMLOutputFactory.newDefaultFactory();
+					XMLOutputFactory xof = ParserCache.get().outputFactory();
 					os = new DeclCheckedOutputStream(os, m_serverCS);
 					XMLStreamWriter xsw = xof.createXMLStreamWriter(
 						os, m_serverCS.name());
@@ -1459,7 +1461,7 @@ public abstract class SQLXMLImpl<V extends VarlenaWrapper> implements SQLXML
 			DOMSource src = new DOMSource(r.getNode());
 			try
 			{
-				TransformerFactory tf = TransformerFactory.newDefaultInstance();
+				TransformerFactory tf = ParserCache.get().transformerFactory();
 				Transformer t = tf.newTransformer();
 				t.setOutputProperty(ENCODING, m_serverCS.name());
 				os = new DeclCheckedOutputStream(os, m_serverCS);
@@ -4018,9 +4020,9 @@ public abstract class SQLXMLImpl<V extends VarlenaWrapper> implements SQLXML
 			{
 				StAXResult str = m_tgt.setResult(
 					m_tgt.backingIfNotFreed(), StAXResult.class);
-				XMLInputFactory  xif = XMLInputFactory.newDefaultFactory();
-				xif.setProperty(xif.IS_NAMESPACE_AWARE, true);
-				XMLOutputFactory xof = XMLOutputFactory.newDefaultFactory();
+				ParserCache cache = ParserCache.get();
+				XMLInputFactory  xif = cache.namespaceAwareInputFactory();
+				XMLOutputFactory xof = cache.outputFactory();
 				/*
 				 * The Source has either an event reader or a stream reader. Use
 				 * the event reader directly, or create one around the stream
@@ -4135,6 +4137,179 @@ public abstract class SQLXMLImpl<V extends VarlenaWrapper> implements SQLXML
 		}
 	}
 
+	/**
+	 * Per-thread cache of the JAXP factories (and, for DOM, parsers) used in
+	 * reading and writing SQLXML values, whose construction can cost more than
+	 * the parsing of a small value.
+	 *<p>
+	 * Factories that are used with fixed settings are simply kept once made.
+	 * A StAX factory or DOM parser whose settings depend on the
+	 * {@code Adjusting.XML} adjustments applied is kept under a key recording
+	 * those adjustments in order, so that another value read with the same
+	 * adjustments (most often, only the defaults) can use it again. A DOM
+	 * parser, which is only used within {@code get()}, is taken out of the
+	 * cache while in use and reset when returned. A SAX parser cannot be
+	 * reused that way, its use continuing after {@code get()} returns, so only
+	 * its factory is kept, by the schema (if any) it validates against.
+	 *<p>
+	 * Each map is simply cleared if it fills, as a thread is not expected to
+	 * use more than a few different sets of adjustments.
+	 */
+	static final class ParserCache
+	{
+		private static final int MAX_KEYS = 16;
+
+		private static final ThreadLocal<ParserCache> s_instance =
+			ThreadLocal.withInitial(ParserCache::new);
+
+		private SAXTransformerFactory m_transformerFactory;
+		private XMLOutputFactory m_outputFactory;
+		private XMLInputFactory m_namespaceAwareInputFactory;
+		private XMLInputFactory m_sniffingInputFactory;
+
+		private final Map<Schema,SAXParserFactory> m_saxParserFactories =
+			new HashMap<>();
+		private final Map<List<Object>,XMLInputFactory> m_inputFactories =
+			new HashMap<>();
+		private final Map<List<Object>,DocumentBuilder> m_documentBuilders =
+			new HashMap<>();
+
+		private ParserCache() { }
+
+		static ParserCache get()
+		{
+			return s_instance.get();
+		}
+
+		SAXTransformerFactory transformerFactory()
+		{
+			if ( null == m_transformerFactory )
+				m_transformerFactory = (SAXTransformerFactory)
+					SAXTransformerFactory.newDefaultInstance();
+			return m_transformerFactory;
+		}
+
+		XMLOutputFactory outputFactory()
+		{
+			if ( null == m_outputFactory )
+				m_outputFactory = XMLOutputFactory.newDefaultFactory();
+			return m_outputFactory;
+		}
+
+		XMLInputFactory namespaceAwareInputFactory()
+		{
+			if ( null == m_namespaceAwareInputFactory )
+			{
+				XMLInputFactory xif = XMLInputFactory.newDefaultFactory();
+				xif.setProperty(xif.IS_NAMESPACE_AWARE, true);
+				m_namespaceAwareInputFactory = xif;
+			}
+			return m_namespaceAwareInputFactory;
+		}
+
+		/**
+		 * The factory for the quick look {@code useWrappingElement} takes at
+		 * the start of a value.
+		 */
+		XMLInputFactory sniffingInputFactory()
+		{
+			if ( null == m_sniffingInputFactory )
+			{
+				XMLInputFactory xif = XMLInputFactory.newDefaultFactory();
+				xif.setProperty(xif.IS_NAMESPACE_AWARE, true);
+				xif.setProperty(xif.SUPPORT_DTD, false);// still reports one
+				xif.setProperty(xif.IS_REPLACING_ENTITY_REFERENCES, false);
+				m_sniffingInputFactory = xif;
+			}
+			return m_sniffingInputFactory;
+		}
+
+		/**
+		 * A namespace-aware SAX parser factory, validating against
+		 * {@code schema} if it is not null.
+		 */
+		SAXParserFactory saxParserFactory(Schema schema)
+		{
+			SAXParserFactory spf = m_saxParserFactories.get(schema);
+			if ( null == spf )
+			{
+				spf = SAXParserFactory.newDefaultInstance();
+				spf.setNamespaceAware(true);
+				if ( null != schema )
+					spf.setSchema(schema);
+				bound(m_saxParserFactories);
+				m_saxParserFactories.put(schema, spf);
+			}
+			return spf;
+		}
+
+		/**
+		 * A namespace-aware StAX input factory with the adjustments recorded
+		 * in {@code settings}, made by applying {@code adjustments} if not
+		 * already cached.
+		 */
+		XMLInputFactory inputFactory(
+			List<Object> settings, List<Consumer<XMLInputFactory>> adjustments)
+		{
+			XMLInputFactory xif = m_inputFactories.get(settings);
+			if ( null == xif )
+			{
+				xif = XMLInputFactory.newDefaultFactory();
+				xif.setProperty(xif.IS_NAMESPACE_AWARE, true);
+				for ( Consumer<XMLInputFactory> a : adjustments )
+					a.accept(xif);
+				bound(m_inputFactories);
+				m_inputFactories.put(settings, xif);
+			}
+			return xif;
+		}
+
+		/**
+		 * A namespace-aware DOM parser with the adjustments recorded in
+		 * {@code settings}, made by applying {@code adjustments} if none is
+		 * cached; to be handed back with {@code giveDocumentBuilder} when done.
+		 */
+		DocumentBuilder takeDocumentBuilder(List<Object> settings,
+			List<Consumer<DocumentBuilderFactory>> adjustments)
+		throws ParserConfigurationException
+		{
+			DocumentBuilder db = m_documentBuilders.remove(settings);
+			if ( null != db )
+			{
+				try
+				{
+					db.reset();
+					return db;
+				}
+				catch ( UnsupportedOperationException e )
+				{
+					/* reset() is optional to implement; just make another */
+				}
+			}
+
+			DocumentBuilderFactory dbf =
+				DocumentBuilderFactory.newDefaultInstance();
+			dbf.setNamespaceAware(true);
+			for ( Consumer<DocumentBuilderFactory> a : adjustments )
+				a.accept(dbf);
+			return dbf.newDocumentBuilder();
+		}
+
+		void giveDocumentBuilder(List<Object> settings, DocumentBuilder db)
+		{
+			if ( m_documentBuilders.containsKey(settings) )
+				return;
+			bound(m_documentBuilders);
+			m_documentBuilders.put(settings, db);
+		}
+
+		private static void bound(Map<?,?> m)
+		{
+			if ( MAX_KEYS <= m.size() )
+				m.clear();
+		}
+	}
+
 	/**
 	 * Implements setters for the later JAXP security properties, which use the
 	 * same names for SAX, StAX, and DOM, so the individual setters can all be
@@ -4904,8 +5079,7 @@ public abstract class SQLXMLImpl<V extends VarlenaWrapper> implements SQLXML
 		{
 			m_is = is;
 			m_wrapped = wrapped;
-			m_spf = SAXParserFactory.newDefaultInstance();
-			m_spf.setNamespaceAware(true);
+			m_spf = ParserCache.get().saxParserFactory(null);
 		}
 
 		AdjustingSAXSource(XMLReader xr, InputSource is)
@@ -5085,7 +5259,8 @@ public abstract class SQLXMLImpl<V extends VarlenaWrapper> implements SQLXML
 		@Override
 		public AdjustingSAXSource schema(Schema schema)
 		{
-			theFactory().setSchema(schema);
+			theFactory();
+			m_spf = ParserCache.get().saxParserFactory(schema);
 			return this;
 		}
 	}
@@ -5184,7 +5359,13 @@ public abstract class SQLXMLImpl<V extends VarlenaWrapper> implements SQLXML
 	extends AdjustingJAXPParser<Adjusting.XML.Source<StAXSource>>
 	implements Adjusting.XML.StAXSource
 	{
-		private XMLInputFactory m_xif;
+		/*
+		 * Adjustments are recorded, rather than applied to a new factory, so a
+		 * factory cached for the same adjustments can be used; see ParserCache.
+		 */
+		private List<Object> m_settings = new ArrayList<>();
+		private List<Consumer<XMLInputFactory>> m_adjustments =
+			new ArrayList<>();
 		private InputStream m_is;
 		private Charset m_serverCS;
 		private boolean m_wrapped;
@@ -5192,8 +5373,6 @@ public abstract class SQLXMLImpl<V extends VarlenaWrapper> implements SQLXML
 		AdjustingStAXSource(InputStream is, Charset serverCS, boolean wrapped)
 		throws XMLStreamException
 		{
-			m_xif = XMLInputFactory.newDefaultFactory();
-			m_xif.setProperty(m_xif.IS_NAMESPACE_AWARE, true);
 			m_is = is;
 			m_serverCS = serverCS;
 			m_wrapped = wrapped;
@@ -5213,27 +5392,34 @@ public abstract class SQLXMLImpl<V extends VarlenaWrapper> implements SQLXML
 				"AdjustingStAXSource used before get()");
 		}
 
-		private XMLInputFactory theFactory()
+		private AdjustingStAXSource adjust(
+			Object value, String[] names, Consumer<XMLInputFactory> adjustment)
 		{
-			if ( null == m_xif )
+			if ( null == m_settings )
 				throw new IllegalStateException(
 					"AdjustingStAXSource too late to adjust after get()");
-			return m_xif;
+			m_settings.add(value);
+			m_settings.add(Arrays.asList(names));
+			m_adjustments.add(adjustment);
+			return this;
 		}
 
 		@Override
 		public StAXSource get() throws SQLException
 		{
-			if ( null == m_xif )
+			if ( null == m_settings )
 				throw new IllegalStateException(
 					"AdjustingStAXSource get() called more than once");
 			try
 			{
-				XMLStreamReader xsr = m_xif.createXMLStreamReader(
+				XMLInputFactory xif =
+					ParserCache.get().inputFactory(m_settings, m_adjustments);
+				XMLStreamReader xsr = xif.createXMLStreamReader(
 					m_is, m_serverCS.name());
 				if ( m_wrapped )
 					xsr = new StAXUnwrapFilter(xsr);
-				m_xif = null; // too late for any more adjustments
+				m_settings = null; // too late for any more adjustments
+				m_adjustments = null;
 				return new StAXSource(xsr);
 			}
 			catch ( Exception e )
@@ -5285,40 +5471,28 @@ public abstract class SQLXMLImpl<V extends VarlenaWrapper> implements SQLXML
 		public AdjustingStAXSource setFirstSupportedFeature(
 			boolean value, String... names)
 		{
-			XMLInputFactory xif = theFactory();
-			for ( String name : names )
-			{
-				try
-				{
-					xif.setProperty(name, value);
-					break;
-				}
-				catch ( IllegalArgumentException e )
-				{
-					e.printStackTrace(); // XXX
-				}
-			}
-			return this;
+			return setFirstSupportedProperty(value, names);
 		}
 
 		@Override
 		public AdjustingStAXSource setFirstSupportedProperty(
 			Object value, String... names)
 		{
-			XMLInputFactory xif = theFactory();
-			for ( String name : names )
+			return adjust(value, names, xif ->
 			{
-				try
+				for ( String name : names )
 				{
-					xif.setProperty(name, value);
-					break;
-				}
-				catch ( IllegalArgumentException e )
-				{
-					e.printStackTrace(); // XXX
+					try
+					{
+						xif.setProperty(name, value);
+						break;
+					}
+					catch ( IllegalArgumentException e )
+					{
+						e.printStackTrace(); // XXX
+					}
 				}
-			}
-			return this;
+			});
 		}
 	}
 
@@ -5326,15 +5500,19 @@ public abstract class SQLXMLImpl<V extends VarlenaWrapper> implements SQLXML
 	extends SAXDOMCommon<Adjusting.XML.Source<DOMSource>>
 	implements Adjusting.XML.DOMSource
 	{
-		private DocumentBuilderFactory m_dbf;
+		/*
+		 * Adjustments are recorded, rather than applied to a new factory, so a
+		 * parser cached for the same adjustments can be used; see ParserCache.
+		 */
+		private List<Object> m_settings = new ArrayList<>();
+		private List<Consumer<DocumentBuilderFactory>> m_adjustments =
+			new ArrayList<>();
 		private InputStream m_is;
 		private boolean m_wrapped;
 		private EntityResolver m_resolver;
 
 		AdjustingDOMSource(InputStream is, boolean wrapped)
 		{
-			m_dbf = DocumentBuilderFactory.newDefaultInstance();
-			m_dbf.setNamespaceAware(true);
 			m_is = is;
 			m_wrapped = wrapped;
 		}
@@ -5353,30 +5531,38 @@ public abstract class SQLXMLImpl<V extends VarlenaWrapper> implements SQLXML
 				"AdjustingDOMSource used before get()");
 		}
 
-		private DocumentBuilderFactory theFactory()
+		private AdjustingDOMSource adjust(Object what, Object value,
+			Consumer<DocumentBuilderFactory> adjustment)
 		{
-			if ( null == m_dbf )
+			if ( null == m_settings )
 				throw new IllegalStateException(
 					"AdjustingDOMSource too late to adjust after get()");
-			return m_dbf;
+			m_settings.add(what);
+			m_settings.add(value);
+			m_adjustments.add(adjustment);
+			return this;
 		}
 
 		@Override
 		public DOMSource get() throws SQLException
 		{
-			if ( null == m_dbf )
+			if ( null == m_settings )
 				throw new IllegalStateException(
 					"AdjustingDOMSource get() called more than once");
 			try
 			{
-				DocumentBuilder db = m_dbf.newDocumentBuilder();
+				ParserCache cache = ParserCache.get();
+				DocumentBuilder db =
+					cache.takeDocumentBuilder(m_settings, m_adjustments);
 				db.setErrorHandler(SAXDOMErrorHandler.instance(m_wrapped));
 				if ( null != m_resolver )
 					db.setEntityResolver(m_resolver);
 				DOMSource ds = new DOMSource(db.parse(m_is));
+				cache.giveDocumentBuilder(m_settings, db);
 				if ( m_wrapped )
 					domUnwrap(ds);
-				m_dbf = null;
+				m_settings = null;
+				m_adjustments = null;
 				m_is = null;
 				return ds;
 			}
@@ -5389,55 +5575,59 @@ public abstract class SQLXMLImpl<V extends VarlenaWrapper> implements SQLXML
 		@Override
 		public AdjustingDOMSource xIncludeAware(boolean v)
 		{
-			theFactory().setXIncludeAware(v);
-			return this;
+			return adjust("xIncludeAware", v,
+				dbf -> dbf.setXIncludeAware(v));
 		}
 
 		@Override
 		public AdjustingDOMSource expandEntityReferences(boolean v)
 		{
-			theFactory().setExpandEntityReferences(v);
-			return this;
+			return adjust("expandEntityReferences", v,
+				dbf -> dbf.setExpandEntityReferences(v));
 		}
 
 		@Override
 		public AdjustingDOMSource setFirstSupportedFeature(
 			boolean value, String... names)
 		{
-			DocumentBuilderFactory dbf = theFactory();
-			for ( String name : names )
-			{
-				try
-				{
-					dbf.setFeature(name, value);
-					break;
-				}
-				catch ( ParserConfigurationException e )
+			return adjust(Arrays.asList("feature", value), Arrays.asList(names),
+				dbf ->
 				{
-					e.printStackTrace(); // XXX
-				}
-			}
-			return this;
+					for ( String name : names )
+					{
+						try
+						{
+							dbf.setFeature(name, value);
+							break;
+						}
+						catch ( ParserConfigurationException e )
+						{
+							e.printStackTrace(); // XXX
+						}
+					}
+				});
 		}
 
 		@Override
 		public AdjustingDOMSource setFirstSupportedProperty(
 			Object value, String... names)
 		{
-			DocumentBuilderFactory dbf = theFactory();
-			for ( String name : names )
-			{
-				try
-				{
-					dbf.setAttribute(name, value);
-					break;
-				}
-				catch ( IllegalArgumentException e )
+			return adjust(Arrays.asList("property", value),
+				Arrays.asList(names), dbf ->
 				{
-					e.printStackTrace(); // XXX
-				}
-			}
-			return this;
+					for ( String name : names )
+					{
+						try
+						{
+							dbf.setAttribute(name, value);
+							break;
+						}
+						catch ( IllegalArgumentException e )
+						{
+							e.printStackTrace(); // XXX
+						}
+					}
+				});
 		}
 
 		@Override
@@ -5450,8 +5640,7 @@ public abstract class SQLXMLImpl<V extends VarlenaWrapper> implements SQLXML
 		@Override
 		public AdjustingDOMSource schema(Schema schema)
 		{
-			theFactory().setSchema(schema);
-			return this;
+			return adjust("schema", schema, dbf -> dbf.setSchema(schema));
 		}
 	}
 }
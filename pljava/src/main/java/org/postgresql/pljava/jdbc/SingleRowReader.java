@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2004-2019 Tada AB and other contributors, as listed below.
+ * Copyright (c) 2004-2026 Tada AB and other contributors, as listed below.
  * Copyright (c) 2010, 2011 PostgreSQL Global Development Group
  *
  * All rights reserved. This program and the accompanying materials
@@ -42,7 +42,9 @@ public class SingleRowReader extends SingleRowResultSet
 		}
 
 		/**
-		 * Return the HeapTupleHeader pointer.
+		 * Return the pointer to the native state, which holds the
+		 * HeapTupleHeader and, once any field has been read, the values of
+		 * all its fields, deformed together on that first access.
 		 *<p>
 		 * This is a transitional implementation: ideally, each method requiring
 		 * the native state would be moved to this class, and hold the pin for
@@ -77,7 +79,8 @@ public class SingleRowReader extends SingleRowResultSet
 	 * {@code SingleRowReader} instance.
 	 * @param resourceOwner Value identifying a scope in PostgreSQL during which
 	 * the native state encapsulated here will be valid.
-	 * @param hth Native pointer to a PG {@code HeapTupleHeader}
+	 * @param hth Native pointer to the reader's native state, holding a PG
+	 * {@code HeapTupleHeader}
 	 * @param tupleDesc A {@code TupleDesc}; the Java class this time.
 	 */
 	public SingleRowReader(DualState.Key cookie, long resourceOwner, long hth,
@@ -13,6 +13,9 @@
  */
 package org.postgresql.pljava.jdbc;
 
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+
 import java.sql.Date;
 import java.sql.ResultSet;
 import java.sql.SQLException;
@@ -23,6 +26,12 @@ import java.util.Calendar;
 
 import org.postgresql.pljava.internal.Tuple;
 import org.postgresql.pljava.internal.TupleDesc;
+import static org.postgresql.pljava.internal.TupleDesc.PRIM_BOOLEAN;
+import static org.postgresql.pljava.internal.TupleDesc.PRIM_DOUBLE;
+import static org.postgresql.pljava.internal.TupleDesc.PRIM_FLOAT;
+import static org.postgresql.pljava.internal.TupleDesc.PRIM_INT;
+import static org.postgresql.pljava.internal.TupleDesc.PRIM_LONG;
+import static org.postgresql.pljava.internal.TupleDesc.PRIM_SHORT;
 
 /**
  * A single row, updateable ResultSet, specially made for functions and
@@ -40,6 +49,15 @@ public class SingleRowWriter extends SingleRowResultSet
 	private final Object[] m_values;
 	private Tuple m_tuple;
 
+	/**
+	 * Values written by the primitive update methods to columns of the
+	 * matching boxed class, kept unboxed in the layout that
+	 * {@link TupleDesc#formTuple(Object[],ByteBuffer)} reads; allocated when
+	 * first needed. A column has its value here, or in {@code m_values}, or
+	 * neither, never both.
+	 */
+	private ByteBuffer m_primitives;
+
 	/**
 	 * Construct a {@code SingleRowWriter} given a descriptor of the tuple
 	 * structure it should produce.
@@ -61,6 +79,9 @@ public class SingleRowWriter extends SingleRowResultSet
 	{
 		if(columnIndex < 1)
 			throw new SQLException("System columns cannot be obtained from this type of ResultSet");
+		if(null != m_primitives  &&  columnIndex <= m_values.length
+			&&  0 != m_primitives.get(kindOffset(columnIndex)))
+			return primitiveValue(columnIndex);
 		return m_values[columnIndex - 1];
 	}
 
@@ -74,11 +95,74 @@ public class SingleRowWriter extends SingleRowResultSet
 	{
 		int top = m_values.length;
 		while(--top >= 0)
-			if(m_values[top] != null)
+			if(m_values[top] != null  ||  null != m_primitives
+				&&  0 != m_primitives.get(kindOffset(top + 1)))
 				return true;
 		return false;
 	}
 
+	@Override
+	public void updateBoolean(int columnIndex, boolean x)
+	throws SQLException
+	{
+		if(primitiveSlot(columnIndex, Boolean.class, PRIM_BOOLEAN))
+			m_primitives.putLong(slotOffset(columnIndex), x ? 1L : 0L);
+		else
+			super.updateBoolean(columnIndex, x);
+	}
+
+	@Override
+	public void updateShort(int columnIndex, short x)
+	throws SQLException
+	{
+		if(primitiveSlot(columnIndex, Short.class, PRIM_SHORT))
+			m_primitives.putLong(slotOffset(columnIndex), x);
+		else
+			super.updateShort(columnIndex, x);
+	}
+
+	@Override
+	public void updateInt(int columnIndex, int x)
+	throws SQLException
+	{
+		if(primitiveSlot(columnIndex, Integer.class, PRIM_INT))
+			m_primitives.putLong(slotOffset(columnIndex), x);
+		else
+			super.updateInt(columnIndex, x);
+	}
+
+	@Override
+	public void updateLong(int columnIndex, long x)
+	throws SQLException
+	{
+		if(primitiveSlot(columnIndex, Long.class, PRIM_LONG))
+			m_primitives.putLong(slotOffset(columnIndex), x);
+		else
+			super.updateLong(columnIndex, x);
+	}
+
+	@Override
+	public void updateFloat(int columnIndex, float x)
+	throws SQLException
+	{
+		if(primitiveSlot(columnIndex, Float.class, PRIM_FLOAT))
+			m_primitives.putLong(
+				slotOffset(columnIndex), Float.floatToRawIntBits(x));
+		else
+			super.updateFloat(columnIndex, x);
+	}
+
+	@Override
+	public void updateDouble(int columnIndex, double x)
+	throws SQLException
+	{
+		if(primitiveSlot(columnIndex, Double.class, PRIM_DOUBLE))
+			m_primitives.putLong(
+				slotOffset(columnIndex), Double.doubleToRawLongBits(x));
+		else
+			super.updateDouble(columnIndex, x);
+	}
+
 	@Override
 	public void updateObject(int columnIndex, Object x)
 	throws SQLException
@@ -86,10 +170,21 @@ public class SingleRowWriter extends SingleRowResultSet
 		if(columnIndex < 1)
 			throw new SQLException("System columns cannot be updated");
 
+		clearPrimitive(columnIndex);
 		if(x == null)
 			m_values[columnIndex-1] = x;
 
-		Class<?> c = m_tupleDesc.getColumnClass(columnIndex);
+		m_values[columnIndex-1] =
+			coerce(m_tupleDesc.getColumnClass(columnIndex), x);
+	}
+
+	/**
+	 * Return <var>x</var> converted as needed to be stored into a column of
+	 * class <var>c</var>; also used by {@link ColumnBatchWriter}.
+	 */
+	static Object coerce(Class<?> c, Object x)
+	throws SQLException
+	{
 		TypeBridge<?>.Holder xAlt = TypeBridge.wrap(x);
 		if(null == xAlt  &&  !c.isInstance(x)
 		&& !(c == byte[].class && (x instanceof BlobValue)))
@@ -104,7 +199,7 @@ public class SingleRowWriter extends SingleRowResultSet
 			else
 				x = SPIConnection.basicCoercion(c, x);
 		}
-		m_values[columnIndex-1] = null == xAlt ? x : xAlt;
+		return null == xAlt ? x : xAlt;
 	}
 
 	@Override
@@ -112,6 +207,7 @@ public class SingleRowWriter extends SingleRowResultSet
 	throws SQLException
 	{
 		Arrays.fill(m_values, null);
+		clearPrimitives();
 	}
 
 	/**
@@ -122,6 +218,7 @@ public class SingleRowWriter extends SingleRowResultSet
 	throws SQLException
 	{
 		Arrays.fill(m_values, null);
+		clearPrimitives();
 		m_tuple = null;	// Feel free to garbage collect...
 	}
 
@@ -150,11 +247,76 @@ public class SingleRowWriter extends SingleRowResultSet
 		// another tuple. This behavior is connected to the internal behavior
 		// of Set Returning Functions (SRF) in the backend.
 		//
-		m_tuple = this.getTupleDesc().formTuple(m_values);
+		m_tuple = this.getTupleDesc().formTuple(m_values, m_primitives);
 		Arrays.fill(m_values, null);
+		clearPrimitives();
 		return m_tuple.getNativePointer();
 	}
 
+	/**
+	 * If the column's class is <var>boxed</var>, mark its value as a primitive
+	 * of the given kind and return true; the caller then stores the value in
+	 * the column's slot. Otherwise return false, for the caller to fall back
+	 * to {@code updateObject} and its coercions.
+	 */
+	private boolean primitiveSlot(int columnIndex, Class<?> boxed, byte kind)
+	throws SQLException
+	{
+		if(columnIndex < 1  ||  columnIndex > m_values.length
+			||  boxed != m_tupleDesc.getColumnClass(columnIndex))
+			return false;
+		if(null == m_primitives)
+			m_primitives = ByteBuffer.allocateDirect(9 * m_values.length)
+				.order(ByteOrder.nativeOrder());
+		m_primitives.put(kindOffset(columnIndex), kind);
+		m_values[columnIndex - 1] = null;
+		return true;
+	}
+
+	private Object primitiveValue(int columnIndex)
+	{
+		long raw = m_primitives.getLong(slotOffset(columnIndex));
+		switch(m_primitives.get(kindOffset(columnIndex)))
+		{
+		case PRIM_BOOLEAN:
+			return Boolean.valueOf(0 != raw);
+		case PRIM_SHORT:
+			return Short.valueOf((short)raw);
+		case PRIM_INT:
+			return Integer.valueOf((int)raw);
+		case PRIM_FLOAT:
+			return Float.valueOf(Float.intBitsToFloat((int)raw));
+		case PRIM_DOUBLE:
+			return Double.valueOf(Double.longBitsToDouble(raw));
+		default:
+			return Long.valueOf(raw);
+		}
+	}
+
+	private void clearPrimitive(int columnIndex)
+	{
+		if(null != m_primitives  &&  columnIndex <= m_values.length)
+			m_primitives.put(kindOffset(columnIndex), (byte)0);
+	}
+
+	private void clearPrimitives()
+	{
+		if(null == m_primitives)
+			return;
+		for(int idx = 1; idx <= m_values.length; ++idx)
+			m_primitives.put(kindOffset(idx), (byte)0);
+	}
+
+	private int slotOffset(int columnIndex)
+	{
+		return 8 * (columnIndex - 1);
+	}
+
+	private int kindOffset(int columnIndex)
+	{
+		return 8 * m_values.length + columnIndex - 1;
+	}
+
 	@Override // defined in SingleRowResultSet
 	protected final TupleDesc getTupleDesc()
 	{
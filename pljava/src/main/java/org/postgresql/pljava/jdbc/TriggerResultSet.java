@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2004-2020 Tada AB and other contributors, as listed below.
+ * Copyright (c) 2004-2026 Tada AB and other contributors, as listed below.
  * Copyright (c) 2010, 2011 PostgreSQL Global Development Group
  *
  * All rights reserved. This program and the accompanying materials
@@ -16,6 +16,7 @@ package org.postgresql.pljava.jdbc;
 import java.sql.SQLException;
 import java.util.ArrayList;
 
+import org.postgresql.pljava.TupleAccessor;
 import org.postgresql.pljava.internal.Tuple;
 import org.postgresql.pljava.internal.TupleDesc;
 
@@ -178,6 +179,32 @@ public class TriggerResultSet extends SingleRowResultSet
 		return m_tupleChanges == null;
 	}
 
+	/**
+	 * Also wraps a {@link TupleAccessor} over the row.
+	 */
+	@Override
+	public boolean isWrapperFor(Class<?> iface)
+	throws SQLException
+	{
+		return TupleAccessor.class == iface  ||  super.isWrapperFor(iface);
+	}
+
+	/**
+	 * Also unwraps to a new {@link TupleAccessor} over the row as it was
+	 * passed to the trigger, which must not have been updated.
+	 */
+	@Override
+	public <T> T unwrap(Class<T> iface)
+	throws SQLException
+	{
+		if ( TupleAccessor.class != iface )
+			return super.unwrap(iface);
+		if ( null != m_tupleChanges  &&  ! m_tupleChanges.isEmpty() )
+			throw new SQLException(
+				"TupleAccessor cannot see updates to a trigger row", "55000");
+		return iface.cast(m_tuple.accessor(m_tupleDesc));
+	}
+
 	// ************************************************************
 	// End of implementation of JDBC 4 methods.
 	// ************************************************************
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+package org.postgresql.pljava.jdbc;
+
+import java.sql.ResultSetMetaData;
+import java.sql.SQLException;
+
+import org.postgresql.pljava.TupleAccessor;
+import org.postgresql.pljava.internal.Tuple;
+import org.postgresql.pljava.internal.TupleDesc;
+import org.postgresql.pljava.internal.TupleTable;
+
+/**
+ * A read-only, forward-only ResultSet over the rows of one
+ * {@link TupleTable} already in hand, such as the result of a
+ * {@link SPIRelationLookup}; not associated with any statement.
+ *<p>
+ * A column the table holds in columnar form is read by array indexing, as in
+ * {@link SPIResultSet}.
+ */
+public class TupleTableResultSet extends ResultSetBase
+{
+	private final TupleTable m_table;
+	private final TupleDesc  m_tupleDesc;
+	private boolean m_open;
+
+	TupleTableResultSet(TupleTable table)
+	{
+		super(table.getCount());
+		m_table = table;
+		m_tupleDesc = table.getTupleDesc();
+		m_open = true;
+	}
+
+	@Override
+	public void close()
+	throws SQLException
+	{
+		if ( m_open )
+		{
+			m_open = false;
+			m_table.release();
+			super.close();
+		}
+	}
+
+	@Override
+	public int findColumn(String columnName)
+	throws SQLException
+	{
+		return m_tupleDesc.getColumnIndex(columnName);
+	}
+
+	@Override
+	public boolean isLast() throws SQLException
+	{
+		return this.getRow() == m_table.getCount();
+	}
+
+	@Override
+	public boolean next() throws SQLException
+	{
+		if ( ! m_open )
+			throw new SQLException("ResultSet is closed");
+		int row = this.getRow();
+		if ( 0 <= row  &&  row < m_table.getCount() )
+		{
+			this.setRow(row + 1);
+			return true;
+		}
+		this.setRow(-1);
+		return false;
+	}
+
+	/**
+	 * Implemented over the table's columnar values when a column has them and
+	 * no particular class is wanted, and otherwise over
+	 * {@link Tuple#getObject Tuple.getObject(TupleDesc,int,Class)}.
+	 */
+	@Override // defined in ObjectResultSet
+	protected Object getObjectValue(int columnIndex, Class<?> type)
+	throws SQLException
+	{
+		int row = this.getRow();
+		if ( row < 1  ||  row > m_table.getCount() )
+			throw new SQLException("ResultSet is not positioned on a valid row");
+		if ( null == type )
+		{
+			Object value = m_table.getColumnarObject(row - 1, columnIndex);
+			if ( TupleTable.NOT_COLUMNAR != value )
+				return value;
+		}
+		return m_table.getSlot(row - 1).getObject(m_tupleDesc, columnIndex, type);
+	}
+
+	/**
+	 * Also wraps a {@link TupleAccessor} over the current row.
+	 */
+	@Override
+	public boolean isWrapperFor(Class<?> iface)
+	throws SQLException
+	{
+		return TupleAccessor.class == iface  ||  super.isWrapperFor(iface);
+	}
+
+	/**
+	 * Also unwraps to a new {@link TupleAccessor} over the current row.
+	 */
+	@Override
+	public <T> T unwrap(Class<T> iface)
+	throws SQLException
+	{
+		if ( TupleAccessor.class != iface )
+			return super.unwrap(iface);
+		int row = this.getRow();
+		if ( row < 1  ||  row > m_table.getCount() )
+			throw new SQLException("ResultSet is not positioned on a valid row");
+		return iface.cast(m_table.getSlot(row - 1).accessor(m_tupleDesc));
+	}
+
+	/**
+	 * Returns an {@link SPIResultSetMetaData} instance.
+	 */
+	@Override
+	public ResultSetMetaData getMetaData()
+	throws SQLException
+	{
+		return new SPIResultSetMetaData(m_tupleDesc);
+	}
+}
@@ -55,6 +55,14 @@ public abstract class TypeBridge<S>
 	 */
 	protected final int m_defaultOid;
 
+	/**
+	 * Position of this TypeBridge in the order of construction, by which the
+	 * native code caches the PostgreSQL {@code Type} it resolves from
+	 * {@code m_canonName}, so as not to look it up by name for every
+	 * {@link Holder Holder} it is passed.
+	 */
+	protected final int m_index;
+
 	/**
 	 * If the Java class associated with the TypeBridge <em>is</em> loaded and
 	 * available, it can be cached here.
@@ -115,6 +123,7 @@ public abstract class TypeBridge<S>
 			throw new NullPointerException("TypeBridge cName must be nonnull.");
 		m_canonName = cName;
 		m_defaultOid = dfltOid;
+		m_index = m_candidates.size();
 		m_candidates.add(this);
 	}
 
@@ -248,15 +257,18 @@ public abstract class TypeBridge<S>
 	 * an object of the normally-expected class for the PostgreSQL type, it can
 	 * retrieve the class, classname, default PG type oid, and the payload
 	 * object itself, from the Holder, and obtain and apply a different coercer
-	 * appropriate to the class.
+	 * appropriate to the class. The native code reads the payload and the
+	 * bridge's {@code m_index} from the fields of the Holder directly.
 	 */
 	public final class Holder
 	{
 		private final S m_payload;
+		private final int m_bridgeIndex;
 
 		private Holder(S o)
 		{
 			m_payload = o;
+			m_bridgeIndex = m_index;
 		}
 
 		public Class<S> bridgedClass()
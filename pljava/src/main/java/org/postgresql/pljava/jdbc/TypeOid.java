@@ -70,6 +70,11 @@ public class TypeOid
 	 * Likewise in 2020.
 	 */
 	public static final int TRIGGEROID = 2279;
+	/*
+	 * And in 2026.
+	 */
+	public static final int VOIDOID = 2278;
+	public static final int INTERNALOID = 2281;
 
 	/*
 	 * Before Java 8 with the @Native annotation, a class needs at least one
@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+package org.postgresql.pljava.jdbc;
+
+import java.io.InputStream;
+import java.io.IOException;
+import java.sql.SQLException;
+
+import org.postgresql.pljava.internal.VarlenaWrapper;
+
+/**
+ * A {@link BlobValue} over a PostgreSQL {@code bytea} value that has not been
+ * copied into Java, made by the native code when a {@code bytea} is retrieved
+ * as a {@code java.sql.Blob}.
+ *<p>
+ * Reading it as a whole stream detoasts it, as for any other
+ * {@code VarlenaWrapper.Input}, but {@link #getBytes getBytes} and
+ * {@link #getBinaryStream(long,long) getBinaryStream(pos, length)} fetch only
+ * the range asked for (unless the value has already been detoasted), so their
+ * cost follows the size of the range rather than of the value, when the value
+ * is stored out of line and uncompressed (storage {@code EXTERNAL}). As in
+ * {@code BlobValue}, positions count from zero, and, unlike its, they may
+ * move backward.
+ */
+public class VarlenaBlob extends BlobValue
+{
+	/**
+	 * The most fetched at once by a stream from
+	 * {@link #getBinaryStream(long,long) getBinaryStream(pos, length)}.
+	 */
+	private static final int SLICE_CHUNK = 65536;
+
+	private final VarlenaWrapper.Input m_input;
+
+	private VarlenaBlob(VarlenaWrapper.Input input) throws SQLException
+	{
+		super(input.new Stream(), input.length());
+		m_input = input;
+	}
+
+	@Override
+	public byte[] getBytes(long pos, int length) throws SQLException
+	{
+		if ( pos < 0L  ||  length < 0 )
+			throw new IllegalArgumentException();
+		if ( pos + length > length() )
+			throw new SQLException(
+				"Attempt to read beyond end of Blob data", "22011");
+		return m_input.slice(pos, length);
+	}
+
+	@Override
+	public InputStream getBinaryStream(long pos, long length)
+	throws SQLException
+	{
+		if ( pos < 0L  ||  length < 0L )
+			throw new IllegalArgumentException();
+		if ( pos + length > length() )
+			throw new SQLException(
+				"Attempt to read beyond end of Blob data", "22011");
+		return new SliceStream(pos, pos + length);
+	}
+
+	@Override
+	public void free() throws SQLException
+	{
+		try
+		{
+			m_input.close();
+		}
+		catch ( IOException e )
+		{
+			throw new SQLException(e.getMessage(), "58030", e);
+		}
+	}
+
+	/**
+	 * A stream over a range of the value, fetching it a slice at a time.
+	 */
+	private class SliceStream extends InputStream
+	{
+		private long m_pos;
+		private final long m_end;
+		private byte[] m_chunk = new byte[0];
+		private int m_chunkPos;
+
+		SliceStream(long pos, long end)
+		{
+			m_pos = pos;
+			m_end = end;
+		}
+
+		/**
+		 * Make sure there is something left in the current chunk, fetching
+		 * the next if need be; return false at the end of the range.
+		 */
+		private boolean fill() throws IOException
+		{
+			if ( m_chunkPos < m_chunk.length )
+				return true;
+			if ( m_pos >= m_end )
+				return false;
+			try
+			{
+				m_chunk = m_input.slice(
+					m_pos, (int)Math.min(SLICE_CHUNK, m_end - m_pos));
+			}
+			catch ( SQLException e )
+			{
+				throw new IOException(e.getMessage(), e);
+			}
+			m_chunkPos = 0;
+			m_pos += m_chunk.length;
+			return 0 < m_chunk.length;
+		}
+
+		@Override
+		public int read() throws IOException
+		{
+			if ( ! fill() )
+				return -1;
+			return m_chunk[m_chunkPos++] & 0xff;
+		}
+
+		@Override
+		public int read(byte[] b, int off, int len) throws IOException
+		{
+			if ( 0 == len )
+				return 0;
+			if ( ! fill() )
+				return -1;
+			int n = Math.min(len, m_chunk.length - m_chunkPos);
+			System.arraycopy(m_chunk, m_chunkPos, b, off, n);
+			m_chunkPos += n;
+			return n;
+		}
+
+		@Override
+		public long skip(long n) throws IOException
+		{
+			if ( n <= 0 )
+				return 0;
+			long inChunk = Math.min(n, m_chunk.length - m_chunkPos);
+			m_chunkPos += (int)inChunk;
+			long beyond = Math.min(n - inChunk, m_end - m_pos);
+			m_pos += beyond;
+			return inChunk + beyond;
+		}
+
+		@Override
+		public int available()
+		{
+			return m_chunk.length - m_chunkPos;
+		}
+	}
+}
@@ -18,6 +18,10 @@ import java.io.ByteArrayOutputStream;
 import java.io.IOException;
 import java.io.InputStream;
 import java.io.InputStreamReader;
+import static java.lang.management.ManagementFactory.getMemoryMXBean;
+import static java.lang.management.ManagementFactory.getPlatformMBeanServer;
+import static java.lang.management.ManagementFactory.getThreadMXBean;
+import java.lang.management.MemoryUsage;
 import java.net.Authenticator;
 import java.net.HttpURLConnection;
 import java.net.PasswordAuthentication;
@@ -29,6 +33,10 @@ import java.nio.ByteBuffer;
 import static java.nio.charset.StandardCharsets.UTF_8;
 import java.nio.charset.CharsetDecoder;
 import java.nio.charset.CharacterCodingException;
+import java.nio.file.Files;
+import java.nio.file.Paths;
+import java.security.MessageDigest;
+import java.security.NoSuchAlgorithmException;
 import java.security.Permission;
 import java.sql.Connection;
 import java.sql.PreparedStatement;
@@ -43,6 +51,10 @@ import java.sql.Statement;
 import java.text.ParseException;
 import java.util.ArrayList;
 import static java.util.Arrays.fill;
+import static java.util.Collections.singleton;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Map;
 import java.util.jar.Attributes;
 import java.util.jar.JarEntry;
 import java.util.jar.JarInputStream;
@@ -52,6 +64,11 @@ import java.util.regex.Pattern;
 import java.util.zip.ZipEntry;
 import java.util.zip.ZipInputStream;
 
+import javax.management.JMException;
+import javax.management.ObjectName;
+
+import org.postgresql.pljava.BulkInsert;
+import org.postgresql.pljava.ResultSetProvider;
 import org.postgresql.pljava.Session;
 import org.postgresql.pljava.SessionManager;
 
@@ -64,9 +81,17 @@ import static
 import org.postgresql.pljava.internal.AclId;
 import org.postgresql.pljava.internal.Backend;
 import org.postgresql.pljava.internal.Checked;
+import org.postgresql.pljava.internal.DualState;
+import org.postgresql.pljava.internal.ExecutionPlan;
+import org.postgresql.pljava.internal.FunctionStats;
 import org.postgresql.pljava.internal.Oid;
 import static org.postgresql.pljava.internal.Privilege.doPrivileged;
+import org.postgresql.pljava.internal.VarlenaWrapper;
 import static org.postgresql.pljava.jdbc.SQLUtils.getDefaultConnection;
+import org.postgresql.pljava.mbeans.DualStateStatistics;
+import org.postgresql.pljava.mbeans.FunctionStatistics;
+import org.postgresql.pljava.mbeans.PlanCacheStatistics;
+import org.postgresql.pljava.sqlj.ClassImageCache;
 import org.postgresql.pljava.sqlj.Loader;
 
 import org.postgresql.pljava.annotation.Function;
@@ -131,7 +156,8 @@ import static org.postgresql.pljava.annotation.Function.Security.DEFINER;
  * <h3>replace_jar</h3>
  * The replace_jar procedure will replace a loaded jar with another jar. Use
  * this command to update already loaded files. It's an error if the jar is not
- * found.
+ * found. Entries of the new jar identical to those already loaded (by name and
+ * content) are left in place, so only the changed entries are stored anew.
  * <h4>Usage 1</h4>
  * <blockquote><code>SELECT sqlj.replace_jar(&lt;jar_url&gt;, &lt;jar_name&gt;, &lt;redeploy&gt;);</code>
  * </blockquote>
@@ -314,11 +340,13 @@ import static org.postgresql.pljava.annotation.Function.Security.DEFINER;
  * In this (1.5.0) incarnation of the schema, jar_repository and jar_entry are
  * both indexed by SERIAL columns. The replace_jar operation is an UPDATE to
  * jar_repository (so the jar's id is preserved), but deletes and reinserts to
- * jar_entry (so ALL classes get new ids). This makes the entryId sufficient as
- * a class-cache token to ensure old cached versions are recognized as invalid
- * (although at the cost of doing so for *every single class* in a jar even if
- * many are unchanged). It is used that way in the cache-token construction in
- * o.p.p.sqlj.Loader, which could need to be revisited if this behavior changes.
+ * jar_entry every entry whose content has changed (so those get new ids), and
+ * leaves in place the entries whose content is the same. This makes the
+ * entryId sufficient as a class-cache token to ensure old cached versions are
+ * recognized as invalid, while an unchanged class keeps its cached version.
+ * It is used that way in the cache-token construction in o.p.p.sqlj.Loader,
+ * and for the file names in o.p.p.sqlj.ClassImageCache, which could need to be
+ * revisited if this behavior changes.
  */
 @SQLAction(provides="sqlj.tables", install={
 "	CREATE TABLE sqlj.jar_repository(" +
@@ -381,6 +409,41 @@ import static org.postgresql.pljava.annotation.Function.Security.DEFINER;
 "	DROP TABLE sqlj.typemap_entry",
 "	DROP TABLE sqlj.jar_repository CASCADE"
 })
+/*
+ * The queue of jobs run by background workers. Only its owner can read or
+ * change it: jobs are queued by sqlj.submit_job and reported by
+ * sqlj.job_status, which act for the outer user, and the workers change it as
+ * the bootstrap superuser (see BackgroundJob.c). It and the functions using
+ * it carry the background_job implementor tag, so a schema from before it
+ * existed can be brought up to date (see InstallHelper.SchemaVariant).
+ */
+@SQLAction(provides="sqlj.background_job", requires="sqlj.tables",
+	implementor="background_job", install={
+"	CREATE TABLE sqlj.background_job(" +
+"		jobId       BIGSERIAL PRIMARY KEY," +
+"		jobFunction pg_catalog.REGPROCEDURE NOT NULL," +
+"		argument    pg_catalog.TEXT," +
+"		submitter   pg_catalog.OID NOT NULL," +
+"		state       pg_catalog.TEXT NOT NULL DEFAULT 'queued'," +
+"		result      pg_catalog.TEXT," +
+"		error       pg_catalog.TEXT," +
+"		submitted   pg_catalog.TIMESTAMPTZ NOT NULL DEFAULT pg_catalog.now()," +
+"		started     pg_catalog.TIMESTAMPTZ," +
+"		finished    pg_catalog.TIMESTAMPTZ" +
+"	)",
+"	CREATE INDEX ON sqlj.background_job (submitter, jobId)" +
+"	WHERE state OPERATOR(pg_catalog.=) 'queued'",
+"	COMMENT ON TABLE sqlj.background_job IS" +
+"	'Jobs queued by sqlj.submit_job for background workers, one row " +
+	"per job.'"
+}, remove={
+"	DROP TABLE sqlj.background_job"
+})
+@SQLAction(provides="background_job", install={
+"	SELECT " +
+"		pg_catalog.set_config('pljava.implementors', 'background_job,' " +
+"		|| pg_catalog.current_setting('pljava.implementors'), true)"
+})
 @SQLAction(provides="alias_java_language", install={
 "	SELECT " +
 "		pg_catalog.set_config('pljava.implementors', 'alias_java_language,' " +
@@ -442,8 +505,12 @@ public class Commands
 	 * 
 	 * @param jarId The id used for the foreign key to the jar_repository table
 	 * @param urlString The url to be read
+	 * @param previous For {@code replace_jar}, the entries already stored,
+	 * as described for the stream-reading version of this method; null for
+	 * {@code install_jar}.
 	 */
-	static void addClassImages(int jarId, String urlString)
+	static void addClassImages(int jarId, String urlString,
+		Map<String,StoredEntry> previous)
 	throws SQLException
 	{
 		try
@@ -496,7 +563,7 @@ public class Commands
 				}, null, least)
 			)
 			{
-				addClassImages(jarId, urlStream, sz[0]);
+				addClassImages(jarId, urlStream, sz[0], previous);
 			}
 		}
 		catch(IOException e)
@@ -512,16 +579,19 @@ public class Commands
 	 * @param sz The expected size of the stream, used as a worst-case
 	 * mark/reset limit. The caller might pass -1 if the URLConnection can't
 	 * determine a size in advance (a generous guess will be made in that case).
+	 * @param previous For {@code replace_jar}, the entries already stored for
+	 * the jar, by name; null for {@code install_jar}. An entry found with the
+	 * same content is left in place; any other is deleted, and the entries
+	 * left in the map on return are those the new jar does not have, which are
+	 * then deleted too.
 	 * @throws SQLException
 	 */
-	static void addClassImages(int jarId, InputStream urlStream, long sz)
+	static void addClassImages(int jarId, InputStream urlStream, long sz,
+		Map<String,StoredEntry> previous)
 	throws SQLException
 	{
 		try (
 			Connection conn = getDefaultConnection();
-			PreparedStatement stmt = conn.prepareStatement(
-				"INSERT INTO sqlj.jar_entry(entryName, jarId, entryImage) " +
-				"VALUES (?, ?, ?)");
 			PreparedStatement descIdFetchStmt = conn.prepareStatement(
 				"SELECT entryId FROM sqlj.jar_entry " +
 				"WHERE jarId OPERATOR(pg_catalog.=) ?" +
@@ -531,8 +601,10 @@ public class Commands
 				" VALUES ( ?, ?, ? )");
 		)
 		{
-			byte[] buf = new byte[1024];
+			byte[] buf = new byte[8192];
 			ByteArrayOutputStream img = new ByteArrayOutputStream();
+			EntryBatch batch = new EntryBatch(conn, jarId);
+			MessageDigest md5 = null == previous ? null : md5();
 
 			BufferedInputStream bis = new BufferedInputStream( urlStream);
 			String manifest = rawManifest( bis, sz);
@@ -570,14 +642,27 @@ public class Commands
 					img.write(buf, 0, nBytes);
 				jis.closeEntry();
 
-				stmt.setString(1, entryName);
-				stmt.setInt(2, jarId);
-				stmt.setBytes(3, img.toByteArray());
-				if(stmt.executeUpdate() != 1)
-					throw new SQLException(
-						"Jar entry insert did not insert 1 row");
+				if ( null != previous )
+				{
+					StoredEntry old = previous.remove(entryName);
+					if ( null != old )
+					{
+						md5.reset();
+						md5.update(img.toByteArray());
+						if ( old.sameDigest(md5.digest()) )
+							continue;
+						batch.delete(old.entryId);
+					}
+				}
+
+				batch.add(entryName, img.toByteArray());
 			}
 
+			if ( null != previous )
+				for ( StoredEntry old : previous.values() )
+					batch.delete(old.entryId);
+			batch.flush();
+
 			Matcher ddr = ddrSection.matcher( null != manifest ? manifest : "");
 			Matcher continuations = mfCont.matcher( "");
 			for ( int ordinal = 0; ddr.find(); ++ ordinal )
@@ -613,6 +698,142 @@ public class Commands
 		}
 	}
 
+	/**
+	 * The id of an entry already stored for a jar, and the MD5 digest of its
+	 * image, for {@code replace_jar} to recognize an entry it need not replace.
+	 */
+	static final class StoredEntry
+	{
+		final int entryId;
+		final String md5;
+
+		StoredEntry(int entryId, String md5)
+		{
+			this.entryId = entryId;
+			this.md5 = md5;
+		}
+
+		boolean sameDigest(byte[] digest)
+		{
+			StringBuilder sb = new StringBuilder(2 * digest.length);
+			for ( byte b : digest )
+				sb.append(Character.forDigit((b >> 4) & 0xf, 16))
+					.append(Character.forDigit(b & 0xf, 16));
+			return md5.equals(sb.toString());
+		}
+	}
+
+	/**
+	 * Return the entries stored for a jar, by name, for {@code replace_jar}.
+	 */
+	private static Map<String,StoredEntry> storedEntries(int jarId)
+	throws SQLException
+	{
+		Map<String,StoredEntry> entries = new HashMap<>();
+		try ( PreparedStatement stmt = getDefaultConnection().prepareStatement(
+			"SELECT entryName, entryId, pg_catalog.md5(entryImage)" +
+			" FROM sqlj.jar_entry WHERE jarId OPERATOR(pg_catalog.=) ?");
+		)
+		{
+			stmt.setInt(1, jarId);
+			try ( ResultSet rs = stmt.executeQuery() )
+			{
+				while ( rs.next() )
+					entries.put(rs.getString(1),
+						new StoredEntry(rs.getInt(2), rs.getString(3)));
+			}
+		}
+		return entries;
+	}
+
+	private static MessageDigest md5() throws SQLException
+	{
+		try
+		{
+			return MessageDigest.getInstance("MD5");
+		}
+		catch ( NoSuchAlgorithmException e )
+		{
+			throw new SQLException(
+				"MD5 digest unavailable for replace_jar", "58000", e);
+		}
+	}
+
+	/**
+	 * Accumulates jar entries to be inserted into, and entry ids to be deleted
+	 * from, {@code sqlj.jar_entry}, so each is done for many entries by one
+	 * statement. The deletions are made before the insertions, as an entry
+	 * replaced is deleted and inserted under the same name.
+	 */
+	private static final class EntryBatch
+	{
+		private static final int MAX_ENTRIES = 512;
+		private static final long MAX_BYTES = 16 * 1024 * 1024;
+
+		private final Connection m_conn;
+		private final int m_jarId;
+		private final List<String> m_names = new ArrayList<>();
+		private final List<byte[]> m_images = new ArrayList<>();
+		private final List<Integer> m_deletes = new ArrayList<>();
+		private long m_bytes;
+
+		EntryBatch(Connection conn, int jarId)
+		{
+			m_conn = conn;
+			m_jarId = jarId;
+		}
+
+		void add(String name, byte[] image) throws SQLException
+		{
+			m_names.add(name);
+			m_images.add(image);
+			m_bytes += image.length;
+			if ( MAX_ENTRIES <= m_names.size()  ||  MAX_BYTES <= m_bytes )
+				flush();
+		}
+
+		void delete(int entryId)
+		{
+			m_deletes.add(entryId);
+		}
+
+		void flush() throws SQLException
+		{
+			if ( ! m_deletes.isEmpty() )
+			{
+				int[] ids = m_deletes.stream().mapToInt(i -> i).toArray();
+				m_deletes.clear();
+				ClassImageCache.evictEntries(ids);
+				try ( PreparedStatement stmt = m_conn.prepareStatement(
+					"DELETE FROM sqlj.jar_entry" +
+					" WHERE entryId OPERATOR(pg_catalog.=) ANY (?)");
+				)
+				{
+					stmt.setObject(1, ids);
+					stmt.executeUpdate();
+				}
+			}
+
+			int n = m_names.size();
+			if ( 0 == n )
+				return;
+
+			int[] jarIds = new int [ n ];
+			fill(jarIds, m_jarId);
+			long inserted = m_conn.unwrap(BulkInsert.class).insertColumns(
+				"sqlj.jar_entry",
+				new String[] { "entryName", "jarId", "entryImage" },
+				m_names.toArray(new String[n]), jarIds,
+				m_images.toArray(new byte[n][]));
+			m_names.clear();
+			m_images.clear();
+			m_bytes = 0;
+			if ( n != inserted )
+				throw new SQLException(
+					"Jar entry insert did not insert " + n + " rows");
+		}
+	}
+
 	private final static Pattern ddrSection = Pattern.compile(
 	    "(?<=[\\r\\n])Name: ((?:.|(?:\\r\\n?+|\\n) )++)(?:\\r\\n?+|\\n)" +
 		"(?:[^\\r\\n]++(?:\\r\\n?+|\\n)(?![\\r\\n]))*" +
@@ -872,6 +1093,9 @@ public class Commands
 		if(undeploy)
 			deployRemove(jarId, jarName);
 
+		List<Identifier.Simple> schemas = schemasUsingJar(jarId);
+		ClassImageCache.evictJar(jarId);
+
 		try ( PreparedStatement stmt = getDefaultConnection()
 			.prepareStatement(
 				"DELETE FROM sqlj.jar_repository " +
@@ -883,7 +1107,7 @@ public class Commands
 				throw new SQLException(
 					"Jar repository update did not update 1 row");
 		}
-		Loader.clearSchemaLoaders();
+		Loader.clearSchemaLoaders(schemas);
 	}
 
 	/**
@@ -1039,7 +1263,7 @@ public class Commands
 				}
 			}
 		}
-		Loader.clearSchemaLoaders();
+		Loader.clearSchemaLoaders(singleton(schema));
 	}
 
 	private static void withJarInPath(String jarName, boolean schemaMayVanish,
@@ -1210,6 +1434,574 @@ public class Commands
 		}
 	}
 
+	/**
+	 * Report the statistics of this session's cache of prepared plans, shared
+	 * by all PL/Java functions. This method is exposed in SQL as
+	 * {@code sqlj.plan_cache_statistics()}.
+	 *<p>
+	 * The same values are available over JMX, from the bean named
+	 * {@code org.postgresql.pljava:type=ExecutionPlan,name=PlanCacheStatistics}.
+	 */
+	@Function(
+		schema="sqlj", name="plan_cache_statistics", requires="sqlj.tables",
+		out={
+			"hits bigint", "misses bigint", "evictions bigint",
+			"reprepares bigint", "entries integer", "bytes bigint"
+		}
+	)
+	public static boolean planCacheStatistics(ResultSet out)
+	throws SQLException
+	{
+		PlanCacheStatistics stats = ExecutionPlan.statistics();
+		out.updateLong(1, stats.getHits());
+		out.updateLong(2, stats.getMisses());
+		out.updateLong(3, stats.getEvictions());
+		out.updateLong(4, stats.getReprepares());
+		out.updateInt(5, stats.getEntries());
+		out.updateLong(6, stats.getBytes());
+		return true;
+	}
+
+	/**
+	 * Report the memory used by this session's JVM, in bytes: the heap and
+	 * non-heap (metaspace, code cache, and so on) amounts used and committed,
+	 * and the heap maximum, the number of live Java threads, and the resident
+	 * set size of the whole backend process, which includes PostgreSQL's own
+	 * memory. This method is exposed in SQL as {@code sqlj.memory_usage()}.
+	 *<p>
+	 * The resident set size is read from {@code /proc/self/status}, and is
+	 * null where that is not available. The heap maximum is null if the JVM
+	 * reports none. Together with {@code pljava.vm_profile}, it is meant for
+	 * judging how many backends using PL/Java the server's memory can hold.
+	 */
+	@Function(
+		schema="sqlj", name="memory_usage", requires="sqlj.tables",
+		out={
+			"heap_used bigint", "heap_committed bigint", "heap_max bigint",
+			"nonheap_used bigint", "nonheap_committed bigint",
+			"threads integer", "rss bigint"
+		}
+	)
+	public static boolean memoryUsage(ResultSet out)
+	throws SQLException
+	{
+		MemoryUsage heap = doPrivileged(() ->
+			getMemoryMXBean().getHeapMemoryUsage());
+		MemoryUsage nonHeap = doPrivileged(() ->
+			getMemoryMXBean().getNonHeapMemoryUsage());
+		int threads = doPrivileged(() -> getThreadMXBean().getThreadCount());
+		long rss = doPrivileged(Commands::residentSetSize);
+
+		out.updateLong(1, heap.getUsed());
+		out.updateLong(2, heap.getCommitted());
+		if ( -1 != heap.getMax() )
+			out.updateLong(3, heap.getMax());
+		out.updateLong(4, nonHeap.getUsed());
+		out.updateLong(5, nonHeap.getCommitted());
+		out.updateInt(6, threads);
+		if ( -1 != rss )
+			out.updateLong(7, rss);
+		return true;
+	}
+
+	/**
+	 * Queue a call of a function, to be made by a background worker in its own
+	 * session, as the current outer user, in the current database. This method
+	 * is exposed in SQL as {@code sqlj.submit_job(VARCHAR, TEXT)}.
+	 *<p>
+	 * The function is named by a signature as accepted by
+	 * {@code regprocedure}, such as {@code myschema.retrain(text)}; it must
+	 * take one {@code text} argument and not return a set. It is recorded by
+	 * its oid, so renaming it or changing the search path does not change which
+	 * function the job calls. It is called with {@code argument}, and its
+	 * result is recorded as text. The current outer user must be able to log
+	 * in, as the worker connects as that role. The job is
+	 * queued when the calling transaction commits. A worker is started, if
+	 * fewer than {@code pljava.job_workers} are running for the user and more
+	 * jobs are queued than workers; a running worker takes the user's queued
+	 * jobs in order, one at a time, with its JVM already started.
+	 * @param function Signature of the function to call.
+	 * @param argument Its argument, which may be null.
+	 * @return The job's id, for {@code sqlj.job_status}.
+	 */
+	@Function(schema="sqlj", name="submit_job", security=DEFINER,
+		onNullInput=CALLED, requires="sqlj.background_job",
+		implementor="background_job")
+	public static long submitJob(String function, String argument)
+	throws SQLException
+	{
+		if ( null == function )
+			throw new SQLDataException(
+				"parameter \"function\" may not be null", "22004");
+
+		AclId user = AclId.getOuterUser();
+		long submitter = Integer.toUnsignedLong(user.intValue());
+		long functionOid;
+		long jobId;
+
+		try (
+			Connection c = getDefaultConnection();
+			PreparedStatement login = c.prepareStatement(
+				"SELECT rolcanlogin FROM pg_catalog.pg_roles" +
+				" WHERE oid OPERATOR(pg_catalog.=) CAST(? AS pg_catalog.oid)");
+			PreparedStatement check = c.prepareStatement(
+				"SELECT p.oid," +
+				" p.pronargs OPERATOR(pg_catalog.=) 1" +
+				"  AND p.proargtypes[0] OPERATOR(pg_catalog.=) CAST(" +
+				"   CAST('pg_catalog.text' AS pg_catalog.regtype)" +
+				"   AS pg_catalog.oid)" +
+				"  AND NOT p.proretset," +
+				" pg_catalog.has_function_privilege(" +
+				"  CAST(? AS pg_catalog.oid), p.oid, 'EXECUTE')" +
+				" FROM pg_catalog.pg_proc p" +
+				" WHERE p.oid OPERATOR(pg_catalog.=) CAST(" +
+				"  CAST(? AS pg_catalog.regprocedure) AS pg_catalog.oid)");
+			PreparedStatement insert = c.prepareStatement(
+				"INSERT INTO sqlj.background_job" +
+				" (jobFunction, argument, submitter)" +
+				" VALUES (CAST(CAST(? AS pg_catalog.oid)" +
+				"  AS pg_catalog.regprocedure), ?," +
+				" CAST(? AS pg_catalog.oid))" +
+				" RETURNING jobId");
+		)
+		{
+			login.setLong(1, submitter);
+			try ( ResultSet rs = login.executeQuery() )
+			{
+				if ( ! rs.next() || ! rs.getBoolean(1) )
+					throw new SQLNonTransientException(
+						"role \"" + user.getName() + "\" is not permitted " +
+						"to log in, so no background worker can run its jobs",
+						"28000");
+			}
+
+			check.setLong(1, submitter);
+			check.setString(2, function);
+			try ( ResultSet rs = check.executeQuery() )
+			{
+				rs.next();
+				functionOid = rs.getLong(1);
+				if ( ! rs.getBoolean(2) )
+					throw new SQLSyntaxErrorException(
+						"function " + function + " must take one text " +
+						"argument and not return a set to be run as a job",
+						"42P13");
+				if ( ! rs.getBoolean(3) )
+					throw new SQLSyntaxErrorException( // yeah, for 42501
+						"permission denied for function " + function, "42501");
+			}
+
+			insert.setLong(1, functionOid);
+			insert.setString(2, argument);
+			insert.setLong(3, submitter);
+			try ( ResultSet rs = insert.executeQuery() )
+			{
+				rs.next();
+				jobId = rs.getLong(1);
+			}
+
+			startJobWorker(c, submitter);
+		}
+		return jobId;
+	}
+
+	/**
+	 * Start a background worker for the submitter's jobs, if fewer than
+	 * {@code pljava.job_workers} are running and more jobs are queued.
+	 *<p>
+	 * A worker just started in this transaction is not yet counted, so one
+	 * more than wanted can be started; a worker finding, as it starts, that
+	 * enough others are running exits at once.
+	 */
+	private static void startJobWorker(Connection c, long submitter)
+	throws SQLException
+	{
+		int max = Backend.getJobWorkers();
+		long workers;
+		long queued;
+
+		if ( 0 == max )
+			return;
+
+		try ( PreparedStatement ps = c.prepareStatement(
+			"SELECT" +
+			" (SELECT pg_catalog.count(*) FROM pg_catalog.pg_stat_activity" +
+			"  WHERE backend_type OPERATOR(pg_catalog.=) 'pljava job worker'" +
+			"  AND datname OPERATOR(pg_catalog.=) " +
+			"   pg_catalog.current_database()" +
+			"  AND usesysid OPERATOR(pg_catalog.=) CAST(? AS pg_catalog.oid))," +
+			" (SELECT pg_catalog.count(*) FROM sqlj.background_job" +
+			"  WHERE state OPERATOR(pg_catalog.=) 'queued'" +
+			"  AND submitter OPERATOR(pg_catalog.=) CAST(? AS pg_catalog.oid))")
+		)
+		{
+			ps.setLong(1, submitter);
+			ps.setLong(2, submitter);
+			try ( ResultSet rs = ps.executeQuery() )
+			{
+				rs.next();
+				workers = rs.getLong(1);
+				queued = rs.getLong(2);
+			}
+		}
+
+		if ( workers >= max  ||  workers >= queued )
+			return;
+
+		if ( ! Backend.launchJobWorker((int)submitter) )
+			s_logger.warning(
+				"no background worker slot is free to run PL/Java jobs; " +
+				"they will wait for a running worker, or another submission " +
+				"(see max_worker_processes)");
+	}
+
+	/**
+	 * Report the state of a job queued by {@code sqlj.submit_job}: one of
+	 * {@code queued}, {@code running}, {@code done}, or {@code failed}, with
+	 * the function's result if done, or the error message if failed. This
+	 * method is exposed in SQL as {@code sqlj.job_status(BIGINT)}.
+	 *<p>
+	 * No row is returned for a job not submitted by the current outer user,
+	 * unless that user is a superuser. A job whose worker was stopped while
+	 * running it stays {@code running}.
+	 */
+	@Function(
+		schema="sqlj", name="job_status", security=DEFINER,
+		requires="sqlj.background_job", implementor="background_job",
+		out={ "state text", "result text", "error text" }
+	)
+	public static boolean jobStatus(long jobId, ResultSet out)
+	throws SQLException
+	{
+		AclId user = AclId.getOuterUser();
+
+		try (
+			Connection c = getDefaultConnection();
+			PreparedStatement ps = c.prepareStatement(
+				"SELECT state, result, error FROM sqlj.background_job" +
+				" WHERE jobId OPERATOR(pg_catalog.=) ?" +
+				" AND (? OR submitter OPERATOR(pg_catalog.=)" +
+				"  CAST(? AS pg_catalog.oid))");
+		)
+		{
+			ps.setLong(1, jobId);
+			ps.setBoolean(2, user.isSuperuser());
+			ps.setLong(3, Integer.toUnsignedLong(user.intValue()));
+			try ( ResultSet rs = ps.executeQuery() )
+			{
+				if ( ! rs.next() )
+					return false;
+				out.updateString(1, rs.getString(1));
+				out.updateString(2, rs.getString(2));
+				out.updateString(3, rs.getString(3));
+				return true;
+			}
+		}
+	}
+
+	/**
+	 * The {@code VmRSS} line of {@code /proc/self/status}, in bytes, or -1 if
+	 * it cannot be read.
+	 */
+	private static long residentSetSize()
+	{
+		try
+		{
+			for ( String line : Files.readAllLines(
+				Paths.get("/proc/self/status"), UTF_8) )
+			{
+				if ( ! line.startsWith("VmRSS:") )
+					continue;
+				String[] f = line.substring(6).trim().split("\\s+");
+				return 1024L * Long.parseLong(f[0]);
+			}
+		}
+		catch ( IOException | NumberFormatException e )
+		{
+		}
+		return -1L;
+	}
+
+	/**
+	 * Write a Java class data sharing archive of the classes loaded so far in
+	 * this session, for use by later sessions through
+	 * {@code pljava.shared_archive}. This method is exposed in SQL as
+	 * {@code sqlj.dump_shared_archive(VARCHAR)}, and may be called only by
+	 * a superuser.
+	 *<p>
+	 * It relies on the Hotspot {@code VM.cds dynamic_dump} diagnostic command
+	 * of Java 17 and later, which needs the session's JVM to have been started
+	 * with {@code -XX:+RecordDynamicDumpInfo} in {@code pljava.vmoptions}. The
+	 * archive is written to {@code fileName}, which should not be the archive
+	 * in use; once written, it can be renamed into place, and is used by
+	 * sessions starting after that.
+	 * @param fileName The file, in the server's file system, to write.
+	 * @return Any output of the diagnostic command.
+	 */
+	@Function(schema="sqlj", name="dump_shared_archive",
+		requires="sqlj.tables")
+	public static String dumpSharedArchive(String fileName)
+	throws SQLException
+	{
+		if ( null == fileName )
+			throw new SQLDataException(
+				"parameter \"fileName\" may not be null", "22004");
+		if ( ! AclId.getOuterUser().isSuperuser() )
+			throw new SQLSyntaxErrorException( // yeah, for 42501, really
+				"Permission denied. Only a super user can write a shared " +
+				"archive", "42501");
+
+		try
+		{
+			return doPrivileged(() ->
+				(String)getPlatformMBeanServer().invoke(
+					new ObjectName("com.sun.management:type=DiagnosticCommand"),
+					"vmCds",
+					new Object[] {
+						new String[] { "dynamic_dump", fileName } },
+					new String[] { String[].class.getName() }));
+		}
+		catch ( JMException e )
+		{
+			throw new SQLFeatureNotSupportedException(
+				"Writing a shared archive requires Java 17 or later with " +
+				"-XX:+RecordDynamicDumpInfo in pljava.vmoptions: " + e,
+				"0A000", e);
+		}
+	}
+
+	/**
+	 * Start a Java Flight Recorder recording in this session's JVM, using the
+	 * {@code profile} settings, for the given number of seconds. This method
+	 * is exposed in SQL as {@code sqlj.start_profile(INTEGER, VARCHAR)}, and
+	 * may be called only by a superuser.
+	 *<p>
+	 * It relies on the Hotspot {@code JFR.start} diagnostic command, of Java 11
+	 * and later. The recording is named for the backend's process ID, so it
+	 * can be told apart from those of other sessions and stopped early by
+	 * {@code sqlj.stop_profile()}; as the JVM runs in the backend process, that
+	 * is also the process ID in the recording itself, and in
+	 * {@code pg_stat_activity}. The per-function times of
+	 * {@code sqlj.function_stats()} can show which functions to look for.
+	 * @param seconds How long to record.
+	 * @param fileName The file, in the server's file system, to write when
+	 * the recording ends; if omitted, {@code pljava-}<em>pid</em>{@code .jfr}
+	 * in the data directory.
+	 * @return Any output of the diagnostic command.
+	 */
+	@Function(schema="sqlj", name="start_profile", requires="sqlj.tables")
+	public static String startProfile(
+		int seconds, @SQLType(optional=true) String fileName)
+	throws SQLException
+	{
+		if ( 0 >= seconds )
+			throw new SQLDataException(
+				"parameter \"seconds\" must be positive", "22023");
+		if ( null == fileName )
+			fileName = profileName() + ".jfr";
+
+		return flightRecorder("jfrStart", "Starting a profile",
+			"name=" + profileName(), "settings=profile",
+			"duration=" + seconds + "s", "filename=" + fileName);
+	}
+
+	/**
+	 * Stop, before its duration is up, a recording started in this session by
+	 * {@code sqlj.start_profile}, writing it to its file. This method is
+	 * exposed in SQL as {@code sqlj.stop_profile()}, and may be called only
+	 * by a superuser.
+	 * @return Any output of the diagnostic command.
+	 */
+	@Function(schema="sqlj", name="stop_profile", requires="sqlj.tables")
+	public static String stopProfile() throws SQLException
+	{
+		return flightRecorder("jfrStop", "Stopping a profile",
+			"name=" + profileName());
+	}
+
+	private static String profileName()
+	{
+		return "pljava-" + ProcessHandle.current().pid();
+	}
+
+	private static String flightRecorder(
+		String operation, String what, String... args)
+	throws SQLException
+	{
+		if ( ! AclId.getOuterUser().isSuperuser() )
+			throw new SQLSyntaxErrorException( // yeah, for 42501, really
+				"Permission denied. Only a super user can control the " +
+				"flight recorder", "42501");
+
+		try
+		{
+			return doPrivileged(() ->
+				(String)getPlatformMBeanServer().invoke(
+					new ObjectName("com.sun.management:type=DiagnosticCommand"),
+					operation,
+					new Object[] { args },
+					new String[] { String[].class.getName() }));
+		}
+		catch ( JMException e )
+		{
+			throw new SQLFeatureNotSupportedException(
+				what + " requires Java 11 or later with the flight " +
+				"recorder: " + e, "0A000", e);
+		}
+	}
+
+	/**
+	 * Report how the varlena values passed to Java in this session (as
+	 * streams or {@code SQLXML}) were handled: how many were detoasted at
+	 * once, how many were parked in their stored form, how many of those were
+	 * parked still compressed for want of a snapshot, and how many parked
+	 * values were detoasted later, when read. This method is exposed in SQL as
+	 * {@code sqlj.varlena_statistics()}.
+	 */
+	@Function(
+		schema="sqlj", name="varlena_statistics", requires="sqlj.tables",
+		out={
+			"eager bigint", "parked bigint", "parked_compressed bigint",
+			"detoasted_later bigint"
+		}
+	)
+	public static boolean varlenaStatistics(ResultSet out)
+	throws SQLException
+	{
+		long[] counts = VarlenaWrapper.Input.statistics();
+		for ( int i = 0; i < counts.length; ++ i )
+			out.updateLong(1 + i, counts[i]);
+		return true;
+	}
+
+	/**
+	 * Report the crossings of the JNI boundary in this session: calls into
+	 * Java, calls from Java into PostgreSQL, local references handed to native
+	 * code, and bytes of string content converted toward Java and from Java.
+	 * This method is exposed in SQL as {@code sqlj.jni_statistics()}.
+	 *<p>
+	 * With {@code pljava.track_jni} on, the same counts are also reported for
+	 * each transaction when it ends.
+	 */
+	@Function(
+		schema="sqlj", name="jni_statistics", requires="sqlj.tables",
+		out={
+			"upcalls bigint", "downcalls bigint", "local_refs bigint",
+			"bytes_to_java bigint", "bytes_from_java bigint"
+		}
+	)
+	public static boolean jniStatistics(ResultSet out)
+	throws SQLException
+	{
+		long[] counts = Backend.jniStatistics();
+		for ( int i = 0; i < counts.length; ++ i )
+			out.updateLong(1 + i, counts[i]);
+		return true;
+	}
+
+	/**
+	 * Report, for each class of object in this session that pairs Java state
+	 * with native state (such as a {@code VarlenaWrapper}, {@code Tuple},
+	 * {@code TupleDesc}, {@code Portal}, {@code ExecutionPlan}, or
+	 * {@code SingleRowReader}), the instances constructed and released, those
+	 * still live, those awaiting release, and the bytes of native memory the
+	 * live ones hold. This method is exposed in SQL as
+	 * {@code sqlj.dualstate_statistics()}.
+	 *<p>
+	 * The native bytes, and the instances awaiting release, are measured by
+	 * each call. The bean named
+	 * {@code org.postgresql.pljava:type=DualState,name=Statistics} reports the
+	 * same counts over JMX, with the measured values as of the latest call.
+	 */
+	@Function(
+		schema="sqlj", name="dualstate_statistics", requires="sqlj.tables",
+		out={
+			"class text", "constructed bigint", "released bigint",
+			"live bigint", "pending_release bigint", "native_bytes bigint"
+		}
+	)
+	public static ResultSetProvider dualStateStatistics() throws SQLException
+	{
+		DualStateStatistics.PerClass[] classes = DualState.measurePerClass();
+
+		return new ResultSetProvider()
+		{
+			@Override
+			public boolean assignRowValues(ResultSet out, int currentRow)
+			throws SQLException
+			{
+				if ( currentRow >= classes.length )
+					return false;
+				DualStateStatistics.PerClass c = classes[currentRow];
+				out.updateString(1, c.getClassName());
+				out.updateLong(2, c.getConstructed());
+				out.updateLong(3, c.getReleased());
+				out.updateLong(4, c.getLive());
+				out.updateLong(5, c.getPendingRelease());
+				out.updateLong(6, c.getNativeBytes());
+				return true;
+			}
+
+			@Override
+			public void close()
+			{
+			}
+		};
+	}
+
+	/**
+	 * Report, for each PL/Java function called in this session while
+	 * {@code pljava.track_functions} was on, the number of calls and the time
+	 * they took, in milliseconds: in total, at most for one call, in Java, and
+	 * converting the arguments and the result, and how many of the calls were
+	 * answered from the function's {@code memoize} cache. This method is
+	 * exposed in SQL as {@code sqlj.function_stats()}.
+	 *<p>
+	 * The same values (in nanoseconds) are available over JMX, from the bean
+	 * named {@code org.postgresql.pljava:type=Function,name=FunctionStatistics},
+	 * which also reports how many calls were not tracked for want of room.
+	 */
+	@Function(
+		schema="sqlj", name="function_stats", requires="sqlj.tables",
+		out={
+			"funcid oid", "calls bigint", "total_time double precision",
+			"max_time double precision", "java_time double precision",
+			"argument_time double precision", "return_time double precision",
+			"memo_hits bigint"
+		}
+	)
+	public static ResultSetProvider functionStats() throws SQLException
+	{
+		FunctionStatistics.Timing[] timings =
+			FunctionStats.statistics().getFunctions();
+
+		return new ResultSetProvider()
+		{
+			@Override
+			public boolean assignRowValues(ResultSet out, int currentRow)
+			throws SQLException
+			{
+				if ( currentRow >= timings.length )
+					return false;
+				FunctionStatistics.Timing t = timings[currentRow];
+				out.updateObject(1, new Oid((int)t.getOid()));
+				out.updateLong(2, t.getCalls());
+				out.updateDouble(3, t.getTotalNanos() / 1e6);
+				out.updateDouble(4, t.getMaxNanos() / 1e6);
+				out.updateDouble(5, t.getJavaNanos() / 1e6);
+				out.updateDouble(6, t.getArgumentNanos() / 1e6);
+				out.updateDouble(7, t.getReturnNanos() / 1e6);
+				out.updateLong(8, t.getMemoHits());
+				return true;
+			}
+
+			@Override
+			public void close()
+			{
+			}
+		};
+	}
+
 	/**
 	 * Throws an exception if the given name cannot be used as the name of a
 	 * jar.
@@ -1381,6 +2173,32 @@ public class Commands
 		}
 	}
 
+	/**
+	 * Returns the schemas whose class paths include the given jar.
+	 *
+	 * @param jarId The primary key value of the jar.
+	 * @return The schemas, in no particular order.
+	 * @throws SQLException
+	 */
+	private static List<Identifier.Simple> schemasUsingJar(int jarId)
+	throws SQLException
+	{
+		List<Identifier.Simple> schemas = new ArrayList<>();
+		try(PreparedStatement stmt = getDefaultConnection()
+			.prepareStatement(
+				"SELECT DISTINCT schemaName FROM sqlj.classpath_entry" +
+				" WHERE jarId OPERATOR(pg_catalog.=) ?"))
+		{
+			stmt.setInt(1, jarId);
+			try(ResultSet rs = stmt.executeQuery())
+			{
+				while(rs.next())
+					schemas.add(Identifier.Simple.fromCatalog(rs.getString(1)));
+			}
+		}
+		return schemas;
+	}
+
 	/**
 	 * Returns the Oid for the given Schema.
 	 * 
@@ -1440,13 +2258,14 @@ public class Commands
 			throw new SQLException("Unable to obtain id of '" + jarName + "'");
 
 		if(image == null)
-			addClassImages(jarId, urlString);
+			addClassImages(jarId, urlString, null);
 		else
 		{
 			InputStream imageStream = new ByteArrayInputStream(image);
-			addClassImages(jarId, imageStream, image.length);
+			addClassImages(jarId, imageStream, image.length, null);
 		}
-		Loader.clearSchemaLoaders();
+		ClassImageCache.storeJar(jarId);
+		Loader.clearSchemaLoaders(schemasUsingJar(jarId));
 		if(!deploy)
 			return;
 
@@ -1494,23 +2313,32 @@ public class Commands
 					"Jar repository update did not update 1 row");
 		}
 
+		/*
+		 * The descriptors are recorded afresh from the new manifest. Entries
+		 * are replaced only where their content has changed; see the comment
+		 * on the schema above.
+		 */
 		try ( PreparedStatement stmt = getDefaultConnection().prepareStatement(
-			"DELETE FROM sqlj.jar_entry WHERE jarId OPERATOR(pg_catalog.=) ?");
+			"DELETE FROM sqlj.jar_descriptor" +
+			" WHERE jarId OPERATOR(pg_catalog.=) ?");
 		)
 		{
 			stmt.setInt(1, jarId);
 			stmt.executeUpdate();
 		}
 
+		Map<String,StoredEntry> previous = storedEntries(jarId);
+
 		if(image == null)
-			addClassImages(jarId, urlString);
+			addClassImages(jarId, urlString, previous);
 		else
 		{
 			InputStream imageStream = new ByteArrayInputStream(image);
-			addClassImages(jarId, imageStream, image.length);
+			addClassImages(jarId, imageStream, image.length, previous);
 		}
 
-		Loader.clearSchemaLoaders();
+		ClassImageCache.storeJar(jarId);
+		Loader.clearSchemaLoaders(schemasUsingJar(jarId));
 
 		if(!redeploy)
 			return;
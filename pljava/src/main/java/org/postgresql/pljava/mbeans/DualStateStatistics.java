@@ -38,4 +38,30 @@ public interface DualStateStatistics
 	long getRepeatedlyDeferred();
 	long getGcReleaseRaces();
 	long getReleaseReleaseRaces();
+
+	/**
+	 * Counts for each {@code DualState} subclass that has had instances
+	 * constructed in this session.
+	 */
+	PerClass[] getPerClass();
+
+	/**
+	 * Counts for one {@code DualState} subclass.
+	 *<p>
+	 * The native bytes held by the live instances, and how many of those are
+	 * awaiting release (explicitly released, or found unreachable, by Java, but
+	 * not yet cleaned up), are as last measured, which happens only on the PG
+	 * thread, as when {@code sqlj.dualstate_statistics()} is called. The
+	 * native bytes are only measured on PostgreSQL 13 and later for state held
+	 * in its own memory context.
+	 */
+	interface PerClass
+	{
+		String getClassName();
+		long getConstructed();
+		long getReleased();
+		long getLive();
+		long getNativeBytes();
+		long getPendingRelease();
+	}
 }
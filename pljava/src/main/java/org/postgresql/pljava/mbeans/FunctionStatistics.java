@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+package org.postgresql.pljava.mbeans;
+
+import javax.management.MXBean;
+
+/**
+ * Bean exposing the per-function timings kept while
+ * {@code pljava.track_functions} is on, for viewing in a JMX management
+ * client.
+ *<p>
+ * Only a fixed number of functions can be tracked in a session; calls of any
+ * further functions are counted, all together, as untracked calls.
+ */
+@MXBean
+public interface FunctionStatistics
+{
+	/**
+	 * The most functions that can be tracked in this session.
+	 */
+	int getCapacity();
+
+	/**
+	 * Calls, while tracking was on, of functions there was no room to track.
+	 */
+	long getUntrackedCalls();
+
+	/**
+	 * The timings of each function tracked so far.
+	 */
+	Timing[] getFunctions();
+
+	/**
+	 * Counts and times (in nanoseconds) for one function.
+	 *<p>
+	 * The total time runs from PL/Java's handler receiving the call to its
+	 * return. Time in Java includes anything the Java code did within the call,
+	 * such as SPI queries or nested calls. The argument and return times are
+	 * those not in Java spent converting the arguments and the result; any
+	 * Java code run for that purpose (as by a UDT's {@code readSQL}) is
+	 * counted as time in Java.
+	 *<p>
+	 * For a function declared with {@code memoize}, the memo hits are the
+	 * calls (included in the calls) answered from its cache of results,
+	 * without entering Java.
+	 */
+	interface Timing
+	{
+		long getOid();
+		long getCalls();
+		long getTotalNanos();
+		long getMaxNanos();
+		long getJavaNanos();
+		long getArgumentNanos();
+		long getReturnNanos();
+		long getMemoHits();
+	}
+}
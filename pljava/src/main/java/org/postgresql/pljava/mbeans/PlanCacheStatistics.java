@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+package org.postgresql.pljava.mbeans;
+
+import javax.management.MXBean;
+
+/**
+ * Bean exposing statistics of the cache of prepared plans shared by all
+ * PL/Java functions in a session, for viewing in a JMX management client.
+ *<p>
+ * A hit is a statement prepared when a plan for the same SQL and parameter
+ * types was found in the cache; a miss is one that had to be prepared anew,
+ * and a reprepare is a miss for SQL and parameter types whose plan had been
+ * evicted recently. An eviction is counted for each plan discarded to keep
+ * the cache within its limits, or displaced by another plan for the same key.
+ */
+@MXBean
+public interface PlanCacheStatistics
+{
+	long getHits();
+	long getMisses();
+	long getEvictions();
+	long getReprepares();
+	int  getEntries();
+	long getBytes();
+}
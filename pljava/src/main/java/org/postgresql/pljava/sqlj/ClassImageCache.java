@@ -0,0 +1,284 @@
+/*
+ * Copyright (c) 2026 Tada AB and other contributors, as listed below.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the The BSD 3-Clause License
+ * which accompanies this distribution, and is available at
+ * http://opensource.org/licenses/BSD-3-Clause
+ *
+ * Contributors:
+ *   Tada AB
+ */
+package org.postgresql.pljava.sqlj;
+
+import java.io.IOException;
+
+import java.nio.ByteBuffer;
+import java.nio.channels.FileChannel;
+import static java.nio.channels.FileChannel.MapMode.READ_ONLY;
+import java.nio.file.DirectoryStream;
+import java.nio.file.Files;
+import java.nio.file.NoSuchFileException;
+import java.nio.file.Path;
+import java.nio.file.Paths;
+import static java.nio.file.StandardCopyOption.ATOMIC_MOVE;
+import static java.nio.file.StandardCopyOption.REPLACE_EXISTING;
+import static java.nio.file.StandardOpenOption.READ;
+
+import java.sql.PreparedStatement;
+import java.sql.ResultSet;
+import java.sql.SQLException;
+import java.sql.Statement;
+
+import java.util.logging.Level;
+import java.util.logging.Logger;
+
+import org.postgresql.pljava.internal.Backend;
+import static org.postgresql.pljava.internal.Privilege.doPrivileged;
+
+import static org.postgresql.pljava.jdbc.SQLUtils.getDefaultConnection;
+
+import org.postgresql.pljava.jdbc.SPIReadOnlyControl;
+
+/**
+ * A cache, in files under the directory named by
+ * {@code pljava.class_image_cache}, of the class images in installed jars,
+ * letting a {@link Loader} in any session map a class image from a file instead
+ * of querying it from {@code sqlj.jar_entry} and copying it into the heap.
+ *<p>
+ * Images are kept in a subdirectory named for the database's oid, each in
+ * a file named for the entry's integer surrogate key and the {@code xmin} of
+ * its row, and a file is only used for an entry whose row the loader found
+ * with that {@code xmin}. {@code replace_jar} deletes and adds anew any entry
+ * whose content changes, so a file is never taken for a row it does not hold,
+ * even one left over from before the extension was dropped and recreated,
+ * restarting the keys. Files
+ * are written under temporary names and renamed into place, so a reader finds
+ * either the whole image or none. Failing to read or write the cache only means
+ * the image comes from the table as it would without the cache.
+ *<p>
+ * The utility functions that install, replace, and remove jars populate and
+ * prune the cache; it is not intended to be used from user code.
+ */
+public final class ClassImageCache
+{
+	private ClassImageCache() { }
+
+	private static final Logger s_logger =
+		Logger.getLogger(ClassImageCache.class.getName());
+
+	private static final String CLASS_SUFFIX = ".class";
+
+	/**
+	 * The cache directory for this database, or null if there is none; looked
+	 * up once in a session, when first needed.
+	 */
+	private static Path s_directory;
+	private static boolean s_directoryKnown;
+
+	static Path directory()
+	{
+		if ( s_directoryKnown )
+			return s_directory;
+		s_directoryKnown = true;
+
+		String dir = Backend.getConfigOption("pljava.class_image_cache");
+		if ( null == dir  ||  dir.isEmpty() )
+			return null;
+
+		try (
+			Statement stmt = getDefaultConnection().createStatement();
+		)
+		{
+			stmt.unwrap(SPIReadOnlyControl.class).clearReadOnly();
+			try ( ResultSet rs = stmt.executeQuery(
+				"SELECT oid FROM pg_catalog.pg_database" +
+				" WHERE datname OPERATOR(pg_catalog.=)" +
+				" pg_catalog.current_database()") )
+			{
+				if ( rs.next() )
+					s_directory = Paths.get(dir, rs.getString(1));
+			}
+		}
+		catch ( SQLException e )
+		{
+			s_logger.log(Level.WARNING,
+				"class image cache unavailable: " + e.getMessage(), e);
+		}
+		return s_directory;
+	}
+
+	/**
+	 * The file for the image of an entry whose row has the given {@code xmin},
+	 * as text.
+	 */
+	private static Path entryFile(Path dir, int entryId, String xmin)
+	{
+		return dir.resolve(entryId + "." + xmin);
+	}
+
+	/**
+	 * Return a read-only mapping of the cached image for a jar entry whose row
+	 * has the given {@code xmin}, or null if it is not cached.
+	 */
+	static ByteBuffer map(int entryId, String xmin)
+	{
+		Path dir = directory();
+		if ( null == dir  ||  null == xmin )
+			return null;
+
+		try
+		{
+			return doPrivileged(() ->
+			{
+				try ( FileChannel fc = FileChannel.open(
+					entryFile(dir, entryId, xmin), READ) )
+				{
+					return fc.map(READ_ONLY, 0, fc.size());
+				}
+			});
+		}
+		catch ( NoSuchFileException e )
+		{
+			return null;
+		}
+		catch ( IOException e )
+		{
+			s_logger.log(Level.FINE, "reading cached class image", e);
+			return null;
+		}
+	}
+
+	/**
+	 * Save the image of a jar entry whose row has the given {@code xmin} in
+	 * the cache, if there is one.
+	 */
+	static void store(int entryId, String xmin, byte[] image)
+	{
+		Path dir = directory();
+		if ( null == dir  ||  null == xmin )
+			return;
+
+		try
+		{
+			doPrivileged(() ->
+			{
+				Files.createDirectories(dir);
+				Path tmp = Files.createTempFile(dir, entryId + "-", ".tmp");
+				try
+				{
+					Files.write(tmp, image);
+					Files.move(tmp, entryFile(dir, entryId, xmin),
+						ATOMIC_MOVE, REPLACE_EXISTING);
+				}
+				finally
+				{
+					Files.deleteIfExists(tmp);
+				}
+			});
+		}
+		catch ( IOException e )
+		{
+			s_logger.log(Level.FINE, "writing cached class image", e);
+		}
+	}
+
+	/**
+	 * Save the images of all classes in a jar in the cache, if there is one.
+	 * Called by {@code install_jar} and {@code replace_jar} once the jar's
+	 * entries are in place. An entry already cached (one {@code replace_jar}
+	 * found unchanged) is not written again.
+	 */
+	public static void storeJar(int jarId) throws SQLException
+	{
+		if ( null == directory() )
+			return;
+
+		try (
+			PreparedStatement stmt = getDefaultConnection().prepareStatement(
+				"SELECT entryId, CAST(xmin AS pg_catalog.text), entryImage" +
+				" FROM sqlj.jar_entry" +
+				" WHERE jarId OPERATOR(pg_catalog.=) ?" +
+				" AND entryName OPERATOR(pg_catalog.~~) ?");
+		)
+		{
+			stmt.setInt(1, jarId);
+			stmt.setString(2, "%" + CLASS_SUFFIX);
+			try ( ResultSet rs = stmt.executeQuery() )
+			{
+				while ( rs.next() )
+				{
+					int entryId = rs.getInt(1);
+					String xmin = rs.getString(2);
+					Path file = entryFile(directory(), entryId, xmin);
+					if ( ! doPrivileged(() -> Files.exists(file)) )
+						store(entryId, xmin, rs.getBytes(3));
+				}
+			}
+		}
+	}
+
+	/**
+	 * Remove the images of the given entries from the cache, if there is one.
+	 * Called by {@code replace_jar} before the entries are deleted.
+	 */
+	public static void evictEntries(int[] entryIds)
+	{
+		Path dir = directory();
+		if ( null == dir )
+			return;
+
+		for ( int entryId : entryIds )
+			evict(dir, entryId);
+	}
+
+	private static void evict(Path dir, int entryId)
+	{
+		try
+		{
+			doPrivileged(() ->
+			{
+				try ( DirectoryStream<Path> files =
+					Files.newDirectoryStream(dir, entryId + ".*") )
+				{
+					for ( Path file : files )
+						Files.deleteIfExists(file);
+				}
+			});
+		}
+		catch ( NoSuchFileException e )
+		{
+			/* no directory yet, so nothing to remove */
+		}
+		catch ( IOException e )
+		{
+			s_logger.log(Level.FINE, "removing cached class image", e);
+		}
+	}
+
+	/**
+	 * Remove the images of all entries in a jar from the cache, if there is
+	 * one. Called by {@code remove_jar} before the jar's entries are
+	 * deleted.
+	 */
+	public static void evictJar(int jarId) throws SQLException
+	{
+		Path dir = directory();
+		if ( null == dir )
+			return;
+
+		try (
+			PreparedStatement stmt = getDefaultConnection().prepareStatement(
+				"SELECT entryId FROM sqlj.jar_entry" +
+				" WHERE jarId OPERATOR(pg_catalog.=) ?");
+		)
+		{
+			stmt.setInt(1, jarId);
+			try ( ResultSet rs = stmt.executeQuery() )
+			{
+				while ( rs.next() )
+					evict(dir, rs.getInt(1));
+			}
+		}
+	}
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2004-2021 Tada AB and other contributors, as listed below.
+ * Copyright (c) 2004-2026 Tada AB and other contributors, as listed below.
  *
  * All rights reserved. This program and the accompanying materials
  * are made available under the terms of the The BSD 3-Clause License
@@ -22,6 +22,8 @@ import static java.lang.invoke.MethodType.methodType;
 import java.net.MalformedURLException;
 import java.net.URL;
 
+import java.nio.ByteBuffer;
+
 import java.security.CodeSigner;
 import java.security.CodeSource;
 import java.security.Principal;
@@ -34,11 +36,16 @@ import java.sql.SQLData;
 import java.sql.SQLException;
 import java.sql.Statement;
 
-import java.util.Collections;
+import java.util.ArrayList;
+import java.util.Collection;
 import java.util.Enumeration;
 import java.util.HashMap;
+import java.util.IdentityHashMap;
+import java.util.List;
 import java.util.Map;
 import java.util.NoSuchElementException;
+import java.util.Set;
+import java.util.concurrent.ConcurrentHashMap;
 
 import java.util.logging.Level;
 import java.util.logging.Logger;
@@ -50,6 +57,7 @@ import org.postgresql.pljava.sqlgen.Lexicals.Identifier;
 import org.postgresql.pljava.internal.Backend;
 import org.postgresql.pljava.internal.Checked;
 import org.postgresql.pljava.internal.Oid;
+import org.postgresql.pljava.internal.ParallelComputeImpl;
 import static org.postgresql.pljava.internal.Privilege.doPrivileged;
 import static org.postgresql.pljava.internal.UncheckedException.unchecked;
 
@@ -92,6 +100,15 @@ public class Loader extends ClassLoader
 	private static final Logger s_logger =
 		Logger.getLogger(Loader.class.getName());
 
+	/*
+	 * Registered before any instance is made, so that classes can be defined
+	 * on several threads at once, as warmUp does.
+	 */
+	static
+	{
+		registerAsParallelCapable();
+	}
+
 	/**
 	 * A distinguished singleton instance to serve as a type-safe "sentinel"
 	 * reference in context classloader management (as Java considers null to be
@@ -153,6 +170,41 @@ public class Loader extends ClassLoader
 		Backend.clearFunctionCache();
 	}
 
+	/**
+	 * Removes the cached loaders of only the given schemas, with the type maps
+	 * and functions that depend on them. This is called by the utility
+	 * functions when a change can affect only the class paths of known
+	 * schemas. It is not intended to be called from user code.
+	 *<p>
+	 * A schema with no class path of its own shares the loader of the
+	 * {@code public} schema (or the system loader, for {@code public} itself),
+	 * so any other schema found sharing a loader being removed has its cache
+	 * entries removed as well.
+	 */
+	public static void clearSchemaLoaders(Collection<Identifier.Simple> schemas)
+	{
+		Map<ClassLoader,Boolean> loaders = new IdentityHashMap<>();
+
+		for ( Identifier.Simple schema : schemas )
+		{
+			ClassLoader loader = s_schemaLoaders.get(schema);
+			if ( null != loader )
+				loaders.put(loader, Boolean.TRUE);
+			s_typeMap.remove(schema);
+		}
+
+		s_schemaLoaders.entrySet().removeIf(e ->
+		{
+			if ( ! loaders.containsKey(e.getValue()) )
+				return false;
+			s_typeMap.remove(e.getKey());
+			return true;
+		});
+
+		for ( ClassLoader loader : loaders.keySet() )
+			Backend.clearFunctionCache(loader);
+	}
+
 	/**
 	 * Obtains the loader that is in effect for the current schema (i.e. the
 	 * schema that is first in the search path).
@@ -205,6 +257,12 @@ public class Loader extends ClassLoader
 		 */
 		Map<Integer,CodeSource> codeSources = new HashMap<>();
 
+		/*
+		 * Under-construction map from an integer entry key to the xmin of its
+		 * row, as text, identifying the image in the class image cache.
+		 */
+		Map<Integer,String> versions = new HashMap<>();
+
 		Connection conn = getDefaultConnection();
 		try (
 			// Read the entries so that the one with highest prio is read last.
@@ -218,7 +276,8 @@ public class Loader extends ClassLoader
 				" WHERE c.schemaName OPERATOR(pg_catalog.=) ?" +
 				" ORDER BY c.ordinal DESC");
 			PreparedStatement inner = conn.prepareStatement(
-				"SELECT entryId, entryName FROM sqlj.jar_entry " +
+				"SELECT entryId, entryName, CAST(xmin AS pg_catalog.text)" +
+				" FROM sqlj.jar_entry " +
 				"WHERE jarId OPERATOR(pg_catalog.=) ?");
 		)
 		{
@@ -240,6 +299,7 @@ public class Loader extends ClassLoader
 							int entryId = rs2.getInt(1);
 							String entryName = rs2.getString(2);
 							codeSources.put(entryId, cs);
+							versions.put(entryId, rs2.getString(3));
 							int[] oldEntry = classImages.get(entryName);
 							if(oldEntry == null)
 								classImages.put(entryName, new int[] { entryId });
@@ -273,8 +333,11 @@ public class Loader extends ClassLoader
 		else
 		{
 			String name = "schema:" + schema.nonFolded();
-			loader = doPrivileged(() ->
-				new Loader(classImages, codeSources, parent, name));
+			Loader l = doPrivileged(() ->
+				new Loader(classImages, codeSources, versions, parent, name));
+			if ( "on".equals(Backend.getConfigOption("pljava.warm_up_classes")) )
+				l.warmUp(schema);
+			loader = l;
 		}
 
 		s_schemaLoaders.put(schema, loader);
@@ -374,6 +437,23 @@ public class Loader extends ClassLoader
 	private final Map<String,int[]> m_entries;
 	private final Map<Integer,ProtectionDomain> m_domains;
 
+	/**
+	 * Map from the integer key of a jar entry to the {@code xmin} of its row,
+	 * as text, under which its image is found in the class image cache.
+	 */
+	private final Map<Integer,String> m_versions;
+
+	/**
+	 * If {@code pljava.prefetch_classes} or {@code pljava.warm_up_classes} was
+	 * on when this loader was created, class images fetched ahead by entry id,
+	 * held until defined; otherwise null. If {@code pljava.prefetch_classes}
+	 * was on, also the protection domains (one per jar) of the jars already
+	 * fetched; otherwise null. Both are safe for concurrent use, as classes may
+	 * be defined on several threads at once.
+	 */
+	private final Map<Integer,byte[]> m_prefetched;
+	private final Set<ProtectionDomain> m_prefetchedJars;
+
 	/**
 	 * Private constructor used only to create the "sentinel" (non-)loader.
 	 *<p>
@@ -384,7 +464,10 @@ public class Loader extends ClassLoader
 	{
 		m_entries  = null;
 		m_domains  = null;
+		m_versions = null;
 		m_j9Helper = null;
+		m_prefetched = null;
+		m_prefetchedJars = null;
 	}
 
 	/**
@@ -394,12 +477,21 @@ public class Loader extends ClassLoader
 	 */
 	Loader(
 		Map<String,int[]> entries,
-		Map<Integer,CodeSource> sources, ClassLoader parent, String name)
+		Map<Integer,CodeSource> sources, Map<Integer,String> versions,
+		ClassLoader parent, String name)
 	{
 		super(name, parent);
 		m_entries = entries;
+		m_versions = versions;
 		m_j9Helper = ifJ9getHelper(); // null if not under OpenJ9 with sharing
 
+		boolean prefetch =
+			"on".equals(Backend.getConfigOption("pljava.prefetch_classes"));
+		boolean warmUp =
+			"on".equals(Backend.getConfigOption("pljava.warm_up_classes"));
+		m_prefetched = prefetch || warmUp ? new ConcurrentHashMap<>() : null;
+		m_prefetchedJars = prefetch ? ConcurrentHashMap.newKeySet() : null;
+
 		Principal[] noPrincipals = new Principal[0];
 
 		m_domains = new HashMap<>();
@@ -442,6 +534,36 @@ public class Loader extends ClassLoader
 			}
 			String ifJ9token = (String) o; // used below when storing class
 
+			/*
+			 * Next, the class image cache, if configured, may have the image
+			 * in a file that can simply be mapped.
+			 */
+			String xmin = m_versions.get(entryId[0]);
+			ByteBuffer cached = ClassImageCache.map(entryId[0], xmin);
+			if ( null != cached )
+			{
+				Class<?> cls = defineClass(name, cached, pd);
+				ifJ9storeSharedClass(ifJ9token, cls); // noop for null token
+				return cls;
+			}
+
+			byte[] prefetched = prefetched(entryId[0], pd);
+			if ( null != prefetched )
+			{
+				Class<?> cls =
+					defineClass(name, prefetched, 0, prefetched.length, pd);
+				ClassImageCache.store(entryId[0], xmin, prefetched);
+				ifJ9storeSharedClass(ifJ9token, cls); // noop for null token
+				return cls;
+			}
+
+			/*
+			 * A warm-up worker may not enter PostgreSQL to query the image;
+			 * the class will be loaded on the PG thread when first needed.
+			 */
+			if ( ParallelComputeImpl.isWorker() )
+				throw new ClassNotFoundException(name);
+
 			try (
 				// This code relies heavily on the fact that the connection
 				// is a singleton and that the prepared statement will live
@@ -471,6 +593,8 @@ public class Loader extends ClassLoader
 
 					Class<?> cls = defineClass(name, img, 0, img.length, pd);
 
+					ClassImageCache.store(entryId[0], xmin, img);
+
 					ifJ9storeSharedClass(ifJ9token, cls); // noop for null token
 					return cls;
 				}
@@ -486,6 +610,140 @@ public class Loader extends ClassLoader
 		throw new ClassNotFoundException(name);
 	}
 
+	/**
+	 * If prefetching, return (and forget) the prefetched image for an entry,
+	 * first fetching, in one query, the images of all classes in the entry's
+	 * jar if that jar has not been fetched yet.
+	 *<p>
+	 * Only images that could be wanted later are kept: not those shadowed by
+	 * an entry of the same name in a jar earlier on the path, nor those of
+	 * classes already defined (from the class image cache, say). A failure to
+	 * prefetch is logged, and classes are then fetched one at a time.
+	 */
+	private byte[] prefetched(int entryId, ProtectionDomain pd)
+	{
+		if ( null == m_prefetched )
+			return null;
+
+		if ( null != m_prefetchedJars  &&  ! ParallelComputeImpl.isWorker()
+			&&  m_prefetchedJars.add(pd) )
+		{
+			try (
+				PreparedStatement stmt = getDefaultConnection()
+					.prepareStatement(
+						"SELECT entryId, entryName, entryImage" +
+						" FROM sqlj.jar_entry" +
+						" WHERE jarId OPERATOR(pg_catalog.=) (" +
+						"  SELECT jarId FROM sqlj.jar_entry" +
+						"  WHERE entryId OPERATOR(pg_catalog.=) ?)" +
+						" AND entryName OPERATOR(pg_catalog.~~) '%.class'");
+			)
+			{
+				stmt.unwrap(SPIReadOnlyControl.class).clearReadOnly();
+				stmt.setInt(1, entryId);
+				try ( ResultSet rs = stmt.executeQuery() )
+				{
+					while ( rs.next() )
+					{
+						int id = rs.getInt(1);
+						String entryName = rs.getString(2);
+						int[] ids = m_entries.get(entryName);
+						if ( null == ids  ||  id != ids[0] )
+							continue;
+						int end = entryName.length() - ".class".length();
+						String className =
+							entryName.substring(0, end).replace('/', '.');
+						if ( null != findLoadedClass(className) )
+							continue;
+						m_prefetched.put(id, rs.getBytes(3));
+					}
+				}
+			}
+			catch ( SQLException e )
+			{
+				Logger.getAnonymousLogger().log(Level.INFO,
+					"Failed to prefetch classes", e);
+			}
+		}
+
+		return m_prefetched.remove(entryId);
+	}
+
+	/**
+	 * Fetch, in one query, the images of all classes on this loader's path,
+	 * then define them on the parallel compute workers, returning once all
+	 * have been tried.
+	 *<p>
+	 * Only the query is made on the PG thread; parsing the images and
+	 * defining the classes, the costly part of a first call into a large jar,
+	 * is spread over the workers. As with prefetching, images shadowed by an
+	 * earlier jar on the path are skipped. A class a worker cannot define, as
+	 * when it needs a class the worker cannot load without entering
+	 * PostgreSQL, is left to be loaded as usual when first needed. No static
+	 * initializer runs here, and the JVM still verifies each class when it is
+	 * first linked. A failure of the query is logged, and classes are then
+	 * loaded as they would be without warming up.
+	 */
+	private void warmUp(Identifier.Simple schema)
+	{
+		ClassImageCache.directory(); // look it up here, not on a worker
+
+		Map<Integer,String> classNames = new HashMap<>();
+		try (
+			PreparedStatement stmt = getDefaultConnection()
+				.prepareStatement(
+					"SELECT e.entryId, e.entryName, e.entryImage" +
+					" FROM" +
+					"  sqlj.jar_entry e" +
+					"  INNER JOIN sqlj.classpath_entry c" +
+					"  ON e.jarId OPERATOR(pg_catalog.=) c.jarId" +
+					" WHERE c.schemaName OPERATOR(pg_catalog.=) ?" +
+					" AND e.entryName OPERATOR(pg_catalog.~~) '%.class'");
+		)
+		{
+			stmt.unwrap(SPIReadOnlyControl.class).clearReadOnly();
+			stmt.setString(1, schema.pgFolded());
+			try ( ResultSet rs = stmt.executeQuery() )
+			{
+				while ( rs.next() )
+				{
+					int id = rs.getInt(1);
+					String entryName = rs.getString(2);
+					int[] ids = m_entries.get(entryName);
+					if ( null == ids  ||  id != ids[0] )
+						continue;
+					int end = entryName.length() - ".class".length();
+					classNames.put(id,
+						entryName.substring(0, end).replace('/', '.'));
+					m_prefetched.put(id, rs.getBytes(3));
+				}
+			}
+		}
+		catch ( SQLException e )
+		{
+			s_logger.log(Level.INFO, "Failed to warm up classes", e);
+			return;
+		}
+
+		List<Runnable> tasks = new ArrayList<>(classNames.size());
+		classNames.forEach((id, className) -> tasks.add(() ->
+		{
+			try
+			{
+				loadClass(className);
+			}
+			catch ( ClassNotFoundException | LinkageError e )
+			{
+				/* left to be loaded, and fail if it must, when needed */
+			}
+			finally
+			{
+				m_prefetched.remove(id);
+			}
+		}));
+		ParallelComputeImpl.runAll(tasks);
+	}
+
 	@Override
 	protected URL findResource(String name)
 	{